@@ -0,0 +1,40 @@
+# - Try to find FFTW3 (double and single precision)
+# Once done this will define
+#
+#  FFTW3_FOUND         - system has FFTW3
+#  FFTW3_INCLUDE_DIR   - the FFTW3 include directory
+#  FFTW3_LIBRARY       - Link this to use FFTW3 (double precision)
+#  FFTW3F_LIBRARY      - Link this to use FFTW3 (single precision)
+
+
+find_path(FFTW3_INCLUDE_DIR fftw3.h
+  PATHS /usr/include /usr/local/include /opt/local/include
+  )
+
+find_library(FFTW3_LIBRARY
+  NAMES fftw3
+  PATHS ${CMAKE_SYSTEM_LIBRARY_PATH} /usr/lib64 /usr/lib /usr/local/lib64 /usr/local/lib /opt/local/lib64 /opt/local/lib
+  )
+
+find_library(FFTW3F_LIBRARY
+  NAMES fftw3f
+  PATHS ${CMAKE_SYSTEM_LIBRARY_PATH} /usr/lib64 /usr/lib /usr/local/lib64 /usr/local/lib /opt/local/lib64 /opt/local/lib
+  )
+
+
+IF (FFTW3_INCLUDE_DIR AND FFTW3_LIBRARY AND FFTW3F_LIBRARY)
+  SET(FFTW3_FOUND YES)
+ELSE ()
+  SET(FFTW3_FOUND NO)
+ENDIF ()
+
+
+IF (FFTW3_FOUND)
+  IF (NOT FFTW3_FIND_QUIETLY)
+     MESSAGE(STATUS "Found FFTW3: ${FFTW3_LIBRARY} ${FFTW3F_LIBRARY}")
+  ENDIF (NOT FFTW3_FIND_QUIETLY)
+ELSE (FFTW3_FOUND)
+  IF (FFTW3_FIND_REQUIRED)
+     MESSAGE(FATAL_ERROR "Could not find FFTW3")
+  ENDIF (FFTW3_FIND_REQUIRED)
+ENDIF (FFTW3_FOUND)
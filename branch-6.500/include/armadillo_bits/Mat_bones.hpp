@@ -494,6 +494,11 @@ class Mat : public Base< eT, Mat<eT> >
   inline bool quiet_load(const std::string   name, const file_type type = auto_detect);
   inline bool quiet_load(      std::istream& is,   const file_type type = auto_detect);
   
+  #if defined(ARMA_USE_CXX11)
+  inline arma_warn_unused io_future save_async(const std::string name, const file_type type = arma_binary, const bool print_status = true) const;
+  inline arma_warn_unused io_future load_async(const std::string name, const file_type type = auto_detect, const bool print_status = true);
+  #endif
+  
   
   // for container-like functionality
   
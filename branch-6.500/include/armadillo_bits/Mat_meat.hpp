@@ -6849,45 +6849,22 @@ Mat<eT>::save(const std::string name, const file_type type, const bool print_sta
   {
   arma_extra_debug_sigprint();
   
-  bool save_okay;
+  std::string err_msg;
   
-  switch(type)
+  const bool save_okay = diskio::save(*this, name, type, err_msg);
+  
+  if(print_status && (save_okay == false))
     {
-    case raw_ascii:
-      save_okay = diskio::save_raw_ascii(*this, name);
-      break;
-    
-    case arma_ascii:
-      save_okay = diskio::save_arma_ascii(*this, name);
-      break;
-    
-    case csv_ascii:
-      save_okay = diskio::save_csv_ascii(*this, name);
-      break;
-    
-    case raw_binary:
-      save_okay = diskio::save_raw_binary(*this, name);
-      break;
-    
-    case arma_binary:
-      save_okay = diskio::save_arma_binary(*this, name);
-      break;
-      
-    case pgm_binary:
-      save_okay = diskio::save_pgm_binary(*this, name);
-      break;
-    
-    case hdf5_binary:
-      save_okay = diskio::save_hdf5_binary(*this, name);
-      break;
-    
-    default:
-      if(print_status)  { arma_debug_warn("Mat::save(): unsupported file type"); }
-      save_okay = false;
+    if(err_msg.length() > 0)
+      {
+      arma_debug_warn("Mat::save(): ", err_msg, name);
+      }
+    else
+      {
+      arma_debug_warn("Mat::save(): couldn't write to ", name);
+      }
     }
   
-  if(print_status && (save_okay == false))  { arma_debug_warn("Mat::save(): couldn't write to ", name); }
-  
   return save_okay;
   }
 
@@ -6924,6 +6901,14 @@ Mat<eT>::save(std::ostream& os, const file_type type, const bool print_status) c
     case arma_binary:
       save_okay = diskio::save_arma_binary(*this, os);
       break;
+    
+    case npy_binary:
+      save_okay = diskio::save_npy_binary(*this, os);
+      break;
+    
+    case npz_binary:
+      save_okay = diskio::save_npz_binary(*this, os);
+      break;
       
     case pgm_binary:
       save_okay = diskio::save_pgm_binary(*this, os);
@@ -6949,47 +6934,9 @@ Mat<eT>::load(const std::string name, const file_type type, const bool print_sta
   {
   arma_extra_debug_sigprint();
   
-  bool load_okay;
   std::string err_msg;
   
-  switch(type)
-    {
-    case auto_detect:
-      load_okay = diskio::load_auto_detect(*this, name, err_msg);
-      break;
-    
-    case raw_ascii:
-      load_okay = diskio::load_raw_ascii(*this, name, err_msg);
-      break;
-    
-    case arma_ascii:
-      load_okay = diskio::load_arma_ascii(*this, name, err_msg);
-      break;
-    
-    case csv_ascii:
-      load_okay = diskio::load_csv_ascii(*this, name, err_msg);
-      break;
-    
-    case raw_binary:
-      load_okay = diskio::load_raw_binary(*this, name, err_msg);
-      break;
-    
-    case arma_binary:
-      load_okay = diskio::load_arma_binary(*this, name, err_msg);
-      break;
-      
-    case pgm_binary:
-      load_okay = diskio::load_pgm_binary(*this, name, err_msg);
-      break;
-    
-    case hdf5_binary:
-      load_okay = diskio::load_hdf5_binary(*this, name, err_msg);
-      break;
-
-    default:
-      if(print_status)  { arma_debug_warn("Mat::load(): unsupported file type"); }
-      load_okay = false;
-    }
+  const bool load_okay = diskio::load(*this, name, type, err_msg);
   
   if( (print_status == true) && (load_okay == false) )
     {
@@ -7049,6 +6996,14 @@ Mat<eT>::load(std::istream& is, const file_type type, const bool print_status)
     case arma_binary:
       load_okay = diskio::load_arma_binary(*this, is, err_msg);
       break;
+    
+    case npy_binary:
+      load_okay = diskio::load_npy_binary(*this, is, err_msg);
+      break;
+    
+    case npz_binary:
+      load_okay = diskio::load_npz_binary(*this, is, err_msg);
+      break;
       
     case pgm_binary:
       load_okay = diskio::load_pgm_binary(*this, is, err_msg);
@@ -7134,6 +7089,36 @@ Mat<eT>::quiet_load(std::istream& is, const file_type type)
 
 
 
+#if defined(ARMA_USE_CXX11)
+
+//! save the matrix to a file on a background thread; a snapshot of the matrix is taken before returning
+template<typename eT>
+inline
+io_future
+Mat<eT>::save_async(const std::string name, const file_type type, const bool print_status) const
+  {
+  arma_extra_debug_sigprint();
+  
+  return io_async::submit_save(*this, name, type, print_status, "Mat::save_async()");
+  }
+
+
+
+//! load the matrix from a file on a background thread; the matrix must not be accessed until the load has completed
+template<typename eT>
+inline
+io_future
+Mat<eT>::load_async(const std::string name, const file_type type, const bool print_status)
+  {
+  arma_extra_debug_sigprint();
+  
+  return io_async::submit_load(*this, name, type, print_status, "Mat::load_async()");
+  }
+
+#endif
+
+
+
 template<typename eT>
 inline
 Mat<eT>::row_iterator::row_iterator(Mat<eT>& in_M, const uword in_row)
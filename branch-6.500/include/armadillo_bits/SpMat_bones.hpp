@@ -330,6 +330,11 @@ class SpMat : public SpBase< eT, SpMat<eT> >
   inline bool quiet_load(const std::string   name, const file_type type = arma_binary);
   inline bool quiet_load(      std::istream& is,   const file_type type = arma_binary);
   
+  #if defined(ARMA_USE_CXX11)
+  inline arma_warn_unused io_future save_async(const std::string name, const file_type type = arma_binary, const bool print_status = true) const;
+  inline arma_warn_unused io_future load_async(const std::string name, const file_type type = arma_binary, const bool print_status = true);
+  #endif
+  
   // TODO: speed up loading of sparse matrices stored as text files (ie. raw_ascii and coord_ascii)
   // TODO: implement auto_detect for sparse matrices
   // TODO: modify docs to specify which formats are not applicable to sparse matrices
@@ -543,6 +548,12 @@ class SpMat : public SpBase< eT, SpMat<eT> >
   //! don't use this unless you're writing internal Armadillo code
   inline void steal_mem(SpMat& X);
   
+  //! don't use this unless you're writing internal Armadillo code
+  inline void init_batch_coo(const uword* in_rows, const uword* in_cols, const eT* in_vals, const uword N, const bool add_values);
+  
+  //! don't use this unless you're writing internal Armadillo code
+  inline void sort_and_merge(const bool add_values);
+  
   //! don't use this unless you're writing internal Armadillo code
   template<              typename T1, typename Functor> arma_hot inline void init_xform   (const SpBase<eT, T1>& x, const Functor& func);
   template<typename eT2, typename T1, typename Functor> arma_hot inline void init_xform_mt(const SpBase<eT2,T1>& x, const Functor& func);
@@ -3657,33 +3657,22 @@ SpMat<eT>::save(const std::string name, const file_type type, const bool print_s
   {
   arma_extra_debug_sigprint();
   
-  bool save_okay;
+  std::string err_msg;
   
-  switch(type)
+  const bool save_okay = diskio::save(*this, name, type, err_msg);
+  
+  if(print_status && (save_okay == false))
     {
-    // case raw_ascii:
-    //   save_okay = diskio::save_raw_ascii(*this, name);
-    //   break;
-    
-    // case csv_ascii:
-    //   save_okay = diskio::save_csv_ascii(*this, name);
-    //   break;
-    
-    case arma_binary:
-      save_okay = diskio::save_arma_binary(*this, name);
-      break;
-    
-    case coord_ascii:
-      save_okay = diskio::save_coord_ascii(*this, name);
-      break;
-    
-    default:
-      if(print_status)  { arma_debug_warn("SpMat::save(): unsupported file type"); }
-      save_okay = false;
+    if(err_msg.length() > 0)
+      {
+      arma_debug_warn("SpMat::save(): ", err_msg, name);
+      }
+    else
+      {
+      arma_debug_warn("SpMat::save(): couldn't write to ", name);
+      }
     }
   
-  if(print_status && (save_okay == false))  { arma_debug_warn("SpMat::save(): couldn't write to ", name); }
-  
   return save_okay;
   }
 
@@ -3713,10 +3702,18 @@ SpMat<eT>::save(std::ostream& os, const file_type type, const bool print_status)
       save_okay = diskio::save_arma_binary(*this, os);
       break;
     
+    case npz_binary:
+      save_okay = diskio::save_npz_binary(*this, os);
+      break;
+    
     case coord_ascii:
       save_okay = diskio::save_coord_ascii(*this, os);
       break;
     
+    case mtx_ascii:
+      save_okay = diskio::save_mtx_ascii(*this, os);
+      break;
+    
     default:
       if(print_status)  { arma_debug_warn("SpMat::save(): unsupported file type"); }
       save_okay = false;
@@ -3737,35 +3734,9 @@ SpMat<eT>::load(const std::string name, const file_type type, const bool print_s
   {
   arma_extra_debug_sigprint();
   
-  bool load_okay;
   std::string err_msg;
   
-  switch(type)
-    {
-    // case auto_detect:
-    //   load_okay = diskio::load_auto_detect(*this, name, err_msg);
-    //   break;
-    
-    // case raw_ascii:
-    //   load_okay = diskio::load_raw_ascii(*this, name, err_msg);
-    //   break;
-    
-    // case csv_ascii:
-    //   load_okay = diskio::load_csv_ascii(*this, name, err_msg);
-    //   break;
-    
-    case arma_binary:
-      load_okay = diskio::load_arma_binary(*this, name, err_msg);
-      break;
-    
-    case coord_ascii:
-      load_okay = diskio::load_coord_ascii(*this, name, err_msg);
-      break;
-    
-    default:
-      if(print_status)  { arma_debug_warn("SpMat::load(): unsupported file type"); }
-      load_okay = false;
-    }
+  const bool load_okay = diskio::load(*this, name, type, err_msg);
   
   if(print_status && (load_okay == false))
     {
@@ -3818,10 +3789,22 @@ SpMat<eT>::load(std::istream& is, const file_type type, const bool print_status)
       load_okay = diskio::load_arma_binary(*this, is, err_msg);
       break;
     
+    case npz_binary:
+      load_okay = diskio::load_npz_binary(*this, is, err_msg);
+      break;
+    
     case coord_ascii:
       load_okay = diskio::load_coord_ascii(*this, is, err_msg);
       break;
     
+    case mtx_ascii:
+      load_okay = diskio::load_mtx_ascii(*this, is, err_msg);
+      break;
+    
+    case mtx_ascii_lowmem:
+      load_okay = diskio::load_mtx_ascii_lowmem(*this, is, err_msg);
+      break;
+    
     default:
       if(print_status)  { arma_debug_warn("SpMat::load(): unsupported file type"); }
       load_okay = false;
@@ -3901,6 +3884,36 @@ SpMat<eT>::quiet_load(std::istream& is, const file_type type)
 
 
 
+#if defined(ARMA_USE_CXX11)
+
+//! save the matrix to a file on a background thread; a snapshot of the matrix is taken before returning
+template<typename eT>
+inline
+io_future
+SpMat<eT>::save_async(const std::string name, const file_type type, const bool print_status) const
+  {
+  arma_extra_debug_sigprint();
+  
+  return io_async::submit_save(*this, name, type, print_status, "SpMat::save_async()");
+  }
+
+
+
+//! load the matrix from a file on a background thread; the matrix must not be accessed until the load has completed
+template<typename eT>
+inline
+io_future
+SpMat<eT>::load_async(const std::string name, const file_type type, const bool print_status)
+  {
+  arma_extra_debug_sigprint();
+  
+  return io_async::submit_load(*this, name, type, print_status, "SpMat::load_async()");
+  }
+
+#endif
+
+
+
 /**
  * Initialize the matrix to the specified size.  Data is not preserved, so the matrix is assumed to be entirely sparse (empty).
  */
@@ -4511,6 +4524,169 @@ SpMat<eT>::remove_zeros()
 
 
 
+//! build the matrix from unsorted co-ordinate (triplet) data, using a counting sort over the columns;
+//! the size of the matrix must already be set;
+//! repeated locations are either added or the last one is kept; zeros are not stored
+template<typename eT>
+inline
+void
+SpMat<eT>::init_batch_coo(const uword* in_rows, const uword* in_cols, const eT* in_vals, const uword N, const bool add_values)
+  {
+  arma_extra_debug_sigprint();
+  
+  mem_resize(N);
+  
+  uword* col_counts = access::rwp(col_ptrs);
+  
+  arrayops::inplace_set(col_counts, uword(0), n_cols + 1);
+  
+  for(uword i=0; i < N; ++i)
+    {
+    arma_debug_check( ( (in_rows[i] >= n_rows) || (in_cols[i] >= n_cols) ), "SpMat::SpMat(): invalid row or column index" );
+    
+    ++col_counts[ in_cols[i] + 1 ];
+    }
+  
+  for(uword c=0; c < n_cols; ++c)
+    {
+    col_counts[c + 1] += col_counts[c];
+    }
+  
+  podarray<uword> fill(n_cols);
+  
+  arrayops::copy(fill.memptr(), col_ptrs, n_cols);
+  
+  uword* fill_mem = fill.memptr();
+  
+  eT*    out_vals = access::rwp(values);
+  uword* out_rows = access::rwp(row_indices);
+  
+  for(uword i=0; i < N; ++i)
+    {
+    const uword k = fill_mem[ in_cols[i] ]++;
+    
+    out_rows[k] = in_rows[i];
+    out_vals[k] = in_vals[i];
+    }
+  
+  sort_and_merge(add_values);
+  }
+
+
+
+//! sort the row indices within each column, combine repeated locations and remove zeros;
+//! within each column, repeated locations are in the order they were given,
+//! so that either their sum or the last one is kept
+template<typename eT>
+inline
+void
+SpMat<eT>::sort_and_merge(const bool add_values)
+  {
+  arma_extra_debug_sigprint();
+  
+  if(n_nonzero == 0)  { return; }
+  
+  eT*    vals = access::rwp(values);
+  uword* rows = access::rwp(row_indices);
+  
+  podarray<uword> counts(n_cols);
+  
+  uword* counts_mem = counts.memptr();
+
+  #if defined(_OPENMP)
+    #pragma omp parallel for schedule(dynamic, 256) if(n_nonzero >= 65536)
+  #endif
+  for(uword c=0; c < n_cols; ++c)
+    {
+    const uword start = col_ptrs[c    ];
+    const uword end   = col_ptrs[c + 1];
+    
+    bool is_sorted = true;
+    
+    for(uword k = start+1; k < end; ++k)
+      {
+      if(rows[k] < rows[k-1])  { is_sorted = false; break; }
+      }
+    
+    if(is_sorted == false)
+      {
+      // the packets are compared by row and then by position, which keeps the sort stable
+      std::vector< std::pair<uword,uword> > packets(end - start);
+      
+      for(uword k = start; k < end; ++k)  { packets[k - start] = std::make_pair(rows[k], k); }
+      
+      std::sort( packets.begin(), packets.end() );
+      
+      std::vector<eT> tmp_vals(vals + start, vals + end);
+      
+      for(uword k = start; k < end; ++k)
+        {
+        rows[k] = packets[k - start].first;
+        vals[k] = tmp_vals[ packets[k - start].second - start ];
+        }
+      }
+    
+    uword n_out = 0;
+    
+    for(uword k = start; k < end; ++k)
+      {
+      if( (n_out > 0) && (rows[start + n_out - 1] == rows[k]) )
+        {
+        vals[start + n_out - 1] = (add_values) ? eT(vals[start + n_out - 1] + vals[k]) : vals[k];
+        }
+      else
+        {
+        rows[start + n_out] = rows[k];
+        vals[start + n_out] = vals[k];
+        ++n_out;
+        }
+      }
+    
+    uword n_kept = 0;
+    
+    for(uword k = start; k < (start + n_out); ++k)
+      {
+      if(vals[k] != eT(0))
+        {
+        rows[start + n_kept] = rows[k];
+        vals[start + n_kept] = vals[k];
+        ++n_kept;
+        }
+      }
+    
+    counts_mem[c] = n_kept;
+    }
+  
+  uword* col_ptrs_mem = access::rwp(col_ptrs);
+  
+  uword pos = 0;
+  
+  for(uword c=0; c < n_cols; ++c)
+    {
+    const uword start = col_ptrs_mem[c];
+    const uword count = counts_mem[c];
+    
+    if(pos != start)
+      {
+      for(uword i=0; i < count; ++i)
+        {
+        rows[pos + i] = rows[start + i];
+        vals[pos + i] = vals[start + i];
+        }
+      }
+    
+    col_ptrs_mem[c] = pos;
+    
+    pos += count;
+    }
+  
+  col_ptrs_mem[n_cols] = pos;
+  
+  mem_resize(pos);
+  }
+
+
+
 // Steal memory from another matrix.
 template<typename eT>
 inline
@@ -64,6 +64,13 @@ struct arma_config
   #endif
   
   
+  #if defined(ARMA_USE_FFTW3)
+    static const bool fftw3 = true;
+  #else
+    static const bool fftw3 = false;
+  #endif
+
+
   #if defined(ARMA_USE_HDF5)
     static const bool hdf5 = true;
   #else
@@ -0,0 +1,363 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup arma_dtoa
+//! @{
+
+
+#if defined(ARMA_USE_U64S64)
+
+//! conversion of floating point numbers to the shortest decimal string which reads back as the same number.
+//! uses the Grisu2 algorithm by Florian Loitsch:
+//! "Printing Floating-Point Numbers Quickly and Accurately with Integers", PLDI 2010
+class arma_dtoa
+  {
+  public:
+  
+  struct diy_fp
+    {
+    u64 f;
+    int e;
+    
+    inline diy_fp()                               : f(0),    e(0)    {}
+    inline diy_fp(const u64 in_f, const int in_e) : f(in_f), e(in_e) {}
+    };
+  
+  
+  inline static diy_fp mul(const diy_fp& a, const diy_fp& b)
+    {
+    const u64 M32 = u64(0xFFFFFFFFu);
+    
+    const u64 a_hi = a.f >> 32;
+    const u64 a_lo = a.f & M32;
+    const u64 b_hi = b.f >> 32;
+    const u64 b_lo = b.f & M32;
+    
+    const u64 hh = a_hi * b_hi;
+    const u64 lh = a_lo * b_hi;
+    const u64 hl = a_hi * b_lo;
+    const u64 ll = a_lo * b_lo;
+    
+    u64 tmp = (ll >> 32) + (hl & M32) + (lh & M32);
+    
+    tmp += u64(1) << 31;  // round
+    
+    return diy_fp( hh + (hl >> 32) + (lh >> 32) + (tmp >> 32), a.e + b.e + 64 );
+    }
+  
+  
+  inline static diy_fp normalise(const diy_fp& x)
+    {
+    diy_fp out = x;
+    
+    const u64 top_bit = u64(1) << 63;
+    
+    while( (out.f & top_bit) == 0 )  { out.f <<= 1; out.e--; }
+    
+    return out;
+    }
+  
+  
+  //! cached power of ten c_k such that the exponent of v * c_k lies in the [-60,-32] range
+  inline static diy_fp cached_power(const int e, int& K)
+    {
+    static const u32 table_f[] =
+      {
+      0xfa8fd5a0,0x081c0288, 0xbaaee17f,0xa23ebf76, 0x8b16fb20,0x3055ac76,
+      0xcf42894a,0x5dce35ea, 0x9a6bb0aa,0x55653b2d, 0xe61acf03,0x3d1a45df,
+      0xab70fe17,0xc79ac6ca, 0xff77b1fc,0xbebcdc4f, 0xbe5691ef,0x416bd60c,
+      0x8dd01fad,0x907ffc3c, 0xd3515c28,0x31559a83, 0x9d71ac8f,0xada6c9b5,
+      0xea9c2277,0x23ee8bcb, 0xaecc4991,0x4078536d, 0x823c1279,0x5db6ce57,
+      0xc2109436,0x4dfb5637, 0x9096ea6f,0x3848984f, 0xd77485cb,0x25823ac7,
+      0xa086cfcd,0x97bf97f4, 0xef340a98,0x172aace5, 0xb23867fb,0x2a35b28e,
+      0x84c8d4df,0xd2c63f3b, 0xc5dd4427,0x1ad3cdba, 0x936b9fce,0xbb25c996,
+      0xdbac6c24,0x7d62a584, 0xa3ab6658,0x0d5fdaf6, 0xf3e2f893,0xdec3f126,
+      0xb5b5ada8,0xaaff80b8, 0x87625f05,0x6c7c4a8b, 0xc9bcff60,0x34c13053,
+      0x964e858c,0x91ba2655, 0xdff97724,0x70297ebd, 0xa6dfbd9f,0xb8e5b88f,
+      0xf8a95fcf,0x88747d94, 0xb9447093,0x8fa89bcf, 0x8a08f0f8,0xbf0f156b,
+      0xcdb02555,0x653131b6, 0x993fe2c6,0xd07b7fac, 0xe45c10c4,0x2a2b3b06,
+      0xaa242499,0x697392d3, 0xfd87b5f2,0x8300ca0e, 0xbce50864,0x92111aeb,
+      0x8cbccc09,0x6f5088cc, 0xd1b71758,0xe219652c, 0x9c400000,0x00000000,
+      0xe8d4a510,0x00000000, 0xad78ebc5,0xac620000, 0x813f3978,0xf8940984,
+      0xc097ce7b,0xc90715b3, 0x8f7e32ce,0x7bea5c70, 0xd5d238a4,0xabe98068,
+      0x9f4f2726,0x179a2245, 0xed63a231,0xd4c4fb27, 0xb0de6538,0x8cc8ada8,
+      0x83c7088e,0x1aab65db, 0xc45d1df9,0x42711d9a, 0x924d692c,0xa61be758,
+      0xda01ee64,0x1a708dea, 0xa26da399,0x9aef774a, 0xf209787b,0xb47d6b85,
+      0xb454e4a1,0x79dd1877, 0x865b8692,0x5b9bc5c2, 0xc83553c5,0xc8965d3d,
+      0x952ab45c,0xfa97a0b3, 0xde469fbd,0x99a05fe3, 0xa59bc234,0xdb398c25,
+      0xf6c69a72,0xa3989f5c, 0xb7dcbf53,0x54e9bece, 0x88fcf317,0xf22241e2,
+      0xcc20ce9b,0xd35c78a5, 0x98165af3,0x7b2153df, 0xe2a0b5dc,0x971f303a,
+      0xa8d9d153,0x5ce3b396, 0xfb9b7cd9,0xa4a7443c, 0xbb764c4c,0xa7a44410,
+      0x8bab8eef,0xb6409c1a, 0xd01fef10,0xa657842c, 0x9b10a4e5,0xe9913129,
+      0xe7109bfb,0xa19c0c9d, 0xac2820d9,0x623bf429, 0x80444b5e,0x7aa7cf85,
+      0xbf21e440,0x03acdd2d, 0x8e679c2f,0x5e44ff8f, 0xd433179d,0x9c8cb841,
+      0x9e19db92,0xb4e31ba9, 0xeb96bf6e,0xbadf77d9, 0xaf87023b,0x9bf0ee6b
+      };
+    
+    static const int table_e[] =
+      {
+      -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+      -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+      -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+      -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+      56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+      375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+      694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+      1013, 1039, 1066
+      };
+    
+    const double dk = double(-61 - e) * 0.30102999566398114 + 347.0;  // dk is always positive
+    
+    int k = int(dk);
+    
+    if(double(k) != dk)  { ++k; }
+    
+    const int index = (k >> 3) + 1;
+    
+    K = -(-348 + index*8);
+    
+    return diy_fp( (u64(table_f[2*index]) << 32) | u64(table_f[2*index + 1]), table_e[index] );
+    }
+  
+  
+  inline static u64 pow10_u64(const int n)
+    {
+    u64 out = 1;
+    
+    for(int i=0; i < n; ++i)  { out *= 10; }
+    
+    return out;
+    }
+  
+  
+  inline static void round_weed(char* buffer, const int len, const u64 delta, u64 rest, const u64 ten_kappa, const u64 wp_w)
+    {
+    while( (rest < wp_w) && ((delta - rest) >= ten_kappa) && ( ((rest + ten_kappa) < wp_w) || ((wp_w - rest) > (rest + ten_kappa - wp_w)) ) )
+      {
+      buffer[len - 1]--;
+      
+      rest += ten_kappa;
+      }
+    }
+  
+  
+  inline static void digit_gen(const diy_fp& W, const diy_fp& Mp, u64 delta, char* buffer, int& len, int& K)
+    {
+    static const u32 pow10_u32[] = { 1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u };
+    
+    const diy_fp one( u64(1) << (-Mp.e), Mp.e );
+    
+    const u64 wp_w = Mp.f - W.f;
+    
+    u32 p1 = u32(Mp.f >> (-one.e));
+    u64 p2 = Mp.f & (one.f - 1);
+    
+    int kappa = 1;
+    
+    while( (kappa < 10) && (p1 >= pow10_u32[kappa]) )  { ++kappa; }
+    
+    len = 0;
+    
+    while(kappa > 0)
+      {
+      const u32 div = pow10_u32[kappa-1];
+      const u32 d   = p1 / div;
+      
+      p1 %= div;
+      
+      if( (d != 0) || (len != 0) )  { buffer[len] = char('0' + d); ++len; }
+      
+      --kappa;
+      
+      const u64 tmp = (u64(p1) << (-one.e)) + p2;
+      
+      if(tmp <= delta)
+        {
+        K += kappa;
+        
+        round_weed(buffer, len, delta, tmp, u64(pow10_u32[kappa]) << (-one.e), wp_w);
+        
+        return;
+        }
+      }
+    
+    while(true)
+      {
+      p2    *= 10;
+      delta *= 10;
+      
+      const char d = char(p2 >> (-one.e));
+      
+      if( (d != 0) || (len != 0) )  { buffer[len] = char('0' + d); ++len; }
+      
+      p2 &= one.f - 1;
+      
+      --kappa;
+      
+      if(p2 < delta)
+        {
+        K += kappa;
+        
+        round_weed(buffer, len, delta, p2, one.f, (-kappa < 20) ? (wp_w * pow10_u64(-kappa)) : u64(0));
+        
+        return;
+        }
+      }
+    }
+  
+  
+  //! generate the digits of f * 2^e, where hidden_bit is the implicit leading bit of the floating point format;
+  //! the value is digits * 10^K
+  inline static void grisu2(const u64 f, const int e, const u64 hidden_bit, const bool lower_closer, char* buffer, int& len, int& K)
+    {
+    const diy_fp v = normalise( diy_fp(f, e) );
+    
+    const diy_fp m_plus = normalise( diy_fp((f << 1) + 1, e - 1) );
+    
+    diy_fp m_minus = ( (f == hidden_bit) && lower_closer ) ? diy_fp((f << 2) - 1, e - 2) : diy_fp((f << 1) - 1, e - 1);
+    
+    m_minus.f <<= (m_minus.e - m_plus.e);
+    m_minus.e   = m_plus.e;
+    
+    const diy_fp c_mk = cached_power(m_plus.e, K);
+    
+    const diy_fp W  = mul(v,       c_mk);
+          diy_fp Wp = mul(m_plus,  c_mk);
+          diy_fp Wm = mul(m_minus, c_mk);
+    
+    Wm.f++;
+    Wp.f--;
+    
+    digit_gen(W, Wp, Wp.f - Wm.f, buffer, len, K);
+    }
+  
+  
+  //! write digits * 10^K in plain or exponent notation; returns the number of characters written
+  inline static uword format(char* out, const char* digits, const int len, const int K)
+    {
+    const int kk = len + K;  // position of the decimal point relative to the first digit
+    
+    uword n = 0;
+    
+    if( (K >= 0) && (kk <= 21) )
+      {
+      for(int i=0; i < len; ++i)  { out[n] = digits[i]; ++n; }
+      for(int i=0; i < K;   ++i)  { out[n] = '0';       ++n; }
+      }
+    else
+    if( (kk > 0) && (kk <= 21) )
+      {
+      for(int i=0;  i < kk;  ++i)  { out[n] = digits[i]; ++n; }
+      
+      out[n] = '.';  ++n;
+      
+      for(int i=kk; i < len; ++i)  { out[n] = digits[i]; ++n; }
+      }
+    else
+    if( (kk > -6) && (kk <= 0) )
+      {
+      out[n] = '0';  ++n;
+      out[n] = '.';  ++n;
+      
+      for(int i=0; i < -kk; ++i)  { out[n] = '0';       ++n; }
+      for(int i=0; i < len; ++i)  { out[n] = digits[i]; ++n; }
+      }
+    else
+      {
+      out[n] = digits[0];  ++n;
+      
+      if(len > 1)
+        {
+        out[n] = '.';  ++n;
+        
+        for(int i=1; i < len; ++i)  { out[n] = digits[i]; ++n; }
+        }
+      
+      out[n] = 'e';  ++n;
+      
+      int exponent = kk - 1;
+      
+      if(exponent < 0)  { out[n] = '-'; ++n; exponent = -exponent; }
+      else              { out[n] = '+'; ++n;                       }
+      
+      if(exponent >= 100)  { out[n] = char('0' + exponent / 100);        ++n; }
+      if(exponent >=  10)  { out[n] = char('0' + (exponent / 10) % 10);  ++n; }
+      
+      out[n] = char('0' + exponent % 10);  ++n;
+      }
+    
+    return n;
+    }
+  
+  
+  //! write a finite double; out must have room for at least 32 characters
+  inline static uword write(char* out, const double val)
+    {
+    u64 bits;
+    
+    std::memcpy(&bits, &val, sizeof(u64));
+    
+    const u64 hidden_bit  = u64(1) << 52;
+    const u64 significand = bits & (hidden_bit - 1);
+    const int biased_e    = int( (bits >> 52) & u64(0x7FF) );
+    
+    uword n = 0;
+    
+    if( (bits >> 63) != 0 )  { out[n] = '-'; ++n; }
+    
+    if( (biased_e == 0) && (significand == 0) )  { out[n] = '0'; ++n; return n; }
+    
+    const u64 f = (biased_e != 0) ? (significand + hidden_bit) : significand;
+    const int e = (biased_e != 0) ? (biased_e - 1075)          : -1074;
+    
+    char digits[24];
+    int  len;
+    int  K;
+    
+    grisu2(f, e, hidden_bit, (biased_e > 1), digits, len, K);
+    
+    return n + format(&out[n], digits, len, K);
+    }
+  
+  
+  //! write a finite float; out must have room for at least 32 characters
+  inline static uword write(char* out, const float val)
+    {
+    u32 bits;
+    
+    std::memcpy(&bits, &val, sizeof(u32));
+    
+    const u32 hidden_bit  = u32(1) << 23;
+    const u32 significand = bits & (hidden_bit - 1);
+    const int biased_e    = int( (bits >> 23) & u32(0xFF) );
+    
+    uword n = 0;
+    
+    if( (bits >> 31) != 0 )  { out[n] = '-'; ++n; }
+    
+    if( (biased_e == 0) && (significand == 0) )  { out[n] = '0'; ++n; return n; }
+    
+    const u64 f = (biased_e != 0) ? u64(significand + hidden_bit) : u64(significand);
+    const int e = (biased_e != 0) ? (biased_e - 150)              : -149;
+    
+    char digits[24];
+    int  len;
+    int  K;
+    
+    grisu2(f, e, u64(hidden_bit), (biased_e > 1), digits, len, K);
+    
+    return n + format(&out[n], digits, len, K);
+    }
+  };
+
+#endif
+
+
+//! @}
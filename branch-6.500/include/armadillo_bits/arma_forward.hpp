@@ -53,6 +53,8 @@ template<typename parent, unsigned int mode, typename TB> class subview_each2;
 template<typename eT>              class subview_cube_each1;
 template<typename eT, typename TB> class subview_cube_each2;
 
+template<typename eT> class fft_plan;
+
 
 class SizeMat;
 class SizeCube;
@@ -249,7 +251,12 @@ enum file_type
   pgm_binary,   //!< Portable Grey Map (greyscale image)
   ppm_binary,   //!< Portable Pixel Map (colour image), used by the field and cube classes
   hdf5_binary,  //!< Open binary format, not specific to Armadillo, which can store arbitrary data
-  coord_ascii   //!< simple co-ordinate format for sparse matrices
+  coord_ascii,  //!< simple co-ordinate format for sparse matrices
+  arma_binary_indexed,  //!< Armadillo binary format for fields, with a trailing index for loading individual objects
+  npy_binary,   //!< NumPy .npy format
+  npz_binary,   //!< NumPy .npz archive (uncompressed); sparse matrices use the layout of scipy.sparse.save_npz()
+  mtx_ascii,    //!< Matrix Market co-ordinate format for sparse matrices
+  mtx_ascii_lowmem  //!< Matrix Market co-ordinate format, loaded in two passes over the file without storing the entries in an intermediate form
   };
 
 
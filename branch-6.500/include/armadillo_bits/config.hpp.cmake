@@ -45,6 +45,16 @@
 //// Make sure the directory has a trailing /
 #endif
 
+#if !defined(ARMA_USE_FFTW3)
+#cmakedefine ARMA_USE_FFTW3
+//// Uncomment the above line if you have FFTW3 (both the double and single precision libraries, eg. -lfftw3 -lfftw3f).
+//// FFTW3 is then used by fft(), ifft(), fft2(), ifft2() and fft_plan instead of the built-in FFT engine
+#endif
+
+// #define ARMA_FFTW3_MEASURE
+//// Uncomment the above line to make FFTW3 plans via measurements instead of estimates.
+//// Making the plans is then much slower, but the transforms may be faster; see also fft_plan::load_wisdom()
+
 #cmakedefine ARMA_USE_WRAPPER
 //// Comment out the above line if you're getting linking errors when compiling your programs,
 //// or if you prefer to directly link with LAPACK, BLAS + etc instead of the Armadillo runtime library.
@@ -160,6 +170,10 @@
   #undef ARMA_SUPERLU_INCLUDE_DIR
 #endif
 
+#if defined(ARMA_DONT_USE_FFTW3)
+  #undef ARMA_USE_FFTW3
+#endif
+
 #if defined(ARMA_DONT_USE_ATLAS)
   #undef ARMA_USE_ATLAS
   #undef ARMA_ATLAS_INCLUDE_DIR
@@ -0,0 +1,43 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+
+#if defined(ARMA_USE_FFTW3)
+
+// fftw_complex and fftwf_complex are double[2] and float[2]
+
+extern "C"
+  {
+  ::fftw_plan_s*  arma_wrapper(fftw_plan_dft_1d) (int n, double (*in)[2], double (*out)[2], int sign, unsigned flags);
+  ::fftwf_plan_s* arma_wrapper(fftwf_plan_dft_1d)(int n, float  (*in)[2], float  (*out)[2], int sign, unsigned flags);
+  
+  void arma_wrapper(fftw_execute_dft) (::fftw_plan_s*  p, double (*in)[2], double (*out)[2]);
+  void arma_wrapper(fftwf_execute_dft)(::fftwf_plan_s* p, float  (*in)[2], float  (*out)[2]);
+  
+  void arma_wrapper(fftw_destroy_plan) (::fftw_plan_s*  p);
+  void arma_wrapper(fftwf_destroy_plan)(::fftwf_plan_s* p);
+  
+  int arma_wrapper(fftw_alignment_of) (double* p);
+  int arma_wrapper(fftwf_alignment_of)(float*  p);
+  
+  void* arma_wrapper(fftw_malloc) (size_t n);
+  void* arma_wrapper(fftwf_malloc)(size_t n);
+  
+  void arma_wrapper(fftw_free) (void* p);
+  void arma_wrapper(fftwf_free)(void* p);
+  
+  int arma_wrapper(fftw_import_wisdom_from_filename) (const char* filename);
+  int arma_wrapper(fftwf_import_wisdom_from_filename)(const char* filename);
+  
+  int arma_wrapper(fftw_export_wisdom_to_filename) (const char* filename);
+  int arma_wrapper(fftwf_export_wisdom_to_filename)(const char* filename);
+  }
+
+#endif
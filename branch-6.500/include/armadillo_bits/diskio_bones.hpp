@@ -37,6 +37,14 @@ class diskio
   template<typename eT> inline static bool convert_naninf(eT&              val, const std::string& token);
   template<typename  T> inline static bool convert_naninf(std::complex<T>& val, const std::string& token);
   
+  template<typename eT> inline static uword fast_txt_real(char* out, const eT               val);
+  template<typename eT> inline static uword fast_txt_int (char* out, const eT               val);
+  template<typename eT> inline static uword fast_txt_elem(char* out, const eT&              val);
+  template<typename  T> inline static uword fast_txt_elem(char* out, const std::complex<T>& val);
+  
+  template<typename eT> inline static uword fast_txt_rows(char* out, const eT* mem, const uword n_rows, const uword n_cols, const uword row_start, const uword row_end, const char separator, const bool lead_separator);
+  template<typename eT> inline static bool  fast_txt_save(std::ostream& f, const eT* mem, const uword n_rows, const uword n_cols, const char separator, const bool lead_separator);
+  
   //
   // matrix saving
   
@@ -88,10 +96,11 @@ class diskio
   
   template<typename eT> inline static bool save_coord_ascii(const SpMat<eT>& x, const std::string& final_name);
   template<typename eT> inline static bool save_arma_binary(const SpMat<eT>& x, const std::string& final_name);
+  template<typename eT> inline static bool save_mtx_ascii  (const SpMat<eT>& x, const std::string& final_name);
   
-  template<typename eT> inline static bool save_coord_ascii(const SpMat<eT>& x,                std::ostream& f);
-  template<typename  T> inline static bool save_coord_ascii(const SpMat< std::complex<T> >& x, std::ostream& f);
-  template<typename eT> inline static bool save_arma_binary(const SpMat<eT>& x,                std::ostream& f);
+  template<typename eT> inline static bool save_coord_ascii(const SpMat<eT>& x, std::ostream& f);
+  template<typename eT> inline static bool save_arma_binary(const SpMat<eT>& x, std::ostream& f);
+  template<typename eT> inline static bool save_mtx_ascii  (const SpMat<eT>& x, std::ostream& f);
   
   
   //
@@ -99,10 +108,13 @@ class diskio
   
   template<typename eT> inline static bool load_coord_ascii(SpMat<eT>& x, const std::string& name, std::string& err_msg);
   template<typename eT> inline static bool load_arma_binary(SpMat<eT>& x, const std::string& name, std::string& err_msg);
+  template<typename eT> inline static bool load_mtx_ascii  (SpMat<eT>& x, const std::string& name, std::string& err_msg);
+  template<typename eT> inline static bool load_mtx_ascii_lowmem(SpMat<eT>& x, const std::string& name, std::string& err_msg);
   
-  template<typename eT> inline static bool load_coord_ascii(SpMat<eT>& x,                std::istream& f, std::string& err_msg);
-  template<typename  T> inline static bool load_coord_ascii(SpMat< std::complex<T> >& x, std::istream& f, std::string& err_msg);
-  template<typename eT> inline static bool load_arma_binary(SpMat<eT>& x,                std::istream& f, std::string& err_msg);
+  template<typename eT> inline static bool load_coord_ascii(SpMat<eT>& x, std::istream& f, std::string& err_msg);
+  template<typename eT> inline static bool load_arma_binary(SpMat<eT>& x, std::istream& f, std::string& err_msg);
+  template<typename eT> inline static bool load_mtx_ascii  (SpMat<eT>& x, std::istream& f, std::string& err_msg);
+  template<typename eT> inline static bool load_mtx_ascii_lowmem(SpMat<eT>& x, std::istream& f, std::string& err_msg);
   
   
   
@@ -138,6 +150,36 @@ class diskio
   template<typename eT> inline static bool load_auto_detect(Cube<eT>& x, std::istream& f, std::string& err_msg);
   
   
+  //
+  // NumPy .npy files and .npz archives
+  
+  template<typename eT> inline static bool save_npy_binary(const Mat<eT>&   x, const std::string& final_name);
+  template<typename eT> inline static bool save_npy_binary(const Cube<eT>&  x, const std::string& final_name);
+  template<typename eT> inline static bool save_npz_binary(const Mat<eT>&   x, const std::string& final_name);
+  template<typename eT> inline static bool save_npz_binary(const Cube<eT>&  x, const std::string& final_name);
+  template<typename eT> inline static bool save_npz_binary(const SpMat<eT>& x, const std::string& final_name);
+  
+  template<typename eT> inline static bool save_npy_binary(const Mat<eT>&   x, std::ostream& f);
+  template<typename eT> inline static bool save_npy_binary(const Cube<eT>&  x, std::ostream& f);
+  template<typename eT> inline static bool save_npz_binary(const Mat<eT>&   x, std::ostream& f);
+  template<typename eT> inline static bool save_npz_binary(const Cube<eT>&  x, std::ostream& f);
+  template<typename eT> inline static bool save_npz_binary(const SpMat<eT>& x, std::ostream& f);
+  
+  template<typename eT> inline static bool load_npy_binary(Mat<eT>&   x, const std::string& name, std::string& err_msg);
+  template<typename eT> inline static bool load_npy_binary(Cube<eT>&  x, const std::string& name, std::string& err_msg);
+  template<typename eT> inline static bool load_npz_binary(Mat<eT>&   x, const std::string& name, std::string& err_msg);
+  template<typename eT> inline static bool load_npz_binary(Cube<eT>&  x, const std::string& name, std::string& err_msg);
+  template<typename eT> inline static bool load_npz_binary(SpMat<eT>& x, const std::string& name, std::string& err_msg);
+  
+  template<typename eT> inline static bool load_npy_binary(Mat<eT>&   x, std::istream& f, std::string& err_msg);
+  template<typename eT> inline static bool load_npy_binary(Cube<eT>&  x, std::istream& f, std::string& err_msg);
+  template<typename eT> inline static bool load_npz_binary(Mat<eT>&   x, std::istream& f, std::string& err_msg);
+  template<typename eT> inline static bool load_npz_binary(Cube<eT>&  x, std::istream& f, std::string& err_msg);
+  template<typename eT> inline static bool load_npz_binary(SpMat<eT>& x, std::istream& f, std::string& err_msg);
+  
+  template<typename eT> inline static bool load_npy_vector(Col<eT>& x, std::istream& f, std::string& err_msg);
+  
+  
   //
   // field saving and loading
   
@@ -150,6 +192,22 @@ class diskio
   template<typename T1> inline static bool load_auto_detect(      field<T1>& x, const std::string&  name, std::string& err_msg);
   template<typename T1> inline static bool load_auto_detect(      field<T1>& x,       std::istream& f,    std::string& err_msg);
   
+  template<typename T1> inline static bool save_arma_binary_indexed(const field<T1>& x, const std::string&  name);
+  template<typename T1> inline static bool save_arma_binary_indexed(const field<T1>& x,       std::ostream& f);
+  
+  template<typename T1> inline static bool load_arma_binary_indexed(      field<T1>& x, const std::string&  name, std::string& err_msg);
+  template<typename T1> inline static bool load_arma_binary_indexed(      field<T1>& x,       std::istream& f,    std::string& err_msg);
+  template<typename T1> inline static bool load_arma_binary_indexed_body(field<T1>& x, std::istream& f, std::string& err_msg);
+  
+  inline static bool is_arma_binary_indexed(const std::string& name);
+  
+  inline static void write_field_offset(std::ostream& f, const std::streamoff offset);
+  inline static bool  read_field_offset(std::istream& f,       std::streamoff& offset);
+  
+  inline static bool load_field_index(const std::string& name, uword& n_rows, uword& n_cols, uword& n_slices, std::vector<std::streamoff>& offsets, std::string& err_msg);
+  
+  template<typename T1> inline static bool load_field_objects(field<T1>& x, const std::string& name, const std::vector<std::streamoff>& offsets, const uword* indices, std::string& err_msg);
+  
   inline static bool save_std_string(const field<std::string>& x, const std::string&  name);
   inline static bool save_std_string(const field<std::string>& x,       std::ostream& f);
   
@@ -177,6 +235,19 @@ class diskio
   template<typename T1> inline static bool load_ppm_binary(      field<T1>& x, const std::string&  final_name, std::string& err_msg);
   template<typename T1> inline static bool load_ppm_binary(      field<T1>& x,       std::istream& f,          std::string& err_msg);
   
+  
+  //
+  // selection of the save and load functions from the file type;
+  // shared by the save() and load() member functions and by save_async() and load_async()
+  
+  template<typename eT> inline static bool save(const Mat<eT>&   x, const std::string& name, const file_type type, std::string& err_msg);
+  template<typename eT> inline static bool save(const Cube<eT>&  x, const std::string& name, const file_type type, std::string& err_msg);
+  template<typename eT> inline static bool save(const SpMat<eT>& x, const std::string& name, const file_type type, std::string& err_msg);
+  
+  template<typename eT> inline static bool load(      Mat<eT>&   x, const std::string& name, const file_type type, std::string& err_msg);
+  template<typename eT> inline static bool load(      Cube<eT>&  x, const std::string& name, const file_type type, std::string& err_msg);
+  template<typename eT> inline static bool load(      SpMat<eT>& x, const std::string& name, const file_type type, std::string& err_msg);
+  
 
 
   };
@@ -579,6 +579,9 @@ diskio::guess_file_type(std::istream& f)
   f.clear();
   f.seekg(pos1);
   
+  if( (load_okay == true) && (N >= 6) && (std::memcmp(ptr, "\x93NUMPY", 6) == 0) )  { return npy_binary; }
+  if( (load_okay == true) && (N >= 4) && (std::memcmp(ptr, "PK\x03\x04", 4) == 0) )  { return npz_binary; }
+  
   bool has_binary  = false;
   bool has_bracket = false;
   bool has_comma   = false;
@@ -755,6 +758,224 @@ diskio::convert_naninf(std::complex<T>& val, const std::string& token)
 
 
 
+//! write the shortest decimal representation of val which reads back as val;
+//! returns the number of characters written; out must have room for at least 32 characters
+template<typename eT>
+inline
+uword
+diskio::fast_txt_real(char* out, const eT val)
+  {
+  if(arma_isfinite(val) == false)
+    {
+    const char* str = arma_isnan(val) ? "nan" : ( (val < eT(0)) ? "-inf" : "inf" );
+    
+    uword len = 0;
+    
+    while(str[len] != char(0))  { out[len] = str[len]; ++len; }
+    
+    return len;
+    }
+
+  #if defined(ARMA_USE_U64S64)
+    {
+    return (is_float<eT>::value) ? arma_dtoa::write(out, float(val)) : arma_dtoa::write(out, double(val));
+    }
+  #else
+    {
+    // digits10 and max_digits10
+    const int min_digits = (is_float<eT>::value) ?  6 : 15;
+    const int max_digits = (is_float<eT>::value) ?  9 : 17;
+    
+    int len = 0;
+    
+    for(int digits = min_digits; digits <= max_digits; ++digits)
+      {
+      // the output of "%.*g" with at most 17 digits is bounded by 24 characters
+      len = std::sprintf(out, "%.*g", digits, double(val));
+      
+      if( (digits == max_digits) || (eT(std::strtod(out, NULL)) == val) )  { break; }
+      }
+    
+    return uword(len);
+    }
+  #endif
+  }
+
+
+
+template<typename eT>
+inline
+uword
+diskio::fast_txt_int(char* out, const eT val)
+  {
+  char  tmp[32];
+  uword n = 0;
+  
+  eT v = val;
+  
+  do
+    {
+    const eT q = v / eT(10);
+    const eT r = v - q*eT(10);  // in the [-9,9] range, so the most negative value is handled without overflow
+    
+    tmp[n] = char( '0' + int( (r < eT(0)) ? eT(-r) : r ) );
+    
+    ++n;
+    
+    v = q;
+    }
+  while(v != eT(0));
+  
+  uword len = 0;
+  
+  if(val < eT(0))  { out[len] = '-'; ++len; }
+  
+  while(n > 0)  { --n; out[len] = tmp[n]; ++len; }
+  
+  return len;
+  }
+
+
+
+template<typename eT>
+inline
+uword
+diskio::fast_txt_elem(char* out, const eT& val)
+  {
+  return (is_real<eT>::value) ? diskio::fast_txt_real(out, val) : diskio::fast_txt_int(out, val);
+  }
+
+
+
+//! complex numbers are written as (real,imag), which is what the text loaders expect
+template<typename T>
+inline
+uword
+diskio::fast_txt_elem(char* out, const std::complex<T>& val)
+  {
+  uword len = 0;
+  
+  out[len] = '(';  ++len;
+  
+  const T a = val.real();
+  const T b = val.imag();
+  
+  if( (arma_isinf(a) == true) && (a > T(0)) )  { out[len] = '+'; ++len; }
+  
+  len += diskio::fast_txt_real(&out[len], a);
+  
+  out[len] = ',';  ++len;
+  
+  if( (arma_isinf(b) == true) && (b > T(0)) )  { out[len] = '+'; ++len; }
+  
+  len += diskio::fast_txt_real(&out[len], b);
+  
+  out[len] = ')';  ++len;
+  
+  return len;
+  }
+
+
+
+//! format rows [row_start, row_end) of a column-major array as text;
+//! returns the number of characters written
+template<typename eT>
+inline
+uword
+diskio::fast_txt_rows(char* out, const eT* mem, const uword n_rows, const uword n_cols, const uword row_start, const uword row_end, const char separator, const bool lead_separator)
+  {
+  uword len = 0;
+  
+  for(uword row = row_start; row < row_end; ++row)
+    {
+    const eT* mem_row = &mem[row];
+    
+    for(uword col=0; col < n_cols; ++col)
+      {
+      if( lead_separator || (col > 0) )  { out[len] = separator; ++len; }
+      
+      len += diskio::fast_txt_elem(&out[len], mem_row[col*n_rows]);
+      }
+    
+    out[len] = '\n';  ++len;
+    }
+  
+  return len;
+  }
+
+
+
+//! write a column-major array as text, one matrix row per line.
+//! rows are formatted in blocks into large buffers instead of going through the stream formatting machinery;
+//! if OpenMP is enabled, several blocks are formatted in parallel and then written in order
+template<typename eT>
+inline
+bool
+diskio::fast_txt_save(std::ostream& f, const eT* mem, const uword n_rows, const uword n_cols, const char separator, const bool lead_separator)
+  {
+  arma_extra_debug_sigprint();
+  
+  if( (n_rows == 0) || (n_cols == 0) )  { return f.good(); }
+  
+  const uword max_elem_len = (is_complex<eT>::value) ? 64 : 32;
+  
+  const uword rows_per_block = (std::max)( uword(1), uword(16384) / n_cols );
+  const uword n_blocks       = (n_rows + rows_per_block - 1) / rows_per_block;
+  const uword block_size     = rows_per_block * (n_cols * (max_elem_len + 1) + 1);
+
+  #if defined(_OPENMP)
+    {
+    const uword n_threads = (std::min)( n_blocks, uword( (std::max)(int(1), int(omp_get_max_threads())) ) );
+    
+    if(n_threads > 1)
+      {
+      podarray<char>  buffer(n_threads * block_size);
+      podarray<uword> lengths(n_threads);
+      
+      char* buffer_mem = buffer.memptr();
+      
+      for(uword block_start = 0; block_start < n_blocks; block_start += n_threads)
+        {
+        const uword block_end = (std::min)(block_start + n_threads, n_blocks);
+
+        #pragma omp parallel for schedule(static)
+        for(uword block = block_start; block < block_end; ++block)
+          {
+          const uword t         = block - block_start;
+          const uword row_start = block * rows_per_block;
+          const uword row_end   = (std::min)(row_start + rows_per_block, n_rows);
+          
+          lengths[t] = diskio::fast_txt_rows(&buffer_mem[t*block_size], mem, n_rows, n_cols, row_start, row_end, separator, lead_separator);
+          }
+        
+        for(uword t=0; t < (block_end - block_start); ++t)
+          {
+          f.write(&buffer_mem[t*block_size], std::streamsize(lengths[t]));
+          }
+        }
+      
+      return f.good();
+      }
+    }
+  #endif
+  
+  podarray<char> buffer(block_size);
+  
+  for(uword block=0; block < n_blocks; ++block)
+    {
+    const uword row_start = block * rows_per_block;
+    const uword row_end   = (std::min)(row_start + rows_per_block, n_rows);
+    
+    const uword len = diskio::fast_txt_rows(buffer.memptr(), mem, n_rows, n_cols, row_start, row_end, separator, lead_separator);
+    
+    f.write(buffer.memptr(), std::streamsize(len));
+    }
+  
+  return f.good();
+  }
+
+
+
 //! Save a matrix as raw text (no header, human readable).
 //! Matrices can be loaded in Matlab and Octave, as long as they don't have complex elements.
 template<typename eT>
@@ -797,35 +1018,7 @@ diskio::save_raw_ascii(const Mat<eT>& x, std::ostream& f)
   {
   arma_extra_debug_sigprint();
   
-  uword cell_width;
-  
-  // TODO: need sane values for complex numbers
-  
-  if( (is_float<eT>::value) || (is_double<eT>::value) )
-    {
-    f.setf(ios::scientific);
-    f.precision(12);
-    cell_width = 20;
-    }
-  
-  for(uword row=0; row < x.n_rows; ++row)
-    {
-    for(uword col=0; col < x.n_cols; ++col)
-      {
-      f.put(' ');
-      
-      if( (is_float<eT>::value) || (is_double<eT>::value) )
-        {
-        f.width(cell_width);
-        }
-      
-      arma_ostream::print_elem(f, x.at(row,col), false);
-      }
-      
-    f.put('\n');
-    }
-  
-  return f.good();
+  return diskio::fast_txt_save(f, x.memptr(), x.n_rows, x.n_cols, ' ', true);
   }
 
 
@@ -918,44 +1111,10 @@ diskio::save_arma_ascii(const Mat<eT>& x, std::ostream& f)
   {
   arma_extra_debug_sigprint();
   
-  const ios::fmtflags orig_flags = f.flags();
-  
   f << diskio::gen_txt_header(x) << '\n';
   f << x.n_rows << ' ' << x.n_cols << '\n';
   
-  uword cell_width;
-  
-  // TODO: need sane values for complex numbers
-  
-  if( (is_float<eT>::value) || (is_double<eT>::value) )
-    {
-    f.setf(ios::scientific);
-    f.precision(12);
-    cell_width = 20;
-    }
-    
-  for(uword row=0; row < x.n_rows; ++row)
-    {
-    for(uword col=0; col < x.n_cols; ++col)
-      {
-      f.put(' ');
-      
-      if( (is_float<eT>::value) || (is_double<eT>::value) )        
-        {
-        f.width(cell_width);
-        }
-      
-      arma_ostream::print_elem(f, x.at(row,col), false);
-      }
-    
-    f.put('\n');
-    }
-  
-  const bool save_okay = f.good();
-  
-  f.flags(orig_flags);
-  
-  return save_okay;
+  return diskio::fast_txt_save(f, x.memptr(), x.n_rows, x.n_cols, ' ', true);
   }
 
 
@@ -1000,39 +1159,7 @@ diskio::save_csv_ascii(const Mat<eT>& x, std::ostream& f)
   {
   arma_extra_debug_sigprint();
   
-  const ios::fmtflags orig_flags = f.flags();
-  
-  // TODO: need sane values for complex numbers
-  
-  if( (is_float<eT>::value) || (is_double<eT>::value) )
-    {
-    f.setf(ios::scientific);
-    f.precision(12);
-    }
-  
-  uword x_n_rows = x.n_rows;
-  uword x_n_cols = x.n_cols;
-  
-  for(uword row=0; row < x_n_rows; ++row)
-    {
-    for(uword col=0; col < x_n_cols; ++col)
-      {
-      arma_ostream::print_elem(f, x.at(row,col), false);
-      
-      if( col < (x_n_cols-1) )
-        {
-        f.put(',');
-        }
-      }
-    
-    f.put('\n');
-    }
-  
-  const bool save_okay = f.good();
-  
-  f.flags(orig_flags);
-  
-  return save_okay;
+  return diskio::fast_txt_save(f, x.memptr(), x.n_rows, x.n_cols, ',', false);
   }
 
 
@@ -2177,6 +2304,8 @@ diskio::load_auto_detect(Mat<eT>& x, std::istream& f, std::string& err_msg)
   static const std::string ARMA_MAT_TXT = "ARMA_MAT_TXT";
   static const std::string ARMA_MAT_BIN = "ARMA_MAT_BIN";
   static const std::string           P5 = "P5";
+  static const std::string          NPY = "\x93NUMPY";
+  static const std::string          NPZ = "PK\x03\x04";
   
   podarray<char> raw_header( uword(ARMA_MAT_TXT.length()) + 1);
   
@@ -2204,6 +2333,16 @@ diskio::load_auto_detect(Mat<eT>& x, std::istream& f, std::string& err_msg)
     {
     return load_pgm_binary(x, f, err_msg);
     }
+  else
+  if(NPY == header.substr(0,NPY.length()))
+    {
+    return load_npy_binary(x, f, err_msg);
+    }
+  else
+  if(NPZ == header.substr(0,NPZ.length()))
+    {
+    return load_npz_binary(x, f, err_msg);
+    }
   else
     {
     const file_type ft = guess_file_type(f);
@@ -2279,81 +2418,7 @@ diskio::save_coord_ascii(const SpMat<eT>& x, std::ostream& f)
   {
   arma_extra_debug_sigprint();
   
-  const ios::fmtflags orig_flags = f.flags();
-  
-  typename SpMat<eT>::const_iterator iter     = x.begin();
-  typename SpMat<eT>::const_iterator iter_end = x.end();
-  
-  for(; iter != iter_end; ++iter)
-    {
-    f.setf(ios::fixed);
-    
-    f << iter.row() << ' ' << iter.col() << ' ';
-    
-    if( (is_float<eT>::value) || (is_double<eT>::value) )
-      {
-      f.setf(ios::scientific);
-      f.precision(12);
-      }
-    
-    f << (*iter) << '\n';
-    }
-  
-  
-  // make sure it's possible to figure out the matrix size later
-  if( (x.n_rows > 0) && (x.n_cols > 0) )
-    {
-    const uword max_row = (x.n_rows > 0) ? x.n_rows-1 : 0;
-    const uword max_col = (x.n_cols > 0) ? x.n_cols-1 : 0;
-    
-    if( x.at(max_row, max_col) == eT(0) )
-      {
-      f.setf(ios::fixed);
-      
-      f << max_row << ' ' << max_col << " 0\n";
-      }
-    }
-  
-  const bool save_okay = f.good();
-  
-  f.flags(orig_flags);
-  
-  return save_okay;
-  }
-
-
-
-//! Save a matrix in ASCII coord format (complex numbers)
-template<typename T>
-inline
-bool
-diskio::save_coord_ascii(const SpMat< std::complex<T> >& x, std::ostream& f)
-  {
-  arma_extra_debug_sigprint();
-  
-  const ios::fmtflags orig_flags = f.flags();
-  
-  typedef typename std::complex<T> eT;
-  
-  typename SpMat<eT>::const_iterator iter     = x.begin();
-  typename SpMat<eT>::const_iterator iter_end = x.end();
-  
-  for(; iter != iter_end; ++iter)
-    {
-    f.setf(ios::fixed);
-    
-    f << iter.row() << ' ' << iter.col() << ' ';
-    
-    if( (is_float<T>::value) || (is_double<T>::value) )
-      {
-      f.setf(ios::scientific);
-      f.precision(12);
-      }
-    
-    const eT val = (*iter);
-    
-    f << val.real() << ' ' << val.imag() << '\n';
-    }
+  const bool save_okay = mtx_misc::write_entries(f, x, 0, 'g');
   
   // make sure it's possible to figure out the matrix size later
   if( (x.n_rows > 0) && (x.n_cols > 0) )
@@ -2363,17 +2428,11 @@ diskio::save_coord_ascii(const SpMat< std::complex<T> >& x, std::ostream& f)
     
     if( x.at(max_row, max_col) == eT(0) )
       {
-      f.setf(ios::fixed);
-      
-      f << max_row << ' ' << max_col << " 0 0\n";
+      f << max_row << ' ' << max_col << ( (is_complex<eT>::value) ? " 0 0\n" : " 0\n" );
       }
     }
   
-  const bool save_okay = f.good();
-  
-  f.flags(orig_flags);
-  
-  return save_okay;
+  return (save_okay && f.good());
   }
 
 
@@ -2432,25 +2491,85 @@ diskio::save_arma_binary(const SpMat<eT>& x, std::ostream& f)
 
 
 
+//! Save a matrix in Matrix Market co-ordinate format.
+//! Symmetric, skew-symmetric and hermitian matrices are detected and only their lower triangle is written.
 template<typename eT>
 inline
 bool
-diskio::load_coord_ascii(SpMat<eT>& x, const std::string& name, std::string& err_msg)
+diskio::save_mtx_ascii(const SpMat<eT>& x, const std::string& final_name)
   {
   arma_extra_debug_sigprint();
   
-  std::fstream f;
-  f.open(name.c_str(), std::fstream::in | std::fstream::binary);
+  const std::string tmp_name = diskio::gen_tmp_name(final_name);
   
-  bool load_okay = f.is_open();
+  std::ofstream f(tmp_name.c_str(), std::fstream::binary);
   
-  if(load_okay == true)
+  bool save_okay = f.is_open();
+  
+  if(save_okay == true)
     {
-    load_okay = diskio::load_coord_ascii(x, f, err_msg);
+    save_okay = diskio::save_mtx_ascii(x, f);
+    
+    f.flush();
     f.close();
+    
+    if(save_okay == true)
+      {
+      save_okay = diskio::safe_rename(tmp_name, final_name);
+      }
     }
   
-  return load_okay;
+  return save_okay;
+  }
+
+
+
+template<typename eT>
+inline
+bool
+diskio::save_mtx_ascii(const SpMat<eT>& x, std::ostream& f)
+  {
+  arma_extra_debug_sigprint();
+  
+  const char symmetry = mtx_misc::find_symmetry(x);
+  
+  uword n_written = 0;
+  
+  for(uword col=0; col < x.n_cols; ++col)
+    {
+    for(uword k = x.col_ptrs[col]; k < x.col_ptrs[col + 1]; ++k)
+      {
+      n_written += mtx_misc::is_written(x.row_indices[k], col, symmetry) ? uword(1) : uword(0);
+      }
+    }
+  
+  f << "%%MatrixMarket matrix coordinate " << mtx_misc::field_name<eT>() << ' ' << mtx_misc::symmetry_name(symmetry) << '\n';
+  f << x.n_rows << ' ' << x.n_cols << ' ' << n_written << '\n';
+  
+  return mtx_misc::write_entries(f, x, 1, symmetry);
+  }
+
+
+
+template<typename eT>
+inline
+bool
+diskio::load_coord_ascii(SpMat<eT>& x, const std::string& name, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  std::fstream f;
+  f.open(name.c_str(), std::fstream::in | std::fstream::binary);
+  
+  bool load_okay = f.is_open();
+  
+  if(load_okay == true)
+    {
+    load_okay = diskio::load_coord_ascii(x, f, err_msg);
+    f.close();
+    }
+  
+  return load_okay;
   }
 
 
@@ -2461,218 +2580,132 @@ bool
 diskio::load_coord_ascii(SpMat<eT>& x, std::istream& f, std::string& err_msg)
   {
   arma_extra_debug_sigprint();
-  arma_ignore(err_msg);
   
-  bool load_okay = f.good();
+  mtx_misc::layout L;
   
-  f.clear();
-  const std::fstream::pos_type pos1 = f.tellg();
+  L.is_mtx   = false;
+  L.field    = (is_complex<eT>::value) ? 'c' : 'r';
+  L.symmetry = 'g';
+  L.n_rows   = 0;
+  L.n_cols   = 0;
   
-  //
-  // work out the size
+  mtx_misc::coo_block<eT> all;
   
-  uword f_n_rows = 0;
-  uword f_n_cols = 0;
-  uword f_n_nz   = 0;
+  all.reset();
   
-  bool size_found = false;
+  const bool load_okay = mtx_misc::read_entries(f, L, all);
   
-  std::string       line_string;
-  std::string       token;
+  if(load_okay == false)
+    {
+    err_msg = "couldn't interpret data in ";
+    return false;
+    }
   
-  std::stringstream line_stream;
-  std::stringstream ss;
+  // the size is given by the largest indices, including those of entries with zero values
+  const uword f_n_rows = (all.n_lines > 0) ? (all.max_row + 1) : uword(0);
+  const uword f_n_cols = (all.n_lines > 0) ? (all.max_col + 1) : uword(0);
   
-  uword last_line_row = 0;
-  uword last_line_col = 0;
+  const uword N = uword(all.vals.size());
   
-  bool first_line   = true;
-  bool weird_format = false;
+  x.set_size(f_n_rows, f_n_cols);
   
+  // repeated locations overwrite earlier ones
+  x.init_batch_coo( (N > 0) ? &(all.rows[0]) : NULL, (N > 0) ? &(all.cols[0]) : NULL, (N > 0) ? &(all.vals[0]) : NULL, N, false );
   
-  while( (f.good() == true) && (load_okay == true) )
+  return true;
+  }
+
+
+
+template<typename eT>
+inline
+bool
+diskio::load_mtx_ascii(SpMat<eT>& x, const std::string& name, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  std::ifstream f;
+  f.open(name.c_str(), std::fstream::binary);
+  
+  bool load_okay = f.is_open();
+  
+  if(load_okay == true)
     {
-    std::getline(f, line_string);
-    
-    if(line_string.size() == 0)
-      {
-      break;
-      }
-    
-    line_stream.clear();
-    line_stream.str(line_string);
-    
-    uword line_row = 0;
-    uword line_col = 0;
-    
-    // a valid line in co-ord format has at least 2 entries
-    
-    line_stream >> line_row;
-    
-    if(line_stream.good() == false)
-      {
-      load_okay = false;
-      break;
-      }
-    
-    line_stream >> line_col;
-    
-    size_found = true;
-    
-    if(f_n_rows < line_row)  f_n_rows = line_row;
-    if(f_n_cols < line_col)  f_n_cols = line_col;
-    
-    if(first_line == true)
-      {
-      first_line = false;
-      }
-    else
-      {
-      if( (line_col < last_line_col) || ((line_row <= last_line_row) && (line_col <= last_line_col)) )
-        {
-        weird_format = true;
-        }
-      }
-    
-    last_line_row = line_row;
-    last_line_col = line_col;
-    
-    
-    if(line_stream.good() == true)
-      {
-      eT final_val = eT(0);
-      
-      line_stream >> token;
-      
-      if(line_stream.fail() == false)
-        {
-        eT val = eT(0);
-        
-        ss.clear();
-        ss.str(token);
-        
-        ss >> val;
-        
-        if(ss.fail() == false)
-          {
-          final_val = val;
-          }
-        else
-          {
-          val = eT(0);
-          
-          const bool success = diskio::convert_naninf( val, token );
-          
-          if(success == true)
-            {
-            final_val = val;
-            }
-          }
-        }
-      
-      if(final_val != eT(0))
-        {
-        ++f_n_nz;
-        }
-      }
+    load_okay = diskio::load_mtx_ascii(x, f, err_msg);
+    f.close();
+    }
+  
+  return load_okay;
+  }
+
+
+
+//! Load a matrix in Matrix Market co-ordinate format.
+//! Blocks of lines are parsed in parallel and the entries are then sorted into columns in one go.
+//! The entries of symmetric, skew-symmetric and hermitian matrices are expanded;
+//! repeated entries are added.
+template<typename eT>
+inline
+bool
+diskio::load_mtx_ascii(SpMat<eT>& x, std::istream& f, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  mtx_misc::layout L;
+  
+  uword f_n_nz = 0;
+  
+  if(mtx_misc::read_header(f, L, f_n_nz, err_msg) == false)  { return false; }
+  
+  if( (is_complex<eT>::value == false) && (L.field == 'c') )
+    {
+    err_msg = "complex data cannot be loaded into a real matrix from ";
+    return false;
     }
   
+  mtx_misc::coo_block<eT> all;
   
-  if(size_found == true)
+  all.reset();
+  
+  const uword n_reserve = (L.symmetry == 'g') ? f_n_nz : 2*f_n_nz;
+  
+  all.rows.reserve(n_reserve);
+  all.cols.reserve(n_reserve);
+  all.vals.reserve(n_reserve);
+  
+  if( (mtx_misc::read_entries(f, L, all) == false) || (all.n_lines != f_n_nz) )
     {
-    // take into account that indices start at 0
-    f_n_rows++;
-    f_n_cols++;
+    err_msg = "inconsistent data in ";
+    return false;
     }
   
+  const uword N = uword(all.vals.size());
+  
+  x.set_size(L.n_rows, L.n_cols);
+  
+  x.init_batch_coo( (N > 0) ? &(all.rows[0]) : NULL, (N > 0) ? &(all.cols[0]) : NULL, (N > 0) ? &(all.vals[0]) : NULL, N, true );
+  
+  return true;
+  }
+
+
+
+template<typename eT>
+inline
+bool
+diskio::load_mtx_ascii_lowmem(SpMat<eT>& x, const std::string& name, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  std::ifstream f;
+  f.open(name.c_str(), std::fstream::binary);
+  
+  bool load_okay = f.is_open();
   
   if(load_okay == true)
     {
-    f.clear();
-    f.seekg(pos1);
-    
-    x.set_size(f_n_rows, f_n_cols);
-    
-    if(weird_format == false)
-      {
-      x.mem_resize(f_n_nz);
-      }
-    
-    uword pos = 0;
-    
-    while(f.good() == true)
-      {
-      std::getline(f, line_string);
-      
-      if(line_string.size() == 0)
-        {
-        break;
-        }
-      
-      line_stream.clear();
-      line_stream.str(line_string);
-      
-      uword line_row = 0;
-      uword line_col = 0;
-      
-      line_stream >> line_row;
-      line_stream >> line_col;
-      
-      eT final_val = eT(0);
-      
-      line_stream >> token;
-      
-      if(line_stream.fail() == false)
-        {
-        eT val = eT(0);
-        
-        ss.clear();
-        ss.str(token);
-        
-        ss >> val;
-        
-        if(ss.fail() == false)
-          {
-          final_val = val;
-          }
-        else
-          {
-          val = eT(0);
-          
-          const bool success = diskio::convert_naninf( val, token );
-          
-          if(success == true)
-            {
-            final_val = val;
-            }
-          }
-        }
-      
-      
-      if(final_val != eT(0))
-        {
-        if(weird_format == false)
-          {
-          access::rw(x.row_indices[pos]) = line_row;
-          access::rw(x.values[pos])      = final_val;
-          ++access::rw(x.col_ptrs[line_col + 1]);
-          
-          ++pos;
-          }
-        else
-          {
-          x.at(line_row,line_col) = final_val;
-          }
-        }
-      }
-    
-    if(weird_format == false)
-      {
-      for(uword c = 1; c <= f_n_cols; ++c)
-        {
-        access::rw(x.col_ptrs[c]) += x.col_ptrs[c - 1];
-        }
-      }
+    load_okay = diskio::load_mtx_ascii_lowmem(x, f, err_msg);
+    f.close();
     }
   
   return load_okay;
@@ -2680,292 +2713,135 @@ diskio::load_coord_ascii(SpMat<eT>& x, std::istream& f, std::string& err_msg)
 
 
 
-template<typename T>
+//! Load a matrix in Matrix Market co-ordinate format, using two passes over the stream.
+//! The first pass counts the entries in each column; the second pass places the entries
+//! directly into the final storage. Only one block of the file is held in memory at a time,
+//! so files larger than the available memory can be loaded. The stream must be seekable.
+template<typename eT>
 inline
 bool
-diskio::load_coord_ascii(SpMat< std::complex<T> >& x, std::istream& f, std::string& err_msg)
+diskio::load_mtx_ascii_lowmem(SpMat<eT>& x, std::istream& f, std::string& err_msg)
   {
   arma_extra_debug_sigprint();
-  arma_ignore(err_msg);
   
-  bool load_okay = f.good();
+  mtx_misc::layout L;
   
-  f.clear();
-  const std::fstream::pos_type pos1 = f.tellg();
+  uword f_n_nz = 0;
   
-  //
-  // work out the size
+  if(mtx_misc::read_header(f, L, f_n_nz, err_msg) == false)  { return false; }
   
-  uword f_n_rows = 0;
-  uword f_n_cols = 0;
-  uword f_n_nz   = 0;
+  if( (is_complex<eT>::value == false) && (L.field == 'c') )
+    {
+    err_msg = "complex data cannot be loaded into a real matrix from ";
+    return false;
+    }
   
-  bool size_found = false;
+  const std::streampos data_pos = f.tellg();
   
-  std::string line_string;
-  std::string token_real;
-  std::string token_imag;
+  if(data_pos == std::streampos(-1))
+    {
+    err_msg = "cannot seek in ";
+    return false;
+    }
   
-  std::stringstream line_stream;
-  std::stringstream ss;
+  // set_size() keeps the existing column pointers if the size is unchanged, but they must start at zero
+  x.zeros(L.n_rows, L.n_cols);
   
-  uword last_line_row = 0;
-  uword last_line_col = 0;
+  uword* col_ptrs = access::rwp(x.col_ptrs);
   
-  bool first_line   = true;
-  bool weird_format = false;
+  std::vector< mtx_misc::coo_block<eT> > blocks( mtx_misc::get_n_threads() );
   
-  while( (f.good() == true) && (load_okay == true) )
+  const char* begin = NULL;
+  const char* end   = NULL;
+  
+  uword n_lines = 0;
+  
+  // first pass: count the entries in each column
     {
-    std::getline(f, line_string);
+    mtx_misc::line_reader reader(f);
     
-    if(line_string.size() == 0)
+    while(reader.next(begin, end))
       {
-      break;
-      }
-    
-    line_stream.clear();
-    line_stream.str(line_string);
-    
-    uword line_row = 0;
-    uword line_col = 0;
-    
-    // a valid line in co-ord format has at least 2 entries
-    
-    line_stream >> line_row;
-    
-    if(line_stream.good() == false)
-      {
-      load_okay = false;
-      break;
-      }
-    
-    line_stream >> line_col;
-    
-    size_found = true;
-    
-    if(f_n_rows < line_row)  f_n_rows = line_row;
-    if(f_n_cols < line_col)  f_n_cols = line_col;
-    
-    
-    if(first_line == true)
-      {
-      first_line = false;
-      }
-    else
-      {
-      if( (line_col < last_line_col) || ((line_row <= last_line_row) && (line_col <= last_line_col)) )
-        {
-        weird_format = true;
-        }
-      }
-    
-    last_line_row = line_row;
-    last_line_col = line_col;
-    
-    
-    if(line_stream.good() == true)
-      {
-      T final_val_real = T(0);
-      T final_val_imag = T(0);
-      
-      
-      line_stream >> token_real;
+      mtx_misc::parse_block(begin, end, L, false, blocks);
       
-      if(line_stream.fail() == false)
+      for(uword i=0; i < blocks.size(); ++i)
         {
-        T val_real = T(0);
+        const mtx_misc::coo_block<eT>& blk = blocks[i];
         
-        ss.clear();
-        ss.str(token_real);
-        
-        ss >> val_real;
-        
-        if(ss.fail() == false)
-          {
-          final_val_real = val_real;
-          }
-        else
-          {
-          val_real = T(0);
-          
-          const bool success = diskio::convert_naninf( val_real, token_real );
-          
-          if(success == true)
-            {
-            final_val_real = val_real;
-            }
-          }
-        }
-      
-      
-      line_stream >> token_imag;
-      
-      if(line_stream.fail() == false)
-        {
-        T val_imag = T(0);
+        if(blk.ok == false)  { err_msg = "inconsistent data in "; return false; }
         
-        ss.clear();
-        ss.str(token_imag);
+        const uword* blk_cols = (blk.cols.empty()) ? NULL : &(blk.cols[0]);
+        const uword  blk_N    = uword(blk.cols.size());
         
-        ss >> val_imag;
+        for(uword j=0; j < blk_N; ++j)  { ++col_ptrs[ blk_cols[j] + 1 ]; }
         
-        if(ss.fail() == false)
-          {
-          final_val_imag = val_imag;
-          }
-        else
-          {
-          val_imag = T(0);
-          
-          const bool success = diskio::convert_naninf( val_imag, token_imag );
-          
-          if(success == true)
-            {
-            final_val_imag = val_imag;
-            }
-          }
-        }
-      
-      
-      if( (final_val_real != T(0)) || (final_val_imag != T(0)) )
-        {
-        ++f_n_nz;
+        n_lines += blk.n_lines;
         }
       }
     }
   
-  
-  if(size_found == true)
+  if(n_lines != f_n_nz)
     {
-    // take into account that indices start at 0
-    f_n_rows++;
-    f_n_cols++;
+    err_msg = "inconsistent data in ";
+    return false;
     }
   
+  for(uword c=0; c < L.n_cols; ++c)  { col_ptrs[c + 1] += col_ptrs[c]; }
   
-  if(load_okay == true)
+  x.mem_resize(col_ptrs[L.n_cols]);
+  
+  podarray<uword> fill(L.n_cols);
+  
+  arrayops::copy(fill.memptr(), col_ptrs, L.n_cols);
+  
+  uword* fill_mem = fill.memptr();
+  
+  eT*    values      = access::rwp(x.values);
+  uword* row_indices = access::rwp(x.row_indices);
+  
+  f.clear();
+  f.seekg(data_pos);
+  
+  // second pass: place the entries into their columns
     {
-    f.clear();
-    f.seekg(pos1);
-    
-    x.set_size(f_n_rows, f_n_cols);
-    
-    if(weird_format == false)
-      {
-      x.mem_resize(f_n_nz);
-      }
+    mtx_misc::line_reader reader(f);
     
-    uword pos = 0;
-    
-    while(f.good() == true)
+    while(reader.next(begin, end))
       {
-      std::getline(f, line_string);
-      
-      if(line_string.size() == 0)
-        {
-        break;
-        }
-      
-      line_stream.clear();
-      line_stream.str(line_string);
-      
-      uword line_row = 0;
-      uword line_col = 0;
-      
-      line_stream >> line_row;
-      line_stream >> line_col;
-      
-      T final_val_real = T(0);
-      T final_val_imag = T(0);
-      
-      
-      line_stream >> token_real;
-      
-      if(line_stream.fail() == false)
-        {
-        T val_real = T(0);
-        
-        ss.clear();
-        ss.str(token_real);
-        
-        ss >> val_real;
-        
-        if(ss.fail() == false)
-          {
-          final_val_real = val_real;
-          }
-        else
-          {
-          val_real = T(0);
-          
-          const bool success = diskio::convert_naninf( val_real, token_real );
-          
-          if(success == true)
-            {
-            final_val_real = val_real;
-            }
-          }
-        }
-      
-      
-      line_stream >> token_imag;
+      mtx_misc::parse_block(begin, end, L, true, blocks);
       
-      if(line_stream.fail() == false)
+      for(uword i=0; i < blocks.size(); ++i)
         {
-        T val_imag = T(0);
+        const mtx_misc::coo_block<eT>& blk = blocks[i];
         
-        ss.clear();
-        ss.str(token_imag);
+        if(blk.ok == false)  { err_msg = "inconsistent data in "; return false; }
         
-        ss >> val_imag;
+        const uword N = uword(blk.vals.size());
         
-        if(ss.fail() == false)
-          {
-          final_val_imag = val_imag;
-          }
-        else
+        for(uword j=0; j < N; ++j)
           {
-          val_imag = T(0);
+          const uword col = blk.cols[j];
           
-          const bool success = diskio::convert_naninf( val_imag, token_imag );
+          // guard against a file which has changed between the passes
+          if(fill_mem[col] >= col_ptrs[col + 1])  { err_msg = "inconsistent data in "; return false; }
           
-          if(success == true)
-            {
-            final_val_imag = val_imag;
-            }
-          }
-        }
-      
-      
-      if( (final_val_real != T(0)) || (final_val_imag != T(0)) )
-        {
-        if(weird_format == false)
-          {
-          access::rw(x.row_indices[pos]) = line_row;
-          access::rw(x.values[pos])      = std::complex<T>(final_val_real, final_val_imag);
-          ++access::rw(x.col_ptrs[line_col + 1]);
+          const uword k = fill_mem[col]++;
           
-          ++pos;
-          }
-        else
-          {
-          x.at(line_row,line_col) = std::complex<T>(final_val_real, final_val_imag);
+          row_indices[k] = blk.rows[j];
+          values[k]      = blk.vals[j];
           }
         }
       }
-    
-    
-    if(weird_format == false)
-      {
-      for(uword c = 1; c <= f_n_cols; ++c)
-        {
-        access::rw(x.col_ptrs[c]) += x.col_ptrs[c - 1];
-        }
-      }
     }
   
-  return load_okay;
+  for(uword c=0; c < L.n_cols; ++c)
+    {
+    if(fill_mem[c] != col_ptrs[c + 1])  { err_msg = "inconsistent data in "; return false; }
+    }
+  
+  x.sort_and_merge(true);
+  
+  return true;
   }
 
 
@@ -3073,48 +2949,961 @@ diskio::load_arma_binary(SpMat<eT>& x, std::istream& f, std::string& err_msg)
         }
       }
     
-    if((check1 == false) || (check2 == false) || (check3 == false))
-      {
-      load_okay = false;
-      err_msg = "inconsistent data in ";
-      }
-    else
+    if((check1 == false) || (check2 == false) || (check3 == false))
+      {
+      load_okay = false;
+      err_msg = "inconsistent data in ";
+      }
+    else
+      {
+      load_okay = f.good();
+      }
+    }
+  else
+    {
+    load_okay = false;
+    err_msg = "incorrect header in ";
+    }
+
+  return load_okay;
+  }
+
+
+
+// cubes
+
+
+
+//! Save a cube as raw text (no header, human readable).
+template<typename eT>
+inline
+bool
+diskio::save_raw_ascii(const Cube<eT>& x, const std::string& final_name)
+  {
+  arma_extra_debug_sigprint();
+  
+  const std::string tmp_name = diskio::gen_tmp_name(final_name);
+  
+  std::fstream f(tmp_name.c_str(), std::fstream::out);
+  
+  bool save_okay = f.is_open();
+  
+  if(save_okay == true)
+    {
+    save_okay = save_raw_ascii(x, f);
+    
+    f.flush();
+    f.close();
+    
+    if(save_okay == true)
+      {
+      save_okay = diskio::safe_rename(tmp_name, final_name);
+      }
+    }
+  
+  return save_okay;
+  }
+
+
+
+//! Save a cube as raw text (no header, human readable).
+template<typename eT>
+inline
+bool
+diskio::save_raw_ascii(const Cube<eT>& x, std::ostream& f)
+  {
+  arma_extra_debug_sigprint();
+  
+  for(uword slice=0; slice < x.n_slices; ++slice)
+    {
+    diskio::fast_txt_save(f, x.slice_memptr(slice), x.n_rows, x.n_cols, ' ', true);
+    }
+  
+  return f.good();
+  }
+
+
+
+//! Save a cube as raw binary (no header)
+template<typename eT>
+inline
+bool
+diskio::save_raw_binary(const Cube<eT>& x, const std::string& final_name)
+  {
+  arma_extra_debug_sigprint();
+  
+  const std::string tmp_name = diskio::gen_tmp_name(final_name);
+  
+  std::ofstream f(tmp_name.c_str(), std::fstream::binary);
+  
+  bool save_okay = f.is_open();
+  
+  if(save_okay == true)
+    {
+    save_okay = diskio::save_raw_binary(x, f);
+    
+    f.flush();
+    f.close();
+    
+    if(save_okay == true)
+      {
+      save_okay = diskio::safe_rename(tmp_name, final_name);
+      }
+    }
+  
+  return save_okay;
+  }
+
+
+
+template<typename eT>
+inline
+bool
+diskio::save_raw_binary(const Cube<eT>& x, std::ostream& f)
+  {
+  arma_extra_debug_sigprint();
+  
+  f.write( reinterpret_cast<const char*>(x.mem), std::streamsize(x.n_elem*sizeof(eT)) );
+  
+  return f.good();
+  }
+
+
+
+//! Save a cube in text format (human readable),
+//! with a header that indicates the cube type as well as its dimensions
+template<typename eT>
+inline
+bool
+diskio::save_arma_ascii(const Cube<eT>& x, const std::string& final_name)
+  {
+  arma_extra_debug_sigprint();
+  
+  const std::string tmp_name = diskio::gen_tmp_name(final_name);
+  
+  std::ofstream f(tmp_name.c_str());
+  
+  bool save_okay = f.is_open();
+  
+  if(save_okay == true)
+    {
+    save_okay = diskio::save_arma_ascii(x, f);
+    
+    f.flush();
+    f.close();
+    
+    if(save_okay == true)
+      {
+      save_okay = diskio::safe_rename(tmp_name, final_name);
+      }
+    }
+  
+  return save_okay;
+  }
+
+
+
+//! Save a cube in text format (human readable),
+//! with a header that indicates the cube type as well as its dimensions
+template<typename eT>
+inline
+bool
+diskio::save_arma_ascii(const Cube<eT>& x, std::ostream& f)
+  {
+  arma_extra_debug_sigprint();
+  
+  f << diskio::gen_txt_header(x) << '\n';
+  f << x.n_rows << ' ' << x.n_cols << ' ' << x.n_slices << '\n';
+  
+  for(uword slice=0; slice < x.n_slices; ++slice)
+    {
+    diskio::fast_txt_save(f, x.slice_memptr(slice), x.n_rows, x.n_cols, ' ', true);
+    }
+  
+  return f.good();
+  }
+
+
+
+//! Save a cube in binary format,
+//! with a header that stores the cube type as well as its dimensions
+template<typename eT>
+inline
+bool
+diskio::save_arma_binary(const Cube<eT>& x, const std::string& final_name)
+  {
+  arma_extra_debug_sigprint();
+  
+  const std::string tmp_name = diskio::gen_tmp_name(final_name);
+  
+  std::ofstream f(tmp_name.c_str(), std::fstream::binary);
+  
+  bool save_okay = f.is_open();
+  
+  if(save_okay == true)
+    {
+    save_okay = diskio::save_arma_binary(x, f);
+    
+    f.flush();
+    f.close();
+    
+    if(save_okay == true)
+      {
+      save_okay = diskio::safe_rename(tmp_name, final_name);
+      }
+    }
+  
+  return save_okay;
+  }
+
+
+
+//! Save a cube in binary format,
+//! with a header that stores the cube type as well as its dimensions
+template<typename eT>
+inline
+bool
+diskio::save_arma_binary(const Cube<eT>& x, std::ostream& f)
+  {
+  arma_extra_debug_sigprint();
+  
+  f << diskio::gen_bin_header(x) << '\n';
+  f << x.n_rows << ' ' << x.n_cols << ' ' << x.n_slices << '\n';
+  
+  f.write( reinterpret_cast<const char*>(x.mem), std::streamsize(x.n_elem*sizeof(eT)) );
+  
+  return f.good();
+  }
+
+
+
+//! Save a cube as part of a HDF5 file
+template<typename eT>
+inline
+bool
+diskio::save_hdf5_binary(const Cube<eT>& x, const std::string& final_name)
+  {
+  arma_extra_debug_sigprint();
+
+  #if defined(ARMA_USE_HDF5)
+    {
+    #if !defined(ARMA_PRINT_HDF5_ERRORS)
+      {
+      // Disable annoying HDF5 error messages.
+      arma_H5Eset_auto(H5E_DEFAULT, NULL, NULL);
+      }
+    #endif
+
+    bool save_okay = false;
+
+    const std::string tmp_name = diskio::gen_tmp_name(final_name);
+
+    // Set up the file according to HDF5's preferences
+    hid_t file = arma_H5Fcreate(tmp_name.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+
+    // We need to create a dataset, datatype, and dataspace
+    hsize_t dims[3];
+    dims[2] = x.n_rows;
+    dims[1] = x.n_cols;
+    dims[0] = x.n_slices;
+
+    hid_t dataspace = arma_H5Screate_simple(3, dims, NULL);   // treat the cube as a 3d array dataspace
+    hid_t datatype  = hdf5_misc::get_hdf5_type<eT>();
+
+    // If this returned something invalid, well, it's time to crash.
+    arma_check(datatype == -1, "Cube::save(): unknown datatype for HDF5");
+
+    // MATLAB forces the users to specify a name at save time for HDF5; Octave
+    // will use the default of 'dataset' unless otherwise specified, so we will
+    // use that.
+    hid_t dataset = arma_H5Dcreate(file, "dataset", datatype, dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+    herr_t status = arma_H5Dwrite(dataset, datatype, H5S_ALL, H5S_ALL, H5P_DEFAULT, x.mem);
+    save_okay = (status >= 0);
+
+    arma_H5Dclose(dataset);
+    arma_H5Tclose(datatype);
+    arma_H5Sclose(dataspace);
+    arma_H5Fclose(file);
+
+    if(save_okay == true) { save_okay = diskio::safe_rename(tmp_name, final_name); }
+
+    return save_okay;
+    }
+  #else
+    {
+    arma_ignore(x);
+    arma_ignore(final_name);
+
+    arma_stop("Cube::save(): use of HDF5 needs to be enabled");
+
+    return false;
+    }
+  #endif
+  }
+
+
+
+//! Load a cube as raw text (no header, human readable).
+//! NOTE: this is much slower than reading a file with a header.
+template<typename eT>
+inline
+bool
+diskio::load_raw_ascii(Cube<eT>& x, const std::string& name, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  Mat<eT> tmp;
+  const bool load_okay = diskio::load_raw_ascii(tmp, name, err_msg);
+  
+  if(load_okay == true)
+    {
+    if(tmp.is_empty() == false)
+      {
+      x.set_size(tmp.n_rows, tmp.n_cols, 1);
+      
+      x.slice(0) = tmp;
+      }
+    else
+      {
+      x.reset();
+      }
+    }
+  
+  return load_okay;
+  }
+
+
+
+//! Load a cube as raw text (no header, human readable).
+//! NOTE: this is much slower than reading a file with a header.
+template<typename eT>
+inline
+bool
+diskio::load_raw_ascii(Cube<eT>& x, std::istream& f, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  Mat<eT> tmp;
+  const bool load_okay = diskio::load_raw_ascii(tmp, f, err_msg);
+  
+  if(load_okay == true)
+    {
+    if(tmp.is_empty() == false)
+      {
+      x.set_size(tmp.n_rows, tmp.n_cols, 1);
+      
+      x.slice(0) = tmp;
+      }
+    else
+      {
+      x.reset();
+      }
+    }
+  
+  return load_okay;
+  }
+
+
+
+//! Load a cube in binary format (no header);
+//! the cube is assumed to have one slice with one column
+template<typename eT>
+inline
+bool
+diskio::load_raw_binary(Cube<eT>& x, const std::string& name, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  std::ifstream f;
+  f.open(name.c_str(), std::fstream::binary);
+  
+  bool load_okay = f.is_open();
+  
+  if(load_okay == true)
+    {
+    load_okay = diskio::load_raw_binary(x, f, err_msg);
+    f.close();
+    }
+  
+  return load_okay;
+  }
+
+
+
+template<typename eT>
+inline
+bool
+diskio::load_raw_binary(Cube<eT>& x, std::istream& f, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(err_msg);
+  
+  f.clear();
+  const std::streampos pos1 = f.tellg();
+  
+  f.clear();
+  f.seekg(0, ios::end);
+  
+  f.clear();
+  const std::streampos pos2 = f.tellg();
+  
+  const uword N = ( (pos1 >= 0) && (pos2 >= 0) ) ? uword(pos2 - pos1) : 0;
+  
+  f.clear();
+  //f.seekg(0, ios::beg);
+  f.seekg(pos1);
+  
+  x.set_size(N / sizeof(eT), 1, 1);
+  
+  f.clear();
+  f.read( reinterpret_cast<char *>(x.memptr()), std::streamsize(N) );
+  
+  return f.good();
+  }
+
+
+
+//! Load a cube in text format (human readable),
+//! with a header that indicates the cube type as well as its dimensions
+template<typename eT>
+inline
+bool
+diskio::load_arma_ascii(Cube<eT>& x, const std::string& name, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  std::ifstream f(name.c_str());
+  
+  bool load_okay = f.is_open();
+  
+  if(load_okay == true)
+    {
+    load_okay = diskio::load_arma_ascii(x, f, err_msg);
+    f.close();
+    }
+  
+  return load_okay;
+  }
+  
+
+
+//! Load a cube in text format (human readable),
+//! with a header that indicates the cube type as well as its dimensions
+template<typename eT>
+inline
+bool
+diskio::load_arma_ascii(Cube<eT>& x, std::istream& f, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  std::streampos pos = f.tellg();
+    
+  bool load_okay = true;
+  
+  std::string f_header;
+  uword f_n_rows;
+  uword f_n_cols;
+  uword f_n_slices;
+  
+  f >> f_header;
+  f >> f_n_rows;
+  f >> f_n_cols;
+  f >> f_n_slices;
+  
+  if(f_header == diskio::gen_txt_header(x))
+    {
+    x.set_size(f_n_rows, f_n_cols, f_n_slices);
+
+    for(uword slice=0; slice < x.n_slices; ++slice)
+      {
+      for(uword row=0; row < x.n_rows; ++row)
+        {
+        for(uword col=0; col < x.n_cols; ++col)
+          {
+          f >> x.at(row,col,slice);
+          }
+        }
+      }
+    
+    load_okay = f.good();
+    }
+  else
+    {
+    load_okay = false;
+    err_msg = "incorrect header in ";
+    }
+  
+  
+  // allow automatic conversion of u32/s32 cubes into u64/s64 cubes
+  
+  if(load_okay == false)
+    {
+    if( (sizeof(eT) == 8) && is_same_type<uword,eT>::yes )
+      {
+      Cube<u32>   tmp;
+      std::string junk;
+      
+      f.clear();
+      f.seekg(pos);
+      
+      load_okay = diskio::load_arma_ascii(tmp, f, junk);
+      
+      if(load_okay)  { x = conv_to< Cube<eT> >::from(tmp); }
+      }
+    else
+    if( (sizeof(eT) == 8) && is_same_type<sword,eT>::yes )
+      {
+      Cube<s32>   tmp;
+      std::string junk;
+      
+      f.clear();
+      f.seekg(pos);
+      
+      load_okay = diskio::load_arma_ascii(tmp, f, junk);
+      
+      if(load_okay)  { x = conv_to< Cube<eT> >::from(tmp); }
+      }
+    }
+  
+  return load_okay;
+  }
+
+
+
+//! Load a cube in binary format,
+//! with a header that indicates the cube type as well as its dimensions
+template<typename eT>
+inline
+bool
+diskio::load_arma_binary(Cube<eT>& x, const std::string& name, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  std::ifstream f;
+  f.open(name.c_str(), std::fstream::binary);
+  
+  bool load_okay = f.is_open();
+  
+  if(load_okay == true)
+    {
+    load_okay = diskio::load_arma_binary(x, f, err_msg);
+    f.close();
+    }
+  
+  return load_okay;
+  }
+
+
+
+template<typename eT>
+inline
+bool
+diskio::load_arma_binary(Cube<eT>& x, std::istream& f, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  std::streampos pos = f.tellg();
+    
+  bool load_okay = true;
+  
+  std::string f_header;
+  uword f_n_rows;
+  uword f_n_cols;
+  uword f_n_slices;
+  
+  f >> f_header;
+  f >> f_n_rows;
+  f >> f_n_cols;
+  f >> f_n_slices;
+  
+  if(f_header == diskio::gen_bin_header(x))
+    {
+    //f.seekg(1, ios::cur);  // NOTE: this may not be portable, as on a Windows machine a newline could be two characters
+    f.get();
+    
+    x.set_size(f_n_rows, f_n_cols, f_n_slices);
+    f.read( reinterpret_cast<char *>(x.memptr()), std::streamsize(x.n_elem*sizeof(eT)) );
+    
+    load_okay = f.good();
+    }
+  else
+    {
+    load_okay = false;
+    err_msg = "incorrect header in ";
+    }
+  
+  
+  // allow automatic conversion of u32/s32 cubes into u64/s64 cubes
+  
+  if(load_okay == false)
+    {
+    if( (sizeof(eT) == 8) && is_same_type<uword,eT>::yes )
+      {
+      Cube<u32>   tmp;
+      std::string junk;
+      
+      f.clear();
+      f.seekg(pos);
+      
+      load_okay = diskio::load_arma_binary(tmp, f, junk);
+      
+      if(load_okay)  { x = conv_to< Cube<eT> >::from(tmp); }
+      }
+    else
+    if( (sizeof(eT) == 8) && is_same_type<sword,eT>::yes )
+      {
+      Cube<s32>   tmp;
+      std::string junk;
+      
+      f.clear();
+      f.seekg(pos);
+      
+      load_okay = diskio::load_arma_binary(tmp, f, junk);
+      
+      if(load_okay)  { x = conv_to< Cube<eT> >::from(tmp); }
+      }
+    }
+  
+  return load_okay;
+  }
+
+
+
+//! Load a HDF5 file as a cube
+template<typename eT>
+inline
+bool
+diskio::load_hdf5_binary(Cube<eT>& x, const std::string& name, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+
+  #if defined(ARMA_USE_HDF5)
+    {
+
+    // These may be necessary to store the error handler (if we need to).
+    herr_t (*old_func)(hid_t, void*);
+    void *old_client_data;
+
+    #if !defined(ARMA_PRINT_HDF5_ERRORS)
+      {
+      // Save old error handler.
+      arma_H5Eget_auto(H5E_DEFAULT, &old_func, &old_client_data);
+
+      // Disable annoying HDF5 error messages.
+      arma_H5Eset_auto(H5E_DEFAULT, NULL, NULL);
+      }
+    #endif
+
+    bool load_okay = false;
+
+    hid_t fid = arma_H5Fopen(name.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+
+    if(fid >= 0)
+      {
+      // MATLAB HDF5 dataset names are user-specified;
+      // Octave tends to store the datasets in a group, with the actual dataset being referred to as "value".
+      // So we will search for "dataset" and "value", and if those are not found we will take the first dataset we do find.
+      std::vector<std::string> searchNames;
+      searchNames.push_back("dataset");
+      searchNames.push_back("value");
+
+      hid_t dataset = hdf5_misc::search_hdf5_file(searchNames, fid, 3, false);
+
+      if(dataset >= 0)
+        {
+        hid_t filespace = arma_H5Dget_space(dataset);
+
+        // This must be <= 3 due to our search rules.
+        const int ndims = arma_H5Sget_simple_extent_ndims(filespace);
+
+        hsize_t dims[3];
+        const herr_t query_status = arma_H5Sget_simple_extent_dims(filespace, dims, NULL);
+
+        // arma_check(query_status < 0, "Cube::load(): cannot get size of HDF5 dataset");
+        if(query_status < 0)
+          {
+          err_msg = "cannot get size of HDF5 dataset in ";
+
+          arma_H5Sclose(filespace);
+          arma_H5Dclose(dataset);
+          arma_H5Fclose(fid);
+
+          #if !defined(ARMA_PRINT_HDF5_ERRORS)
+            {
+            // Restore HDF5 error handler.
+            arma_H5Eset_auto(H5E_DEFAULT, old_func, old_client_data);
+            }
+          #endif
+
+          return false;
+          }
+
+        if (ndims == 1) { dims[1] = 1; dims[2] = 1; }  // Vector case; one row/colum, several slices
+        if (ndims == 2) { dims[2] = 1; } // Matrix case; one column, several rows/slices
+
+        x.set_size(dims[2], dims[1], dims[0]);
+
+        // Now we have to see what type is stored to figure out how to load it.
+        hid_t datatype = arma_H5Dget_type(dataset);
+        hid_t mat_type = hdf5_misc::get_hdf5_type<eT>();
+
+        // If these are the same type, it is simple.
+        if(arma_H5Tequal(datatype, mat_type) > 0)
+          {
+          // Load directly; H5S_ALL used so that we load the entire dataset.
+          hid_t read_status = arma_H5Dread(dataset, datatype, H5S_ALL, H5S_ALL, H5P_DEFAULT, void_ptr(x.memptr()));
+
+          if(read_status >= 0) { load_okay = true; }
+          }
+        else
+          {
+          // Load into another array and convert its type accordingly.
+          hid_t read_status = hdf5_misc::load_and_convert_hdf5(x.memptr(), dataset, datatype, x.n_elem);
+
+          if(read_status >= 0) { load_okay = true; }
+          }
+
+        // Now clean up.
+        arma_H5Tclose(datatype);
+        arma_H5Tclose(mat_type);
+        arma_H5Sclose(filespace);
+        }
+
+      arma_H5Dclose(dataset);
+
+      arma_H5Fclose(fid);
+
+      if(load_okay == false)
+        {
+        err_msg = "unsupported or incorrect HDF5 data in ";
+        }
+      }
+    else
+      {
+      err_msg = "cannot open file ";
+      }
+
+    #if !defined(ARMA_PRINT_HDF5_ERRORS)
+      {
+      // Restore HDF5 error handler.
+      arma_H5Eset_auto(H5E_DEFAULT, old_func, old_client_data);
+      }
+    #endif
+
+    return load_okay;
+    }
+  #else
+    {
+    arma_ignore(x);
+    arma_ignore(name);
+    arma_ignore(err_msg);
+
+    arma_stop("Cube::load(): use of HDF5 needs to be enabled");
+
+    return false;
+    }
+  #endif
+  }
+
+
+
+//! Try to load a cube by automatically determining its type
+template<typename eT>
+inline
+bool
+diskio::load_auto_detect(Cube<eT>& x, const std::string& name, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  #if defined(ARMA_USE_HDF5)
+    // We're currently using the C bindings for the HDF5 library, which don't support C++ streams
+    if( arma_H5Fis_hdf5(name.c_str()) ) { return load_hdf5_binary(x, name, err_msg); }
+  #endif
+
+  std::fstream f;
+  f.open(name.c_str(), std::fstream::in | std::fstream::binary);
+  
+  bool load_okay = f.is_open();
+  
+  if(load_okay == true)
+    {
+    load_okay = diskio::load_auto_detect(x, f, err_msg);
+    f.close();
+    }
+  
+  return load_okay;
+  }
+
+
+
+//! Try to load a cube by automatically determining its type
+template<typename eT>
+inline
+bool
+diskio::load_auto_detect(Cube<eT>& x, std::istream& f, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  static const std::string ARMA_CUB_TXT = "ARMA_CUB_TXT";
+  static const std::string ARMA_CUB_BIN = "ARMA_CUB_BIN";
+  static const std::string           P6 = "P6";
+  static const std::string          NPY = "\x93NUMPY";
+  static const std::string          NPZ = "PK\x03\x04";
+  
+  podarray<char> raw_header(uword(ARMA_CUB_TXT.length()) + 1);
+  
+  std::streampos pos = f.tellg();
+  
+  f.read( raw_header.memptr(), std::streamsize(ARMA_CUB_TXT.length()) );
+  raw_header[uword(ARMA_CUB_TXT.length())] = '\0';
+  
+  f.clear();
+  f.seekg(pos);
+  
+  const std::string header = raw_header.mem;
+  
+  if(ARMA_CUB_TXT == header.substr(0, ARMA_CUB_TXT.length()))
+    {
+    return load_arma_ascii(x, f, err_msg);
+    }
+  else
+  if(ARMA_CUB_BIN == header.substr(0, ARMA_CUB_BIN.length()))
+    {
+    return load_arma_binary(x, f, err_msg);
+    }
+  else
+  if(P6 == header.substr(0, P6.length()))
+    {
+    return load_ppm_binary(x, f, err_msg);
+    }
+  else
+  if(NPY == header.substr(0, NPY.length()))
+    {
+    return load_npy_binary(x, f, err_msg);
+    }
+  else
+  if(NPZ == header.substr(0, NPZ.length()))
+    {
+    return load_npz_binary(x, f, err_msg);
+    }
+  else
+    {
+    const file_type ft = guess_file_type(f);
+    
+    switch(ft)
+      {
+      // case csv_ascii:
+      //   return load_csv_ascii(x, f, err_msg);
+      //   break;
+      
+      case raw_binary:
+        return load_raw_binary(x, f, err_msg);
+        break;
+        
+      case raw_ascii:
+        return load_raw_ascii(x, f, err_msg);
+        break;
+        
+      default:
+        err_msg = "unknown data in ";
+        return false;
+      }
+    }
+  
+  return false;
+  }
+
+
+
+
+
+//
+// NumPy .npy files and .npz archives
+
+
+
+//! Save a matrix in NumPy .npy format (Fortran order)
+template<typename eT>
+inline
+bool
+diskio::save_npy_binary(const Mat<eT>& x, const std::string& final_name)
+  {
+  arma_extra_debug_sigprint();
+  
+  const std::string tmp_name = diskio::gen_tmp_name(final_name);
+  
+  std::ofstream f( tmp_name.c_str(), std::fstream::binary );
+  
+  bool save_okay = f.is_open();
+  
+  if(save_okay == true)
+    {
+    save_okay = diskio::save_npy_binary(x, f);
+    
+    f.flush();
+    f.close();
+    
+    if(save_okay == true)
+      {
+      save_okay = diskio::safe_rename(tmp_name, final_name);
+      }
+    }
+  
+  return save_okay;
+  }
+
+
+
+//! Save a cube in NumPy .npy format (Fortran order)
+template<typename eT>
+inline
+bool
+diskio::save_npy_binary(const Cube<eT>& x, const std::string& final_name)
+  {
+  arma_extra_debug_sigprint();
+  
+  const std::string tmp_name = diskio::gen_tmp_name(final_name);
+  
+  std::ofstream f( tmp_name.c_str(), std::fstream::binary );
+  
+  bool save_okay = f.is_open();
+  
+  if(save_okay == true)
+    {
+    save_okay = diskio::save_npy_binary(x, f);
+    
+    f.flush();
+    f.close();
+    
+    if(save_okay == true)
       {
-      load_okay = f.good();
+      save_okay = diskio::safe_rename(tmp_name, final_name);
       }
     }
-  else
-    {
-    load_okay = false;
-    err_msg = "incorrect header in ";
-    }
-
-  return load_okay;
+  
+  return save_okay;
   }
 
 
 
-// cubes
-
-
-
-//! Save a cube as raw text (no header, human readable).
+//! Save a matrix as the array "arr_0" of an uncompressed NumPy .npz archive
 template<typename eT>
 inline
 bool
-diskio::save_raw_ascii(const Cube<eT>& x, const std::string& final_name)
+diskio::save_npz_binary(const Mat<eT>& x, const std::string& final_name)
   {
   arma_extra_debug_sigprint();
   
   const std::string tmp_name = diskio::gen_tmp_name(final_name);
   
-  std::fstream f(tmp_name.c_str(), std::fstream::out);
+  std::ofstream f( tmp_name.c_str(), std::fstream::binary );
   
   bool save_okay = f.is_open();
   
   if(save_okay == true)
     {
-    save_okay = save_raw_ascii(x, f);
+    save_okay = diskio::save_npz_binary(x, f);
     
     f.flush();
     f.close();
@@ -3130,67 +3919,55 @@ diskio::save_raw_ascii(const Cube<eT>& x, const std::string& final_name)
 
 
 
-//! Save a cube as raw text (no header, human readable).
+//! Save a cube as the array "arr_0" of an uncompressed NumPy .npz archive
 template<typename eT>
 inline
 bool
-diskio::save_raw_ascii(const Cube<eT>& x, std::ostream& f)
+diskio::save_npz_binary(const Cube<eT>& x, const std::string& final_name)
   {
   arma_extra_debug_sigprint();
   
-  uword cell_width;
+  const std::string tmp_name = diskio::gen_tmp_name(final_name);
   
-  // TODO: need sane values for complex numbers
+  std::ofstream f( tmp_name.c_str(), std::fstream::binary );
   
-  if( (is_float<eT>::value) || (is_double<eT>::value) )
-    {
-    f.setf(ios::scientific);
-    f.precision(12);
-    cell_width = 20;
-    }
+  bool save_okay = f.is_open();
   
-  for(uword slice=0; slice < x.n_slices; ++slice)
+  if(save_okay == true)
     {
-    for(uword row=0; row < x.n_rows; ++row)
+    save_okay = diskio::save_npz_binary(x, f);
+    
+    f.flush();
+    f.close();
+    
+    if(save_okay == true)
       {
-      for(uword col=0; col < x.n_cols; ++col)
-        {
-        f.put(' ');
-        
-        if( (is_float<eT>::value) || (is_double<eT>::value) )
-          {
-          f.width(cell_width);
-          }
-        
-        arma_ostream::print_elem(f, x.at(row,col,slice), false);
-        }
-        
-      f.put('\n');
+      save_okay = diskio::safe_rename(tmp_name, final_name);
       }
     }
   
-  return f.good();
+  return save_okay;
   }
 
 
 
-//! Save a cube as raw binary (no header)
+//! Save a sparse matrix as an uncompressed .npz archive in the CSC layout of scipy.sparse.save_npz()
 template<typename eT>
 inline
 bool
-diskio::save_raw_binary(const Cube<eT>& x, const std::string& final_name)
+diskio::save_npz_binary(const SpMat<eT>& x, const std::string& final_name)
   {
   arma_extra_debug_sigprint();
   
   const std::string tmp_name = diskio::gen_tmp_name(final_name);
   
-  std::ofstream f(tmp_name.c_str(), std::fstream::binary);
+  std::ofstream f( tmp_name.c_str(), std::fstream::binary );
   
   bool save_okay = f.is_open();
   
   if(save_okay == true)
     {
-    save_okay = diskio::save_raw_binary(x, f);
+    save_okay = diskio::save_npz_binary(x, f);
     
     f.flush();
     f.close();
@@ -3209,247 +3986,274 @@ diskio::save_raw_binary(const Cube<eT>& x, const std::string& final_name)
 template<typename eT>
 inline
 bool
-diskio::save_raw_binary(const Cube<eT>& x, std::ostream& f)
+diskio::save_npy_binary(const Mat<eT>& x, std::ostream& f)
   {
   arma_extra_debug_sigprint();
   
-  f.write( reinterpret_cast<const char*>(x.mem), std::streamsize(x.n_elem*sizeof(eT)) );
+  const uword dims[2] = { x.n_rows, x.n_cols };
+  
+  npy_misc::write_header(f, npy_misc::gen_descr<eT>(), dims, 2);
+  
+  f.write( reinterpret_cast<const char*>(x.memptr()), std::streamsize(x.n_elem*sizeof(eT)) );
   
   return f.good();
   }
 
 
 
-//! Save a cube in text format (human readable),
-//! with a header that indicates the cube type as well as its dimensions
 template<typename eT>
 inline
 bool
-diskio::save_arma_ascii(const Cube<eT>& x, const std::string& final_name)
+diskio::save_npy_binary(const Cube<eT>& x, std::ostream& f)
   {
   arma_extra_debug_sigprint();
   
-  const std::string tmp_name = diskio::gen_tmp_name(final_name);
+  const uword dims[3] = { x.n_rows, x.n_cols, x.n_slices };
   
-  std::ofstream f(tmp_name.c_str());
+  npy_misc::write_header(f, npy_misc::gen_descr<eT>(), dims, 3);
   
-  bool save_okay = f.is_open();
+  f.write( reinterpret_cast<const char*>(x.memptr()), std::streamsize(x.n_elem*sizeof(eT)) );
   
-  if(save_okay == true)
-    {
-    save_okay = diskio::save_arma_ascii(x, f);
-    
-    f.flush();
-    f.close();
-    
-    if(save_okay == true)
-      {
-      save_okay = diskio::safe_rename(tmp_name, final_name);
-      }
-    }
+  return f.good();
+  }
+
+
+
+template<typename eT>
+inline
+bool
+diskio::save_npz_binary(const Mat<eT>& x, std::ostream& f)
+  {
+  arma_extra_debug_sigprint();
+  
+  // the .npy data is written straight into the archive
+  
+  npy_misc::zip_writer zw(f);
+  
+  std::ostream ss(&zw);
+  
+  bool save_okay = zw.begin_entry("arr_0.npy", std::streamoff(x.n_elem*sizeof(eT)));
+  
+  if(save_okay)  { save_okay = diskio::save_npy_binary(x, ss); }
+  if(save_okay)  { save_okay = zw.end_entry();                 }
+  if(save_okay)  { save_okay = zw.finish();                    }
   
   return save_okay;
   }
 
 
 
-//! Save a cube in text format (human readable),
-//! with a header that indicates the cube type as well as its dimensions
 template<typename eT>
 inline
 bool
-diskio::save_arma_ascii(const Cube<eT>& x, std::ostream& f)
+diskio::save_npz_binary(const Cube<eT>& x, std::ostream& f)
   {
   arma_extra_debug_sigprint();
   
-  const ios::fmtflags orig_flags = f.flags();
+  // the .npy data is written straight into the archive
   
-  f << diskio::gen_txt_header(x) << '\n';
-  f << x.n_rows << ' ' << x.n_cols << ' ' << x.n_slices << '\n';
+  npy_misc::zip_writer zw(f);
+  
+  std::ostream ss(&zw);
+  
+  bool save_okay = zw.begin_entry("arr_0.npy", std::streamoff(x.n_elem*sizeof(eT)));
+  
+  if(save_okay)  { save_okay = diskio::save_npy_binary(x, ss); }
+  if(save_okay)  { save_okay = zw.end_entry();                 }
+  if(save_okay)  { save_okay = zw.finish();                    }
+  
+  return save_okay;
+  }
+
+
+
+template<typename eT>
+inline
+bool
+diskio::save_npz_binary(const SpMat<eT>& x, std::ostream& f)
+  {
+  arma_extra_debug_sigprint();
+  
+  const std::string index_descr = npy_misc::gen_descr('i', uword(sizeof(uword)));
+  
+  // each array is written straight into the archive, in the same order as scipy.sparse.save_npz()
+  
+  npy_misc::zip_writer zw(f);
   
-  uword cell_width;
+  std::ostream ss(&zw);
   
-  // TODO: need sane values for complex numbers
+  // indices and indptr are stored as signed integers of the same size as uword
   
-  if( (is_float<eT>::value) || (is_double<eT>::value) )
+  const uword dims_indices[1] = { x.n_nonzero  };
+  const uword dims_indptr[1]  = { x.n_cols + 1 };
+  const uword dims_shape[1]   = { 2            };
+  
+  bool save_okay = zw.begin_entry("indices.npy", std::streamoff(x.n_nonzero*sizeof(uword)));
+  
+  if(save_okay)
     {
-    f.setf(ios::scientific);
-    f.precision(12);
-    cell_width = 20;
+    npy_misc::write_header(ss, index_descr, dims_indices, 1);
+    ss.write( reinterpret_cast<const char*>(x.row_indices), std::streamsize(x.n_nonzero*sizeof(uword)) );
+    
+    save_okay = ss.good() && zw.end_entry();
     }
+  
+  if(save_okay)  { save_okay = zw.begin_entry("indptr.npy", std::streamoff((x.n_cols+1)*sizeof(uword))); }
+  
+  if(save_okay)
+    {
+    npy_misc::write_header(ss, index_descr, dims_indptr, 1);
+    ss.write( reinterpret_cast<const char*>(x.col_ptrs), std::streamsize((x.n_cols+1)*sizeof(uword)) );
     
-  for(uword slice=0; slice < x.n_slices; ++slice)
+    save_okay = ss.good() && zw.end_entry();
+    }
+  
+  // format is a 0-dimensional unicode string with 3 characters
+  
+  if(save_okay)  { save_okay = zw.begin_entry("format.npy", 3*sizeof(u32)); }
+  
+  if(save_okay)
     {
-    for(uword row=0; row < x.n_rows; ++row)
+    const char* format = "csc";
+    
+    npy_misc::write_header(ss, npy_misc::gen_descr('U', 3), dims_shape, 0);
+    
+    for(uword i=0; i < 3; ++i)
       {
-      for(uword col=0; col < x.n_cols; ++col)
-        {
-        f.put(' ');
-        
-        if( (is_float<eT>::value) || (is_double<eT>::value) )        
-          {
-          f.width(cell_width);
-          }
-        
-        arma_ostream::print_elem(f, x.at(row,col,slice), false);
-        }
+      const u32 val = u32(format[i]);
+      
+      ss.write( reinterpret_cast<const char*>(&val), std::streamsize(sizeof(u32)) );
+      }
+    
+    save_okay = ss.good() && zw.end_entry();
+    }
+  
+  // shape is stored as two 64 bit integers
+  
+  if(save_okay)  { save_okay = zw.begin_entry("shape.npy", 2*8); }
+  
+  if(save_okay)
+    {
+    npy_misc::write_header(ss, npy_misc::gen_descr('i', 8), dims_shape, 1);
+    
+    const uword shape[2] = { x.n_rows, x.n_cols };
+    
+    for(uword i=0; i < 2; ++i)
+      {
+      std::string val;
       
-      f.put('\n');
+      npy_misc::put_le(val, std::streamoff(shape[i]), 8);
+      
+      if(npy_misc::is_little_endian() == false)  { std::reverse(val.begin(), val.end()); }
+      
+      ss.write( val.data(), std::streamsize(val.length()) );
       }
+    
+    save_okay = ss.good() && zw.end_entry();
     }
   
-  const bool save_okay = f.good();
+  if(save_okay)  { save_okay = zw.begin_entry("data.npy", std::streamoff(x.n_nonzero*sizeof(eT))); }
+  
+  if(save_okay)
+    {
+    npy_misc::write_header(ss, npy_misc::gen_descr<eT>(), dims_indices, 1);
+    ss.write( reinterpret_cast<const char*>(x.values), std::streamsize(x.n_nonzero*sizeof(eT)) );
+    
+    save_okay = ss.good() && zw.end_entry();
+    }
   
-  f.flags(orig_flags);
+  if(save_okay)  { save_okay = zw.finish(); }
   
   return save_okay;
   }
 
 
 
-//! Save a cube in binary format,
-//! with a header that stores the cube type as well as its dimensions
+//! Load a matrix from a NumPy .npy file
 template<typename eT>
 inline
 bool
-diskio::save_arma_binary(const Cube<eT>& x, const std::string& final_name)
+diskio::load_npy_binary(Mat<eT>& x, const std::string& name, std::string& err_msg)
   {
   arma_extra_debug_sigprint();
   
-  const std::string tmp_name = diskio::gen_tmp_name(final_name);
-  
-  std::ofstream f(tmp_name.c_str(), std::fstream::binary);
+  std::ifstream f( name.c_str(), std::fstream::binary );
   
-  bool save_okay = f.is_open();
+  bool load_okay = f.is_open();
   
-  if(save_okay == true)
+  if(load_okay == true)
     {
-    save_okay = diskio::save_arma_binary(x, f);
-    
-    f.flush();
+    load_okay = diskio::load_npy_binary(x, f, err_msg);
     f.close();
-    
-    if(save_okay == true)
-      {
-      save_okay = diskio::safe_rename(tmp_name, final_name);
-      }
     }
   
-  return save_okay;
+  return load_okay;
   }
 
 
 
-//! Save a cube in binary format,
-//! with a header that stores the cube type as well as its dimensions
+//! Load a cube from a NumPy .npy file
 template<typename eT>
 inline
 bool
-diskio::save_arma_binary(const Cube<eT>& x, std::ostream& f)
+diskio::load_npy_binary(Cube<eT>& x, const std::string& name, std::string& err_msg)
   {
   arma_extra_debug_sigprint();
   
-  f << diskio::gen_bin_header(x) << '\n';
-  f << x.n_rows << ' ' << x.n_cols << ' ' << x.n_slices << '\n';
+  std::ifstream f( name.c_str(), std::fstream::binary );
   
-  f.write( reinterpret_cast<const char*>(x.mem), std::streamsize(x.n_elem*sizeof(eT)) );
+  bool load_okay = f.is_open();
   
-  return f.good();
+  if(load_okay == true)
+    {
+    load_okay = diskio::load_npy_binary(x, f, err_msg);
+    f.close();
+    }
+  
+  return load_okay;
   }
 
 
 
-//! Save a cube as part of a HDF5 file
+//! Load the first array of a NumPy .npz archive into a matrix
 template<typename eT>
 inline
 bool
-diskio::save_hdf5_binary(const Cube<eT>& x, const std::string& final_name)
+diskio::load_npz_binary(Mat<eT>& x, const std::string& name, std::string& err_msg)
   {
   arma_extra_debug_sigprint();
-
-  #if defined(ARMA_USE_HDF5)
-    {
-    #if !defined(ARMA_PRINT_HDF5_ERRORS)
-      {
-      // Disable annoying HDF5 error messages.
-      arma_H5Eset_auto(H5E_DEFAULT, NULL, NULL);
-      }
-    #endif
-
-    bool save_okay = false;
-
-    const std::string tmp_name = diskio::gen_tmp_name(final_name);
-
-    // Set up the file according to HDF5's preferences
-    hid_t file = arma_H5Fcreate(tmp_name.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
-
-    // We need to create a dataset, datatype, and dataspace
-    hsize_t dims[3];
-    dims[2] = x.n_rows;
-    dims[1] = x.n_cols;
-    dims[0] = x.n_slices;
-
-    hid_t dataspace = arma_H5Screate_simple(3, dims, NULL);   // treat the cube as a 3d array dataspace
-    hid_t datatype  = hdf5_misc::get_hdf5_type<eT>();
-
-    // If this returned something invalid, well, it's time to crash.
-    arma_check(datatype == -1, "Cube::save(): unknown datatype for HDF5");
-
-    // MATLAB forces the users to specify a name at save time for HDF5; Octave
-    // will use the default of 'dataset' unless otherwise specified, so we will
-    // use that.
-    hid_t dataset = arma_H5Dcreate(file, "dataset", datatype, dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-
-    herr_t status = arma_H5Dwrite(dataset, datatype, H5S_ALL, H5S_ALL, H5P_DEFAULT, x.mem);
-    save_okay = (status >= 0);
-
-    arma_H5Dclose(dataset);
-    arma_H5Tclose(datatype);
-    arma_H5Sclose(dataspace);
-    arma_H5Fclose(file);
-
-    if(save_okay == true) { save_okay = diskio::safe_rename(tmp_name, final_name); }
-
-    return save_okay;
-    }
-  #else
-    {
-    arma_ignore(x);
-    arma_ignore(final_name);
-
-    arma_stop("Cube::save(): use of HDF5 needs to be enabled");
-
-    return false;
+  
+  std::ifstream f( name.c_str(), std::fstream::binary );
+  
+  bool load_okay = f.is_open();
+  
+  if(load_okay == true)
+    {
+    load_okay = diskio::load_npz_binary(x, f, err_msg);
+    f.close();
     }
-  #endif
+  
+  return load_okay;
   }
 
 
 
-//! Load a cube as raw text (no header, human readable).
-//! NOTE: this is much slower than reading a file with a header.
+//! Load the first array of a NumPy .npz archive into a cube
 template<typename eT>
 inline
 bool
-diskio::load_raw_ascii(Cube<eT>& x, const std::string& name, std::string& err_msg)
+diskio::load_npz_binary(Cube<eT>& x, const std::string& name, std::string& err_msg)
   {
   arma_extra_debug_sigprint();
   
-  Mat<eT> tmp;
-  const bool load_okay = diskio::load_raw_ascii(tmp, name, err_msg);
+  std::ifstream f( name.c_str(), std::fstream::binary );
+  
+  bool load_okay = f.is_open();
   
   if(load_okay == true)
     {
-    if(tmp.is_empty() == false)
-      {
-      x.set_size(tmp.n_rows, tmp.n_cols, 1);
-      
-      x.slice(0) = tmp;
-      }
-    else
-      {
-      x.reset();
-      }
+    load_okay = diskio::load_npz_binary(x, f, err_msg);
+    f.close();
     }
   
   return load_okay;
@@ -3457,30 +4261,22 @@ diskio::load_raw_ascii(Cube<eT>& x, const std::string& name, std::string& err_ms
 
 
 
-//! Load a cube as raw text (no header, human readable).
-//! NOTE: this is much slower than reading a file with a header.
+//! Load a sparse matrix from a .npz archive written by scipy.sparse.save_npz() (CSC or CSR layout)
 template<typename eT>
 inline
 bool
-diskio::load_raw_ascii(Cube<eT>& x, std::istream& f, std::string& err_msg)
+diskio::load_npz_binary(SpMat<eT>& x, const std::string& name, std::string& err_msg)
   {
   arma_extra_debug_sigprint();
   
-  Mat<eT> tmp;
-  const bool load_okay = diskio::load_raw_ascii(tmp, f, err_msg);
+  std::ifstream f( name.c_str(), std::fstream::binary );
+  
+  bool load_okay = f.is_open();
   
   if(load_okay == true)
     {
-    if(tmp.is_empty() == false)
-      {
-      x.set_size(tmp.n_rows, tmp.n_cols, 1);
-      
-      x.slice(0) = tmp;
-      }
-    else
-      {
-      x.reset();
-      }
+    load_okay = diskio::load_npz_binary(x, f, err_msg);
+    f.close();
     }
   
   return load_okay;
@@ -3488,182 +4284,362 @@ diskio::load_raw_ascii(Cube<eT>& x, std::istream& f, std::string& err_msg)
 
 
 
-//! Load a cube in binary format (no header);
-//! the cube is assumed to have one slice with one column
+//! Load a matrix from a NumPy .npy stream.
+//! Data in Fortran order with an element type matching eT is read directly into the matrix;
+//! otherwise the element type and order are converted in a single pass.
+//! One dimensional arrays are loaded as column vectors (or row vectors when loading into a Row).
 template<typename eT>
 inline
 bool
-diskio::load_raw_binary(Cube<eT>& x, const std::string& name, std::string& err_msg)
+diskio::load_npy_binary(Mat<eT>& x, std::istream& f, std::string& err_msg)
   {
   arma_extra_debug_sigprint();
   
-  std::ifstream f;
-  f.open(name.c_str(), std::fstream::binary);
+  npy_misc::dtype_info dt;
   
-  bool load_okay = f.is_open();
+  bool  fortran_order = false;
+  uword dims[3];
+  uword n_dims = 0;
   
-  if(load_okay == true)
+  if(npy_misc::read_header(f, dt, fortran_order, dims, n_dims, err_msg) == false)  { return false; }
+  
+  if(dims[2] != 1)
     {
-    load_okay = diskio::load_raw_binary(x, f, err_msg);
-    f.close();
+    err_msg = "incorrect number of dimensions in ";
+    return false;
     }
   
-  return load_okay;
+  uword f_n_rows = dims[0];
+  uword f_n_cols = dims[1];
+  
+  if( (x.vec_state != 0) && ((f_n_rows == 1) || (f_n_cols == 1)) )
+    {
+    // the elements of a vector are stored in the same order irrespective of its orientation
+    const uword N = f_n_rows * f_n_cols;
+    
+    f_n_rows = (x.vec_state == 2) ? 1 : N;
+    f_n_cols = (x.vec_state == 2) ? N : 1;
+    }
+  else
+  if(x.vec_state != 0)
+    {
+    err_msg = "incorrect size in ";
+    return false;
+    }
+  
+  x.set_size(f_n_rows, f_n_cols);
+  
+  return npy_misc::read_data(f, dt, fortran_order, dims, x.memptr(), err_msg);
   }
 
 
 
+//! Load a cube from a NumPy .npy stream; arrays with fewer than three dimensions are loaded as a single slice
 template<typename eT>
 inline
 bool
-diskio::load_raw_binary(Cube<eT>& x, std::istream& f, std::string& err_msg)
+diskio::load_npy_binary(Cube<eT>& x, std::istream& f, std::string& err_msg)
   {
   arma_extra_debug_sigprint();
-  arma_ignore(err_msg);
   
-  f.clear();
-  const std::streampos pos1 = f.tellg();
+  npy_misc::dtype_info dt;
   
-  f.clear();
-  f.seekg(0, ios::end);
+  bool  fortran_order = false;
+  uword dims[3];
+  uword n_dims = 0;
   
-  f.clear();
-  const std::streampos pos2 = f.tellg();
+  if(npy_misc::read_header(f, dt, fortran_order, dims, n_dims, err_msg) == false)  { return false; }
   
-  const uword N = ( (pos1 >= 0) && (pos2 >= 0) ) ? uword(pos2 - pos1) : 0;
+  x.set_size(dims[0], dims[1], dims[2]);
   
-  f.clear();
-  //f.seekg(0, ios::beg);
-  f.seekg(pos1);
+  return npy_misc::read_data(f, dt, fortran_order, dims, x.memptr(), err_msg);
+  }
+
+
+
+template<typename eT>
+inline
+bool
+diskio::load_npz_binary(Mat<eT>& x, std::istream& f, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
   
-  x.set_size(N / sizeof(eT), 1, 1);
+  std::vector<npy_misc::zip_entry> entries;
   
-  f.clear();
-  f.read( reinterpret_cast<char *>(x.memptr()), std::streamsize(N) );
+  if(npy_misc::read_zip_directory(f, entries, err_msg) == false)  { return false; }
   
-  return f.good();
+  if(entries.size() == 0)
+    {
+    err_msg = "no arrays in ";
+    return false;
+    }
+  
+  return ( npy_misc::seek_entry(f, entries[0], err_msg) && diskio::load_npy_binary(x, f, err_msg) );
   }
 
 
 
-//! Load a cube in text format (human readable),
-//! with a header that indicates the cube type as well as its dimensions
 template<typename eT>
 inline
 bool
-diskio::load_arma_ascii(Cube<eT>& x, const std::string& name, std::string& err_msg)
+diskio::load_npz_binary(Cube<eT>& x, std::istream& f, std::string& err_msg)
   {
   arma_extra_debug_sigprint();
   
-  std::ifstream f(name.c_str());
+  std::vector<npy_misc::zip_entry> entries;
   
-  bool load_okay = f.is_open();
+  if(npy_misc::read_zip_directory(f, entries, err_msg) == false)  { return false; }
   
-  if(load_okay == true)
+  if(entries.size() == 0)
     {
-    load_okay = diskio::load_arma_ascii(x, f, err_msg);
-    f.close();
+    err_msg = "no arrays in ";
+    return false;
     }
   
-  return load_okay;
+  return ( npy_misc::seek_entry(f, entries[0], err_msg) && diskio::load_npy_binary(x, f, err_msg) );
   }
+
+
+
+//! load a one dimensional array
+template<typename eT>
+inline
+bool
+diskio::load_npy_vector(Col<eT>& x, std::istream& f, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  npy_misc::dtype_info dt;
+  
+  bool  fortran_order = false;
+  uword dims[3];
+  uword n_dims = 0;
+  
+  if(npy_misc::read_header(f, dt, fortran_order, dims, n_dims, err_msg) == false)  { return false; }
+  
+  if(n_dims != 1)
+    {
+    err_msg = "incorrect sparse matrix format in ";
+    return false;
+    }
   
+  x.set_size(dims[0]);
+  
+  return npy_misc::read_data(f, dt, fortran_order, dims, x.memptr(), err_msg);
+  }
+
 
 
-//! Load a cube in text format (human readable),
-//! with a header that indicates the cube type as well as its dimensions
 template<typename eT>
 inline
 bool
-diskio::load_arma_ascii(Cube<eT>& x, std::istream& f, std::string& err_msg)
+diskio::load_npz_binary(SpMat<eT>& x, std::istream& f, std::string& err_msg)
   {
   arma_extra_debug_sigprint();
   
-  std::streampos pos = f.tellg();
+  std::vector<npy_misc::zip_entry> entries;
+  
+  if(npy_misc::read_zip_directory(f, entries, err_msg) == false)  { return false; }
+  
+  const npy_misc::zip_entry* entry_format  = npy_misc::find_entry(entries, "format.npy" );
+  const npy_misc::zip_entry* entry_shape   = npy_misc::find_entry(entries, "shape.npy"  );
+  const npy_misc::zip_entry* entry_indices = npy_misc::find_entry(entries, "indices.npy");
+  const npy_misc::zip_entry* entry_indptr  = npy_misc::find_entry(entries, "indptr.npy" );
+  const npy_misc::zip_entry* entry_data    = npy_misc::find_entry(entries, "data.npy"   );
+  
+  if( (entry_format == NULL) || (entry_shape == NULL) || (entry_indices == NULL) || (entry_indptr == NULL) || (entry_data == NULL) )
+    {
+    err_msg = "incorrect sparse matrix format in ";
+    return false;
+    }
+  
+  std::string format;
+  
+  Col<uword> shape;
+  Col<uword> indices;
+  Col<uword> indptr;
+  Col<eT>    data;
+  
+  bool load_okay =                     npy_misc::seek_entry(f, *entry_format,  err_msg) && npy_misc::read_string(f, format, err_msg);
+  load_okay      = load_okay        && npy_misc::seek_entry(f, *entry_shape,   err_msg) && diskio::load_npy_vector(shape,   f, err_msg);
+  load_okay      = load_okay        && npy_misc::seek_entry(f, *entry_indices, err_msg) && diskio::load_npy_vector(indices, f, err_msg);
+  load_okay      = load_okay        && npy_misc::seek_entry(f, *entry_indptr,  err_msg) && diskio::load_npy_vector(indptr,  f, err_msg);
+  load_okay      = load_okay        && npy_misc::seek_entry(f, *entry_data,    err_msg) && diskio::load_npy_vector(data,    f, err_msg);
+  
+  if(load_okay == false)  { return false; }
+  
+  // CSR data of a matrix is the CSC data of its transpose
+  
+  const bool is_csc = (format == "csc");
+  
+  if( ((is_csc == false) && (format != "csr")) || (shape.n_elem != 2) )
+    {
+    err_msg = "unsupported sparse matrix format in ";
+    return false;
+    }
+  
+  const uword n_minor = (is_csc) ? shape[0] : shape[1];
+  const uword n_major = (is_csc) ? shape[1] : shape[0];
+  const uword n_nz    = data.n_elem;
+  
+  bool valid  = (indptr.n_elem == n_major + 1) && (indices.n_elem == n_nz) && (indptr[0] == 0) && (indptr[n_major] == n_nz);
+  bool simple = true;  // indices sorted within each column, without duplicates or explicit zeros
+  
+  for(uword j=0; (j < n_major) && (valid == true); ++j)
+    {
+    const uword start = indptr[j  ];
+    const uword end   = indptr[j+1];
     
-  bool load_okay = true;
+    if( (end < start) || (end > n_nz) )  { valid = false; break; }
+    
+    for(uword k=start; k < end; ++k)
+      {
+      if(indices[k] >= n_minor)  { valid = false; break; }
+      
+      if( (data[k] == eT(0)) || ((k > start) && (indices[k] <= indices[k-1])) )  { simple = false; }
+      }
+    }
   
-  std::string f_header;
-  uword f_n_rows;
-  uword f_n_cols;
-  uword f_n_slices;
+  if(valid == false)
+    {
+    err_msg = "incorrect sparse matrix format in ";
+    return false;
+    }
   
-  f >> f_header;
-  f >> f_n_rows;
-  f >> f_n_cols;
-  f >> f_n_slices;
+  SpMat<eT> tmp;
   
-  if(f_header == diskio::gen_txt_header(x))
+  if(simple == true)
     {
-    x.set_size(f_n_rows, f_n_cols, f_n_slices);
-
-    for(uword slice=0; slice < x.n_slices; ++slice)
+    tmp.set_size(n_minor, n_major);
+    tmp.mem_resize(n_nz);
+    
+    arrayops::copy( access::rwp(tmp.values),      data.memptr(),    n_nz        );
+    arrayops::copy( access::rwp(tmp.row_indices), indices.memptr(), n_nz        );
+    arrayops::copy( access::rwp(tmp.col_ptrs),    indptr.memptr(),  n_major + 1 );
+    }
+  else
+    {
+    // duplicate entries are summed, as in scipy.sparse
+    umat locations(2, n_nz);
+    
+    for(uword j=0; j < n_major; ++j)
       {
-      for(uword row=0; row < x.n_rows; ++row)
+      for(uword k=indptr[j]; k < indptr[j+1]; ++k)
         {
-        for(uword col=0; col < x.n_cols; ++col)
-          {
-          f >> x.at(row,col,slice);
-          }
+        locations.at(0,k) = indices[k];
+        locations.at(1,k) = j;
         }
       }
     
-    load_okay = f.good();
+    SpMat<eT> tmp2(true, locations, data, n_minor, n_major, true, true);
+    
+    tmp.steal_mem(tmp2);
+    }
+  
+  if(is_csc)
+    {
+    x.steal_mem(tmp);
     }
   else
     {
-    load_okay = false;
-    err_msg = "incorrect header in ";
+    x = tmp.t();
     }
   
+  return true;
+  }
+
+
+
+
+
+// fields
+
+
+
+template<typename T1>
+inline
+bool
+diskio::save_arma_binary(const field<T1>& x, const std::string& final_name)
+  {
+  arma_extra_debug_sigprint();
+  
+  const std::string tmp_name = diskio::gen_tmp_name(final_name);
   
-  // allow automatic conversion of u32/s32 cubes into u64/s64 cubes
+  std::ofstream f( tmp_name.c_str(), std::fstream::binary );
   
-  if(load_okay == false)
+  bool save_okay = f.is_open();
+  
+  if(save_okay == true)
     {
-    if( (sizeof(eT) == 8) && is_same_type<uword,eT>::yes )
+    save_okay = diskio::save_arma_binary(x, f);
+    
+    f.flush();
+    f.close();
+    
+    if(save_okay == true)
       {
-      Cube<u32>   tmp;
-      std::string junk;
-      
-      f.clear();
-      f.seekg(pos);
-      
-      load_okay = diskio::load_arma_ascii(tmp, f, junk);
-      
-      if(load_okay)  { x = conv_to< Cube<eT> >::from(tmp); }
+      save_okay = diskio::safe_rename(tmp_name, final_name);
       }
-    else
-    if( (sizeof(eT) == 8) && is_same_type<sword,eT>::yes )
+    }
+  
+  return save_okay;
+  }
+
+
+
+template<typename T1>
+inline
+bool
+diskio::save_arma_binary(const field<T1>& x, std::ostream& f)
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_type_check(( (is_Mat<T1>::value == false) && (is_Cube<T1>::value == false) ));
+  
+  if(x.n_slices <= 1)
+    {
+    f << "ARMA_FLD_BIN" << '\n';
+    f << x.n_rows << '\n';
+    f << x.n_cols << '\n';
+    }
+  else
+    {
+    f << "ARMA_FL3_BIN" << '\n';
+    f << x.n_rows   << '\n';
+    f << x.n_cols   << '\n';
+    f << x.n_slices << '\n';
+    }
+  
+  bool save_okay = true;
+  
+  for(uword i=0; i<x.n_elem; ++i)
+    {
+    save_okay = diskio::save_arma_binary(x[i], f);
+    
+    if(save_okay == false)
       {
-      Cube<s32>   tmp;
-      std::string junk;
-      
-      f.clear();
-      f.seekg(pos);
-      
-      load_okay = diskio::load_arma_ascii(tmp, f, junk);
-      
-      if(load_okay)  { x = conv_to< Cube<eT> >::from(tmp); }
+      break;
       }
     }
   
-  return load_okay;
+  return save_okay;
   }
 
 
 
-//! Load a cube in binary format,
-//! with a header that indicates the cube type as well as its dimensions
-template<typename eT>
+template<typename T1>
 inline
 bool
-diskio::load_arma_binary(Cube<eT>& x, const std::string& name, std::string& err_msg)
+diskio::load_arma_binary(field<T1>& x, const std::string& name, std::string& err_msg)
   {
   arma_extra_debug_sigprint();
   
-  std::ifstream f;
-  f.open(name.c_str(), std::fstream::binary);
+  if(diskio::is_arma_binary_indexed(name))
+    {
+    return diskio::load_arma_binary_indexed(x, name, err_msg);
+    }
+  
+  std::ifstream f( name.c_str(), std::fstream::binary );
   
   bool load_okay = f.is_open();
   
@@ -3678,406 +4654,441 @@ diskio::load_arma_binary(Cube<eT>& x, const std::string& name, std::string& err_
 
 
 
-template<typename eT>
+template<typename T1>
 inline
 bool
-diskio::load_arma_binary(Cube<eT>& x, std::istream& f, std::string& err_msg)
+diskio::load_arma_binary(field<T1>& x, std::istream& f, std::string& err_msg)
   {
   arma_extra_debug_sigprint();
   
-  std::streampos pos = f.tellg();
-    
-  bool load_okay = true;
+  arma_type_check(( (is_Mat<T1>::value == false) && (is_Cube<T1>::value == false) ));
   
-  std::string f_header;
-  uword f_n_rows;
-  uword f_n_cols;
-  uword f_n_slices;
+  bool load_okay = true;
   
-  f >> f_header;
-  f >> f_n_rows;
-  f >> f_n_cols;
-  f >> f_n_slices;
+  std::string f_type;
+  f >> f_type;
   
-  if(f_header == diskio::gen_bin_header(x))
+  if(f_type == "ARMA_FLX_BIN")
     {
-    //f.seekg(1, ios::cur);  // NOTE: this may not be portable, as on a Windows machine a newline could be two characters
-    f.get();
-    
-    x.set_size(f_n_rows, f_n_cols, f_n_slices);
-    f.read( reinterpret_cast<char *>(x.memptr()), std::streamsize(x.n_elem*sizeof(eT)) );
-    
-    load_okay = f.good();
+    // the type has been read, so the stream doesn't need to be rewound
+    load_okay = diskio::load_arma_binary_indexed_body(x, f, err_msg);
     }
   else
+  if(f_type == "ARMA_FLD_BIN")
     {
-    load_okay = false;
-    err_msg = "incorrect header in ";
-    }
-  
-  
-  // allow automatic conversion of u32/s32 cubes into u64/s64 cubes
+    uword f_n_rows;
+    uword f_n_cols;
   
-  if(load_okay == false)
-    {
-    if( (sizeof(eT) == 8) && is_same_type<uword,eT>::yes )
-      {
-      Cube<u32>   tmp;
-      std::string junk;
-      
-      f.clear();
-      f.seekg(pos);
-      
-      load_okay = diskio::load_arma_binary(tmp, f, junk);
-      
-      if(load_okay)  { x = conv_to< Cube<eT> >::from(tmp); }
-      }
-    else
-    if( (sizeof(eT) == 8) && is_same_type<sword,eT>::yes )
+    f >> f_n_rows;
+    f >> f_n_cols;
+    
+    x.set_size(f_n_rows, f_n_cols);
+    
+    f.get();      
+    
+    for(uword i=0; i<x.n_elem; ++i)
       {
-      Cube<s32>   tmp;
-      std::string junk;
-      
-      f.clear();
-      f.seekg(pos);
-      
-      load_okay = diskio::load_arma_binary(tmp, f, junk);
+      load_okay = diskio::load_arma_binary(x[i], f, err_msg);
       
-      if(load_okay)  { x = conv_to< Cube<eT> >::from(tmp); }
+      if(load_okay == false)
+        {
+        break;
+        }
       }
     }
-  
-  return load_okay;
-  }
-
-
-
-//! Load a HDF5 file as a cube
-template<typename eT>
-inline
-bool
-diskio::load_hdf5_binary(Cube<eT>& x, const std::string& name, std::string& err_msg)
-  {
-  arma_extra_debug_sigprint();
-
-  #if defined(ARMA_USE_HDF5)
+  else
+  if(f_type == "ARMA_FL3_BIN")
     {
-
-    // These may be necessary to store the error handler (if we need to).
-    herr_t (*old_func)(hid_t, void*);
-    void *old_client_data;
-
-    #if !defined(ARMA_PRINT_HDF5_ERRORS)
-      {
-      // Save old error handler.
-      arma_H5Eget_auto(H5E_DEFAULT, &old_func, &old_client_data);
-
-      // Disable annoying HDF5 error messages.
-      arma_H5Eset_auto(H5E_DEFAULT, NULL, NULL);
-      }
-    #endif
-
-    bool load_okay = false;
-
-    hid_t fid = arma_H5Fopen(name.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
-
-    if(fid >= 0)
+    uword f_n_rows;
+    uword f_n_cols;
+    uword f_n_slices;
+  
+    f >> f_n_rows;
+    f >> f_n_cols;
+    f >> f_n_slices;
+    
+    x.set_size(f_n_rows, f_n_cols, f_n_slices);
+    
+    f.get();      
+    
+    for(uword i=0; i<x.n_elem; ++i)
       {
-      // MATLAB HDF5 dataset names are user-specified;
-      // Octave tends to store the datasets in a group, with the actual dataset being referred to as "value".
-      // So we will search for "dataset" and "value", and if those are not found we will take the first dataset we do find.
-      std::vector<std::string> searchNames;
-      searchNames.push_back("dataset");
-      searchNames.push_back("value");
-
-      hid_t dataset = hdf5_misc::search_hdf5_file(searchNames, fid, 3, false);
-
-      if(dataset >= 0)
-        {
-        hid_t filespace = arma_H5Dget_space(dataset);
-
-        // This must be <= 3 due to our search rules.
-        const int ndims = arma_H5Sget_simple_extent_ndims(filespace);
-
-        hsize_t dims[3];
-        const herr_t query_status = arma_H5Sget_simple_extent_dims(filespace, dims, NULL);
-
-        // arma_check(query_status < 0, "Cube::load(): cannot get size of HDF5 dataset");
-        if(query_status < 0)
-          {
-          err_msg = "cannot get size of HDF5 dataset in ";
-
-          arma_H5Sclose(filespace);
-          arma_H5Dclose(dataset);
-          arma_H5Fclose(fid);
-
-          #if !defined(ARMA_PRINT_HDF5_ERRORS)
-            {
-            // Restore HDF5 error handler.
-            arma_H5Eset_auto(H5E_DEFAULT, old_func, old_client_data);
-            }
-          #endif
-
-          return false;
-          }
-
-        if (ndims == 1) { dims[1] = 1; dims[2] = 1; }  // Vector case; one row/colum, several slices
-        if (ndims == 2) { dims[2] = 1; } // Matrix case; one column, several rows/slices
-
-        x.set_size(dims[2], dims[1], dims[0]);
-
-        // Now we have to see what type is stored to figure out how to load it.
-        hid_t datatype = arma_H5Dget_type(dataset);
-        hid_t mat_type = hdf5_misc::get_hdf5_type<eT>();
-
-        // If these are the same type, it is simple.
-        if(arma_H5Tequal(datatype, mat_type) > 0)
-          {
-          // Load directly; H5S_ALL used so that we load the entire dataset.
-          hid_t read_status = arma_H5Dread(dataset, datatype, H5S_ALL, H5S_ALL, H5P_DEFAULT, void_ptr(x.memptr()));
-
-          if(read_status >= 0) { load_okay = true; }
-          }
-        else
-          {
-          // Load into another array and convert its type accordingly.
-          hid_t read_status = hdf5_misc::load_and_convert_hdf5(x.memptr(), dataset, datatype, x.n_elem);
-
-          if(read_status >= 0) { load_okay = true; }
-          }
-
-        // Now clean up.
-        arma_H5Tclose(datatype);
-        arma_H5Tclose(mat_type);
-        arma_H5Sclose(filespace);
-        }
-
-      arma_H5Dclose(dataset);
-
-      arma_H5Fclose(fid);
-
+      load_okay = diskio::load_arma_binary(x[i], f, err_msg);
+      
       if(load_okay == false)
         {
-        err_msg = "unsupported or incorrect HDF5 data in ";
+        break;
         }
       }
-    else
-      {
-      err_msg = "cannot open file ";
-      }
-
-    #if !defined(ARMA_PRINT_HDF5_ERRORS)
-      {
-      // Restore HDF5 error handler.
-      arma_H5Eset_auto(H5E_DEFAULT, old_func, old_client_data);
-      }
-    #endif
-
-    return load_okay;
     }
-  #else
-    {
-    arma_ignore(x);
-    arma_ignore(name);
-    arma_ignore(err_msg);
-
-    arma_stop("Cube::load(): use of HDF5 needs to be enabled");
-
-    return false;
+  else
+    {
+    load_okay = false;
+    err_msg = "unsupported field type in ";
     }
-  #endif
+  
+  return load_okay;
   }
 
 
 
-//! Try to load a cube by automatically determining its type
-template<typename eT>
+//! save a field in arma_binary_indexed format:
+//! the objects are stored as in arma_binary format, followed by a table with the position of each object
+//! and a fixed size trailer with the position of the table;
+//! this allows individual objects to be loaded without parsing the preceding objects
+template<typename T1>
 inline
 bool
-diskio::load_auto_detect(Cube<eT>& x, const std::string& name, std::string& err_msg)
+diskio::save_arma_binary_indexed(const field<T1>& x, const std::string& final_name)
   {
   arma_extra_debug_sigprint();
   
-  #if defined(ARMA_USE_HDF5)
-    // We're currently using the C bindings for the HDF5 library, which don't support C++ streams
-    if( arma_H5Fis_hdf5(name.c_str()) ) { return load_hdf5_binary(x, name, err_msg); }
-  #endif
-
-  std::fstream f;
-  f.open(name.c_str(), std::fstream::in | std::fstream::binary);
+  const std::string tmp_name = diskio::gen_tmp_name(final_name);
   
-  bool load_okay = f.is_open();
+  std::ofstream f( tmp_name.c_str(), std::fstream::binary );
   
-  if(load_okay == true)
+  bool save_okay = f.is_open();
+  
+  if(save_okay == true)
     {
-    load_okay = diskio::load_auto_detect(x, f, err_msg);
+    save_okay = diskio::save_arma_binary_indexed(x, f);
+    
+    f.flush();
     f.close();
+    
+    if(save_okay == true)
+      {
+      save_okay = diskio::safe_rename(tmp_name, final_name);
+      }
     }
   
-  return load_okay;
+  return save_okay;
   }
 
 
 
-//! Try to load a cube by automatically determining its type
-template<typename eT>
+template<typename T1>
 inline
 bool
-diskio::load_auto_detect(Cube<eT>& x, std::istream& f, std::string& err_msg)
+diskio::save_arma_binary_indexed(const field<T1>& x, std::ostream& f)
   {
   arma_extra_debug_sigprint();
   
-  static const std::string ARMA_CUB_TXT = "ARMA_CUB_TXT";
-  static const std::string ARMA_CUB_BIN = "ARMA_CUB_BIN";
-  static const std::string           P6 = "P6";
+  arma_type_check(( (is_Mat<T1>::value == false) && (is_Cube<T1>::value == false) && (is_SpMat<T1>::value == false) ));
   
-  podarray<char> raw_header(uword(ARMA_CUB_TXT.length()) + 1);
+  // positions are relative to the start of the header, so the field can be embedded in a larger stream
+  const std::streampos base = f.tellp();
   
-  std::streampos pos = f.tellg();
+  if(base == std::streampos(-1))  { return false; }
   
-  f.read( raw_header.memptr(), std::streamsize(ARMA_CUB_TXT.length()) );
-  raw_header[uword(ARMA_CUB_TXT.length())] = '\0';
+  f << "ARMA_FLX_BIN" << '\n';
+  f << x.n_rows << ' ' << x.n_cols << ' ' << x.n_slices << '\n';
   
-  f.clear();
-  f.seekg(pos);
+  std::vector<std::streamoff> offsets(x.n_elem);
   
-  const std::string header = raw_header.mem;
+  bool save_okay = f.good();
   
-  if(ARMA_CUB_TXT == header.substr(0, ARMA_CUB_TXT.length()))
-    {
-    return load_arma_ascii(x, f, err_msg);
-    }
-  else
-  if(ARMA_CUB_BIN == header.substr(0, ARMA_CUB_BIN.length()))
+  for(uword i=0; (i < x.n_elem) && (save_okay == true); ++i)
     {
-    return load_arma_binary(x, f, err_msg);
-    }
-  else
-  if(P6 == header.substr(0, P6.length()))
-    {
-    return load_ppm_binary(x, f, err_msg);
+    offsets[i] = std::streamoff(f.tellp() - base);
+    
+    save_okay = diskio::save_arma_binary(x[i], f);
     }
-  else
+  
+  if(save_okay == true)
     {
-    const file_type ft = guess_file_type(f);
+    const std::streamoff index_offset = std::streamoff(f.tellp() - base);
     
-    switch(ft)
+    for(uword i=0; i < x.n_elem; ++i)
       {
-      // case csv_ascii:
-      //   return load_csv_ascii(x, f, err_msg);
-      //   break;
-      
-      case raw_binary:
-        return load_raw_binary(x, f, err_msg);
-        break;
-        
-      case raw_ascii:
-        return load_raw_ascii(x, f, err_msg);
-        break;
-        
-      default:
-        err_msg = "unknown data in ";
-        return false;
+      diskio::write_field_offset(f, offsets[i]);
       }
+    
+    diskio::write_field_offset(f, index_offset);
+    
+    f << "ARMA_FLX_END" << '\n';
+    
+    save_okay = f.good();
     }
   
-  return false;
+  return save_okay;
   }
 
 
 
+//! load a field saved in arma_binary_indexed format;
+//! the objects are loaded in parallel when OpenMP is enabled
+template<typename T1>
+inline
+bool
+diskio::load_arma_binary_indexed(field<T1>& x, const std::string& name, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_type_check(( (is_Mat<T1>::value == false) && (is_Cube<T1>::value == false) && (is_SpMat<T1>::value == false) ));
+  
+  uword f_n_rows   = 0;
+  uword f_n_cols   = 0;
+  uword f_n_slices = 0;
+  
+  std::vector<std::streamoff> offsets;
+  
+  bool load_okay = diskio::load_field_index(name, f_n_rows, f_n_cols, f_n_slices, offsets, err_msg);
+  
+  if(load_okay == true)
+    {
+    x.set_size(f_n_rows, f_n_cols, f_n_slices);
+    
+    load_okay = diskio::load_field_objects(x, name, offsets, NULL, err_msg);
+    }
+  
+  return load_okay;
+  }
+
 
 
-// fields
+//! load a field saved in arma_binary_indexed format by reading the stream sequentially
+template<typename T1>
+inline
+bool
+diskio::load_arma_binary_indexed(field<T1>& x, std::istream& f, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_type_check(( (is_Mat<T1>::value == false) && (is_Cube<T1>::value == false) && (is_SpMat<T1>::value == false) ));
+  
+  std::string f_type;
+  f >> f_type;
+  
+  if(f_type != "ARMA_FLX_BIN")
+    {
+    err_msg = "unsupported field type in ";
+    return false;
+    }
+  
+  return diskio::load_arma_binary_indexed_body(x, f, err_msg);
+  }
 
 
 
+//! load the rest of a field saved in arma_binary_indexed format, after the "ARMA_FLX_BIN" type has been read;
+//! the objects and the index are read sequentially, so the stream doesn't need to be seekable
 template<typename T1>
 inline
 bool
-diskio::save_arma_binary(const field<T1>& x, const std::string& final_name)
+diskio::load_arma_binary_indexed_body(field<T1>& x, std::istream& f, std::string& err_msg)
   {
   arma_extra_debug_sigprint();
   
-  const std::string tmp_name = diskio::gen_tmp_name(final_name);
+  arma_type_check(( (is_Mat<T1>::value == false) && (is_Cube<T1>::value == false) && (is_SpMat<T1>::value == false) ));
   
-  std::ofstream f( tmp_name.c_str(), std::fstream::binary );
+  uword f_n_rows   = 0;
+  uword f_n_cols   = 0;
+  uword f_n_slices = 0;
   
-  bool save_okay = f.is_open();
+  f >> f_n_rows;
+  f >> f_n_cols;
+  f >> f_n_slices;
   
-  if(save_okay == true)
+  f.get();
+  
+  bool load_okay = f.good();
+  
+  if(load_okay == true)
     {
-    save_okay = diskio::save_arma_binary(x, f);
-    
-    f.flush();
-    f.close();
+    x.set_size(f_n_rows, f_n_cols, f_n_slices);
     
-    if(save_okay == true)
+    for(uword i=0; (i < x.n_elem) && (load_okay == true); ++i)
       {
-      save_okay = diskio::safe_rename(tmp_name, final_name);
+      load_okay = diskio::load_arma_binary(x[i], f, err_msg);
       }
     }
   
-  return save_okay;
+  // consume the index, so that the stream is positioned after the field
+  
+  std::streamoff offset = 0;
+  
+  for(uword i=0; (i <= x.n_elem) && (load_okay == true); ++i)
+    {
+    load_okay = diskio::read_field_offset(f, offset);
+    }
+  
+  if(load_okay == true)
+    {
+    std::string f_end;
+    f >> f_end;
+    f.get();
+    
+    load_okay = (f_end == "ARMA_FLX_END");
+    }
+  
+  if( (load_okay == false) && (err_msg.length() == 0) )
+    {
+    err_msg = "incorrect index in ";
+    }
+  
+  return load_okay;
   }
 
 
 
-template<typename T1>
 inline
 bool
-diskio::save_arma_binary(const field<T1>& x, std::ostream& f)
+diskio::is_arma_binary_indexed(const std::string& name)
   {
   arma_extra_debug_sigprint();
   
-  arma_type_check(( (is_Mat<T1>::value == false) && (is_Cube<T1>::value == false) ));
+  std::ifstream f( name.c_str(), std::fstream::binary );
   
-  if(x.n_slices <= 1)
-    {
-    f << "ARMA_FLD_BIN" << '\n';
-    f << x.n_rows << '\n';
-    f << x.n_cols << '\n';
-    }
-  else
+  if(f.is_open() == false)  { return false; }
+  
+  char header[12];
+  
+  f.read(header, 12);
+  
+  return ( (f.gcount() == 12) && (std::string(header, 12) == "ARMA_FLX_BIN") );
+  }
+
+
+
+//! write a position as a fixed width decimal number
+inline
+void
+diskio::write_field_offset(std::ostream& f, const std::streamoff offset)
+  {
+  arma_extra_debug_sigprint();
+  
+  char buf[21];
+  
+  std::streamoff val = offset;
+  
+  for(int k=19; k >= 0; --k)
     {
-    f << "ARMA_FL3_BIN" << '\n';
-    f << x.n_rows   << '\n';
-    f << x.n_cols   << '\n';
-    f << x.n_slices << '\n';
+    buf[k] = char( '0' + int(val % 10) );
+    
+    val /= 10;
     }
   
-  bool save_okay = true;
+  buf[20] = '\n';
   
-  for(uword i=0; i<x.n_elem; ++i)
+  f.write(buf, 21);
+  }
+
+
+
+inline
+bool
+diskio::read_field_offset(std::istream& f, std::streamoff& offset)
+  {
+  arma_extra_debug_sigprint();
+  
+  char buf[21];
+  
+  f.read(buf, 21);
+  
+  if( (f.gcount() != 21) || (buf[20] != '\n') )  { return false; }
+  
+  std::streamoff val = 0;
+  
+  for(int k=0; k < 20; ++k)
     {
-    save_okay = diskio::save_arma_binary(x[i], f);
+    const char c = buf[k];
     
-    if(save_okay == false)
-      {
-      break;
-      }
+    if( (c < '0') || (c > '9') )  { return false; }
+    
+    val = val*10 + std::streamoff(c - '0');
     }
   
-  return save_okay;
+  offset = val;
+  
+  return true;
   }
 
 
 
-template<typename T1>
+//! read the dimensions and the object positions of a field saved in arma_binary_indexed format,
+//! without reading the objects
 inline
 bool
-diskio::load_arma_binary(field<T1>& x, const std::string& name, std::string& err_msg)
+diskio::load_field_index(const std::string& name, uword& n_rows, uword& n_cols, uword& n_slices, std::vector<std::streamoff>& offsets, std::string& err_msg)
   {
   arma_extra_debug_sigprint();
   
   std::ifstream f( name.c_str(), std::fstream::binary );
   
-  bool load_okay = f.is_open();
+  if(f.is_open() == false)  { return false; }
+  
+  std::string f_type;
+  f >> f_type;
+  
+  if(f_type != "ARMA_FLX_BIN")
+    {
+    err_msg = "unsupported field type in ";
+    return false;
+    }
+  
+  f >> n_rows;
+  f >> n_cols;
+  f >> n_slices;
+  
+  bool load_okay = f.good();
+  
+  // trailer: position of the index followed by "ARMA_FLX_END\n"
+  const std::streamoff trailer_length = 21 + 13;
+  
+  std::streamoff index_offset = 0;
+  std::streamoff trailer_pos  = 0;
+  
+  if(load_okay == true)
+    {
+    f.seekg(-trailer_length, std::ios::end);
+    
+    trailer_pos = std::streamoff(f.tellg());
+    
+    load_okay = (trailer_pos >= 0) && diskio::read_field_offset(f, index_offset);
+    }
+  
+  if(load_okay == true)
+    {
+    std::string f_end;
+    f >> f_end;
+    
+    load_okay = (f_end == "ARMA_FLX_END");
+    }
+  
+  // the index must fit between its position and the trailer; this also rejects sizes that overflow
+  
+  uword n_elem = 0;
+  
+  if(load_okay == true)
+    {
+    const double n_elem_d = double(n_rows) * double(n_cols) * double(n_slices);
+    
+    const std::streamoff n_index = (index_offset <= trailer_pos) ? (trailer_pos - index_offset) / 21 : std::streamoff(-1);
+    
+    load_okay = (n_elem_d <= double(ARMA_MAX_UWORD)) && (n_index >= 0) && (n_elem_d <= double(n_index));
+    
+    if(load_okay == true)  { n_elem = n_rows * n_cols * n_slices; }
+    }
+  
+  if(load_okay == true)
+    {
+    f.clear();
+    f.seekg(index_offset, std::ios::beg);
+    
+    offsets.resize(n_elem);
+    
+    for(uword i=0; (i < n_elem) && (load_okay == true); ++i)
+      {
+      load_okay = diskio::read_field_offset(f, offsets[i]);
+      
+      if(load_okay == true)  { load_okay = (offsets[i] < index_offset); }
+      }
+    }
   
-  if(load_okay == true)
+  if(load_okay == false)
     {
-    load_okay = diskio::load_arma_binary(x, f, err_msg);
-    f.close();
+    err_msg = "incorrect index in ";
     }
   
   return load_okay;
@@ -4085,74 +5096,91 @@ diskio::load_arma_binary(field<T1>& x, const std::string& name, std::string& err
 
 
 
+//! load objects from a file saved in arma_binary_indexed format into the pre-sized field x;
+//! object x[i] is read from offsets[ indices[i] ], or from offsets[i] if indices is NULL;
+//! each thread uses its own stream, so the objects are read in parallel when OpenMP is enabled
 template<typename T1>
 inline
 bool
-diskio::load_arma_binary(field<T1>& x, std::istream& f, std::string& err_msg)
+diskio::load_field_objects(field<T1>& x, const std::string& name, const std::vector<std::streamoff>& offsets, const uword* indices, std::string& err_msg)
   {
   arma_extra_debug_sigprint();
   
-  arma_type_check(( (is_Mat<T1>::value == false) && (is_Cube<T1>::value == false) ));
+  const uword N = x.n_elem;
   
-  bool load_okay = true;
+  if(N == 0)  { return true; }
   
-  std::string f_type;
-  f >> f_type;
+  podarray<uword> status(N);
   
-  if(f_type == "ARMA_FLD_BIN")
-    {
-    uword f_n_rows;
-    uword f_n_cols;
+  status.zeros();
   
-    f >> f_n_rows;
-    f >> f_n_cols;
-    
-    x.set_size(f_n_rows, f_n_cols);
-    
-    f.get();      
+  std::vector<std::string> msgs(N);
+
+  #if defined(_OPENMP)
+    const uword n_threads = (std::min)( N, uword( (std::max)(int(1), int(omp_get_max_threads())) ) );
+
+    #pragma omp parallel num_threads(int(n_threads))
+  #endif
+    {
+    std::ifstream f( name.c_str(), std::fstream::binary );
     
-    for(uword i=0; i<x.n_elem; ++i)
+    const bool is_open = f.is_open();
+
+    #if defined(_OPENMP)
+      #pragma omp for schedule(static)
+    #endif
+    for(uword i=0; i < N; ++i)
       {
-      load_okay = diskio::load_arma_binary(x[i], f, err_msg);
+      if(is_open == false)  { continue; }
       
-      if(load_okay == false)
+      const std::streamoff offset = offsets[ (indices != NULL) ? indices[i] : i ];
+      
+      // contiguous objects are read without seeking, which would discard the stream buffer
+      f.clear();
+      
+      if(std::streamoff(f.tellg()) != offset)  { f.seekg(offset, std::ios::beg); }
+      
+      // exceptions can't leave a parallel region, so they are recorded and thrown again afterwards;
+      // status: 0 = load failed, 1 = okay, 2 = logic_error, 3 = runtime_error, 4 = bad_alloc, 5 = other exception
+      try
         {
-        break;
+        if( f.good() && diskio::load_arma_binary(x[i], f, msgs[i]) )  { status[i] = 1; }
         }
+      catch(const std::logic_error&   e)  { status[i] = 2; msgs[i] = e.what(); }
+      catch(const std::runtime_error& e)  { status[i] = 3; msgs[i] = e.what(); }
+      catch(const std::bad_alloc&      )  { status[i] = 4; }
+      catch(...)                          { status[i] = 5; }
       }
     }
-  else
-  if(f_type == "ARMA_FL3_BIN")
-    {
-    uword f_n_rows;
-    uword f_n_cols;
-    uword f_n_slices;
   
-    f >> f_n_rows;
-    f >> f_n_cols;
-    f >> f_n_slices;
-    
-    x.set_size(f_n_rows, f_n_cols, f_n_slices);
-    
-    f.get();      
-    
-    for(uword i=0; i<x.n_elem; ++i)
+  // the first failure determines the outcome, as when the objects are loaded one by one
+  
+  for(uword i=0; i < N; ++i)
+    {
+    switch(status[i])
       {
-      load_okay = diskio::load_arma_binary(x[i], f, err_msg);
+      case 0:
+        err_msg = msgs[i];
+        return false;
       
-      if(load_okay == false)
-        {
+      case 2:
+        throw std::logic_error(msgs[i]);
+      
+      case 3:
+        throw std::runtime_error(msgs[i]);
+      
+      case 4:
+        throw std::bad_alloc();
+      
+      case 5:
+        throw std::runtime_error("field::load(): unknown exception while loading object");
+      
+      default:
         break;
-        }
       }
     }
-  else
-    {
-    load_okay = false;
-    err_msg = "unsupported field type in ";
-    }
   
-  return load_okay;
+  return true;
   }
 
 
@@ -4317,6 +5345,11 @@ diskio::load_auto_detect(field<T1>& x, const std::string& name, std::string& err
   {
   arma_extra_debug_sigprint();
   
+  if(diskio::is_arma_binary_indexed(name))
+    {
+    return diskio::load_arma_binary_indexed(x, name, err_msg);
+    }
+  
   std::fstream f;
   f.open(name.c_str(), std::fstream::in | std::fstream::binary);
   
@@ -4345,6 +5378,7 @@ diskio::load_auto_detect(field<T1>& x, std::istream& f, std::string& err_msg)
   
   static const std::string ARMA_FLD_BIN = "ARMA_FLD_BIN";
   static const std::string ARMA_FL3_BIN = "ARMA_FL3_BIN";
+  static const std::string ARMA_FLX_BIN = "ARMA_FLX_BIN";
   static const std::string           P6 = "P6";
   
   podarray<char> raw_header(uword(ARMA_FLD_BIN.length()) + 1);
@@ -4370,6 +5404,11 @@ diskio::load_auto_detect(field<T1>& x, std::istream& f, std::string& err_msg)
     return load_arma_binary(x, f, err_msg);
     }
   else
+  if(ARMA_FLX_BIN == header.substr(0, ARMA_FLX_BIN.length()))
+    {
+    return load_arma_binary_indexed(x, f, err_msg);
+    }
+  else
   if(P6 == header.substr(0, P6.length()))
     {
     return load_ppm_binary(x, f, err_msg);
@@ -4813,5 +5852,311 @@ diskio::save_ppm_binary(const field<T1>& x, std::ostream& f)
 
 
 
+//! save a matrix to a file, using the function for the given file type
+template<typename eT>
+inline
+bool
+diskio::save(const Mat<eT>& x, const std::string& name, const file_type type, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  bool save_okay = false;
+  
+  switch(type)
+    {
+    case raw_ascii:
+      save_okay = diskio::save_raw_ascii(x, name);
+      break;
+    
+    case arma_ascii:
+      save_okay = diskio::save_arma_ascii(x, name);
+      break;
+    
+    case csv_ascii:
+      save_okay = diskio::save_csv_ascii(x, name);
+      break;
+    
+    case raw_binary:
+      save_okay = diskio::save_raw_binary(x, name);
+      break;
+    
+    case arma_binary:
+      save_okay = diskio::save_arma_binary(x, name);
+      break;
+    
+    case npy_binary:
+      save_okay = diskio::save_npy_binary(x, name);
+      break;
+    
+    case npz_binary:
+      save_okay = diskio::save_npz_binary(x, name);
+      break;
+    
+    case pgm_binary:
+      save_okay = diskio::save_pgm_binary(x, name);
+      break;
+    
+    case hdf5_binary:
+      save_okay = diskio::save_hdf5_binary(x, name);
+      break;
+    
+    default:
+      err_msg = "unsupported file type; filename = ";
+    }
+  
+  return save_okay;
+  }
+
+
+
+//! save a cube to a file, using the function for the given file type
+template<typename eT>
+inline
+bool
+diskio::save(const Cube<eT>& x, const std::string& name, const file_type type, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  bool save_okay = false;
+  
+  switch(type)
+    {
+    case raw_ascii:
+      save_okay = diskio::save_raw_ascii(x, name);
+      break;
+    
+    case arma_ascii:
+      save_okay = diskio::save_arma_ascii(x, name);
+      break;
+    
+    case raw_binary:
+      save_okay = diskio::save_raw_binary(x, name);
+      break;
+    
+    case arma_binary:
+      save_okay = diskio::save_arma_binary(x, name);
+      break;
+    
+    case npy_binary:
+      save_okay = diskio::save_npy_binary(x, name);
+      break;
+    
+    case npz_binary:
+      save_okay = diskio::save_npz_binary(x, name);
+      break;
+    
+    case ppm_binary:
+      save_okay = diskio::save_ppm_binary(x, name);
+      break;
+    
+    case hdf5_binary:
+      save_okay = diskio::save_hdf5_binary(x, name);
+      break;
+    
+    default:
+      err_msg = "unsupported file type; filename = ";
+    }
+  
+  return save_okay;
+  }
+
+
+
+//! save a sparse matrix to a file, using the function for the given file type
+template<typename eT>
+inline
+bool
+diskio::save(const SpMat<eT>& x, const std::string& name, const file_type type, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  bool save_okay = false;
+  
+  switch(type)
+    {
+    case arma_binary:
+      save_okay = diskio::save_arma_binary(x, name);
+      break;
+    
+    case npz_binary:
+      save_okay = diskio::save_npz_binary(x, name);
+      break;
+    
+    case coord_ascii:
+      save_okay = diskio::save_coord_ascii(x, name);
+      break;
+    
+    case mtx_ascii:
+      save_okay = diskio::save_mtx_ascii(x, name);
+      break;
+    
+    default:
+      err_msg = "unsupported file type; filename = ";
+    }
+  
+  return save_okay;
+  }
+
+
+
+//! load a matrix from a file, using the function for the given file type
+template<typename eT>
+inline
+bool
+diskio::load(Mat<eT>& x, const std::string& name, const file_type type, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  bool load_okay = false;
+  
+  switch(type)
+    {
+    case auto_detect:
+      load_okay = diskio::load_auto_detect(x, name, err_msg);
+      break;
+    
+    case raw_ascii:
+      load_okay = diskio::load_raw_ascii(x, name, err_msg);
+      break;
+    
+    case arma_ascii:
+      load_okay = diskio::load_arma_ascii(x, name, err_msg);
+      break;
+    
+    case csv_ascii:
+      load_okay = diskio::load_csv_ascii(x, name, err_msg);
+      break;
+    
+    case raw_binary:
+      load_okay = diskio::load_raw_binary(x, name, err_msg);
+      break;
+    
+    case arma_binary:
+      load_okay = diskio::load_arma_binary(x, name, err_msg);
+      break;
+    
+    case npy_binary:
+      load_okay = diskio::load_npy_binary(x, name, err_msg);
+      break;
+    
+    case npz_binary:
+      load_okay = diskio::load_npz_binary(x, name, err_msg);
+      break;
+    
+    case pgm_binary:
+      load_okay = diskio::load_pgm_binary(x, name, err_msg);
+      break;
+    
+    case hdf5_binary:
+      load_okay = diskio::load_hdf5_binary(x, name, err_msg);
+      break;
+    
+    default:
+      err_msg = "unsupported file type; filename = ";
+    }
+  
+  return load_okay;
+  }
+
+
+
+//! load a cube from a file, using the function for the given file type
+template<typename eT>
+inline
+bool
+diskio::load(Cube<eT>& x, const std::string& name, const file_type type, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  bool load_okay = false;
+  
+  switch(type)
+    {
+    case auto_detect:
+      load_okay = diskio::load_auto_detect(x, name, err_msg);
+      break;
+    
+    case raw_ascii:
+      load_okay = diskio::load_raw_ascii(x, name, err_msg);
+      break;
+    
+    case arma_ascii:
+      load_okay = diskio::load_arma_ascii(x, name, err_msg);
+      break;
+    
+    case raw_binary:
+      load_okay = diskio::load_raw_binary(x, name, err_msg);
+      break;
+    
+    case arma_binary:
+      load_okay = diskio::load_arma_binary(x, name, err_msg);
+      break;
+    
+    case npy_binary:
+      load_okay = diskio::load_npy_binary(x, name, err_msg);
+      break;
+    
+    case npz_binary:
+      load_okay = diskio::load_npz_binary(x, name, err_msg);
+      break;
+    
+    case ppm_binary:
+      load_okay = diskio::load_ppm_binary(x, name, err_msg);
+      break;
+    
+    case hdf5_binary:
+      load_okay = diskio::load_hdf5_binary(x, name, err_msg);
+      break;
+    
+    default:
+      err_msg = "unsupported file type; filename = ";
+    }
+  
+  return load_okay;
+  }
+
+
+
+//! load a sparse matrix from a file, using the function for the given file type
+template<typename eT>
+inline
+bool
+diskio::load(SpMat<eT>& x, const std::string& name, const file_type type, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  bool load_okay = false;
+  
+  switch(type)
+    {
+    case arma_binary:
+      load_okay = diskio::load_arma_binary(x, name, err_msg);
+      break;
+    
+    case npz_binary:
+      load_okay = diskio::load_npz_binary(x, name, err_msg);
+      break;
+    
+    case coord_ascii:
+      load_okay = diskio::load_coord_ascii(x, name, err_msg);
+      break;
+    
+    case mtx_ascii:
+      load_okay = diskio::load_mtx_ascii(x, name, err_msg);
+      break;
+    
+    case mtx_ascii_lowmem:
+      load_okay = diskio::load_mtx_ascii_lowmem(x, name, err_msg);
+      break;
+    
+    default:
+      err_msg = "unsupported file type; filename = ";
+    }
+  
+  return load_okay;
+  }
+
+
+
 //! @}
 
@@ -0,0 +1,77 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup executor
+//! @{
+
+
+
+//! work split into independent tasks, identified by 0 to n_tasks-1
+class executor_job
+  {
+  public:
+  
+  inline virtual ~executor_job() {}
+  
+  virtual void run_task(const uword task_id) = 0;
+  };
+
+
+
+//! runs the tasks of a job, possibly in parallel;
+//! derive from this class to run the tasks on a user provided thread pool.
+//! run() must only return after all tasks have finished, and may be called by several threads at once
+class executor
+  {
+  public:
+  
+  inline virtual ~executor() {}
+  
+  virtual uword n_threads() const = 0;  //!< the largest number of tasks that are worth running at once
+  
+  virtual void run(executor_job& job, const uword n_tasks) = 0;
+  };
+
+
+
+//! runs all tasks in the calling thread
+class serial_executor : public executor
+  {
+  public:
+  
+  inline uword n_threads() const;
+  
+  inline void run(executor_job& job, const uword n_tasks);
+  };
+
+
+
+//! runs the tasks via OpenMP, with at most max_threads threads per call (0 indicates omp_get_max_threads());
+//! the tasks are run in the calling thread if OpenMP is not enabled, or if called from within a parallel region
+class omp_executor : public executor
+  {
+  public:
+  
+  const uword max_threads;
+  
+  inline explicit omp_executor(const uword in_max_threads = 0);
+  
+  inline uword n_threads() const;
+  
+  inline void run(executor_job& job, const uword n_tasks);
+  };
+
+
+
+inline executor& default_executor();
+
+
+
+//! @}
@@ -0,0 +1,103 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup executor
+//! @{
+
+
+
+inline
+uword
+serial_executor::n_threads() const
+  {
+  return uword(1);
+  }
+
+
+
+inline
+void
+serial_executor::run(executor_job& job, const uword n_tasks)
+  {
+  arma_extra_debug_sigprint();
+  
+  for(uword t=0; t < n_tasks; ++t)  { job.run_task(t); }
+  }
+
+
+
+inline
+omp_executor::omp_executor(const uword in_max_threads)
+  : max_threads(in_max_threads)
+  {
+  arma_extra_debug_sigprint();
+  }
+
+
+
+inline
+uword
+omp_executor::n_threads() const
+  {
+  #if defined(_OPENMP)
+    {
+    if(omp_in_parallel())  { return uword(1); }
+    
+    const uword n_threads_omp = uword( (std::max)(int(1), int(omp_get_max_threads())) );
+    
+    return (max_threads > 0) ? (std::min)(max_threads, n_threads_omp) : n_threads_omp;
+    }
+  #else
+    {
+    return uword(1);
+    }
+  #endif
+  }
+
+
+
+inline
+void
+omp_executor::run(executor_job& job, const uword n_tasks)
+  {
+  arma_extra_debug_sigprint();
+  
+  #if defined(_OPENMP)
+    {
+    const uword n_threads_use = (std::min)( n_threads(), n_tasks );
+    
+    if(n_threads_use > 1)
+      {
+      #pragma omp parallel for schedule(static) num_threads(int(n_threads_use))
+      for(uword t=0; t < n_tasks; ++t)  { job.run_task(t); }
+      
+      return;
+      }
+    }
+  #endif
+  
+  for(uword t=0; t < n_tasks; ++t)  { job.run_task(t); }
+  }
+
+
+
+//! the executor used when none is specified: an omp_executor without a limit on the number of threads
+inline
+executor&
+default_executor()
+  {
+  static omp_executor exec;
+  
+  return exec;
+  }
+
+
+
+//! @}
@@ -46,54 +46,322 @@
 //! @{
 
 
-template<typename cx_type, uword fixed_N, bool> struct store {};
 
-template<typename cx_type, uword fixed_N>
-struct store<cx_type, fixed_N, true>
+//! helpers for the butterflies: rotations by roots of unity and the 4 point transform;
+//! the sign of the exponent is negative for the forward transform and positive for the inverse transform
+template<typename T, bool inverse>
+struct fft_rotate
   {
-  static const uword N = fixed_N;
+  //! multiply by exp(-+ i*2*pi/4), ie. by -i or +i
+  arma_inline
+  static
+  void
+  w4(T& re, T& im)
+    {
+    const T tmp = re;
+    
+    if(inverse)  { re = -im; im =  tmp; }
+    else         { re =  im; im = -tmp; }
+    }
+  
+  
+  //! multiply by exp(-+ i*2*pi/8)
+  arma_inline
+  static
+  void
+  w8(T& re, T& im)
+    {
+    const T c   = T(0.70710678118654752440);
+    const T tmp = re;
+    
+    if(inverse)  { re = c*(tmp - im); im = c*(tmp + im); }
+    else         { re = c*(tmp + im); im = c*(im - tmp); }
+    }
+  
   
-  arma_aligned cx_type coeffs_array[fixed_N];
+  //! multiply by exp(-+ i*2*pi*3/8)
+  arma_inline
+  static
+  void
+  w8_3(T& re, T& im)
+    {
+    const T c   = T(0.70710678118654752440);
+    const T tmp = re;
+    
+    if(inverse)  { re = -c*(tmp + im); im = c*(tmp - im); }
+    else         { re =  c*(im - tmp); im = -c*(tmp + im); }
+    }
+  
+  
+  //! multiply by (c + i*s)
+  arma_inline
+  static
+  void
+  mul(T& re, T& im, const T c, const T s)
+    {
+    const T tmp = re*c - im*s;
+    
+    im = re*s + im*c;
+    re = tmp;
+    }
   
-  inline store()      {}
-  inline store(uword) {}
   
-  arma_inline       cx_type* coeffs_ptr()       { return &coeffs_array[0]; }
-  arma_inline const cx_type* coeffs_ptr() const { return &coeffs_array[0]; }
+  arma_inline
+  static
+  void
+  dft_4(T& r0, T& i0, T& r1, T& i1, T& r2, T& i2, T& r3, T& i3)
+    {
+    const T t0r = r0 + r2;  const T t0i = i0 + i2;
+    const T t1r = r0 - r2;  const T t1i = i0 - i2;
+    const T t2r = r1 + r3;  const T t2i = i1 + i3;
+          T t3r = r1 - r3;        T t3i = i1 - i3;
+    
+    w4(t3r, t3i);
+    
+    r0 = t0r + t2r;  i0 = t0i + t2i;
+    r1 = t1r + t3r;  i1 = t1i + t3i;
+    r2 = t0r - t2r;  i2 = t0i - t2i;
+    r3 = t1r - t3r;  i3 = t1i - t3i;
+    }
   };
 
 
 
-template<typename cx_type, uword fixed_N>
-struct store<cx_type, fixed_N, false>
+//! butterflies of radix 2, 3, 4, 5, 8 and 16, operating on split real and imaginary parts.
+//! each computes the r point transform of the elements re[j*st] and im[j*st], for j < r, in place
+
+template<typename T, bool inverse>
+struct fft_butterfly_2
   {
-  const uword N;
+  static const uword r = 2;
+  
+  arma_inline
+  static
+  void
+  apply(T* re, T* im, const uword st)
+    {
+    const T r0 = re[0];   const T i0 = im[0];
+    const T r1 = re[st];  const T i1 = im[st];
+    
+    re[0]  = r0 + r1;  im[0]  = i0 + i1;
+    re[st] = r0 - r1;  im[st] = i0 - i1;
+    }
+  };
+
+
+
+template<typename T, bool inverse>
+struct fft_butterfly_3
+  {
+  static const uword r = 3;
+  
+  arma_inline
+  static
+  void
+  apply(T* re, T* im, const uword st)
+    {
+    // sin(2*pi/3), with the sign of the exponent
+    const T s = (inverse) ? T(+0.86602540378443864676) : T(-0.86602540378443864676);
+    
+    const T r0 = re[0];     const T i0 = im[0];
+    const T r1 = re[st];    const T i1 = im[st];
+    const T r2 = re[2*st];  const T i2 = im[2*st];
+    
+    const T tr = r1 + r2;  const T ti = i1 + i2;
+    const T dr = r1 - r2;  const T di = i1 - i2;
+    
+    const T ur = r0 - T(0.5)*tr;
+    const T ui = i0 - T(0.5)*ti;
+    
+    re[0]    = r0 + tr;    im[0]    = i0 + ti;
+    re[st]   = ur - s*di;  im[st]   = ui + s*dr;
+    re[2*st] = ur + s*di;  im[2*st] = ui - s*dr;
+    }
+  };
+
+
+
+template<typename T, bool inverse>
+struct fft_butterfly_4
+  {
+  static const uword r = 4;
   
-  podarray<cx_type> coeffs_array;
+  arma_inline
+  static
+  void
+  apply(T* re, T* im, const uword st)
+    {
+    fft_rotate<T,inverse>::dft_4(re[0], im[0], re[st], im[st], re[2*st], im[2*st], re[3*st], im[3*st]);
+    }
+  };
+
+
+
+template<typename T, bool inverse>
+struct fft_butterfly_5
+  {
+  static const uword r = 5;
   
-  inline store()           : N(0)    {}
-  inline store(uword in_N) : N(in_N) { coeffs_array.set_size(N); }
+  arma_inline
+  static
+  void
+  apply(T* re, T* im, const uword st)
+    {
+    // cos(2*pi/5), cos(4*pi/5), and sin(2*pi/5), sin(4*pi/5) with the sign of the exponent
+    const T c1 = T(+0.30901699437494742410);
+    const T c2 = T(-0.80901699437494742410);
+    const T s1 = (inverse) ? T(+0.95105651629515357212) : T(-0.95105651629515357212);
+    const T s2 = (inverse) ? T(+0.58778525229247312917) : T(-0.58778525229247312917);
+    
+    const T r0 = re[0];     const T i0 = im[0];
+    const T r1 = re[st];    const T i1 = im[st];
+    const T r2 = re[2*st];  const T i2 = im[2*st];
+    const T r3 = re[3*st];  const T i3 = im[3*st];
+    const T r4 = re[4*st];  const T i4 = im[4*st];
+    
+    const T t1r = r1 + r4;  const T t1i = i1 + i4;
+    const T t2r = r2 + r3;  const T t2i = i2 + i3;
+    const T d1r = r1 - r4;  const T d1i = i1 - i4;
+    const T d2r = r2 - r3;  const T d2i = i2 - i3;
+    
+    const T u1r = r0 + c1*t1r + c2*t2r;  const T u1i = i0 + c1*t1i + c2*t2i;
+    const T u2r = r0 + c2*t1r + c1*t2r;  const T u2i = i0 + c2*t1i + c1*t2i;
+    
+    // v1 = i*(s1*d1 + s2*d2),  v2 = i*(s2*d1 - s1*d2)
+    const T v1r = -(s1*d1i + s2*d2i);  const T v1i = s1*d1r + s2*d2r;
+    const T v2r = -(s2*d1i - s1*d2i);  const T v2i = s2*d1r - s1*d2r;
+    
+    re[0]    = r0 + t1r + t2r;  im[0]    = i0 + t1i + t2i;
+    re[st]   = u1r + v1r;       im[st]   = u1i + v1i;
+    re[2*st] = u2r + v2r;       im[2*st] = u2i + v2i;
+    re[3*st] = u2r - v2r;       im[3*st] = u2i - v2i;
+    re[4*st] = u1r - v1r;       im[4*st] = u1i - v1i;
+    }
+  };
+
+
+
+template<typename T, bool inverse>
+struct fft_butterfly_8
+  {
+  static const uword r = 8;
   
-  arma_inline       cx_type* coeffs_ptr()       { return coeffs_array.memptr(); }
-  arma_inline const cx_type* coeffs_ptr() const { return coeffs_array.memptr(); }
+  arma_inline
+  static
+  void
+  apply(T* re, T* im, const uword st)
+    {
+    typedef fft_rotate<T,inverse> rot;
+    
+    T r0 = re[0];     T i0 = im[0];
+    T r1 = re[st];    T i1 = im[st];
+    T r2 = re[2*st];  T i2 = im[2*st];
+    T r3 = re[3*st];  T i3 = im[3*st];
+    T r4 = re[4*st];  T i4 = im[4*st];
+    T r5 = re[5*st];  T i5 = im[5*st];
+    T r6 = re[6*st];  T i6 = im[6*st];
+    T r7 = re[7*st];  T i7 = im[7*st];
+    
+    // 4 point transforms of the even and the odd inputs
+    rot::dft_4(r0, i0, r2, i2, r4, i4, r6, i6);
+    rot::dft_4(r1, i1, r3, i3, r5, i5, r7, i7);
+    
+    rot::w8  (r3, i3);
+    rot::w4  (r5, i5);
+    rot::w8_3(r7, i7);
+    
+    re[0]    = r0 + r1;  im[0]    = i0 + i1;
+    re[st]   = r2 + r3;  im[st]   = i2 + i3;
+    re[2*st] = r4 + r5;  im[2*st] = i4 + i5;
+    re[3*st] = r6 + r7;  im[3*st] = i6 + i7;
+    re[4*st] = r0 - r1;  im[4*st] = i0 - i1;
+    re[5*st] = r2 - r3;  im[5*st] = i2 - i3;
+    re[6*st] = r4 - r5;  im[6*st] = i4 - i5;
+    re[7*st] = r6 - r7;  im[7*st] = i6 - i7;
+    }
   };
 
 
 
-template<typename cx_type, bool inverse, uword fixed_N = 0>
-class fft_engine : public store<cx_type, fixed_N, (fixed_N > 0)>
+template<typename T, bool inverse>
+struct fft_butterfly_16
+  {
+  static const uword r = 16;
+  
+  arma_inline
+  static
+  void
+  apply(T* re, T* im, const uword st)
+    {
+    typedef fft_rotate<T,inverse> rot;
+    
+    // cos(2*pi/16), cos(2*pi*3/16), and sin(2*pi/16), sin(2*pi*3/16) with the sign of the exponent
+    const T c1 = T(0.92387953251128675613);
+    const T c3 = T(0.38268343236508977173);
+    const T s1 = (inverse) ? T(+0.38268343236508977173) : T(-0.38268343236508977173);
+    const T s3 = (inverse) ? T(+0.92387953251128675613) : T(-0.92387953251128675613);
+    
+    // 16 = 4 x 4: transforms of the inputs j, j+4, j+8, j+12;
+    // the k-th output of the j-th transform is then multiplied by exp(-+ i*2*pi*j*k/16)
+    for(uword j=0; j < 4; ++j)
+      {
+      rot::dft_4(re[j*st], im[j*st], re[(j+4)*st], im[(j+4)*st], re[(j+8)*st], im[(j+8)*st], re[(j+12)*st], im[(j+12)*st]);
+      }
+    
+    rot::mul (re[ 5*st], im[ 5*st],  c1,  s1);
+    rot::w8  (re[ 9*st], im[ 9*st]);
+    rot::mul (re[13*st], im[13*st],  c3,  s3);
+    rot::w8  (re[ 6*st], im[ 6*st]);
+    rot::w4  (re[10*st], im[10*st]);
+    rot::w8_3(re[14*st], im[14*st]);
+    rot::mul (re[ 7*st], im[ 7*st],  c3,  s3);
+    rot::w8_3(re[11*st], im[11*st]);
+    rot::mul (re[15*st], im[15*st], -c1, -s1);
+    
+    // transforms across j; the output k+4*l is the l-th output of the k-th transform
+    for(uword k=0; k < 4; ++k)
+      {
+      const uword i = 4*k*st;
+      
+      rot::dft_4(re[i], im[i], re[i+st], im[i+st], re[i+2*st], im[i+2*st], re[i+3*st], im[i+3*st]);
+      }
+    
+    std::swap(re[ 1*st], re[ 4*st]);  std::swap(im[ 1*st], im[ 4*st]);
+    std::swap(re[ 2*st], re[ 8*st]);  std::swap(im[ 2*st], im[ 8*st]);
+    std::swap(re[ 3*st], re[12*st]);  std::swap(im[ 3*st], im[12*st]);
+    std::swap(re[ 6*st], re[ 9*st]);  std::swap(im[ 6*st], im[ 9*st]);
+    std::swap(re[ 7*st], re[13*st]);  std::swap(im[ 7*st], im[13*st]);
+    std::swap(re[11*st], re[14*st]);  std::swap(im[11*st], im[14*st]);
+    }
+  };
+
+
+
+//! FFT of length N, using the Stockham autosort algorithm on split real and imaginary parts.
+//! The length is factorised into passes of radix 8 (plus one pass of radix 16, 4 or 2), 3, 5 and any remaining prime factors;
+//! when the remaining factors are large, Bluestein's algorithm is used instead,
+//! which re-expresses the transform as a convolution done via power-of-2 transforms.
+//! Once constructed, the engine is not modified, so it can be used by several threads at once.
+template<typename cx_type, bool inverse>
+class fft_engine
   {
   public:
   
   typedef typename get_pod_type<cx_type>::result T;
   
-  using store<cx_type, fixed_N, (fixed_N > 0)>::N;
-  using store<cx_type, fixed_N, (fixed_N > 0)>::coeffs_ptr;
+  const uword N;
   
-  podarray<uword>   residue;
-  podarray<uword>   radix;
+  podarray<uword> radix;        //!< radix of each pass
+  podarray<uword> tw_offset;    //!< location of the twiddle factors of each pass
+  podarray<T>     tw_re;        //!< twiddle factors of all passes, split into real and imaginary parts
+  podarray<T>     tw_im;
   
-  podarray<cx_type> tmp_array;
+  uword                            bs_M;        //!< length of the transforms used by Bluestein's algorithm; 0 if not used
+  const fft_engine<cx_type,false>* bs_engine;
+  podarray<T>                      bs_w_re;     //!< chirp
+  podarray<T>                      bs_w_im;
+  podarray<T>                      bs_b_re;     //!< transform of the conjugated chirp, scaled by 1/bs_M
+  podarray<T>                      bs_b_im;
   
   
   template<bool fill>
@@ -102,313 +370,652 @@ class fft_engine : public store<cx_type, fixed_N, (fixed_N > 0)>
   calc_radix()
     {
     uword i = 0;
+    uword n = N;
+    
+    if(n == 0)  { return 0; }
+    
+    // powers of 2: passes of radix 8, with one pass of radix 16, 4 or 2 for the remainder
+    uword k = 0;
+    
+    while( (n % 2) == 0 )  { n /= 2; ++k; }
+    
+    uword n8 = k / 3;
+    uword r2 = 0;
     
-    for(uword n = N, r=4; n >= 2; ++i)
+    switch(k % 3)
       {
-      while( (n % r) > 0 )
-        {
-        switch(r)
-          {
-          case 2:  r  = 3; break;
-          case 4:  r  = 2; break;
-          default: r += 2; break;
-          }
-        
-        if(r*r > n) { r = n; }
-        }
-      
-      n /= r;
-      
-      if(fill)
-        {
-        residue[i] = n;
-          radix[i] = r;
-        }
+      case 1:  if(n8 > 0) { --n8; r2 = 16; } else { r2 = 2; }  break;
+      case 2:  r2 = 4;  break;
+      default: ;
       }
     
+    for(uword j=0; j < n8; ++j)  { if(fill) { radix[i] = 8; }  ++i; }
+    
+    if(r2 > 0)  { if(fill) { radix[i] = r2; }  ++i; }
+    
+    while( (n % 3) == 0 )  { if(fill) { radix[i] = 3; }  n /= 3; ++i; }
+    while( (n % 5) == 0 )  { if(fill) { radix[i] = 5; }  n /= 5; ++i; }
+    
+    for(uword r = 7; r*r <= n; r += 2)
+      {
+      while( (n % r) == 0 )  { if(fill) { radix[i] = r; }  n /= r; ++i; }
+      }
+    
+    if(n > 1)  { if(fill) { radix[i] = n; }  ++i; }
+    
     return i;
     }
   
   
   
+  inline
+  ~fft_engine()
+    {
+    arma_extra_debug_sigprint();
+    
+    if(bs_engine != NULL)  { delete bs_engine; }
+    }
+  
+  
+  
   inline
   fft_engine(const uword in_N)
-    : store< cx_type, fixed_N, (fixed_N > 0) >(in_N)
+    : N        (in_N)
+    , bs_M     (0   )
+    , bs_engine(NULL)
     {
     arma_extra_debug_sigprint();
     
     const uword len = calc_radix<false>();
     
-    residue.set_size(len);
-      radix.set_size(len);
+    radix.set_size(len);
     
     calc_radix<true>();
     
+    // the passes with a generic radix take O(N*r) operations,
+    // while Bluestein's algorithm takes O(M log M) operations, with M the smallest power of 2 >= 2N-1
     
-    // calculate the constant coefficients
+    double generic_sum = 0;
     
-    cx_type* coeffs = coeffs_ptr();
+    for(uword i=0; i < len; ++i)  { if(is_generic(radix[i]))  { generic_sum += double(radix[i]); } }
     
-    const T k = T( (inverse) ? +2 : -2 ) * std::acos( T(-1) ) / T(N);
+    if(generic_sum > 0)
+      {
+      uword M      = 1;
+      uword log2_M = 0;
+      
+      while(M < 2*N-1)  { M *= 2; ++log2_M; }
+      
+      if( (generic_sum * double(N)) > (bs_cost_factor * double(M) * double(log2_M)) )  { init_bluestein(M); return; }
+      }
     
-    for(uword i=0; i < N; ++i)  { coeffs[i] = std::exp( cx_type(T(0), i*k) ); }
+    init_twiddles();
     }
   
   
   
-  arma_hot
+  //! relative cost of Bluestein's algorithm, found empirically
+  static const uword bs_cost_factor = 2;
+  
+  
+  
+  //! roots of unity: exp(-+ i*2*pi*k/n);
+  //! the angle is computed in double precision, so that the float version is accurate
   inline
+  static
   void
-  butterfly_2(cx_type* Y, const uword stride, const uword m)
+  calc_root(T& out_re, T& out_im, const uword k, const uword n)
     {
-    arma_extra_debug_sigprint();
+    const double angle = double( (inverse) ? +2 : -2 ) * Datum<double>::pi * double(k) / double(n);
     
-    const cx_type* coeffs = coeffs_ptr();
-    
-    for(uword i=0; i < m; ++i)
-      {
-      const cx_type t = Y[i+m] * coeffs[i*stride];
-      
-      Y[i+m] =  Y[i] - t;
-      Y[i  ] += t;
-      }
+    out_re = T( std::cos(angle) );
+    out_im = T( std::sin(angle) );
     }
   
   
   
-  arma_hot
+  //! the pass with radix r and sub-transform length n uses the factors exp(-+ i*2*pi*p*k/n), for p < n/r and 0 < k < r,
+  //! stored at tw_offset + (k-1)*(n/r) + p.  the passes with a generic radix also store the r-th roots of unity
   inline
   void
-  butterfly_3(cx_type* Y, const uword stride, const uword m)
+  init_twiddles()
     {
     arma_extra_debug_sigprint();
     
-    arma_aligned cx_type tmp[5];
-    
-    cx_type* coeffs1 = coeffs_ptr();
-    cx_type* coeffs2 = coeffs1;
-    
-    const T coeff_sm_imag = coeffs1[stride*m].imag();
+    tw_offset.set_size(radix.n_elem);
     
-    const uword n = m*2;
+    uword n_tw = 0;
+    uword n    = N;
     
-    // TODO: rearrange the indices within tmp[] into a more sane order
-    
-    for(uword i = m; i > 0; --i)
+    for(uword i=0; i < radix.n_elem; ++i)
       {
-      tmp[1] = Y[m] * (*coeffs1);
-      tmp[2] = Y[n] * (*coeffs2);
-      
-      tmp[0]  = tmp[1] - tmp[2];
-      tmp[0] *= coeff_sm_imag;
-      
-      tmp[3] = tmp[1] + tmp[2];
+      const uword r = radix[i];
+      const uword m = n / r;
       
-      Y[m] = cx_type( (Y[0].real() - (T(0.5)*tmp[3].real())), (Y[0].imag() - (T(0.5)*tmp[3].imag())) );
+      tw_offset[i] = n_tw;
       
-      Y[0] += tmp[3];
+      n_tw += (r-1)*m + ( (is_generic(r)) ? r : 0 );
       
+      n = m;
+      }
+    
+    tw_re.set_size(n_tw);
+    tw_im.set_size(n_tw);
+    
+    n = N;
+    
+    for(uword i=0; i < radix.n_elem; ++i)
+      {
+      const uword r = radix[i];
+      const uword m = n / r;
       
-      Y[n] = cx_type( (Y[m].real() + tmp[0].imag()), (Y[m].imag() - tmp[0].real()) );
+      T* w_re = tw_re.memptr() + tw_offset[i];
+      T* w_im = tw_im.memptr() + tw_offset[i];
       
-      Y[m] += cx_type( -tmp[0].imag(), tmp[0].real() );
+      for(uword k=1; k < r; ++k)
+      for(uword p=0; p < m; ++p)
+        {
+        calc_root( w_re[(k-1)*m + p], w_im[(k-1)*m + p], p*k, n );
+        }
       
-      Y++;
+      if(is_generic(r))
+        {
+        w_re += (r-1)*m;
+        w_im += (r-1)*m;
+        
+        for(uword k=0; k < r; ++k)  { calc_root(w_re[k], w_im[k], k, r); }
+        }
       
-      coeffs1 += stride;
-      coeffs2 += stride*2;
+      n = m;
       }
     }
   
   
   
-  arma_hot
+  //! Bluestein's algorithm: with w_n = exp(-+ i*pi*n^2/N), the n-th output is w_n times the convolution of x_n*w_n and conj(w_n)
   inline
   void
-  butterfly_4(cx_type* Y, const uword stride, const uword m)
+  init_bluestein(const uword M)
     {
     arma_extra_debug_sigprint();
     
-    arma_aligned cx_type tmp[7];
-    
-    const cx_type* coeffs = coeffs_ptr();
+    bs_M      = M;
+    bs_engine = new fft_engine<cx_type,false>(M);
     
-    const uword m2 = m*2;
-    const uword m3 = m*3;
+    bs_w_re.set_size(N);
+    bs_w_im.set_size(N);
     
-    // TODO: rearrange the indices within tmp[] into a more sane order
+    // n^2 mod 2N is computed incrementally, avoiding overflows
+    uword n2 = 0;
     
-    for(uword i=0; i < m; ++i)
+    for(uword n=0; n < N; ++n)
       {
-      tmp[0] = Y[i + m ] * coeffs[i*stride  ];
-      tmp[2] = Y[i + m3] * coeffs[i*stride*3];
-      tmp[3] = tmp[0] + tmp[2];
+      calc_root(bs_w_re[n], bs_w_im[n], n2, 2*N);
       
-      //tmp[4] = tmp[0] - tmp[2];
-      //tmp[4] = (inverse) ? cx_type( -(tmp[4].imag()), tmp[4].real() ) : cx_type( tmp[4].imag(), -tmp[4].real() );
+      n2 += 2*n + 1;
       
-      tmp[4] = (inverse)
-                 ? cx_type( (tmp[2].imag() - tmp[0].imag()), (tmp[0].real() - tmp[2].real()) )
-                 : cx_type( (tmp[0].imag() - tmp[2].imag()), (tmp[2].real() - tmp[0].real()) );
-      
-      tmp[1] = Y[i + m2] * coeffs[i*stride*2];
-      tmp[5] = Y[i] - tmp[1];
-      
-      
-      Y[i     ] += tmp[1];
-      Y[i + m2]  = Y[i] - tmp[3];
-      Y[i     ] += tmp[3];
-      Y[i + m ]  = tmp[5] + tmp[4];
-      Y[i + m3]  = tmp[5] - tmp[4];
+      if(n2 >= 2*N)  { n2 -= 2*N; }
+      }
+    
+    podarray<T> work(4*M);
+    
+    T* a_re = work.memptr();
+    T* a_im = a_re + M;
+    T* b_re = a_im + M;
+    T* b_im = b_re + M;
+    
+    arrayops::fill_zeros(a_re, 2*M);
+    
+    a_re[0] = bs_w_re[0];
+    a_im[0] = -bs_w_im[0];
+    
+    for(uword n=1; n < N; ++n)
+      {
+      a_re[n] = bs_w_re[n];  a_re[M-n] =  bs_w_re[n];
+      a_im[n] = -bs_w_im[n]; a_im[M-n] = -bs_w_im[n];
+      }
+    
+    const bool in_b = bs_engine->run_split(a_re, a_im, b_re, b_im);
+    
+    const T* c_re = (in_b) ? b_re : a_re;
+    const T* c_im = (in_b) ? b_im : a_im;
+    
+    bs_b_re.set_size(M);
+    bs_b_im.set_size(M);
+    
+    const T scale = T(1) / T(M);
+    
+    for(uword i=0; i < M; ++i)
+      {
+      bs_b_re[i] = c_re[i] * scale;
+      bs_b_im[i] = c_im[i] * scale;
       }
     }
   
   
   
-  inline
+  arma_inline
+  static
+  bool
+  is_generic(const uword r)
+    {
+    return (r > 5) && (r != 8) && (r != 16);
+    }
+  
+  
+  
+  //! one Stockham pass with a fixed radix: the inputs x[q + s*(p + j*m)] are transformed, multiplied by the twiddle factors,
+  //! and stored in y[q + s*(r*p + k)], for j,k < r, p < m and q < s.
+  //! x_e and y_e are the distances between consecutive elements: 1 for split data, 2 for interleaved complex data.
+  //! groups of L butterflies are copied to a local array and processed together, which allows the compiler to vectorise the butterflies;
+  //! the groups run along q, or along p in the first pass where s = 1
+  template<typename butterfly, uword x_e, uword y_e>
   arma_hot
+  inline
   void
-  butterfly_5(cx_type* Y, const uword stride, const uword m)
+  pass(T* y_re, T* y_im, const T* x_re, const T* x_im, const uword stage, const uword m, const uword s) const
     {
-    arma_extra_debug_sigprint();
-    
-    arma_aligned cx_type tmp[13];
+    const uword r = butterfly::r;
+    const uword L = 4;
     
-    const cx_type* coeffs = coeffs_ptr();
+    const T* w_re = tw_re.memptr() + tw_offset[stage];
+    const T* w_im = tw_im.memptr() + tw_offset[stage];
     
-    const T a_real = coeffs[stride*1*m].real();
-    const T a_imag = coeffs[stride*1*m].imag();
+    arma_aligned T a_re[butterfly::r * L];
+    arma_aligned T a_im[butterfly::r * L];
     
-    const T b_real = coeffs[stride*2*m].real();
-    const T b_imag = coeffs[stride*2*m].imag();
-    
-    cx_type* Y0 = Y;
-    cx_type* Y1 = Y + 1*m;
-    cx_type* Y2 = Y + 2*m;
-    cx_type* Y3 = Y + 3*m;
-    cx_type* Y4 = Y + 4*m;
-    
-    for(uword i=0; i < m; ++i)
+    if(s == 1)
       {
-      tmp[0] = (*Y0);
-      
-      tmp[1] = (*Y1) * coeffs[stride*1*i];
-      tmp[2] = (*Y2) * coeffs[stride*2*i];
-      tmp[3] = (*Y3) * coeffs[stride*3*i];
-      tmp[4] = (*Y4) * coeffs[stride*4*i];
-      
-      tmp[7]  = tmp[1] + tmp[4];
-      tmp[8]  = tmp[2] + tmp[3];
-      tmp[9]  = tmp[2] - tmp[3];
-      tmp[10] = tmp[1] - tmp[4];
-      
-      (*Y0) += tmp[7];
-      (*Y0) += tmp[8];
+      uword p = 0;
       
-      tmp[5] = tmp[0] + cx_type( ( (tmp[7].real() * a_real) + (tmp[8].real() * b_real) ), ( (tmp[7].imag() * a_real) + (tmp[8].imag() * b_real) ) );
+      for(; (p+L) <= m; p += L)
+        {
+        for(uword j=0; j < r; ++j)
+        for(uword l=0; l < L; ++l)
+          {
+          a_re[j*L + l] = x_re[x_e*(p + l + j*m)];
+          a_im[j*L + l] = x_im[x_e*(p + l + j*m)];
+          }
+        
+        for(uword l=0; l < L; ++l)  { butterfly::apply(&a_re[l], &a_im[l], L); }
+        
+        for(uword l=0; l < L; ++l)
+          {
+          y_re[y_e*(r*(p+l))] = a_re[l];
+          y_im[y_e*(r*(p+l))] = a_im[l];
+          }
+        
+        for(uword k=1; k < r; ++k)
+        for(uword l=0; l < L; ++l)
+          {
+          const T wr = w_re[(k-1)*m + p + l];
+          const T wi = w_im[(k-1)*m + p + l];
+          
+          const T ar = a_re[k*L + l];
+          const T ai = a_im[k*L + l];
+          
+          y_re[y_e*(r*(p+l) + k)] = ar*wr - ai*wi;
+          y_im[y_e*(r*(p+l) + k)] = ar*wi + ai*wr;
+          }
+        }
       
-      tmp[6] =  cx_type( ( (tmp[10].imag() * a_imag) + (tmp[9].imag() * b_imag) ), ( -(tmp[10].real() * a_imag) - (tmp[9].real() * b_imag) ) );
+      for(; p < m; ++p)
+        {
+        for(uword j=0; j < r; ++j)  { a_re[j] = x_re[x_e*(p + j*m)];  a_im[j] = x_im[x_e*(p + j*m)]; }
+        
+        butterfly::apply(a_re, a_im, 1);
+        
+        y_re[y_e*(r*p)] = a_re[0];
+        y_im[y_e*(r*p)] = a_im[0];
+        
+        for(uword k=1; k < r; ++k)
+          {
+          fft_rotate<T,inverse>::mul(a_re[k], a_im[k], w_re[(k-1)*m + p], w_im[(k-1)*m + p]);
+          
+          y_re[y_e*(r*p + k)] = a_re[k];
+          y_im[y_e*(r*p + k)] = a_im[k];
+          }
+        }
       
-      (*Y1) = tmp[5] - tmp[6];
-      (*Y4) = tmp[5] + tmp[6];
+      return;
+      }
+    
+    for(uword p=0; p < m; ++p)
+      {
+      const T* xp_re = x_re + x_e*s*p;
+      const T* xp_im = x_im + x_e*s*p;
       
-      tmp[11] = tmp[0] +  cx_type( ( (tmp[7].real() * b_real) + (tmp[8].real() * a_real) ), ( (tmp[7].imag() * b_real) + (tmp[8].imag() * a_real) ) );
+      T* yp_re = y_re + y_e*s*r*p;
+      T* yp_im = y_im + y_e*s*r*p;
       
-      tmp[12] = cx_type( ( -(tmp[10].imag() * b_imag) + (tmp[9].imag() * a_imag) ), (  (tmp[10].real() * b_imag) - (tmp[9].real() * a_imag) ) );
+      uword q = 0;
       
-      (*Y2) = tmp[11] + tmp[12];
-      (*Y3) = tmp[11] - tmp[12];
+      for(; (q+L) <= s; q += L)
+        {
+        for(uword j=0; j < r; ++j)
+        for(uword l=0; l < L; ++l)
+          {
+          a_re[j*L + l] = xp_re[x_e*(q + l + j*s*m)];
+          a_im[j*L + l] = xp_im[x_e*(q + l + j*s*m)];
+          }
+        
+        for(uword l=0; l < L; ++l)  { butterfly::apply(&a_re[l], &a_im[l], L); }
+        
+        for(uword l=0; l < L; ++l)
+          {
+          yp_re[y_e*(q+l)] = a_re[l];
+          yp_im[y_e*(q+l)] = a_im[l];
+          }
+        
+        for(uword k=1; k < r; ++k)
+          {
+          const T wr = w_re[(k-1)*m + p];
+          const T wi = w_im[(k-1)*m + p];
+          
+          for(uword l=0; l < L; ++l)
+            {
+            const T ar = a_re[k*L + l];
+            const T ai = a_im[k*L + l];
+            
+            yp_re[y_e*(q + l + k*s)] = ar*wr - ai*wi;
+            yp_im[y_e*(q + l + k*s)] = ar*wi + ai*wr;
+            }
+          }
+        }
       
-      Y0++;
-      Y1++;
-      Y2++;
-      Y3++;
-      Y4++;
+      for(; q < s; ++q)
+        {
+        for(uword j=0; j < r; ++j)  { a_re[j] = xp_re[x_e*(q + j*s*m)];  a_im[j] = xp_im[x_e*(q + j*s*m)]; }
+        
+        butterfly::apply(a_re, a_im, 1);
+        
+        yp_re[y_e*q] = a_re[0];
+        yp_im[y_e*q] = a_im[0];
+        
+        for(uword k=1; k < r; ++k)
+          {
+          fft_rotate<T,inverse>::mul(a_re[k], a_im[k], w_re[(k-1)*m + p], w_im[(k-1)*m + p]);
+          
+          yp_re[y_e*(q + k*s)] = a_re[k];
+          yp_im[y_e*(q + k*s)] = a_im[k];
+          }
+        }
       }
     }
   
   
   
+  //! one Stockham pass with a generic radix, computing the r point transforms directly
   arma_hot
   inline
   void
-  butterfly_N(cx_type* Y, const uword stride, const uword m, const uword r)
+  pass_generic(T* y_re, T* y_im, const T* x_re, const T* x_im, const uword stage, const uword m, const uword s, const uword r, const uword x_e, const uword y_e) const
     {
-    arma_extra_debug_sigprint();
+    const T* w_re = tw_re.memptr() + tw_offset[stage];
+    const T* w_im = tw_im.memptr() + tw_offset[stage];
     
-    const cx_type* coeffs = coeffs_ptr();
+    const T* root_re = w_re + (r-1)*m;
+    const T* root_im = w_im + (r-1)*m;
     
-    tmp_array.set_min_size(r);
-    cx_type* tmp = tmp_array.memptr();
+    const uword x_step = x_e*s*m;
     
-    for(uword u=0; u < m; ++u)
+    podarray<T> tmp(2*r);
+    
+    T* a_re = tmp.memptr();
+    T* a_im = a_re + r;
+    
+    for(uword p=0; p < m; ++p)
       {
-      uword k = u;
-      
-      for(uword v=0; v < r; ++v)
-        {
-        tmp[v] = Y[k];
-        k += m;
-        }
-      
-      k = u;
-      
-      for(uword v=0; v < r; ++v)
+      for(uword q=0; q < s; ++q)
         {
-        Y[k] = tmp[0];
+        const T* xp_re = x_re + x_e*(s*p + q);
+        const T* xp_im = x_im + x_e*(s*p + q);
+        
+        T* yp_re = y_re + y_e*(s*r*p + q);
+        T* yp_im = y_im + y_e*(s*r*p + q);
         
-        uword j = 0;
+        for(uword j=0; j < r; ++j)  { a_re[j] = xp_re[j*x_step];  a_im[j] = xp_im[j*x_step]; }
         
-        for(uword w=1; w < r; ++w)
+        for(uword k=0; k < r; ++k)
           {
-          j += stride * k;
+          T acc_re = a_re[0];
+          T acc_im = a_im[0];
+          
+          uword e = 0;
+          
+          for(uword j=1; j < r; ++j)
+            {
+            e += k;
+            
+            if(e >= r)  { e -= r; }
+            
+            acc_re += a_re[j]*root_re[e] - a_im[j]*root_im[e];
+            acc_im += a_re[j]*root_im[e] + a_im[j]*root_re[e];
+            }
           
-          if(j >= N) { j -= N; }
+          if(k > 0)
+            {
+            fft_rotate<T,inverse>::mul(acc_re, acc_im, w_re[(k-1)*m + p], w_im[(k-1)*m + p]);
+            }
           
-          Y[k] += tmp[w] * coeffs[j];
+          yp_re[y_e*k*s] = acc_re;
+          yp_im[y_e*k*s] = acc_im;
           }
-        
-        k += m;
         }
       }
     }
   
   
   
+  //! pass i, where the sub-transforms have length n and are interleaved with stride s
+  template<uword x_e, uword y_e>
   inline
   void
-  run(cx_type* Y, const cx_type* X, const uword stage = 0, const uword stride = 1)
+  run_pass(T* y_re, T* y_im, const T* x_re, const T* x_im, const uword i, const uword n, const uword s) const
     {
-    arma_extra_debug_sigprint();
+    const uword r = radix[i];
+    const uword m = n / r;
+    
+    switch(r)
+      {
+      case  2:  pass< fft_butterfly_2 <T,inverse>, x_e, y_e >(y_re, y_im, x_re, x_im, i, m, s);  break;
+      case  3:  pass< fft_butterfly_3 <T,inverse>, x_e, y_e >(y_re, y_im, x_re, x_im, i, m, s);  break;
+      case  4:  pass< fft_butterfly_4 <T,inverse>, x_e, y_e >(y_re, y_im, x_re, x_im, i, m, s);  break;
+      case  5:  pass< fft_butterfly_5 <T,inverse>, x_e, y_e >(y_re, y_im, x_re, x_im, i, m, s);  break;
+      case  8:  pass< fft_butterfly_8 <T,inverse>, x_e, y_e >(y_re, y_im, x_re, x_im, i, m, s);  break;
+      case 16:  pass< fft_butterfly_16<T,inverse>, x_e, y_e >(y_re, y_im, x_re, x_im, i, m, s);  break;
+      default:  pass_generic(y_re, y_im, x_re, x_im, i, m, s, r, x_e, y_e);                       break;
+      }
+    }
+  
+  
+  
+  //! transform the split data in a; b is used as the other buffer of the passes.
+  //! returns true if the result is in b
+  inline
+  bool
+  run_split(T* a_re, T* a_im, T* b_re, T* b_im) const
+    {
+    uword n = N;
+    uword s = 1;
     
-    const uword m = residue[stage];
-    const uword r =   radix[stage];
+    bool in_b = false;
     
-    const cx_type *Y_end = Y + r*m;
+    for(uword i=0; i < radix.n_elem; ++i)
+      {
+      const T* x_re = (in_b) ? b_re : a_re;
+      const T* x_im = (in_b) ? b_im : a_im;
+      
+      T* y_re = (in_b) ? a_re : b_re;
+      T* y_im = (in_b) ? a_im : b_im;
+      
+      run_pass<1,1>(y_re, y_im, x_re, x_im, i, n, s);
+      
+      n /= radix[i];
+      s *= radix[i];
+      
+      in_b = !in_b;
+      }
     
-    if(m == 1)
+    return in_b;
+    }
+  
+  
+  
+  inline
+  void
+  run_bluestein(cx_type* Y, const cx_type* X, T* work) const
+    {
+    const uword M = bs_M;
+    
+    T* a_re = work;
+    T* a_im = a_re + M;
+    T* b_re = a_im + M;
+    T* b_im = b_re + M;
+    
+    for(uword n=0; n < N; ++n)
       {
-      for(cx_type* Yi = Y; Yi != Y_end; Yi++, X += stride)  {  (*Yi) = (*X);  }
+      const T x_re = X[n].real();
+      const T x_im = X[n].imag();
+      
+      a_re[n] = x_re*bs_w_re[n] - x_im*bs_w_im[n];
+      a_im[n] = x_re*bs_w_im[n] + x_im*bs_w_re[n];
       }
-    else
+    
+    arrayops::fill_zeros(a_re + N, M-N);
+    arrayops::fill_zeros(a_im + N, M-N);
+    
+    const bool in_b = bs_engine->run_split(a_re, a_im, b_re, b_im);
+    
+    T* c_re = (in_b) ? b_re : a_re;
+    T* c_im = (in_b) ? b_im : a_im;
+    T* d_re = (in_b) ? a_re : b_re;
+    T* d_im = (in_b) ? a_im : b_im;
+    
+    // multiply by the transformed chirp, and conjugate so that the next forward transform computes the inverse transform
+    for(uword i=0; i < M; ++i)
       {
-      const uword next_stage  = stage + 1;
-      const uword next_stride = stride * r;
+      const T tmp_re = c_re[i]*bs_b_re[i] - c_im[i]*bs_b_im[i];
+      const T tmp_im = c_re[i]*bs_b_im[i] + c_im[i]*bs_b_re[i];
       
-      for(cx_type* Yi = Y; Yi != Y_end; Yi += m, X += stride)  { run(Yi, X, next_stage, next_stride); }
+      c_re[i] =  tmp_re;
+      c_im[i] = -tmp_im;
       }
     
-    switch(r)
+    const bool in_d = bs_engine->run_split(c_re, c_im, d_re, d_im);
+    
+    const T* e_re = (in_d) ? d_re : c_re;
+    const T* e_im = (in_d) ? d_im : c_im;
+    
+    for(uword n=0; n < N; ++n)
       {
-      case 2:  butterfly_2(Y, stride, m   );  break;
-      case 3:  butterfly_3(Y, stride, m   );  break;
-      case 4:  butterfly_4(Y, stride, m   );  break;
-      case 5:  butterfly_5(Y, stride, m   );  break;
-      default: butterfly_N(Y, stride, m, r);  break;
+      const T w_re = bs_w_re[n];
+      const T w_im = bs_w_im[n];
+      
+      Y[n] = cx_type( (e_re[n]*w_re + e_im[n]*w_im), (e_re[n]*w_im - e_im[n]*w_re) );
       }
     }
-
-
+  
+  
+  
+  //! number of elements of type T used as workspace by run()
+  inline
+  uword
+  n_work() const
+    {
+    if(bs_engine != NULL)  { return 4*bs_M; }
+    
+    return (radix.n_elem > 1) ? 2*N : uword(0);
+    }
+  
+  
+  
+  //! approximate amount of memory held by the engine, in bytes
+  inline
+  uword
+  n_bytes() const
+    {
+    const uword n_uword = radix.n_elem + tw_offset.n_elem;
+    const uword n_T     = tw_re.n_elem + tw_im.n_elem + bs_w_re.n_elem + bs_w_im.n_elem + bs_b_re.n_elem + bs_b_im.n_elem;
+    
+    const uword n_bs = (bs_engine != NULL) ? bs_engine->n_bytes() : uword(0);
+    
+    return sizeof(fft_engine) + n_uword*sizeof(uword) + n_T*sizeof(T) + n_bs;
+    }
+  
+  
+  
+  //! transform X into Y, both of length N; X and Y must not overlap
+  inline
+  void
+  run(cx_type* Y, const cx_type* X) const
+    {
+    arma_extra_debug_sigprint();
+    
+    podarray<T> work( n_work() );
+    
+    run(Y, X, work.memptr());
+    }
+  
+  
+  
+  //! as above, using the given workspace of n_work() elements.
+  //! the first pass reads the interleaved complex numbers in X directly, and the last pass writes directly to Y;
+  //! the memory of Y is also used as one of the two buffers of the intermediate passes
+  inline
+  void
+  run(cx_type* Y, const cx_type* X, T* work) const
+    {
+    arma_extra_debug_sigprint();
+    
+    if(bs_engine != NULL)  { run_bluestein(Y, X, work); return; }
+    
+    const uword n_passes = radix.n_elem;
+    
+    if(n_passes == 0)  { arrayops::copy(Y, X, N); return; }
+    
+    const T* X_mem = reinterpret_cast<const T*>(X);
+          T* Y_mem = reinterpret_cast<      T*>(Y);
+    
+    T* a_re = work;
+    T* a_im = a_re + N;
+    T* b_re = Y_mem;
+    T* b_im = Y_mem + N;
+    
+    // the last intermediate pass writes to a
+    bool to_a = ( ((n_passes - 2) % 2) == 0 );
+    
+    uword n = N;
+    uword s = 1;
+    
+    for(uword i=0; i < n_passes; ++i)
+      {
+      const bool first = (i == 0);
+      const bool last  = (i == n_passes-1);
+      
+      T* y_re = (to_a) ? a_re : b_re;
+      T* y_im = (to_a) ? a_im : b_im;
+      
+      const T* x_re = (to_a) ? b_re : a_re;
+      const T* x_im = (to_a) ? b_im : a_im;
+      
+           if(first && last)  { run_pass<2,2>(Y_mem, Y_mem+1, X_mem, X_mem+1, i, n, s); }
+      else if(first        )  { run_pass<2,1>(y_re,  y_im,    X_mem, X_mem+1, i, n, s); }
+      else if(last         )  { run_pass<1,2>(Y_mem, Y_mem+1, x_re,  x_im,    i, n, s); }
+      else                    { run_pass<1,1>(y_re,  y_im,    x_re,  x_im,    i, n, s); }
+      
+      n /= radix[i];
+      s *= radix[i];
+      
+      to_a = !to_a;
+      }
+    }
+  
+  
+  private:
+  
+  fft_engine(const fft_engine&);              //!< not implemented
+  fft_engine& operator=(const fft_engine&);   //!< not implemented
   };
 
 
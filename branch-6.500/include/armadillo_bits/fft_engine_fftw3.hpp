@@ -0,0 +1,193 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup fft_engine_fftw3
+//! @{
+
+
+
+#if defined(ARMA_USE_FFTW3)
+
+//! FFT of length N via FFTW3, with the same interface as fft_engine.
+//! two plans are made: one for memory with the alignment preferred by FFTW3 (eg. memory from Mat),
+//! and one for arbitrary memory (eg. a column of a subview).
+//! if FFTW3 cannot make the plans, the built-in engine is used instead.
+//! Once constructed, the engine is not modified, so it can be used by several threads at once.
+template<typename cx_type, bool inverse>
+class fft_engine_fftw3
+  {
+  public:
+  
+  typedef typename get_pod_type<cx_type>::result T;
+  
+  const uword N;
+  
+  void* plan_aligned;
+  void* plan_unaligned;
+  
+  const fft_engine<cx_type,inverse>* fallback;
+  
+  
+  
+  inline
+  ~fft_engine_fftw3()
+    {
+    arma_extra_debug_sigprint();
+    
+    fftw3::destroy_plan<cx_type>(plan_aligned);
+    fftw3::destroy_plan<cx_type>(plan_unaligned);
+    
+    if(fallback != NULL)  { delete fallback; }
+    }
+  
+  
+  
+  inline
+  fft_engine_fftw3(const uword in_N)
+    : N             (in_N)
+    , plan_aligned  (NULL)
+    , plan_unaligned(NULL)
+    , fallback      (NULL)
+    {
+    arma_extra_debug_sigprint();
+    
+    if(N == 0)  { return; }
+    
+    if( N <= uword(std::numeric_limits<int>::max()) )  { make_plans(); }
+    
+    if( (plan_aligned == NULL) || (plan_unaligned == NULL) )
+      {
+      fftw3::destroy_plan<cx_type>(plan_aligned);
+      fftw3::destroy_plan<cx_type>(plan_unaligned);
+      
+      plan_aligned   = NULL;
+      plan_unaligned = NULL;
+      
+      fallback = new fft_engine<cx_type,inverse>(N);
+      }
+    }
+  
+  
+  
+  //! number of elements of type T used as workspace by run()
+  inline
+  uword
+  n_work() const
+    {
+    return (fallback != NULL) ? fallback->n_work() : uword(0);
+    }
+  
+  
+  
+  //! approximate amount of memory held by the engine, in bytes;
+  //! the size of the FFTW3 plans is not known, so it is taken to be about that of the twiddle factors
+  inline
+  uword
+  n_bytes() const
+    {
+    return sizeof(fft_engine_fftw3) + ( (fallback != NULL) ? fallback->n_bytes() : N*sizeof(cx_type) );
+    }
+  
+  
+  
+  //! Y and X must not overlap
+  inline
+  void
+  run(cx_type* Y, const cx_type* X) const
+    {
+    arma_extra_debug_sigprint();
+    
+    if(fallback != NULL)  { fallback->run(Y, X); return; }
+    
+    execute(Y, X);
+    }
+  
+  
+  
+  //! as above, using the given workspace of n_work() elements
+  inline
+  void
+  run(cx_type* Y, const cx_type* X, T* work) const
+    {
+    arma_extra_debug_sigprint();
+    
+    if(fallback != NULL)  { fallback->run(Y, X, work); return; }
+    
+    execute(Y, X);
+    }
+  
+  
+  
+  private:
+  
+  inline
+  void
+  make_plans()
+    {
+    arma_extra_debug_sigprint();
+
+    #if defined(ARMA_FFTW3_MEASURE)
+      const unsigned flags = fftw3::measure  | fftw3::preserve_input;
+    #else
+      const unsigned flags = fftw3::estimate | fftw3::preserve_input;
+    #endif
+    
+    const int n    = int(N);
+    const int sign = (inverse) ? fftw3::backward : fftw3::forward;
+    
+    // the planner may overwrite the arrays, hence they can't be the arrays to be transformed
+    cx_type* A = fftw3::acquire<cx_type>(N);
+    cx_type* B = fftw3::acquire<cx_type>(N);
+    
+    if( (A != NULL) && (B != NULL) )
+      {
+      plan_aligned   = fftw3::plan_dft_1d(n, A, B, sign, flags                     );
+      plan_unaligned = fftw3::plan_dft_1d(n, A, B, sign, flags | fftw3::unaligned);
+      }
+    
+    fftw3::release(A);
+    fftw3::release(B);
+    }
+  
+  
+  
+  inline
+  void
+  execute(cx_type* Y, const cx_type* X) const
+    {
+    const bool aligned = fftw3::is_aligned(X) && fftw3::is_aligned(Y);
+    
+    fftw3::execute_dft( ((aligned) ? plan_aligned : plan_unaligned), X, Y );
+    }
+  
+  
+  fft_engine_fftw3(const fft_engine_fftw3&);              //!< not implemented
+  fft_engine_fftw3& operator=(const fft_engine_fftw3&);   //!< not implemented
+  };
+
+#endif
+
+
+
+//! complex FFT engine used by fft_plan and fft_engine_real:
+//! FFTW3 when ARMA_USE_FFTW3 is enabled, otherwise the built-in fft_engine
+template<typename cx_type, bool inverse>
+struct fft_engine_type
+  {
+  #if defined(ARMA_USE_FFTW3)
+    typedef fft_engine_fftw3<cx_type,inverse> result;
+  #else
+    typedef fft_engine<cx_type,inverse>       result;
+  #endif
+  };
+
+
+
+//! @}
@@ -0,0 +1,136 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup fft_engine_pair
+//! @{
+
+
+
+template<typename eT>
+struct fft_engine_pair_types
+  {
+  typedef fft_engine_real< std::complex<eT>, false > fwd_type;
+  typedef fft_engine_real< std::complex<eT>, true  > inv_type;
+  
+  static const bool is_real = true;
+  };
+
+
+
+template<typename T>
+struct fft_engine_pair_types< std::complex<T> >
+  {
+  typedef typename fft_engine_type< std::complex<T>, false >::result fwd_type;
+  typedef typename fft_engine_type< std::complex<T>, true  >::result inv_type;
+  
+  static const bool is_real = false;
+  };
+
+
+
+//! forward and inverse FFTs of length N for vectors with real or complex elements (eT),
+//! for use by algorithms that work in the frequency domain (eg. convolution).
+//! for real elements only the first N/2+1 values of the spectrum are kept, as the rest follows from conjugate symmetry.
+//! Once constructed, the engines are not modified, so they can be used by several threads at once.
+template<typename eT>
+class fft_engine_pair
+  {
+  public:
+  
+  typedef typename get_pod_type<eT>::result T;
+  typedef std::complex<T>                   cx_type;
+  
+  typedef typename fft_engine_pair_types<eT>::fwd_type fwd_type;
+  typedef typename fft_engine_pair_types<eT>::inv_type inv_type;
+  
+  const uword N;
+  const uword n_spec;   //!< number of values of the spectrum
+  
+  const fft_engine_ref<fwd_type> fwd;
+  const fft_engine_ref<inv_type> inv;
+  
+  
+  
+  inline
+  explicit
+  fft_engine_pair(const uword in_N)
+    : N     (in_N)
+    , n_spec( (fft_engine_pair_types<eT>::is_real) ? (in_N/2 + 1) : in_N )
+    , fwd   (in_N)
+    , inv   (in_N)
+    {
+    arma_extra_debug_sigprint();
+    }
+  
+  
+  
+  //! number of elements of type T used as workspace by forward() and inverse()
+  inline
+  uword
+  n_work() const
+    {
+    return (std::max)( fwd->n_work(), inv->n_work() );
+    }
+  
+  
+  
+  //! N values in X to n_spec values in Y
+  inline
+  void
+  forward(cx_type* Y, const eT* X, T* work) const
+    {
+    fwd->run(Y, X, work);
+    }
+  
+  
+  
+  //! n_spec values in X to N values in Y, without scaling; X and Y must not overlap
+  inline
+  void
+  inverse(eT* Y, const cx_type* X, T* work) const
+    {
+    inv->run(Y, X, work);
+    }
+  
+  
+  
+  //! smallest length >= n of the form 2^a * 3^b * 5^c, for which the transforms are fast;
+  //! for real elements the length is also even, so that the half-length complex transform is used
+  inline
+  static
+  uword
+  fast_length(const uword n)
+    {
+    if(n <= 2)  { return (fft_engine_pair_types<eT>::is_real) ? uword(2) : (std::max)(n, uword(1)); }
+    
+    for(uword m = n; ; ++m)
+      {
+      if( (fft_engine_pair_types<eT>::is_real) && ((m % 2) != 0) )  { continue; }
+      
+      uword k = m;
+      
+      while((k % 2) == 0)  { k /= 2; }
+      while((k % 3) == 0)  { k /= 3; }
+      while((k % 5) == 0)  { k /= 5; }
+      
+      if(k == 1)  { return m; }
+      }
+    }
+  
+  
+  private:
+  
+  fft_engine_pair(const fft_engine_pair&);              //!< not implemented
+  fft_engine_pair& operator=(const fft_engine_pair&);   //!< not implemented
+  };
+
+
+
+//! @}
@@ -0,0 +1,274 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup fft_engine_real
+//! @{
+
+
+
+//! FFT of real data of length N.
+//! The forward transform (inverse = false) maps N real values to the first N/2+1 values of their transform;
+//! the remaining values are given by conjugate symmetry, ie. Y[N-k] = conj(Y[k]).
+//! The inverse transform (inverse = true) does the opposite, without scaling.
+//! For even N, the N real values are packed into N/2 complex values and a complex transform of length N/2 is used;
+//! for odd N, a complex transform of length N is used.
+//! Once constructed, the engine is not modified, so it can be used by several threads at once.
+template<typename cx_type, bool inverse>
+class fft_engine_real
+  {
+  public:
+  
+  typedef typename get_pod_type<cx_type>::result T;
+  
+  const uword N;
+  const uword M;    //!< length of the complex transform
+  
+  typedef typename fft_engine_type<cx_type,inverse>::result engine_type;
+  
+  const engine_type* engine;
+  bool               owns_engine;
+  
+  podarray<T> tw_re;    //!< exp(-+ i*2*pi*k/N), for k < N/2; only used for even N
+  podarray<T> tw_im;
+  
+  
+  
+  inline
+  ~fft_engine_real()
+    {
+    arma_extra_debug_sigprint();
+    
+    if(owns_engine)
+      {
+      delete engine;
+      }
+    else
+      {
+      fft_engine_cache<engine_type>::release(engine);
+      }
+    }
+  
+  
+  
+  inline
+  fft_engine_real(const uword in_N)
+    : N          (in_N                                  )
+    , M          ( ((in_N % 2) == 0) ? (in_N/2) : in_N )
+    , engine     (NULL                                  )
+    , owns_engine(false                                 )
+    {
+    arma_extra_debug_sigprint();
+    
+    if(N == 0)  { return; }
+    
+    engine = fft_engine_cache<engine_type>::get(M);
+    
+    if(engine == NULL)  { engine = new engine_type(M); owns_engine = true; }
+    
+    if(M == N)  { return; }
+    
+    tw_re.set_size(M);
+    tw_im.set_size(M);
+    
+    for(uword k=0; k < M; ++k)
+      {
+      fft_engine<cx_type,inverse>::calc_root(tw_re[k], tw_im[k], k, N);
+      }
+    }
+  
+  
+  
+  //! number of elements of type T used as workspace by run()
+  inline
+  uword
+  n_work() const
+    {
+    if(N == 0)  { return 0; }
+    
+    const uword n_own = (M == N) ? 4*N : ( (inverse) ? 2*M : uword(0) );
+    
+    return n_own + engine->n_work();
+    }
+  
+  
+  
+  //! approximate amount of memory held by the engine, in bytes; a complex engine taken from the cache is not included
+  inline
+  uword
+  n_bytes() const
+    {
+    const uword n_engine = ( owns_engine && (engine != NULL) ) ? engine->n_bytes() : uword(0);
+    
+    return sizeof(fft_engine_real) + (tw_re.n_elem + tw_im.n_elem)*sizeof(T) + n_engine;
+    }
+  
+  
+  
+  //! forward transform: N real values in X to N/2+1 complex values in Y
+  inline
+  void
+  run(cx_type* Y, const T* X) const
+    {
+    arma_extra_debug_sigprint();
+    
+    podarray<T> work( n_work() );
+    
+    run(Y, X, work.memptr());
+    }
+  
+  
+  
+  //! as above, using the given workspace of n_work() elements
+  inline
+  void
+  run(cx_type* Y, const T* X, T* work) const
+    {
+    arma_extra_debug_sigprint();
+    
+    if(N == 0)  { return; }
+    
+    if(M == N)
+      {
+      cx_type* A = reinterpret_cast<cx_type*>(work);
+      cx_type* B = A + N;
+      
+      for(uword i=0; i < N; ++i)  { A[i] = cx_type(X[i], T(0)); }
+      
+      engine->run(B, A, work + 4*N);
+      
+      arrayops::copy(Y, B, N/2 + 1);
+      
+      return;
+      }
+    
+    // X[2n] + i*X[2n+1] has the same memory layout as X
+    engine->run(Y, reinterpret_cast<const cx_type*>(X), work);
+    
+    // with Z the transform of the packed values, the transforms of the even and odd values are
+    // E[k] = (Z[k] + conj(Z[M-k]))/2 and O[k] = -i*(Z[k] - conj(Z[M-k]))/2, while Y[k] = E[k] + W^k * O[k],
+    // where W = exp(-i*2*pi/N)
+    
+    const T Z0_re = Y[0].real();
+    const T Z0_im = Y[0].imag();
+    
+    Y[0] = cx_type(Z0_re + Z0_im, T(0));
+    Y[M] = cx_type(Z0_re - Z0_im, T(0));
+    
+    const T* tw_re_mem = tw_re.memptr();
+    const T* tw_im_mem = tw_im.memptr();
+    
+    for(uword k=1, j=M-1; k <= j; ++k, --j)
+      {
+      const T a_re = Y[k].real();
+      const T a_im = Y[k].imag();
+      const T b_re = Y[j].real();
+      const T b_im = Y[j].imag();
+      
+      const T e_re = T(0.5) * (a_re + b_re);
+      const T e_im = T(0.5) * (a_im - b_im);
+      const T o_re = T(0.5) * (a_im + b_im);
+      const T o_im = T(0.5) * (b_re - a_re);
+      
+      // W^j = -conj(W^k), hence Y[j] = conj(E[k]) + conj(W^k * O[k])
+      const T p_re = tw_re_mem[k]*o_re - tw_im_mem[k]*o_im;
+      const T p_im = tw_re_mem[k]*o_im + tw_im_mem[k]*o_re;
+      
+      Y[k] = cx_type(e_re + p_re,   e_im + p_im );
+      Y[j] = cx_type(e_re - p_re, -(e_im - p_im));
+      }
+    }
+  
+  
+  
+  //! inverse transform: N/2+1 complex values in X to N real values in Y, without scaling;
+  //! the imaginary parts of X[0] and (for even N) X[N/2] are ignored
+  inline
+  void
+  run(T* Y, const cx_type* X) const
+    {
+    arma_extra_debug_sigprint();
+    
+    podarray<T> work( n_work() );
+    
+    run(Y, X, work.memptr());
+    }
+  
+  
+  
+  //! as above, using the given workspace of n_work() elements
+  inline
+  void
+  run(T* Y, const cx_type* X, T* work) const
+    {
+    arma_extra_debug_sigprint();
+    
+    if(N == 0)  { return; }
+    
+    if(M == N)
+      {
+      cx_type* A = reinterpret_cast<cx_type*>(work);
+      cx_type* B = A + N;
+      
+      A[0] = cx_type(X[0].real(), T(0));
+      
+      for(uword k=1; k <= N/2; ++k)  { A[k] = X[k];  A[N-k] = std::conj(X[k]); }
+      
+      engine->run(B, A, work + 4*N);
+      
+      for(uword i=0; i < N; ++i)  { Y[i] = B[i].real(); }
+      
+      return;
+      }
+    
+    // form the transform of the packed values, Z[k] = E[k] + i*O[k],
+    // with E[k] = X[k] + conj(X[M-k]) and O[k] = (X[k] - conj(X[M-k])) * W^k, where W = exp(+i*2*pi/N)
+    
+    cx_type* Z = reinterpret_cast<cx_type*>(work);
+    
+    const T X0 = X[0].real();
+    const T XM = X[M].real();
+    
+    Z[0] = cx_type(X0 + XM, X0 - XM);
+    
+    const T* tw_re_mem = tw_re.memptr();
+    const T* tw_im_mem = tw_im.memptr();
+    
+    for(uword k=1, j=M-1; k <= j; ++k, --j)
+      {
+      const T a_re = X[k].real();
+      const T a_im = X[k].imag();
+      const T b_re = X[j].real();
+      const T b_im = X[j].imag();
+      
+      const T e_re = a_re + b_re;
+      const T e_im = a_im - b_im;
+      const T d_re = a_re - b_re;
+      const T d_im = a_im + b_im;
+      
+      const T o_re = tw_re_mem[k]*d_re - tw_im_mem[k]*d_im;
+      const T o_im = tw_re_mem[k]*d_im + tw_im_mem[k]*d_re;
+      
+      // E[j] = conj(E[k]) and O[j] = conj(O[k])
+      Z[k] = cx_type(e_re - o_im, e_im + o_re);
+      Z[j] = cx_type(e_re + o_im, o_re - e_im);
+      }
+    
+    engine->run(reinterpret_cast<cx_type*>(Y), Z, work + 2*M);
+    }
+  
+  
+  private:
+  
+  fft_engine_real(const fft_engine_real&);              //!< not implemented
+  fft_engine_real& operator=(const fft_engine_real&);   //!< not implemented
+  };
+
+
+//! @}
@@ -0,0 +1,157 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup fft_plan
+//! @{
+
+
+
+//! process-wide cache of FFT engines of one type (eg. fft_engine<cx_double,false>), keyed by length.
+//! the cache holds at most max_bytes of engines; when it holds more, the least recently used engines are evicted.
+//! each engine returned by get() must be handed back via release(), so that engines evicted while in use
+//! are only deleted once their last user has finished with them.
+//! engines are constructed without holding the lock of the cache, as constructing an engine may be slow
+//! and may itself use the cache (eg. fft_engine_real)
+template<typename engine_type>
+class fft_engine_cache
+  {
+  public:
+  
+  static const uword max_bytes = 32*1024*1024;
+  static const uword max_N     = 65536;  //!< engines for longer transforms are not cached, as they are likely to be used only once
+  
+  //! returns NULL if an engine of the given length can't be cached
+  inline static const engine_type* get(const uword N);
+  
+  inline static void release(const engine_type* engine);
+  
+  inline static uword n_entries();  //!< number of cached engines
+  inline static uword n_bytes();    //!< amount of memory held by the cached engines
+  
+  
+  private:
+  
+  struct entry_type
+    {
+    uword              N;
+    const engine_type* engine;
+    uword              n_bytes;
+    uword              n_users;
+    uword              last_use;
+    bool               evicted;   //!< no longer cached, but still in use
+    };
+  
+  struct state_type
+    {
+    std::vector<entry_type> entries;
+    
+    uword n_bytes;
+    uword clock;
+
+    #if defined(ARMA_USE_CXX11)
+      std::mutex mutex_obj;
+    #endif
+    
+    inline  state_type();
+    inline ~state_type();
+    };
+  
+  inline static state_type& get_state();
+  inline static bool&       is_destroyed();
+  
+  inline static const engine_type* find_locked   (state_type& state, const uword N);
+  inline static const engine_type* insert_locked (state_type& state, const uword N, const engine_type* engine);
+  inline static void               release_locked(state_type& state, const engine_type* engine);
+  inline static void               evict_locked  (state_type& state);
+  };
+
+
+
+//! engine of the given type and length, taken from fft_engine_cache when possible
+template<typename engine_type>
+class fft_engine_ref
+  {
+  public:
+  
+  const engine_type* engine;
+  
+  inline ~fft_engine_ref();
+  inline explicit fft_engine_ref(const uword N);
+  
+  inline const engine_type* operator->() const { return engine; }
+  
+  
+  private:
+  
+  bool owns_engine;
+  
+  fft_engine_ref(const fft_engine_ref&);              //!< not implemented
+  fft_engine_ref& operator=(const fft_engine_ref&);   //!< not implemented
+  };
+
+
+
+//! reusable plan for one dimensional FFTs of length N;
+//! the coefficients of the transform (or the FFTW3 plans, when ARMA_USE_FFTW3 is enabled) are computed once and shared by all plans of the same length, direction and element type.
+//! a plan object can be used by several threads at once.
+template<typename eT>
+class fft_plan
+  {
+  public:
+  
+  typedef eT                                elem_type;
+  typedef typename get_pod_type<eT>::result pod_type;
+  
+  const uword N;
+  const bool  inverse;
+  
+  inline ~fft_plan();
+  inline explicit fft_plan(const uword in_N, const bool in_inverse = false);
+  
+  inline            fft_plan(const fft_plan& x);
+  inline const fft_plan& operator=(const fft_plan& x);
+  
+  template<typename T1> inline void apply(Mat<eT>& out, const Base<eT,      T1>& X) const;
+  template<typename T1> inline void apply(Mat<eT>& out, const Base<pod_type,T1>& X) const;
+  
+  template<typename T1> inline Mat<eT> operator()(const Base<eT,      T1>& X) const;
+  template<typename T1> inline Mat<eT> operator()(const Base<pod_type,T1>& X) const;
+  
+  //! transform one vector of length N, without scaling the inverse transform; out and in must not overlap
+  inline void run(eT* out, const eT* in) const;
+  
+  //! as above, using the given workspace of n_work() elements, so that no memory is allocated
+  inline void run(eT* out, const eT* in, pod_type* work) const;
+  
+  inline uword n_work() const;
+  
+  //! import or export the accumulated FFTW3 wisdom, so that plans are made faster in later runs;
+  //! return false if the operation failed, or if FFTW3 is not used
+  inline static bool load_wisdom(const std::string& name);
+  inline static bool save_wisdom(const std::string& name);
+  
+  
+  private:
+  
+  typedef typename fft_engine_type<eT,false>::result engine_fwd_type;
+  typedef typename fft_engine_type<eT,true >::result engine_inv_type;
+  
+  const engine_fwd_type* engine_fwd;
+  const engine_inv_type* engine_inv;
+  
+  bool owns_engine;
+  
+  inline void init();
+  inline void release();
+  };
+
+
+
+//! @}
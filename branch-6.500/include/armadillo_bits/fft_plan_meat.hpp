@@ -0,0 +1,706 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup fft_plan
+//! @{
+
+
+
+//
+// fft_engine_cache
+
+
+
+template<typename engine_type> const uword fft_engine_cache<engine_type>::max_bytes;
+template<typename engine_type> const uword fft_engine_cache<engine_type>::max_N;
+
+
+
+template<typename engine_type>
+inline
+fft_engine_cache<engine_type>::state_type::state_type()
+  : n_bytes(0)
+  , clock  (0)
+  {
+  }
+
+
+
+//! engines still in use at the end of the program are also deleted, as their users are static objects being destroyed
+template<typename engine_type>
+inline
+fft_engine_cache<engine_type>::state_type::~state_type()
+  {
+  for(uword i=0; i < entries.size(); ++i)  { delete entries[i].engine; }
+  
+  is_destroyed() = true;
+  }
+
+
+
+template<typename engine_type>
+inline
+typename fft_engine_cache<engine_type>::state_type&
+fft_engine_cache<engine_type>::get_state()
+  {
+  static state_type state;
+  
+  return state;
+  }
+
+
+
+//! static objects destroyed after the cache (eg. engines held by the cache of fft_engine_real) must not use it;
+//! the flag is trivially destructible, so it remains valid during the destruction of static objects
+template<typename engine_type>
+inline
+bool&
+fft_engine_cache<engine_type>::is_destroyed()
+  {
+  static bool flag = false;
+  
+  return flag;
+  }
+
+
+
+//! the engine of the given length is marked as used; returns NULL if it's not cached
+template<typename engine_type>
+inline
+const engine_type*
+fft_engine_cache<engine_type>::find_locked(state_type& state, const uword N)
+  {
+  arma_extra_debug_sigprint();
+  
+  for(uword i=0; i < state.entries.size(); ++i)
+    {
+    entry_type& entry = state.entries[i];
+    
+    if( (entry.N == N) && (entry.evicted == false) )
+      {
+      entry.n_users++;
+      entry.last_use = ++state.clock;
+      
+      return entry.engine;
+      }
+    }
+  
+  return NULL;
+  }
+
+
+
+//! returns the engine that ends up being used, which differs from the given engine if another thread inserted one first
+template<typename engine_type>
+inline
+const engine_type*
+fft_engine_cache<engine_type>::insert_locked(state_type& state, const uword N, const engine_type* engine)
+  {
+  arma_extra_debug_sigprint();
+  
+  const engine_type* existing = find_locked(state, N);
+  
+  if(existing != NULL)  { return existing; }
+  
+  entry_type entry;
+  
+  entry.N        = N;
+  entry.engine   = engine;
+  entry.n_bytes  = engine->n_bytes();
+  entry.n_users  = 1;
+  entry.last_use = ++state.clock;
+  entry.evicted  = false;
+  
+  state.entries.push_back(entry);
+  
+  state.n_bytes += entry.n_bytes;
+  
+  evict_locked(state);
+  
+  return engine;
+  }
+
+
+
+template<typename engine_type>
+inline
+void
+fft_engine_cache<engine_type>::release_locked(state_type& state, const engine_type* engine)
+  {
+  arma_extra_debug_sigprint();
+  
+  for(uword i=0; i < state.entries.size(); ++i)
+    {
+    entry_type& entry = state.entries[i];
+    
+    if(entry.engine != engine)  { continue; }
+    
+    if(entry.n_users > 0)  { entry.n_users--; }
+    
+    if( (entry.evicted == true) && (entry.n_users == 0) )
+      {
+      delete entry.engine;
+      
+      state.entries.erase(state.entries.begin() + i);
+      }
+    
+    return;
+    }
+  }
+
+
+
+//! evict the least recently used engines until the cache holds at most max_bytes;
+//! engines in use are deleted by release_locked() once their last user has finished with them
+template<typename engine_type>
+inline
+void
+fft_engine_cache<engine_type>::evict_locked(state_type& state)
+  {
+  arma_extra_debug_sigprint();
+  
+  while(state.n_bytes > max_bytes)
+    {
+    uword lru_index = state.entries.size();
+    
+    for(uword i=0; i < state.entries.size(); ++i)
+      {
+      const entry_type& entry = state.entries[i];
+      
+      if(entry.evicted)  { continue; }
+      
+      if( (lru_index == state.entries.size()) || (entry.last_use < state.entries[lru_index].last_use) )  { lru_index = i; }
+      }
+    
+    if(lru_index == state.entries.size())  { break; }
+    
+    entry_type& lru = state.entries[lru_index];
+    
+    state.n_bytes -= lru.n_bytes;
+    
+    if(lru.n_users == 0)
+      {
+      delete lru.engine;
+      
+      state.entries.erase(state.entries.begin() + lru_index);
+      }
+    else
+      {
+      lru.evicted = true;
+      }
+    }
+  }
+
+
+
+template<typename engine_type>
+inline
+const engine_type*
+fft_engine_cache<engine_type>::get(const uword N)
+  {
+  arma_extra_debug_sigprint();
+  
+  if( (N > max_N) || is_destroyed() )  { return NULL; }
+  
+  state_type& state = get_state();
+  
+  const engine_type* engine = NULL;
+
+  #if defined(ARMA_USE_CXX11)
+    {
+    std::lock_guard<std::mutex> lock(state.mutex_obj);
+    
+    engine = find_locked(state, N);
+    }
+  #elif defined(_OPENMP)
+    {
+    #pragma omp critical (arma_fft_engine_cache)
+      {
+      engine = find_locked(state, N);
+      }
+    }
+  #else
+    {
+    engine = find_locked(state, N);
+    }
+  #endif
+  
+  if(engine != NULL)  { return engine; }
+  
+  const engine_type* new_engine = new engine_type(N);
+
+  #if defined(ARMA_USE_CXX11)
+    {
+    std::lock_guard<std::mutex> lock(state.mutex_obj);
+    
+    engine = insert_locked(state, N, new_engine);
+    }
+  #elif defined(_OPENMP)
+    {
+    #pragma omp critical (arma_fft_engine_cache)
+      {
+      engine = insert_locked(state, N, new_engine);
+      }
+    }
+  #else
+    {
+    engine = insert_locked(state, N, new_engine);
+    }
+  #endif
+  
+  if(engine != new_engine)  { delete new_engine; }
+  
+  return engine;
+  }
+
+
+
+//! hand back an engine obtained from get()
+template<typename engine_type>
+inline
+void
+fft_engine_cache<engine_type>::release(const engine_type* engine)
+  {
+  arma_extra_debug_sigprint();
+  
+  if( (engine == NULL) || is_destroyed() )  { return; }
+  
+  state_type& state = get_state();
+
+  #if defined(ARMA_USE_CXX11)
+    {
+    std::lock_guard<std::mutex> lock(state.mutex_obj);
+    
+    release_locked(state, engine);
+    }
+  #elif defined(_OPENMP)
+    {
+    #pragma omp critical (arma_fft_engine_cache)
+      {
+      release_locked(state, engine);
+      }
+    }
+  #else
+    {
+    release_locked(state, engine);
+    }
+  #endif
+  }
+
+
+
+template<typename engine_type>
+inline
+uword
+fft_engine_cache<engine_type>::n_entries()
+  {
+  arma_extra_debug_sigprint();
+  
+  if(is_destroyed())  { return 0; }
+  
+  state_type& state = get_state();
+  
+  uword count = 0;
+
+  #if defined(ARMA_USE_CXX11)
+    {
+    std::lock_guard<std::mutex> lock(state.mutex_obj);
+    
+    for(uword i=0; i < state.entries.size(); ++i)  { if(state.entries[i].evicted == false)  { ++count; } }
+    }
+  #elif defined(_OPENMP)
+    {
+    #pragma omp critical (arma_fft_engine_cache)
+      {
+      for(uword i=0; i < state.entries.size(); ++i)  { if(state.entries[i].evicted == false)  { ++count; } }
+      }
+    }
+  #else
+    {
+    for(uword i=0; i < state.entries.size(); ++i)  { if(state.entries[i].evicted == false)  { ++count; } }
+    }
+  #endif
+  
+  return count;
+  }
+
+
+
+template<typename engine_type>
+inline
+uword
+fft_engine_cache<engine_type>::n_bytes()
+  {
+  arma_extra_debug_sigprint();
+  
+  if(is_destroyed())  { return 0; }
+  
+  state_type& state = get_state();
+  
+  uword out = 0;
+
+  #if defined(ARMA_USE_CXX11)
+    {
+    std::lock_guard<std::mutex> lock(state.mutex_obj);
+    
+    out = state.n_bytes;
+    }
+  #elif defined(_OPENMP)
+    {
+    #pragma omp critical (arma_fft_engine_cache)
+      {
+      out = state.n_bytes;
+      }
+    }
+  #else
+    {
+    out = state.n_bytes;
+    }
+  #endif
+  
+  return out;
+  }
+
+
+
+//
+// fft_engine_ref
+
+
+
+template<typename engine_type>
+inline
+fft_engine_ref<engine_type>::~fft_engine_ref()
+  {
+  arma_extra_debug_sigprint_this(this);
+  
+  if(owns_engine)
+    {
+    delete engine;
+    }
+  else
+    {
+    fft_engine_cache<engine_type>::release(engine);
+    }
+  }
+
+
+
+template<typename engine_type>
+inline
+fft_engine_ref<engine_type>::fft_engine_ref(const uword N)
+  : engine     (fft_engine_cache<engine_type>::get(N))
+  , owns_engine(false                                )
+  {
+  arma_extra_debug_sigprint_this(this);
+  
+  if(engine == NULL)  { engine = new engine_type(N); owns_engine = true; }
+  }
+
+
+
+//
+// fft_plan
+
+
+
+template<typename eT>
+inline
+fft_plan<eT>::~fft_plan()
+  {
+  arma_extra_debug_sigprint_this(this);
+  
+  release();
+  }
+
+
+
+template<typename eT>
+inline
+fft_plan<eT>::fft_plan(const uword in_N, const bool in_inverse)
+  : N      (in_N      )
+  , inverse(in_inverse)
+  {
+  arma_extra_debug_sigprint_this(this);
+  
+  arma_type_check(( is_complex<eT>::value == false ));
+  
+  init();
+  }
+
+
+
+template<typename eT>
+inline
+fft_plan<eT>::fft_plan(const fft_plan<eT>& x)
+  : N      (x.N      )
+  , inverse(x.inverse)
+  {
+  arma_extra_debug_sigprint_this(this);
+  
+  init();
+  }
+
+
+
+template<typename eT>
+inline
+const fft_plan<eT>&
+fft_plan<eT>::operator=(const fft_plan<eT>& x)
+  {
+  arma_extra_debug_sigprint();
+  
+  if(this != &x)
+    {
+    release();
+    
+    access::rw(N)       = x.N;
+    access::rw(inverse) = x.inverse;
+    
+    init();
+    }
+  
+  return *this;
+  }
+
+
+
+//! engines are taken from the cache when possible; otherwise the plan has its own engine
+template<typename eT>
+inline
+void
+fft_plan<eT>::init()
+  {
+  arma_extra_debug_sigprint();
+  
+  engine_fwd  = NULL;
+  engine_inv  = NULL;
+  owns_engine = false;
+  
+  if(N == 0)  { return; }
+  
+  if(inverse)
+    {
+    engine_inv = fft_engine_cache<engine_inv_type>::get(N);
+    
+    if(engine_inv == NULL)  { engine_inv = new engine_inv_type(N); owns_engine = true; }
+    }
+  else
+    {
+    engine_fwd = fft_engine_cache<engine_fwd_type>::get(N);
+    
+    if(engine_fwd == NULL)  { engine_fwd = new engine_fwd_type(N); owns_engine = true; }
+    }
+  }
+
+
+
+template<typename eT>
+inline
+void
+fft_plan<eT>::release()
+  {
+  arma_extra_debug_sigprint();
+  
+  if(owns_engine)
+    {
+    if(engine_fwd != NULL)  { delete engine_fwd; }
+    if(engine_inv != NULL)  { delete engine_inv; }
+    }
+  else
+    {
+    fft_engine_cache<engine_fwd_type>::release(engine_fwd);
+    fft_engine_cache<engine_inv_type>::release(engine_inv);
+    }
+  
+  engine_fwd  = NULL;
+  engine_inv  = NULL;
+  owns_engine = false;
+  }
+
+
+
+template<typename eT>
+inline
+void
+fft_plan<eT>::run(eT* out, const eT* in) const
+  {
+  arma_extra_debug_sigprint();
+  
+  if(N == 0)  { return; }
+  
+  if(inverse)
+    {
+    engine_inv->run(out, in);
+    }
+  else
+    {
+    engine_fwd->run(out, in);
+    }
+  }
+
+
+
+template<typename eT>
+inline
+void
+fft_plan<eT>::run(eT* out, const eT* in, pod_type* work) const
+  {
+  arma_extra_debug_sigprint();
+  
+  if(N == 0)  { return; }
+  
+  if(inverse)
+    {
+    engine_inv->run(out, in, work);
+    }
+  else
+    {
+    engine_fwd->run(out, in, work);
+    }
+  }
+
+
+
+template<typename eT>
+inline
+uword
+fft_plan<eT>::n_work() const
+  {
+  if(N == 0)  { return 0; }
+  
+  return (inverse) ? engine_inv->n_work() : engine_fwd->n_work();
+  }
+
+
+
+template<typename eT>
+inline
+bool
+fft_plan<eT>::load_wisdom(const std::string& name)
+  {
+  arma_extra_debug_sigprint();
+
+  #if defined(ARMA_USE_FFTW3)
+    {
+    return fftw3::wisdom<eT>(name.c_str(), false);
+    }
+  #else
+    {
+    arma_ignore(name);
+    
+    return false;
+    }
+  #endif
+  }
+
+
+
+template<typename eT>
+inline
+bool
+fft_plan<eT>::save_wisdom(const std::string& name)
+  {
+  arma_extra_debug_sigprint();
+
+  #if defined(ARMA_USE_FFTW3)
+    {
+    return fftw3::wisdom<eT>(name.c_str(), true);
+    }
+  #else
+    {
+    arma_ignore(name);
+    
+    return false;
+    }
+  #endif
+  }
+
+
+
+//! transform a vector, or each column of a matrix; the input is zero padded or truncated to length N.
+//! the inverse transform is scaled by 1/N, as per ifft()
+template<typename eT>
+template<typename T1>
+inline
+void
+fft_plan<eT>::apply(Mat<eT>& out, const Base<eT,T1>& X) const
+  {
+  arma_extra_debug_sigprint();
+  
+  const Proxy<T1> P(X.get_ref());
+  
+  if(P.is_alias(out) == false)
+    {
+    op_fft_cx::apply_plan(out, P, *this);
+    }
+  else
+    {
+    Mat<eT> tmp;
+    
+    op_fft_cx::apply_plan(tmp, P, *this);
+    
+    out.steal_mem(tmp);
+    }
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+void
+fft_plan<eT>::apply(Mat<eT>& out, const Base<pod_type,T1>& X) const
+  {
+  arma_extra_debug_sigprint();
+  
+  // no need to worry about aliasing, as we're going from a real object to a complex object
+  const Proxy<T1> P(X.get_ref());
+  
+  op_fft_real::apply_plan(out, P, *this);
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+Mat<eT>
+fft_plan<eT>::operator()(const Base<eT,T1>& X) const
+  {
+  arma_extra_debug_sigprint();
+  
+  Mat<eT> out;
+  
+  (*this).apply(out, X);
+  
+  return out;
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+Mat<eT>
+fft_plan<eT>::operator()(const Base<pod_type,T1>& X) const
+  {
+  arma_extra_debug_sigprint();
+  
+  Mat<eT> out;
+  
+  (*this).apply(out, X);
+  
+  return out;
+  }
+
+
+
+//! @}
@@ -202,6 +202,11 @@ class field
   inline bool quiet_load(const std::string   name, const file_type type = auto_detect);
   inline bool quiet_load(      std::istream& is,   const file_type type = auto_detect);
   
+  #if defined(ARMA_USE_CXX11)
+  inline arma_warn_unused io_future save_async(const std::string name, const file_type type = arma_binary, const bool print_status = true) const;
+  inline arma_warn_unused io_future load_async(const std::string name, const file_type type = auto_detect, const bool print_status = true);
+  #endif
+  
   
   // for container-like functionality
   
@@ -325,6 +330,11 @@ class field_aux
   template<typename eT> inline static bool load(      field< Cube<eT> >& x, const std::string&  name, const file_type type, std::string& err_msg);
   template<typename eT> inline static bool load(      field< Cube<eT> >& x,       std::istream& is,   const file_type type, std::string& err_msg);
   
+  template<typename eT> inline static bool save(const field< SpMat<eT> >& x, const std::string&  name, const file_type type, std::string& err_msg);
+  template<typename eT> inline static bool save(const field< SpMat<eT> >& x,       std::ostream& os,   const file_type type, std::string& err_msg);
+  template<typename eT> inline static bool load(      field< SpMat<eT> >& x, const std::string&  name, const file_type type, std::string& err_msg);
+  template<typename eT> inline static bool load(      field< SpMat<eT> >& x,       std::istream& is,   const file_type type, std::string& err_msg);
+  
   inline static bool save(const field< std::string >& x, const std::string&  name, const file_type type, std::string& err_msg);
   inline static bool save(const field< std::string >& x,       std::ostream& os,   const file_type type, std::string& err_msg);
   inline static bool load(      field< std::string >& x, const std::string&  name, const file_type type, std::string& err_msg);
@@ -1875,6 +1875,36 @@ field<oT>::quiet_load(std::istream& is, const file_type type)
 
 
 
+#if defined(ARMA_USE_CXX11)
+
+//! save the field to a file on a background thread; a snapshot of the field is taken before returning
+template<typename oT>
+inline
+io_future
+field<oT>::save_async(const std::string name, const file_type type, const bool print_status) const
+  {
+  arma_extra_debug_sigprint();
+  
+  return io_async::submit_save(*this, name, type, print_status, "field::save_async()");
+  }
+
+
+
+//! load the field from a file on a background thread; the field must not be accessed until the load has completed
+template<typename oT>
+inline
+io_future
+field<oT>::load_async(const std::string name, const file_type type, const bool print_status)
+  {
+  arma_extra_debug_sigprint();
+  
+  return io_async::submit_load(*this, name, type, print_status, "field::load_async()");
+  }
+
+#endif
+
+
+
 //! construct a field from a given field
 template<typename oT>
 inline
@@ -2489,6 +2519,10 @@ field_aux::save(const field< Mat<eT> >& x, const std::string& name, const file_t
       return diskio::save_arma_binary(x, name);
       break;
       
+    case arma_binary_indexed:
+      return diskio::save_arma_binary_indexed(x, name);
+      break;
+    
     case ppm_binary:
       return diskio::save_ppm_binary(x, name);
       break;
@@ -2514,6 +2548,10 @@ field_aux::save(const field< Mat<eT> >& x, std::ostream& os, const file_type typ
       return diskio::save_arma_binary(x, os);
       break;
       
+    case arma_binary_indexed:
+      return diskio::save_arma_binary_indexed(x, os);
+      break;
+    
     case ppm_binary:
       return diskio::save_ppm_binary(x, os);
       break;
@@ -2543,6 +2581,10 @@ field_aux::load(field< Mat<eT> >& x, const std::string& name, const file_type ty
       return diskio::load_arma_binary(x, name, err_msg);
       break;
       
+    case arma_binary_indexed:
+      return diskio::load_arma_binary_indexed(x, name, err_msg);
+      break;
+    
     case ppm_binary:
       return diskio::load_ppm_binary(x, name, err_msg);
       break;
@@ -2572,6 +2614,10 @@ field_aux::load(field< Mat<eT> >& x, std::istream& is, const file_type type, std
       return diskio::load_arma_binary(x, is, err_msg);
       break;
       
+    case arma_binary_indexed:
+      return diskio::load_arma_binary_indexed(x, is, err_msg);
+      break;
+    
     case ppm_binary:
       return diskio::load_ppm_binary(x, is, err_msg);
       break;
@@ -2597,6 +2643,10 @@ field_aux::save(const field< Col<eT> >& x, const std::string& name, const file_t
       return diskio::save_arma_binary(x, name);
       break;
       
+    case arma_binary_indexed:
+      return diskio::save_arma_binary_indexed(x, name);
+      break;
+    
     case ppm_binary:
       return diskio::save_ppm_binary(x, name);
       break;
@@ -2622,6 +2672,10 @@ field_aux::save(const field< Col<eT> >& x, std::ostream& os, const file_type typ
       return diskio::save_arma_binary(x, os);
       break;
       
+    case arma_binary_indexed:
+      return diskio::save_arma_binary_indexed(x, os);
+      break;
+    
     case ppm_binary:
       return diskio::save_ppm_binary(x, os);
       break;
@@ -2651,6 +2705,10 @@ field_aux::load(field< Col<eT> >& x, const std::string& name, const file_type ty
       return diskio::load_arma_binary(x, name, err_msg);
       break;
       
+    case arma_binary_indexed:
+      return diskio::load_arma_binary_indexed(x, name, err_msg);
+      break;
+    
     case ppm_binary:
       return diskio::load_ppm_binary(x, name, err_msg);
       break;
@@ -2680,6 +2738,10 @@ field_aux::load(field< Col<eT> >& x, std::istream& is, const file_type type, std
       return diskio::load_arma_binary(x, is, err_msg);
       break;
       
+    case arma_binary_indexed:
+      return diskio::load_arma_binary_indexed(x, is, err_msg);
+      break;
+    
     case ppm_binary:
       return diskio::load_ppm_binary(x, is, err_msg);
       break;
@@ -2705,6 +2767,10 @@ field_aux::save(const field< Row<eT> >& x, const std::string& name, const file_t
       return diskio::save_arma_binary(x, name);
       break;
       
+    case arma_binary_indexed:
+      return diskio::save_arma_binary_indexed(x, name);
+      break;
+    
     case ppm_binary:
       return diskio::save_ppm_binary(x, name);
       break;
@@ -2730,6 +2796,10 @@ field_aux::save(const field< Row<eT> >& x, std::ostream& os, const file_type typ
       return diskio::save_arma_binary(x, os);
       break;
       
+    case arma_binary_indexed:
+      return diskio::save_arma_binary_indexed(x, os);
+      break;
+    
     case ppm_binary:
       return diskio::save_ppm_binary(x, os);
       break;
@@ -2759,6 +2829,10 @@ field_aux::load(field< Row<eT> >& x, const std::string& name, const file_type ty
       return diskio::load_arma_binary(x, name, err_msg);
       break;
       
+    case arma_binary_indexed:
+      return diskio::load_arma_binary_indexed(x, name, err_msg);
+      break;
+    
     case ppm_binary:
       return diskio::load_ppm_binary(x, name, err_msg);
       break;
@@ -2788,6 +2862,10 @@ field_aux::load(field< Row<eT> >& x, std::istream& is, const file_type type, std
       return diskio::load_arma_binary(x, is, err_msg);
       break;
       
+    case arma_binary_indexed:
+      return diskio::load_arma_binary_indexed(x, is, err_msg);
+      break;
+    
     case ppm_binary:
       return diskio::load_ppm_binary(x, is, err_msg);
       break;
@@ -2813,6 +2891,10 @@ field_aux::save(const field< Cube<eT> >& x, const std::string& name, const file_
       return diskio::save_arma_binary(x, name);
       break;
     
+    case arma_binary_indexed:
+      return diskio::save_arma_binary_indexed(x, name);
+      break;
+    
     default:
       err_msg = " [unsupported type] filename = ";
       return false;
@@ -2834,6 +2916,10 @@ field_aux::save(const field< Cube<eT> >& x, std::ostream& os, const file_type ty
       return diskio::save_arma_binary(x, os);
       break;
     
+    case arma_binary_indexed:
+      return diskio::save_arma_binary_indexed(x, os);
+      break;
+    
     default:
       err_msg = " [unsupported type] filename = ";
       return false;
@@ -2856,6 +2942,10 @@ field_aux::load(field< Cube<eT> >& x, const std::string& name, const file_type t
       return diskio::load_arma_binary(x, name, err_msg);
       break;
     
+    case arma_binary_indexed:
+      return diskio::load_arma_binary_indexed(x, name, err_msg);
+      break;
+    
     default:
       err_msg = " [unsupported type] filename = ";
       return false;
@@ -2878,6 +2968,96 @@ field_aux::load(field< Cube<eT> >& x, std::istream& is, const file_type type, st
       return diskio::load_arma_binary(x, is, err_msg);
       break;
       
+    case arma_binary_indexed:
+      return diskio::load_arma_binary_indexed(x, is, err_msg);
+      break;
+    
+    default:
+      err_msg = " [unsupported type] filename = ";
+      return false;
+    }
+  }
+
+
+
+template<typename eT>
+inline
+bool
+field_aux::save(const field< SpMat<eT> >& x, const std::string& name, const file_type type, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  switch(type)
+    {
+    case arma_binary_indexed:
+      return diskio::save_arma_binary_indexed(x, name);
+      break;
+    
+    default:
+      err_msg = " [unsupported type] filename = ";
+      return false;
+    }
+  }
+
+
+
+template<typename eT>
+inline
+bool
+field_aux::save(const field< SpMat<eT> >& x, std::ostream& os, const file_type type, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  switch(type)
+    {
+    case arma_binary_indexed:
+      return diskio::save_arma_binary_indexed(x, os);
+      break;
+    
+    default:
+      err_msg = " [unsupported type] filename = ";
+      return false;
+    }
+  }
+
+
+
+template<typename eT>
+inline
+bool
+field_aux::load(field< SpMat<eT> >& x, const std::string& name, const file_type type, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  switch(type)
+    {
+    case auto_detect:
+    case arma_binary_indexed:
+      return diskio::load_arma_binary_indexed(x, name, err_msg);
+      break;
+    
+    default:
+      err_msg = " [unsupported type] filename = ";
+      return false;
+    }
+  }
+
+
+
+template<typename eT>
+inline
+bool
+field_aux::load(field< SpMat<eT> >& x, std::istream& is, const file_type type, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  switch(type)
+    {
+    case auto_detect:
+    case arma_binary_indexed:
+      return diskio::load_arma_binary_indexed(x, is, err_msg);
+      break;
+    
     default:
       err_msg = " [unsupported type] filename = ";
       return false;
@@ -0,0 +1,59 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup field_reader
+//! @{
+
+
+//! random access to the objects of a field saved in arma_binary_indexed format;
+//! only the index is read when the file is opened, and objects are loaded on demand
+template<typename oT>
+class field_reader
+  {
+  public:
+  
+  typedef oT object_type;
+  
+  const uword n_rows;    //!< number of rows of the stored field
+  const uword n_cols;    //!< number of columns of the stored field
+  const uword n_slices;  //!< number of slices of the stored field
+  const uword n_elem;    //!< number of objects in the stored field
+  
+  
+  inline ~field_reader();
+  inline  field_reader();
+  
+  inline explicit field_reader(const std::string& name, const bool print_status = true);
+  
+  inline bool open(const std::string& name, const bool print_status = true);
+  inline void close();
+  
+  inline bool is_open() const;
+  
+  inline bool load(oT& x, const uword i) const;
+  inline bool load(oT& x, const uword in_row, const uword in_col) const;
+  inline bool load(oT& x, const uword in_row, const uword in_col, const uword in_slice) const;
+  
+  inline bool load(field<oT>& x) const;
+  inline bool load(field<oT>& x, const Col<uword>& indices) const;
+  
+  
+  private:
+  
+  std::string                 name;
+  std::vector<std::streamoff> offsets;
+  bool                        opened;
+  bool                        print_status;
+  
+  inline void report(const char* sig, const std::string& err_msg) const;
+  };
+
+
+//! @}
@@ -0,0 +1,292 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup field_reader
+//! @{
+
+
+template<typename oT>
+inline
+field_reader<oT>::~field_reader()
+  {
+  arma_extra_debug_sigprint_this(this);
+  }
+
+
+
+template<typename oT>
+inline
+field_reader<oT>::field_reader()
+  : n_rows(0)
+  , n_cols(0)
+  , n_slices(0)
+  , n_elem(0)
+  , opened(false)
+  , print_status(true)
+  {
+  arma_extra_debug_sigprint_this(this);
+  
+  arma_type_check(( (is_Mat<oT>::value == false) && (is_Cube<oT>::value == false) && (is_SpMat<oT>::value == false) ));
+  }
+
+
+
+template<typename oT>
+inline
+field_reader<oT>::field_reader(const std::string& in_name, const bool in_print_status)
+  : n_rows(0)
+  , n_cols(0)
+  , n_slices(0)
+  , n_elem(0)
+  , opened(false)
+  , print_status(in_print_status)
+  {
+  arma_extra_debug_sigprint_this(this);
+  
+  arma_type_check(( (is_Mat<oT>::value == false) && (is_Cube<oT>::value == false) && (is_SpMat<oT>::value == false) ));
+  
+  (*this).open(in_name, in_print_status);
+  }
+
+
+
+//! read the index of the given file;
+//! print_status also applies to subsequent calls to load()
+template<typename oT>
+inline
+bool
+field_reader<oT>::open(const std::string& in_name, const bool in_print_status)
+  {
+  arma_extra_debug_sigprint();
+  
+  (*this).close();
+  
+  print_status = in_print_status;
+  
+  uword f_n_rows   = 0;
+  uword f_n_cols   = 0;
+  uword f_n_slices = 0;
+  
+  std::string err_msg;
+  
+  const bool open_okay = diskio::load_field_index(in_name, f_n_rows, f_n_cols, f_n_slices, offsets, err_msg);
+  
+  if(open_okay == false)
+    {
+    offsets.clear();
+    
+    if(print_status == true)
+      {
+      if(err_msg.length() > 0)
+        {
+        arma_debug_warn("field_reader::open(): ", err_msg, in_name);
+        }
+      else
+        {
+        arma_debug_warn("field_reader::open(): couldn't read from ", in_name);
+        }
+      }
+    
+    return false;
+    }
+  
+  name   = in_name;
+  opened = true;
+  
+  access::rw(n_rows)   = f_n_rows;
+  access::rw(n_cols)   = f_n_cols;
+  access::rw(n_slices) = f_n_slices;
+  access::rw(n_elem)   = f_n_rows * f_n_cols * f_n_slices;
+  
+  return true;
+  }
+
+
+
+template<typename oT>
+inline
+void
+field_reader<oT>::close()
+  {
+  arma_extra_debug_sigprint();
+  
+  name.clear();
+  offsets.clear();
+  
+  opened = false;
+  
+  access::rw(n_rows)   = 0;
+  access::rw(n_cols)   = 0;
+  access::rw(n_slices) = 0;
+  access::rw(n_elem)   = 0;
+  }
+
+
+
+template<typename oT>
+inline
+bool
+field_reader<oT>::is_open() const
+  {
+  return opened;
+  }
+
+
+
+//! load the object with linear index i
+template<typename oT>
+inline
+bool
+field_reader<oT>::load(oT& x, const uword i) const
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_debug_check( (opened == false), "field_reader::load(): no file is open"    );
+  arma_debug_check( (i >= n_elem),     "field_reader::load(): index out of bounds" );
+  
+  std::ifstream f( name.c_str(), std::fstream::binary );
+  
+  std::string err_msg;
+  
+  bool load_okay = f.is_open();
+  
+  if(load_okay == true)
+    {
+    f.seekg(offsets[i], std::ios::beg);
+    
+    load_okay = f.good() && diskio::load_arma_binary(x, f, err_msg);
+    }
+  
+  if(load_okay == false)
+    {
+    report("field_reader::load(): ", err_msg);
+    
+    x.reset();
+    }
+  
+  return load_okay;
+  }
+
+
+
+template<typename oT>
+inline
+bool
+field_reader<oT>::load(oT& x, const uword in_row, const uword in_col) const
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_debug_check( ((in_row >= n_rows) || (in_col >= n_cols) || (n_slices > 1)), "field_reader::load(): index out of bounds" );
+  
+  return (*this).load(x, in_row + in_col*n_rows);
+  }
+
+
+
+template<typename oT>
+inline
+bool
+field_reader<oT>::load(oT& x, const uword in_row, const uword in_col, const uword in_slice) const
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_debug_check( ((in_row >= n_rows) || (in_col >= n_cols) || (in_slice >= n_slices)), "field_reader::load(): index out of bounds" );
+  
+  return (*this).load(x, in_row + in_col*n_rows + in_slice*(n_rows*n_cols));
+  }
+
+
+
+//! load all objects, in parallel when OpenMP is enabled
+template<typename oT>
+inline
+bool
+field_reader<oT>::load(field<oT>& x) const
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_debug_check( (opened == false), "field_reader::load(): no file is open" );
+  
+  x.set_size(n_rows, n_cols, n_slices);
+  
+  std::string err_msg;
+  
+  const bool load_okay = diskio::load_field_objects(x, name, offsets, NULL, err_msg);
+  
+  if(load_okay == false)
+    {
+    report("field_reader::load(): ", err_msg);
+    
+    x.reset();
+    }
+  
+  return load_okay;
+  }
+
+
+
+//! load the objects with the given linear indices into a field with one column,
+//! in parallel when OpenMP is enabled
+template<typename oT>
+inline
+bool
+field_reader<oT>::load(field<oT>& x, const Col<uword>& indices) const
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_debug_check( (opened == false), "field_reader::load(): no file is open" );
+  
+  const uword* indices_mem = indices.memptr();
+  const uword  N           = indices.n_elem;
+  
+  for(uword i=0; i < N; ++i)
+    {
+    arma_debug_check( (indices_mem[i] >= n_elem), "field_reader::load(): index out of bounds" );
+    }
+  
+  x.set_size(N);
+  
+  std::string err_msg;
+  
+  const bool load_okay = diskio::load_field_objects(x, name, offsets, indices_mem, err_msg);
+  
+  if(load_okay == false)
+    {
+    report("field_reader::load(): ", err_msg);
+    
+    x.reset();
+    }
+  
+  return load_okay;
+  }
+
+
+
+template<typename oT>
+inline
+void
+field_reader<oT>::report(const char* sig, const std::string& err_msg) const
+  {
+  if(print_status == true)
+    {
+    if(err_msg.length() > 0)
+      {
+      arma_debug_warn(sig, err_msg, name);
+      }
+    else
+      {
+      arma_debug_warn(sig, "couldn't read from ", name);
+      }
+    }
+  }
+
+
+
+//! @}
@@ -0,0 +1,75 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup fir_filter
+//! @{
+
+
+
+//! causal FIR filter for signals that arrive in successive blocks:
+//! out[i] = sum_k taps[k] * x[i-k], where x includes the samples of the preceding blocks (initially zero).
+//! each block is filtered either directly or via overlap-save with FFTs of a fixed length,
+//! whichever is estimated to be faster for the block length.
+//! all buffers are kept between calls, so that apply() does not allocate memory once the block length stops growing.
+//! as the filter has state, an object must not be used by several threads at once.
+template<typename eT>
+class fir_filter
+  {
+  public:
+  
+  typedef eT                                elem_type;
+  typedef typename get_pod_type<eT>::result pod_type;
+  typedef std::complex<pod_type>            cx_type;
+  
+  const uword n_taps;
+  const uword method;   //!< one of glue_conv_mode::method_auto, method_direct or method_fft
+  const uword L;        //!< length of the transforms; zero if the FFT based method is not used
+  
+  inline ~fir_filter();
+  
+  template<typename T1> inline explicit fir_filter(const Base<eT,T1>& in_taps, const char* in_method = "auto");
+  
+  inline const Col<eT>& taps() const;
+  
+  inline void reset();
+  
+  template<typename T1> inline void    apply(Col<eT>& out, const Base<eT,T1>& X);
+  template<typename T1> inline Col<eT> operator()(const Base<eT,T1>& X);
+  
+  inline static uword fft_length(const uword n_taps);
+  
+  
+  private:
+  
+  Col<eT>            h;
+  podarray<eT>       hh;     //!< flipped version of h
+  podarray<eT>       buf;    //!< the last n_taps-1 samples of the preceding blocks, followed by the current block
+  podarray<cx_type>  H;      //!< spectrum of h, including the scaling of the inverse transform
+  podarray<eT>       seg;
+  podarray<eT>       y;
+  podarray<cx_type>  Z;
+  podarray<pod_type> work;
+  
+  const fft_engine_pair<eT>* engine;
+  
+  inline static uword method_from_name(const char* name);
+  
+  inline bool use_fft(const uword n) const;
+  
+  inline void apply_direct(eT* out_mem, const uword n) const;
+  inline void apply_fft   (eT* out_mem, const uword n);
+  
+  fir_filter(const fir_filter&);              //!< not implemented
+  fir_filter& operator=(const fir_filter&);   //!< not implemented
+  };
+
+
+
+//! @}
@@ -0,0 +1,298 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup fir_filter
+//! @{
+
+
+
+template<typename eT>
+inline
+fir_filter<eT>::~fir_filter()
+  {
+  arma_extra_debug_sigprint_this(this);
+  
+  if(engine != NULL)  { delete engine; }
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+fir_filter<eT>::fir_filter(const Base<eT,T1>& in_taps, const char* in_method)
+  : n_taps(0                                            )
+  , method(fir_filter<eT>::method_from_name(in_method))
+  , L     (0                                            )
+  , engine(NULL                                         )
+  {
+  arma_extra_debug_sigprint_this(this);
+  
+  arma_type_check(( is_supported_blas_type<eT>::value == false ));
+  
+  const quasi_unwrap<T1> U(in_taps.get_ref());
+  
+  arma_debug_check( ((U.M.is_vec() == false) && (U.M.is_empty() == false)), "fir_filter(): given taps must be a vector" );
+  
+  const uword M = U.M.n_elem;
+  
+  access::rw(n_taps) = M;
+  
+  h.set_size(M);
+  hh.set_size(M);
+  
+  arrayops::copy( h.memptr(), U.M.memptr(), M );
+  
+  const eT* h_mem =  h.memptr();
+        eT* hh_mem = hh.memptr();
+  
+  for(uword i=0; i < M; ++i)  { hh_mem[M-1-i] = h_mem[i]; }
+  
+  buf.set_size( (M > 0) ? (M-1) : uword(0) );
+  
+  (*this).reset();
+  
+  // the transforms are only prepared if they can be used;
+  // as with conv(), short filters are always applied directly
+  
+  const bool fft_allowed = (method == glue_conv_mode::method_fft) || ( (method == glue_conv_mode::method_auto) && (M >= 64) );
+  
+  if( (M == 0) || (fft_allowed == false) )  { return; }
+  
+  access::rw(L) = fir_filter<eT>::fft_length(M);
+  
+  engine = new fft_engine_pair<eT>(L);
+  
+  H.set_size(engine->n_spec);
+  seg.set_size(L);
+  y.set_size(L);
+  Z.set_size(engine->n_spec);
+  work.set_size(engine->n_work());
+  
+  arrayops::copy( seg.memptr(), h_mem, M );
+  arrayops::fill_zeros( seg.memptr() + M, L - M );
+  
+  engine->forward( H.memptr(), seg.memptr(), work.memptr() );
+  
+  arrayops::inplace_mul( H.memptr(), cx_type( pod_type(1) / pod_type(L) ), engine->n_spec );
+  }
+
+
+
+template<typename eT>
+inline
+uword
+fir_filter<eT>::method_from_name(const char* name)
+  {
+  const char sig = (name != NULL) ? name[0] : char(0);
+  
+  arma_debug_check( ((sig != 'a') && (sig != 'd') && (sig != 'f')), "fir_filter(): unsupported value of 'method' parameter" );
+  
+  return (sig == 'd') ? glue_conv_mode::method_direct : ( (sig == 'f') ? glue_conv_mode::method_fft : glue_conv_mode::method_auto );
+  }
+
+
+
+//! the power of 2 (at least 2*n_taps) with the lowest estimated cost per output of an overlap-save block;
+//! as the block lengths are not known in advance, the length is chosen for long signals
+template<typename eT>
+inline
+uword
+fir_filter<eT>::fft_length(const uword n_taps)
+  {
+  uword L = 2;
+  
+  while(L < 2*n_taps)  { L *= 2; }
+  
+  uword  best_L    = L;
+  double best_cost = glue_conv::fft_cost(L, 1.0) / double(L - n_taps + 1);
+  
+  for(L *= 2; L <= 64*n_taps; L *= 2)
+    {
+    const double cost = glue_conv::fft_cost(L, 1.0) / double(L - n_taps + 1);
+    
+    if(cost < best_cost)  { best_L = L; best_cost = cost; }
+    }
+  
+  return best_L;
+  }
+
+
+
+template<typename eT>
+inline
+const Col<eT>&
+fir_filter<eT>::taps() const
+  {
+  return h;
+  }
+
+
+
+//! forget the preceding blocks, ie. the filter starts again from zero samples
+template<typename eT>
+inline
+void
+fir_filter<eT>::reset()
+  {
+  arma_extra_debug_sigprint();
+  
+  if(n_taps > 1)  { arrayops::fill_zeros( buf.memptr(), n_taps - 1 ); }
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+void
+fir_filter<eT>::apply(Col<eT>& out, const Base<eT,T1>& X)
+  {
+  arma_extra_debug_sigprint();
+  
+  const quasi_unwrap<T1> U(X.get_ref());
+  
+  const Mat<eT>& x = U.M;
+  
+  arma_debug_check( ((x.is_vec() == false) && (x.is_empty() == false)), "fir_filter::apply(): given object must be a vector" );
+  
+  const uword n   = x.n_elem;
+  const uword n_h = (n_taps > 0) ? (n_taps - 1) : uword(0);   // number of samples kept from the preceding blocks
+  
+  if(buf.n_elem < n_h + n)
+    {
+    // only happens while the block length grows
+    podarray<eT> history(n_h);
+    
+    arrayops::copy( history.memptr(), buf.memptr(), n_h );
+    
+    buf.set_size(n_h + n);
+    
+    arrayops::copy( buf.memptr(), history.memptr(), n_h );
+    }
+  
+  eT* buf_mem = buf.memptr();
+  
+  // the block is copied before out is resized, as out may be an alias of X
+  arrayops::copy( &(buf_mem[n_h]), x.memptr(), n );
+  
+  out.set_size(n);
+  
+  if(n == 0)  { return; }
+  
+  if(n_taps == 0)  { out.zeros(); return; }
+  
+  if(use_fft(n))
+    {
+    apply_fft(out.memptr(), n);
+    }
+  else
+    {
+    apply_direct(out.memptr(), n);
+    }
+  
+  // keep the last n_taps-1 samples for the next block; the ranges may overlap, but the source is ahead of the destination
+  for(uword i=0; i < n_h; ++i)  { buf_mem[i] = buf_mem[n + i]; }
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+Col<eT>
+fir_filter<eT>::operator()(const Base<eT,T1>& X)
+  {
+  arma_extra_debug_sigprint();
+  
+  Col<eT> out;
+  
+  (*this).apply(out, X);
+  
+  return out;
+  }
+
+
+
+template<typename eT>
+inline
+bool
+fir_filter<eT>::use_fft(const uword n) const
+  {
+  if(engine == NULL)  { return false; }
+  
+  if(method == glue_conv_mode::method_fft)  { return true; }
+  
+  const uword S = L - n_taps + 1;
+  
+  const double n_blocks = std::ceil( double(n) / double(S) );
+  
+  return ( glue_conv::fft_cost(L, n_blocks) < double(n_taps) * double(n) );
+  }
+
+
+
+template<typename eT>
+inline
+void
+fir_filter<eT>::apply_direct(eT* out_mem, const uword n) const
+  {
+  arma_extra_debug_sigprint();
+  
+  const eT* hh_mem  = hh.memptr();
+  const eT* buf_mem = buf.memptr();
+  
+  for(uword i=0; i < n; ++i)
+    {
+    out_mem[i] = op_dot::direct_dot( n_taps, hh_mem, &(buf_mem[i]) );
+    }
+  }
+
+
+
+//! overlap-save: each chunk of up to L - n_taps + 1 outputs is obtained from the product of the spectra of h
+//! and of a segment of buf that starts n_taps - 1 samples before the chunk
+template<typename eT>
+inline
+void
+fir_filter<eT>::apply_fft(eT* out_mem, const uword n)
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword n_h    = n_taps - 1;
+  const uword S      = L - n_h;
+  const uword n_spec = engine->n_spec;
+  
+  const eT*      buf_mem = buf.memptr();
+        eT*      seg_mem = seg.memptr();
+        cx_type*   Z_mem =   Z.memptr();
+  const cx_type*   H_mem =   H.memptr();
+  
+  for(uword c=0; c < n; c += S)
+    {
+    const uword len = (std::min)(S, n - c);
+    
+    arrayops::copy( seg_mem, &(buf_mem[c]), n_h + len );
+    arrayops::fill_zeros( &(seg_mem[n_h + len]), S - len );
+    
+    engine->forward(Z_mem, seg_mem, work.memptr());
+    
+    for(uword k=0; k < n_spec; ++k)  { Z_mem[k] *= H_mem[k]; }
+    
+    engine->inverse(y.memptr(), Z_mem, work.memptr());
+    
+    // the first n_taps - 1 values are corrupted by circular wrap-around
+    arrayops::copy( &(out_mem[c]), &(y.memptr()[n_h]), len );
+    }
+  }
+
+
+
+//! @}
@@ -14,6 +14,8 @@
 
 
 //! Convolution, which is also equivalent to polynomial multiplication and FIR digital filtering.
+//! shape is "full", "same" or "valid"; method is "auto", "direct" or "fft".
+//! with "auto", the FFT based method is used when it is estimated to be faster, ie. for long filters.
 
 template<typename T1, typename T2>
 inline
@@ -23,17 +25,20 @@ enable_if2
   (is_arma_type<T1>::value && is_arma_type<T2>::value && is_same_type<typename T1::elem_type, typename T2::elem_type>::value),
   const Glue<T1, T2, glue_conv>
   >::result
-conv(const T1& A, const T2& B, const char* shape = "full")
+conv(const T1& A, const T2& B, const char* shape = "full", const char* method = "auto")
   {
   arma_extra_debug_sigprint();
   
-  const char sig = (shape != NULL) ? shape[0] : char(0);
+  const char sig = (shape  != NULL) ? shape[0]  : char(0);
+  const char met = (method != NULL) ? method[0] : char(0);
   
-  arma_debug_check( ((sig != 'f') && (sig != 's')), "conv(): unsupported value of 'shape' parameter" );
+  arma_debug_check( ((sig != 'f') && (sig != 's') && (sig != 'v')), "conv(): unsupported value of 'shape' parameter"  );
+  arma_debug_check( ((met != 'a') && (met != 'd') && (met != 'f')), "conv(): unsupported value of 'method' parameter" );
   
-  const uword mode = (sig == 's') ? uword(1) : uword(0);
+  const uword shape_id  = (sig == 's') ? glue_conv_mode::same : ( (sig == 'v') ? glue_conv_mode::valid : glue_conv_mode::full );
+  const uword method_id = (met == 'd') ? glue_conv_mode::method_direct : ( (met == 'f') ? glue_conv_mode::method_fft : glue_conv_mode::method_auto );
   
-  return Glue<T1, T2, glue_conv>(A, B, mode);
+  return Glue<T1, T2, glue_conv>(A, B, shape_id + 4*method_id);
   }
 
 
@@ -46,17 +51,138 @@ enable_if2
   (is_arma_type<T1>::value && is_arma_type<T2>::value && is_same_type<typename T1::elem_type, typename T2::elem_type>::value),
   const Glue<T1, T2, glue_conv2>
   >::result
-conv2(const T1& A, const T2& B, const char* shape = "full")
+conv2(const T1& A, const T2& B, const char* shape = "full", const char* method = "auto")
+  {
+  arma_extra_debug_sigprint();
+  
+  const char sig = (shape  != NULL) ? shape[0]  : char(0);
+  const char met = (method != NULL) ? method[0] : char(0);
+  
+  arma_debug_check( ((sig != 'f') && (sig != 's') && (sig != 'v')), "conv2(): unsupported value of 'shape' parameter"  );
+  arma_debug_check( ((met != 'a') && (met != 'd') && (met != 'f')), "conv2(): unsupported value of 'method' parameter" );
+  
+  const uword shape_id  = (sig == 's') ? glue_conv_mode::same : ( (sig == 'v') ? glue_conv_mode::valid : glue_conv_mode::full );
+  const uword method_id = (met == 'd') ? glue_conv_mode::method_direct : ( (met == 'f') ? glue_conv_mode::method_fft : glue_conv_mode::method_auto );
+  
+  return Glue<T1, T2, glue_conv2>(A, B, shape_id + 4*method_id);
+  }
+
+
+
+
+//! convolution with the separable filter u*v, where u is a column vector and v is a row vector (as per Matlab's conv2(u,v,A));
+//! the columns of A are convolved with u, and the rows of the result are convolved with v
+
+template<typename T1, typename T2, typename T3>
+inline
+typename
+enable_if2
+  <
+  (is_arma_type<T1>::value && is_arma_type<T2>::value && is_arma_type<T3>::value && is_same_type<typename T1::elem_type, typename T2::elem_type>::value && is_same_type<typename T1::elem_type, typename T3::elem_type>::value),
+  Mat<typename T1::elem_type>
+  >::result
+conv2(const T1& u, const T2& v, const T3& A, const char* shape = "full")
   {
   arma_extra_debug_sigprint();
   
+  typedef typename T1::elem_type eT;
+  
   const char sig = (shape != NULL) ? shape[0] : char(0);
   
-  arma_debug_check( ((sig != 'f') && (sig != 's')), "conv2(): unsupported value of 'shape' parameter" );
+  arma_debug_check( ((sig != 'f') && (sig != 's') && (sig != 'v')), "conv2(): unsupported value of 'shape' parameter" );
+  
+  const uword shape_id = (sig == 's') ? glue_conv_mode::same : ( (sig == 'v') ? glue_conv_mode::valid : glue_conv_mode::full );
+  
+  const quasi_unwrap<T1> Uu(u);
+  const quasi_unwrap<T2> Uv(v);
+  const quasi_unwrap<T3> UA(A);
+  
+  arma_debug_check( ( ((Uu.M.is_vec() == false) && (Uu.M.is_empty() == false)) || ((Uv.M.is_vec() == false) && (Uv.M.is_empty() == false)) ), "conv2(): given filters must be vectors" );
+  
+  const Col<eT> uu( const_cast<eT*>(Uu.M.memptr()), Uu.M.n_elem, false, true );
+  const Row<eT> vv( const_cast<eT*>(Uv.M.memptr()), Uv.M.n_elem, false, true );
+  
+  Mat<eT> out;
+  
+  glue_conv2::apply(out, uu, vv, UA.M, shape_id);
+  
+  return out;
+  }
+
+
+
+//! convolution of each slice of cube Q with matrix K
+
+template<typename T1, typename T2>
+inline
+Cube<typename T1::elem_type>
+conv2(const BaseCube<typename T1::elem_type,T1>& Q, const Base<typename T1::elem_type,T2>& K, const char* shape = "full", const char* method = "auto")
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename T1::elem_type eT;
+  
+  const char sig = (shape  != NULL) ? shape[0]  : char(0);
+  const char met = (method != NULL) ? method[0] : char(0);
+  
+  arma_debug_check( ((sig != 'f') && (sig != 's') && (sig != 'v')), "conv2(): unsupported value of 'shape' parameter"  );
+  arma_debug_check( ((met != 'a') && (met != 'd') && (met != 'f')), "conv2(): unsupported value of 'method' parameter" );
+  
+  const uword shape_id  = (sig == 's') ? glue_conv_mode::same : ( (sig == 'v') ? glue_conv_mode::valid : glue_conv_mode::full );
+  const uword method_id = (met == 'd') ? glue_conv_mode::method_direct : ( (met == 'f') ? glue_conv_mode::method_fft : glue_conv_mode::method_auto );
+  
+  const unwrap_cube<T1>  UQ(Q.get_ref());
+  const quasi_unwrap<T2> UK(K.get_ref());
+  
+  Cube<eT> out;
+  
+  glue_conv2::apply(out, UQ.M, UK.M, shape_id + 4*method_id);
+  
+  return out;
+  }
+
+
+
+//! 2D cross-correlation, ie. conv2(A, B) with B rotated by 180 degrees and conjugated;
+//! the full result has (A.n_rows + B.n_rows - 1) rows and (A.n_cols + B.n_cols - 1) columns
+
+template<typename T1, typename T2>
+inline
+typename
+enable_if2
+  <
+  (is_arma_type<T1>::value && is_arma_type<T2>::value && is_same_type<typename T1::elem_type, typename T2::elem_type>::value),
+  Mat<typename T1::elem_type>
+  >::result
+xcorr2(const T1& A, const T2& B, const char* shape = "full", const char* method = "auto")
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename T1::elem_type eT;
+  
+  const Mat<eT> K = conj( flipud(fliplr(B)) );
+  
+  Mat<eT> out = conv2(A, K, shape, method);
+  
+  return out;
+  }
+
+
+
+//! 2D cross-correlation of each slice of cube Q with matrix K
+
+template<typename T1, typename T2>
+inline
+Cube<typename T1::elem_type>
+xcorr2(const BaseCube<typename T1::elem_type,T1>& Q, const Base<typename T1::elem_type,T2>& K, const char* shape = "full", const char* method = "auto")
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename T1::elem_type eT;
   
-  const uword mode = (sig == 's') ? uword(1) : uword(0);
+  const Mat<eT> KK = conj( flipud(fliplr(K.get_ref())) );
   
-  return Glue<T1, T2, glue_conv2>(A, B, mode);
+  return conv2(Q, KK, shape, method);
   }
 
 
@@ -42,4 +42,31 @@ cov(const Base<typename T1::elem_type,T1>& A, const Base<typename T1::elem_type,
 
 
 
+//! weighted covariance matrix of X, where each row of X is an observation with a non-negative weight in vector W;
+//! the covariance is normalised by the sum of the weights
+template<typename T1, typename T2>
+inline
+typename
+enable_if2
+  <
+  is_real<typename T1::elem_type>::value,
+  Mat<typename T1::elem_type>
+  >::result
+cov_weighted(const Base<typename T1::elem_type,T1>& X, const Base<typename T1::elem_type,T2>& W)
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename T1::elem_type eT;
+  
+  const quasi_unwrap<T1> UX(X.get_ref());
+  const quasi_unwrap<T2> UW(W.get_ref());
+  
+  Mat<eT> out;
+  
+  op_cov::direct_cov_weighted(out, UX.M, UW.M);
+  
+  return out;
+  }
+
+
 //! @}
@@ -119,4 +119,76 @@ ifft(const T1& A, const uword N)
 
 
 
+// 1D FFT of real data & its inverse, using N/2+1 values of the transform
+
+
+
+template<typename T1>
+inline
+typename
+enable_if2
+  <
+  (is_arma_type<T1>::value && is_real<typename T1::elem_type>::value),
+  const mtOp<std::complex<typename T1::pod_type>, T1, op_rfft>
+  >::result
+rfft(const T1& A)
+  {
+  arma_extra_debug_sigprint();
+  
+  return mtOp<std::complex<typename T1::pod_type>, T1, op_rfft>(A, uword(0), uword(1));
+  }
+
+
+
+template<typename T1>
+inline
+typename
+enable_if2
+  <
+  (is_arma_type<T1>::value && is_real<typename T1::elem_type>::value),
+  const mtOp<std::complex<typename T1::pod_type>, T1, op_rfft>
+  >::result
+rfft(const T1& A, const uword N)
+  {
+  arma_extra_debug_sigprint();
+  
+  return mtOp<std::complex<typename T1::pod_type>, T1, op_rfft>(A, N, uword(0));
+  }
+
+
+
+template<typename T1>
+inline
+typename
+enable_if2
+  <
+  (is_arma_type<T1>::value && is_complex_strict<typename T1::elem_type>::value),
+  const mtOp<typename T1::pod_type, T1, op_irfft>
+  >::result
+irfft(const T1& A)
+  {
+  arma_extra_debug_sigprint();
+  
+  return mtOp<typename T1::pod_type, T1, op_irfft>(A, uword(0), uword(1));
+  }
+
+
+
+template<typename T1>
+inline
+typename
+enable_if2
+  <
+  (is_arma_type<T1>::value && is_complex_strict<typename T1::elem_type>::value),
+  const mtOp<typename T1::pod_type, T1, op_irfft>
+  >::result
+irfft(const T1& A, const uword N)
+  {
+  arma_extra_debug_sigprint();
+  
+  return mtOp<typename T1::pod_type, T1, op_irfft>(A, N, uword(0));
+  }
+
+
+
 //! @}
@@ -22,25 +22,47 @@ inline
 typename
 enable_if2
   <
-  is_arma_type<T1>::value,
+  (is_arma_type<T1>::value && is_real<typename T1::elem_type>::value),
   Mat< std::complex<typename T1::pod_type> >
   >::result
 fft2(const T1& A)
   {
   arma_extra_debug_sigprint();
   
-  // not exactly efficient, but "better-than-nothing" implementation
+  typedef typename T1::pod_type T;
+  
+  const unwrap<T1> tmp(A);
+  
+  Mat< std::complex<T> > out;
+  
+  op_rfft::apply2<true>(out, tmp.M);
+  
+  return out;
+  }
+
+
+
+template<typename T1>
+inline
+typename
+enable_if2
+  <
+  (is_arma_type<T1>::value && is_complex_strict<typename T1::elem_type>::value),
+  Mat< std::complex<typename T1::pod_type> >
+  >::result
+fft2(const T1& A)
+  {
+  arma_extra_debug_sigprint();
   
   typedef typename T1::pod_type T;
   
-  Mat< std::complex<T> > B = fft(A);
+  const unwrap<T1> tmp(A);
   
-  // for square matrices, strans() will work out that an inplace transpose can be done,
-  // hence we can potentially avoid creating a temporary matrix
+  Mat< std::complex<T> > out;
   
-  B = strans(B);
+  op_fft_cx::apply2<false>(out, tmp.M);
   
-  return strans( fft(B) );
+  return out;
   }
 
 
@@ -81,18 +103,15 @@ ifft2(const T1& A)
   {
   arma_extra_debug_sigprint();
   
-  // not exactly efficient, but "better-than-nothing" implementation
-  
   typedef typename T1::pod_type T;
   
-  Mat< std::complex<T> > B = ifft(A);
+  const unwrap<T1> tmp(A);
   
-  // for square matrices, strans() will work out that an inplace transpose can be done,
-  // hence we can potentially avoid creating a temporary matrix
+  Mat< std::complex<T> > out;
   
-  B = strans(B);
+  op_fft_cx::apply2<true>(out, tmp.M);
   
-  return strans( ifft(B) );
+  return out;
   }
 
 
@@ -121,4 +140,109 @@ ifft2(const T1& A, const uword n_rows, const uword n_cols)
 
 
 
+// 2D FFT of real data & its inverse, using the first n_rows/2+1 rows of the transform
+
+
+
+template<typename T1>
+inline
+typename
+enable_if2
+  <
+  (is_arma_type<T1>::value && is_real<typename T1::elem_type>::value),
+  Mat< std::complex<typename T1::pod_type> >
+  >::result
+rfft2(const T1& A)
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename T1::pod_type T;
+  
+  const unwrap<T1> tmp(A);
+  
+  Mat< std::complex<T> > out;
+  
+  op_rfft::apply2<false>(out, tmp.M);
+  
+  return out;
+  }
+
+
+
+template<typename T1>
+inline
+typename
+enable_if2
+  <
+  (is_arma_type<T1>::value && is_real<typename T1::elem_type>::value),
+  Mat< std::complex<typename T1::pod_type> >
+  >::result
+rfft2(const T1& A, const uword n_rows, const uword n_cols)
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename T1::elem_type eT;
+  
+  const unwrap<T1>   tmp(A);
+  const Mat<eT>& B = tmp.M;
+  
+  const bool do_resize = (B.n_rows != n_rows) || (B.n_cols != n_cols);
+  
+  return rfft2( do_resize ? resize(B,n_rows,n_cols) : B );
+  }
+
+
+
+template<typename T1>
+inline
+typename
+enable_if2
+  <
+  (is_arma_type<T1>::value && is_complex_strict<typename T1::elem_type>::value),
+  Mat<typename T1::pod_type>
+  >::result
+irfft2(const T1& A)
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename T1::pod_type T;
+  
+  const unwrap<T1> tmp(A);
+  
+  const uword n_rows = (tmp.M.n_rows > 0) ? 2*(tmp.M.n_rows - 1) : uword(0);
+  
+  Mat<T> out;
+  
+  op_irfft::apply2(out, tmp.M, n_rows, tmp.M.n_cols);
+  
+  return out;
+  }
+
+
+
+template<typename T1>
+inline
+typename
+enable_if2
+  <
+  (is_arma_type<T1>::value && is_complex_strict<typename T1::elem_type>::value),
+  Mat<typename T1::pod_type>
+  >::result
+irfft2(const T1& A, const uword n_rows, const uword n_cols)
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename T1::pod_type T;
+  
+  const unwrap<T1> tmp(A);
+  
+  Mat<T> out;
+  
+  op_irfft::apply2(out, tmp.M, n_rows, n_cols);
+  
+  return out;
+  }
+
+
+
 //! @}
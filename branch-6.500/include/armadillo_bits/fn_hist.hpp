@@ -62,4 +62,43 @@ hist(const T1& X, const T2& Y, const uword dim)
   }
 
 
+
+//! joint histogram of the pairs (X(i), Y(i));
+//! element (j,k) of the output is the number of pairs where X(i) is nearest to centers_x(j) and Y(i) is nearest to centers_y(k)
+template<typename T1, typename T2, typename T3, typename T4>
+inline
+typename
+enable_if2
+  <
+  (is_arma_type<T1>::value) && (is_arma_type<T2>::value) && (is_arma_type<T3>::value) && (is_arma_type<T4>::value) && (is_not_complex<typename T1::elem_type>::value) && (is_same_type<typename T1::elem_type, typename T2::elem_type>::value) && (is_same_type<typename T1::elem_type, typename T3::elem_type>::value) && (is_same_type<typename T1::elem_type, typename T4::elem_type>::value),
+  Mat<uword>
+  >::result
+hist2(const T1& X, const T2& Y, const T3& centers_x, const T4& centers_y)
+  {
+  arma_extra_debug_sigprint();
+  
+  const quasi_unwrap<T1> UX(X);
+  const quasi_unwrap<T2> UY(Y);
+  const quasi_unwrap<T3> UBX(centers_x);
+  const quasi_unwrap<T4> UBY(centers_y);
+  
+  arma_debug_check( (UX.M.n_elem != UY.M.n_elem), "hist2(): X and Y must have the same number of elements" );
+  
+  arma_debug_check
+    (
+    ( ((UBX.M.is_vec() == false) && (UBX.M.is_empty() == false)) || ((UBY.M.is_vec() == false) && (UBY.M.is_empty() == false)) ),
+    "hist2(): parameters 'centers_x' and 'centers_y' must be vectors"
+    );
+  
+  Mat<uword> out;
+  
+  if( (UBX.M.n_elem > 0) && (UBY.M.n_elem > 0) )
+    {
+    glue_hist::apply_2d<glue_hist>(out, UX.M, UY.M, UBX.M, UBY.M, true);
+    }
+  
+  return out;
+  }
+
+
 //! @}
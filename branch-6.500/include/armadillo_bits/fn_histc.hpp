@@ -45,4 +45,43 @@ histc(const T1& X, const T2& Y, const uword dim)
   }
 
 
+
+//! joint histogram of the pairs (X(i), Y(i));
+//! element (j,k) of the output is the number of pairs where X(i) is in bin j of edges_x and Y(i) is in bin k of edges_y
+template<typename T1, typename T2, typename T3, typename T4>
+inline
+typename
+enable_if2
+  <
+  (is_arma_type<T1>::value) && (is_arma_type<T2>::value) && (is_arma_type<T3>::value) && (is_arma_type<T4>::value) && (is_not_complex<typename T1::elem_type>::value) && (is_same_type<typename T1::elem_type, typename T2::elem_type>::value) && (is_same_type<typename T1::elem_type, typename T3::elem_type>::value) && (is_same_type<typename T1::elem_type, typename T4::elem_type>::value),
+  Mat<uword>
+  >::result
+histc2(const T1& X, const T2& Y, const T3& edges_x, const T4& edges_y)
+  {
+  arma_extra_debug_sigprint();
+  
+  const quasi_unwrap<T1> UX(X);
+  const quasi_unwrap<T2> UY(Y);
+  const quasi_unwrap<T3> UBX(edges_x);
+  const quasi_unwrap<T4> UBY(edges_y);
+  
+  arma_debug_check( (UX.M.n_elem != UY.M.n_elem), "histc2(): X and Y must have the same number of elements" );
+  
+  arma_debug_check
+    (
+    ( ((UBX.M.is_vec() == false) && (UBX.M.is_empty() == false)) || ((UBY.M.is_vec() == false) && (UBY.M.is_empty() == false)) ),
+    "histc2(): parameters 'edges_x' and 'edges_y' must be vectors"
+    );
+  
+  Mat<uword> out;
+  
+  if( (UBX.M.n_elem > 0) && (UBY.M.n_elem > 0) )
+    {
+    glue_hist::apply_2d<glue_histc>(out, UX.M, UY.M, UBX.M, UBY.M, false);
+    }
+  
+  return out;
+  }
+
+
 //! @}
@@ -13,146 +13,251 @@
 
 
 
+//! index j of the interval XG[j] <= x <= XG[j+1] of the ascending grid XG, for x within the domain of XG;
+//! j_prev is the interval of the previous query, which is checked first.
+//! with merge = true (ascending queries) the grid is traversed together with the queries, so that all queries take O(NG + NI) time;
+//! otherwise a binary search is used
+template<typename eT>
+arma_inline
+uword
+interp1_find_interval(const eT* XG_mem, const uword NG, const eT x, const uword j_prev, const bool merge)
+  {
+  uword j = j_prev;
+  
+  if( (XG_mem[j] <= x) && (x <= XG_mem[j+1]) )  { return j; }
+  
+  if( merge && (XG_mem[j] <= x) )
+    {
+    while( (j+2 < NG) && (XG_mem[j+1] < x) )  { ++j; }
+    
+    return j;
+    }
+  
+  j = uword( std::upper_bound(XG_mem, XG_mem + NG, x) - XG_mem );
+  
+  j = (j > 0) ? (j-1) : uword(0);
+  
+  return (j < NG-1) ? j : (NG-2);
+  }
+
+
+
+template<typename eT>
+inline
+bool
+interp1_is_increasing(const Mat<eT>& X)
+  {
+  const eT*   X_mem = X.memptr();
+  const uword N     = X.n_elem;
+  
+  for(uword i=1; i < N; ++i)
+    {
+    if( (X_mem[i-1] < X_mem[i]) == false )  { return false; }  // also catches NaN
+    }
+  
+  return true;
+  }
+
+
+
+//! slopes at the grid points for piecewise cubic Hermite interpolation:
+//! method 3 gives shape preserving slopes (pchip, as per Fritsch and Carlson),
+//! while method 4 gives the slopes of the cubic spline with not-a-knot end conditions
 template<typename eT>
 inline
 void
-interp1_helper_nearest(const Mat<eT>& XG, const Mat<eT>& YG, const Mat<eT>& XI, Mat<eT>& YI, const eT extrap_val)
+interp1_slopes(Col<eT>& D, const Mat<eT>& XG, const Mat<eT>& YG, const uword method)
   {
   arma_extra_debug_sigprint();
   
-  const eT XG_min = XG.min();
-  const eT XG_max = XG.max();
-  
-  YI.copy_size(XI);
+  const uword NG = XG.n_elem;
   
   const eT* XG_mem = XG.memptr();
   const eT* YG_mem = YG.memptr();
-  const eT* XI_mem = XI.memptr();
-        eT* YI_mem = YI.memptr();
   
-  const uword NG = XG.n_elem;
-  const uword NI = XI.n_elem;
+  Col<eT> h  (NG-1);   // interval lengths
+  Col<eT> del(NG-1);   // slopes of the intervals
   
-  uword best_j = 0;
+  eT*   h_mem =   h.memptr();
+  eT* del_mem = del.memptr();
   
-  for(uword i=0; i<NI; ++i)
+  for(uword k=0; k < NG-1; ++k)
     {
-    eT best_err = Datum<eT>::inf;
-    
-    const eT XI_val = XI_mem[i];
+    h_mem[k]   = XG_mem[k+1] - XG_mem[k];
+    del_mem[k] = (YG_mem[k+1] - YG_mem[k]) / h_mem[k];
+    }
+  
+  D.set_size(NG);
+  
+  eT* D_mem = D.memptr();
+  
+  if(NG == 2)  { D_mem[0] = del_mem[0]; D_mem[1] = del_mem[0]; return; }
+  
+  if(method == 3)
+    {
+    // weighted harmonic mean of the adjacent slopes, or zero at local extrema
     
-    if((XI_val < XG_min) || (XI_val > XG_max))
+    for(uword k=1; k < NG-1; ++k)
       {
-      YI_mem[i] = extrap_val;
-      }
-    else
-      {
-      // XG and XI are guaranteed to be sorted in ascending manner,
-      // so start searching XG from last known optimum position 
+      const eT d0 = del_mem[k-1];
+      const eT d1 = del_mem[k  ];
       
-      for(uword j=best_j; j<NG; ++j)
+      if( (d0 == eT(0)) || (d1 == eT(0)) || ((d0 > eT(0)) != (d1 > eT(0))) )
         {
-        const eT tmp = XG_mem[j] - XI_val;
-        const eT err = (tmp >= eT(0)) ? tmp : -tmp;
+        D_mem[k] = eT(0);
+        }
+      else
+        {
+        const eT w1 = eT(2)*h_mem[k] + h_mem[k-1];
+        const eT w2 = h_mem[k] + eT(2)*h_mem[k-1];
         
-        if(err >= best_err)
-          {
-          // error is going up, so we have found the optimum position
-          break;
-          }
-        else
-          {
-          best_err = err;
-          best_j   = j;   // remember the optimum position
-          }
+        D_mem[k] = (w1 + w2) / (w1/d0 + w2/d1);
         }
+      }
+    
+    // one-sided three point estimates at the ends, modified to preserve the shape
+    
+    for(uword e=0; e < 2; ++e)
+      {
+      const uword k  = (e == 0) ? uword(0) : (NG-1);
+      const eT    h0 = (e == 0) ? h_mem[0]   : h_mem[NG-2];
+      const eT    h1 = (e == 0) ? h_mem[1]   : h_mem[NG-3];
+      const eT    d0 = (e == 0) ? del_mem[0] : del_mem[NG-2];
+      const eT    d1 = (e == 0) ? del_mem[1] : del_mem[NG-3];
+      
+      eT d = ( (eT(2)*h0 + h1)*d0 - h0*d1 ) / (h0 + h1);
       
-      YI_mem[i] = YG_mem[best_j];
+           if( (d > eT(0)) != (d0 > eT(0)) || (d == eT(0)) )                          { d = eT(0);     }
+      else if( ((d0 > eT(0)) != (d1 > eT(0))) && (std::abs(d) > std::abs(eT(3)*d0)) )  { d = eT(3)*d0; }
+      
+      D_mem[k] = d;
       }
+    
+    return;
+    }
+  
+  if(NG == 3)
+    {
+    // the not-a-knot spline through three points is the parabola through them
+    
+    const eT c = (del_mem[1] - del_mem[0]) / (h_mem[0] + h_mem[1]);
+    
+    D_mem[0] = del_mem[0] - c*h_mem[0];
+    D_mem[1] = del_mem[0] + c*h_mem[0];
+    D_mem[2] = del_mem[0] + c*(h_mem[0] + eT(2)*h_mem[1]);
+    
+    return;
+    }
+  
+  // tridiagonal system for the slopes: row k has sub-diagonal element a[k], diagonal element b[k] and super-diagonal element c[k]
+  
+  Col<eT> a(NG);
+  Col<eT> b(NG);
+  Col<eT> c(NG);
+  
+  eT* a_mem = a.memptr();
+  eT* b_mem = b.memptr();
+  eT* c_mem = c.memptr();
+  
+  const eT x31 = h_mem[0]    + h_mem[1];
+  const eT xn  = h_mem[NG-2] + h_mem[NG-3];
+  
+  a_mem[0] = eT(0);
+  b_mem[0] = h_mem[1];
+  c_mem[0] = x31;
+  D_mem[0] = ( (h_mem[0] + eT(2)*x31)*h_mem[1]*del_mem[0] + h_mem[0]*h_mem[0]*del_mem[1] ) / x31;
+  
+  for(uword k=1; k < NG-1; ++k)
+    {
+    a_mem[k] = h_mem[k];
+    b_mem[k] = eT(2)*(h_mem[k-1] + h_mem[k]);
+    c_mem[k] = h_mem[k-1];
+    D_mem[k] = eT(3)*(h_mem[k]*del_mem[k-1] + h_mem[k-1]*del_mem[k]);
+    }
+  
+  a_mem[NG-1] = xn;
+  b_mem[NG-1] = h_mem[NG-3];
+  c_mem[NG-1] = eT(0);
+  D_mem[NG-1] = ( h_mem[NG-2]*h_mem[NG-2]*del_mem[NG-3] + (eT(2)*xn + h_mem[NG-2])*h_mem[NG-3]*del_mem[NG-2] ) / xn;
+  
+  // forward elimination and back substitution
+  
+  for(uword k=1; k < NG; ++k)
+    {
+    const eT m = a_mem[k] / b_mem[k-1];
+    
+    b_mem[k] -= m*c_mem[k-1];
+    D_mem[k] -= m*D_mem[k-1];
+    }
+  
+  D_mem[NG-1] /= b_mem[NG-1];
+  
+  for(uword k=NG-1; k > 0; --k)
+    {
+    D_mem[k-1] = (D_mem[k-1] - c_mem[k-1]*D_mem[k]) / b_mem[k-1];
     }
   }
 
 
 
+//! interpolate the queries XI[i_start] to XI[i_end-1], using the ascending grid XG without duplicates;
+//! method is 1 for nearest neighbour, 2 for linear, or 3 and 4 for cubic Hermite interpolation with the slopes in D_mem
 template<typename eT>
 inline
 void
-interp1_helper_linear(const Mat<eT>& XG, const Mat<eT>& YG, const Mat<eT>& XI, Mat<eT>& YI, const eT extrap_val)
+interp1_worker(const Mat<eT>& XG, const Mat<eT>& YG, const eT* D_mem, const Mat<eT>& XI, eT* YI_mem, const uword method, const eT extrap_val, const bool XI_ascending, const uword i_start, const uword i_end)
   {
   arma_extra_debug_sigprint();
   
-  const eT XG_min = XG.min();
-  const eT XG_max = XG.max();
-  
-  YI.copy_size(XI);
-  
   const eT* XG_mem = XG.memptr();
   const eT* YG_mem = YG.memptr();
   const eT* XI_mem = XI.memptr();
-        eT* YI_mem = YI.memptr();
   
   const uword NG = XG.n_elem;
-  const uword NI = XI.n_elem;
   
-  uword a_best_j = 0;
-  uword b_best_j = 0;
+  const eT XG_min = XG_mem[0];
+  const eT XG_max = XG_mem[NG-1];
   
-  for(uword i=0; i<NI; ++i)
+  uword j     = 0;
+  bool  merge = false;  // the first query within the domain is found via binary search
+  
+  for(uword i=i_start; i < i_end; ++i)
     {
     const eT XI_val = XI_mem[i];
     
-    if((XI_val < XG_min) || (XI_val > XG_max))
+    if(arma_isnan(XI_val))  { YI_mem[i] = Datum<eT>::nan; continue; }
+    
+    if((XI_val < XG_min) || (XI_val > XG_max))  { YI_mem[i] = extrap_val; continue; }
+    
+    j = interp1_find_interval(XG_mem, NG, XI_val, j, merge);
+    
+    merge = XI_ascending;
+    
+    const eT a_err = XI_val      - XG_mem[j];
+    const eT b_err = XG_mem[j+1] - XI_val;
+    
+    if(method == 1)
       {
-      YI_mem[i] = extrap_val;
+      YI_mem[i] = (a_err <= b_err) ? YG_mem[j] : YG_mem[j+1];
       }
     else
+    if(method == 2)
       {
-      // XG and XI are guaranteed to be sorted in ascending manner,
-      // so start searching XG from last known optimum position 
-      
-      eT a_best_err = Datum<eT>::inf;
-      eT b_best_err = Datum<eT>::inf;
-      
-      for(uword j=a_best_j; j<NG; ++j)
-        {
-        const eT tmp = XG_mem[j] - XI_val;
-        const eT err = (tmp >= eT(0)) ? tmp : -tmp;
-        
-        if(err >= a_best_err)
-          {
-          break;
-          }
-        else
-          {
-          a_best_err = err;
-          a_best_j   = j;
-          }
-        }
-      
-      if( (XG_mem[a_best_j] - XI_val) <= eT(0) )
-        {
-        // a_best_j is to the left of the interpolated position
-        
-        b_best_j = ( (a_best_j+1) < NG) ? (a_best_j+1) : a_best_j; 
-        }
-      else
-        {
-        // a_best_j is to the right of the interpolated position
-        
-        b_best_j = (a_best_j >= 1) ? (a_best_j-1) : a_best_j; 
-        }
-      
-      b_best_err = std::abs( XG_mem[b_best_j] - XI_val );
-      
-      if(a_best_j > b_best_j)
-        {
-        std::swap(a_best_j,   b_best_j  );
-        std::swap(a_best_err, b_best_err);
-        }
+      const eT weight = (a_err > eT(0)) ? (a_err / (a_err + b_err)) : eT(0);
       
-      const eT weight = (a_best_err > eT(0)) ? (a_best_err / (a_best_err + b_best_err)) : eT(0);
+      YI_mem[i] = (eT(1) - weight)*YG_mem[j] + (weight)*YG_mem[j+1];
+      }
+    else
+      {
+      const eT h  = XG_mem[j+1] - XG_mem[j];
+      const eT t  = a_err / h;
+      const eT t2 = t*t;
+      const eT t3 = t2*t;
       
-      YI_mem[i] = (eT(1) - weight)*YG_mem[a_best_j] + (weight)*YG_mem[b_best_j];
+      YI_mem[i] = (eT(2)*t3 - eT(3)*t2 + eT(1)) * YG_mem[j  ]
+                + (t3 - eT(2)*t2 + t)           * h * D_mem[j  ]
+                + (eT(3)*t2 - eT(2)*t3)         * YG_mem[j+1]
+                + (t3 - t2)                     * h * D_mem[j+1];
       }
     }
   }
@@ -173,95 +278,89 @@ interp1_helper(const Mat<eT>& X, const Mat<eT>& Y, const Mat<eT>& XI, Mat<eT>& Y
   arma_debug_check( (X.n_elem < 2), "interp1(): X must have at least two unique elements" );
   
   // sig = 10: nearest neighbour
-  // sig = 11: nearest neighbour, assume monotonic increase in X and XI
-  // 
   // sig = 20: linear
-  // sig = 21: linear, assume monotonic increase in X and XI
-  
-  if(sig == 11)  { interp1_helper_nearest(X, Y, XI, YI, extrap_val); return; }
-  if(sig == 21)  { interp1_helper_linear (X, Y, XI, YI, extrap_val); return; }
-  
-  uvec X_indices;
-  
-  try { X_indices = find_unique(X,false); } catch(...) { }
-  
-  // NOTE: find_unique(X,false) provides indices of elements sorted in ascending order
-  // NOTE: find_unique(X,false) will reset X_indices if X has NaN
-  
-  const uword N_subset = X_indices.n_elem;
-  
-  arma_debug_check( (N_subset < 2), "interp1(): X must have at least two unique elements" );
+  // sig = 30: piecewise cubic Hermite (pchip)
+  // sig = 40: cubic spline
+  // 
+  // sig + 1: as above, but assume monotonic increase in X
   
-  Mat<eT> X_sanitised(N_subset,1);
-  Mat<eT> Y_sanitised(N_subset,1);
+  const uword method = sig / 10;
   
-  eT* X_sanitised_mem = X_sanitised.memptr();
-  eT* Y_sanitised_mem = Y_sanitised.memptr();
+  // the grid is sanitised (sorted, with duplicates and NaN removed) only when it is not already strictly increasing
   
-  const eT* X_mem = X.memptr();
-  const eT* Y_mem = Y.memptr();
+  const bool X_is_clean = ((sig % 10) == 1) || interp1_is_increasing(X);
   
-  const uword* X_indices_mem = X_indices.memptr();
+  Mat<eT> X_sanitised;
+  Mat<eT> Y_sanitised;
   
-  for(uword i=0; i<N_subset; ++i)
+  if(X_is_clean == false)
     {
-    const uword j = X_indices_mem[i];
+    uvec X_indices;
     
-    X_sanitised_mem[i] = X_mem[j];
-    Y_sanitised_mem[i] = Y_mem[j];
-    }
-  
-  
-  Mat<eT> XI_tmp;
-  uvec    XI_indices;
-  
-  const bool XI_is_sorted = XI.is_sorted();
-  
-  if(XI_is_sorted == false)
-    {
-    XI_indices = sort_index(XI);
+    try { X_indices = find_unique(X,false); } catch(...) { }
     
-    const uword N = XI.n_elem;
+    // NOTE: find_unique(X,false) provides indices of elements sorted in ascending order
+    // NOTE: find_unique(X,false) will reset X_indices if X has NaN
     
-    XI_tmp.copy_size(XI);
+    const uword N_subset = X_indices.n_elem;
     
-    const uword* XI_indices_mem = XI_indices.memptr();
+    arma_debug_check( (N_subset < 2), "interp1(): X must have at least two unique elements" );
     
-    const eT* XI_mem     = XI.memptr();
-          eT* XI_tmp_mem = XI_tmp.memptr();
+    X_sanitised.set_size(N_subset,1);
+    Y_sanitised.set_size(N_subset,1);
     
-    for(uword i=0; i<N; ++i)
+    eT* X_sanitised_mem = X_sanitised.memptr();
+    eT* Y_sanitised_mem = Y_sanitised.memptr();
+    
+    const eT* X_mem = X.memptr();
+    const eT* Y_mem = Y.memptr();
+    
+    const uword* X_indices_mem = X_indices.memptr();
+    
+    for(uword i=0; i<N_subset; ++i)
       {
-      XI_tmp_mem[i] = XI_mem[ XI_indices_mem[i] ];
+      const uword j = X_indices_mem[i];
+      
+      X_sanitised_mem[i] = X_mem[j];
+      Y_sanitised_mem[i] = Y_mem[j];
       }
     }
   
-  const Mat<eT>& XI_sorted = (XI_is_sorted) ? XI : XI_tmp;
+  const Mat<eT>& XG = (X_is_clean) ? X : X_sanitised;
+  const Mat<eT>& YG = (X_is_clean) ? Y : Y_sanitised;
   
+  Col<eT> D;
   
-       if(sig == 10)  { interp1_helper_nearest(X_sanitised, Y_sanitised, XI_sorted, YI, extrap_val); }
-  else if(sig == 20)  { interp1_helper_linear (X_sanitised, Y_sanitised, XI_sorted, YI, extrap_val); }
+  if(method >= 3)  { interp1_slopes(D, XG, YG, method); }
   
+  YI.copy_size(XI);
   
-  if( (XI_is_sorted == false) && (YI.n_elem > 0) )
+  const uword NI = XI.n_elem;
+  
+  const bool XI_ascending = XI.is_sorted();
+
+  #if defined(_OPENMP)
     {
-    Mat<eT> YI_unsorted;
-    
-    YI_unsorted.copy_size(YI);
+    const uword n_threads_max = uword( (std::max)(int(1), int(omp_get_max_threads())) );
+    const uword n_threads     = (NI >= 16384) ? (std::min)(NI, n_threads_max) : uword(1);
     
-    const eT* YI_mem          = YI.memptr();
-          eT* YI_unsorted_mem = YI_unsorted.memptr();
-    
-    const uword  N              = XI_sorted.n_elem;
-    const uword* XI_indices_mem = XI_indices.memptr();
-    
-    for(uword i=0; i<N; ++i)
+    if(n_threads > 1)
       {
-      YI_unsorted_mem[ XI_indices_mem[i] ] = YI_mem[i];
+      #pragma omp parallel for schedule(static)
+      for(uword t=0; t < n_threads; ++t)
+        {
+        const uword i_start = (t     * NI) / n_threads;
+        const uword i_end   = ((t+1) * NI) / n_threads;
+        
+        interp1_worker(XG, YG, D.memptr(), XI, YI.memptr(), method, extrap_val, XI_ascending, i_start, i_end);
+        }
+      
+      return;
       }
-    
-    YI.steal_mem(YI_unsorted);
     }
+  #endif
+  
+  interp1_worker(XG, YG, D.memptr(), XI, YI.memptr(), method, extrap_val, XI_ascending, 0, NI);
   }
 
 
@@ -299,10 +398,14 @@ interp1
     
          if(c1 == 'n')  { sig = 10; }  // nearest neighbour
     else if(c1 == 'l')  { sig = 20; }  // linear
+    else if(c1 == 'p')  { sig = 30; }  // piecewise cubic Hermite (pchip)
+    else if(c1 == 's')  { sig = 40; }  // cubic spline
     else
       {
-      if( (c1 == '*') && (c2 == 'n') )  { sig = 11; }  // nearest neighour, assume monotonic increase in X and XI
-      if( (c1 == '*') && (c2 == 'l') )  { sig = 21; }  // linear, assume monotonic increase in X and XI
+      if( (c1 == '*') && (c2 == 'n') )  { sig = 11; }  // nearest neighour, assume monotonic increase in X
+      if( (c1 == '*') && (c2 == 'l') )  { sig = 21; }  // linear, assume monotonic increase in X
+      if( (c1 == '*') && (c2 == 'p') )  { sig = 31; }  // pchip, assume monotonic increase in X
+      if( (c1 == '*') && (c2 == 's') )  { sig = 41; }  // cubic spline, assume monotonic increase in X
       }
     }
   
@@ -0,0 +1,207 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup fn_interp2
+//! @{
+
+
+
+//! for each query location in Q, find its position on the strictly increasing grid G.
+//! linear (method = 2): j_mem[i] is the interval and w_mem[i] the weight of its right end;
+//! nearest neighbour (method = 1): j_mem[i] is the nearest grid point.
+//! for a location outside of the grid, j_mem[i] is set to G.n_elem and w_mem[i] holds the value of the output
+template<typename eT>
+inline
+void
+interp2_locate(const Mat<eT>& G, const Mat<eT>& Q, uword* j_mem, eT* w_mem, const uword method, const eT extrap_val)
+  {
+  arma_extra_debug_sigprint();
+  
+  const eT* G_mem = G.memptr();
+  const eT* Q_mem = Q.memptr();
+  
+  const uword NG = G.n_elem;
+  const uword NQ = Q.n_elem;
+  
+  const bool Q_ascending = Q.is_sorted();
+  
+  uword j     = 0;
+  bool  merge = false;
+  
+  for(uword i=0; i < NQ; ++i)
+    {
+    const eT q = Q_mem[i];
+    
+    if(arma_isnan(q))                          { j_mem[i] = NG; w_mem[i] = Datum<eT>::nan; continue; }
+    if((q < G_mem[0]) || (q > G_mem[NG-1]))  { j_mem[i] = NG; w_mem[i] = extrap_val;     continue; }
+    
+    j = interp1_find_interval(G_mem, NG, q, j, merge);
+    
+    merge = Q_ascending;
+    
+    const eT a_err = q          - G_mem[j];
+    const eT b_err = G_mem[j+1] - q;
+    
+    if(method == 1)
+      {
+      j_mem[i] = (a_err <= b_err) ? j : (j+1);
+      w_mem[i] = eT(0);
+      }
+    else
+      {
+      j_mem[i] = j;
+      w_mem[i] = a_err / (a_err + b_err);
+      }
+    }
+  }
+
+
+
+template<typename eT>
+inline
+void
+interp2_helper(const Mat<eT>& X, const Mat<eT>& Y, const Mat<eT>& Z, const Mat<eT>& XI, const Mat<eT>& YI, Mat<eT>& ZI, const uword method, const eT extrap_val)
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_debug_check( ((X.is_vec() == false) || (Y.is_vec() == false) || (XI.is_vec() == false) || (YI.is_vec() == false)), "interp2(): X, Y, XI and YI must be vectors" );
+  
+  arma_debug_check( ((X.n_elem != Z.n_cols) || (Y.n_elem != Z.n_rows)), "interp2(): size of Z must be Y.n_elem x X.n_elem" );
+  
+  arma_debug_check( ((X.n_elem < 2) || (Y.n_elem < 2)), "interp2(): X and Y must have at least two elements" );
+  
+  arma_debug_check( ((interp1_is_increasing(X) == false) || (interp1_is_increasing(Y) == false)), "interp2(): X and Y must be strictly increasing" );
+  
+  const uword NX = X.n_elem;
+  const uword NY = Y.n_elem;
+  
+  const uword n_cols = XI.n_elem;
+  const uword n_rows = YI.n_elem;
+  
+  podarray<uword> jx(n_cols);
+  podarray<eT>    wx(n_cols);
+  podarray<uword> jy(n_rows);
+  podarray<eT>    wy(n_rows);
+  
+  interp2_locate(X, XI, jx.memptr(), wx.memptr(), method, extrap_val);
+  interp2_locate(Y, YI, jy.memptr(), wy.memptr(), method, extrap_val);
+  
+  ZI.set_size(n_rows, n_cols);
+  
+  const uword* jx_mem = jx.memptr();
+  const eT*    wx_mem = wx.memptr();
+  const uword* jy_mem = jy.memptr();
+  const eT*    wy_mem = wy.memptr();
+  
+  #if defined(_OPENMP)
+    const bool use_mp = (ZI.n_elem >= 16384) && (n_cols > 1) && (omp_get_max_threads() > 1);
+  #endif
+  
+  #if defined(_OPENMP)
+    #pragma omp parallel for schedule(static) if(use_mp)
+  #endif
+  for(uword c=0; c < n_cols; ++c)
+    {
+    eT* ZI_colptr = ZI.colptr(c);
+    
+    const uword col = jx_mem[c];
+    const eT    u   = wx_mem[c];
+    
+    if(col == NX)  { arrayops::inplace_set(ZI_colptr, u, n_rows); continue; }
+    
+    const eT* Z_col_a = Z.colptr(col);
+    const eT* Z_col_b = (method == 1) ? Z_col_a : Z.colptr(col+1);
+    
+    for(uword r=0; r < n_rows; ++r)
+      {
+      const uword row = jy_mem[r];
+      const eT    v   = wy_mem[r];
+      
+      if(row == NY)  { ZI_colptr[r] = v; continue; }
+      
+      if(method == 1)
+        {
+        ZI_colptr[r] = Z_col_a[row];
+        }
+      else
+        {
+        const eT z_a = (eT(1) - v)*Z_col_a[row] + v*Z_col_a[row+1];
+        const eT z_b = (eT(1) - v)*Z_col_b[row] + v*Z_col_b[row+1];
+        
+        ZI_colptr[r] = (eT(1) - u)*z_a + u*z_b;
+        }
+      }
+    }
+  }
+
+
+
+//! 2D interpolation on the grid given by vectors X (locations of the columns of Z) and Y (locations of the rows of Z);
+//! ZI has YI.n_elem rows and XI.n_elem columns, with ZI(i,j) interpolated at location (XI(j), YI(i))
+template<typename T1, typename T2, typename T3, typename T4, typename T5>
+inline
+typename
+enable_if2
+  <
+  is_real<typename T1::elem_type>::value,
+  void
+  >::result
+interp2
+  (
+  const Base<typename T1::elem_type, T1>& X,
+  const Base<typename T1::elem_type, T2>& Y,
+  const Base<typename T1::elem_type, T3>& Z,
+  const Base<typename T1::elem_type, T4>& XI,
+  const Base<typename T1::elem_type, T5>& YI,
+         Mat<typename T1::elem_type>&     ZI,
+  const char*                             method     = "linear",
+  const typename T1::elem_type            extrap_val = Datum<typename T1::elem_type>::nan
+  )
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename T1::elem_type eT;
+  
+  uword sig = 0;
+  
+  if(method    != NULL   )
+  if(method[0] != char(0))
+    {
+    const char c1 = method[0];
+    
+         if(c1 == 'n')  { sig = 1; }  // nearest neighbour
+    else if(c1 == 'l')  { sig = 2; }  // linear
+    }
+  
+  arma_debug_check( (sig == 0), "interp2(): unsupported interpolation type" );
+  
+  const quasi_unwrap<T1>  X_tmp( X.get_ref());
+  const quasi_unwrap<T2>  Y_tmp( Y.get_ref());
+  const quasi_unwrap<T3>  Z_tmp( Z.get_ref());
+  const quasi_unwrap<T4> XI_tmp(XI.get_ref());
+  const quasi_unwrap<T5> YI_tmp(YI.get_ref());
+  
+  if( X_tmp.is_alias(ZI) || Y_tmp.is_alias(ZI) || Z_tmp.is_alias(ZI) || XI_tmp.is_alias(ZI) || YI_tmp.is_alias(ZI) )
+    {
+    Mat<eT> tmp;
+    
+    interp2_helper(X_tmp.M, Y_tmp.M, Z_tmp.M, XI_tmp.M, YI_tmp.M, tmp, sig, extrap_val);
+    
+    ZI.steal_mem(tmp);
+    }
+  else
+    {
+    interp2_helper(X_tmp.M, Y_tmp.M, Z_tmp.M, XI_tmp.M, YI_tmp.M, ZI, sig, extrap_val);
+    }
+  }
+
+
+
+//! @}
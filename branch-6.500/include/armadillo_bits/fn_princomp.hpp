@@ -152,6 +152,86 @@ princomp
 
 
 
+//! \brief
+//! principal component analysis -- truncated version;
+//! only the first k principal components are computed
+//! coeff_out    -> principal component coefficients
+//! score_out    -> projected samples
+//! latent_out   -> eigenvalues of principal vectors
+template<typename T1>
+inline
+bool
+princomp
+  (
+         Mat<typename T1::elem_type>&    coeff_out,
+         Mat<typename T1::elem_type>&    score_out,
+         Col<typename T1::pod_type>&     latent_out,
+  const Base<typename T1::elem_type,T1>& X,
+  const uword                            k,
+  const typename arma_blas_type_only<typename T1::elem_type>::result* junk = 0
+  )
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  const quasi_unwrap<T1> U(X.get_ref());
+  
+  const bool status = op_princomp::direct_princomp_trunc(coeff_out, score_out, latent_out, U.M, k);
+  
+  if(status == false)
+    {
+    coeff_out.reset();
+    score_out.reset();
+    latent_out.reset();
+    
+    arma_debug_warn("princomp(): decomposition failed");
+    }
+  
+  return status;
+  }
+
+
+
+//! \brief
+//! principal component analysis -- truncated version for sparse matrices;
+//! only the first k principal components are computed
+//! coeff_out    -> principal component coefficients
+//! score_out    -> projected samples
+//! latent_out   -> eigenvalues of principal vectors
+template<typename T1>
+inline
+bool
+princomp
+  (
+           Mat<typename T1::elem_type>&    coeff_out,
+           Mat<typename T1::elem_type>&    score_out,
+           Col<typename T1::pod_type>&     latent_out,
+  const SpBase<typename T1::elem_type,T1>& X,
+  const uword                              k,
+  const typename arma_blas_type_only<typename T1::elem_type>::result* junk = 0
+  )
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  const unwrap_spmat<T1> U(X.get_ref());
+  
+  const bool status = op_princomp::direct_princomp_trunc(coeff_out, score_out, latent_out, U.M, k);
+  
+  if(status == false)
+    {
+    coeff_out.reset();
+    score_out.reset();
+    latent_out.reset();
+    
+    arma_debug_warn("princomp(): decomposition failed");
+    }
+  
+  return status;
+  }
+
+
+
 template<typename T1>
 inline
 const Op<T1, op_princomp>
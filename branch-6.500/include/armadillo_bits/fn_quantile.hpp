@@ -0,0 +1,48 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup fn_quantile
+//! @{
+
+
+template<typename T1, typename T2>
+arma_inline
+typename
+enable_if2
+  <
+  (is_arma_type<T1>::value) && (is_arma_type<T2>::value) && (is_real<typename T1::elem_type>::value) && (is_same_type<typename T1::elem_type, typename T2::elem_type>::value),
+  const Glue<T1,T2,glue_quantile_default>
+  >::result
+quantile(const T1& X, const T2& P)
+  {
+  arma_extra_debug_sigprint();
+  
+  return Glue<T1,T2,glue_quantile_default>(X, P);
+  }
+
+
+
+template<typename T1, typename T2>
+arma_inline
+typename
+enable_if2
+  <
+  (is_arma_type<T1>::value) && (is_arma_type<T2>::value) && (is_real<typename T1::elem_type>::value) && (is_same_type<typename T1::elem_type, typename T2::elem_type>::value),
+  const Glue<T1,T2,glue_quantile>
+  >::result
+quantile(const T1& X, const T2& P, const uword dim)
+  {
+  arma_extra_debug_sigprint();
+  
+  return Glue<T1,T2,glue_quantile>(X, P, dim);
+  }
+
+
+//! @}
@@ -85,4 +85,61 @@ stddev(const T&)
 
 
 
+//! weighted standard deviation of each column of X, with one non-negative weight per row in vector W;
+//! the variance is normalised by the sum of the weights
+template<typename T1, typename T2>
+inline
+typename
+enable_if2
+  <
+  (is_arma_type<T1>::value) && (is_arma_type<T2>::value) && (is_real<typename T1::elem_type>::value) && (is_same_type<typename T1::elem_type, typename T2::elem_type>::value) && (resolves_to_vector<T1>::value == false),
+  const eOp< Glue<T1,T2,glue_var_weighted>, eop_sqrt >
+  >::result
+stddev(const T1& X, const T2& W)
+  {
+  arma_extra_debug_sigprint();
+  
+  return eOp< Glue<T1,T2,glue_var_weighted>, eop_sqrt >( Glue<T1,T2,glue_var_weighted>(X, W, 0) );
+  }
+
+
+
+//! weighted standard deviation of each column (dim = 0) or each row (dim = 1) of X, with one non-negative weight per observation in vector W;
+//! the variance is normalised by the sum of the weights
+template<typename T1, typename T2>
+inline
+typename
+enable_if2
+  <
+  (is_arma_type<T1>::value) && (is_arma_type<T2>::value) && (is_real<typename T1::elem_type>::value) && (is_same_type<typename T1::elem_type, typename T2::elem_type>::value),
+  const eOp< Glue<T1,T2,glue_var_weighted>, eop_sqrt >
+  >::result
+stddev(const T1& X, const T2& W, const uword dim)
+  {
+  arma_extra_debug_sigprint();
+  
+  return eOp< Glue<T1,T2,glue_var_weighted>, eop_sqrt >( Glue<T1,T2,glue_var_weighted>(X, W, dim) );
+  }
+
+
+
+//! weighted standard deviation of the elements of vector X, with one non-negative weight per element in vector W;
+//! the variance is normalised by the sum of the weights
+template<typename T1, typename T2>
+inline
+arma_warn_unused
+typename
+enable_if2
+  <
+  (is_arma_type<T1>::value) && (is_arma_type<T2>::value) && (is_real<typename T1::elem_type>::value) && (is_same_type<typename T1::elem_type, typename T2::elem_type>::value) && (resolves_to_vector<T1>::value == true),
+  typename T1::elem_type
+  >::result
+stddev(const T1& X, const T2& W)
+  {
+  arma_extra_debug_sigprint();
+  
+  return std::sqrt( glue_stats_weighted::var_vec(X, W) );
+  }
+
+
 //! @}
@@ -0,0 +1,68 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup fn_stft
+//! @{
+
+
+
+//! short-time Fourier transform of vector X with the given window (real vector of length L):
+//! column k of the result is the transform of length nfft (by default L) of the k-th windowed frame, which starts at sample k*hop
+template<typename T1, typename T2>
+inline
+typename
+enable_if2
+  <
+  (is_arma_type<T1>::value && is_arma_type<T2>::value && is_real<typename T2::elem_type>::value && is_same_type<typename T1::pod_type, typename T2::elem_type>::value),
+  Mat< std::complex<typename T1::pod_type> >
+  >::result
+stft(const T1& X, const T2& window, const uword hop, const uword nfft = 0)
+  {
+  arma_extra_debug_sigprint();
+  
+  const quasi_unwrap<T1> UX(X);
+  const quasi_unwrap<T2> UW(window);
+  
+  Mat< std::complex<typename T1::pod_type> > out;
+  
+  op_stft::apply(out, UX.M, UW.M, hop, nfft);
+  
+  return out;
+  }
+
+
+
+//! inverse short-time Fourier transform of spectrogram S, using weighted overlap-add with the window and hop given to stft();
+//! the result has N elements, or covers all frames if N is zero
+template<typename T1, typename T2>
+inline
+typename
+enable_if2
+  <
+  (is_arma_type<T1>::value && is_arma_type<T2>::value && is_complex_strict<typename T1::elem_type>::value && is_same_type<typename T1::pod_type, typename T2::elem_type>::value),
+  Col<typename T1::elem_type>
+  >::result
+istft(const T1& S, const T2& window, const uword hop, const uword N = 0)
+  {
+  arma_extra_debug_sigprint();
+  
+  const quasi_unwrap<T1> US(S);
+  const quasi_unwrap<T2> UW(window);
+  
+  Col<typename T1::elem_type> out;
+  
+  op_istft::apply(out, US.M, UW.M, hop, N);
+  
+  return out;
+  }
+
+
+
+//! @}
@@ -14,13 +14,43 @@
 
 
 
+//! the aux_uword of conv() and conv2() expressions holds the shape (0 = full, 1 = same, 2 = valid)
+//! and the method (0 = automatic, 1 = direct, 2 = FFT based), as shape + 4*method
+struct glue_conv_mode
+  {
+  static const uword full   = 0;
+  static const uword same   = 1;
+  static const uword valid  = 2;
+  
+  static const uword method_auto   = 0;
+  static const uword method_direct = 1;
+  static const uword method_fft    = 2;
+  };
+
+
+
 class glue_conv
   {
   public:
-
+  
   template<typename eT> inline static void apply(Mat<eT>& out, const Mat<eT>& A, const Mat<eT>& B, const bool A_is_col);
   
+  template<typename eT> inline static void apply(Mat<eT>& out, const Mat<eT>& A, const Mat<eT>& B, const bool A_is_col, const uword mode);
+  
   template<typename T1, typename T2> inline static void apply(Mat<typename T1::elem_type>& out, const Glue<T1,T2,glue_conv>& X);
+  
+  template<typename eT> inline static bool use_fft(const uword h_n, const uword x_n);
+  
+  template<typename eT> inline static uword fft_length(const uword h_n, const uword x_n);
+  
+  inline static double fft_cost(const uword L, const double n_blocks);
+  
+  template<typename eT> inline static void apply_direct(eT* out_mem, const Mat<eT>& h, const Mat<eT>& x, const uword out_start, const uword out_n);
+  
+  template<typename eT> inline static void apply_fft(eT* out_mem, const Mat<eT>& h, const Mat<eT>& x, const uword out_start, const uword out_n, const typename arma_blas_type_only<eT>::result* junk = 0);
+  template<typename eT> inline static void apply_fft(eT* out_mem, const Mat<eT>& h, const Mat<eT>& x, const uword out_start, const uword out_n, const typename arma_not_blas_type<eT>::result*  junk = 0);
+  
+  template<typename engine_type, typename eT> inline static void apply_fft_worker(eT* out_mem, const engine_type& engine, const typename engine_type::cx_type* H_mem, const Mat<eT>& x, const uword h_n, const uword out_start, const uword out_n, const uword block_start, const uword block_end);
   };
 
 
@@ -31,7 +61,35 @@ class glue_conv2
   
   template<typename eT> inline static void apply(Mat<eT>& out, const Mat<eT>& A, const Mat<eT>& B);
   
+  template<typename eT> inline static void apply(Mat<eT>& out, const Mat<eT>& A, const Mat<eT>& B, const uword mode);
+  
   template<typename T1, typename T2> inline static void apply(Mat<typename T1::elem_type>& out, const Glue<T1,T2,glue_conv2>& expr);
+  
+  template<typename eT> inline static void apply(Mat<eT>& out, const Col<eT>& u, const Row<eT>& v, const Mat<eT>& W, const uword mode);
+  
+  template<typename eT> inline static void apply(Cube<eT>& out, const Cube<eT>& Q, const Mat<eT>& K, const uword mode);
+  
+  inline static void out_region(uword& out_row, uword& out_col, uword& out_n_rows, uword& out_n_cols, const uword A_n_rows, const uword A_n_cols, const uword B_n_rows, const uword B_n_cols, const uword shape);
+  
+  template<typename eT> inline static double fft_cost(const Mat<eT>& G, const Mat<eT>& W);
+  
+  template<typename eT> inline static bool use_fft(const Mat<eT>& G, const Mat<eT>& W);
+  
+  template<typename eT> inline static bool is_separable(Col<eT>& u, Row<eT>& v, const Mat<eT>& G, const typename arma_blas_type_only<eT>::result* junk = 0);
+  template<typename eT> inline static bool is_separable(Col<eT>& u, Row<eT>& v, const Mat<eT>& G, const typename arma_not_blas_type<eT>::result*  junk = 0);
+  
+  template<typename eT> inline static void apply_direct(Mat<eT>& out, const Mat<eT>& G, const Mat<eT>& W, const uword out_row, const uword out_col);
+  
+  template<typename eT> inline static void apply_separable(Mat<eT>& out, const Col<eT>& u, const Row<eT>& v, const Mat<eT>& W, const uword out_row, const uword out_col);
+  
+  template<typename eT> inline static void apply_fft(Mat<eT>& out, const Mat<eT>& G, const Mat<eT>& W, const uword out_row, const uword out_col, const typename arma_blas_type_only<eT>::result* junk = 0);
+  template<typename eT> inline static void apply_fft(Mat<eT>& out, const Mat<eT>& G, const Mat<eT>& W, const uword out_row, const uword out_col, const typename arma_not_blas_type<eT>::result*  junk = 0);
+  
+  template<typename T> inline static void fft2_fwd(Mat< std::complex<T> >& out, const Mat<T>&                X);
+  template<typename T> inline static void fft2_fwd(Mat< std::complex<T> >& out, const Mat< std::complex<T> >& X);
+  
+  template<typename T> inline static void fft2_inv(Mat<T>&                out, const Mat< std::complex<T> >& X, const uword n_rows, const uword n_cols);
+  template<typename T> inline static void fft2_inv(Mat< std::complex<T> >& out, const Mat< std::complex<T> >& X, const uword n_rows, const uword n_cols);
   };
 
 
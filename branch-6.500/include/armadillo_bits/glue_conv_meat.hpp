@@ -13,6 +13,7 @@
 
 
 
+//! full convolution, with automatic choice of the method
 template<typename eT>
 inline
 void
@@ -20,45 +21,64 @@ glue_conv::apply(Mat<eT>& out, const Mat<eT>& A, const Mat<eT>& B, const bool A_
   {
   arma_extra_debug_sigprint();
   
-  const Mat<eT>& h = (A.n_elem <= B.n_elem) ? A : B;
-  const Mat<eT>& x = (A.n_elem <= B.n_elem) ? B : A;
-  
-  const uword   h_n_elem    = h.n_elem;
-  const uword   h_n_elem_m1 = h_n_elem - 1;
-  const uword   x_n_elem    = x.n_elem;
-  const uword out_n_elem    = ((h_n_elem + x_n_elem) > 0) ? (h_n_elem + x_n_elem - 1) : uword(0);
-  
-  (A_is_col) ? out.set_size(out_n_elem, 1) : out.set_size(1, out_n_elem);
+  glue_conv::apply(out, A, B, A_is_col, glue_conv_mode::full);
+  }
+
+
+
+template<typename eT>
+inline
+void
+glue_conv::apply(Mat<eT>& out, const Mat<eT>& A, const Mat<eT>& B, const bool A_is_col, const uword mode)
+  {
+  arma_extra_debug_sigprint();
   
-  if( (h_n_elem == 0) || (x_n_elem == 0) )  { out.zeros(); return; }
+  const uword shape  = mode % 4;
+  const uword method = mode / 4;
   
+  const uword A_n = A.n_elem;
+  const uword B_n = B.n_elem;
   
-  Col<eT> hh(h_n_elem);  // flipped version of h
+  // the output is the part of the full convolution (of length A_n + B_n - 1) starting at out_start
   
-  const eT*   h_mem =  h.memptr();
-        eT*  hh_mem = hh.memptr();
+  uword out_start = 0;
+  uword out_n     = 0;
   
-  for(uword i=0; i < h_n_elem; ++i)
+  if(shape == glue_conv_mode::full)
     {
-    hh_mem[h_n_elem_m1-i] = h_mem[i];
+    out_n = ((A_n + B_n) > 0) ? (A_n + B_n - 1) : uword(0);
+    }
+  else
+  if(shape == glue_conv_mode::same)
+    {
+    out_start = B_n / 2;
+    out_n     = A_n;
+    }
+  else
+  if(shape == glue_conv_mode::valid)
+    {
+    out_start = (B_n > 0) ? (B_n - 1) : uword(0);
+    out_n     = (B_n == 0) ? A_n : ( (A_n >= B_n) ? (A_n - B_n + 1) : uword(0) );
     }
   
+  (A_is_col) ? out.set_size(out_n, 1) : out.set_size(1, out_n);
   
-  Col<eT> xx( (x_n_elem + 2*h_n_elem_m1), fill::zeros );  // zero padded version of x
-  
-  const eT*  x_mem =  x.memptr();
-        eT* xx_mem = xx.memptr();
+  if( (A_n == 0) || (B_n == 0) || (out_n == 0) )  { out.zeros(); return; }
   
-  arrayops::copy( &(xx_mem[h_n_elem_m1]), x_mem, x_n_elem );
+  const Mat<eT>& h = (A_n <= B_n) ? A : B;
+  const Mat<eT>& x = (A_n <= B_n) ? B : A;
   
+  const bool do_fft = (method == glue_conv_mode::method_fft   ) ? true
+                    : (method == glue_conv_mode::method_direct) ? false
+                    : glue_conv::use_fft<eT>(h.n_elem, x.n_elem);
   
-  eT* out_mem = out.memptr();
-        
-  for(uword i=0; i < out_n_elem; ++i)
+  if(do_fft)
     {
-    // out_mem[i] = dot( hh, xx.subvec(i, (i + h_n_elem_m1)) );
-    
-    out_mem[i] = op_dot::direct_dot( h_n_elem, hh_mem, &(xx_mem[i]) );
+    glue_conv::apply_fft(out.memptr(), h, x, out_start, out_n);
+    }
+  else
+    {
+    glue_conv::apply_direct(out.memptr(), h, x, out_start, out_n);
     }
   }
 
@@ -85,32 +105,255 @@ glue_conv::apply(Mat<typename T1::elem_type>& out, const Glue<T1,T2,glue_conv>&
     "conv(): given object is not a vector"
     );
   
-  const bool A_is_col = ((T1::is_col) || (A.n_cols == 1));
-  
-  const uword mode = expr.aux_uword;
+  const bool A_is_col = (T1::is_row == false) && ((T1::is_col) || (A.n_cols == 1));
   
-  if(mode == 0)  // full convolution
+  if(UA.is_alias(out) || UB.is_alias(out))
     {
-    glue_conv::apply(out, A, B, A_is_col);
+    Mat<eT> tmp;
+    
+    glue_conv::apply(tmp, A, B, A_is_col, expr.aux_uword);
+    
+    out.steal_mem(tmp);
     }
   else
-  if(mode == 1)  // same size as A
     {
-    Mat<eT> tmp;
+    glue_conv::apply(out, A, B, A_is_col, expr.aux_uword);
+    }
+  }
+
+
+
+//! estimate whether the FFT based method is faster than the direct method,
+//! for a filter of length h_n and a signal of length x_n (with h_n <= x_n)
+template<typename eT>
+inline
+bool
+glue_conv::use_fft(const uword h_n, const uword x_n)
+  {
+  if( (is_supported_blas_type<eT>::value == false) || (h_n < 64) )  { return false; }
+  
+  const uword L = glue_conv::fft_length<eT>(h_n, x_n);
+  
+  const double n_blocks = std::ceil( double(x_n + h_n - 1) / double(L - h_n + 1) );
+  
+  // cost of the direct method: one multiply-add per filter coefficient per output
+  
+  const double direct_cost = double(h_n) * double(x_n + h_n - 1);
+  
+  return (glue_conv::fft_cost(L, n_blocks) < direct_cost);
+  }
+
+
+
+//! estimated cost of overlap-save convolution with n_blocks blocks of length L:
+//! per block, a forward and an inverse transform plus the spectral product,
+//! expressed in multiply-adds via a weight that was measured on x86-64 machines
+inline
+double
+glue_conv::fft_cost(const uword L, const double n_blocks)
+  {
+  return 10.0 * n_blocks * double(L) * ( std::log(double(L)) / std::log(2.0) + 1.0 );
+  }
+
+
+
+//! length of the transforms for overlap-save convolution of a signal of length x_n with a filter of length h_n:
+//! either a single block covering the entire output, or the power of 2 with the lowest estimated cost
+template<typename eT>
+inline
+uword
+glue_conv::fft_length(const uword h_n, const uword x_n)
+  {
+  const uword out_n = x_n + h_n - 1;
+  
+  uword  best_L    = fft_engine_pair<eT>::fast_length(out_n);
+  double best_cost = double(best_L) * ( std::log(double(best_L)) / std::log(2.0) + 1.0 );
+  
+  uword L = 2;
+  
+  while(L < 2*h_n)  { L *= 2; }
+  
+  for(; L < best_L; L *= 2)
+    {
+    const double n_blocks = std::ceil( double(out_n) / double(L - h_n + 1) );
+    
+    const double cost = n_blocks * double(L) * ( std::log(double(L)) / std::log(2.0) + 1.0 );
+    
+    if(cost < best_cost)  { best_L = L; best_cost = cost; }
+    }
+  
+  return best_L;
+  }
+
+
+
+//! elements out_start to (out_start + out_n - 1) of the full convolution of h and x, computed directly
+template<typename eT>
+inline
+void
+glue_conv::apply_direct(eT* out_mem, const Mat<eT>& h, const Mat<eT>& x, const uword out_start, const uword out_n)
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword h_n_elem    = h.n_elem;
+  const uword h_n_elem_m1 = h_n_elem - 1;
+  const uword x_n_elem    = x.n_elem;
+  
+  Col<eT> hh(h_n_elem);  // flipped version of h
+  
+  const eT*   h_mem =  h.memptr();
+        eT*  hh_mem = hh.memptr();
+  
+  for(uword i=0; i < h_n_elem; ++i)
+    {
+    hh_mem[h_n_elem_m1-i] = h_mem[i];
+    }
+  
+  
+  Col<eT> xx( (x_n_elem + 2*h_n_elem_m1), fill::zeros );  // zero padded version of x
+  
+  const eT*  x_mem =  x.memptr();
+        eT* xx_mem = xx.memptr();
+  
+  arrayops::copy( &(xx_mem[h_n_elem_m1]), x_mem, x_n_elem );
+  
+  
+  for(uword i=0; i < out_n; ++i)
+    {
+    // out_mem[i] = dot( hh, xx.subvec(out_start+i, (out_start + i + h_n_elem_m1)) );
     
-    glue_conv::apply(tmp, A, B, A_is_col);
+    out_mem[i] = op_dot::direct_dot( h_n_elem, hh_mem, &(xx_mem[out_start + i]) );
+    }
+  }
+
+
+
+//! elements out_start to (out_start + out_n - 1) of the full convolution of h and x, computed via the overlap-save method:
+//! each block of L - h_n + 1 outputs is obtained from the product of the spectra of h and of a segment of x of length L.
+//! if OpenMP is enabled, the blocks are split between threads
+template<typename eT>
+inline
+void
+glue_conv::apply_fft(eT* out_mem, const Mat<eT>& h, const Mat<eT>& x, const uword out_start, const uword out_n, const typename arma_blas_type_only<eT>::result* junk)
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  typedef typename get_pod_type<eT>::result T;
+  typedef std::complex<T>                   cx_type;
+  
+  const uword h_n = h.n_elem;
+  const uword L   = glue_conv::fft_length<eT>(h_n, x.n_elem);
+  
+  const fft_engine_pair<eT> engine(L);
+  
+  // spectrum of h, including the scaling of the inverse transform
+  
+  podarray<cx_type> H( engine.n_spec );
+  podarray<eT>      h_pad( L );
+  podarray<T>       work( engine.n_work() );
+  
+  arrayops::copy( h_pad.memptr(), h.memptr(), h_n );
+  arrayops::fill_zeros( h_pad.memptr() + h_n, L - h_n );
+  
+  engine.forward( H.memptr(), h_pad.memptr(), work.memptr() );
+  
+  arrayops::inplace_mul( H.memptr(), cx_type( T(1) / T(L) ), engine.n_spec );
+  
+  const uword S        = L - h_n + 1;
+  const uword n_blocks = (out_n + S - 1) / S;
+  
+  #if defined(_OPENMP)
+    {
+    const uword n_threads_max = uword( (std::max)(int(1), int(omp_get_max_threads())) );
+    const uword n_threads     = (out_n >= 16384) ? (std::min)(n_blocks, n_threads_max) : uword(1);
     
-    if( (tmp.is_empty() == false) && (A.is_empty() == false) && (B.is_empty() == false) )
+    if(n_threads > 1)
       {
-      const uword start = uword( std::floor( double(B.n_elem) / double(2) ) );
+      #pragma omp parallel for schedule(static)
+      for(uword t=0; t < n_threads; ++t)
+        {
+        const uword block_start = (t     * n_blocks) / n_threads;
+        const uword block_end   = ((t+1) * n_blocks) / n_threads;
+        
+        glue_conv::apply_fft_worker(out_mem, engine, H.memptr(), x, h_n, out_start, out_n, block_start, block_end);
+        }
       
-      out = (A_is_col) ? tmp(start, 0, size(A)) : tmp(0, start, size(A));
-      }
-    else
-      {
-      out.zeros( size(A) );
+      return;
       }
     }
+  #endif
+  
+  glue_conv::apply_fft_worker(out_mem, engine, H.memptr(), x, h_n, out_start, out_n, 0, n_blocks);
+  }
+
+
+
+//! the FFT based method is not available for integer elements
+template<typename eT>
+inline
+void
+glue_conv::apply_fft(eT* out_mem, const Mat<eT>& h, const Mat<eT>& x, const uword out_start, const uword out_n, const typename arma_not_blas_type<eT>::result* junk)
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  glue_conv::apply_direct(out_mem, h, x, out_start, out_n);
+  }
+
+
+
+template<typename engine_type, typename eT>
+inline
+void
+glue_conv::apply_fft_worker(eT* out_mem, const engine_type& engine, const typename engine_type::cx_type* H_mem, const Mat<eT>& x, const uword h_n, const uword out_start, const uword out_n, const uword block_start, const uword block_end)
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename engine_type::T       T;
+  typedef typename engine_type::cx_type cx_type;
+  
+  const uword L      = engine.N;
+  const uword n_spec = engine.n_spec;
+  const uword S      = L - h_n + 1;
+  
+  const eT*   x_mem = x.memptr();
+  const uword x_n   = x.n_elem;
+  
+  podarray<eT>      seg ( L );
+  podarray<eT>      y   ( L );
+  podarray<cx_type> Z   ( n_spec );
+  podarray<T>       work( engine.n_work() );
+  
+  eT*      seg_mem = seg.memptr();
+  cx_type*   Z_mem =   Z.memptr();
+  
+  for(uword b=block_start; b < block_end; ++b)
+    {
+    // element i of the full convolution needs x[i - h_n + 1] to x[i], with x taken as zero outside of its range;
+    // the segment for outputs i0 to (i0 + S - 1) hence holds x[i0 - h_n + 1] to x[i0 - h_n + L]
+    
+    const uword i0 = out_start + b*S;
+    
+    const uword n_lead  = (i0 < h_n - 1) ? (h_n - 1 - i0) : uword(0);
+    const uword x_start = i0 + n_lead - (h_n - 1);
+    const uword n_copy  = (x_start < x_n) ? (std::min)(L - n_lead, x_n - x_start) : uword(0);
+    
+    arrayops::fill_zeros(seg_mem, n_lead);
+    arrayops::copy( &(seg_mem[n_lead]), &(x_mem[x_start]), n_copy );
+    arrayops::fill_zeros( &(seg_mem[n_lead + n_copy]), L - n_lead - n_copy );
+    
+    engine.forward(Z_mem, seg_mem, work.memptr());
+    
+    for(uword k=0; k < n_spec; ++k)  { Z_mem[k] *= H_mem[k]; }
+    
+    engine.inverse(y.memptr(), Z_mem, work.memptr());
+    
+    // the first h_n - 1 values are corrupted by circular wrap-around
+    const uword n_out = (std::min)(S, out_n - b*S);
+    
+    arrayops::copy( &(out_mem[b*S]), &(y.memptr()[h_n - 1]), n_out );
+    }
   }
 
 
@@ -126,15 +369,321 @@ glue_conv2::apply(Mat<eT>& out, const Mat<eT>& A, const Mat<eT>& B)
   {
   arma_extra_debug_sigprint();
   
+  glue_conv2::apply(out, A, B, glue_conv_mode::full);
+  }
+
+
+
+template<typename eT>
+inline
+void
+glue_conv2::apply(Mat<eT>& out, const Mat<eT>& A, const Mat<eT>& B, const uword mode)
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword shape  = mode % 4;
+  const uword method = mode / 4;
+  
+  // the output is the part of the full convolution starting at (out_row, out_col)
+  
+  uword out_row    = 0;
+  uword out_col    = 0;
+  uword out_n_rows = 0;
+  uword out_n_cols = 0;
+  
+  glue_conv2::out_region(out_row, out_col, out_n_rows, out_n_cols, A.n_rows, A.n_cols, B.n_rows, B.n_cols, shape);
+  
+  out.set_size(out_n_rows, out_n_cols);
+  
+  if(A.is_empty() || B.is_empty() || out.is_empty())  { out.zeros(); return; }
+  
   const Mat<eT>& G = (A.n_elem <= B.n_elem) ? A : B;   // unflipped filter coefficients
   const Mat<eT>& W = (A.n_elem <= B.n_elem) ? B : A;   // original 2D image
   
-  const uword out_n_rows = ((W.n_rows + G.n_rows) > 0) ? (W.n_rows + G.n_rows - 1) : uword(0);
-  const uword out_n_cols = ((W.n_cols + G.n_cols) > 0) ? (W.n_cols + G.n_cols - 1) : uword(0);
+  // a filter of rank 1 is the outer product of a column and a row, and is applied as two 1D convolutions
+  
+  Col<eT> u;
+  Row<eT> v;
+  
+  const bool do_separable = (method != glue_conv_mode::method_fft) && glue_conv2::is_separable(u, v, G);
+  
+  if(do_separable)
+    {
+    const double separable_cost = double(G.n_rows) * double(out_n_rows) * double(W.n_cols) + double(G.n_cols) * double(out.n_elem);
+    
+    if( (method == glue_conv_mode::method_direct) || (separable_cost <= glue_conv2::fft_cost(G, W)) )
+      {
+      glue_conv2::apply_separable(out, u, v, W, out_row, out_col);
+      
+      return;
+      }
+    }
+  
+  const bool do_fft = (method == glue_conv_mode::method_fft   ) ? true
+                    : (method == glue_conv_mode::method_direct) ? false
+                    : glue_conv2::use_fft(G, W);
   
-  out.set_size( out_n_rows, out_n_cols );
+  if(do_fft)
+    {
+    glue_conv2::apply_fft(out, G, W, out_row, out_col);
+    }
+  else
+    {
+    glue_conv2::apply_direct(out, G, W, out_row, out_col);
+    }
+  }
+
+
+
+template<typename T1, typename T2>
+inline
+void
+glue_conv2::apply(Mat<typename T1::elem_type>& out, const Glue<T1,T2,glue_conv2>& expr)
+  {
+  arma_extra_debug_sigprint();
   
-  if(G.is_empty() || W.is_empty())  { out.zeros(); return; }
+  typedef typename T1::elem_type eT;
+  
+  const quasi_unwrap<T1> UA(expr.A);
+  const quasi_unwrap<T2> UB(expr.B);
+  
+  const Mat<eT>& A = UA.M;
+  const Mat<eT>& B = UB.M;
+  
+  if(UA.is_alias(out) || UB.is_alias(out))
+    {
+    Mat<eT> tmp;
+    
+    glue_conv2::apply(tmp, A, B, expr.aux_uword);
+    
+    out.steal_mem(tmp);
+    }
+  else
+    {
+    glue_conv2::apply(out, A, B, expr.aux_uword);
+    }
+  }
+
+
+
+//! convolution of W with the separable filter u*v, ie. the columns of W are convolved with u and the rows of the result with v
+template<typename eT>
+inline
+void
+glue_conv2::apply(Mat<eT>& out, const Col<eT>& u, const Row<eT>& v, const Mat<eT>& W, const uword mode)
+  {
+  arma_extra_debug_sigprint();
+  
+  uword out_row    = 0;
+  uword out_col    = 0;
+  uword out_n_rows = 0;
+  uword out_n_cols = 0;
+  
+  glue_conv2::out_region(out_row, out_col, out_n_rows, out_n_cols, W.n_rows, W.n_cols, u.n_elem, v.n_elem, mode % 4);
+  
+  out.set_size(out_n_rows, out_n_cols);
+  
+  if(u.is_empty() || v.is_empty() || W.is_empty() || out.is_empty())  { out.zeros(); return; }
+  
+  glue_conv2::apply_separable(out, u, v, W, out_row, out_col);
+  }
+
+
+
+//! convolution of each slice of Q with K; if OpenMP is enabled, the slices are split between threads
+template<typename eT>
+inline
+void
+glue_conv2::apply(Cube<eT>& out, const Cube<eT>& Q, const Mat<eT>& K, const uword mode)
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword n_slices = Q.n_slices;
+  
+  uword out_row    = 0;
+  uword out_col    = 0;
+  uword out_n_rows = 0;
+  uword out_n_cols = 0;
+  
+  glue_conv2::out_region(out_row, out_col, out_n_rows, out_n_cols, Q.n_rows, Q.n_cols, K.n_rows, K.n_cols, mode % 4);
+  
+  out.set_size(out_n_rows, out_n_cols, n_slices);
+  
+  if(out.is_empty())  { return; }
+  
+  #if defined(_OPENMP)
+    const bool use_mp = (n_slices > 1) && (Q.n_elem >= 16384) && (omp_get_max_threads() > 1);
+  #endif
+  
+  #if defined(_OPENMP)
+    #pragma omp parallel for schedule(dynamic) if(use_mp)
+  #endif
+  for(uword s=0; s < n_slices; ++s)
+    {
+    const Mat<eT> Q_slice(const_cast<eT*>(Q.slice_memptr(s)), Q.n_rows, Q.n_cols, false, true);
+          Mat<eT> out_slice(out.slice_memptr(s), out_n_rows, out_n_cols, false, true);
+    
+    glue_conv2::apply(out_slice, Q_slice, K, mode);
+    }
+  }
+
+
+
+//! location and size of the part of the full convolution of A and B given by shape
+inline
+void
+glue_conv2::out_region(uword& out_row, uword& out_col, uword& out_n_rows, uword& out_n_cols, const uword A_n_rows, const uword A_n_cols, const uword B_n_rows, const uword B_n_cols, const uword shape)
+  {
+  out_row    = 0;
+  out_col    = 0;
+  out_n_rows = 0;
+  out_n_cols = 0;
+  
+  const bool B_is_empty = (B_n_rows == 0) || (B_n_cols == 0);
+  
+  if(shape == glue_conv_mode::full)
+    {
+    out_n_rows = ((A_n_rows + B_n_rows) > 0) ? (A_n_rows + B_n_rows - 1) : uword(0);
+    out_n_cols = ((A_n_cols + B_n_cols) > 0) ? (A_n_cols + B_n_cols - 1) : uword(0);
+    }
+  else
+  if(shape == glue_conv_mode::same)
+    {
+    out_row    = B_n_rows / 2;
+    out_col    = B_n_cols / 2;
+    out_n_rows = A_n_rows;
+    out_n_cols = A_n_cols;
+    }
+  else
+  if(shape == glue_conv_mode::valid)
+    {
+    out_row    = (B_n_rows > 0) ? (B_n_rows - 1) : uword(0);
+    out_col    = (B_n_cols > 0) ? (B_n_cols - 1) : uword(0);
+    out_n_rows = (B_is_empty) ? A_n_rows : ( (A_n_rows >= B_n_rows) ? (A_n_rows - B_n_rows + 1) : uword(0) );
+    out_n_cols = (B_is_empty) ? A_n_cols : ( (A_n_cols >= B_n_cols) ? (A_n_cols - B_n_cols + 1) : uword(0) );
+    }
+  }
+
+
+
+//! estimate whether the FFT based method is faster than the direct method, for filter G and image W (with G.n_elem <= W.n_elem);
+//! the FFT based method transforms the zero padded filter and image, and inverse transforms their product
+template<typename eT>
+inline
+bool
+glue_conv2::use_fft(const Mat<eT>& G, const Mat<eT>& W)
+  {
+  if( (is_supported_blas_type<eT>::value == false) || (G.n_elem < 64) )  { return false; }
+  
+  const double direct_cost = double(G.n_elem) * double(W.n_rows + G.n_rows - 1) * double(W.n_cols + G.n_cols - 1);
+  
+  return (glue_conv2::fft_cost(G, W) < direct_cost);
+  }
+
+
+
+//! as per glue_conv::use_fft(), with three 2D transforms of size R x C
+template<typename eT>
+inline
+double
+glue_conv2::fft_cost(const Mat<eT>& G, const Mat<eT>& W)
+  {
+  if(is_supported_blas_type<eT>::value == false)  { return Datum<double>::inf; }
+  
+  const double R = double( fft_engine_pair<eT>::fast_length(W.n_rows + G.n_rows - 1) );
+  const double C = double( fft_engine_pair<eT>::fast_length(W.n_cols + G.n_cols - 1) );
+  
+  return 3.0 * 2.0 * R * C * ( std::log(R*C) / std::log(2.0) + 1.0 );
+  }
+
+
+
+//! check whether G is the outer product u*v of a column and a row, to within rounding errors:
+//! with G(p,q) the element with the largest magnitude, u = G.col(q) and v = G.row(p) / G(p,q)
+template<typename eT>
+inline
+bool
+glue_conv2::is_separable(Col<eT>& u, Row<eT>& v, const Mat<eT>& G, const typename arma_blas_type_only<eT>::result* junk)
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  typedef typename get_pod_type<eT>::result T;
+  
+  const uword G_n_rows = G.n_rows;
+  const uword G_n_cols = G.n_cols;
+  
+  if( (G_n_rows < 2) || (G_n_cols < 2) )  { return false; }
+  
+  const eT*   G_mem = G.memptr();
+  const uword N     = G.n_elem;
+  
+  uword p_index = 0;
+  T     p_abs   = T(0);
+  
+  for(uword i=0; i < N; ++i)
+    {
+    const T val = std::abs(G_mem[i]);
+    
+    if(arma_isnan(val))  { return false; }
+    
+    if(val > p_abs)  { p_abs = val; p_index = i; }
+    }
+  
+  if(p_abs == T(0))  { return false; }
+  
+  const uword p = p_index % G_n_rows;
+  const uword q = p_index / G_n_rows;
+  
+  const eT G_pq = G_mem[p_index];
+  
+  u = G.col(q);
+  v = G.row(p) / G_pq;
+  
+  const T tol = T(16) * std::numeric_limits<T>::epsilon() * p_abs;
+  
+  const eT* u_mem = u.memptr();
+  
+  for(uword col=0; col < G_n_cols; ++col)
+    {
+    const eT* G_colptr = G.colptr(col);
+    const eT  v_val    = v[col];
+    
+    for(uword row=0; row < G_n_rows; ++row)
+      {
+      if( std::abs(G_colptr[row] - u_mem[row]*v_val) > tol )  { return false; }
+      }
+    }
+  
+  return true;
+  }
+
+
+
+//! separable filters of integer elements are not detected, as the division is inexact
+template<typename eT>
+inline
+bool
+glue_conv2::is_separable(Col<eT>& u, Row<eT>& v, const Mat<eT>& G, const typename arma_not_blas_type<eT>::result* junk)
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(u);
+  arma_ignore(v);
+  arma_ignore(G);
+  arma_ignore(junk);
+  
+  return false;
+  }
+
+
+
+//! the part of the full convolution of G and W starting at (out_row, out_col), computed directly; out must have the required size
+template<typename eT>
+inline
+void
+glue_conv2::apply_direct(Mat<eT>& out, const Mat<eT>& G, const Mat<eT>& W, const uword out_row, const uword out_col)
+  {
+  arma_extra_debug_sigprint();
   
   Mat<eT> H(G.n_rows, G.n_cols);  // flipped filter coefficients
   
@@ -159,72 +708,221 @@ glue_conv2::apply(Mat<eT>& out, const Mat<eT>& A, const Mat<eT>& B)
   
   X( H_n_rows_m1, H_n_cols_m1, size(W) ) = W;  // zero padded version of 2D image
   
+  const uword out_n_rows = out.n_rows;
+  const uword out_n_cols = out.n_cols;
+  
+  // each column of the output is accumulated from scaled columns of X, so that the innermost loop is long and contiguous;
+  // if OpenMP is enabled, the columns of the output are split between threads
+  
+  #if defined(_OPENMP)
+    const bool use_mp = (out_n_cols > 1) && (double(out.n_elem) * double(H.n_elem) >= 1e6) && (omp_get_max_threads() > 1);
+  #endif
+  
+  #if defined(_OPENMP)
+    #pragma omp parallel for schedule(static) if(use_mp)
+  #endif
   for(uword col=0; col < out_n_cols; ++col)
     {
     eT* out_colptr = out.colptr(col);
     
-    for(uword row=0; row < out_n_rows; ++row)
+    arrayops::fill_zeros(out_colptr, out_n_rows);
+    
+    for(uword H_col = 0; H_col < H_n_cols; ++H_col)
       {
-      // out.at(row, col) = accu( H % X(row, col, size(H)) );
-      
-      eT acc = eT(0);
+      const eT* H_colptr = H.colptr(H_col);
+      const eT* X_colptr = X.colptr(out_col + col + H_col) + out_row;
       
-      for(uword H_col = 0; H_col < H_n_cols; ++H_col)
+      for(uword H_row = 0; H_row < H_n_rows; ++H_row)
         {
-        const eT* X_colptr = X.colptr(col + H_col);
+        const eT  H_val = H_colptr[H_row];
+        const eT* X_mem = &(X_colptr[H_row]);
         
-        acc += op_dot::direct_dot( H_n_rows, H.colptr(H_col), &(X_colptr[row]) );
+        for(uword row=0; row < out_n_rows; ++row)  { out_colptr[row] += H_val * X_mem[row]; }
         }
-      
-      out_colptr[row] = acc;
       }
     }
   }
 
 
 
-template<typename T1, typename T2>
+//! the part of the full convolution of W with the separable filter u*v starting at (out_row, out_col); out must have the required size.
+//! the columns of W are first convolved with u, keeping only the required rows, and then the rows of the result are convolved with v
+template<typename eT>
 inline
 void
-glue_conv2::apply(Mat<typename T1::elem_type>& out, const Glue<T1,T2,glue_conv2>& expr)
+glue_conv2::apply_separable(Mat<eT>& out, const Col<eT>& u, const Row<eT>& v, const Mat<eT>& W, const uword out_row, const uword out_col)
   {
   arma_extra_debug_sigprint();
   
-  typedef typename T1::elem_type eT;
+  const uword u_n = u.n_elem;
+  const uword v_n = v.n_elem;
   
-  const quasi_unwrap<T1> UA(expr.A);
-  const quasi_unwrap<T2> UB(expr.B);
+  const uword W_n_rows = W.n_rows;
+  const uword W_n_cols = W.n_cols;
   
-  const Mat<eT>& A = UA.M;
-  const Mat<eT>& B = UB.M;
+  const uword out_n_rows = out.n_rows;
+  const uword out_n_cols = out.n_cols;
   
-  const uword mode = expr.aux_uword;
+  const eT* u_mem = u.memptr();
+  const eT* v_mem = v.memptr();
   
-  if(mode == 0)  // full convolution
-    {
-    glue_conv2::apply(out, A, B);
-    }
-  else
-  if(mode == 1)  // same size as A
+  // element (r,c) of the first pass needs W(out_row + r - k, c) for k < u_n, with W taken as zero outside of its range
+  
+  Mat<eT> P(out_n_rows, W_n_cols);
+  
+  #if defined(_OPENMP)
+    const bool use_mp = (double(out.n_elem) * double(u_n + v_n) >= 1e6) && (omp_get_max_threads() > 1);
+  #endif
+  
+  #if defined(_OPENMP)
+    #pragma omp parallel for schedule(static) if(use_mp)
+  #endif
+  for(uword c=0; c < W_n_cols; ++c)
     {
-    Mat<eT> tmp;
+    const eT* W_colptr = W.colptr(c);
+          eT* P_colptr = P.colptr(c);
     
-    glue_conv2::apply(tmp, A, B);
+    arrayops::fill_zeros(P_colptr, out_n_rows);
     
-    if( (tmp.is_empty() == false) && (A.is_empty() == false) && (B.is_empty() == false) )
+    for(uword k=0; k < u_n; ++k)
       {
-      const uword start_row = uword( std::floor( double(B.n_rows) / double(2) ) );
-      const uword start_col = uword( std::floor( double(B.n_cols) / double(2) ) );
+      // rows of P for which out_row + r - k is within W
+      
+      if(W_n_rows + k <= out_row)  { continue; }
+      
+      const uword r_start = (out_row >= k) ? uword(0) : (k - out_row);
+      const uword r_end   = (std::min)(out_n_rows, W_n_rows + k - out_row);   // one past the last row
       
-      out = tmp(start_row, start_col, size(A));
+      if(r_start >= r_end)  { continue; }
+      
+      const eT    u_val = u_mem[k];
+      const eT*   W_mem = &(W_colptr[out_row + r_start - k]);
+            eT*   P_mem = &(P_colptr[r_start]);
+      const uword n     = r_end - r_start;
+      
+      for(uword i=0; i < n; ++i)  { P_mem[i] += u_val * W_mem[i]; }
       }
-    else
+    }
+  
+  // element (r,c) of the output is the sum of v[k] * P(r, out_col + c - k), with P taken as zero outside of its range
+  
+  #if defined(_OPENMP)
+    #pragma omp parallel for schedule(static) if(use_mp)
+  #endif
+  for(uword c=0; c < out_n_cols; ++c)
+    {
+    eT* out_colptr = out.colptr(c);
+    
+    arrayops::fill_zeros(out_colptr, out_n_rows);
+    
+    for(uword k=0; k < v_n; ++k)
       {
-      out.zeros( size(A) );
+      if( (out_col + c < k) || (out_col + c - k >= W_n_cols) )  { continue; }
+      
+      const eT  v_val = v_mem[k];
+      const eT* P_mem = P.colptr(out_col + c - k);
+      
+      for(uword i=0; i < out_n_rows; ++i)  { out_colptr[i] += v_val * P_mem[i]; }
       }
     }
   }
 
 
 
+//! as per apply_direct(), via the product of the 2D spectra of the zero padded filter and image
+template<typename eT>
+inline
+void
+glue_conv2::apply_fft(Mat<eT>& out, const Mat<eT>& G, const Mat<eT>& W, const uword out_row, const uword out_col, const typename arma_blas_type_only<eT>::result* junk)
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  typedef typename get_pod_type<eT>::result T;
+  typedef std::complex<T>                   cx_type;
+  
+  const uword R = fft_engine_pair<eT>::fast_length(W.n_rows + G.n_rows - 1);
+  const uword C = fft_engine_pair<eT>::fast_length(W.n_cols + G.n_cols - 1);
+  
+  Mat<eT> pad(R, C, fill::zeros);
+  
+  Mat<cx_type> G_spec;
+  Mat<cx_type> W_spec;
+  
+  pad( 0, 0, size(G) ) = G;
+  
+  glue_conv2::fft2_fwd(G_spec, pad);
+  
+  pad( 0, 0, size(G) ).zeros();
+  pad( 0, 0, size(W) ) = W;
+  
+  glue_conv2::fft2_fwd(W_spec, pad);
+  
+  arrayops::inplace_mul( W_spec.memptr(), G_spec.memptr(), W_spec.n_elem );
+  
+  glue_conv2::fft2_inv(pad, W_spec, R, C);
+  
+  out = pad( out_row, out_col, size(out) );
+  }
+
+
+
+//! the FFT based method is not available for integer elements
+template<typename eT>
+inline
+void
+glue_conv2::apply_fft(Mat<eT>& out, const Mat<eT>& G, const Mat<eT>& W, const uword out_row, const uword out_col, const typename arma_not_blas_type<eT>::result* junk)
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  glue_conv2::apply_direct(out, G, W, out_row, out_col);
+  }
+
+
+
+//! 2D transform of real X; only the first X.n_rows/2 + 1 rows are kept
+template<typename T>
+inline
+void
+glue_conv2::fft2_fwd(Mat< std::complex<T> >& out, const Mat<T>& X)
+  {
+  op_rfft::apply2<false>(out, X);
+  }
+
+
+
+template<typename T>
+inline
+void
+glue_conv2::fft2_fwd(Mat< std::complex<T> >& out, const Mat< std::complex<T> >& X)
+  {
+  op_fft_cx::apply2<false>(out, X);
+  }
+
+
+
+template<typename T>
+inline
+void
+glue_conv2::fft2_inv(Mat<T>& out, const Mat< std::complex<T> >& X, const uword n_rows, const uword n_cols)
+  {
+  op_irfft::apply2(out, X, n_rows, n_cols);
+  }
+
+
+
+template<typename T>
+inline
+void
+glue_conv2::fft2_inv(Mat< std::complex<T> >& out, const Mat< std::complex<T> >& X, const uword n_rows, const uword n_cols)
+  {
+  arma_ignore(n_rows);
+  arma_ignore(n_cols);
+  
+  op_fft_cx::apply2<true>(out, X);
+  }
+
+
+
 //! @}
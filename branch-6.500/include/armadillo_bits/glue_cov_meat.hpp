@@ -59,8 +59,8 @@ glue_cov::direct_cov(Mat<eT>& out, const Mat<eT>& A, const Mat<eT>& B, const uwo
     const uword N = A.n_rows;
     const eT norm_val = (norm_type == 0) ? ( (N > 1) ? eT(N-1) : eT(1) ) : eT(N);
     
-    out = trans(A) * B;
-    out -= (trans(sum(A)) * sum(B))/eT(N);
+    op_cov::centred_products(out, A, B, false);
+    
     out /= norm_val;
     }
   }
@@ -114,8 +114,8 @@ glue_cov::direct_cov(Mat< std::complex<T> >& out, const Mat< std::complex<T> >&
     const uword N = A.n_rows;
     const eT norm_val = (norm_type == 0) ? ( (N > 1) ? eT(N-1) : eT(1) ) : eT(N);
     
-    out = trans(A) * B;                     // out = strans(conj(A)) * B;
-    out -= (trans(sum(A)) * sum(B))/eT(N);  // out -= (strans(conj(sum(A))) * sum(B))/eT(N);
+    op_cov::centred_products(out, A, B, false);  // out = strans(conj(A - mean(A))) * (B - mean(B))
+    
     out /= norm_val;
     }
   }
@@ -16,6 +16,32 @@ class glue_hist
    {
    public:
    
+   //! arrangement of bin centers or edges, as determined by bin_layout()
+   static const uword layout_unsorted = 0;
+   static const uword layout_sorted   = 1;
+   static const uword layout_uniform  = 2;  //!< sorted and approximately uniformly spaced
+   
+   template<typename eT>
+   inline static uword bin_layout(double& inv_delta, const eT* B_mem, const uword B_n_elem, const bool strict);
+   
+   template<typename eT>
+   arma_hot inline static uword bin_search(const eT val, const eT* B_mem, const uword B_n_elem, const uword layout, const double inv_delta);
+   
+   template<typename eT>
+   arma_hot inline static uword bin_index(const eT val, const eT* C_mem, const uword C_n_elem, const uword layout, const double inv_delta);
+   
+   template<typename glue_type, typename eT>
+   inline static void apply_worker(uword* out_mem, const uword out_step, const eT* X_mem, const uword X_step, const uword X_n_elem, const eT* B_mem, const uword B_n_elem, const uword layout, const double inv_delta);
+   
+   template<typename glue_type, typename eT>
+   inline static void apply_lines(Mat<uword>& out, const Mat<eT>& X, const Mat<eT>& B, const uword dim, const bool strict);
+   
+   template<typename glue_type, typename eT>
+   inline static void apply_2d_worker(uword* out_mem, const uword out_n_rows, const eT* X_mem, const eT* Y_mem, const uword start, const uword end, const eT* BX_mem, const uword BX_n_elem, const uword layout_x, const double inv_delta_x, const eT* BY_mem, const uword BY_n_elem, const uword layout_y, const double inv_delta_y);
+   
+   template<typename glue_type, typename eT>
+   inline static void apply_2d(Mat<uword>& out, const Mat<eT>& X, const Mat<eT>& Y, const Mat<eT>& BX, const Mat<eT>& BY, const bool strict);
+   
    template<typename eT>
    inline static void apply_noalias(Mat<uword>& out, const Mat<eT>& X, const Mat<eT>& C, const uword dim);
    
@@ -12,169 +12,349 @@
 //! @{
 
 
+//! determine whether the bin centers (or edges) are sorted in ascending order,
+//! and if so, whether they are approximately uniformly spaced;
+//! for uniformly spaced bins, inv_delta is set to the reciprocal of the spacing
 template<typename eT>
 inline
-void
-glue_hist::apply_noalias(Mat<uword>& out, const Mat<eT>& X, const Mat<eT>& C, const uword dim)
+uword
+glue_hist::bin_layout(double& inv_delta, const eT* B_mem, const uword B_n_elem, const bool strict)
   {
   arma_extra_debug_sigprint();
   
-  arma_debug_check( ((C.is_vec() == false) && (C.is_empty() == false)), "hist(): parameter 'centers' must be a vector" );
+  inv_delta = double(0);
   
-  const uword X_n_rows = X.n_rows;
-  const uword X_n_cols = X.n_cols;
+  // a single bin is handled by the generic code, which preserves the handling of the edge cases
+  if(B_n_elem < 2)  { return layout_unsorted; }
   
-  const uword C_n_elem = C.n_elem;
+  for(uword i=1; i < B_n_elem; ++i)
+    {
+    const bool ok = (strict) ? (B_mem[i-1] < B_mem[i]) : (B_mem[i-1] <= B_mem[i]);
+    
+    if(ok == false)  { return layout_unsorted; }
+    }
   
-  if( C_n_elem == 0 )  { out.reset(); return; }
+  const double B_0   = double(B_mem[0]);
+  const double delta = (double(B_mem[B_n_elem-1]) - B_0) / double(B_n_elem-1);
   
-  const eT* C_mem    = C.memptr();
-  const eT  center_0 = C_mem[0];
+  if( (delta > double(0)) && arma_isfinite(delta) )
+    {
+    // the spacing only needs to be roughly uniform, as the bin found via arithmetic is refined using the actual bins
+    
+    for(uword i=1; i < B_n_elem; ++i)
+      {
+      if( std::abs(double(B_mem[i]) - (B_0 + double(i)*delta)) > (double(0.25) * delta) )  { return layout_sorted; }
+      }
+    
+    inv_delta = double(1) / delta;
+    
+    return layout_uniform;
+    }
   
-  if(dim == 0)
+  return layout_sorted;
+  }
+
+
+
+//! find the largest j such that B_mem[j] <= val (or 0 if val < B_mem[0]);
+//! the bins must be sorted and val must not be NaN;
+//! for uniformly spaced bins the location is found in O(1) time, and otherwise via binary search
+template<typename eT>
+arma_hot
+inline
+uword
+glue_hist::bin_search(const eT val, const eT* B_mem, const uword B_n_elem, const uword layout, const double inv_delta)
+  {
+  uword j;
+  
+  if(layout == layout_uniform)
+    {
+    const double t = (double(val) - double(B_mem[0])) * inv_delta;
+    
+    j = (t > double(0)) ? ( (t < double(B_n_elem-1)) ? uword(t) : (B_n_elem-1) ) : uword(0);
+    
+    while( (j > 0)            && (val < B_mem[j])    )  { --j; }
+    while( (j+1 < B_n_elem)   && (B_mem[j+1] <= val) )  { ++j; }
+    }
+  else
+    {
+    j = uword( std::upper_bound(B_mem, B_mem + B_n_elem, val) - B_mem );
+    
+    j = (j > 0) ? (j-1) : uword(0);
+    }
+  
+  return j;
+  }
+
+
+
+//! index of the nearest bin center, or C_n_elem if val is NaN
+template<typename eT>
+arma_hot
+inline
+uword
+glue_hist::bin_index(const eT val, const eT* C_mem, const uword C_n_elem, const uword layout, const double inv_delta)
+  {
+  if(arma_isfinite(val) == false)
+    {
+    // -inf
+    if(val < eT(0)) { return 0; }
+    
+    // +inf
+    if(val > eT(0)) { return C_n_elem-1; }
+    
+    // ignore NaN
+    return C_n_elem;
+    }
+  
+  if(layout == layout_unsorted)
     {
-    out.zeros(C_n_elem, X_n_cols);
+    const eT center_0 = C_mem[0];
     
-    for(uword col=0; col < X_n_cols; ++col)
+    eT    opt_dist  = (center_0 >= val) ? (center_0 - val) : (val - center_0);
+    uword opt_index = 0;
+    
+    for(uword j=1; j < C_n_elem; ++j)
       {
-      const eT*    X_coldata   = X.colptr(col);
-            uword* out_coldata = out.colptr(col);
+      const eT center = C_mem[j];
+      const eT dist   = (center >= val) ? (center - val) : (val - center);
       
-      for(uword row=0; row < X_n_rows; ++row)
+      if(dist < opt_dist)
         {
-        const eT val = X_coldata[row];
-        
-        if(arma_isfinite(val))
-          {
-          eT    opt_dist  = (center_0 >= val) ? (center_0 - val) : (val - center_0);
-          uword opt_index = 0;
-          
-          for(uword j=1; j < C_n_elem; ++j)
-            {
-            const eT center = C_mem[j];
-            const eT dist   = (center >= val) ? (center - val) : (val - center);
-            
-            if(dist < opt_dist)
-              {
-              opt_dist  = dist;
-              opt_index = j;
-              }
-            else
-              {
-              break;
-              }
-            }
-          
-          out_coldata[opt_index]++;
-          }
-        else
-          {
-          // -inf
-          if(val < eT(0)) { out_coldata[0]++; }
-          
-          // +inf
-          if(val > eT(0)) { out_coldata[C_n_elem-1]++; }
-          
-          // ignore NaN
-          }
+        opt_dist  = dist;
+        opt_index = j;
+        }
+      else
+        {
+        break;
         }
       }
+    
+    return opt_index;
+    }
+  
+  // the nearest center is either the last center <= val or the next one
+  
+  uword j = glue_hist::bin_search(val, C_mem, C_n_elem, layout, inv_delta);
+  
+  if(j+1 < C_n_elem)
+    {
+    const eT center_a = C_mem[j  ];
+    const eT center_b = C_mem[j+1];
+    
+    const eT dist_a = (center_a >= val) ? (center_a - val) : (val - center_a);
+    const eT dist_b = (center_b >= val) ? (center_b - val) : (val - center_b);
+    
+    if(dist_b < dist_a)  { ++j; }
+    }
+  
+  return j;
+  }
+
+
+
+template<typename glue_type, typename eT>
+inline
+void
+glue_hist::apply_worker(uword* out_mem, const uword out_step, const eT* X_mem, const uword X_step, const uword X_n_elem, const eT* B_mem, const uword B_n_elem, const uword layout, const double inv_delta)
+  {
+  for(uword i=0; i < X_n_elem; ++i)
+    {
+    const uword index = glue_type::bin_index(X_mem[i*X_step], B_mem, B_n_elem, layout, inv_delta);
+    
+    if(index < B_n_elem)  { out_mem[index*out_step]++; }
+    }
+  }
+
+
+
+//! histogram of each column (dim = 0) or each row (dim = 1) of X, using the bin rule of glue_type;
+//! if OpenMP is enabled, the columns or rows are split between threads;
+//! if there are fewer columns or rows than threads, each column or row is split between threads instead,
+//! with each thread using its own histogram; the histograms are then added
+template<typename glue_type, typename eT>
+inline
+void
+glue_hist::apply_lines(Mat<uword>& out, const Mat<eT>& X, const Mat<eT>& B, const uword dim, const bool strict)
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword X_n_rows = X.n_rows;
+  const uword X_n_cols = X.n_cols;
+  
+  const eT*   B_mem    = B.memptr();
+  const uword B_n_elem = B.n_elem;
+  
+  double inv_delta = double(0);
+  
+  const uword layout = glue_hist::bin_layout(inv_delta, B_mem, B_n_elem, strict);
+  
+  if(dim == 0)
+    {
+    out.zeros(B_n_elem, X_n_cols);
     }
   else
-  if(dim == 1)
     {
-    out.zeros(X_n_rows, C_n_elem);
+    out.zeros(X_n_rows, B_n_elem);
+    }
+  
+  const uword n_lines       = (dim == 0) ? X_n_cols : X_n_rows;
+  const uword line_len      = (dim == 0) ? X_n_rows : X_n_cols;
+  const uword X_line_step   = (dim == 0) ? X_n_rows : uword(1);
+  const uword X_elem_step   = (dim == 0) ? uword(1) : X_n_rows;
+  const uword out_line_step = (dim == 0) ? B_n_elem : uword(1);
+  const uword out_elem_step = (dim == 0) ? uword(1) : X_n_rows;
+  
+  const eT*    X_mem   = X.memptr();
+        uword* out_mem = out.memptr();
+  
+  #if defined(_OPENMP)
+    {
+    const uword n_threads_max = uword( (std::max)(int(1), int(omp_get_max_threads())) );
+    const uword n_threads     = (X.n_elem >= 16384) ? (std::min)(line_len, n_threads_max) : uword(1);
     
-    if(X_n_rows == 1)
+    if(n_threads > 1)
       {
-      const uword  X_n_elem = X.n_elem;
-      const eT*    X_mem    = X.memptr();
-            uword* out_mem  = out.memptr();
-      
-      for(uword i=0; i < X_n_elem; ++i)
+      if(n_lines >= n_threads)
         {
-        const eT val = X_mem[i];
-        
-        if(is_finite(val))
+        #pragma omp parallel for schedule(static)
+        for(uword line=0; line < n_lines; ++line)
           {
-          eT    opt_dist  = (val >= center_0) ? (val - center_0) : (center_0 - val);
-          uword opt_index = 0;
-          
-          for(uword j=1; j < C_n_elem; ++j)
-            {
-            const eT center = C_mem[j];
-            const eT dist   = (val >= center) ? (val - center) : (center - val);
-            
-            if(dist < opt_dist)
-              {
-              opt_dist  = dist;
-              opt_index = j;
-              }
-            else
-              {
-              break;
-              }
-            }
-          
-          out_mem[opt_index]++;
-          }
-        else
-          {
-          // -inf
-          if(val < eT(0)) { out_mem[0]++; }
-          
-          // +inf
-          if(val > eT(0)) { out_mem[C_n_elem-1]++; }
-          
-          // ignore NaN
+          glue_hist::apply_worker<glue_type>(out_mem + line*out_line_step, out_elem_step, X_mem + line*X_line_step, X_elem_step, line_len, B_mem, B_n_elem, layout, inv_delta);
           }
         }
-      }
-    else
-      {
-      for(uword row=0; row < X_n_rows; ++row)
+      else
         {
-        for(uword col=0; col < X_n_cols; ++col)
+        Mat<uword> partial(B_n_elem, n_threads);
+        
+        for(uword line=0; line < n_lines; ++line)
           {
-          const eT val = X.at(row,col);
+          partial.zeros();
           
-          if(arma_isfinite(val))
+          #pragma omp parallel for schedule(static)
+          for(uword t=0; t < n_threads; ++t)
             {
-            eT    opt_dist  = (center_0 >= val) ? (center_0 - val) : (val - center_0);
-            uword opt_index = 0;
+            const uword i_start = (t     * line_len) / n_threads;
+            const uword i_end   = ((t+1) * line_len) / n_threads;
             
-            for(uword j=1; j < C_n_elem; ++j)
-              {
-              const eT center = C_mem[j];
-              const eT dist   = (center >= val) ? (center - val) : (val - center);
-              
-              if(dist < opt_dist)
-                {
-                opt_dist  = dist;
-                opt_index = j;
-                }
-              else
-                {
-                break;
-                }
-              }
-            
-            out.at(row,opt_index)++;
+            glue_hist::apply_worker<glue_type>(partial.colptr(t), uword(1), X_mem + line*X_line_step + i_start*X_elem_step, X_elem_step, (i_end - i_start), B_mem, B_n_elem, layout, inv_delta);
             }
-          else
+          
+          uword* out_line_mem = out_mem + line*out_line_step;
+          
+          for(uword t=0; t < n_threads; ++t)
             {
-            // -inf
-            if(val < eT(0)) { out.at(row,0)++; }
+            const uword* partial_mem = partial.colptr(t);
             
-            // +inf
-            if(val > eT(0)) { out.at(row,C_n_elem-1)++; }
-            
-            // ignore NaN
+            for(uword i=0; i < B_n_elem; ++i)  { out_line_mem[i*out_elem_step] += partial_mem[i]; }
             }
           }
         }
+      
+      return;
       }
     }
+  #endif
+  
+  for(uword line=0; line < n_lines; ++line)
+    {
+    glue_hist::apply_worker<glue_type>(out_mem + line*out_line_step, out_elem_step, X_mem + line*X_line_step, X_elem_step, line_len, B_mem, B_n_elem, layout, inv_delta);
+    }
+  }
+
+
+
+template<typename glue_type, typename eT>
+inline
+void
+glue_hist::apply_2d_worker(uword* out_mem, const uword out_n_rows, const eT* X_mem, const eT* Y_mem, const uword start, const uword end, const eT* BX_mem, const uword BX_n_elem, const uword layout_x, const double inv_delta_x, const eT* BY_mem, const uword BY_n_elem, const uword layout_y, const double inv_delta_y)
+  {
+  for(uword i=start; i < end; ++i)
+    {
+    const uword index_x = glue_type::bin_index(X_mem[i], BX_mem, BX_n_elem, layout_x, inv_delta_x);
+    
+    if(index_x >= BX_n_elem)  { continue; }
+    
+    const uword index_y = glue_type::bin_index(Y_mem[i], BY_mem, BY_n_elem, layout_y, inv_delta_y);
+    
+    if(index_y >= BY_n_elem)  { continue; }
+    
+    out_mem[index_x + index_y*out_n_rows]++;
+    }
+  }
+
+
+
+//! joint histogram of the pairs (X[i], Y[i]), using the bin rule of glue_type;
+//! element (j,k) of the output is the number of pairs with X[i] in bin j of BX and Y[i] in bin k of BY;
+//! if OpenMP is enabled, the pairs are split between threads, with each thread using its own histogram
+template<typename glue_type, typename eT>
+inline
+void
+glue_hist::apply_2d(Mat<uword>& out, const Mat<eT>& X, const Mat<eT>& Y, const Mat<eT>& BX, const Mat<eT>& BY, const bool strict)
+  {
+  arma_extra_debug_sigprint();
+  
+  const eT*   BX_mem    = BX.memptr();
+  const uword BX_n_elem = BX.n_elem;
+  
+  const eT*   BY_mem    = BY.memptr();
+  const uword BY_n_elem = BY.n_elem;
+  
+  double inv_delta_x = double(0);
+  double inv_delta_y = double(0);
+  
+  const uword layout_x = glue_hist::bin_layout(inv_delta_x, BX_mem, BX_n_elem, strict);
+  const uword layout_y = glue_hist::bin_layout(inv_delta_y, BY_mem, BY_n_elem, strict);
+  
+  out.zeros(BX_n_elem, BY_n_elem);
+  
+  const uword N = X.n_elem;
+  
+  #if defined(_OPENMP)
+    {
+    const uword n_threads_max = uword( (std::max)(int(1), int(omp_get_max_threads())) );
+    const uword n_threads     = (N >= 16384) ? (std::min)(N, n_threads_max) : uword(1);
+    
+    if(n_threads > 1)
+      {
+      Cube<uword> partial(BX_n_elem, BY_n_elem, n_threads);
+      
+      partial.zeros();
+
+      #pragma omp parallel for schedule(static)
+      for(uword t=0; t < n_threads; ++t)
+        {
+        const uword i_start = (t     * N) / n_threads;
+        const uword i_end   = ((t+1) * N) / n_threads;
+        
+        glue_hist::apply_2d_worker<glue_type>(partial.slice_memptr(t), BX_n_elem, X.memptr(), Y.memptr(), i_start, i_end, BX_mem, BX_n_elem, layout_x, inv_delta_x, BY_mem, BY_n_elem, layout_y, inv_delta_y);
+        }
+      
+      for(uword t=0; t < n_threads; ++t)  { arrayops::inplace_plus( out.memptr(), partial.slice_memptr(t), out.n_elem ); }
+      
+      return;
+      }
+    }
+  #endif
+  
+  glue_hist::apply_2d_worker<glue_type>(out.memptr(), BX_n_elem, X.memptr(), Y.memptr(), 0, N, BX_mem, BX_n_elem, layout_x, inv_delta_x, BY_mem, BY_n_elem, layout_y, inv_delta_y);
+  }
+
+
+
+template<typename eT>
+inline
+void
+glue_hist::apply_noalias(Mat<uword>& out, const Mat<eT>& X, const Mat<eT>& C, const uword dim)
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_debug_check( ((C.is_vec() == false) && (C.is_empty() == false)), "hist(): parameter 'centers' must be a vector" );
+  
+  if( C.n_elem == 0 )  { out.reset(); return; }
+  
+  glue_hist::apply_lines<glue_hist>(out, X, C, dim, true);
   }
 
 
@@ -16,6 +16,9 @@ class glue_histc
    {
    public:
    
+   template<typename eT>
+   arma_hot inline static uword bin_index(const eT x, const eT* B_mem, const uword B_n_elem, const uword layout, const double inv_delta);
+   
    template<typename eT>
    inline static void apply_noalias(Mat<uword>& C, const Mat<eT>& A, const Mat<eT>& B, const uword dim);
    
@@ -12,83 +12,49 @@
 //! @{
 
 
+//! index of the bin containing x, ie. B_mem[i] <= x < B_mem[i+1], or B_n_elem if x is not in any bin;
+//! x equal to the last edge is counted in the last bin, for compatibility with Matlab
 template<typename eT>
+arma_hot
 inline
-void
-glue_histc::apply_noalias(Mat<uword>& C, const Mat<eT>& A, const Mat<eT>& B, const uword dim)
+uword
+glue_histc::bin_index(const eT x, const eT* B_mem, const uword B_n_elem, const uword layout, const double inv_delta)
   {
-  arma_extra_debug_sigprint();
-  
-  arma_debug_check( ((B.is_vec() == false) && (B.is_empty() == false)), "histc(): parameter 'edges' is not a vector" );
-  
-  const uword A_n_rows = A.n_rows;
-  const uword A_n_cols = A.n_cols;
-  
-  const uword B_n_elem = B.n_elem;
-  
-  if( B_n_elem == uword(0) )  { C.reset(); return; }
-  
-  const eT*   B_mem       = B.memptr();
   const uword B_n_elem_m1 = B_n_elem - 1;
   
-  if(dim == uword(0))
+  if(layout == glue_hist::layout_unsorted)
     {
-    C.zeros(B_n_elem, A_n_cols);
-    
-    for(uword col=0; col < A_n_cols; ++col)
+    for(uword i=0; i < B_n_elem_m1; ++i)
       {
-      const eT*    A_coldata = A.colptr(col);
-            uword* C_coldata = C.colptr(col);
-      
-      for(uword row=0; row < A_n_rows; ++row)
-        {
-        const eT x = A_coldata[row];
-        
-        for(uword i=0; i < B_n_elem_m1; ++i)
-          {
-               if( (B_mem[i]           <= x) && (x < B_mem[i+1]) )  { C_coldata[i]++;           break; }
-          else if(  B_mem[B_n_elem_m1] == x                      )  { C_coldata[B_n_elem_m1]++; break; }    // for compatibility with Matlab
-          }
-        }
+           if( (B_mem[i]           <= x) && (x < B_mem[i+1]) )  { return i;           }
+      else if(  B_mem[B_n_elem_m1] == x                      )  { return B_n_elem_m1; }    // for compatibility with Matlab
       }
-    }
-  else
-  if(dim == uword(1))
-    {
-    C.zeros(A_n_rows, B_n_elem);
     
-    if(A.n_rows == 1)
-      {
-      const uword  A_n_elem = A.n_elem;
-      const eT*    A_mem    = A.memptr();
-            uword* C_mem    = C.memptr();
-      
-      for(uword j=0; j < A_n_elem; ++j)
-        {
-        const eT x = A_mem[j];
-        
-        for(uword i=0; i < B_n_elem_m1; ++i)
-          {
-               if( (B_mem[i]           <= x) && (x < B_mem[i+1]) )  { C_mem[i]++;           break; }
-          else if(  B_mem[B_n_elem_m1] == x                      )  { C_mem[B_n_elem_m1]++; break; }    // for compatibility with Matlab
-          }
-        }
-      }
-    else
-      {
-      for(uword row=0; row < A_n_rows; ++row)
-      for(uword col=0; col < A_n_cols; ++col)
-        {
-        const eT x = A.at(row,col);
-        
-        for(uword i=0; i < B_n_elem_m1; ++i)
-          {
-               if( (B_mem[i]            <= x) && (x < B_mem[i+1]) )  { C.at(row,i)++;           break; }
-          else if(  B_mem[B_n_elem_m1]  == x                      )  { C.at(row,B_n_elem_m1)++; break; }   // for compatibility with Matlab
-          }
-        }
-      }
+    return B_n_elem;
     }
+  
+  // also rejects NaN
+  if( (x >= B_mem[0]) == false )  { return B_n_elem; }
+  
+  if(x >= B_mem[B_n_elem_m1])  { return (x == B_mem[B_n_elem_m1]) ? B_n_elem_m1 : B_n_elem; }
+  
+  return glue_hist::bin_search(x, B_mem, B_n_elem, layout, inv_delta);
+  }
+
+
+
+template<typename eT>
+inline
+void
+glue_histc::apply_noalias(Mat<uword>& C, const Mat<eT>& A, const Mat<eT>& B, const uword dim)
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_debug_check( ((B.is_vec() == false) && (B.is_empty() == false)), "histc(): parameter 'edges' is not a vector" );
+  
+  if( B.n_elem == uword(0) )  { C.reset(); return; }
+  
+  glue_hist::apply_lines<glue_histc>(C, A, B, dim, false);
   }
 
 
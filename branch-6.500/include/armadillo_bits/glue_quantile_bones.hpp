@@ -0,0 +1,40 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup glue_quantile
+//! @{
+
+
+class glue_quantile
+  {
+  public:
+  
+  template<typename eT>
+  inline static void worker(eT* out_mem, const uword out_step, std::vector<eT>& Y, const Mat<eT>& P, const uvec& P_order);
+  
+  template<typename eT>
+  inline static void apply_noalias(Mat<eT>& out, const Mat<eT>& X, const Mat<eT>& P, const uword dim);
+  
+  template<typename T1, typename T2>
+  inline static void apply(Mat<typename T1::elem_type>& out, const Glue<T1,T2,glue_quantile>& expr);
+  };
+
+
+
+class glue_quantile_default
+  {
+  public:
+  
+  template<typename T1, typename T2>
+  inline static void apply(Mat<typename T1::elem_type>& out, const Glue<T1,T2,glue_quantile_default>& expr);
+  };
+
+
+//! @}
@@ -0,0 +1,224 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup glue_quantile
+//! @{
+
+
+//! quantiles of the values in Y for the probabilities in P, with P_order listing the elements of P in ascending order.
+//! the quantile for probability p is found by linear interpolation at position N*p + 0.5 (1-based) of the sorted values,
+//! where N is the number of values; positions outside of [1,N] give the smallest or largest value.
+//! the required order statistics are found in ascending order via std::nth_element(),
+//! with each search limited to the values not smaller than the previous order statistic;
+//! Y is reordered in the process.
+template<typename eT>
+inline
+void
+glue_quantile::worker(eT* out_mem, const uword out_step, std::vector<eT>& Y, const Mat<eT>& P, const uvec& P_order)
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword N        = uword(Y.size());
+  const eT    N_eT     = eT(N);
+  const eT*   P_mem    = P.memptr();
+  const uword P_n_elem = P.n_elem;
+  
+  typename std::vector<eT>::iterator Y_begin = Y.begin();
+  typename std::vector<eT>::iterator Y_end   = Y.end();
+  
+  uword lo = 0;  // the values from position lo onwards are not smaller than the order statistics found so far
+  
+  for(uword j=0; j < P_n_elem; ++j)
+    {
+    const uword P_index = P_order[j];
+    
+    const eT h = N_eT * P_mem[P_index] + eT(0.5);
+    
+    uword k    = 0;  // 0-based rank of the lower value
+    eT    frac = eT(0);
+    
+    if(h >= N_eT)
+      {
+      k = N - 1;
+      }
+    else
+    if(h >= eT(1))
+      {
+      k    = uword(h) - 1;
+      frac = h - eT(k + 1);
+      }
+    
+    if( (k > lo) || (j == 0) )
+      {
+      std::nth_element(Y_begin + lo, Y_begin + k, Y_end);
+      
+      lo = k;
+      }
+    
+    eT val = Y[k];
+    
+    if(frac > eT(0))
+      {
+      const eT val_next = *( std::min_element(Y_begin + (k + 1), Y_end) );
+      
+      val += frac * (val_next - val);
+      }
+    
+    out_mem[P_index * out_step] = val;
+    }
+  }
+
+
+
+template<typename eT>
+inline
+void
+glue_quantile::apply_noalias(Mat<eT>& out, const Mat<eT>& X, const Mat<eT>& P, const uword dim)
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_debug_check( ((P.is_vec() == false) && (P.is_empty() == false)), "quantile(): parameter 'P' must be a vector" );
+  
+  const uword P_n_elem = P.n_elem;
+  
+  if(P_n_elem == 0)  { out.reset(); return; }
+  
+  arma_debug_check( ((P.min() < eT(0)) || (P.max() > eT(1))), "quantile(): all elements in P must be in the [0,1] interval" );
+  
+  const uvec P_order = sort_index(P);
+  
+  const uword X_n_rows = X.n_rows;
+  const uword X_n_cols = X.n_cols;
+  
+  if(dim == 0)  // in each column
+    {
+    arma_extra_debug_print("glue_quantile::apply(): dim = 0");
+    
+    out.set_size((X_n_rows > 0) ? P_n_elem : 0, X_n_cols);
+    
+    if(X_n_rows == 0)  { return; }
+    
+    #if defined(_OPENMP)
+      const bool use_mp = (X_n_cols > 1) && (X.n_elem >= 16384) && (omp_get_max_threads() > 1);
+    #endif
+    
+    #if defined(_OPENMP)
+      #pragma omp parallel if(use_mp)
+    #endif
+      {
+      std::vector<eT> tmp_vec(X_n_rows);
+      
+      #if defined(_OPENMP)
+        #pragma omp for schedule(static)
+      #endif
+      for(uword col=0; col < X_n_cols; ++col)
+        {
+        arrayops::copy( &(tmp_vec[0]), X.colptr(col), X_n_rows );
+        
+        glue_quantile::worker(out.colptr(col), uword(1), tmp_vec, P, P_order);
+        }
+      }
+    }
+  else
+  if(dim == 1)  // in each row
+    {
+    arma_extra_debug_print("glue_quantile::apply(): dim = 1");
+    
+    out.set_size(X_n_rows, (X_n_cols > 0) ? P_n_elem : 0);
+    
+    if(X_n_cols == 0)  { return; }
+    
+    #if defined(_OPENMP)
+      const bool use_mp = (X_n_rows > 1) && (X.n_elem >= 16384) && (omp_get_max_threads() > 1);
+    #endif
+    
+    #if defined(_OPENMP)
+      #pragma omp parallel if(use_mp)
+    #endif
+      {
+      std::vector<eT> tmp_vec(X_n_cols);
+      
+      #if defined(_OPENMP)
+        #pragma omp for schedule(static)
+      #endif
+      for(uword row=0; row < X_n_rows; ++row)
+        {
+        for(uword col=0; col < X_n_cols; ++col)  { tmp_vec[col] = X.at(row,col); }
+        
+        glue_quantile::worker(out.memptr() + row, X_n_rows, tmp_vec, P, P_order);
+        }
+      }
+    }
+  }
+
+
+
+template<typename T1, typename T2>
+inline
+void
+glue_quantile::apply(Mat<typename T1::elem_type>& out, const Glue<T1,T2,glue_quantile>& expr)
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename T1::elem_type eT;
+  
+  const uword dim = expr.aux_uword;
+  
+  arma_debug_check( (dim > 1), "quantile(): parameter 'dim' must be 0 or 1" );
+  
+  const quasi_unwrap<T1> UA(expr.A);
+  const quasi_unwrap<T2> UB(expr.B);
+  
+  if(UA.is_alias(out) || UB.is_alias(out))
+    {
+    Mat<eT> tmp;
+    
+    glue_quantile::apply_noalias(tmp, UA.M, UB.M, dim);
+    
+    out.steal_mem(tmp);
+    }
+  else
+    {
+    glue_quantile::apply_noalias(out, UA.M, UB.M, dim);
+    }
+  }
+
+
+
+template<typename T1, typename T2>
+inline
+void
+glue_quantile_default::apply(Mat<typename T1::elem_type>& out, const Glue<T1,T2,glue_quantile_default>& expr)
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename T1::elem_type eT;
+  
+  const quasi_unwrap<T1> UA(expr.A);
+  const quasi_unwrap<T2> UB(expr.B);
+  
+  const uword dim = (T1::is_row) ? 1 : 0;
+  
+  if(UA.is_alias(out) || UB.is_alias(out))
+    {
+    Mat<eT> tmp;
+    
+    glue_quantile::apply_noalias(tmp, UA.M, UB.M, dim);
+    
+    out.steal_mem(tmp);
+    }
+  else
+    {
+    glue_quantile::apply_noalias(out, UA.M, UB.M, dim);
+    }
+  }
+
+
+//! @}
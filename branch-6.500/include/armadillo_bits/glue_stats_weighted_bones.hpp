@@ -0,0 +1,49 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup glue_stats_weighted
+//! @{
+
+
+
+class glue_stats_weighted
+  {
+  public:
+  
+  template<typename eT> inline static eT check_weights(const Mat<eT>& W, const uword n_obs, const char* caller);
+  
+  template<typename eT> inline static void mean_noalias(Mat<eT>& out, const Mat<eT>& X, const Mat<eT>& W, const uword dim);
+  template<typename eT> inline static void  var_noalias(Mat<eT>& out, const Mat<eT>& X, const Mat<eT>& W, const uword dim);
+  
+  template<typename T1, typename T2> inline static typename T1::elem_type mean_vec(const T1& X, const T2& W);
+  template<typename T1, typename T2> inline static typename T1::elem_type  var_vec(const T1& X, const T2& W);
+  };
+
+
+
+class glue_mean_weighted
+  {
+  public:
+  
+  template<typename T1, typename T2> inline static void apply(Mat<typename T1::elem_type>& out, const Glue<T1,T2,glue_mean_weighted>& expr);
+  };
+
+
+
+class glue_var_weighted
+  {
+  public:
+  
+  template<typename T1, typename T2> inline static void apply(Mat<typename T1::elem_type>& out, const Glue<T1,T2,glue_var_weighted>& expr);
+  };
+
+
+
+//! @}
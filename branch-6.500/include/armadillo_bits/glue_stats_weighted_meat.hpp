@@ -0,0 +1,384 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup glue_stats_weighted
+//! @{
+
+
+
+//! check that W is a vector with n_obs finite and non-negative elements, and return the sum of the elements
+template<typename eT>
+inline
+eT
+glue_stats_weighted::check_weights(const Mat<eT>& W, const uword n_obs, const char* caller)
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_debug_check( ((W.is_vec() == false) && (W.is_empty() == false)), caller, ": given weights must be a vector" );
+  
+  arma_debug_check( (W.n_elem != n_obs), caller, ": number of weights does not match the number of observations" );
+  
+  const eT* W_mem = W.memptr();
+  
+  eT W_sum = eT(0);
+  
+  for(uword i=0; i < n_obs; ++i)
+    {
+    const eT w = W_mem[i];
+    
+    arma_debug_check( ((w < eT(0)) || (arma_isfinite(w) == false)), caller, ": weights must be finite and non-negative" );
+    
+    W_sum += w;
+    }
+  
+  return W_sum;
+  }
+
+
+
+//! weighted mean of each column (dim = 0) or each row (dim = 1);
+//! if OpenMP is enabled, the columns (dim = 0) or blocks of rows (dim = 1) of large matrices are split between threads
+template<typename eT>
+inline
+void
+glue_stats_weighted::mean_noalias(Mat<eT>& out, const Mat<eT>& X, const Mat<eT>& W, const uword dim)
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword X_n_rows = X.n_rows;
+  const uword X_n_cols = X.n_cols;
+  
+  const eT* W_mem = W.memptr();
+  
+  if(dim == 0)
+    {
+    const eT W_sum = glue_stats_weighted::check_weights(W, X_n_rows, "mean()");
+    
+    out.set_size((X_n_rows > 0) ? 1 : 0, X_n_cols);
+    
+    if(X_n_rows == 0)  { return; }
+    
+    eT* out_mem = out.memptr();
+    
+    #if defined(_OPENMP)
+      const bool use_mp = (X_n_cols > 1) && (X.n_elem >= 16384) && (omp_get_max_threads() > 1);
+    #endif
+    
+    #if defined(_OPENMP)
+      #pragma omp parallel for schedule(static) if(use_mp)
+    #endif
+    for(uword col=0; col < X_n_cols; ++col)
+      {
+      const eT* X_colmem = X.colptr(col);
+      
+      eT acc1 = eT(0);
+      eT acc2 = eT(0);
+      
+      uword i,j;
+      for(i=0, j=1; j < X_n_rows; i+=2, j+=2)
+        {
+        acc1 += W_mem[i] * X_colmem[i];
+        acc2 += W_mem[j] * X_colmem[j];
+        }
+      
+      if(i < X_n_rows)
+        {
+        acc1 += W_mem[i] * X_colmem[i];
+        }
+      
+      out_mem[col] = (acc1 + acc2) / W_sum;
+      }
+    }
+  else
+  if(dim == 1)
+    {
+    const eT W_sum = glue_stats_weighted::check_weights(W, X_n_cols, "mean()");
+    
+    out.zeros(X_n_rows, (X_n_cols > 0) ? 1 : 0);
+    
+    if(X_n_cols == 0)  { return; }
+    
+    eT* out_mem = out.memptr();
+    
+    uword n_chunks = 1;
+    
+    #if defined(_OPENMP)
+      if( (X_n_rows > 1) && (X.n_elem >= 16384) )  { n_chunks = (std::min)( X_n_rows, uword( (std::max)(int(1), int(omp_get_max_threads())) ) ); }
+    #endif
+    
+    #if defined(_OPENMP)
+      #pragma omp parallel for schedule(static) if(n_chunks > 1)
+    #endif
+    for(uword t=0; t < n_chunks; ++t)
+      {
+      const uword row_start = (t     * X_n_rows) / n_chunks;
+      const uword row_end   = ((t+1) * X_n_rows) / n_chunks;
+      
+      for(uword col=0; col < X_n_cols; ++col)
+        {
+        const eT w = W_mem[col];
+        
+        if(w == eT(0))  { continue; }
+        
+        const eT* X_colmem = X.colptr(col);
+        
+        for(uword row=row_start; row < row_end; ++row)  { out_mem[row] += w * X_colmem[row]; }
+        }
+      
+      for(uword row=row_start; row < row_end; ++row)  { out_mem[row] /= W_sum; }
+      }
+    }
+  }
+
+
+
+//! weighted variance of each column (dim = 0) or each row (dim = 1), normalised by the sum of the weights;
+//! the mean and the sum of squared differences are found in one pass via the weighted update of West (1979):
+//! for each observation x with weight w, m <- m + (w/S_new)*(x - m) and M2 <- M2 + (S_old*w/S_new)*(x - m_old)^2,
+//! where S is the sum of the weights so far; the two coefficients only depend on the weights, so they are found once;
+//! if OpenMP is enabled, the columns (dim = 0) or blocks of rows (dim = 1) of large matrices are split between threads
+template<typename eT>
+inline
+void
+glue_stats_weighted::var_noalias(Mat<eT>& out, const Mat<eT>& X, const Mat<eT>& W, const uword dim)
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword X_n_rows = X.n_rows;
+  const uword X_n_cols = X.n_cols;
+  
+  const uword n_obs = (dim == 0) ? X_n_rows : X_n_cols;
+  
+  const eT W_sum = glue_stats_weighted::check_weights(W, n_obs, "var()");
+  
+  const eT* W_mem = W.memptr();
+  
+  podarray<eT> coeff_m(n_obs);
+  podarray<eT> coeff_v(n_obs);
+  
+  eT S = eT(0);
+  
+  for(uword i=0; i < n_obs; ++i)
+    {
+    const eT w     = W_mem[i];
+    const eT S_new = S + w;
+    
+    const eT r = (S_new > eT(0)) ? (w / S_new) : eT(0);
+    
+    coeff_m[i] = r;
+    coeff_v[i] = S * r;
+    
+    S = S_new;
+    }
+  
+  const eT* coeff_m_mem = coeff_m.memptr();
+  const eT* coeff_v_mem = coeff_v.memptr();
+  
+  if(dim == 0)
+    {
+    out.set_size((X_n_rows > 0) ? 1 : 0, X_n_cols);
+    
+    if(X_n_rows == 0)  { return; }
+    
+    eT* out_mem = out.memptr();
+    
+    #if defined(_OPENMP)
+      const bool use_mp = (X_n_cols > 1) && (X.n_elem >= 16384) && (omp_get_max_threads() > 1);
+    #endif
+    
+    #if defined(_OPENMP)
+      #pragma omp parallel for schedule(static) if(use_mp)
+    #endif
+    for(uword col=0; col < X_n_cols; ++col)
+      {
+      const eT* X_colmem = X.colptr(col);
+      
+      eT m  = eT(0);
+      eT M2 = eT(0);
+      
+      for(uword i=0; i < X_n_rows; ++i)
+        {
+        const eT d = X_colmem[i] - m;
+        
+        m  += coeff_m_mem[i] * d;
+        M2 += coeff_v_mem[i] * (d*d);
+        }
+      
+      out_mem[col] = M2 / W_sum;
+      }
+    }
+  else
+  if(dim == 1)
+    {
+    out.zeros(X_n_rows, (X_n_cols > 0) ? 1 : 0);
+    
+    if(X_n_cols == 0)  { return; }
+    
+    podarray<eT> m(X_n_rows);
+    
+    m.zeros();
+    
+    eT* m_mem   = m.memptr();
+    eT* out_mem = out.memptr();
+    
+    uword n_chunks = 1;
+    
+    #if defined(_OPENMP)
+      if( (X_n_rows > 1) && (X.n_elem >= 16384) )  { n_chunks = (std::min)( X_n_rows, uword( (std::max)(int(1), int(omp_get_max_threads())) ) ); }
+    #endif
+    
+    #if defined(_OPENMP)
+      #pragma omp parallel for schedule(static) if(n_chunks > 1)
+    #endif
+    for(uword t=0; t < n_chunks; ++t)
+      {
+      const uword row_start = (t     * X_n_rows) / n_chunks;
+      const uword row_end   = ((t+1) * X_n_rows) / n_chunks;
+      
+      for(uword col=0; col < X_n_cols; ++col)
+        {
+        const eT cm = coeff_m_mem[col];
+        const eT cv = coeff_v_mem[col];
+        
+        if(cm == eT(0))  { continue; }
+        
+        const eT* X_colmem = X.colptr(col);
+        
+        for(uword row=row_start; row < row_end; ++row)
+          {
+          const eT d = X_colmem[row] - m_mem[row];
+          
+          m_mem[row]   += cm * d;
+          out_mem[row] += cv * (d*d);
+          }
+        }
+      
+      for(uword row=row_start; row < row_end; ++row)  { out_mem[row] /= W_sum; }
+      }
+    }
+  }
+
+
+
+template<typename T1, typename T2>
+inline
+typename T1::elem_type
+glue_stats_weighted::mean_vec(const T1& X, const T2& W)
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename T1::elem_type eT;
+  
+  const quasi_unwrap<T1> UX(X);
+  const quasi_unwrap<T2> UW(W);
+  
+  arma_debug_check( (UX.M.n_elem == 0), "mean(): object has no elements" );
+  
+  const Mat<eT> V( const_cast<eT*>(UX.M.memptr()), UX.M.n_elem, 1, false, true );
+  
+  Mat<eT> out;
+  
+  glue_stats_weighted::mean_noalias(out, V, UW.M, 0);
+  
+  return out[0];
+  }
+
+
+
+template<typename T1, typename T2>
+inline
+typename T1::elem_type
+glue_stats_weighted::var_vec(const T1& X, const T2& W)
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename T1::elem_type eT;
+  
+  const quasi_unwrap<T1> UX(X);
+  const quasi_unwrap<T2> UW(W);
+  
+  arma_debug_check( (UX.M.n_elem == 0), "var(): object has no elements" );
+  
+  const Mat<eT> V( const_cast<eT*>(UX.M.memptr()), UX.M.n_elem, 1, false, true );
+  
+  Mat<eT> out;
+  
+  glue_stats_weighted::var_noalias(out, V, UW.M, 0);
+  
+  return out[0];
+  }
+
+
+
+template<typename T1, typename T2>
+inline
+void
+glue_mean_weighted::apply(Mat<typename T1::elem_type>& out, const Glue<T1,T2,glue_mean_weighted>& expr)
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename T1::elem_type eT;
+  
+  const uword dim = expr.aux_uword;
+  
+  arma_debug_check( (dim > 1), "mean(): parameter 'dim' must be 0 or 1" );
+  
+  const quasi_unwrap<T1> UA(expr.A);
+  const quasi_unwrap<T2> UB(expr.B);
+  
+  if(UA.is_alias(out) || UB.is_alias(out))
+    {
+    Mat<eT> tmp;
+    
+    glue_stats_weighted::mean_noalias(tmp, UA.M, UB.M, dim);
+    
+    out.steal_mem(tmp);
+    }
+  else
+    {
+    glue_stats_weighted::mean_noalias(out, UA.M, UB.M, dim);
+    }
+  }
+
+
+
+template<typename T1, typename T2>
+inline
+void
+glue_var_weighted::apply(Mat<typename T1::elem_type>& out, const Glue<T1,T2,glue_var_weighted>& expr)
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename T1::elem_type eT;
+  
+  const uword dim = expr.aux_uword;
+  
+  arma_debug_check( (dim > 1), "var(): parameter 'dim' must be 0 or 1" );
+  
+  const quasi_unwrap<T1> UA(expr.A);
+  const quasi_unwrap<T2> UB(expr.B);
+  
+  if(UA.is_alias(out) || UB.is_alias(out))
+    {
+    Mat<eT> tmp;
+    
+    glue_stats_weighted::var_noalias(tmp, UA.M, UB.M, dim);
+    
+    out.steal_mem(tmp);
+    }
+  else
+    {
+    glue_stats_weighted::var_noalias(out, UA.M, UB.M, dim);
+    }
+  }
+
+
+
+//! @}
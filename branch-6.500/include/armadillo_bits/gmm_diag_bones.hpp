@@ -37,12 +37,14 @@ struct gmm_seed_static_subset : public gmm_seed_mode { inline gmm_seed_static_su
 struct gmm_seed_static_spread : public gmm_seed_mode { inline gmm_seed_static_spread() : gmm_seed_mode(3) {} };
 struct gmm_seed_random_subset : public gmm_seed_mode { inline gmm_seed_random_subset() : gmm_seed_mode(4) {} };
 struct gmm_seed_random_spread : public gmm_seed_mode { inline gmm_seed_random_spread() : gmm_seed_mode(5) {} };
+struct gmm_seed_random_kmpp   : public gmm_seed_mode { inline gmm_seed_random_kmpp()   : gmm_seed_mode(6) {} };
 
 static const gmm_seed_keep_existing keep_existing;
 static const gmm_seed_static_subset static_subset;
 static const gmm_seed_static_spread static_spread;
 static const gmm_seed_random_subset random_subset;
 static const gmm_seed_random_spread random_spread;
+static const gmm_seed_random_kmpp   random_kmpp;
 
 
 namespace gmm_priv
@@ -51,20 +53,6 @@ namespace gmm_priv
 struct gmm_empty_arg {};
 
 
-#if defined(_OPENMP)
-  struct arma_omp_state
-    {
-    const int orig_dynamic_state;
-    
-    inline  arma_omp_state() : orig_dynamic_state(omp_get_dynamic()) { omp_set_dynamic(0); }
-    inline ~arma_omp_state() { omp_set_dynamic(orig_dynamic_state); }
-    };
-#else
-  struct arma_omp_state {};
-#endif
-
-
-
 template<typename eT>
 class gmm_diag
   {
@@ -134,6 +122,27 @@ class gmm_diag
     );
   
   
+  template<typename T1>
+  inline
+  bool
+  learn_online
+    (
+    const Base<eT,T1>&    batch,
+    const uword           n_gaus,
+    const gmm_dist_mode&  dist_mode,
+    const gmm_seed_mode&  seed_mode,
+    const uword           km_batches,
+    const eT              var_floor,
+    const eT              decay,
+    const bool            print_mode
+    );
+  
+  inline void reset_online();
+  
+  inline void set_executor(executor& in_exec);
+  inline void set_executor();
+  
+  
   template<typename T1>
   inline
   bool
@@ -152,11 +161,24 @@ class gmm_diag
   
   protected:
   
+  template<typename> friend class gmm_full;  // gmm_full uses the seeding and k-means algorithms
+  
   
   arma_aligned Row<eT> log_det_etc;
   arma_aligned Row<eT> log_hefts;
   arma_aligned Col<eT> mah_aux;
   
+  // state of learn_online(): the number of batches seen so far,
+  // the counts of the mini-batch k-means stage, and the normalised sufficient statistics of the stepwise EM stage
+  
+  arma_aligned uword   online_n_batches;
+  arma_aligned uvec    online_km_counts;
+  arma_aligned Row<eT> online_acc_hefts;
+  arma_aligned Mat<eT> online_acc_means;
+  arma_aligned Mat<eT> online_acc_dcovs;
+  
+  executor* exec_ptr;  //!< executor for the parallel operations; the default executor is used if null
+  
   //
   
   inline void init(const gmm_diag& x);
@@ -166,6 +188,8 @@ class gmm_diag
   inline void init_constants();
 
   inline umat internal_gen_boundaries(const uword N) const;
+  
+  inline executor& get_executor() const;
 
   inline eT internal_scalar_log_p(const eT* x                     ) const;
   inline eT internal_scalar_log_p(const eT* x, const uword gaus_id) const;
@@ -180,6 +204,8 @@ class gmm_diag
   
   template<typename T1> inline void internal_vec_assign(urowvec& out, const T1& X, const gmm_dist_mode& dist_mode) const;
   
+  template<typename T1> inline void internal_vec_assign_worker(uword* out_mem, const T1& X, const uword start_index, const uword end_index, const gmm_dist_mode& dist_mode) const;
+  
   inline void internal_raw_hist(urowvec& hist, const Mat<eT>& X, const gmm_dist_mode& dist_mode) const;
   
   //
@@ -192,10 +218,25 @@ class gmm_diag
   
   template<uword dist_id> inline void km_update_stats(const Mat<eT>& X, const uword start_index, const uword end_index, const Mat<eT>& old_means, field< running_mean_vec<eT> >& running_means) const;
   
+  inline bool km_fix_dead_means(Mat<eT>& new_means, const uword* counts, const uword* last_indices, const Mat<eT>& X, const bool verbose, const char* signature) const;
+  
+  template<uword dist_id> inline void generate_kmpp_means(const Mat<eT>& X);
+  
+  template<uword dist_id> inline bool km_iterate_bounds(const Mat<eT>& X, const uword max_iter, const bool verbose, const char* signature);
+  
+  template<uword dist_id> inline void km_bounds_init  (const Mat<eT>& X, const uword start_index, const uword end_index, const Mat<eT>& old_means, uword* assign, eT* upper, eT* lower, Mat<eT>& acc, uword* counts, uword* last_indices) const;
+  template<uword dist_id> inline void km_bounds_update(const Mat<eT>& X, const uword start_index, const uword end_index, const Mat<eT>& old_means, const eT* half_sep, const eT* moved, const eT* lower_shift, uword* assign, eT* upper, eT* lower, Mat<eT>& acc, uword* counts, uword* last_indices) const;
+  
+  template<uword dist_id> inline void km_online_update(const Mat<eT>& X);
+  
+  inline void em_online_update(const Mat<eT>& X, const uword em_index, const eT var_floor, const eT decay, const bool verbose);
+  
   //
   
   inline bool em_iterate(const Mat<eT>& X, const uword max_iter, const eT var_floor, const bool verbose);
   
+  inline void em_accumulate(const Mat<eT>& X, const umat& boundaries, field< Mat<eT> >& t_acc_means, field< Mat<eT> >& t_acc_dcovs, field< Col<eT> >& t_acc_norm_lhoods, field< Col<eT> >& t_gaus_log_lhoods, Col<eT>& t_progress_log_lhoods) const;
+  
   inline void em_update_params(const Mat<eT>& X, const umat& boundaries, field< Mat<eT> >& t_acc_means, field< Mat<eT> >& t_acc_dcovs, field< Col<eT> >& t_acc_norm_lhoods, field< Col<eT> >& t_gaus_log_lhoods, Col<eT>& t_progress_log_lhoods);
   
   inline void em_generate_acc(const Mat<eT>& X, const uword start_index, const uword end_index, Mat<eT>& acc_means, Mat<eT>& acc_dcovs, Col<eT>& acc_norm_lhoods, Col<eT>& gaus_log_lhoods, eT& progress_log_lhood) const;
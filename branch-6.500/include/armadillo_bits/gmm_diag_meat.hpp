@@ -30,6 +30,8 @@ gmm_diag<eT>::~gmm_diag()
 template<typename eT>
 inline
 gmm_diag<eT>::gmm_diag()
+  : online_n_batches(0)
+  , exec_ptr(0)
   {
   arma_extra_debug_sigprint_this(this);
   }
@@ -39,6 +41,8 @@ gmm_diag<eT>::gmm_diag()
 template<typename eT>
 inline
 gmm_diag<eT>::gmm_diag(const gmm_diag<eT>& x)
+  : online_n_batches(0)
+  , exec_ptr(0)
   {
   arma_extra_debug_sigprint_this(this);
   
@@ -64,6 +68,8 @@ gmm_diag<eT>::operator=(const gmm_diag<eT>& x)
 template<typename eT>
 inline
 gmm_diag<eT>::gmm_diag(const uword in_n_dims, const uword in_n_gaus)
+  : online_n_batches(0)
+  , exec_ptr(0)
   {
   arma_extra_debug_sigprint_this(this);
   
@@ -137,6 +143,8 @@ gmm_diag<eT>::set_params(const Base<eT,T1>& in_means_expr, const Base<eT,T2>& in
   access::rw(dcovs) = in_dcovs;
   access::rw(hefts) = in_hefts;
   
+  reset_online();
+  
   init_constants();
   }
 
@@ -158,6 +166,8 @@ gmm_diag<eT>::set_means(const Base<eT,T1>& in_means_expr)
   arma_debug_check( (in_means.is_finite() == false), "gmm_diag::set_means(): given means have non-finite values" );
   
   access::rw(means) = in_means;
+  
+  reset_online();
   }
 
 
@@ -180,6 +190,8 @@ gmm_diag<eT>::set_dcovs(const Base<eT,T1>& in_dcovs_expr)
   
   access::rw(dcovs) = in_dcovs;
   
+  reset_online();
+  
   init_constants();
   }
 
@@ -217,6 +229,8 @@ gmm_diag<eT>::set_hefts(const Base<eT,T1>& in_hefts_expr)
   
   access::rw(hefts) /= accu(hefts);
   
+  reset_online();
+  
   log_hefts = log(hefts);
   }
 
@@ -269,6 +283,8 @@ gmm_diag<eT>::load(const std::string name)
   access::rw(means) = Q.slice(0).submat(1, 0, Q.n_rows-1, Q.n_cols-1);
   access::rw(dcovs) = Q.slice(1).submat(1, 0, Q.n_rows-1, Q.n_cols-1);
   
+  reset_online();
+  
   init_constants();
   
   return true;
@@ -665,7 +681,8 @@ gmm_diag<eT>::learn
     || (seed_mode == static_subset)
     || (seed_mode == static_spread)
     || (seed_mode == random_subset)
-    || (seed_mode == random_spread);
+    || (seed_mode == random_spread)
+    || (seed_mode == random_kmpp);
   
   arma_debug_check( (dist_mode_ok == false), "gmm_diag::learn(): dist_mode must be eucl_dist or maha_dist" );
   arma_debug_check( (seed_mode_ok == false), "gmm_diag::learn(): unknown seed_mode"                        );
@@ -713,7 +730,8 @@ gmm_diag<eT>::learn
     {
     if(X.n_cols < N_gaus)  { arma_debug_warn("gmm_diag::learn(): number of vectors is less than number of gaussians"); return false; }
     
-    reset(X.n_rows, N_gaus);
+    // not using reset(), as it also clears mah_aux
+    init(X.n_rows, N_gaus);
     
     if(print_mode)  { get_stream_err2() << "gmm_diag::learn(): generating initial means\n"; }
     
@@ -767,6 +785,8 @@ gmm_diag<eT>::learn
   
   mah_aux.reset();
   
+  reset_online();
+  
   init_constants();
   
   return true;
@@ -795,7 +815,8 @@ gmm_diag<eT>::kmeans_wrapper
     || (seed_mode == static_subset)
     || (seed_mode == static_spread)
     || (seed_mode == random_subset)
-    || (seed_mode == random_spread);
+    || (seed_mode == random_spread)
+    || (seed_mode == random_kmpp);
   
   arma_debug_check( (seed_mode_ok == false), "kmeans(): unknown seed_mode" );
   
@@ -851,6 +872,207 @@ gmm_diag<eT>::kmeans_wrapper
 
 
 
+//! stepwise (online) learning from a stream of mini-batches: each call consumes one batch, which does not need to be kept afterwards.
+//! the first km_batches batches are used for mini-batch k-means, and the subsequent batches for stepwise EM,
+//! where the sufficient statistics are blended with those of each new batch using the step size (n+2)^(-decay), with n the EM batch index.
+//! seed_mode is used for the first batch only; with keep_existing, the existing model is used as the starting point
+template<typename eT>
+template<typename T1>
+inline
+bool
+gmm_diag<eT>::learn_online
+  (
+  const Base<eT,T1>&   batch,
+  const uword          N_gaus,
+  const gmm_dist_mode& dist_mode,
+  const gmm_seed_mode& seed_mode,
+  const uword          km_batches,
+  const eT             var_floor,
+  const eT             decay,
+  const bool           print_mode
+  )
+  {
+  arma_extra_debug_sigprint();
+  
+  const bool dist_mode_ok = (dist_mode == eucl_dist) || (dist_mode == maha_dist);
+  
+  const bool seed_mode_ok = \
+       (seed_mode == keep_existing)
+    || (seed_mode == static_subset)
+    || (seed_mode == static_spread)
+    || (seed_mode == random_subset)
+    || (seed_mode == random_spread)
+    || (seed_mode == random_kmpp);
+  
+  arma_debug_check( (dist_mode_ok == false),                    "gmm_diag::learn_online(): dist_mode must be eucl_dist or maha_dist"   );
+  arma_debug_check( (seed_mode_ok == false),                    "gmm_diag::learn_online(): unknown seed_mode"                          );
+  arma_debug_check( (var_floor < eT(0)    ),                    "gmm_diag::learn_online(): variance floor is negative"                 );
+  arma_debug_check( ((decay <= eT(0.5)) || (decay > eT(1))),    "gmm_diag::learn_online(): decay must be in the (0.5, 1] interval"     );
+  
+  const unwrap<T1>   tmp_X(batch.get_ref());
+  const Mat<eT>& X = tmp_X.M;
+  
+  if(X.is_empty()          )  { arma_debug_warn("gmm_diag::learn_online(): given matrix is empty"             ); return false; }
+  if(X.is_finite() == false)  { arma_debug_warn("gmm_diag::learn_online(): given matrix has non-finite values"); return false; }
+  
+  if(N_gaus == 0)  { reset(); return true; }
+  
+  
+  // copy current model, in case of failure
+  
+  const gmm_diag<eT> orig = (*this);
+  
+  if(online_n_batches == 0)
+    {
+    if(seed_mode == keep_existing)
+      {
+      if(means.is_empty()        )  { arma_debug_warn("gmm_diag::learn_online(): no existing means"                      ); return false; }
+      if(X.n_rows != means.n_rows)  { arma_debug_warn("gmm_diag::learn_online(): dimensionality mismatch"                ); return false; }
+      if(N_gaus   != means.n_cols)  { arma_debug_warn("gmm_diag::learn_online(): number of gaussians differs from model"); return false; }
+      }
+    else
+      {
+      if(X.n_cols < N_gaus)  { arma_debug_warn("gmm_diag::learn_online(): number of vectors is less than number of gaussians"); return false; }
+      
+      reset(X.n_rows, N_gaus);
+      }
+    
+    if(dist_mode == maha_dist)
+      {
+      mah_aux = var(X,1,1);
+      
+      const uword mah_aux_n_elem = mah_aux.n_elem;
+            eT*   mah_aux_mem    = mah_aux.memptr();
+      
+      for(uword i=0; i < mah_aux_n_elem; ++i)
+        {
+        const eT val = mah_aux_mem[i];
+        
+        mah_aux_mem[i] = ((val != eT(0)) && arma_isfinite(val)) ? eT(1) / val : eT(1);
+        }
+      }
+    
+    if(seed_mode != keep_existing)
+      {
+      if(print_mode)  { get_stream_err2() << "gmm_diag::learn_online(): generating initial means\n"; }
+      
+           if(dist_mode == eucl_dist)  { generate_initial_means<1>(X, seed_mode); }
+      else if(dist_mode == maha_dist)  { generate_initial_means<2>(X, seed_mode); }
+      }
+    
+    online_km_counts.zeros(N_gaus);
+    }
+  else
+    {
+    if( (X.n_rows != means.n_rows) || (N_gaus != means.n_cols) )
+      {
+      arma_debug_warn("gmm_diag::learn_online(): dimensionality or number of gaussians differs from model");
+      return false;
+      }
+    }
+  
+  const eT vfloor = (eT(var_floor) > eT(0)) ? eT(var_floor) : std::numeric_limits<eT>::min();
+  
+  const arma_ostream_state stream_state(get_stream_err2());
+  
+  if(online_n_batches < km_batches)
+    {
+    // mini-batch k-means
+    
+         if(dist_mode == eucl_dist)  { km_online_update<1>(X); }
+    else if(dist_mode == maha_dist)  { km_online_update<2>(X); }
+    
+    if(print_mode)  { get_stream_err2() << "gmm_diag::learn_online(): k-means: batch: " << (online_n_batches+1) << '\n'; }
+    }
+  else
+    {
+    // stepwise EM
+    
+    if(online_acc_hefts.is_empty())
+      {
+      if(seed_mode != keep_existing)
+        {
+        if(print_mode)  { get_stream_err2() << "gmm_diag::learn_online(): generating initial covariances\n"; }
+        
+             if(dist_mode == eucl_dist)  { generate_initial_dcovs_and_hefts<1>(X, vfloor); }
+        else if(dist_mode == maha_dist)  { generate_initial_dcovs_and_hefts<2>(X, vfloor); }
+        }
+      
+      online_acc_hefts = hefts;
+      online_acc_means = means;
+      online_acc_dcovs = dcovs + square(means);
+      
+      online_acc_means.each_row() %= hefts;
+      online_acc_dcovs.each_row() %= hefts;
+      }
+    
+    em_online_update(X, online_n_batches - (std::min)(online_n_batches, km_batches), vfloor, decay, print_mode);
+    }
+  
+  stream_state.restore(get_stream_err2());
+  
+  init_constants();
+  
+  if( (means.is_finite() == false) || (dcovs.is_finite() == false) || (hefts.is_finite() == false) )
+    {
+    arma_debug_warn("gmm_diag::learn_online(): model update failed");
+    init(orig);
+    return false;
+    }
+  
+  ++online_n_batches;
+  
+  return true;
+  }
+
+
+
+//! forget the state of learn_online(), so that the next batch starts a new learning run
+template<typename eT>
+inline
+void
+gmm_diag<eT>::reset_online()
+  {
+  arma_extra_debug_sigprint();
+  
+  online_n_batches = 0;
+  
+  online_km_counts.reset();
+  online_acc_hefts.reset();
+  online_acc_means.reset();
+  online_acc_dcovs.reset();
+  }
+
+
+
+//! run the parallel operations on the given executor, eg. one that submits the tasks to a thread pool,
+//! or an omp_executor with a limit on the number of threads; the executor must outlive its use by the model.
+//! as this modifies the model, it must be done before the model is used by several threads at once
+template<typename eT>
+inline
+void
+gmm_diag<eT>::set_executor(executor& in_exec)
+  {
+  arma_extra_debug_sigprint();
+  
+  exec_ptr = &in_exec;
+  }
+
+
+
+//! run the parallel operations on the default executor
+template<typename eT>
+inline
+void
+gmm_diag<eT>::set_executor()
+  {
+  arma_extra_debug_sigprint();
+  
+  exec_ptr = 0;
+  }
+
+
+
 //
 //
 //
@@ -872,6 +1094,16 @@ gmm_diag<eT>::init(const gmm_diag<eT>& x)
     access::rw(t.dcovs) = x.dcovs;
     access::rw(t.hefts) = x.hefts;
     
+    t.online_n_batches = x.online_n_batches;
+    t.online_km_counts = x.online_km_counts;
+    t.online_acc_hefts = x.online_acc_hefts;
+    t.online_acc_means = x.online_acc_means;
+    t.online_acc_dcovs = x.online_acc_dcovs;
+    
+    t.mah_aux = x.mah_aux;
+    
+    t.exec_ptr = x.exec_ptr;
+    
     init_constants();
     }
   }
@@ -893,6 +1125,8 @@ gmm_diag<eT>::init(const uword in_n_dims, const uword in_n_gaus)
   
   access::rw(hefts).fill(eT(1) / eT(in_n_gaus));
   
+  reset_online();
+  
   init_constants();
   }
 
@@ -931,6 +1165,8 @@ gmm_diag<eT>::init_constants()
 
 
 
+//! chunks of vectors for the tasks of a parallel operation: at most one chunk per thread of the executor,
+//! and only one chunk when there is too little work to make use of several threads
 template<typename eT>
 inline
 umat
@@ -938,17 +1174,14 @@ gmm_diag<eT>::internal_gen_boundaries(const uword N) const
   {
   arma_extra_debug_sigprint();
   
-  #if defined(_OPENMP)
-    // const uword n_cores = 0;
-    const uword n_cores   = uword(omp_get_num_procs());
-    const uword n_threads = (n_cores > 0) ? ( (n_cores <= N) ? n_cores : 1 ) : 1;
-  #else
-    // static const uword n_cores   = 0;
-    static const uword n_threads = 1;
-  #endif
+  const uword n_threads_max = get_executor().n_threads();
+  
+  const double work_per_vec = double( (std::max)( uword(1), means.n_rows * means.n_cols ) );
+  const double work_min     = double(65536);  // minimum number of distance terms per chunk
   
-  // get_stream_err2() << "gmm_diag::internal_gen_boundaries(): n_cores:   " << n_cores   << '\n';
-  // get_stream_err2() << "gmm_diag::internal_gen_boundaries(): n_threads: " << n_threads << '\n';
+  const uword n_threads_work = uword( (std::min)( double(N) * work_per_vec / work_min, double(n_threads_max) ) );
+  
+  const uword n_threads = (std::max)( uword(1), (std::min)(n_threads_work, N) );
   
   umat boundaries(2, n_threads);
   
@@ -974,13 +1207,22 @@ gmm_diag<eT>::internal_gen_boundaries(const uword N) const
     boundaries.zeros();
     }
   
-  // get_stream_err2() << "gmm_diag::internal_gen_boundaries(): boundaries: " << '\n' << boundaries << '\n';
-  
   return boundaries;
   }
 
 
 
+//! the executor given to set_executor(), or the default executor
+template<typename eT>
+inline
+executor&
+gmm_diag<eT>::get_executor() const
+  {
+  return (exec_ptr != 0) ? (*exec_ptr) : default_executor();
+  }
+
+
+
 template<typename eT>
 arma_hot
 inline
@@ -1072,38 +1314,33 @@ gmm_diag<eT>::internal_vec_log_p(const T1& X) const
   
   if(N > 0)
     {
-    #if defined(_OPENMP)
+    struct job_type : public executor_job
       {
-      const arma_omp_state save_omp_state;
-      
-      const umat boundaries = internal_gen_boundaries(N);
+      const gmm_diag<eT>& model;
+      const T1&           X;
+      const umat&         boundaries;
+            eT*           out_mem;
       
-      const uword n_threads = boundaries.n_cols;
+      inline job_type(const gmm_diag<eT>& in_model, const T1& in_X, const umat& in_boundaries, eT* in_out_mem)
+        : model(in_model), X(in_X), boundaries(in_boundaries), out_mem(in_out_mem) {}
       
-      #pragma omp parallel for
-      for(uword t=0; t < n_threads; ++t)
+      inline void run_task(const uword t)
         {
         const uword start_index = boundaries.at(0,t);
         const uword   end_index = boundaries.at(1,t);
         
-        eT* out_mem = out.memptr();
-        
         for(uword i=start_index; i <= end_index; ++i)
           {
-          out_mem[i] = internal_scalar_log_p( X.colptr(i) );
+          out_mem[i] = model.internal_scalar_log_p( X.colptr(i) );
           }
         }
-      }
-    #else
-      {
-      eT* out_mem = out.memptr();
-      
-      for(uword i=0; i < N; ++i)
-        {
-        out_mem[i] = internal_scalar_log_p( X.colptr(i) );
-        }
-      }
-    #endif
+      };
+    
+    const umat boundaries = internal_gen_boundaries(N);
+    
+    job_type job(*this, X, boundaries, out.memptr());
+    
+    get_executor().run(job, boundaries.n_cols);
     }
   
   return out;
@@ -1128,38 +1365,34 @@ gmm_diag<eT>::internal_vec_log_p(const T1& X, const uword gaus_id) const
   
   if(N > 0)
     {
-    #if defined(_OPENMP)
+    struct job_type : public executor_job
       {
-      const arma_omp_state save_omp_state;
+      const gmm_diag<eT>& model;
+      const T1&           X;
+      const umat&         boundaries;
+      const uword         gaus_id;
+            eT*           out_mem;
       
-      const umat boundaries = internal_gen_boundaries(N);
+      inline job_type(const gmm_diag<eT>& in_model, const T1& in_X, const umat& in_boundaries, const uword in_gaus_id, eT* in_out_mem)
+        : model(in_model), X(in_X), boundaries(in_boundaries), gaus_id(in_gaus_id), out_mem(in_out_mem) {}
       
-      const uword n_threads = boundaries.n_cols;
-      
-      #pragma omp parallel for
-      for(uword t=0; t < n_threads; ++t)
+      inline void run_task(const uword t)
         {
         const uword start_index = boundaries.at(0,t);
         const uword   end_index = boundaries.at(1,t);
         
-        eT* out_mem = out.memptr();
-        
         for(uword i=start_index; i <= end_index; ++i)
           {
-          out_mem[i] = internal_scalar_log_p( X.colptr(i), gaus_id );
+          out_mem[i] = model.internal_scalar_log_p( X.colptr(i), gaus_id );
           }
         }
-      }
-    #else
-      {
-      eT* out_mem = out.memptr();
-      
-      for(uword i=0; i < N; ++i)
-        {
-        out_mem[i] = internal_scalar_log_p( X.colptr(i), gaus_id );
-        }
-      }
-    #endif
+      };
+    
+    const umat boundaries = internal_gen_boundaries(N);
+    
+    job_type job(*this, X, boundaries, gaus_id, out.memptr());
+    
+    get_executor().run(job, boundaries.n_cols);
     }
   
   return out;
@@ -1182,19 +1415,17 @@ gmm_diag<eT>::internal_avg_log_p(const T1& X) const
   if(N == 0)  { return (-Datum<eT>::inf); }
   
   
-  #if defined(_OPENMP)
+  struct job_type : public executor_job
     {
-    const arma_omp_state save_omp_state;
-    
-    const umat boundaries = internal_gen_boundaries(N);
-    
-    const uword n_threads = boundaries.n_cols;
+    const gmm_diag<eT>&               model;
+    const T1&                         X;
+    const umat&                       boundaries;
+    field< running_mean_scalar<eT> >& t_running_means;
     
-    field< running_mean_scalar<eT> > t_running_means(n_threads);
+    inline job_type(const gmm_diag<eT>& in_model, const T1& in_X, const umat& in_boundaries, field< running_mean_scalar<eT> >& in_t_running_means)
+      : model(in_model), X(in_X), boundaries(in_boundaries), t_running_means(in_t_running_means) {}
     
-    
-    #pragma omp parallel for
-    for(uword t=0; t < n_threads; ++t)
+    inline void run_task(const uword t)
       {
       const uword start_index = boundaries.at(0,t);
       const uword   end_index = boundaries.at(1,t);
@@ -1203,36 +1434,33 @@ gmm_diag<eT>::internal_avg_log_p(const T1& X) const
       
       for(uword i=start_index; i <= end_index; ++i)
         {
-        current_running_mean( internal_scalar_log_p( X.colptr(i) ) );
+        current_running_mean( model.internal_scalar_log_p( X.colptr(i) ) );
         }
       }
-    
-    
-    eT avg = eT(0);
-    
-    for(uword t=0; t < n_threads; ++t)
-      {
-      running_mean_scalar<eT>& current_running_mean = t_running_means[t];
-      
-      const eT w = eT(current_running_mean.count()) / eT(N);
-      
-      avg += w * current_running_mean.mean();
-      }
-    
-    return avg;
-    }
-  #else
+    };
+  
+  const umat boundaries = internal_gen_boundaries(N);
+  
+  const uword n_threads = boundaries.n_cols;
+  
+  field< running_mean_scalar<eT> > t_running_means(n_threads);
+  
+  job_type job(*this, X, boundaries, t_running_means);
+  
+  get_executor().run(job, n_threads);
+  
+  eT avg = eT(0);
+  
+  for(uword t=0; t < n_threads; ++t)
     {
-    running_mean_scalar<eT> running_mean;
+    running_mean_scalar<eT>& current_running_mean = t_running_means[t];
     
-    for(uword i=0; i<N; ++i)
-      {
-      running_mean( internal_scalar_log_p( X.colptr(i) ) );
-      }
+    const eT w = eT(current_running_mean.count()) / eT(N);
     
-    return running_mean.mean();
+    avg += w * current_running_mean.mean();
     }
-  #endif
+  
+  return avg;
   }
 
 
@@ -1253,19 +1481,18 @@ gmm_diag<eT>::internal_avg_log_p(const T1& X, const uword gaus_id) const
   if(N == 0)  { return (-Datum<eT>::inf); }
   
   
-  #if defined(_OPENMP)
+  struct job_type : public executor_job
     {
-    const arma_omp_state save_omp_state;
-    
-    const umat boundaries = internal_gen_boundaries(N);
-    
-    const uword n_threads = boundaries.n_cols;
-    
-    field< running_mean_scalar<eT> > t_running_means(n_threads);
+    const gmm_diag<eT>&               model;
+    const T1&                         X;
+    const umat&                       boundaries;
+    const uword                       gaus_id;
+    field< running_mean_scalar<eT> >& t_running_means;
     
+    inline job_type(const gmm_diag<eT>& in_model, const T1& in_X, const umat& in_boundaries, const uword in_gaus_id, field< running_mean_scalar<eT> >& in_t_running_means)
+      : model(in_model), X(in_X), boundaries(in_boundaries), gaus_id(in_gaus_id), t_running_means(in_t_running_means) {}
     
-    #pragma omp parallel for
-    for(uword t=0; t < n_threads; ++t)
+    inline void run_task(const uword t)
       {
       const uword start_index = boundaries.at(0,t);
       const uword   end_index = boundaries.at(1,t);
@@ -1274,36 +1501,33 @@ gmm_diag<eT>::internal_avg_log_p(const T1& X, const uword gaus_id) const
       
       for(uword i=start_index; i <= end_index; ++i)
         {
-        current_running_mean( internal_scalar_log_p( X.colptr(i), gaus_id) );
+        current_running_mean( model.internal_scalar_log_p( X.colptr(i), gaus_id ) );
         }
       }
-    
-    
-    eT avg = eT(0);
-    
-    for(uword t=0; t < n_threads; ++t)
-      {
-      running_mean_scalar<eT>& current_running_mean = t_running_means[t];
-      
-      const eT w = eT(current_running_mean.count()) / eT(N);
-      
-      avg += w * current_running_mean.mean();
-      }
-    
-    return avg;
-    }
-  #else
+    };
+  
+  const umat boundaries = internal_gen_boundaries(N);
+  
+  const uword n_threads = boundaries.n_cols;
+  
+  field< running_mean_scalar<eT> > t_running_means(n_threads);
+  
+  job_type job(*this, X, boundaries, gaus_id, t_running_means);
+  
+  get_executor().run(job, n_threads);
+  
+  eT avg = eT(0);
+  
+  for(uword t=0; t < n_threads; ++t)
     {
-    running_mean_scalar<eT> running_mean;
+    running_mean_scalar<eT>& current_running_mean = t_running_means[t];
     
-    for(uword i=0; i<N; ++i)
-      {
-      running_mean( internal_scalar_log_p( X.colptr(i), gaus_id ) );
-      }
+    const eT w = eT(current_running_mean.count()) / eT(N);
     
-    return running_mean.mean();
+    avg += w * current_running_mean.mean();
     }
-  #endif
+  
+  return avg;
   }
 
 
@@ -1386,15 +1610,58 @@ gmm_diag<eT>::internal_vec_assign(urowvec& out, const T1& X, const gmm_dist_mode
   
   arma_debug_check( (X.n_rows != N_dims), "gmm_diag::assign(): incompatible dimensions" );
   
+  arma_debug_check( ((dist_mode != eucl_dist) && (dist_mode != prob_dist)), "gmm_diag::assign(): unsupported distance mode" );
+  
   const uword X_n_cols = (N_gaus > 0) ? X.n_cols : 0;
   
   out.set_size(1,X_n_cols);
   
-  uword* out_mem = out.memptr();
+  if(X_n_cols == 0)  { return; }
+  
+  struct job_type : public executor_job
+    {
+    const gmm_diag<eT>&  model;
+    const T1&            X;
+    const umat&          boundaries;
+    const gmm_dist_mode& dist_mode;
+          uword*         out_mem;
+    
+    inline job_type(const gmm_diag<eT>& in_model, const T1& in_X, const umat& in_boundaries, const gmm_dist_mode& in_dist_mode, uword* in_out_mem)
+      : model(in_model), X(in_X), boundaries(in_boundaries), dist_mode(in_dist_mode), out_mem(in_out_mem) {}
+    
+    inline void run_task(const uword t)
+      {
+      const uword start_index = boundaries.at(0,t);
+      const uword   end_index = boundaries.at(1,t);
+      
+      model.internal_vec_assign_worker(&(out_mem[start_index]), X, start_index, end_index, dist_mode);
+      }
+    };
+  
+  const umat boundaries = internal_gen_boundaries(X_n_cols);
+  
+  job_type job(*this, X, boundaries, dist_mode, out.memptr());
+  
+  get_executor().run(job, boundaries.n_cols);
+  }
+
+
+
+//! assignments of vectors start_index to end_index, written to out_mem[0] onwards
+template<typename eT>
+template<typename T1>
+inline
+void
+gmm_diag<eT>::internal_vec_assign_worker(uword* out_mem, const T1& X, const uword start_index, const uword end_index, const gmm_dist_mode& dist_mode) const
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword N_dims = means.n_rows;
+  const uword N_gaus = means.n_cols;
   
   if(dist_mode == eucl_dist)
     {
-    for(uword i=0; i<X_n_cols; ++i)
+    for(uword i=start_index; i <= end_index; ++i)
       {
       const eT* X_colptr = X.colptr(i);
        
@@ -1412,7 +1679,7 @@ gmm_diag<eT>::internal_vec_assign(urowvec& out, const T1& X, const gmm_dist_mode
           }
         }
       
-      out_mem[i] = best_g;
+      out_mem[i - start_index] = best_g;
       }
     }
   else
@@ -1420,7 +1687,7 @@ gmm_diag<eT>::internal_vec_assign(urowvec& out, const T1& X, const gmm_dist_mode
     {
     const eT* log_hefts_mem = log_hefts.memptr();
     
-    for(uword i=0; i<X_n_cols; ++i)
+    for(uword i=start_index; i <= end_index; ++i)
       {
       const eT* X_colptr = X.colptr(i);
        
@@ -1438,13 +1705,9 @@ gmm_diag<eT>::internal_vec_assign(urowvec& out, const T1& X, const gmm_dist_mode
           }
         }
       
-      out_mem[i] = best_g;
+      out_mem[i - start_index] = best_g;
       }
     }
-  else
-    {
-    arma_debug_check(true, "gmm_diag::assign(): unsupported distance mode");
-    }
   }
 
 
@@ -1457,66 +1720,63 @@ gmm_diag<eT>::internal_raw_hist(urowvec& hist, const Mat<eT>& X, const gmm_dist_
   {
   arma_extra_debug_sigprint();
   
-  const uword N_dims = means.n_rows;
   const uword N_gaus = means.n_cols;
   
   const uword X_n_cols = X.n_cols;
   
   hist.zeros(N_gaus);
   
-  if(N_gaus == 0)  { return; }
+  if( (N_gaus == 0) || (X_n_cols == 0) )  { return; }
   
-  uword* hist_mem = hist.memptr();
+  // each task counts the assignments of its chunk of vectors, which are obtained in blocks
   
-  if(dist_mode == eucl_dist)
+  struct job_type : public executor_job
     {
-    for(uword i=0; i<X_n_cols; ++i)
+    const gmm_diag<eT>&  model;
+    const Mat<eT>&       X;
+    const umat&          boundaries;
+    const gmm_dist_mode& dist_mode;
+          umat&          t_hist;
+    
+    inline job_type(const gmm_diag<eT>& in_model, const Mat<eT>& in_X, const umat& in_boundaries, const gmm_dist_mode& in_dist_mode, umat& in_t_hist)
+      : model(in_model), X(in_X), boundaries(in_boundaries), dist_mode(in_dist_mode), t_hist(in_t_hist) {}
+    
+    inline void run_task(const uword t)
       {
-      const eT* X_colptr = X.colptr(i);
-       
-      eT    best_dist = Datum<eT>::inf;
-      uword best_g    = 0;
+      const uword start_index = boundaries.at(0,t);
+      const uword   end_index = boundaries.at(1,t);
       
-      for(uword g=0; g < N_gaus; ++g)
-        {
-        const eT tmp_dist = distance<eT,1>::eval(N_dims, X_colptr, means.colptr(g), X_colptr);
-        
-        if(tmp_dist <= best_dist)
-          {
-          best_dist = tmp_dist;
-          best_g    = g;
-          }
-        }
+      const uword block_size = 1024;
       
-      hist_mem[best_g]++;
-      }
-    }
-  else
-  if(dist_mode == prob_dist)
-    {
-    const eT* log_hefts_mem = log_hefts.memptr();
-    
-    for(uword i=0; i<X_n_cols; ++i)
-      {
-      const eT* X_colptr = X.colptr(i);
-        
-      eT    best_p = -Datum<eT>::inf;
-      uword best_g = 0;
+      podarray<uword> ids(block_size);
       
-      for(uword g=0; g < N_gaus; ++g)
+      uword* ids_mem  = ids.memptr();
+      uword* hist_mem = t_hist.colptr(t);
+      
+      for(uword block_start = start_index; block_start <= end_index; block_start += block_size)
         {
-        const eT tmp_p = internal_scalar_log_p(X_colptr, g) + log_hefts_mem[g];
+        const uword block_end = (std::min)(block_start + block_size - 1, end_index);
         
-        if(tmp_p >= best_p)
-          {
-          best_p = tmp_p;
-          best_g = g;
-          }
+        model.internal_vec_assign_worker(ids_mem, X, block_start, block_end, dist_mode);
+        
+        for(uword i=0; i <= (block_end - block_start); ++i)  { hist_mem[ ids_mem[i] ]++; }
         }
-      
-      hist_mem[best_g]++;
       }
-    }
+    };
+  
+  const umat boundaries = internal_gen_boundaries(X_n_cols);
+  
+  const uword n_threads = boundaries.n_cols;
+  
+  umat t_hist(N_gaus, n_threads, fill::zeros);
+  
+  job_type job(*this, X, boundaries, dist_mode, t_hist);
+  
+  get_executor().run(job, n_threads);
+  
+  uword* hist_mem = hist.memptr();
+  
+  for(uword t=0; t < n_threads; ++t)  { arrayops::inplace_plus(hist_mem, t_hist.colptr(t), N_gaus); }
   }
 
 
@@ -1530,6 +1790,11 @@ gmm_diag<eT>::generate_initial_means(const Mat<eT>& X, const gmm_seed_mode& seed
   const uword N_dims = means.n_rows;
   const uword N_gaus = means.n_cols;
   
+  if(seed_mode == random_kmpp)
+    {
+    generate_kmpp_means<dist_id>(X);
+    }
+  else
   if( (seed_mode == static_subset) || (seed_mode == random_subset) )
     {
     uvec initial_indices;
@@ -1655,6 +1920,9 @@ gmm_diag<eT>::km_iterate(const Mat<eT>& X, const uword max_iter, const bool verb
   {
   arma_extra_debug_sigprint();
   
+  // with many means, the bounds based algorithm avoids most of the distance computations
+  if(means.n_cols >= 8)  { return km_iterate_bounds<dist_id>(X, max_iter, verbose, signature); }
+  
   if(verbose)
     {
     get_stream_err2().unsetf(ios::showbase);
@@ -1674,176 +1942,566 @@ gmm_diag<eT>::km_iterate(const Mat<eT>& X, const uword max_iter, const bool verb
   
   running_mean_scalar<double> rs_delta;
   
-  field< running_mean_vec<eT> > running_means(N_gaus);
+  uvec counts(N_gaus);
+  uvec last_indices(N_gaus);
   
   const eT* mah_aux_mem = mah_aux.memptr();
   
   
-  #if defined(_OPENMP)
-    const arma_omp_state save_omp_state;
+  // km_update_stats() is the "map" operation, which produces partial means
+  
+  struct job_type : public executor_job
+    {
+    const gmm_diag<eT>&                     model;
+    const Mat<eT>&                          X;
+    const umat&                             boundaries;
+    const Mat<eT>&                          old_means;
+    field< field< running_mean_vec<eT> > >& t_running_means;
     
-    const umat boundaries = internal_gen_boundaries(X.n_cols);
+    inline job_type(const gmm_diag<eT>& in_model, const Mat<eT>& in_X, const umat& in_boundaries, const Mat<eT>& in_old_means, field< field< running_mean_vec<eT> > >& in_t_running_means)
+      : model(in_model), X(in_X), boundaries(in_boundaries), old_means(in_old_means), t_running_means(in_t_running_means) {}
+    
+    inline void run_task(const uword t)
+      {
+      model.template km_update_stats<dist_id>(X, boundaries.at(0,t), boundaries.at(1,t), old_means, t_running_means[t]);
+      }
+    };
+  
+  const umat boundaries = internal_gen_boundaries(X.n_cols);
+  
+  const uword n_threads = boundaries.n_cols;
+  
+  field< field< running_mean_vec<eT> > > t_running_means(n_threads);
+  
+  for(uword t=0; t < n_threads; ++t)  { t_running_means[t].set_size(N_gaus); }
+  
+  Col<eT> tmp_mean(N_dims);
+  
+  job_type job(*this, X, boundaries, old_means, t_running_means);
+  
+  if(verbose)
+    {
+    get_stream_err2() << signature << ": n_threads: " << n_threads  << '\n';
+    }
+  
+  
+  for(uword iter=1; iter <= max_iter; ++iter)
+    {
+    for(uword t=0; t < n_threads; ++t)
+      {
+      for(uword g=0; g < N_gaus; ++g)  { t_running_means[t][g].reset(); }
+      }
     
-    const uword n_threads = boundaries.n_cols;
+    get_executor().run(job, n_threads);
     
-    field< field< running_mean_vec<eT> > > t_running_means(n_threads);
     
-    for(uword t=0; t < n_threads; ++t)  { t_running_means[t].set_size(N_gaus); }
+    // the "reduce" operation, which combines the partial means produced by the separate threads;
+    // takes into account the counts for each mean
     
-    Col<eT> tmp_mean(N_dims);
+    uword n_dead_means = 0;
+    
+    for(uword g=0; g < N_gaus; ++g)
+      {
+      uword total_count = 0;
+      
+      for(uword t=0; t < n_threads; ++t)  { total_count += t_running_means[t][g].count(); }
+      
+      counts[g]       = total_count;
+      last_indices[g] = 0;
+      
+      if(total_count == 0)  { n_dead_means++; continue; }
+      
+      tmp_mean.zeros();
+      
+      for(uword t=0; t < n_threads; ++t)
+        {
+        const eT w = eT(t_running_means[t][g].count()) / eT(total_count);
+        
+        if(w > eT(0))
+          {
+          tmp_mean += w * t_running_means[t][g].mean();
+          
+          last_indices[g] = t_running_means[t][g].last_index();
+          }
+        }
+      
+      new_means.col(g) = tmp_mean;
+      }
+    
+    // heuristics to resurrect dead means
+    
+    if(n_dead_means > 0)
+      {
+      if(km_fix_dead_means(new_means, counts.memptr(), last_indices.memptr(), X, verbose, signature) == false)  { return false; }
+      }
+    
+    rs_delta.reset();
+    
+    for(uword g=0; g < N_gaus; ++g)
+      {
+      rs_delta( distance<eT,dist_id>::eval(N_dims, old_means.colptr(g), new_means.colptr(g), mah_aux_mem) );
+      }
     
     if(verbose)
       {
-      get_stream_err2() << signature << ": n_threads: " << n_threads  << '\n';
+      get_stream_err2() << signature << ": iteration: ";
+      get_stream_err2().unsetf(ios::scientific);
+      get_stream_err2().setf(ios::fixed);
+      get_stream_err2().width(std::streamsize(4));
+      get_stream_err2() << iter;
+      get_stream_err2() << "   delta: ";
+      get_stream_err2().unsetf(ios::fixed);
+      //get_stream_err2().setf(ios::scientific);
+      get_stream_err2() << rs_delta.mean() << '\n';
       }
-  #endif
+    
+    arma::swap(old_means, new_means);
+    
+    if(rs_delta.mean() <= Datum<eT>::eps)  { break; }
+    }
   
+  access::rw(means) = old_means;
   
-  for(uword iter=1; iter <= max_iter; ++iter)
+  return true;
+  }
+
+
+
+template<typename eT>
+template<uword dist_id>
+inline
+void
+gmm_diag<eT>::km_update_stats(const Mat<eT>& X, const uword start_index, const uword end_index, const Mat<eT>& old_means, field< running_mean_vec<eT> >& running_means) const
+  {
+  arma_extra_debug_sigprint();
+  
+  // get_stream_err2() << "km_update_stats(): start_index: " << start_index << '\n';
+  // get_stream_err2() << "km_update_stats():   end_index: " <<   end_index << '\n';
+  
+  const uword N_dims = means.n_rows;
+  const uword N_gaus = means.n_cols;
+  
+  const eT* mah_aux_mem = mah_aux.memptr();
+  
+  for(uword i=start_index; i <= end_index; ++i)
     {
-    #if defined(_OPENMP)
+    const eT* X_colptr = X.colptr(i);
+    
+    double best_dist = Datum<eT>::inf;
+    uword  best_g    = 0;
+    
+    for(uword g=0; g < N_gaus; ++g)
       {
-      for(uword t=0; t < n_threads; ++t)
-        {
-        for(uword g=0; g < N_gaus; ++g)  { t_running_means[t][g].reset(); }
-        }
+      const double dist = distance<eT,dist_id>::eval(N_dims, X_colptr, old_means.colptr(g), mah_aux_mem);
       
+      // get_stream_err2() << "g: " << g << "   dist: " << dist << '\n';
+      // old_means.col(g).print("old_means.col(g):");
+      // vec tmp(old_means.colptr(g), old_means.n_rows);
+      // tmp.print("tmp:");
       
-      // km_update_stats() is the "map" operation, which produces partial means
+      if(dist <= best_dist)  { best_dist = dist; best_g = g; }
+      }
+    
+    // get_stream_err2() << "best_g: " << best_g << '\n';
+    
+    running_means[best_g]( X.unsafe_col(i), i );
+    }
+  }
+
+
+
+//! heuristics to resurrect dead means (ie. means without any assigned vectors),
+//! given the number of vectors assigned to each mean and the index of the last vector assigned to each mean
+template<typename eT>
+inline
+bool
+gmm_diag<eT>::km_fix_dead_means(Mat<eT>& new_means, const uword* counts, const uword* last_indices, const Mat<eT>& X, const bool verbose, const char* signature) const
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword N_gaus = new_means.n_cols;
+  
+  uword n_dead_means = 0;
+  
+  for(uword g=0; g < N_gaus; ++g)
+    {
+    if(counts[g] == 0)  { n_dead_means++; }
+    }
+  
+  if(n_dead_means == 0)  { return true; }
+  
+  if(verbose)  { get_stream_err2() << signature << ": recovering from dead means\n"; }
+  
+  if(n_dead_means == 1)
+    {
+    uword dead_g         = 0;
+    uword populous_g     = 0;
+    uword populous_count = counts[0];
+    
+    for(uword g=1; g < N_gaus; ++g)
+      {
+      const uword count = counts[g];
       
-      #pragma omp parallel for
-      for(uword t=0; t < n_threads; ++t)
+      if(count == 0)  { dead_g = g; }
+      
+      if(populous_count < count)
+        {
+        populous_count = count;
+        populous_g     = g;
+        }
+      }
+    
+    if( (populous_count <= 2) || (dead_g == populous_g) )  { return false; }
+    
+    new_means.col(dead_g) = X.unsafe_col( last_indices[populous_g] );
+    }
+  else
+    {
+    uword n_resurrected_means = 0;
+    
+    uword dead_g = 0;
+    
+    for(uword live_g = 0; live_g < N_gaus; ++live_g)
+      {
+      if(counts[live_g] >= 2)
         {
-        field< running_mean_vec<eT> >& current_running_means = t_running_means[t];
+        for(; dead_g < N_gaus; ++dead_g)
+          {
+          if(counts[dead_g] == 0)  { break; }
+          }
         
-        km_update_stats<dist_id>(X, boundaries.at(0,t), boundaries.at(1,t), old_means, current_running_means);
+        if(dead_g == N_gaus)  { break; }
+        
+        new_means.col(dead_g) = X.unsafe_col( last_indices[live_g] );
+        
+        dead_g++;
+        n_resurrected_means++;
         }
+      }
+    
+    if(n_resurrected_means != n_dead_means)
+      {
+      if(verbose)  { get_stream_err2() << signature << ": WARNING: did not resurrect all dead means\n"; }
+      }
+    }
+  
+  return true;
+  }
+
+
+
+//! k-means++ seeding: the first mean is a randomly selected vector,
+//! and each further mean is a vector selected with probability proportional to its distance to the nearest mean selected so far;
+//! the distances are updated in parallel, and the selection only scans the chunk of vectors in which the random threshold falls
+template<typename eT>
+template<uword dist_id>
+inline
+void
+gmm_diag<eT>::generate_kmpp_means(const Mat<eT>& X)
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword N_gaus = means.n_cols;
+  const uword N      = X.n_cols;
+  
+  const eT* mah_aux_mem = mah_aux.memptr();
+  
+  podarray<eT> min_dist(N);
+  
+  eT* min_dist_mem = min_dist.memptr();
+  
+  const umat  boundaries = internal_gen_boundaries(N);
+  const uword n_threads  = boundaries.n_cols;
+  
+  podarray<double> t_sum(n_threads);
+  
+  uword index = as_scalar(randi<uvec>(1, distr_param(0,N-1)));
+  
+  access::rw(means).col(0) = X.unsafe_col(index);
+  
+  // each task updates the distances of its chunk of vectors to the nearest mean, given the newest mean
+  
+  struct job_type : public executor_job
+    {
+    const Mat<eT>& X;
+    const umat&    boundaries;
+    const eT*      mah_aux_mem;
+          eT*      min_dist_mem;
+          double*  t_sum_mem;
+    
+    const eT*      mean_mem;   // the newest mean
+          bool     first;      // the newest mean is the first mean
+    
+    inline job_type(const Mat<eT>& in_X, const umat& in_boundaries, const eT* in_mah_aux_mem, eT* in_min_dist_mem, double* in_t_sum_mem)
+      : X(in_X), boundaries(in_boundaries), mah_aux_mem(in_mah_aux_mem), min_dist_mem(in_min_dist_mem), t_sum_mem(in_t_sum_mem), mean_mem(0), first(true) {}
+    
+    inline void run_task(const uword t)
+      {
+      const uword N_dims = X.n_rows;
       
+      const uword start_index = boundaries.at(0,t);
+      const uword   end_index = boundaries.at(1,t);
       
-      // the "reduce" operation, which combines the partial means produced by the separate threads;
-      // takes into account the counts for each mean
+      double acc = double(0);
       
-      for(uword g=0; g < N_gaus; ++g)
+      for(uword i=start_index; i <= end_index; ++i)
         {
-        uword total_count = 0;
-        
-        for(uword t=0; t < n_threads; ++t)  { total_count += t_running_means[t][g].count(); }
+        const eT dist = distance<eT,dist_id>::eval(N_dims, X.colptr(i), mean_mem, mah_aux_mem);
         
-        tmp_mean.zeros();
+        if( first || (dist < min_dist_mem[i]) )  { min_dist_mem[i] = dist; }
         
-        bool  dead       = true;
-        uword last_index = 0;
+        acc += double(min_dist_mem[i]);
+        }
+      
+      t_sum_mem[t] = acc;
+      }
+    };
+  
+  job_type job(X, boundaries, mah_aux_mem, min_dist_mem, t_sum.memptr());
+  
+  for(uword g=1; g < N_gaus; ++g)
+    {
+    job.mean_mem = means.colptr(g-1);
+    job.first    = (g == 1);
+    
+    get_executor().run(job, n_threads);
+    
+    double total = double(0);
+    
+    for(uword t=0; t < n_threads; ++t)  { total += t_sum[t]; }
+    
+    if(total > double(0))
+      {
+      double r = double(as_scalar(randu<vec>(1))) * total;
+      
+      // find the chunk and then the vector where the cumulative sum exceeds r;
+      // in case of rounding errors, the last chunk and vector with a non-zero distance are used
+      
+      uword chunk = 0;
+      
+      for(uword t=0; t < n_threads; ++t)
+        {
+        if(t_sum[t] > double(0))  { chunk = t;  if(r < t_sum[t])  { break; } }
         
-        if(total_count > 0)
-          {
-          for(uword t=0; t < n_threads; ++t)
-            {
-            const eT w = eT(t_running_means[t][g].count()) / eT(total_count);
-            
-            if(w > eT(0))
-              {
-              tmp_mean += w * t_running_means[t][g].mean();
-              
-              dead       = false;
-              last_index = t_running_means[t][g].last_index();
-              }
-            }
-          }
+        r -= t_sum[t];
+        }
+      
+      for(uword i=boundaries.at(0,chunk); i <= boundaries.at(1,chunk); ++i)
+        {
+        const double dist = double(min_dist_mem[i]);
         
-        running_means[g].reset();
+        if(dist > double(0))  { index = i;  if(r < dist)  { break; } }
         
-        if(dead == false)  { running_means[g](tmp_mean, last_index); }
+        r -= dist;
         }
       }
-    #else
+    else
       {
-      for(uword g=0; g < N_gaus; ++g)  { running_means[g].reset(); }
-      
-      km_update_stats<dist_id>(X, 0, X.n_cols-1, old_means, running_means);
+      // all vectors coincide with the means so far
+      index = as_scalar(randi<uvec>(1, distr_param(0,N-1)));
       }
-    #endif
     
-    uword n_dead_means = 0;
+    access::rw(means).col(g) = X.unsafe_col(index);
+    }
+  }
+
+
+
+//! k-means via Hamerly's algorithm: for each vector, an upper bound on the distance to its mean and a lower bound
+//! on the distance to all other means are kept across iterations, and are loosened by the distances the means move;
+//! the distances from a vector to all means are only computed when the bounds cannot rule out a change of mean.
+//! for the first assignment all distances are needed, and are obtained via the matrix product of the means and the vectors.
+//! apart from ties and rounding errors, the means are the same as obtained by km_iterate() with the standard algorithm.
+template<typename eT>
+template<uword dist_id>
+inline
+bool
+gmm_diag<eT>::km_iterate_bounds(const Mat<eT>& X, const uword max_iter, const bool verbose, const char* signature)
+  {
+  arma_extra_debug_sigprint();
+  
+  if(verbose)
+    {
+    get_stream_err2().unsetf(ios::showbase);
+    get_stream_err2().unsetf(ios::uppercase);
+    get_stream_err2().unsetf(ios::showpos);
+    get_stream_err2().unsetf(ios::scientific);
     
-    for(uword g=0; g < N_gaus; ++g)
+    get_stream_err2().setf(ios::right);
+    get_stream_err2().setf(ios::fixed);
+    }
+  
+  const uword N_dims = means.n_rows;
+  const uword N_gaus = means.n_cols;
+  const uword N      = X.n_cols;
+  
+  Mat<eT> old_means = means;
+  Mat<eT> new_means = means;
+  
+  running_mean_scalar<double> rs_delta;
+  
+  const eT* mah_aux_mem = mah_aux.memptr();
+  
+  podarray<uword> assign(N);
+  podarray<eT>    upper(N);
+  podarray<eT>    lower(N);
+  
+  podarray<eT> half_sep(N_gaus);      // half the distance from each mean to the nearest other mean
+  podarray<eT> moved(N_gaus);         // distance each mean moved in the last iteration
+  podarray<eT> lower_shift(N_gaus);   // largest distance moved by any of the other means
+  
+  uvec counts(N_gaus);
+  uvec last_indices(N_gaus);
+  
+  const umat  boundaries = internal_gen_boundaries(N);
+  const uword n_threads  = boundaries.n_cols;
+  
+  field< Mat<eT> > t_acc(n_threads);
+  
+  for(uword t=0; t < n_threads; ++t)  { t_acc[t].set_size(N_dims, N_gaus); }
+  
+  umat t_counts      (N_gaus, n_threads);
+  umat t_last_indices(N_gaus, n_threads);
+  
+  // the tasks are either the initial assignment or the bounds test for each chunk of vectors,
+  // or the separation of each mean from the other means
+  
+  struct job_type : public executor_job
+    {
+    const gmm_diag<eT>& model;
+    const Mat<eT>&      X;
+    const umat&         boundaries;
+    const Mat<eT>&      old_means;
+    
+    uword* assign;
+    eT*    upper;
+    eT*    lower;
+    eT*    half_sep;
+    eT*    moved;
+    eT*    lower_shift;
+    
+    field< Mat<eT> >& t_acc;
+    umat&             t_counts;
+    umat&             t_last_indices;
+    
+    uword stage;  // 0: initial assignment; 1: separation of the means; 2: bounds test
+    
+    inline job_type(const gmm_diag<eT>& in_model, const Mat<eT>& in_X, const umat& in_boundaries, const Mat<eT>& in_old_means, uword* in_assign, eT* in_upper, eT* in_lower, eT* in_half_sep, eT* in_moved, eT* in_lower_shift, field< Mat<eT> >& in_t_acc, umat& in_t_counts, umat& in_t_last_indices)
+      : model(in_model), X(in_X), boundaries(in_boundaries), old_means(in_old_means)
+      , assign(in_assign), upper(in_upper), lower(in_lower), half_sep(in_half_sep), moved(in_moved), lower_shift(in_lower_shift)
+      , t_acc(in_t_acc), t_counts(in_t_counts), t_last_indices(in_t_last_indices), stage(0) {}
+    
+    inline void run_task(const uword t)
       {
-      if(running_means[g].count() > 0)
+      if(stage == 0)
         {
-        new_means.col(g) = running_means[g].mean();
+        model.template km_bounds_init<dist_id>(X, boundaries.at(0,t), boundaries.at(1,t), old_means, assign, upper, lower, t_acc[t], t_counts.colptr(t), t_last_indices.colptr(t));
         }
       else
+      if(stage == 1)
         {
-        n_dead_means++;
+        const uword N_dims = old_means.n_rows;
+        const uword N_gaus = old_means.n_cols;
+        
+        eT min_dist = Datum<eT>::inf;
+        
+        for(uword h=0; h < N_gaus; ++h)
+          {
+          if(h == t)  { continue; }
+          
+          const eT dist = distance<eT,dist_id>::eval(N_dims, old_means.colptr(t), old_means.colptr(h), model.mah_aux.memptr());
+          
+          if(dist < min_dist)  { min_dist = dist; }
+          }
+        
+        half_sep[t] = eT(0.5) * std::sqrt(min_dist);
         }
+      else
+        {
+        model.template km_bounds_update<dist_id>(X, boundaries.at(0,t), boundaries.at(1,t), old_means, half_sep, moved, lower_shift, assign, upper, lower, t_acc[t], t_counts.colptr(t), t_last_indices.colptr(t));
+        }
+      }
+    };
+  
+  job_type job(*this, X, boundaries, old_means, assign.memptr(), upper.memptr(), lower.memptr(), half_sep.memptr(), moved.memptr(), lower_shift.memptr(), t_acc, t_counts, t_last_indices);
+  
+  if(verbose)
+    {
+    get_stream_err2() << signature << ": n_threads: " << n_threads  << '\n';
+    }
+  
+  for(uword iter=1; iter <= max_iter; ++iter)
+    {
+    if(iter == 1)
+      {
+      job.stage = 0;  get_executor().run(job, n_threads);
+      }
+    else
+      {
+      job.stage = 1;  get_executor().run(job, N_gaus   );
+      job.stage = 2;  get_executor().run(job, n_threads);
       }
     
-    // heuristics to resurrect dead means
+    // combine the sums produced by the separate threads
     
-    if(n_dead_means > 0)
+    uword n_dead_means = 0;
+    
+    for(uword g=0; g < N_gaus; ++g)
       {
-      if(verbose)  { get_stream_err2() << signature << ": recovering from dead means\n"; }
+      uword total_count = 0;
+      
+      for(uword t=0; t < n_threads; ++t)
+        {
+        const uword count = t_counts.at(g,t);
+        
+        if(count > 0)  { total_count += count;  last_indices[g] = t_last_indices.at(g,t); }
+        }
+      
+      counts[g] = total_count;
+      
+      eT* new_mean_mem = new_means.colptr(g);
       
-      if(n_dead_means == 1)
+      if(total_count > 0)
         {
-        uword dead_g         = 0;
-        uword populous_g     = 0;
-        uword populous_count = running_means(0).count(); 
+        arrayops::copy(new_mean_mem, t_acc[0].colptr(g), N_dims);
         
-        for(uword g=1; g < N_gaus; ++g)
-          {
-          const uword count = running_means(g).count();
-          
-          if(count == 0)  { dead_g = g; }
-          
-          if(populous_count < count)
-            {
-            populous_count = count;
-            populous_g     = g;
-            }
-          }
+        for(uword t=1; t < n_threads; ++t)  { arrayops::inplace_plus(new_mean_mem, t_acc[t].colptr(g), N_dims); }
         
-        if( (populous_count <= 2) || (dead_g == populous_g) )  { return false; }
-        
-        new_means.col(dead_g) = X.unsafe_col( running_means(populous_g).last_index() );
+        arrayops::inplace_div(new_mean_mem, eT(total_count), N_dims);
         }
       else
         {
-        uword n_resurrected_means = 0;
-        
-        uword dead_g = 0;
-        
-        for(uword live_g = 0; live_g < N_gaus; ++live_g)
-          {
-          if(running_means(live_g).count() >= 2)
-            {
-            for(; dead_g < N_gaus; ++dead_g)
-              {
-              if(running_means(dead_g).count() == 0)  { break; }
-              }
-            
-            if(dead_g == N_gaus)  { break; }
-            
-            new_means.col(dead_g) = X.unsafe_col( running_means(live_g).last_index() );
-            
-            dead_g++;
-            n_resurrected_means++;
-            }
-          }
+        arrayops::copy(new_mean_mem, old_means.colptr(g), N_dims);
         
-        if(n_resurrected_means != n_dead_means)
-          {
-          if(verbose)  { get_stream_err2() << signature << ": WARNING: did not resurrect all dead means\n"; }
-          }
+        n_dead_means++;
         }
       }
     
+    if(n_dead_means > 0)
+      {
+      if(km_fix_dead_means(new_means, counts.memptr(), last_indices.memptr(), X, verbose, signature) == false)  { return false; }
+      }
+    
     rs_delta.reset();
     
+    eT    max_moved    = eT(0);
+    eT    second_moved = eT(0);
+    uword max_moved_g  = 0;
+    
     for(uword g=0; g < N_gaus; ++g)
       {
-      rs_delta( distance<eT,dist_id>::eval(N_dims, old_means.colptr(g), new_means.colptr(g), mah_aux_mem) );
+      const eT dist = distance<eT,dist_id>::eval(N_dims, old_means.colptr(g), new_means.colptr(g), mah_aux_mem);
+      
+      rs_delta(dist);
+      
+      moved[g] = std::sqrt(dist);
+      
+           if(moved[g] > max_moved   )  { second_moved = max_moved;  max_moved = moved[g];  max_moved_g = g; }
+      else if(moved[g] > second_moved)  { second_moved = moved[g];                                           }
       }
     
+    for(uword g=0; g < N_gaus; ++g)  { lower_shift[g] = (g == max_moved_g) ? second_moved : max_moved; }
+    
     if(verbose)
       {
       get_stream_err2() << signature << ": iteration: ";
@@ -1869,44 +2527,232 @@ gmm_diag<eT>::km_iterate(const Mat<eT>& X, const uword max_iter, const bool verb
 
 
 
+//! assigns vectors start_index to end_index to the nearest means and initialises their bounds;
+//! the distances to all means are obtained in blocks via |x|^2 - 2*trans(x)*m + |m|^2, with the matrix product done by gemm();
+//! the sums of the assigned vectors are accumulated in acc
 template<typename eT>
 template<uword dist_id>
 inline
 void
-gmm_diag<eT>::km_update_stats(const Mat<eT>& X, const uword start_index, const uword end_index, const Mat<eT>& old_means, field< running_mean_vec<eT> >& running_means) const
+gmm_diag<eT>::km_bounds_init(const Mat<eT>& X, const uword start_index, const uword end_index, const Mat<eT>& old_means, uword* assign, eT* upper, eT* lower, Mat<eT>& acc, uword* counts, uword* last_indices) const
   {
   arma_extra_debug_sigprint();
   
-  // get_stream_err2() << "km_update_stats(): start_index: " << start_index << '\n';
-  // get_stream_err2() << "km_update_stats():   end_index: " <<   end_index << '\n';
+  const uword N_dims = old_means.n_rows;
+  const uword N_gaus = old_means.n_cols;
   
-  const uword N_dims = means.n_rows;
-  const uword N_gaus = means.n_cols;
+  const eT* mah_aux_mem = mah_aux.memptr();
+  
+  acc.zeros();
+  
+  arrayops::fill_zeros(counts,       N_gaus);
+  arrayops::fill_zeros(last_indices, N_gaus);
+  
+  // the vectors and means are centred on the average mean to reduce the cancellation in the expanded form;
+  // for the Mahalanobis distance, the dimensions are also scaled so that the Euclidean distance can be used
+  
+  const Col<eT> centre = mean(old_means, 1);
+  
+  Col<eT> scale;
+  
+  if(dist_id == 2)  { scale = sqrt(mah_aux); }
+  
+  Mat<eT> M = old_means;
+  
+  M.each_col() -= centre;
+  
+  if(dist_id == 2)  { M.each_col() %= scale; }
+  
+  const Row<eT> M_norms = sum(square(M), 0);
+  
+  const eT* M_norms_mem = M_norms.memptr();
+  
+  const eT M_norms_max = M_norms.max();
+  
+  const uword block_size = 256;
+  
+  Mat<eT> Xb;
+  Mat<eT> G;
+  
+  for(uword block_start = start_index; block_start <= end_index; block_start += block_size)
+    {
+    const uword block_end = (std::min)(block_start + block_size - 1, end_index);
+    
+    Xb = X.cols(block_start, block_end);
+    
+    Xb.each_col() -= centre;
+    
+    if(dist_id == 2)  { Xb.each_col() %= scale; }
+    
+    G = trans(M) * Xb;
+    
+    for(uword j=0; j < Xb.n_cols; ++j)
+      {
+      const eT* Xb_colptr = Xb.colptr(j);
+      const eT* G_colptr  = G.colptr(j);
+      
+      eT    best_dist   = Datum<eT>::inf;
+      eT    second_dist = Datum<eT>::inf;
+      uword best_g      = 0;
+      
+      // |x|^2 is the same for all means, and is added afterwards
+      for(uword g=0; g < N_gaus; ++g)
+        {
+        const eT dist = M_norms_mem[g] - eT(2)*G_colptr[g];
+        
+             if(dist <= best_dist  )  { second_dist = best_dist;  best_dist = dist;  best_g = g; }
+        else if(dist <  second_dist)  { second_dist = dist;                                      }
+        }
+      
+      const eT x_norm = op_dot::direct_dot(N_dims, Xb_colptr, Xb_colptr);
+      
+      // allowance for the rounding errors in the expanded form, so that the lower bound stays valid
+      const eT tol = eT(N_dims + 2) * Datum<eT>::eps * (x_norm + M_norms_max);
+      
+      const uword i = block_start + j;
+      
+      const eT* X_colptr = X.colptr(i);
+      
+      assign[i] = best_g;
+      upper[i]  = std::sqrt( distance<eT,dist_id>::eval(N_dims, X_colptr, old_means.colptr(best_g), mah_aux_mem) );
+      lower[i]  = std::sqrt( (std::max)(second_dist + x_norm - tol, eT(0)) );
+      
+      arrayops::inplace_plus(acc.colptr(best_g), X_colptr, N_dims);
+      
+      counts[best_g]++;
+      last_indices[best_g] = i;
+      }
+    }
+  }
+
+
+
+//! Hamerly's test for vectors start_index to end_index: after the bounds are loosened by the distances the means moved,
+//! a vector keeps its mean if the upper bound does not exceed the lower bound or half the distance from its mean to the nearest other mean;
+//! otherwise the upper bound is recomputed, followed by the distances to all means if the test still fails.
+//! the sums of the assigned vectors are accumulated in acc
+template<typename eT>
+template<uword dist_id>
+inline
+void
+gmm_diag<eT>::km_bounds_update(const Mat<eT>& X, const uword start_index, const uword end_index, const Mat<eT>& old_means, const eT* half_sep, const eT* moved, const eT* lower_shift, uword* assign, eT* upper, eT* lower, Mat<eT>& acc, uword* counts, uword* last_indices) const
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword N_dims = old_means.n_rows;
+  const uword N_gaus = old_means.n_cols;
   
   const eT* mah_aux_mem = mah_aux.memptr();
   
+  acc.zeros();
+  
+  arrayops::fill_zeros(counts,       N_gaus);
+  arrayops::fill_zeros(last_indices, N_gaus);
+  
   for(uword i=start_index; i <= end_index; ++i)
     {
     const eT* X_colptr = X.colptr(i);
     
-    double best_dist = Datum<eT>::inf;
-    uword  best_g    = 0;
+    uword g = assign[i];
     
-    for(uword g=0; g < N_gaus; ++g)
+    eT u = upper[i] + moved[g];
+    eT l = lower[i] - lower_shift[g];
+    
+    const eT bound = (std::max)(half_sep[g], l);
+    
+    if(u > bound)
       {
-      const double dist = distance<eT,dist_id>::eval(N_dims, X_colptr, old_means.colptr(g), mah_aux_mem);
-      
-      // get_stream_err2() << "g: " << g << "   dist: " << dist << '\n';
-      // old_means.col(g).print("old_means.col(g):");
-      // vec tmp(old_means.colptr(g), old_means.n_rows);
-      // tmp.print("tmp:");
+      u = std::sqrt( distance<eT,dist_id>::eval(N_dims, X_colptr, old_means.colptr(g), mah_aux_mem) );
       
-      if(dist <= best_dist)  { best_dist = dist; best_g = g; }
+      if(u > bound)
+        {
+        eT best_dist   = Datum<eT>::inf;
+        eT second_dist = Datum<eT>::inf;
+        
+        for(uword h=0; h < N_gaus; ++h)
+          {
+          const eT dist = distance<eT,dist_id>::eval(N_dims, X_colptr, old_means.colptr(h), mah_aux_mem);
+          
+               if(dist <= best_dist  )  { second_dist = best_dist;  best_dist = dist;  g = h; }
+          else if(dist <  second_dist)  { second_dist = dist;                                 }
+          }
+        
+        u = std::sqrt(best_dist);
+        l = std::sqrt(second_dist);
+        }
       }
     
-    // get_stream_err2() << "best_g: " << best_g << '\n';
+    assign[i] = g;
+    upper[i]  = u;
+    lower[i]  = l;
     
-    running_means[best_g]( X.unsafe_col(i), i );
+    arrayops::inplace_plus(acc.colptr(g), X_colptr, N_dims);
+    
+    counts[g]++;
+    last_indices[g] = i;
+    }
+  }
+
+
+
+//! mini-batch k-means: the vectors in X are assigned to the nearest means,
+//! and each mean is moved to the average of all the vectors assigned to it so far (in this and previous batches)
+template<typename eT>
+template<uword dist_id>
+inline
+void
+gmm_diag<eT>::km_online_update(const Mat<eT>& X)
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword N_gaus = means.n_cols;
+  
+  struct job_type : public executor_job
+    {
+    const gmm_diag<eT>&                     model;
+    const Mat<eT>&                          X;
+    const umat&                             boundaries;
+    field< field< running_mean_vec<eT> > >& t_running_means;
+    
+    inline job_type(const gmm_diag<eT>& in_model, const Mat<eT>& in_X, const umat& in_boundaries, field< field< running_mean_vec<eT> > >& in_t_running_means)
+      : model(in_model), X(in_X), boundaries(in_boundaries), t_running_means(in_t_running_means) {}
+    
+    inline void run_task(const uword t)
+      {
+      model.template km_update_stats<dist_id>(X, boundaries.at(0,t), boundaries.at(1,t), model.means, t_running_means[t]);
+      }
+    };
+  
+  const umat boundaries = internal_gen_boundaries(X.n_cols);
+  
+  const uword n_threads = boundaries.n_cols;
+  
+  field< field< running_mean_vec<eT> > > t_running_means(n_threads);
+  
+  for(uword t=0; t < n_threads; ++t)  { t_running_means[t].set_size(N_gaus); }
+  
+  job_type job(*this, X, boundaries, t_running_means);
+  
+  get_executor().run(job, n_threads);
+  
+  uword* counts_mem = online_km_counts.memptr();
+  
+  for(uword g=0; g < N_gaus; ++g)
+    {
+    for(uword t=0; t < n_threads; ++t)
+      {
+      const running_mean_vec<eT>& rm = t_running_means[t][g];
+      
+      const uword count = rm.count();
+      
+      if(count == 0)  { continue; }
+      
+      counts_mem[g] += count;
+      
+      const eT w = eT(count) / eT(counts_mem[g]);
+      
+      access::rw(means).col(g) += w * (rm.mean() - means.col(g));
+      }
     }
   }
 
@@ -1934,10 +2780,6 @@ gmm_diag<eT>::em_iterate(const Mat<eT>& X, const uword max_iter, const eT var_fl
     get_stream_err2().setf(ios::fixed);
     }
   
-  #if defined(_OPENMP)
-    const arma_omp_state save_omp_state;
-  #endif
-  
   const umat boundaries = internal_gen_boundaries(X.n_cols);
   
   const uword n_threads = boundaries.n_cols;
@@ -1960,12 +2802,10 @@ gmm_diag<eT>::em_iterate(const Mat<eT>& X, const uword max_iter, const eT var_fl
     }
   
   
-  #if defined(_OPENMP)
-    if(verbose)
-      {
-      get_stream_err2() << "gmm_diag::learn(): EM: n_threads: " << n_threads  << '\n';
-      }
-  #endif
+  if(verbose)
+    {
+    get_stream_err2() << "gmm_diag::learn(): EM: n_threads: " << n_threads  << '\n';
+    }
   
   eT old_avg_log_p = -Datum<eT>::inf;
   
@@ -2012,10 +2852,12 @@ gmm_diag<eT>::em_iterate(const Mat<eT>& X, const uword max_iter, const eT var_fl
 
 
 
+//! accumulators for means, diagonal covariances and hefts over all vectors in X;
+//! the results are left in t_acc_means[0], t_acc_dcovs[0] and t_acc_norm_lhoods[0]
 template<typename eT>
 inline
 void
-gmm_diag<eT>::em_update_params
+gmm_diag<eT>::em_accumulate
   (
   const Mat<eT>&          X,
   const umat&             boundaries,
@@ -2025,6 +2867,7 @@ gmm_diag<eT>::em_update_params
         field< Col<eT> >& t_gaus_log_lhoods,
         Col<eT>&          t_progress_log_lhood
   )
+  const
   {
   arma_extra_debug_sigprint();
   
@@ -2032,11 +2875,22 @@ gmm_diag<eT>::em_update_params
   
   
   // em_generate_acc() is the "map" operation, which produces partial accumulators for means, diagonal covariances and hefts
-    
-  #if defined(_OPENMP)
+  
+  struct job_type : public executor_job
     {
-    #pragma omp parallel for
-    for(uword t=0; t<n_threads; t++)
+    const gmm_diag<eT>& model;
+    const Mat<eT>&      X;
+    const umat&         boundaries;
+    field< Mat<eT> >&   t_acc_means;
+    field< Mat<eT> >&   t_acc_dcovs;
+    field< Col<eT> >&   t_acc_norm_lhoods;
+    field< Col<eT> >&   t_gaus_log_lhoods;
+    Col<eT>&            t_progress_log_lhood;
+    
+    inline job_type(const gmm_diag<eT>& in_model, const Mat<eT>& in_X, const umat& in_boundaries, field< Mat<eT> >& in_t_acc_means, field< Mat<eT> >& in_t_acc_dcovs, field< Col<eT> >& in_t_acc_norm_lhoods, field< Col<eT> >& in_t_gaus_log_lhoods, Col<eT>& in_t_progress_log_lhood)
+      : model(in_model), X(in_X), boundaries(in_boundaries), t_acc_means(in_t_acc_means), t_acc_dcovs(in_t_acc_dcovs), t_acc_norm_lhoods(in_t_acc_norm_lhoods), t_gaus_log_lhoods(in_t_gaus_log_lhoods), t_progress_log_lhood(in_t_progress_log_lhood) {}
+    
+    inline void run_task(const uword t)
       {
       Mat<eT>& acc_means          = t_acc_means[t];
       Mat<eT>& acc_dcovs          = t_acc_dcovs[t];
@@ -2044,17 +2898,13 @@ gmm_diag<eT>::em_update_params
       Col<eT>& gaus_log_lhoods    = t_gaus_log_lhoods[t];
       eT&      progress_log_lhood = t_progress_log_lhood[t];
       
-      em_generate_acc(X, boundaries.at(0,t), boundaries.at(1,t), acc_means, acc_dcovs, acc_norm_lhoods, gaus_log_lhoods, progress_log_lhood);
+      model.em_generate_acc(X, boundaries.at(0,t), boundaries.at(1,t), acc_means, acc_dcovs, acc_norm_lhoods, gaus_log_lhoods, progress_log_lhood);
       }
-    }
-  #else
-    {
-    em_generate_acc(X, boundaries.at(0,0), boundaries.at(1,0), t_acc_means[0], t_acc_dcovs[0], t_acc_norm_lhoods[0], t_gaus_log_lhoods[0], t_progress_log_lhood[0]);
-    }
-  #endif
+    };
   
-  const uword N_dims = means.n_rows;
-  const uword N_gaus = means.n_cols;
+  job_type job(*this, X, boundaries, t_acc_means, t_acc_dcovs, t_acc_norm_lhoods, t_gaus_log_lhoods, t_progress_log_lhood);
+  
+  get_executor().run(job, n_threads);
   
   Mat<eT>& final_acc_means = t_acc_means[0];
   Mat<eT>& final_acc_dcovs = t_acc_dcovs[0];
@@ -2071,6 +2921,35 @@ gmm_diag<eT>::em_update_params
     
     final_acc_norm_lhoods += t_acc_norm_lhoods[t];
     }
+  }
+
+
+
+template<typename eT>
+inline
+void
+gmm_diag<eT>::em_update_params
+  (
+  const Mat<eT>&          X,
+  const umat&             boundaries,
+        field< Mat<eT> >& t_acc_means,
+        field< Mat<eT> >& t_acc_dcovs,
+        field< Col<eT> >& t_acc_norm_lhoods,
+        field< Col<eT> >& t_gaus_log_lhoods,
+        Col<eT>&          t_progress_log_lhood
+  )
+  {
+  arma_extra_debug_sigprint();
+  
+  em_accumulate(X, boundaries, t_acc_means, t_acc_dcovs, t_acc_norm_lhoods, t_gaus_log_lhoods, t_progress_log_lhood);
+  
+  const uword N_dims = means.n_rows;
+  const uword N_gaus = means.n_cols;
+  
+  const Mat<eT>& final_acc_means = t_acc_means[0];
+  const Mat<eT>& final_acc_dcovs = t_acc_dcovs[0];
+  
+  const Col<eT>& final_acc_norm_lhoods = t_acc_norm_lhoods[0];
   
   
   eT* hefts_mem = access::rw(hefts).memptr();
@@ -2080,8 +2959,8 @@ gmm_diag<eT>::em_update_params
     eT* mean_mem = access::rw(means).colptr(g);
     eT* dcov_mem = access::rw(dcovs).colptr(g);
     
-    eT* acc_mean_mem = final_acc_means.colptr(g);
-    eT* acc_dcov_mem = final_acc_dcovs.colptr(g);
+    const eT* acc_mean_mem = final_acc_means.colptr(g);
+    const eT* acc_dcov_mem = final_acc_dcovs.colptr(g);
     
     const eT acc_norm_lhood = (std::max)( final_acc_norm_lhoods[g], std::numeric_limits<eT>::min() );
     
@@ -2201,6 +3080,101 @@ gmm_diag<eT>::em_fix_params(const eT var_floor)
   }
 
 
+
+//! one step of stepwise EM: the normalised sufficient statistics of batch X are blended into the running statistics,
+//! from which the parameters are then obtained
+template<typename eT>
+inline
+void
+gmm_diag<eT>::em_online_update(const Mat<eT>& X, const uword em_index, const eT var_floor, const eT decay, const bool verbose)
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword N_dims = means.n_rows;
+  const uword N_gaus = means.n_cols;
+  
+  const umat boundaries = internal_gen_boundaries(X.n_cols);
+  
+  const uword n_threads = boundaries.n_cols;
+  
+  field< Mat<eT> > t_acc_means(n_threads);
+  field< Mat<eT> > t_acc_dcovs(n_threads);
+  
+  field< Col<eT> > t_acc_norm_lhoods(n_threads);
+  field< Col<eT> > t_gaus_log_lhoods(n_threads);
+  
+  Col<eT>          t_progress_log_lhood(n_threads);
+  
+  for(uword t=0; t<n_threads; t++)
+    {
+    t_acc_means[t].set_size(N_dims, N_gaus);
+    t_acc_dcovs[t].set_size(N_dims, N_gaus);
+    
+    t_acc_norm_lhoods[t].set_size(N_gaus);
+    t_gaus_log_lhoods[t].set_size(N_gaus);
+    }
+  
+  init_constants();
+  
+  em_accumulate(X, boundaries, t_acc_means, t_acc_dcovs, t_acc_norm_lhoods, t_gaus_log_lhoods, t_progress_log_lhood);
+  
+  const eT step     = std::pow( eT(em_index + 2), -decay );
+  const eT step_inv = eT(1) - step;
+  const eT scale    = step / eT(X.n_cols);
+  
+  const Mat<eT>& acc_means       = t_acc_means[0];
+  const Mat<eT>& acc_dcovs       = t_acc_dcovs[0];
+  const Col<eT>& acc_norm_lhoods = t_acc_norm_lhoods[0];
+  
+  eT* hefts_mem = access::rw(hefts).memptr();
+  
+  for(uword g=0; g < N_gaus; ++g)
+    {
+    eT& s_heft = online_acc_hefts[g];
+    
+    s_heft = step_inv * s_heft + scale * acc_norm_lhoods[g];
+    
+    const eT s_heft_val = (std::max)( s_heft, std::numeric_limits<eT>::min() );
+    
+    hefts_mem[g] = s_heft_val;
+    
+    const eT* acc_mean_mem = acc_means.colptr(g);
+    const eT* acc_dcov_mem = acc_dcovs.colptr(g);
+    
+    eT* s_mean_mem = online_acc_means.colptr(g);
+    eT* s_dcov_mem = online_acc_dcovs.colptr(g);
+    
+    eT* mean_mem = access::rw(means).colptr(g);
+    eT* dcov_mem = access::rw(dcovs).colptr(g);
+    
+    for(uword d=0; d < N_dims; ++d)
+      {
+      s_mean_mem[d] = step_inv * s_mean_mem[d] + scale * acc_mean_mem[d];
+      s_dcov_mem[d] = step_inv * s_dcov_mem[d] + scale * acc_dcov_mem[d];
+      
+      const eT tmp = s_mean_mem[d] / s_heft_val;
+      
+      mean_mem[d] = tmp;
+      dcov_mem[d] = s_dcov_mem[d] / s_heft_val - tmp*tmp;
+      }
+    }
+  
+  access::rw(hefts) /= accu(hefts);
+  
+  em_fix_params(var_floor);
+  
+  if(verbose)
+    {
+    get_stream_err2().unsetf(ios::showbase);
+    get_stream_err2().unsetf(ios::uppercase);
+    get_stream_err2().unsetf(ios::showpos);
+    get_stream_err2().unsetf(ios::scientific);
+    
+    get_stream_err2() << "gmm_diag::learn_online(): EM: batch avg_log_p: " << mean(t_progress_log_lhood) << "   step size: " << step << '\n';
+    }
+  }
+
+
 }
 
 
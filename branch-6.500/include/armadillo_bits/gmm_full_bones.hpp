@@ -0,0 +1,157 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup gmm_full
+//! @{
+
+
+namespace gmm_priv
+{
+
+
+template<typename eT>
+class gmm_full
+  {
+  public:
+  
+  arma_aligned const Mat<eT>  means;
+  arma_aligned const Cube<eT> fcovs;
+  arma_aligned const Row<eT>  hefts;
+  
+  //
+  //
+  
+  inline ~gmm_full();
+  inline  gmm_full();
+  
+  inline                  gmm_full(const gmm_full& x);
+  inline const gmm_full& operator=(const gmm_full& x);
+  
+  inline      gmm_full(const uword in_n_dims, const uword in_n_gaus);
+  inline void    reset(const uword in_n_dims, const uword in_n_gaus);
+  inline void    reset();
+  
+  template<typename T1, typename T2, typename T3>
+  inline void set_params(const Base<eT,T1>& in_means, const BaseCube<eT,T2>& in_fcovs, const Base<eT,T3>& in_hefts);
+  
+  template<typename T1> inline void set_means(const Base<eT,T1>&     in_means);
+  template<typename T1> inline void set_fcovs(const BaseCube<eT,T1>& in_fcovs);
+  template<typename T1> inline void set_hefts(const Base<eT,T1>&     in_hefts);
+  
+  inline uword n_dims() const;
+  inline uword n_gaus() const;
+  
+  inline bool load(const std::string name);
+  inline bool save(const std::string name) const;
+  
+  inline Col<eT> generate()              const;
+  inline Mat<eT> generate(const uword N) const;
+  
+  template<typename T1> inline eT      log_p(const T1& expr, const gmm_empty_arg& junk1 = gmm_empty_arg(), typename enable_if<((is_arma_type<T1>::value) && (resolves_to_colvector<T1>::value == true ))>::result* junk2 = 0) const;
+  template<typename T1> inline eT      log_p(const T1& expr, const uword gaus_id,                          typename enable_if<((is_arma_type<T1>::value) && (resolves_to_colvector<T1>::value == true ))>::result* junk2 = 0) const;
+  
+  template<typename T1> inline Row<eT> log_p(const T1& expr, const gmm_empty_arg& junk1 = gmm_empty_arg(), typename enable_if<((is_arma_type<T1>::value) && (resolves_to_colvector<T1>::value == false))>::result* junk2 = 0) const;
+  template<typename T1> inline Row<eT> log_p(const T1& expr, const uword gaus_id,                          typename enable_if<((is_arma_type<T1>::value) && (resolves_to_colvector<T1>::value == false))>::result* junk2 = 0) const;
+  
+  template<typename T1> inline eT  avg_log_p(const Base<eT,T1>& expr)                      const;
+  template<typename T1> inline eT  avg_log_p(const Base<eT,T1>& expr, const uword gaus_id) const;
+  
+  template<typename T1> inline uword   assign(const T1& expr, const gmm_dist_mode& dist, typename enable_if<((is_arma_type<T1>::value) && (resolves_to_colvector<T1>::value == true ))>::result* junk = 0) const;
+  template<typename T1> inline urowvec assign(const T1& expr, const gmm_dist_mode& dist, typename enable_if<((is_arma_type<T1>::value) && (resolves_to_colvector<T1>::value == false))>::result* junk = 0) const;
+  
+  template<typename T1> inline urowvec  raw_hist(const Base<eT,T1>& expr, const gmm_dist_mode& dist_mode) const;
+  template<typename T1> inline Row<eT> norm_hist(const Base<eT,T1>& expr, const gmm_dist_mode& dist_mode) const;
+  
+  template<typename T1>
+  inline
+  bool
+  learn
+    (
+    const Base<eT,T1>&    data,
+    const uword           n_gaus,
+    const gmm_dist_mode&  dist_mode,
+    const gmm_seed_mode&  seed_mode,
+    const uword           km_iter,
+    const uword           em_iter,
+    const eT              var_floor,
+    const bool            print_mode
+    );
+  
+  inline void set_executor(executor& in_exec);
+  inline void set_executor();
+  
+  
+  //
+  
+  protected:
+  
+  //! number of vectors processed together by the batched triangular solves
+  static const uword block_size = 128;
+  
+  arma_aligned Cube<eT> chol_fcovs;   //!< upper triangular R for each Gaussian, with trans(R)*R = fcovs.slice(g)
+  arma_aligned Row<eT>  log_det_etc;  //!< -0.5*log(det(2*pi*fcovs.slice(g))) for each Gaussian
+  arma_aligned Row<eT>  log_hefts;
+  
+  executor* exec_ptr;  //!< executor for the parallel operations; the default executor is used if null
+  
+  //
+  
+  inline void init(const gmm_full& x);
+  
+  inline void init(const uword in_n_dim, const uword in_n_gaus);
+  
+  inline void init_constants();
+  
+  inline umat internal_gen_boundaries(const uword N) const;
+  
+  inline executor& get_executor() const;
+  
+  template<typename T1> inline void internal_block_gather(eT* XT, const T1& X, const uword start, const uword n) const;
+  
+  inline void internal_block_log_p     (eT* out, const eT* XT, const uword n, const uword gaus_id, eT* Z) const;
+  inline void internal_block_log_lhoods(eT* out, const eT* XT, const uword n,                      eT* Z) const;
+  
+  inline eT internal_scalar_log_p(const eT* x, const uword gaus_id) const;
+  inline eT internal_scalar_log_p(const eT* x                     ) const;
+  
+  template<typename T1> inline Row<eT> internal_vec_log_p(const T1& X, const uword gaus_id) const;
+  
+  template<typename T1> inline void internal_vec_log_p_worker(eT* out, const T1& X, const uword start_index, const uword end_index, const uword gaus_id) const;
+  
+  template<typename T1> inline eT internal_avg_log_p(const T1& X, const uword gaus_id) const;
+  
+  template<typename T1> inline void internal_vec_assign(urowvec& out, const T1& X, const gmm_dist_mode& dist_mode) const;
+  
+  template<typename T1> inline void internal_vec_assign_worker(uword* out, const T1& X, const uword start_index, const uword end_index, const gmm_dist_mode& dist_mode) const;
+  
+  //
+  
+  template<uword dist_id> inline void generate_initial_fcovs_and_hefts(const Mat<eT>& X, const eT var_floor, const Col<eT>& mah_aux);
+  
+  //
+  
+  inline bool em_iterate(const Mat<eT>& X, const uword max_iter, const eT var_floor, const bool verbose);
+  
+  inline void em_update_params(const Mat<eT>& X, const umat& boundaries, field< Mat<eT> >& t_acc_means, field< Cube<eT> >& t_acc_fcovs, field< Col<eT> >& t_acc_norm_lhoods, Col<eT>& t_progress_log_lhood);
+  
+  inline void em_generate_acc(const Mat<eT>& X, const uword start_index, const uword end_index, Mat<eT>& acc_means, Cube<eT>& acc_fcovs, Col<eT>& acc_norm_lhoods, eT& progress_log_lhood) const;
+  
+  inline void em_fix_params(const eT var_floor);
+  };
+
+
+}
+
+
+typedef gmm_priv::gmm_full<double>  gmm_full;
+typedef gmm_priv::gmm_full<float>  fgmm_full;
+
+
+//! @}
@@ -0,0 +1,1833 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup gmm_full
+//! @{
+
+
+namespace gmm_priv
+{
+
+
+template<typename eT>
+inline
+gmm_full<eT>::~gmm_full()
+  {
+  arma_extra_debug_sigprint_this(this);
+  
+  arma_type_check(( (is_same_type<eT,float>::value == false) && (is_same_type<eT,double>::value == false) ));
+  }
+
+
+
+template<typename eT>
+inline
+gmm_full<eT>::gmm_full()
+  : exec_ptr(0)
+  {
+  arma_extra_debug_sigprint_this(this);
+  }
+
+
+
+template<typename eT>
+inline
+gmm_full<eT>::gmm_full(const gmm_full<eT>& x)
+  : exec_ptr(0)
+  {
+  arma_extra_debug_sigprint_this(this);
+  
+  init(x);
+  }
+
+
+
+template<typename eT>
+inline
+const gmm_full<eT>&
+gmm_full<eT>::operator=(const gmm_full<eT>& x)
+  {
+  arma_extra_debug_sigprint();
+  
+  init(x);
+  
+  return *this;
+  }
+
+
+
+template<typename eT>
+inline
+gmm_full<eT>::gmm_full(const uword in_n_dims, const uword in_n_gaus)
+  : exec_ptr(0)
+  {
+  arma_extra_debug_sigprint_this(this);
+  
+  init(in_n_dims, in_n_gaus);
+  }
+
+
+
+template<typename eT>
+inline
+void
+gmm_full<eT>::reset()
+  {
+  arma_extra_debug_sigprint();
+  
+  init(0, 0);
+  }
+
+
+
+template<typename eT>
+inline
+void
+gmm_full<eT>::reset(const uword in_n_dims, const uword in_n_gaus)
+  {
+  arma_extra_debug_sigprint();
+  
+  init(in_n_dims, in_n_gaus);
+  }
+
+
+
+template<typename eT>
+template<typename T1, typename T2, typename T3>
+inline
+void
+gmm_full<eT>::set_params(const Base<eT,T1>& in_means_expr, const BaseCube<eT,T2>& in_fcovs_expr, const Base<eT,T3>& in_hefts_expr)
+  {
+  arma_extra_debug_sigprint();
+  
+  const unwrap<T1>      tmp1(in_means_expr.get_ref());
+  const unwrap_cube<T2> tmp2(in_fcovs_expr.get_ref());
+  const unwrap<T3>      tmp3(in_hefts_expr.get_ref());
+  
+  const Mat<eT>&  in_means = tmp1.M;
+  const Cube<eT>& in_fcovs = tmp2.M;
+  const Mat<eT>&  in_hefts = tmp3.M;
+  
+  arma_debug_check
+    (
+    (in_fcovs.n_rows != in_means.n_rows) || (in_fcovs.n_cols != in_means.n_rows) || (in_fcovs.n_slices != in_means.n_cols) || (in_hefts.n_cols != in_means.n_cols) || (in_hefts.n_rows != 1),
+    "gmm_full::set_params(): given parameters have inconsistent and/or wrong sizes"
+    );
+  
+  arma_debug_check( (in_means.is_finite() == false), "gmm_full::set_params(): given means have non-finite values" );
+  arma_debug_check( (in_fcovs.is_finite() == false), "gmm_full::set_params(): given fcovs have non-finite values" );
+  arma_debug_check( (in_hefts.is_finite() == false), "gmm_full::set_params(): given hefts have non-finite values" );
+  
+  for(uword g=0; g < in_fcovs.n_slices; ++g)
+    {
+    Mat<eT> R;
+    
+    arma_debug_check( (auxlib::chol(R, in_fcovs.slice(g), 0) == false), "gmm_full::set_params(): given fcovs are not positive definite" );
+    }
+  
+  arma_debug_check( (any(vectorise(in_hefts) < eT(0))), "gmm_full::set_params(): given hefts have negative values" );
+  
+  const eT s = accu(in_hefts);
+  
+  arma_debug_check( ((s < (eT(1) - Datum<eT>::eps)) || (s > (eT(1) + Datum<eT>::eps))), "gmm_full::set_params(): sum of given hefts is not 1" );
+  
+  access::rw(means) = in_means;
+  access::rw(fcovs) = in_fcovs;
+  access::rw(hefts) = in_hefts;
+  
+  init_constants();
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+void
+gmm_full<eT>::set_means(const Base<eT,T1>& in_means_expr)
+  {
+  arma_extra_debug_sigprint();
+  
+  const unwrap<T1> tmp(in_means_expr.get_ref());
+  
+  const Mat<eT>& in_means = tmp.M;
+  
+  arma_debug_check( (size(in_means) != size(means)), "gmm_full::set_means(): given means have incompatible size" );
+  arma_debug_check( (in_means.is_finite() == false), "gmm_full::set_means(): given means have non-finite values" );
+  
+  access::rw(means) = in_means;
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+void
+gmm_full<eT>::set_fcovs(const BaseCube<eT,T1>& in_fcovs_expr)
+  {
+  arma_extra_debug_sigprint();
+  
+  const unwrap_cube<T1> tmp(in_fcovs_expr.get_ref());
+  
+  const Cube<eT>& in_fcovs = tmp.M;
+  
+  arma_debug_check( (size(in_fcovs) != size(fcovs)), "gmm_full::set_fcovs(): given fcovs have incompatible size" );
+  arma_debug_check( (in_fcovs.is_finite() == false), "gmm_full::set_fcovs(): given fcovs have non-finite values" );
+  
+  for(uword g=0; g < in_fcovs.n_slices; ++g)
+    {
+    Mat<eT> R;
+    
+    arma_debug_check( (auxlib::chol(R, in_fcovs.slice(g), 0) == false), "gmm_full::set_fcovs(): given fcovs are not positive definite" );
+    }
+  
+  access::rw(fcovs) = in_fcovs;
+  
+  init_constants();
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+void
+gmm_full<eT>::set_hefts(const Base<eT,T1>& in_hefts_expr)
+  {
+  arma_extra_debug_sigprint();
+  
+  const unwrap<T1> tmp(in_hefts_expr.get_ref());
+  
+  const Mat<eT>& in_hefts = tmp.M;
+  
+  arma_debug_check( (size(in_hefts) != size(hefts)),     "gmm_full::set_hefts(): given hefts have incompatible size" );
+  arma_debug_check( (in_hefts.is_finite() == false),     "gmm_full::set_hefts(): given hefts have non-finite values" );
+  arma_debug_check( (any(vectorise(in_hefts) <  eT(0))), "gmm_full::set_hefts(): given hefts have negative values"   );
+  
+  const eT s = accu(in_hefts);
+  
+  arma_debug_check( ((s < (eT(1) - Datum<eT>::eps)) || (s > (eT(1) + Datum<eT>::eps))), "gmm_full::set_hefts(): sum of given hefts is not 1" );
+  
+  // make sure all hefts are positive and non-zero
+  
+  const eT* in_hefts_mem = in_hefts.memptr();
+        eT*    hefts_mem = access::rw(hefts).memptr();
+  
+  for(uword i=0; i < hefts.n_elem; ++i)
+    {
+    hefts_mem[i] = (std::max)( in_hefts_mem[i], std::numeric_limits<eT>::min() );
+    }
+  
+  access::rw(hefts) /= accu(hefts);
+  
+  log_hefts = log(hefts);
+  }
+
+
+
+template<typename eT>
+inline
+uword
+gmm_full<eT>::n_dims() const
+  {
+  return means.n_rows;
+  }
+
+
+
+template<typename eT>
+inline
+uword
+gmm_full<eT>::n_gaus() const
+  {
+  return means.n_cols;
+  }
+
+
+
+//! the model is stored as a cube with n_gaus slices;
+//! each slice has n_dims rows and (n_dims + 2) columns, holding the mean, the covariance matrix and (in the first row of the last column) the heft
+template<typename eT>
+inline
+bool
+gmm_full<eT>::load(const std::string name)
+  {
+  arma_extra_debug_sigprint();
+  
+  Cube<eT> Q;
+  
+  bool status = Q.load(name, arma_binary);
+  
+  if( (status == false) || (Q.n_cols != (Q.n_rows + 2)) )
+    {
+    reset();
+    return false;
+    }
+  
+  if( (Q.n_rows < 1) || (Q.n_slices < 1) )
+    {
+    reset();
+    return true;
+    }
+  
+  const uword N_dims = Q.n_rows;
+  const uword N_gaus = Q.n_slices;
+  
+  access::rw(means).set_size(N_dims, N_gaus);
+  access::rw(fcovs).set_size(N_dims, N_dims, N_gaus);
+  access::rw(hefts).set_size(N_gaus);
+  
+  for(uword g=0; g < N_gaus; ++g)
+    {
+    access::rw(means).col(g)   = Q.slice(g).col(0);
+    access::rw(fcovs).slice(g) = Q.slice(g).cols(1, N_dims);
+    access::rw(hefts)(g)       = Q.slice(g).at(0, N_dims+1);
+    }
+  
+  init_constants();
+  
+  return true;
+  }
+
+
+
+template<typename eT>
+inline
+bool
+gmm_full<eT>::save(const std::string name) const
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword N_dims = means.n_rows;
+  const uword N_gaus = means.n_cols;
+  
+  Cube<eT> Q(N_dims, N_dims + 2, N_gaus);
+  
+  if(Q.n_elem > 0)
+    {
+    Q.zeros();
+    
+    for(uword g=0; g < N_gaus; ++g)
+      {
+      Q.slice(g).col(0)            = means.col(g);
+      Q.slice(g).cols(1, N_dims)   = fcovs.slice(g);
+      Q.slice(g).at(0, N_dims + 1) = hefts(g);
+      }
+    }
+  
+  const bool status = Q.save(name, arma_binary);
+  
+  return status;
+  }
+
+
+
+template<typename eT>
+inline
+Col<eT>
+gmm_full<eT>::generate() const
+  {
+  arma_extra_debug_sigprint();
+  
+  return (*this).generate(1);
+  }
+
+
+
+template<typename eT>
+inline
+Mat<eT>
+gmm_full<eT>::generate(const uword N_vec) const
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword N_dims = means.n_rows;
+  const uword N_gaus = means.n_cols;
+  
+  Mat<eT> out( ( (N_gaus > 0) ? N_dims : uword(0) ), N_vec );
+  
+  if(N_gaus > 0)
+    {
+    const eT* hefts_mem = hefts.memptr();
+    
+    for(uword i=0; i < N_vec; ++i)
+      {
+      const double val = randu<double>();
+      
+      double csum    = double(0);
+      uword  gaus_id = 0;
+      
+      for(uword j=0; j < N_gaus; ++j)
+        {
+        csum += hefts_mem[j];
+        
+        if(val <= csum)  { gaus_id = j; break; }
+        }
+      
+      // trans(R)*z has covariance trans(R)*R when z is drawn from N(0,I)
+      
+      out.col(i) = means.col(gaus_id) + trans(chol_fcovs.slice(gaus_id)) * randn< Col<eT> >(N_dims);
+      }
+    }
+  
+  return out;
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+eT
+gmm_full<eT>::log_p(const T1& expr, const gmm_empty_arg& junk1, typename enable_if<((is_arma_type<T1>::value) && (resolves_to_colvector<T1>::value == true))>::result* junk2) const
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk1);
+  arma_ignore(junk2);
+  
+  const quasi_unwrap<T1> tmp(expr);
+  
+  arma_debug_check( (tmp.M.n_rows != means.n_rows), "gmm_full::log_p(): incompatible dimensions" );
+  
+  return internal_scalar_log_p( tmp.M.memptr() );
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+eT
+gmm_full<eT>::log_p(const T1& expr, const uword gaus_id, typename enable_if<((is_arma_type<T1>::value) && (resolves_to_colvector<T1>::value == true))>::result* junk2) const
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk2);
+  
+  const quasi_unwrap<T1> tmp(expr);
+  
+  arma_debug_check( (tmp.M.n_rows != means.n_rows), "gmm_full::log_p(): incompatible dimensions" );
+  
+  arma_debug_check( (gaus_id >= means.n_cols), "gmm_full::log_p(): specified gaussian is out of range" );
+  
+  return internal_scalar_log_p( tmp.M.memptr(), gaus_id );
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+Row<eT>
+gmm_full<eT>::log_p(const T1& expr, const gmm_empty_arg& junk1, typename enable_if<((is_arma_type<T1>::value) && (resolves_to_colvector<T1>::value == false))>::result* junk2) const
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk1);
+  arma_ignore(junk2);
+  
+  if(is_subview<T1>::value)
+    {
+    const subview<eT>& X = reinterpret_cast< const subview<eT>& >(expr);
+    
+    return internal_vec_log_p(X, means.n_cols);
+    }
+  else
+    {
+    const unwrap<T1>   tmp(expr);
+    const Mat<eT>& X = tmp.M;
+    
+    return internal_vec_log_p(X, means.n_cols);
+    }
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+Row<eT>
+gmm_full<eT>::log_p(const T1& expr, const uword gaus_id, typename enable_if<((is_arma_type<T1>::value) && (resolves_to_colvector<T1>::value == false))>::result* junk2) const
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk2);
+  
+  arma_debug_check( (gaus_id >= means.n_cols), "gmm_full::log_p(): specified gaussian is out of range" );
+  
+  if(is_subview<T1>::value)
+    {
+    const subview<eT>& X = reinterpret_cast< const subview<eT>& >(expr);
+    
+    return internal_vec_log_p(X, gaus_id);
+    }
+  else
+    {
+    const unwrap<T1>   tmp(expr);
+    const Mat<eT>& X = tmp.M;
+    
+    return internal_vec_log_p(X, gaus_id);
+    }
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+eT
+gmm_full<eT>::avg_log_p(const Base<eT,T1>& expr) const
+  {
+  arma_extra_debug_sigprint();
+  
+  if(is_subview<T1>::value)
+    {
+    const subview<eT>& X = reinterpret_cast< const subview<eT>& >( expr.get_ref() );
+    
+    return internal_avg_log_p(X, means.n_cols);
+    }
+  else
+    {
+    const unwrap<T1>   tmp(expr.get_ref());
+    const Mat<eT>& X = tmp.M;
+    
+    return internal_avg_log_p(X, means.n_cols);
+    }
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+eT
+gmm_full<eT>::avg_log_p(const Base<eT,T1>& expr, const uword gaus_id) const
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_debug_check( (gaus_id >= means.n_cols), "gmm_full::avg_log_p(): specified gaussian is out of range" );
+  
+  if(is_subview<T1>::value)
+    {
+    const subview<eT>& X = reinterpret_cast< const subview<eT>& >( expr.get_ref() );
+    
+    return internal_avg_log_p(X, gaus_id);
+    }
+  else
+    {
+    const unwrap<T1>   tmp(expr.get_ref());
+    const Mat<eT>& X = tmp.M;
+    
+    return internal_avg_log_p(X, gaus_id);
+    }
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+uword
+gmm_full<eT>::assign(const T1& expr, const gmm_dist_mode& dist, typename enable_if<((is_arma_type<T1>::value) && (resolves_to_colvector<T1>::value == true))>::result* junk) const
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  arma_debug_check( (means.n_cols == 0), "gmm_full::assign(): model has no means" );
+  
+  const quasi_unwrap<T1> tmp(expr);
+  
+  urowvec out;
+  
+  internal_vec_assign(out, tmp.M, dist);
+  
+  return out[0];
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+urowvec
+gmm_full<eT>::assign(const T1& expr, const gmm_dist_mode& dist, typename enable_if<((is_arma_type<T1>::value) && (resolves_to_colvector<T1>::value == false))>::result* junk) const
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  urowvec out;
+  
+  if(is_subview<T1>::value)
+    {
+    const subview<eT>& X = reinterpret_cast< const subview<eT>& >(expr);
+    
+    internal_vec_assign(out, X, dist);
+    }
+  else
+    {
+    const unwrap<T1>   tmp(expr);
+    const Mat<eT>& X = tmp.M;
+    
+    internal_vec_assign(out, X, dist);
+    }
+  
+  return out;
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+urowvec
+gmm_full<eT>::raw_hist(const Base<eT,T1>& expr, const gmm_dist_mode& dist_mode) const
+  {
+  arma_extra_debug_sigprint();
+  
+  const unwrap<T1>   tmp(expr.get_ref());
+  const Mat<eT>& X = tmp.M;
+  
+  arma_debug_check( (X.n_rows != means.n_rows), "gmm_full::raw_hist(): incompatible dimensions" );
+  
+  arma_debug_check( ((dist_mode != eucl_dist) && (dist_mode != prob_dist)), "gmm_full::raw_hist(): unsupported distance mode" );
+  
+  urowvec ids;
+  
+  internal_vec_assign(ids, X, dist_mode);
+  
+  urowvec hist(means.n_cols, fill::zeros);
+  
+  const uword* ids_mem  = ids.memptr();
+        uword* hist_mem = hist.memptr();
+  
+  for(uword i=0; i < ids.n_elem; ++i)  { hist_mem[ ids_mem[i] ]++; }
+  
+  return hist;
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+Row<eT>
+gmm_full<eT>::norm_hist(const Base<eT,T1>& expr, const gmm_dist_mode& dist_mode) const
+  {
+  arma_extra_debug_sigprint();
+  
+  const urowvec hist = (*this).raw_hist(expr, dist_mode);
+  
+  const uword  hist_n_elem = hist.n_elem;
+  const uword* hist_mem    = hist.memptr();
+  
+  eT acc = eT(0);
+  for(uword i=0; i<hist_n_elem; ++i)  { acc += eT(hist_mem[i]); }
+  
+  if(acc == eT(0))  { acc = eT(1); }
+  
+  Row<eT> out(hist_n_elem);
+  
+  eT* out_mem = out.memptr();
+  
+  for(uword i=0; i<hist_n_elem; ++i)  { out_mem[i] = eT(hist_mem[i]) / acc; }
+  
+  return out;
+  }
+
+
+
+//! the seeding of the initial means and the k-means iterations are done by gmm_diag;
+//! the initial covariances are then estimated from the samples closest to each mean
+template<typename eT>
+template<typename T1>
+inline
+bool
+gmm_full<eT>::learn
+  (
+  const Base<eT,T1>&   data,
+  const uword          N_gaus,
+  const gmm_dist_mode& dist_mode,
+  const gmm_seed_mode& seed_mode,
+  const uword          km_iter,
+  const uword          em_iter,
+  const eT             var_floor,
+  const bool           print_mode
+  )
+  {
+  arma_extra_debug_sigprint();
+  
+  const bool dist_mode_ok = (dist_mode == eucl_dist) || (dist_mode == maha_dist);
+  
+  const bool seed_mode_ok = \
+       (seed_mode == keep_existing)
+    || (seed_mode == static_subset)
+    || (seed_mode == static_spread)
+    || (seed_mode == random_subset)
+    || (seed_mode == random_spread)
+    || (seed_mode == random_kmpp);
+  
+  arma_debug_check( (dist_mode_ok == false), "gmm_full::learn(): dist_mode must be eucl_dist or maha_dist" );
+  arma_debug_check( (seed_mode_ok == false), "gmm_full::learn(): unknown seed_mode"                        );
+  arma_debug_check( (var_floor < eT(0)    ), "gmm_full::learn(): variance floor is negative"               );
+  
+  const unwrap<T1>   tmp_X(data.get_ref());
+  const Mat<eT>& X = tmp_X.M;
+  
+  if(X.is_empty()          )  { arma_debug_warn("gmm_full::learn(): given matrix is empty"             ); return false; }
+  if(X.is_finite() == false)  { arma_debug_warn("gmm_full::learn(): given matrix has non-finite values"); return false; }
+  
+  if(N_gaus == 0)  { reset(); return true; }
+  
+  
+  // copy current model, in case of failure by k-means and/or EM
+  
+  const gmm_full<eT> orig = (*this);
+  
+  
+  // initial means
+  
+  gmm_diag<eT> km;
+  
+  km.exec_ptr = exec_ptr;
+  
+  if(seed_mode == keep_existing)
+    {
+    if(means.is_empty()        )  { arma_debug_warn("gmm_full::learn(): no existing means"      ); return false; }
+    if(X.n_rows != means.n_rows)  { arma_debug_warn("gmm_full::learn(): dimensionality mismatch"); return false; }
+    
+    km.reset(means.n_rows, means.n_cols);
+    
+    access::rw(km.means) = means;
+    }
+  else
+    {
+    if(X.n_cols < N_gaus)  { arma_debug_warn("gmm_full::learn(): number of vectors is less than number of gaussians"); return false; }
+    
+    reset(X.n_rows, N_gaus);
+    
+    km.reset(X.n_rows, N_gaus);
+    }
+  
+  if(dist_mode == maha_dist)
+    {
+    km.mah_aux = var(X,1,1);
+    
+    const uword mah_aux_n_elem = km.mah_aux.n_elem;
+          eT*   mah_aux_mem    = km.mah_aux.memptr();
+    
+    for(uword i=0; i < mah_aux_n_elem; ++i)
+      {
+      const eT val = mah_aux_mem[i];
+      
+      mah_aux_mem[i] = ((val != eT(0)) && arma_isfinite(val)) ? eT(1) / val : eT(1);
+      }
+    }
+  
+  if(seed_mode != keep_existing)
+    {
+    if(print_mode)  { get_stream_err2() << "gmm_full::learn(): generating initial means\n"; }
+    
+         if(dist_mode == eucl_dist)  { km.template generate_initial_means<1>(X, seed_mode); }
+    else if(dist_mode == maha_dist)  { km.template generate_initial_means<2>(X, seed_mode); }
+    }
+  
+  
+  // k-means
+  
+  if(km_iter > 0)
+    {
+    const arma_ostream_state stream_state(get_stream_err2());
+    
+    bool status = false;
+    
+         if(dist_mode == eucl_dist)  { status = km.template km_iterate<1>(X, km_iter, print_mode, "gmm_full::learn(): k-means"); }
+    else if(dist_mode == maha_dist)  { status = km.template km_iterate<2>(X, km_iter, print_mode, "gmm_full::learn(): k-means"); }
+    
+    stream_state.restore(get_stream_err2());
+    
+    if(status == false)  { arma_debug_warn("gmm_full::learn(): k-means algorithm failed; not enough data, or too many gaussians requested"); init(orig); return false; }
+    }
+  
+  access::rw(means) = km.means;
+  
+  
+  // initial fcovs
+  
+  const eT vfloor = (eT(var_floor) > eT(0)) ? eT(var_floor) : std::numeric_limits<eT>::min();
+  
+  if(seed_mode != keep_existing)
+    {
+    if(print_mode)  { get_stream_err2() << "gmm_full::learn(): generating initial covariances\n"; }
+    
+         if(dist_mode == eucl_dist)  { generate_initial_fcovs_and_hefts<1>(X, vfloor, km.mah_aux); }
+    else if(dist_mode == maha_dist)  { generate_initial_fcovs_and_hefts<2>(X, vfloor, km.mah_aux); }
+    }
+  
+  
+  // EM algorithm
+  
+  if(em_iter > 0)
+    {
+    const arma_ostream_state stream_state(get_stream_err2());
+    
+    const bool status = em_iterate(X, em_iter, vfloor, print_mode);
+    
+    stream_state.restore(get_stream_err2());
+    
+    if(status == false)  { arma_debug_warn("gmm_full::learn(): EM algorithm failed"); init(orig); return false; }
+    }
+  
+  init_constants();
+  
+  return true;
+  }
+
+
+
+//! run the parallel operations on the given executor, eg. one that submits the tasks to a thread pool,
+//! or an omp_executor with a limit on the number of threads; the executor must outlive its use by the model.
+//! as this modifies the model, it must be done before the model is used by several threads at once
+template<typename eT>
+inline
+void
+gmm_full<eT>::set_executor(executor& in_exec)
+  {
+  arma_extra_debug_sigprint();
+  
+  exec_ptr = &in_exec;
+  }
+
+
+
+//! run the parallel operations on the default executor
+template<typename eT>
+inline
+void
+gmm_full<eT>::set_executor()
+  {
+  arma_extra_debug_sigprint();
+  
+  exec_ptr = 0;
+  }
+
+
+
+//
+//
+//
+
+
+
+template<typename eT>
+inline
+void
+gmm_full<eT>::init(const gmm_full<eT>& x)
+  {
+  arma_extra_debug_sigprint();
+  
+  gmm_full<eT>& t = *this;
+  
+  if(&t != &x)
+    {
+    access::rw(t.means) = x.means;
+    access::rw(t.fcovs) = x.fcovs;
+    access::rw(t.hefts) = x.hefts;
+    
+    t.exec_ptr = x.exec_ptr;
+    
+    init_constants();
+    }
+  }
+
+
+
+template<typename eT>
+inline
+void
+gmm_full<eT>::init(const uword in_n_dims, const uword in_n_gaus)
+  {
+  arma_extra_debug_sigprint();
+  
+  access::rw(means).zeros(in_n_dims, in_n_gaus);
+  
+  access::rw(fcovs).zeros(in_n_dims, in_n_dims, in_n_gaus);
+  
+  for(uword g=0; g < in_n_gaus; ++g)  { access::rw(fcovs).slice(g).diag().ones(); }
+  
+  access::rw(hefts).set_size(in_n_gaus);
+  
+  access::rw(hefts).fill(eT(1) / eT(in_n_gaus));
+  
+  init_constants();
+  }
+
+
+
+//! caches the Cholesky factor and the log determinant of each covariance matrix;
+//! a Gaussian whose covariance matrix is not positive definite is given zero likelihood
+template<typename eT>
+inline
+void
+gmm_full<eT>::init_constants()
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword N_dims = means.n_rows;
+  const uword N_gaus = means.n_cols;
+  
+  const eT tmp = (eT(N_dims)/eT(2)) * std::log(eT(2) * Datum<eT>::pi);
+  
+  chol_fcovs.set_size(N_dims, N_dims, N_gaus);
+  
+  log_det_etc.set_size(N_gaus);
+  
+  Mat<eT> R;
+  
+  for(uword g=0; g < N_gaus; ++g)
+    {
+    if( (N_dims > 0) && auxlib::chol(R, fcovs.slice(g), 0) )
+      {
+      chol_fcovs.slice(g) = R;
+      
+      // log(det(C)) = 2*sum(log(diag(R)))
+      
+      eT half_logdet = eT(0);
+      
+      for(uword d=0; d < N_dims; ++d)  { half_logdet += std::log( R.at(d,d) ); }
+      
+      log_det_etc[g] = eT(-1) * ( tmp + half_logdet );
+      }
+    else
+      {
+      chol_fcovs.slice(g).eye();
+      
+      log_det_etc[g] = (N_dims > 0) ? -Datum<eT>::inf : eT(0);
+      }
+    }
+  
+  eT* hefts_mem = access::rw(hefts).memptr();
+  
+  for(uword i=0; i<N_gaus; ++i)
+    {
+    hefts_mem[i] = (std::max)( hefts_mem[i], std::numeric_limits<eT>::min() );
+    }
+  
+  log_hefts = log(hefts);
+  }
+
+
+
+//! chunks of vectors for the tasks of a parallel operation: at most one chunk per thread of the executor,
+//! and only one chunk when there is too little work to make use of several threads
+template<typename eT>
+inline
+umat
+gmm_full<eT>::internal_gen_boundaries(const uword N) const
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword n_threads_max = get_executor().n_threads();
+  
+  // the triangular solves cost about n_dims^2 per vector and Gaussian
+  
+  const double work_per_vec = double( (std::max)( uword(1), means.n_rows * means.n_rows * means.n_cols ) );
+  const double work_min     = double(65536);
+  
+  const uword n_threads_work = uword( (std::min)( double(N) * work_per_vec / work_min, double(n_threads_max) ) );
+  
+  const uword n_threads = (std::max)( uword(1), (std::min)(n_threads_work, N) );
+  
+  umat boundaries(2, n_threads);
+  
+  if(N > 0)
+    {
+    const uword chunk_size = N / n_threads;
+    
+    uword count = 0;
+    
+    for(uword t=0; t<n_threads; t++)
+      {
+      boundaries.at(0,t) = count;
+      
+      count += chunk_size;
+      
+      boundaries.at(1,t) = count-1;
+      }
+    
+    boundaries.at(1,n_threads-1) = N - 1;
+    }
+  else
+    {
+    boundaries.zeros();
+    }
+  
+  return boundaries;
+  }
+
+
+
+//! the executor given to set_executor(), or the default executor
+template<typename eT>
+inline
+executor&
+gmm_full<eT>::get_executor() const
+  {
+  return (exec_ptr != 0) ? (*exec_ptr) : default_executor();
+  }
+
+
+
+//! copy columns start to (start + n - 1) of X into XT, transposed, so that each dimension is contiguous (XT has n rows)
+template<typename eT>
+template<typename T1>
+inline
+void
+gmm_full<eT>::internal_block_gather(eT* XT, const T1& X, const uword start, const uword n) const
+  {
+  const uword N_dims = means.n_rows;
+  
+  for(uword j=0; j < n; ++j)
+    {
+    const eT* x = X.colptr(start + j);
+    
+    for(uword d=0; d < N_dims; ++d)  { XT[j + d*n] = x[d]; }
+    }
+  }
+
+
+
+//! log-likelihoods of a block of n vectors (stored transposed in XT) according to Gaussian g;
+//! trans(R)*z = x - mean is solved by forward substitution for all the vectors at once, with the innermost loops running over the vectors;
+//! the Mahalanobis distance of each vector is then the sum of the squares of its z.
+//! Z is workspace with n*n_dims elements
+template<typename eT>
+arma_hot
+inline
+void
+gmm_full<eT>::internal_block_log_p(eT* out, const eT* XT, const uword n, const uword g, eT* Z) const
+  {
+  const uword N_dims = means.n_rows;
+  
+  const eT*      mean = means.colptr(g);
+  const Mat<eT>& R    = chol_fcovs.slice(g);
+  
+  arrayops::fill_zeros(out, n);
+  
+  for(uword d=0; d < N_dims; ++d)
+    {
+    // column d of R holds row d of the lower triangular trans(R)
+    const eT* R_col = R.colptr(d);
+    
+    const eT* x_d = &XT[d*n];
+          eT* z_d = &Z[d*n];
+    
+    const eT mean_d = mean[d];
+    
+    for(uword j=0; j < n; ++j)  { z_d[j] = x_d[j] - mean_d; }
+    
+    for(uword k=0; k < d; ++k)
+      {
+      const eT  a   = R_col[k];
+      const eT* z_k = &Z[k*n];
+      
+      for(uword j=0; j < n; ++j)  { z_d[j] -= a * z_k[j]; }
+      }
+    
+    const eT inv_r = eT(1) / R_col[d];
+    
+    for(uword j=0; j < n; ++j)
+      {
+      const eT val = z_d[j] * inv_r;
+      
+      z_d[j]  = val;
+      out[j] += val*val;
+      }
+    }
+  
+  const eT log_det_etc_g = log_det_etc[g];
+  
+  for(uword j=0; j < n; ++j)  { out[j] = eT(-0.5)*out[j] + log_det_etc_g; }
+  }
+
+
+
+//! out is an n x n_gaus matrix, with element (j,g) set to the log-likelihood of vector j according to Gaussian g, plus the log of the heft
+template<typename eT>
+inline
+void
+gmm_full<eT>::internal_block_log_lhoods(eT* out, const eT* XT, const uword n, eT* Z) const
+  {
+  const uword N_gaus = means.n_cols;
+  
+  for(uword g=0; g < N_gaus; ++g)
+    {
+    eT* out_g = &out[g*n];
+    
+    internal_block_log_p(out_g, XT, n, g, Z);
+    
+    const eT log_heft = log_hefts[g];
+    
+    for(uword j=0; j < n; ++j)  { out_g[j] += log_heft; }
+    }
+  }
+
+
+
+template<typename eT>
+inline
+eT
+gmm_full<eT>::internal_scalar_log_p(const eT* x, const uword gaus_id) const
+  {
+  arma_extra_debug_sigprint();
+  
+  podarray<eT> Z( means.n_rows );
+  
+  eT val;
+  
+  internal_block_log_p(&val, x, 1, gaus_id, Z.memptr());
+  
+  return val;
+  }
+
+
+
+template<typename eT>
+inline
+eT
+gmm_full<eT>::internal_scalar_log_p(const eT* x) const
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword N_gaus = means.n_cols;
+  
+  if(N_gaus == 0)  { return -Datum<eT>::inf; }
+  
+  podarray<eT> Z   ( means.n_rows );
+  podarray<eT> vals( N_gaus       );
+  
+  internal_block_log_lhoods(vals.memptr(), x, 1, Z.memptr());
+  
+  eT log_sum = vals[0];
+  
+  for(uword g=1; g < N_gaus; ++g)  { log_sum = log_add_exp(log_sum, vals[g]); }
+  
+  return log_sum;
+  }
+
+
+
+//! log-likelihoods of vectors start_index to end_index (inclusive) of X, according to Gaussian gaus_id,
+//! or according to the entire model if gaus_id is n_gaus
+template<typename eT>
+template<typename T1>
+inline
+void
+gmm_full<eT>::internal_vec_log_p_worker(eT* out, const T1& X, const uword start_index, const uword end_index, const uword gaus_id) const
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword N_dims = means.n_rows;
+  const uword N_gaus = means.n_cols;
+  
+  const bool use_all = (gaus_id == N_gaus);
+  
+  podarray<eT> XT( N_dims * block_size );
+  podarray<eT> Z ( N_dims * block_size );
+  podarray<eT> G ( (use_all ? N_gaus : uword(0)) * block_size );
+  
+  for(uword start=start_index; start <= end_index; start += block_size)
+    {
+    const uword n = (std::min)(uword(block_size), end_index + 1 - start);
+    
+    internal_block_gather(XT.memptr(), X, start, n);
+    
+    eT* out_block = &out[start];
+    
+    if(use_all == false)
+      {
+      internal_block_log_p(out_block, XT.memptr(), n, gaus_id, Z.memptr());
+      }
+    else
+      {
+      const eT* G_mem = G.memptr();
+      
+      internal_block_log_lhoods(G.memptr(), XT.memptr(), n, Z.memptr());
+      
+      for(uword j=0; j < n; ++j)
+        {
+        eT log_sum = G_mem[j];
+        
+        for(uword g=1; g < N_gaus; ++g)  { log_sum = log_add_exp(log_sum, G_mem[j + g*n]); }
+        
+        out_block[j] = log_sum;
+        }
+      }
+    }
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+Row<eT>
+gmm_full<eT>::internal_vec_log_p(const T1& X, const uword gaus_id) const
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_debug_check( (X.n_rows != means.n_rows), "gmm_full::log_p(): incompatible dimensions" );
+  
+  const uword N = X.n_cols;
+  
+  Row<eT> out(N);
+  
+  if(N > 0)
+    {
+    if(means.n_cols == 0)  { out.fill(-Datum<eT>::inf); return out; }
+    
+    struct job_type : public executor_job
+      {
+      const gmm_full<eT>& model;
+      const T1&           X;
+      const umat&         boundaries;
+      const uword         gaus_id;
+            eT*           out_mem;
+      
+      inline job_type(const gmm_full<eT>& in_model, const T1& in_X, const umat& in_boundaries, const uword in_gaus_id, eT* in_out_mem)
+        : model(in_model), X(in_X), boundaries(in_boundaries), gaus_id(in_gaus_id), out_mem(in_out_mem) {}
+      
+      inline void run_task(const uword t)
+        {
+        model.internal_vec_log_p_worker(out_mem, X, boundaries.at(0,t), boundaries.at(1,t), gaus_id);
+        }
+      };
+    
+    const umat boundaries = internal_gen_boundaries(N);
+    
+    job_type job(*this, X, boundaries, gaus_id, out.memptr());
+    
+    get_executor().run(job, boundaries.n_cols);
+    }
+  
+  return out;
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+eT
+gmm_full<eT>::internal_avg_log_p(const T1& X, const uword gaus_id) const
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_debug_check( (X.n_rows != means.n_rows), "gmm_full::avg_log_p(): incompatible dimensions" );
+  
+  if(X.n_cols == 0)  { return (-Datum<eT>::inf); }
+  
+  const Row<eT> vals = internal_vec_log_p(X, gaus_id);
+  
+  running_mean_scalar<eT> running_mean;
+  
+  const eT* vals_mem = vals.memptr();
+  
+  for(uword i=0; i < vals.n_elem; ++i)  { running_mean(vals_mem[i]); }
+  
+  return running_mean.mean();
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+void
+gmm_full<eT>::internal_vec_assign_worker(uword* out, const T1& X, const uword start_index, const uword end_index, const gmm_dist_mode& dist_mode) const
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword N_dims = means.n_rows;
+  const uword N_gaus = means.n_cols;
+  
+  if(dist_mode == eucl_dist)
+    {
+    for(uword i=start_index; i <= end_index; ++i)
+      {
+      const eT* X_colptr = X.colptr(i);
+      
+      eT    best_dist = Datum<eT>::inf;
+      uword best_g    = 0;
+      
+      for(uword g=0; g < N_gaus; ++g)
+        {
+        const eT tmp_dist = distance<eT,1>::eval(N_dims, X_colptr, means.colptr(g), X_colptr);
+        
+        if(tmp_dist <= best_dist)
+          {
+          best_dist = tmp_dist;
+          best_g    = g;
+          }
+        }
+      
+      out[i] = best_g;
+      }
+    }
+  else
+  if(dist_mode == prob_dist)
+    {
+    podarray<eT> XT( N_dims * block_size );
+    podarray<eT> Z ( N_dims * block_size );
+    podarray<eT> G ( N_gaus * block_size );
+    
+    const eT* G_mem = G.memptr();
+    
+    for(uword start=start_index; start <= end_index; start += block_size)
+      {
+      const uword n = (std::min)(uword(block_size), end_index + 1 - start);
+      
+      internal_block_gather(XT.memptr(), X, start, n);
+      
+      internal_block_log_lhoods(G.memptr(), XT.memptr(), n, Z.memptr());
+      
+      for(uword j=0; j < n; ++j)
+        {
+        eT    best_p = -Datum<eT>::inf;
+        uword best_g = 0;
+        
+        for(uword g=0; g < N_gaus; ++g)
+          {
+          const eT tmp_p = G_mem[j + g*n];
+          
+          if(tmp_p >= best_p)
+            {
+            best_p = tmp_p;
+            best_g = g;
+            }
+          }
+        
+        out[start + j] = best_g;
+        }
+      }
+    }
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+void
+gmm_full<eT>::internal_vec_assign(urowvec& out, const T1& X, const gmm_dist_mode& dist_mode) const
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword N_dims = means.n_rows;
+  const uword N_gaus = means.n_cols;
+  
+  arma_debug_check( (X.n_rows != N_dims), "gmm_full::assign(): incompatible dimensions" );
+  
+  arma_debug_check( ((dist_mode != eucl_dist) && (dist_mode != prob_dist)), "gmm_full::assign(): unsupported distance mode" );
+  
+  const uword X_n_cols = (N_gaus > 0) ? X.n_cols : 0;
+  
+  out.set_size(1,X_n_cols);
+  
+  if(X_n_cols == 0)  { return; }
+  
+  struct job_type : public executor_job
+    {
+    const gmm_full<eT>&  model;
+    const T1&            X;
+    const umat&          boundaries;
+    const gmm_dist_mode& dist_mode;
+          uword*         out_mem;
+    
+    inline job_type(const gmm_full<eT>& in_model, const T1& in_X, const umat& in_boundaries, const gmm_dist_mode& in_dist_mode, uword* in_out_mem)
+      : model(in_model), X(in_X), boundaries(in_boundaries), dist_mode(in_dist_mode), out_mem(in_out_mem) {}
+    
+    inline void run_task(const uword t)
+      {
+      model.internal_vec_assign_worker(out_mem, X, boundaries.at(0,t), boundaries.at(1,t), dist_mode);
+      }
+    };
+  
+  const umat boundaries = internal_gen_boundaries(X_n_cols);
+  
+  job_type job(*this, X, boundaries, dist_mode, out.memptr());
+  
+  get_executor().run(job, boundaries.n_cols);
+  }
+
+
+
+//! each vector is assigned to the closest mean; the covariance matrices and hefts are then estimated from the assigned vectors
+template<typename eT>
+template<uword dist_id>
+inline
+void
+gmm_full<eT>::generate_initial_fcovs_and_hefts(const Mat<eT>& X, const eT var_floor, const Col<eT>& mah_aux)
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword N_dims = means.n_rows;
+  const uword N_gaus = means.n_cols;
+  
+  // accumulate around the means, to reduce cancellation errors
+  
+  Mat<eT>    acc_means(N_dims, N_gaus, fill::zeros);
+  Cube<eT>   acc_fcovs(N_dims, N_dims, N_gaus, fill::zeros);
+  Col<uword> counts(N_gaus, fill::zeros);
+  
+  const eT* mah_aux_mem = mah_aux.memptr();
+  
+  podarray<eT> y(N_dims);
+  
+  eT* y_mem = y.memptr();
+  
+  for(uword i=0; i<X.n_cols; ++i)
+    {
+    const eT* X_colptr = X.colptr(i);
+    
+    double min_dist = Datum<eT>::inf;
+    uword  best_g   = 0;
+    
+    for(uword g=0; g<N_gaus; ++g)
+      {
+      const double dist = distance<eT,dist_id>::eval(N_dims, X_colptr, means.colptr(g), mah_aux_mem);
+      
+      if(dist <= min_dist)  { min_dist = dist; best_g = g; }
+      }
+    
+    const eT* mean = means.colptr(best_g);
+    
+    for(uword d=0; d < N_dims; ++d)  { y_mem[d] = X_colptr[d] - mean[d]; }
+    
+    eT*      acc_mean = acc_means.colptr(best_g);
+    Mat<eT>& acc_fcov = acc_fcovs.slice(best_g);
+    
+    for(uword d2=0; d2 < N_dims; ++d2)
+      {
+      const eT y_d2 = y_mem[d2];
+      
+      acc_mean[d2] += y_d2;
+      
+      eT* acc_fcov_col = acc_fcov.colptr(d2);
+      
+      for(uword d1=0; d1 <= d2; ++d1)  { acc_fcov_col[d1] += y_mem[d1] * y_d2; }
+      }
+    
+    counts[best_g]++;
+    }
+  
+  for(uword g=0; g<N_gaus; ++g)
+    {
+    const uword count = counts[g];
+    
+    Mat<eT>& fcov = access::rw(fcovs).slice(g);
+    
+    if(count >= 2)
+      {
+      const eT* acc_mean = acc_means.colptr(g);
+      
+      const Mat<eT>& acc_fcov = acc_fcovs.slice(g);
+      
+      // unbiased estimate, as per running_stat_vec::cov(0)
+      
+      for(uword d2=0; d2 < N_dims; ++d2)
+      for(uword d1=0; d1 <= d2;    ++d1)
+        {
+        const eT val = ( acc_fcov.at(d1,d2) - acc_mean[d1]*acc_mean[d2]/eT(count) ) / eT(count - 1);
+        
+        fcov.at(d1,d2) = val;
+        fcov.at(d2,d1) = val;
+        }
+      }
+    else
+      {
+      fcov.eye();
+      }
+    
+    access::rw(hefts)(g) = (std::max)( (eT(count) / eT(X.n_cols)), std::numeric_limits<eT>::min() );
+    }
+  
+  em_fix_params(var_floor);
+  }
+
+
+
+//! multi-threaded implementation of Expectation-Maximisation, inspired by MapReduce
+template<typename eT>
+inline
+bool
+gmm_full<eT>::em_iterate(const Mat<eT>& X, const uword max_iter, const eT var_floor, const bool verbose)
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword N_dims = means.n_rows;
+  const uword N_gaus = means.n_cols;
+  
+  if(verbose)
+    {
+    get_stream_err2().unsetf(ios::showbase);
+    get_stream_err2().unsetf(ios::uppercase);
+    get_stream_err2().unsetf(ios::showpos);
+    get_stream_err2().unsetf(ios::scientific);
+    
+    get_stream_err2().setf(ios::right);
+    get_stream_err2().setf(ios::fixed);
+    }
+  
+  const umat boundaries = internal_gen_boundaries(X.n_cols);
+  
+  const uword n_threads = boundaries.n_cols;
+  
+  field< Mat<eT>  > t_acc_means(n_threads);
+  field< Cube<eT> > t_acc_fcovs(n_threads);
+  
+  field< Col<eT> > t_acc_norm_lhoods(n_threads);
+  
+  Col<eT>          t_progress_log_lhood(n_threads);
+  
+  for(uword t=0; t<n_threads; t++)
+    {
+    t_acc_means[t].set_size(N_dims, N_gaus);
+    t_acc_fcovs[t].set_size(N_dims, N_dims, N_gaus);
+    
+    t_acc_norm_lhoods[t].set_size(N_gaus);
+    }
+
+  
+  if(verbose)
+    {
+    get_stream_err2() << "gmm_full::learn(): EM: n_threads: " << n_threads  << '\n';
+    }
+  
+  eT old_avg_log_p = -Datum<eT>::inf;
+  
+  for(uword iter=1; iter <= max_iter; ++iter)
+    {
+    init_constants();
+    
+    em_update_params(X, boundaries, t_acc_means, t_acc_fcovs, t_acc_norm_lhoods, t_progress_log_lhood);
+    
+    em_fix_params(var_floor);
+    
+    const eT new_avg_log_p = accu(t_progress_log_lhood) / eT(X.n_cols);
+    
+    if(verbose)
+      {
+      get_stream_err2() << "gmm_full::learn(): EM: iteration: ";
+      get_stream_err2().unsetf(ios::scientific);
+      get_stream_err2().setf(ios::fixed);
+      get_stream_err2().width(std::streamsize(4));
+      get_stream_err2() << iter;
+      get_stream_err2() << "   avg_log_p: ";
+      get_stream_err2().unsetf(ios::fixed);
+      //get_stream_err2().setf(ios::scientific);
+      get_stream_err2() << new_avg_log_p << '\n';
+      }
+    
+    if(is_finite(new_avg_log_p) == false)  { return false; }
+    
+    if(std::abs(old_avg_log_p - new_avg_log_p) <= Datum<eT>::eps)  { break; }
+    
+    
+    old_avg_log_p = new_avg_log_p;
+    }
+  
+  
+  if(means.is_finite() == false)  { return false; }
+  if(fcovs.is_finite() == false)  { return false; }
+  if(hefts.is_finite() == false)  { return false; }
+  
+  return true;
+  }
+
+
+
+template<typename eT>
+inline
+void
+gmm_full<eT>::em_update_params
+  (
+  const Mat<eT>&           X,
+  const umat&              boundaries,
+        field< Mat<eT>  >& t_acc_means,
+        field< Cube<eT> >& t_acc_fcovs,
+        field< Col<eT>  >& t_acc_norm_lhoods,
+        Col<eT>&           t_progress_log_lhood
+  )
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword n_threads = boundaries.n_cols;
+  
+  
+  // em_generate_acc() is the "map" operation, which produces partial accumulators for means, full covariances and hefts
+  
+  struct job_type : public executor_job
+    {
+    const gmm_full<eT>& model;
+    const Mat<eT>&      X;
+    const umat&         boundaries;
+    field< Mat<eT>  >&  t_acc_means;
+    field< Cube<eT> >&  t_acc_fcovs;
+    field< Col<eT>  >&  t_acc_norm_lhoods;
+    Col<eT>&            t_progress_log_lhood;
+    
+    inline job_type(const gmm_full<eT>& in_model, const Mat<eT>& in_X, const umat& in_boundaries, field< Mat<eT> >& in_t_acc_means, field< Cube<eT> >& in_t_acc_fcovs, field< Col<eT> >& in_t_acc_norm_lhoods, Col<eT>& in_t_progress_log_lhood)
+      : model(in_model), X(in_X), boundaries(in_boundaries), t_acc_means(in_t_acc_means), t_acc_fcovs(in_t_acc_fcovs), t_acc_norm_lhoods(in_t_acc_norm_lhoods), t_progress_log_lhood(in_t_progress_log_lhood) {}
+    
+    inline void run_task(const uword t)
+      {
+      Mat<eT>&  acc_means          = t_acc_means[t];
+      Cube<eT>& acc_fcovs          = t_acc_fcovs[t];
+      Col<eT>&  acc_norm_lhoods    = t_acc_norm_lhoods[t];
+      eT&       progress_log_lhood = t_progress_log_lhood[t];
+      
+      model.em_generate_acc(X, boundaries.at(0,t), boundaries.at(1,t), acc_means, acc_fcovs, acc_norm_lhoods, progress_log_lhood);
+      }
+    };
+  
+  job_type job(*this, X, boundaries, t_acc_means, t_acc_fcovs, t_acc_norm_lhoods, t_progress_log_lhood);
+  
+  get_executor().run(job, n_threads);
+  
+  const uword N_dims = means.n_rows;
+  const uword N_gaus = means.n_cols;
+  
+  Mat<eT>&  final_acc_means = t_acc_means[0];
+  Cube<eT>& final_acc_fcovs = t_acc_fcovs[0];
+  
+  Col<eT>&  final_acc_norm_lhoods = t_acc_norm_lhoods[0];
+  
+  
+  // the "reduce" operation, which combines the partial accumulators produced by the separate threads
+  
+  for(uword t=1; t<n_threads; t++)
+    {
+    final_acc_means += t_acc_means[t];
+    final_acc_fcovs += t_acc_fcovs[t];
+    
+    final_acc_norm_lhoods += t_acc_norm_lhoods[t];
+    }
+  
+  
+  // the accumulators are relative to the current means: with y = x - mean,
+  // the new mean is mean + E[y] and the new covariance is E[y*y'] - E[y]*E[y]'
+  
+  eT* hefts_mem = access::rw(hefts).memptr();
+  
+  for(uword g=0; g < N_gaus; ++g)
+    {
+    eT*      mean_mem = access::rw(means).colptr(g);
+    Mat<eT>& fcov     = access::rw(fcovs).slice(g);
+    
+    eT*            acc_mean_mem = final_acc_means.colptr(g);
+    const Mat<eT>& acc_fcov     = final_acc_fcovs.slice(g);
+    
+    const eT acc_norm_lhood = (std::max)( final_acc_norm_lhoods[g], std::numeric_limits<eT>::min() );
+    
+    hefts_mem[g] = acc_norm_lhood / eT(X.n_cols);
+    
+    for(uword d=0; d < N_dims; ++d)  { acc_mean_mem[d] /= acc_norm_lhood; }
+    
+    for(uword d2=0; d2 < N_dims; ++d2)
+    for(uword d1=0; d1 <= d2;    ++d1)
+      {
+      const eT val = acc_fcov.at(d1,d2) / acc_norm_lhood - acc_mean_mem[d1]*acc_mean_mem[d2];
+      
+      fcov.at(d1,d2) = val;
+      fcov.at(d2,d1) = val;
+      }
+    
+    for(uword d=0; d < N_dims; ++d)  { mean_mem[d] += acc_mean_mem[d]; }
+    }
+  }
+
+
+
+//! processes the vectors in blocks: the log-likelihoods for all Gaussians are obtained via batched triangular solves,
+//! and the accumulators for the covariance matrices are updated with dot products over the vectors in the block.
+//! only the upper triangle of each covariance accumulator is updated
+template<typename eT>
+inline
+void
+gmm_full<eT>::em_generate_acc
+  (
+  const Mat<eT>&  X,
+  const uword     start_index,
+  const uword       end_index,
+        Mat<eT>&  acc_means,
+        Cube<eT>& acc_fcovs,
+        Col<eT>&  acc_norm_lhoods,
+        eT&       progress_log_lhood
+  )
+  const
+  {
+  arma_extra_debug_sigprint();
+  
+  progress_log_lhood = eT(0);
+  
+  acc_means.zeros();
+  acc_fcovs.zeros();
+  
+  acc_norm_lhoods.zeros();
+  
+  const uword N_dims = means.n_rows;
+  const uword N_gaus = means.n_cols;
+  
+  podarray<eT> XT( N_dims * block_size );
+  podarray<eT> Z ( N_dims * block_size );
+  podarray<eT> G ( N_gaus * block_size );
+  podarray<eT> W ( block_size );
+  
+  const eT* XT_mem = XT.memptr();
+        eT* Z_mem  = Z.memptr();
+        eT* G_mem  = G.memptr();
+        eT* W_mem  = W.memptr();
+  
+  for(uword start=start_index; start <= end_index; start += block_size)
+    {
+    const uword n = (std::min)(uword(block_size), end_index + 1 - start);
+    
+    internal_block_gather(XT.memptr(), X, start, n);
+    
+    internal_block_log_lhoods(G_mem, XT_mem, n, Z_mem);
+    
+    // convert the log-likelihoods into normalised likelihoods
+    
+    for(uword j=0; j < n; ++j)
+      {
+      eT log_lhood_sum = G_mem[j];
+      
+      for(uword g=1; g < N_gaus; ++g)  { log_lhood_sum = log_add_exp(log_lhood_sum, G_mem[j + g*n]); }
+      
+      progress_log_lhood += log_lhood_sum;
+      
+      for(uword g=0; g < N_gaus; ++g)  { G_mem[j + g*n] = std::exp(G_mem[j + g*n] - log_lhood_sum); }
+      }
+    
+    for(uword g=0; g < N_gaus; ++g)
+      {
+      const eT* norm_lhoods = &G_mem[g*n];
+      
+      const eT* mean = means.colptr(g);
+      
+      eT*      acc_mean = acc_means.colptr(g);
+      Mat<eT>& acc_fcov = acc_fcovs.slice(g);
+      
+      eT acc_norm_lhood = eT(0);
+      
+      for(uword j=0; j < n; ++j)  { acc_norm_lhood += norm_lhoods[j]; }
+      
+      acc_norm_lhoods[g] += acc_norm_lhood;
+      
+      // Z holds the vectors relative to the mean
+      
+      for(uword d=0; d < N_dims; ++d)
+        {
+        const eT* x_d = &XT_mem[d*n];
+              eT* z_d = &Z_mem[d*n];
+        
+        const eT mean_d = mean[d];
+        
+        for(uword j=0; j < n; ++j)  { z_d[j] = x_d[j] - mean_d; }
+        }
+      
+      for(uword d1=0; d1 < N_dims; ++d1)
+        {
+        const eT* z_d1 = &Z_mem[d1*n];
+        
+        for(uword j=0; j < n; ++j)  { W_mem[j] = norm_lhoods[j] * z_d1[j]; }
+        
+        eT acc = eT(0);
+        
+        for(uword j=0; j < n; ++j)  { acc += W_mem[j]; }
+        
+        acc_mean[d1] += acc;
+        
+        for(uword d2=d1; d2 < N_dims; ++d2)
+          {
+          acc_fcov.at(d1,d2) += op_dot::direct_dot(n, W_mem, &Z_mem[d2*n]);
+          }
+        }
+      }
+    }
+  }
+
+
+
+//! the covariance matrices are made symmetric, their diagonals are floored,
+//! and any matrix that is still not positive definite is regularised by adding to its diagonal
+template<typename eT>
+inline
+void
+gmm_full<eT>::em_fix_params(const eT var_floor)
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword N_dims = means.n_rows;
+  const uword N_gaus = means.n_cols;
+  
+  Mat<eT> R;
+  
+  for(uword g=0; g < N_gaus; ++g)
+    {
+    Mat<eT>& fcov = access::rw(fcovs).slice(g);
+    
+    for(uword d2=0; d2 < N_dims; ++d2)
+    for(uword d1=0; d1 <  d2;    ++d1)
+      {
+      const eT val = eT(0.5) * (fcov.at(d1,d2) + fcov.at(d2,d1));
+      
+      fcov.at(d1,d2) = val;
+      fcov.at(d2,d1) = val;
+      }
+    
+    for(uword d=0; d < N_dims; ++d)
+      {
+      if(fcov.at(d,d) < var_floor)  { fcov.at(d,d) = var_floor; }
+      }
+    
+    if(auxlib::chol(R, fcov, 0))  { continue; }
+    
+    const eT max_diag = (N_dims > 0) ? fcov.diag().max() : eT(0);
+    
+    eT delta = (std::max)( var_floor, max_diag * eT(1e3) * std::numeric_limits<eT>::epsilon() );
+    
+    bool ok = false;
+    
+    for(uword attempt=0; attempt < 8; ++attempt)
+      {
+      fcov.diag() += delta;
+      
+      if(auxlib::chol(R, fcov, 0))  { ok = true; break; }
+      
+      delta *= eT(10);
+      }
+    
+    if(ok == false)
+      {
+      const Col<eT> fcov_diag = fcov.diag();
+      
+      fcov = diagmat(fcov_diag);
+      }
+    }
+  
+  const eT heft_sum = accu(hefts);
+  
+  if(heft_sum != eT(1))  { access::rw(hefts) /= heft_sum; }
+  }
+
+
+}
+
+
+//! @}
@@ -0,0 +1,20 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+
+#if defined(ARMA_USE_FFTW3)
+
+// fftw3.h is not needed: only a small part of the FFTW3 interface is used (see def_fftw3.hpp).
+// the plan types are declared in the same way as in fftw3.h, so that user code can still include fftw3.h
+
+struct fftw_plan_s;
+struct fftwf_plan_s;
+
+#endif
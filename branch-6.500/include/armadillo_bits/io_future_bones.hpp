@@ -0,0 +1,161 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup io_future
+//! @{
+
+
+#if defined(ARMA_USE_CXX11)
+
+
+//! shared state of an asynchronous save or load operation
+class io_future_state
+  {
+  public:
+  
+  inline io_future_state();
+  
+  inline void set(const bool in_status, const std::string& in_err_msg);
+  inline void wait();
+  
+  std::mutex              mutex_obj;
+  std::condition_variable cond_obj;
+  
+  bool        done;
+  bool        status;
+  std::string err_msg;
+  };
+
+
+
+//! handle to the result of an asynchronous save or load operation;
+//! the object being loaded must not be accessed until the operation has completed.
+//! copies of a handle share the operation; destroying the last copy waits for the operation to complete,
+//! as a load may still be writing into the destination object
+class io_future
+  {
+  public:
+  
+  inline  io_future();
+  inline ~io_future();
+  
+  inline explicit io_future(const std::shared_ptr<io_future_state>& in_state);
+  
+  inline bool valid()    const;  //!< true if the handle is associated with an operation
+  inline bool is_ready() const;  //!< true if the operation has completed; does not block
+  inline void wait()     const;  //!< block until the operation has completed
+  inline bool get()      const;  //!< block until the operation has completed, then return its status
+  
+  inline std::string err_msg() const;  //!< block until the operation has completed, then return its diagnostics
+  
+  
+  private:
+  
+  //! used as the deleter of the handles' pointer to the state, so it runs when the last copy of a handle is destroyed;
+  //! holds its own reference, as the state must outlive the wait
+  struct waiter
+    {
+    std::shared_ptr<io_future_state> keep;
+    
+    inline explicit waiter(const std::shared_ptr<io_future_state>& in_keep) : keep(in_keep) {}
+    
+    inline void operator()(io_future_state*) const { keep->wait(); }
+    };
+  
+  std::shared_ptr<io_future_state> state;
+  };
+
+
+
+//! single background thread which runs queued I/O tasks in submission order
+class io_worker
+  {
+  public:
+  
+  inline static io_worker& get_instance();
+  
+  inline void submit(const std::function<void()>& task);
+  
+  inline ~io_worker();
+  
+  
+  private:
+  
+  inline io_worker();
+  
+  inline io_worker(const io_worker&);
+  inline void operator=(const io_worker&);
+  
+  inline void run();
+  
+  std::mutex                         mutex_obj;
+  std::condition_variable            cond_obj;
+  std::deque< std::function<void()> > tasks;
+  bool                               stop;
+  std::thread                        thread_obj;
+  };
+
+
+
+//! dispatchers and tasks used by save_async() and load_async()
+class io_async
+  {
+  public:
+  
+  template<typename eT> inline static bool save(const Mat<eT>&   x, const std::string& name, const file_type type, std::string& err_msg);
+  template<typename eT> inline static bool save(const Cube<eT>&  x, const std::string& name, const file_type type, std::string& err_msg);
+  template<typename eT> inline static bool save(const SpMat<eT>& x, const std::string& name, const file_type type, std::string& err_msg);
+  template<typename oT> inline static bool save(const field<oT>& x, const std::string& name, const file_type type, std::string& err_msg);
+  
+  template<typename eT> inline static bool load(Mat<eT>&   x, const std::string& name, const file_type type, std::string& err_msg);
+  template<typename eT> inline static bool load(Cube<eT>&  x, const std::string& name, const file_type type, std::string& err_msg);
+  template<typename eT> inline static bool load(SpMat<eT>& x, const std::string& name, const file_type type, std::string& err_msg);
+  template<typename oT> inline static bool load(field<oT>& x, const std::string& name, const file_type type, std::string& err_msg);
+  
+  template<typename obj_type> inline static io_future submit_save(const obj_type& x, const std::string& name, const file_type type, const bool print_status, const char* sig);
+  template<typename obj_type> inline static io_future submit_load(      obj_type& x, const std::string& name, const file_type type, const bool print_status, const char* sig);
+  
+  
+  //! saves a private snapshot of the object, so the caller is free to modify the original
+  template<typename obj_type>
+  struct save_task
+    {
+    std::shared_ptr<const obj_type>  snapshot;
+    std::string                      name;
+    file_type                        type;
+    bool                             print_status;
+    const char*                      sig;
+    std::shared_ptr<io_future_state> state;
+    
+    inline void operator()() const;
+    };
+  
+  
+  //! loads directly into the destination object
+  template<typename obj_type>
+  struct load_task
+    {
+    obj_type*                        dest;
+    std::string                      name;
+    file_type                        type;
+    bool                             print_status;
+    const char*                      sig;
+    std::shared_ptr<io_future_state> state;
+    
+    inline void operator()() const;
+    };
+  };
+
+
+
+#endif
+
+
+//! @}
@@ -0,0 +1,472 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup io_future
+//! @{
+
+
+#if defined(ARMA_USE_CXX11)
+
+
+inline
+io_future_state::io_future_state()
+  : done(false)
+  , status(false)
+  {
+  arma_extra_debug_sigprint();
+  }
+
+
+
+inline
+void
+io_future_state::set(const bool in_status, const std::string& in_err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+    {
+    std::lock_guard<std::mutex> lock(mutex_obj);
+    
+    status  = in_status;
+    err_msg = in_err_msg;
+    done    = true;
+    }
+  
+  cond_obj.notify_all();
+  }
+
+
+
+inline
+void
+io_future_state::wait()
+  {
+  arma_extra_debug_sigprint();
+  
+  std::unique_lock<std::mutex> lock(mutex_obj);
+  
+  while(done == false)  { cond_obj.wait(lock); }
+  }
+
+
+
+//
+// io_future
+
+
+
+inline
+io_future::io_future()
+  {
+  arma_extra_debug_sigprint_this(this);
+  }
+
+
+
+//! if this is the last copy of the handle, waits for the operation to complete (via io_future::waiter)
+inline
+io_future::~io_future()
+  {
+  arma_extra_debug_sigprint_this(this);
+  }
+
+
+
+inline
+io_future::io_future(const std::shared_ptr<io_future_state>& in_state)
+  : state(in_state.get(), waiter(in_state))
+  {
+  arma_extra_debug_sigprint_this(this);
+  }
+
+
+
+inline
+bool
+io_future::valid() const
+  {
+  return bool(state);
+  }
+
+
+
+inline
+bool
+io_future::is_ready() const
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_debug_check( (bool(state) == false), "io_future::is_ready(): handle is not associated with an operation" );
+  
+  std::lock_guard<std::mutex> lock(state->mutex_obj);
+  
+  return state->done;
+  }
+
+
+
+inline
+void
+io_future::wait() const
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_debug_check( (bool(state) == false), "io_future::wait(): handle is not associated with an operation" );
+  
+  state->wait();
+  }
+
+
+
+inline
+bool
+io_future::get() const
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_debug_check( (bool(state) == false), "io_future::get(): handle is not associated with an operation" );
+  
+  state->wait();
+  
+  return state->status;
+  }
+
+
+
+inline
+std::string
+io_future::err_msg() const
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_debug_check( (bool(state) == false), "io_future::err_msg(): handle is not associated with an operation" );
+  
+  state->wait();
+  
+  return state->err_msg;
+  }
+
+
+
+//
+// io_worker
+
+
+
+inline
+io_worker&
+io_worker::get_instance()
+  {
+  static io_worker instance;
+  
+  return instance;
+  }
+
+
+
+inline
+io_worker::io_worker()
+  : stop(false)
+  , thread_obj(&io_worker::run, this)
+  {
+  arma_extra_debug_sigprint_this(this);
+  }
+
+
+
+//! pending tasks are completed before the thread is shut down
+inline
+io_worker::~io_worker()
+  {
+  arma_extra_debug_sigprint_this(this);
+  
+    {
+    std::lock_guard<std::mutex> lock(mutex_obj);
+    
+    stop = true;
+    }
+  
+  cond_obj.notify_all();
+  
+  if(thread_obj.joinable())  { thread_obj.join(); }
+  }
+
+
+
+inline
+void
+io_worker::submit(const std::function<void()>& task)
+  {
+  arma_extra_debug_sigprint();
+  
+    {
+    std::lock_guard<std::mutex> lock(mutex_obj);
+    
+    tasks.push_back(task);
+    }
+  
+  cond_obj.notify_one();
+  }
+
+
+
+inline
+void
+io_worker::run()
+  {
+  arma_extra_debug_sigprint();
+  
+  while(true)
+    {
+    std::function<void()> task;
+    
+      {
+      std::unique_lock<std::mutex> lock(mutex_obj);
+      
+      while( (stop == false) && tasks.empty() )  { cond_obj.wait(lock); }
+      
+      if(tasks.empty())  { return; }
+      
+      task = tasks.front();
+      
+      tasks.pop_front();
+      }
+    
+    task();
+    }
+  }
+
+
+
+//
+// io_async
+
+
+
+template<typename eT>
+inline
+bool
+io_async::save(const Mat<eT>& x, const std::string& name, const file_type type, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  return diskio::save(x, name, type, err_msg);
+  }
+
+
+
+template<typename eT>
+inline
+bool
+io_async::save(const Cube<eT>& x, const std::string& name, const file_type type, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  return diskio::save(x, name, type, err_msg);
+  }
+
+
+
+template<typename eT>
+inline
+bool
+io_async::save(const SpMat<eT>& x, const std::string& name, const file_type type, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  return diskio::save(x, name, type, err_msg);
+  }
+
+
+
+template<typename oT>
+inline
+bool
+io_async::save(const field<oT>& x, const std::string& name, const file_type type, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  return field_aux::save(x, name, type, err_msg);
+  }
+
+
+
+template<typename eT>
+inline
+bool
+io_async::load(Mat<eT>& x, const std::string& name, const file_type type, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  return diskio::load(x, name, type, err_msg);
+  }
+
+
+
+template<typename eT>
+inline
+bool
+io_async::load(Cube<eT>& x, const std::string& name, const file_type type, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  return diskio::load(x, name, type, err_msg);
+  }
+
+
+
+template<typename eT>
+inline
+bool
+io_async::load(SpMat<eT>& x, const std::string& name, const file_type type, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  return diskio::load(x, name, type, err_msg);
+  }
+
+
+
+template<typename oT>
+inline
+bool
+io_async::load(field<oT>& x, const std::string& name, const file_type type, std::string& err_msg)
+  {
+  arma_extra_debug_sigprint();
+  
+  return field_aux::load(x, name, type, err_msg);
+  }
+
+
+
+template<typename obj_type>
+inline
+io_future
+io_async::submit_save(const obj_type& x, const std::string& name, const file_type type, const bool print_status, const char* sig)
+  {
+  arma_extra_debug_sigprint();
+  
+  std::shared_ptr<io_future_state> state(new io_future_state);
+  
+  save_task<obj_type> task;
+  
+  task.snapshot     = std::shared_ptr<const obj_type>(new obj_type(x));
+  task.name         = name;
+  task.type         = type;
+  task.print_status = print_status;
+  task.sig          = sig;
+  task.state        = state;
+  
+  io_worker::get_instance().submit(task);
+  
+  return io_future(state);
+  }
+
+
+
+template<typename obj_type>
+inline
+io_future
+io_async::submit_load(obj_type& x, const std::string& name, const file_type type, const bool print_status, const char* sig)
+  {
+  arma_extra_debug_sigprint();
+  
+  std::shared_ptr<io_future_state> state(new io_future_state);
+  
+  load_task<obj_type> task;
+  
+  task.dest         = &x;
+  task.name         = name;
+  task.type         = type;
+  task.print_status = print_status;
+  task.sig          = sig;
+  task.state        = state;
+  
+  io_worker::get_instance().submit(task);
+  
+  return io_future(state);
+  }
+
+
+
+template<typename obj_type>
+inline
+void
+io_async::save_task<obj_type>::operator()() const
+  {
+  arma_extra_debug_sigprint();
+  
+  bool        save_okay = false;
+  std::string err_msg;
+  std::string msg;
+  
+  try
+    {
+    save_okay = io_async::save(*snapshot, name, type, err_msg);
+    
+    if(save_okay == false)
+      {
+      msg = (err_msg.length() > 0) ? (std::string(sig) + ": " + err_msg + name) : (std::string(sig) + ": couldn't write to " + name);
+      }
+    }
+  catch(const std::exception& e)
+    {
+    save_okay = false;
+    msg       = std::string(sig) + ": " + e.what();
+    }
+  
+  if(print_status && (save_okay == false))  { arma_debug_warn(msg); }
+  
+  state->set(save_okay, msg);
+  }
+
+
+
+template<typename obj_type>
+inline
+void
+io_async::load_task<obj_type>::operator()() const
+  {
+  arma_extra_debug_sigprint();
+  
+  bool        load_okay = false;
+  std::string err_msg;
+  std::string msg;
+  
+  try
+    {
+    load_okay = io_async::load(*dest, name, type, err_msg);
+    
+    if(load_okay == false)
+      {
+      msg = (err_msg.length() > 0) ? (std::string(sig) + ": " + err_msg + name) : (std::string(sig) + ": couldn't read " + name);
+      
+      (*dest).reset();
+      }
+    }
+  catch(const std::exception& e)
+    {
+    load_okay = false;
+    msg       = std::string(sig) + ": " + e.what();
+    
+    (*dest).reset();
+    }
+  
+  if(print_status && (load_okay == false))  { arma_debug_warn(msg); }
+  
+  state->set(load_okay, msg);
+  }
+
+
+
+#endif
+
+
+//! @}
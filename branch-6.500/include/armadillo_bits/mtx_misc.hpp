@@ -0,0 +1,753 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup mtx_misc
+//! @{
+
+
+//! helpers for reading and writing co-ordinate text files:
+//! Matrix Market (.mtx) files and the simpler coord_ascii format
+namespace mtx_misc
+{
+
+
+//! layout of the entries in a co-ordinate text file
+struct layout
+  {
+  bool  is_mtx;    //!< Matrix Market file (1-based indices, comments allowed) or coord_ascii (0-based indices, a blank line ends the data)
+  char  field;     //!< 'r' (real), 'i' (integer), 'c' (complex) or 'p' (pattern)
+  char  symmetry;  //!< 'g' (general), 's' (symmetric), 'k' (skew-symmetric) or 'h' (hermitian)
+  uword n_rows;    //!< size given in the header of a Matrix Market file
+  uword n_cols;
+  };
+
+
+
+//! entries parsed from a block of lines
+template<typename eT>
+struct coo_block
+  {
+  std::vector<uword> rows;
+  std::vector<uword> cols;
+  std::vector<eT>    vals;
+  
+  uword n_lines;  //!< number of lines with entries, including lines with zero values
+  uword max_row;
+  uword max_col;
+  bool  stop;     //!< a blank line was found in coord_ascii data
+  bool  ok;
+  
+  inline
+  void
+  reset()
+    {
+    rows.clear();
+    cols.clear();
+    vals.clear();
+    
+    n_lines = 0;
+    max_row = 0;
+    max_col = 0;
+    stop    = false;
+    ok      = true;
+    }
+  };
+
+
+
+inline
+uword
+get_n_threads()
+  {
+  #if defined(_OPENMP)
+    return uword( (std::max)(int(1), int(omp_get_max_threads())) );
+  #else
+    return uword(1);
+  #endif
+  }
+
+
+
+inline
+const char*
+skip_blanks(const char* p)
+  {
+  while( (*p == ' ') || (*p == '\t') || (*p == '\r') )  { ++p; }
+  
+  return p;
+  }
+
+
+
+//! the data must contain a newline at or after p
+inline
+const char*
+skip_line(const char* p)
+  {
+  while(*p != '\n')  { ++p; }
+  
+  return p;
+  }
+
+
+
+inline
+bool
+parse_index(const char*& p, uword& out)
+  {
+  const char* q = skip_blanks(p);
+  
+  if( (*q < '0') || (*q > '9') )  { return false; }
+  
+  uword val = 0;
+  
+  while( (*q >= '0') && (*q <= '9') )  { val = val*10 + uword(*q - '0'); ++q; }
+  
+  out = val;
+  p   = q;
+  
+  return true;
+  }
+
+
+
+//! integers are parsed directly; everything else (including nan and inf) goes through strtod()
+template<typename eT>
+inline
+bool
+parse_real(const char*& p, eT& out)
+  {
+  p = skip_blanks(p);
+  
+  if( (*p == '\n') || (*p == '\0') )  { return false; }
+  
+  if(is_real<eT>::value == false)
+    {
+    const char* q = p;
+    
+    const bool neg = (*q == '-');
+    
+    if( (*q == '-') || (*q == '+') )  { ++q; }
+    
+    if( (*q >= '0') && (*q <= '9') )
+      {
+      eT val = eT(0);
+      
+      while( (*q >= '0') && (*q <= '9') )  { val = val*eT(10) + eT(*q - '0'); ++q; }
+      
+      if( (*q != '.') && (*q != 'e') && (*q != 'E') )
+        {
+        out = (neg) ? eT(eT(0) - val) : val;
+        p   = q;
+        
+        return true;
+        }
+      }
+    }
+  
+  char* q_end = NULL;
+  
+  const double val = std::strtod(p, &q_end);
+  
+  if(q_end == p)  { return false; }
+  
+  out = eT(val);
+  p   = q_end;
+  
+  return true;
+  }
+
+
+
+//! returns the number of parsed components
+template<typename eT>
+inline
+uword
+parse_elem(const char*& p, eT& out)
+  {
+  return parse_real(p, out) ? uword(1) : uword(0);
+  }
+
+
+
+template<typename T>
+inline
+uword
+parse_elem(const char*& p, std::complex<T>& out)
+  {
+  T a = T(0);
+  T b = T(0);
+  
+  if(parse_real(p, a) == false)  { return 0; }
+  
+  const uword n = parse_real(p, b) ? uword(2) : uword(1);
+  
+  out = std::complex<T>(a, b);
+  
+  return n;
+  }
+
+
+
+//! value of the entry at the transposed location
+template<typename eT>
+inline
+eT
+mirror(const eT val, const char symmetry)
+  {
+  return (symmetry == 'k') ? eT(-val) : val;
+  }
+
+
+
+template<typename T>
+inline
+std::complex<T>
+mirror(const std::complex<T>& val, const char symmetry)
+  {
+  return (symmetry == 'k') ? (-val) : ( (symmetry == 'h') ? std::conj(val) : val );
+  }
+
+
+
+//! parse the lines in [p,end); entries are expanded according to the symmetry of the layout.
+//! if with_values is false, only the locations are stored.
+//! entries with zero values are kept in Matrix Market data, so that both passes of a two-pass load see the same entries
+template<typename eT>
+inline
+void
+parse_lines(const char* p, const char* end, const layout& L, const bool with_values, coo_block<eT>& out)
+  {
+  const bool expand = (L.symmetry != 'g');
+  
+  while(p < end)
+    {
+    p = skip_blanks(p);
+    
+    if(*p == '\n')
+      {
+      if(L.is_mtx == false)  { out.stop = true; return; }
+      
+      ++p;
+      continue;
+      }
+    
+    if( (*p == '%') && (L.is_mtx) )
+      {
+      p = skip_line(p) + 1;
+      continue;
+      }
+    
+    uword row = 0;
+    uword col = 0;
+    
+    if( (parse_index(p, row) == false) || (parse_index(p, col) == false) )  { out.ok = false; return; }
+    
+    if(L.is_mtx)
+      {
+      if( (row == 0) || (col == 0) || (row > L.n_rows) || (col > L.n_cols) )  { out.ok = false; return; }
+      
+      --row;
+      --col;
+      }
+    
+    ++out.n_lines;
+    
+    if(out.max_row < row)  { out.max_row = row; }
+    if(out.max_col < col)  { out.max_col = col; }
+    
+    eT val = eT(1);
+    
+    if( (with_values) && (L.field != 'p') )
+      {
+      val = eT(0);
+      
+      const uword n = parse_elem(p, val);
+      
+      if( (L.is_mtx) && (n < ((L.field == 'c') ? uword(2) : uword(1))) )  { out.ok = false; return; }
+      }
+    
+    p = skip_line(p) + 1;
+    
+    if( (L.is_mtx == false) && (val == eT(0)) )  { continue; }
+    
+    out.rows.push_back(row);
+    out.cols.push_back(col);
+    
+    if(with_values)  { out.vals.push_back(val); }
+    
+    if( (expand) && (row != col) )
+      {
+      out.rows.push_back(col);
+      out.cols.push_back(row);
+      
+      if(with_values)  { out.vals.push_back( mirror(val, L.symmetry) ); }
+      }
+    }
+  }
+
+
+
+//! reads a stream in large blocks of complete lines
+class line_reader
+  {
+  public:
+  
+  inline
+  line_reader(std::istream& in_f, const uword block_size = (uword(1) << 24))
+    : f(in_f)
+    , buf(block_size + 2)
+    , at_end(false)
+    {
+    }
+  
+  
+  //! [begin,end) holds complete lines, each terminated by a newline; the data is followed by a null character
+  inline
+  bool
+  next(const char*& begin, const char*& end)
+    {
+    uword n = uword(carry.size());
+    
+    if(n > 0)  { std::memcpy(&buf[0], carry.data(), n); carry.clear(); }
+    
+    while(true)
+      {
+      if(at_end == false)
+        {
+        const uword n_wanted = uword(buf.size()) - 2 - n;
+        
+        f.read(&buf[n], std::streamsize(n_wanted));
+        
+        const uword n_got = uword(f.gcount());
+        
+        n += n_got;
+        
+        if(n_got < n_wanted)  { at_end = true; }
+        }
+      
+      if(n == 0)  { return false; }
+      
+      if(at_end)
+        {
+        if(buf[n-1] != '\n')  { buf[n] = '\n'; ++n; }
+        
+        buf[n] = '\0';
+        
+        begin = &buf[0];
+        end   = &buf[n];
+        
+        // the next call returns false
+        carry.clear();
+        
+        return true;
+        }
+      
+      uword last = n;
+      
+      while( (last > 0) && (buf[last-1] != '\n') )  { --last; }
+      
+      if(last == 0)
+        {
+        // a line longer than the block
+        buf.resize(2 * buf.size());
+        continue;
+        }
+      
+      carry.assign(&buf[last], n - last);
+      
+      buf[last] = '\0';
+      
+      begin = &buf[0];
+      end   = &buf[last];
+      
+      return true;
+      }
+    }
+  
+  
+  private:
+  
+  std::istream&     f;
+  std::vector<char> buf;
+  std::string       carry;
+  bool              at_end;
+  };
+
+
+
+//! parse a block of complete lines, splitting it at line boundaries across the blocks (one per thread)
+template<typename eT>
+inline
+void
+parse_block(const char* begin, const char* end, const layout& L, const bool with_values, std::vector< coo_block<eT> >& blocks)
+  {
+  const uword n_blocks = uword(blocks.size());
+  
+  std::vector<const char*> bounds(n_blocks + 1);
+  
+  bounds[0]        = begin;
+  bounds[n_blocks] = end;
+  
+  const uword len = uword(end - begin);
+  
+  for(uword i=1; i < n_blocks; ++i)
+    {
+    const char* q = begin + (len / n_blocks) * i;
+    
+    if(q < bounds[i-1])  { q = bounds[i-1]; }
+    
+    while( (q < end) && (q > begin) && (q[-1] != '\n') )  { ++q; }
+    
+    bounds[i] = q;
+    }
+
+  #if defined(_OPENMP)
+    #pragma omp parallel for schedule(static) if(n_blocks > 1)
+  #endif
+  for(uword i=0; i < n_blocks; ++i)
+    {
+    blocks[i].reset();
+    
+    parse_lines(bounds[i], bounds[i+1], L, with_values, blocks[i]);
+    }
+  }
+
+
+
+//! read all entries from the current position of the stream; blocks of lines are parsed in parallel
+template<typename eT>
+inline
+bool
+read_entries(std::istream& f, const layout& L, coo_block<eT>& all)
+  {
+  std::vector< coo_block<eT> > blocks( get_n_threads() );
+  
+  line_reader reader(f);
+  
+  const char* begin = NULL;
+  const char* end   = NULL;
+  
+  while( (all.stop == false) && reader.next(begin, end) )
+    {
+    parse_block(begin, end, L, true, blocks);
+    
+    for(uword i=0; i < blocks.size(); ++i)
+      {
+      const coo_block<eT>& blk = blocks[i];
+      
+      if(blk.ok == false)  { all.ok = false; return false; }
+      
+      all.rows.insert( all.rows.end(), blk.rows.begin(), blk.rows.end() );
+      all.cols.insert( all.cols.end(), blk.cols.begin(), blk.cols.end() );
+      all.vals.insert( all.vals.end(), blk.vals.begin(), blk.vals.end() );
+      
+      if(blk.n_lines > 0)
+        {
+        if(all.max_row < blk.max_row)  { all.max_row = blk.max_row; }
+        if(all.max_col < blk.max_col)  { all.max_col = blk.max_col; }
+        
+        all.n_lines += blk.n_lines;
+        }
+      
+      if(blk.stop)  { all.stop = true; break; }
+      }
+    }
+  
+  return true;
+  }
+
+
+
+//! read the banner and the size line of a Matrix Market file
+inline
+bool
+read_header(std::istream& f, layout& L, uword& n_nz, std::string& err_msg)
+  {
+  std::string line;
+  
+  std::getline(f, line);
+  
+  std::istringstream ss(line);
+  
+  std::string banner, object, format, field, symmetry;
+  
+  ss >> banner >> object >> format >> field >> symmetry;
+  
+  std::transform(banner.begin(),   banner.end(),   banner.begin(),   ::tolower);
+  std::transform(object.begin(),   object.end(),   object.begin(),   ::tolower);
+  std::transform(format.begin(),   format.end(),   format.begin(),   ::tolower);
+  std::transform(field.begin(),    field.end(),    field.begin(),    ::tolower);
+  std::transform(symmetry.begin(), symmetry.end(), symmetry.begin(), ::tolower);
+  
+  if( (banner != "%%matrixmarket") || (object != "matrix") )
+    {
+    err_msg = "incorrect header in ";
+    return false;
+    }
+  
+  if(format != "coordinate")
+    {
+    err_msg = "unsupported Matrix Market format (only the coordinate format is handled) in ";
+    return false;
+    }
+    
+       if(field == "real"   )  { L.field = 'r'; }
+  else if(field == "double" )  { L.field = 'r'; }
+  else if(field == "integer")  { L.field = 'i'; }
+  else if(field == "complex")  { L.field = 'c'; }
+  else if(field == "pattern")  { L.field = 'p'; }
+  else                         { err_msg = "unsupported Matrix Market field in "; return false; }
+  
+       if(symmetry == "general"       )  { L.symmetry = 'g'; }
+  else if(symmetry == "symmetric"     )  { L.symmetry = 's'; }
+  else if(symmetry == "skew-symmetric")  { L.symmetry = 'k'; }
+  else if(symmetry == "hermitian"     )  { L.symmetry = 'h'; }
+  else                                   { err_msg = "unsupported Matrix Market symmetry in "; return false; }
+  
+  L.is_mtx = true;
+  
+  // comment lines and blank lines may precede the size line
+  while(f.good())
+    {
+    std::getline(f, line);
+    
+    const std::string::size_type pos = line.find_first_not_of(" \t\r");
+    
+    if( (pos == std::string::npos) || (line[pos] == '%') )  { continue; }
+    
+    break;
+    }
+  
+  std::istringstream size_ss(line);
+  
+  size_ss >> L.n_rows >> L.n_cols >> n_nz;
+  
+  if( (size_ss.fail() == true) || ((L.symmetry != 'g') && (L.n_rows != L.n_cols)) )
+    {
+    err_msg = "incorrect header in ";
+    return false;
+    }
+  
+  return true;
+  }
+
+
+
+template<typename eT>
+inline
+const char*
+field_name()
+  {
+  return (is_complex<eT>::value) ? "complex" : ( (is_real<eT>::value) ? "real" : "integer" );
+  }
+
+
+
+inline
+const char*
+symmetry_name(const char symmetry)
+  {
+  switch(symmetry)
+    {
+    case 's':  return "symmetric";
+    case 'k':  return "skew-symmetric";
+    case 'h':  return "hermitian";
+    default:   return "general";
+    }
+  }
+
+
+
+//! symmetry of a matrix, as used when writing it; only the lower triangle of a matrix with symmetry is written
+template<typename eT>
+inline
+char
+find_symmetry(const SpMat<eT>& x)
+  {
+  if( (x.n_rows != x.n_cols) || (x.n_nonzero == 0) )  { return 'g'; }
+  
+  // quick rejection: each row must have as many entries as the corresponding column
+  podarray<uword> row_counts(x.n_rows);
+  
+  row_counts.zeros();
+  
+  for(uword i=0; i < x.n_nonzero; ++i)  { ++row_counts[ x.row_indices[i] ]; }
+  
+  for(uword c=0; c < x.n_cols; ++c)
+    {
+    if(row_counts[c] != (x.col_ptrs[c+1] - x.col_ptrs[c]))  { return 'g'; }
+    }
+  
+  const SpMat<eT> xt = x.st();
+  
+  if( (xt.n_nonzero != x.n_nonzero) || (std::equal(x.col_ptrs, x.col_ptrs + x.n_cols + 1, xt.col_ptrs) == false) || (std::equal(x.row_indices, x.row_indices + x.n_nonzero, xt.row_indices) == false) )
+    {
+    return 'g';
+    }
+  
+  bool is_sym  = true;
+  bool is_skew = true;
+  bool is_herm = true;
+  
+  for(uword i=0; i < x.n_nonzero; ++i)
+    {
+    const eT a = x.values[i];
+    const eT b = xt.values[i];
+    
+    is_sym  = is_sym  && (a == b);
+    is_skew = is_skew && (a == mirror(b, 'k'));
+    is_herm = is_herm && (a == mirror(b, 'h'));
+    }
+  
+  return (is_sym) ? 's' : ( (is_herm) ? 'h' : ( (is_skew) ? 'k' : 'g' ) );
+  }
+
+
+
+template<typename eT>
+inline
+uword
+format_value(char* out, const eT& val)
+  {
+  return diskio::fast_txt_elem(out, val);
+  }
+
+
+
+template<typename T>
+inline
+uword
+format_value(char* out, const std::complex<T>& val)
+  {
+  uword len = diskio::fast_txt_real(out, val.real());
+  
+  out[len] = ' ';  ++len;
+  
+  len += diskio::fast_txt_real(&out[len], val.imag());
+  
+  return len;
+  }
+
+
+
+//! true if the entry is written for the given symmetry
+inline
+bool
+is_written(const uword row, const uword col, const char symmetry)
+  {
+  return (symmetry == 'g') || (row > col) || ( (row == col) && (symmetry != 'k') );
+  }
+
+
+
+//! format the stored entries [k_start,k_end) as lines of co-ordinate data, with indices starting at base;
+//! returns the number of characters written; out must have room for 128 characters per entry
+template<typename eT>
+inline
+uword
+format_entries(char* out, const SpMat<eT>& x, const uword k_start, const uword k_end, const uword base, const char symmetry)
+  {
+  uword col = uword( std::upper_bound(x.col_ptrs, x.col_ptrs + x.n_cols + 1, k_start) - x.col_ptrs ) - 1;
+  
+  uword len = 0;
+  
+  for(uword k = k_start; k < k_end; ++k)
+    {
+    while(x.col_ptrs[col + 1] <= k)  { ++col; }
+    
+    const uword row = x.row_indices[k];
+    
+    if(is_written(row, col, symmetry) == false)  { continue; }
+    
+    len += diskio::fast_txt_int(&out[len], row + base);  out[len] = ' ';  ++len;
+    len += diskio::fast_txt_int(&out[len], col + base);  out[len] = ' ';  ++len;
+    
+    len += format_value(&out[len], x.values[k]);
+    
+    out[len] = '\n';  ++len;
+    }
+  
+  return len;
+  }
+
+
+
+//! write the stored entries which are needed for the given symmetry; blocks of entries are formatted in parallel
+template<typename eT>
+inline
+bool
+write_entries(std::ostream& f, const SpMat<eT>& x, const uword base, const char symmetry)
+  {
+  const uword N = x.n_nonzero;
+  
+  if(N == 0)  { return f.good(); }
+  
+  const uword entries_per_block = 16384;
+  const uword n_blocks          = (N + entries_per_block - 1) / entries_per_block;
+  const uword block_size        = entries_per_block * 128;
+
+  #if defined(_OPENMP)
+    {
+    const uword n_threads = (std::min)( n_blocks, uword( (std::max)(int(1), int(omp_get_max_threads())) ) );
+    
+    if(n_threads > 1)
+      {
+      podarray<char>  buffer(n_threads * block_size);
+      podarray<uword> lengths(n_threads);
+      
+      char* buffer_mem = buffer.memptr();
+      
+      for(uword block_start = 0; block_start < n_blocks; block_start += n_threads)
+        {
+        const uword block_end = (std::min)(block_start + n_threads, n_blocks);
+
+        #pragma omp parallel for schedule(static)
+        for(uword block = block_start; block < block_end; ++block)
+          {
+          const uword t       = block - block_start;
+          const uword k_start = block * entries_per_block;
+          const uword k_end   = (std::min)(k_start + entries_per_block, N);
+          
+          lengths[t] = format_entries(&buffer_mem[t*block_size], x, k_start, k_end, base, symmetry);
+          }
+        
+        for(uword t=0; t < (block_end - block_start); ++t)
+          {
+          f.write(&buffer_mem[t*block_size], std::streamsize(lengths[t]));
+          }
+        }
+      
+      return f.good();
+      }
+    }
+  #endif
+  
+  podarray<char> buffer(block_size);
+  
+  for(uword block=0; block < n_blocks; ++block)
+    {
+    const uword k_start = block * entries_per_block;
+    const uword k_end   = (std::min)(k_start + entries_per_block, N);
+    
+    const uword len = format_entries(buffer.memptr(), x, k_start, k_end, base, symmetry);
+    
+    f.write(buffer.memptr(), std::streamsize(len));
+    }
+  
+  return f.good();
+  }
+
+
+
+}  // namespace mtx_misc
+
+
+//! @}
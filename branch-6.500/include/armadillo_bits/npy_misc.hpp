@@ -0,0 +1,1163 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup npy_misc
+//! @{
+
+
+//! helpers for reading and writing NumPy .npy files and .npz archives
+namespace npy_misc
+{
+
+
+//! element type of a NumPy array, as given by the 'descr' entry of the header
+struct dtype_info
+  {
+  char  kind;  //!< 'f' (floating point), 'c' (complex), 'i' (signed int), 'u' (unsigned int), 'b' (bool), 'S' or 'U' (string)
+  uword size;  //!< number of bytes per element
+  bool  swap;  //!< true if the byte order differs from the byte order of this machine
+  };
+
+
+
+//! entry of a zip archive
+struct zip_entry
+  {
+  std::string    name;
+  uword          method;       //!< 0 = stored, 8 = deflated
+  std::streamoff data_offset;  //!< position of the data within the stream
+  std::streamoff data_size;
+  };
+
+
+
+inline
+bool
+is_little_endian()
+  {
+  const u32 val = 1;
+  
+  unsigned char byte;
+  
+  std::memcpy(&byte, &val, 1);
+  
+  return (byte == 1);
+  }
+
+
+
+template<typename eT>
+inline
+char
+kind_of()
+  {
+  return (is_complex<eT>::value) ? 'c' : ( (is_real<eT>::value) ? 'f' : ( (is_signed<eT>::value) ? 'i' : 'u' ) );
+  }
+
+
+
+//! 'descr' string for an element of the given kind and size, in the byte order of this machine
+inline
+std::string
+gen_descr(const char kind, const uword size)
+  {
+  std::ostringstream ss;
+  
+  ss << ( (size == 1) ? '|' : ( is_little_endian() ? '<' : '>' ) ) << kind << size;
+  
+  return ss.str();
+  }
+
+
+
+template<typename eT>
+inline
+std::string
+gen_descr()
+  {
+  return gen_descr(kind_of<eT>(), uword(sizeof(eT)));
+  }
+
+
+
+//! true if the elements can be copied directly into memory of type eT
+template<typename eT>
+inline
+bool
+is_native(const dtype_info& dt)
+  {
+  return ( (dt.swap == false) && (dt.kind == kind_of<eT>()) && (dt.size == uword(sizeof(eT))) );
+  }
+
+
+
+inline
+std::string
+gen_shape(const uword* dims, const uword n_dims)
+  {
+  std::ostringstream ss;
+  
+  ss << '(';
+  
+  for(uword i=0; i < n_dims; ++i)
+    {
+    if(i > 0)  { ss << ", "; }
+    
+    ss << dims[i];
+    }
+  
+  if(n_dims == 1)  { ss << ','; }
+  
+  ss << ')';
+  
+  return ss.str();
+  }
+
+
+
+inline
+void
+put_le(std::string& out, const std::streamoff val, const uword n_bytes)
+  {
+  for(uword i=0; i < n_bytes; ++i)
+    {
+    out.push_back( char( (val >> (8*i)) & 0xFF ) );
+    }
+  }
+
+
+
+inline
+std::streamoff
+get_le(const unsigned char* in, const uword n_bytes)
+  {
+  std::streamoff val = 0;
+  
+  for(uword i=n_bytes; i > 0; --i)
+    {
+    val = (val << 8) | std::streamoff(in[i-1]);
+    }
+  
+  return val;
+  }
+
+
+
+//! write a version 1.0 header (version 2.0 if the header is too long),
+//! padded so that the data starts at a multiple of 64 bytes
+inline
+void
+write_header(std::ostream& f, const std::string& descr, const uword* dims, const uword n_dims)
+  {
+  std::string dict = "{'descr': '" + descr + "', 'fortran_order': True, 'shape': " + gen_shape(dims, n_dims) + ", }";
+  
+  const uword dict_len  = uword(dict.length()) + 1;  // including the terminating newline
+  const bool  version_2 = (dict_len + 10 + 63) > 65535;
+  const uword prefix    = (version_2) ? 12 : 10;
+  const uword padding   = (64 - ((prefix + dict_len) % 64)) % 64;
+  
+  dict.append(padding, ' ');
+  dict.push_back('\n');
+  
+  std::string header("\x93NUMPY", 6);
+  
+  header.push_back( char( (version_2) ? 2 : 1 ) );
+  header.push_back( char(0) );
+  
+  put_le(header, std::streamoff(dict.length()), prefix - 8);
+  
+  f.write(header.data(), std::streamsize(header.length()));
+  f.write(dict.data(),   std::streamsize(dict.length())  );
+  }
+
+
+
+//! parse a 'descr' entry such as '<f8'
+inline
+bool
+parse_descr(const std::string& descr, dtype_info& dt)
+  {
+  if(descr.length() < 3)  { return false; }
+  
+  const char order = descr[0];
+  const char kind  = descr[1];
+  
+  if( (order != '<') && (order != '>') && (order != '|') && (order != '=') )  { return false; }
+  
+  uword size = 0;
+  
+  for(uword i=2; i < descr.length(); ++i)
+    {
+    const char c = descr[i];
+    
+    if( (c < '0') || (c > '9') )  { return false; }
+    
+    size = size*10 + uword(c - '0');
+    }
+  
+  bool valid = false;
+  
+  switch(kind)
+    {
+    case 'f':  valid = (size == 4) || (size == 8);                              break;
+    case 'c':  valid = (size == 8) || (size == 16);                             break;
+    case 'b':  valid = (size == 1);                                             break;
+    case 'S':  valid = (size >= 1);                                             break;
+    case 'U':  valid = (size >= 1);                                             break;
+    
+    case 'i':
+    case 'u':  valid = (size == 1) || (size == 2) || (size == 4) || (size == 8); break;
+    
+    default:   valid = false;
+    }
+  
+  if(valid == false)  { return false; }
+  
+  dt.kind = kind;
+  dt.size = (kind == 'U') ? 4*size : size;  // 'U' strings use 4 bytes per character
+  dt.swap = ( (order == '<') && (is_little_endian() == false) ) || ( (order == '>') && (is_little_endian() == true) );
+  
+  return true;
+  }
+
+
+
+//! find the value of the given key in the header dictionary
+inline
+bool
+find_value(const std::string& dict, const std::string& key, std::string::size_type& pos)
+  {
+  std::string::size_type key_pos = dict.find("'" + key + "'");
+  
+  if(key_pos == std::string::npos)  { key_pos = dict.find("\"" + key + "\""); }
+  
+  if(key_pos == std::string::npos)  { return false; }
+  
+  pos = dict.find(':', key_pos + key.length() + 2);
+  
+  if(pos == std::string::npos)  { return false; }
+  
+  pos = dict.find_first_not_of(" \t", pos + 1);
+  
+  return (pos != std::string::npos);
+  }
+
+
+
+//! read the header of a .npy file; the dimensions are returned in dims, with n_dims <= 3
+inline
+bool
+read_header(std::istream& f, dtype_info& dt, bool& fortran_order, uword* dims, uword& n_dims, std::string& err_msg)
+  {
+  unsigned char magic[12];
+  
+  f.read(reinterpret_cast<char*>(magic), 8);
+  
+  if( (f.gcount() != 8) || (std::memcmp(magic, "\x93NUMPY", 6) != 0) )
+    {
+    err_msg = "unsupported header in ";
+    return false;
+    }
+  
+  const uword major = uword(magic[6]);
+  
+  if( (major < 1) || (major > 3) )
+    {
+    err_msg = "unsupported NumPy format version in ";
+    return false;
+    }
+  
+  const uword n_len = (major == 1) ? 2 : 4;
+  
+  f.read(reinterpret_cast<char*>(&magic[8]), std::streamsize(n_len));
+  
+  const uword dict_len = uword( get_le(&magic[8], n_len) );
+  
+  podarray<char> raw(dict_len + 1);
+  
+  f.read(raw.memptr(), std::streamsize(dict_len));
+  
+  raw[dict_len] = '\0';
+  
+  if(f.good() == false)
+    {
+    err_msg = "incorrect header in ";
+    return false;
+    }
+  
+  const std::string dict(raw.memptr(), dict_len);
+  
+  std::string::size_type pos = 0;
+  
+  // descr
+  
+  if(find_value(dict, "descr", pos) == false)  { err_msg = "incorrect header in "; return false; }
+  
+  const char quote = dict[pos];
+  
+  const std::string::size_type end = dict.find(quote, pos + 1);
+  
+  if( ((quote != '\'') && (quote != '"')) || (end == std::string::npos) || (parse_descr(dict.substr(pos + 1, end - pos - 1), dt) == false) )
+    {
+    err_msg = "unsupported element type in ";
+    return false;
+    }
+  
+  // fortran_order
+  
+  if(find_value(dict, "fortran_order", pos) == false)  { err_msg = "incorrect header in "; return false; }
+  
+  fortran_order = (dict.compare(pos, 4, "True") == 0);
+  
+  // shape
+  
+  if( (find_value(dict, "shape", pos) == false) || (dict[pos] != '(') )  { err_msg = "incorrect header in "; return false; }
+  
+  n_dims = 0;
+  
+  dims[0] = 1;
+  dims[1] = 1;
+  dims[2] = 1;
+  
+  ++pos;
+  
+  while(pos < dict.length())
+    {
+    while( (pos < dict.length()) && ((dict[pos] == ' ') || (dict[pos] == ',')) )  { ++pos; }
+    
+    if( (pos >= dict.length()) || (dict[pos] == ')') )  { break; }
+    
+    if( (dict[pos] < '0') || (dict[pos] > '9') )  { err_msg = "incorrect header in "; return false; }
+    
+    uword val = 0;
+    
+    while( (pos < dict.length()) && (dict[pos] >= '0') && (dict[pos] <= '9') )  { val = val*10 + uword(dict[pos] - '0'); ++pos; }
+    
+    if(n_dims >= 3)  { err_msg = "unsupported number of dimensions in "; return false; }
+    
+    dims[n_dims] = val;
+    
+    ++n_dims;
+    }
+  
+  return true;
+  }
+
+
+
+//! copy the element bytes, reversing their order if required
+template<typename T>
+inline
+T
+get_elem(const char* src, const bool swap)
+  {
+  T val;
+  
+  if(swap == false)
+    {
+    std::memcpy(&val, src, sizeof(T));
+    }
+  else
+    {
+    char tmp[sizeof(T)];
+    
+    for(uword i=0; i < sizeof(T); ++i)  { tmp[i] = src[sizeof(T) - 1 - i]; }
+    
+    std::memcpy(&val, tmp, sizeof(T));
+    }
+  
+  return val;
+  }
+
+
+
+template<typename eT, typename T>
+inline
+void
+set_cx(eT& out, const T re, const T)
+  {
+  out = eT(re);
+  }
+
+
+
+template<typename T1, typename T>
+inline
+void
+set_cx(std::complex<T1>& out, const T re, const T im)
+  {
+  out = std::complex<T1>( T1(re), T1(im) );
+  }
+
+
+
+template<typename eT, typename T>
+inline
+void
+convert_real(eT* out, const char* src, const uword N, const bool swap)
+  {
+  for(uword i=0; i < N; ++i)
+    {
+    out[i] = eT( get_elem<T>(src + i*sizeof(T), swap) );
+    }
+  }
+
+
+
+template<typename eT, typename T>
+inline
+void
+convert_cx(eT* out, const char* src, const uword N, const bool swap)
+  {
+  for(uword i=0; i < N; ++i)
+    {
+    const T re = get_elem<T>(src + (2*i    )*sizeof(T), swap);
+    const T im = get_elem<T>(src + (2*i + 1)*sizeof(T), swap);
+    
+    set_cx(out[i], re, im);
+    }
+  }
+
+
+
+//! 64 bit integers without native 64 bit integer support: the value is exact up to 2^53
+template<typename eT>
+inline
+void
+convert_int64(eT* out, const char* src, const uword N, const bool swap, const bool is_signed_src)
+  {
+  const uword lo_index = (is_little_endian() != swap) ? 0 : 1;
+  
+  for(uword i=0; i < N; ++i)
+    {
+    const char* elem = src + 8*i;
+    
+    const u32 lo = get_elem<u32>(elem + 4*lo_index,     swap);
+    const u32 hi = get_elem<u32>(elem + 4*(1-lo_index), swap);
+    
+    const double hi_val = (is_signed_src) ? double(s32(hi)) : double(hi);
+    
+    out[i] = eT( hi_val * 4294967296.0 + double(lo) );
+    }
+  }
+
+
+
+template<typename eT>
+inline
+void
+convert(eT* out, const char* src, const uword N, const dtype_info& dt)
+  {
+  const bool swap = dt.swap;
+  
+  switch(dt.kind)
+    {
+    case 'f':
+      if(dt.size == 4)  { convert_real<eT, float >(out, src, N, swap); }
+      else              { convert_real<eT, double>(out, src, N, swap); }
+      break;
+    
+    case 'c':
+      if(dt.size == 8)  { convert_cx<eT, float >(out, src, N, swap); }
+      else              { convert_cx<eT, double>(out, src, N, swap); }
+      break;
+    
+    case 'b':
+      convert_real<eT, unsigned char>(out, src, N, false);
+      break;
+    
+    case 'i':
+      switch(dt.size)
+        {
+        case 1:  convert_real<eT, signed char>(out, src, N, false); break;
+        case 2:  convert_real<eT, s16        >(out, src, N, swap ); break;
+        case 4:  convert_real<eT, s32        >(out, src, N, swap ); break;
+        #if defined(ARMA_USE_U64S64)
+        case 8:  convert_real<eT, s64        >(out, src, N, swap ); break;
+        #else
+        case 8:  convert_int64(out, src, N, swap, true);            break;
+        #endif
+        default: ;
+        }
+      break;
+    
+    case 'u':
+      switch(dt.size)
+        {
+        case 1:  convert_real<eT, u8 >(out, src, N, false); break;
+        case 2:  convert_real<eT, u16>(out, src, N, swap ); break;
+        case 4:  convert_real<eT, u32>(out, src, N, swap ); break;
+        #if defined(ARMA_USE_U64S64)
+        case 8:  convert_real<eT, u64>(out, src, N, swap ); break;
+        #else
+        case 8:  convert_int64(out, src, N, swap, false);   break;
+        #endif
+        default: ;
+        }
+      break;
+    
+    default: ;
+    }
+  }
+
+
+
+//! read the data of an array with dimensions dims[0] x dims[1] x dims[2] into column-major memory;
+//! data in the native type and in Fortran order is read directly into the destination,
+//! otherwise the element type and the order are converted in a single pass over the data
+template<typename eT>
+inline
+bool
+read_data(std::istream& f, const dtype_info& dt, const bool fortran_order, const uword* dims, eT* out, std::string& err_msg)
+  {
+  if( (dt.kind == 'S') || (dt.kind == 'U') || ( (dt.kind == 'c') && (is_complex<eT>::value == false) ) )
+    {
+    err_msg = "incompatible element type in ";
+    return false;
+    }
+  
+  const uword N = dims[0] * dims[1] * dims[2];
+  
+  if(N == 0)  { return true; }
+  
+  const uword n_non_unit = uword(dims[0] > 1) + uword(dims[1] > 1) + uword(dims[2] > 1);
+  
+  const bool same_order = fortran_order || (n_non_unit <= 1);
+  
+  if( same_order && is_native<eT>(dt) )
+    {
+    f.read( reinterpret_cast<char*>(out), std::streamsize(N*sizeof(eT)) );
+    
+    return f.good();
+    }
+  
+  const uword chunk_size = (std::max)( uword(1), uword(65536 / dt.size) );
+  
+  podarray<char> raw( chunk_size * dt.size );
+  podarray<eT>   tmp( (same_order) ? uword(0) : chunk_size );
+  
+  // position of the next element in C order: the last index varies fastest
+  uword i0 = 0;
+  uword i1 = 0;
+  uword i2 = 0;
+  
+  const uword d0 = dims[0];
+  const uword d1 = dims[1];
+  const uword d2 = dims[2];
+  
+  for(uword start=0; start < N; start += chunk_size)
+    {
+    const uword count = (std::min)(chunk_size, N - start);
+    
+    f.read( raw.memptr(), std::streamsize(count * dt.size) );
+    
+    if(f.good() == false)  { return false; }
+    
+    if(same_order)
+      {
+      convert(&out[start], raw.memptr(), count, dt);
+      }
+    else
+      {
+      eT* tmp_mem = tmp.memptr();
+      
+      convert(tmp_mem, raw.memptr(), count, dt);
+      
+      for(uword k=0; k < count; ++k)
+        {
+        out[i0 + i1*d0 + i2*(d0*d1)] = tmp_mem[k];
+        
+        ++i2;
+        
+        if(i2 == d2)
+          {
+          i2 = 0;
+          ++i1;
+          
+          if(i1 == d1)  { i1 = 0; ++i0; }
+          }
+        }
+      }
+    }
+  
+  return true;
+  }
+
+
+
+//! read a string array with one element, such as the 'format' entry of a SciPy sparse matrix archive
+inline
+bool
+read_string(std::istream& f, std::string& out, std::string& err_msg)
+  {
+  dtype_info dt;
+  
+  bool  fortran_order = false;
+  uword dims[3];
+  uword n_dims = 0;
+  
+  if(read_header(f, dt, fortran_order, dims, n_dims, err_msg) == false)  { return false; }
+  
+  if( ((dt.kind != 'S') && (dt.kind != 'U')) || ((dims[0] * dims[1] * dims[2]) != 1) )
+    {
+    err_msg = "incorrect sparse matrix format in ";
+    return false;
+    }
+  
+  podarray<char> raw(dt.size);
+  
+  f.read(raw.memptr(), std::streamsize(dt.size));
+  
+  if(f.good() == false)  { return false; }
+  
+  out.clear();
+  
+  const uword step = (dt.kind == 'U') ? 4 : 1;
+  
+  for(uword i=0; i < dt.size; i += step)
+    {
+    const char c = (dt.kind == 'U' && dt.swap == is_little_endian()) ? raw[i + 3] : raw[i];
+    
+    if(c == '\0')  { break; }
+    
+    out.push_back(c);
+    }
+  
+  return true;
+  }
+
+
+
+inline
+void
+gen_crc32_table(u32* table)
+  {
+  for(u32 n=0; n < 256; ++n)
+    {
+    u32 c = n;
+    
+    for(uword k=0; k < 8; ++k)  { c = (c & 1) ? (u32(0xEDB88320) ^ (c >> 1)) : (c >> 1); }
+    
+    table[n] = c;
+    }
+  }
+
+
+
+//! update the running CRC-32 value, where crc starts at 0xFFFFFFFF and is inverted at the end
+inline
+u32
+update_crc32(const u32* table, u32 crc, const char* data, const uword N)
+  {
+  for(uword i=0; i < N; ++i)
+    {
+    crc = table[ (crc ^ u32(static_cast<unsigned char>(data[i]))) & 0xFF ] ^ (crc >> 8);
+    }
+  
+  return crc;
+  }
+
+
+
+inline
+u32
+crc32(const char* data, const uword N)
+  {
+  u32 table[256];
+  
+  gen_crc32_table(table);
+  
+  return update_crc32(table, u32(0xFFFFFFFF), data, N) ^ u32(0xFFFFFFFF);
+  }
+
+
+
+//! writes an uncompressed zip archive, as produced by numpy.savez(), directly to the output stream;
+//! the data of each entry is written through this object (used as the buffer of an std::ostream),
+//! which finds the CRC and size of the entry on the way; these are then patched into the local header,
+//! so the output stream must be seekable;
+//! zip64 fields are used for entries which may reach 4 GB, and for archives which exceed the limits of the plain format
+class zip_writer : public std::streambuf
+  {
+  public:
+  
+  inline zip_writer(std::ostream& in_f, const bool in_force_zip64 = false);
+  
+  inline bool begin_entry(const std::string& name, const std::streamoff data_size);
+  inline bool end_entry();
+  inline bool finish();
+  
+  
+  protected:
+  
+  inline std::streamsize xsputn(const char* s, std::streamsize n);
+  inline int_type        overflow(int_type c);
+  
+  
+  private:
+  
+  std::ostream&  f;
+  std::streampos base;
+  bool           force_zip64;
+  bool           good;
+  u32            table[256];
+  
+  std::string    central;    //!< central directory entries of the finished entries
+  std::streamoff n_entries;
+  
+  bool           in_entry;
+  std::string    entry_name;
+  std::streamoff entry_offset;
+  std::streamoff entry_size;
+  u32            entry_crc;
+  bool           entry_zip64;
+  };
+
+
+
+inline
+zip_writer::zip_writer(std::ostream& in_f, const bool in_force_zip64)
+  : f           (in_f          )
+  , base        (in_f.tellp()  )
+  , force_zip64 (in_force_zip64)
+  , good        (base != std::streampos(-1))
+  , n_entries   (0             )
+  , in_entry    (false         )
+  , entry_offset(0             )
+  , entry_size  (0             )
+  , entry_crc   (0             )
+  , entry_zip64 (false         )
+  {
+  gen_crc32_table(table);
+  }
+
+
+
+//! write the local header of a new entry, with placeholders for the CRC and sizes
+inline
+bool
+zip_writer::begin_entry(const std::string& name, const std::streamoff data_size)
+  {
+  if( (good == false) || (in_entry == true) )  { return false; }
+  
+  const std::streamoff limit = std::streamoff(0xFFFFFFFF);
+  
+  // data_size is the number of bytes in the array, to which the .npy header adds less than 64 kB
+  const std::streamoff header_margin = std::streamoff(65536 + 12);
+  
+  entry_name   = name;
+  entry_offset = std::streamoff(f.tellp() - base);
+  entry_size   = 0;
+  entry_crc    = u32(0xFFFFFFFF);
+  entry_zip64  = force_zip64 || ( (data_size + header_margin) >= limit );
+  
+  // for zip64 entries the sizes are patched into the extra field instead
+  
+  std::string local;
+  
+  put_le(local, 0x04034b50, 4);
+  put_le(local, (entry_zip64) ? 45 : 20, 2);  // version needed
+  put_le(local, 0,    2);  // flags
+  put_le(local, 0,    2);  // method
+  put_le(local, 0,    2);  // time
+  put_le(local, 0x21, 2);  // 1980-01-01
+  put_le(local, 0,    4);  // crc
+  put_le(local, (entry_zip64) ? limit : 0, 4);
+  put_le(local, (entry_zip64) ? limit : 0, 4);
+  put_le(local, std::streamoff(name.length()), 2);
+  put_le(local, (entry_zip64) ? 20 : 0, 2);
+  
+  local += name;
+  
+  if(entry_zip64)
+    {
+    put_le(local, 0x0001, 2);
+    put_le(local, 16,     2);
+    put_le(local, 0,      8);
+    put_le(local, 0,      8);
+    }
+  
+  f.write(local.data(), std::streamsize(local.length()));
+  
+  good     = f.good();
+  in_entry = good;
+  
+  return good;
+  }
+
+
+
+//! patch the CRC and sizes into the local header of the current entry, and add its central directory entry
+inline
+bool
+zip_writer::end_entry()
+  {
+  if( (good == false) || (in_entry == false) )  { return false; }
+  
+  in_entry = false;
+  
+  const std::streamoff limit = std::streamoff(0xFFFFFFFF);
+  
+  if( (entry_zip64 == false) && (entry_size >= limit) )  { good = false; return false; }
+  
+  const u32 crc = entry_crc ^ u32(0xFFFFFFFF);
+  
+  const std::streampos end_pos = f.tellp();
+  
+  std::string patch;
+  
+  put_le(patch, crc, 4);
+  
+  if(entry_zip64 == false)
+    {
+    put_le(patch, entry_size, 4);
+    put_le(patch, entry_size, 4);
+    }
+  
+  f.seekp(base + std::streamoff(entry_offset + 14));
+  f.write(patch.data(), std::streamsize(patch.length()));
+  
+  if(entry_zip64)
+    {
+    std::string patch64;
+    
+    put_le(patch64, entry_size, 8);
+    put_le(patch64, entry_size, 8);
+    
+    f.seekp(base + std::streamoff(entry_offset + 30 + std::streamoff(entry_name.length()) + 4));
+    f.write(patch64.data(), std::streamsize(patch64.length()));
+    }
+  
+  f.seekp(end_pos);
+  
+  good = f.good();
+  
+  if(good == false)  { return false; }
+  
+  // zip64 extra field with the values which don't fit in the directory entry, in the order given by the zip specification
+  
+  const bool sizes_64  = force_zip64 || (entry_size   >= limit);
+  const bool offset_64 = force_zip64 || (entry_offset >= limit);
+  
+  std::string extra;
+  
+  if(sizes_64 || offset_64)
+    {
+    put_le(extra, 0x0001, 2);
+    put_le(extra, (sizes_64 ? 16 : 0) + (offset_64 ? 8 : 0), 2);
+    
+    if(sizes_64)   { put_le(extra, entry_size,   8); put_le(extra, entry_size, 8); }
+    if(offset_64)  { put_le(extra, entry_offset, 8); }
+    }
+  
+  const uword version = (extra.empty()) ? 20 : 45;
+  
+  put_le(central, 0x02014b50, 4);
+  put_le(central, version,    2);  // version made by
+  put_le(central, version,    2);  // version needed
+  put_le(central, 0,          2);  // flags
+  put_le(central, 0,          2);  // method
+  put_le(central, 0,          2);  // time
+  put_le(central, 0x21,       2);  // 1980-01-01
+  put_le(central, crc,        4);
+  put_le(central, (sizes_64) ? limit : entry_size, 4);
+  put_le(central, (sizes_64) ? limit : entry_size, 4);
+  put_le(central, std::streamoff(entry_name.length()), 2);
+  put_le(central, std::streamoff(extra.length()),      2);
+  put_le(central, 0,          2);  // comment length
+  put_le(central, 0,          2);  // disk number
+  put_le(central, 0,          2);  // internal attributes
+  put_le(central, 0,          4);  // external attributes
+  put_le(central, (offset_64) ? limit : entry_offset, 4);
+  
+  central += entry_name;
+  central += extra;
+  
+  ++n_entries;
+  
+  return true;
+  }
+
+
+
+//! write the central directory and the end records
+inline
+bool
+zip_writer::finish()
+  {
+  if( (good == false) || (in_entry == true) )  { return false; }
+  
+  const std::streamoff limit = std::streamoff(0xFFFFFFFF);
+  
+  const std::streamoff central_offset = std::streamoff(f.tellp() - base);
+  const std::streamoff central_size   = std::streamoff(central.length());
+  
+  f.write(central.data(), std::streamsize(central.length()));
+  
+  const bool zip64 = force_zip64 || (n_entries >= 0xFFFF) || (central_size >= limit) || (central_offset >= limit);
+  
+  std::string end;
+  
+  if(zip64)
+    {
+    const std::streamoff eocd64_offset = central_offset + central_size;
+    
+    put_le(end, 0x06064b50,     4);
+    put_le(end, 44,             8);  // size of the remaining record
+    put_le(end, 45,             2);  // version made by
+    put_le(end, 45,             2);  // version needed
+    put_le(end, 0,              4);  // disk number
+    put_le(end, 0,              4);  // disk with the central directory
+    put_le(end, n_entries,      8);
+    put_le(end, n_entries,      8);
+    put_le(end, central_size,   8);
+    put_le(end, central_offset, 8);
+    
+    put_le(end, 0x07064b50,     4);
+    put_le(end, 0,              4);  // disk with the zip64 end record
+    put_le(end, eocd64_offset,  8);
+    put_le(end, 1,              4);  // number of disks
+    }
+  
+  put_le(end, 0x06054b50, 4);
+  put_le(end, 0, 2);
+  put_le(end, 0, 2);
+  put_le(end, (zip64) ? std::streamoff(0xFFFF) : n_entries,      2);
+  put_le(end, (zip64) ? std::streamoff(0xFFFF) : n_entries,      2);
+  put_le(end, (zip64) ? limit                  : central_size,   4);
+  put_le(end, (zip64) ? limit                  : central_offset, 4);
+  put_le(end, 0, 2);
+  
+  f.write(end.data(), std::streamsize(end.length()));
+  
+  good = f.good();
+  
+  return good;
+  }
+
+
+
+inline
+std::streamsize
+zip_writer::xsputn(const char* s, std::streamsize n)
+  {
+  if( (good == false) || (in_entry == false) )  { return 0; }
+  
+  f.write(s, n);
+  
+  if(f.good() == false)  { good = false; return 0; }
+  
+  entry_crc   = update_crc32(table, entry_crc, s, uword(n));
+  entry_size += std::streamoff(n);
+  
+  return n;
+  }
+
+
+
+inline
+zip_writer::int_type
+zip_writer::overflow(int_type c)
+  {
+  if(traits_type::eq_int_type(c, traits_type::eof()))  { return traits_type::not_eof(c); }
+  
+  const char ch = traits_type::to_char_type(c);
+  
+  return (xsputn(&ch, 1) == 1) ? c : traits_type::eof();
+  }
+
+
+
+//! read the central directory of a zip archive starting at the current position of the stream;
+//! zip64 archives (as written by numpy.savez) are supported
+inline
+bool
+read_zip_directory(std::istream& f, std::vector<zip_entry>& entries, std::string& err_msg)
+  {
+  entries.clear();
+  
+  err_msg = "incorrect zip archive in ";
+  
+  f.clear();
+  
+  const std::streampos base_pos = f.tellg();
+  
+  f.seekg(0, std::ios::end);
+  
+  const std::streampos end_pos = f.tellg();
+  
+  if( (base_pos == std::streampos(-1)) || (end_pos == std::streampos(-1)) )  { return false; }
+  
+  const std::streamoff base   = std::streamoff(base_pos);
+  const std::streamoff length = std::streamoff(end_pos - base_pos);
+  
+  // the end of central directory record is at the end of the archive, followed by an optional comment
+  
+  const std::streamoff tail_length = (std::min)( length, std::streamoff(65535 + 22) );
+  
+  const uword n_tail = uword(tail_length);
+  
+  podarray<unsigned char> tail(n_tail);
+  
+  f.seekg(base + length - tail_length, std::ios::beg);
+  f.read( reinterpret_cast<char*>(tail.memptr()), std::streamsize(tail_length) );
+  
+  if(f.good() == false)  { return false; }
+  
+  std::streamoff eocd = -1;
+  
+  for(std::streamoff i = tail_length - 22; i >= 0; --i)
+    {
+    if(get_le(&tail[uword(i)], 4) == 0x06054b50)  { eocd = i; break; }
+    }
+  
+  if(eocd < 0)  { return false; }
+  
+  std::streamoff n_entries      = get_le(&tail[uword(eocd + 10)], 2);
+  std::streamoff central_size   = get_le(&tail[uword(eocd + 12)], 4);
+  std::streamoff central_offset = get_le(&tail[uword(eocd + 16)], 4);
+  
+  if( (n_entries == 0xFFFF) || (central_size == 0xFFFFFFFF) || (central_offset == 0xFFFFFFFF) )
+    {
+    // zip64 end of central directory locator, followed by the zip64 end of central directory record
+    
+    if( (eocd < 20) || (get_le(&tail[uword(eocd - 20)], 4) != 0x07064b50) )  { return false; }
+    
+    const std::streamoff eocd64_offset = get_le(&tail[uword(eocd - 20 + 8)], 8);
+    
+    unsigned char eocd64[56];
+    
+    f.seekg(base + eocd64_offset, std::ios::beg);
+    f.read( reinterpret_cast<char*>(eocd64), 56 );
+    
+    if( (f.good() == false) || (get_le(eocd64, 4) != 0x06064b50) )  { return false; }
+    
+    n_entries      = get_le(&eocd64[32], 8);
+    central_size   = get_le(&eocd64[40], 8);
+    central_offset = get_le(&eocd64[48], 8);
+    }
+  
+  if( (central_offset + central_size) > length )  { return false; }
+  
+  const uword n_central = uword(central_size);
+  
+  podarray<unsigned char> central(n_central);
+  
+  f.seekg(base + central_offset, std::ios::beg);
+  f.read( reinterpret_cast<char*>(central.memptr()), std::streamsize(central_size) );
+  
+  if(f.good() == false)  { return false; }
+  
+  uword pos = 0;
+  
+  for(std::streamoff count=0; count < n_entries; ++count)
+    {
+    if( (std::streamoff(pos) + 46 > central_size) || (get_le(&central[pos], 4) != 0x02014b50) )  { return false; }
+    
+    zip_entry entry;
+    
+    entry.method = uword( get_le(&central[pos + 10], 2) );
+    
+    std::streamoff comp_size    = get_le(&central[pos + 20], 4);
+    std::streamoff uncomp_size  = get_le(&central[pos + 24], 4);
+    std::streamoff local_offset = get_le(&central[pos + 42], 4);
+    
+    const uword name_len    = uword( get_le(&central[pos + 28], 2) );
+    const uword extra_len   = uword( get_le(&central[pos + 30], 2) );
+    const uword comment_len = uword( get_le(&central[pos + 32], 2) );
+    
+    if( std::streamoff(pos + 46 + name_len + extra_len + comment_len) > central_size )  { return false; }
+    
+    entry.name.assign( reinterpret_cast<const char*>(&central[pos + 46]), name_len );
+    
+    // zip64 extended information: only the fields which don't fit in the directory entry are present
+    
+    uword extra_pos = pos + 46 + name_len;
+    
+    const uword extra_end = extra_pos + extra_len;
+    
+    while(extra_pos + 4 <= extra_end)
+      {
+      const std::streamoff id       = get_le(&central[extra_pos    ], 2);
+      const uword          data_len = uword( get_le(&central[extra_pos + 2], 2) );
+      
+      if(id == 0x0001)
+        {
+        uword field_pos = extra_pos + 4;
+        
+        if( (uncomp_size  == 0xFFFFFFFF) && (field_pos + 8 <= extra_end) )  { uncomp_size  = get_le(&central[field_pos], 8); field_pos += 8; }
+        if( (comp_size    == 0xFFFFFFFF) && (field_pos + 8 <= extra_end) )  { comp_size    = get_le(&central[field_pos], 8); field_pos += 8; }
+        if( (local_offset == 0xFFFFFFFF) && (field_pos + 8 <= extra_end) )  { local_offset = get_le(&central[field_pos], 8);                 }
+        }
+      
+      extra_pos += 4 + data_len;
+      }
+    
+    // the local header has its own name and extra fields, which may differ from the central directory
+    
+    unsigned char local[30];
+    
+    f.seekg(base + local_offset, std::ios::beg);
+    f.read( reinterpret_cast<char*>(local), 30 );
+    
+    if( (f.good() == false) || (get_le(local, 4) != 0x04034b50) )  { return false; }
+    
+    entry.data_offset = base + local_offset + 30 + get_le(&local[26], 2) + get_le(&local[28], 2);
+    entry.data_size   = comp_size;
+    
+    entries.push_back(entry);
+    
+    pos += 46 + name_len + extra_len + comment_len;
+    }
+  
+  err_msg.clear();
+  
+  return true;
+  }
+
+
+
+//! position the stream at the start of the data of the given entry
+inline
+bool
+seek_entry(std::istream& f, const zip_entry& entry, std::string& err_msg)
+  {
+  if(entry.method != 0)
+    {
+    err_msg = "compressed archive entries are not supported; use numpy.savez() instead of numpy.savez_compressed() for ";
+    return false;
+    }
+  
+  f.clear();
+  f.seekg(entry.data_offset, std::ios::beg);
+  
+  return f.good();
+  }
+
+
+
+inline
+const zip_entry*
+find_entry(const std::vector<zip_entry>& entries, const std::string& name)
+  {
+  for(uword i=0; i < entries.size(); ++i)
+    {
+    if(entries[i].name == name)  { return &(entries[i]); }
+    }
+  
+  return NULL;
+  }
+
+
+
+}  // namespace npy_misc
+
+
+//! @}
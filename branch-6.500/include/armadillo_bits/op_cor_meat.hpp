@@ -38,11 +38,12 @@ op_cor::direct_cor(Mat<eT>& out, const Mat<eT>& A, const uword norm_type)
     const uword N = A.n_rows;
     const eT norm_val = (norm_type == 0) ? ( (N > 1) ? eT(N-1) : eT(1) ) : eT(N);
 
-    const Row<eT> acc = sum(A);
-    const Row<eT> sd  = stddev(A);
-
-    out = (trans(A) * A);
-    out -= (trans(acc) * acc)/eT(N);
+    op_cov::centred_products(out, A, A, true);
+    
+    // the standard deviations are found from the diagonal, as stddev(A) would require another pass over A
+    
+    const Row<eT> sd = sqrt( trans(out.diag()) / ( (N > 1) ? eT(N-1) : eT(1) ) );
+    
     out /= norm_val;
     out /= trans(sd) * sd;
     }
@@ -75,11 +76,10 @@ op_cor::direct_cor(Mat< std::complex<T> >& out, const Mat< std::complex<T> >& A,
     const uword N = A.n_rows;
     const eT norm_val = (norm_type == 0) ? ( (N > 1) ? eT(N-1) : eT(1) ) : eT(N);
 
-    const Row<eT> acc = sum(A);
-    const Row<T>  sd  = stddev(A);
-
-    out = trans(A) * A;               // out = strans(conj(A)) * A;
-    out -= (trans(acc) * acc)/eT(N);  // out -= (strans(conj(acc)) * acc)/eT(N);
+    op_cov::centred_products(out, A, A, true);  // out = strans(conj(A - mean)) * (A - mean)
+    
+    const Row<T> sd = sqrt( real(strans(out.diag())) / ( (N > 1) ? T(N-1) : T(1) ) );
+    
     out /= norm_val;
 
     //out = out / (trans(sd) * sd);
@@ -22,7 +22,17 @@ class op_cov
   template<typename eT> inline static void direct_cov(Mat<eT>&                out, const Mat<eT>& X,                const uword norm_type);
   template<typename  T> inline static void direct_cov(Mat< std::complex<T> >& out, const Mat< std::complex<T> >& X, const uword norm_type);
   
+  template<typename eT> inline static void direct_cov_weighted(Mat<eT>& out, const Mat<eT>& X, const Mat<eT>& W);
+  
   template<typename T1> inline static void apply(Mat<typename T1::elem_type>& out, const Op<T1,op_cov>& in);
+  
+  //
+  
+  template<typename eT> inline static void centred_products(Mat<eT>& out, const Mat<eT>& A, const Mat<eT>& B, const bool is_self, const eT* W_mem = 0);
+  
+  template<typename eT> inline static void centred_products_worker(Mat<eT>& acc, Row<eT>& mean_A, Row<eT>& mean_B, typename get_pod_type<eT>::result& count, const Mat<eT>& A, const Mat<eT>& B, const bool is_self, const eT* W_mem, const uword start_row, const uword end_row, const uword block_rows);
+  
+  template<typename eT> inline static void centred_products_merge(Mat<eT>& acc, Row<eT>& mean_A, Row<eT>& mean_B, typename get_pod_type<eT>::result& count, const Mat<eT>& acc2, const Row<eT>& mean_A2, const Row<eT>& mean_B2, const typename get_pod_type<eT>::result count2, const bool is_self);
   };
 
 
@@ -37,11 +37,9 @@ op_cov::direct_cov(Mat<eT>& out, const Mat<eT>& A, const uword norm_type)
     {
     const uword N = A.n_rows;
     const eT norm_val = (norm_type == 0) ? ( (N > 1) ? eT(N-1) : eT(1) ) : eT(N);
-
-    const Row<eT> acc = sum(A);
-
-    out = trans(A) * A;
-    out -= (trans(acc) * acc)/eT(N);
+    
+    op_cov::centred_products(out, A, A, true);
+    
     out /= norm_val;
     }
   }
@@ -77,16 +75,49 @@ op_cov::direct_cov(Mat< std::complex<T> >& out, const Mat< std::complex<T> >& A,
     const uword N = A.n_rows;
     const eT norm_val = (norm_type == 0) ? ( (N > 1) ? eT(N-1) : eT(1) ) : eT(N);
     
-    const Row<eT> acc = sum(A);
+    op_cov::centred_products(out, A, A, true);  // out = strans(conj(A - mean)) * (A - mean)
     
-    out = trans(A) * A;               // out = strans(conj(A)) * A;
-    out -= (trans(acc) * acc)/eT(N);  // out -= (strans(conj(acc)) * acc)/eT(N);
     out /= norm_val;
     }
   }
 
 
 
+//! weighted covariance, ie. sum_i W(i) * trans(X.row(i) - mu) * (X.row(i) - mu) / sum(W), where mu is the weighted mean;
+//! each row of X is an observation
+template<typename eT>
+inline
+void
+op_cov::direct_cov_weighted(Mat<eT>& out, const Mat<eT>& X, const Mat<eT>& W)
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_debug_check( ((W.is_vec() == false) && (W.is_empty() == false)), "cov_weighted(): given weights must be a vector" );
+  
+  const Mat<eT> A( const_cast<eT*>(X.memptr()), (X.is_vec() ? X.n_elem : X.n_rows), (X.is_vec() ? uword(1) : X.n_cols), false, true );
+  
+  arma_debug_check( (W.n_elem != A.n_rows), "cov_weighted(): number of weights does not match the number of observations" );
+  
+  const eT* W_mem = W.memptr();
+  
+  eT W_sum = eT(0);
+  
+  for(uword i=0; i < W.n_elem; ++i)
+    {
+    const eT w = W_mem[i];
+    
+    arma_debug_check( ((w < eT(0)) || (arma_isfinite(w) == false)), "cov_weighted(): weights must be finite and non-negative" );
+    
+    W_sum += w;
+    }
+  
+  op_cov::centred_products(out, A, A, true, W_mem);
+  
+  out /= W_sum;
+  }
+
+
+
 template<typename T1>
 inline
 void
@@ -106,4 +137,241 @@ op_cov::apply(Mat<typename T1::elem_type>& out, const Op<T1,op_cov>& in)
 
 
 
+
+//! sums of the products of the centred columns of A and B, ie. trans(A - mean(A)) * (B - mean(B)),
+//! where each row is an observation; if is_self is true, B must be A.
+//! if W_mem is not NULL, it points to one non-negative weight per row (only for is_self),
+//! the means are weighted and each product is multiplied by the weight of its row.
+//! the rows are processed in blocks: each block is centred by its own mean (into a small buffer),
+//! multiplied via syrk/gemm, and combined with the results of the previous blocks via the pairwise update
+//! acc = acc + acc2 + trans(delta_A)*delta_B * (count*count2)/(count+count2), where delta is the difference between the means.
+//! this needs one pass over the data, and memory for one block per thread.
+//! if OpenMP is enabled, the blocks of large matrices are split between threads.
+template<typename eT>
+inline
+void
+op_cov::centred_products(Mat<eT>& out, const Mat<eT>& A, const Mat<eT>& B, const bool is_self, const eT* W_mem)
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename get_pod_type<eT>::result T;
+  
+  const uword N        = A.n_rows;
+  const uword A_n_cols = A.n_cols;
+  const uword B_n_cols = (is_self) ? A.n_cols : B.n_cols;
+  
+  const uword block_rows = (std::max)( uword(256), uword(262144) / (A_n_cols + B_n_cols) );
+  
+  out.zeros(A_n_cols, B_n_cols);
+  
+  if(N == 0)  { return; }
+  
+  Row<eT> mean_A;
+  Row<eT> mean_B;
+  T       count = T(0);
+  
+  #if defined(_OPENMP)
+    {
+    const uword n_blocks = (N + block_rows - 1) / block_rows;
+    
+    const bool use_mp = (n_blocks > 1) && ((double(N) * double(A_n_cols) * double(B_n_cols)) >= double(1e7)) && (omp_get_max_threads() > 1) && (omp_in_parallel() == false);
+    
+    if(use_mp)
+      {
+      const uword n_threads = (std::min)( n_blocks, uword(omp_get_max_threads()) );
+      
+      field< Mat<eT> > t_acc(n_threads);
+      field< Row<eT> > t_mean_A(n_threads);
+      field< Row<eT> > t_mean_B(n_threads);
+      
+      Col<T> t_count(n_threads, fill::zeros);
+      
+      #pragma omp parallel for schedule(static) num_threads(int(n_threads))
+      for(uword t=0; t < n_threads; ++t)
+        {
+        const uword start_row = ((t    ) * n_blocks / n_threads) * block_rows;
+        const uword end_row   = (std::min)( N, ((t + 1) * n_blocks / n_threads) * block_rows );
+        
+        t_acc(t).zeros(A_n_cols, B_n_cols);
+        
+        op_cov::centred_products_worker(t_acc(t), t_mean_A(t), t_mean_B(t), t_count[t], A, B, is_self, W_mem, start_row, end_row, block_rows);
+        }
+      
+      for(uword t=0; t < n_threads; ++t)
+        {
+        op_cov::centred_products_merge(out, mean_A, mean_B, count, t_acc(t), t_mean_A(t), t_mean_B(t), t_count[t], is_self);
+        }
+      
+      return;
+      }
+    }
+  #endif
+  
+  op_cov::centred_products_worker(out, mean_A, mean_B, count, A, B, is_self, W_mem, 0, N, block_rows);
+  }
+
+
+
+//! process rows [start_row, end_row) block by block, combining the results with the accumulated values in acc
+template<typename eT>
+inline
+void
+op_cov::centred_products_worker(Mat<eT>& acc, Row<eT>& mean_A, Row<eT>& mean_B, typename get_pod_type<eT>::result& count, const Mat<eT>& A, const Mat<eT>& B, const bool is_self, const eT* W_mem, const uword start_row, const uword end_row, const uword block_rows)
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename get_pod_type<eT>::result T;
+  
+  const uword A_n_cols = A.n_cols;
+  const uword B_n_cols = B.n_cols;
+  
+  Mat<eT> A_block;
+  Mat<eT> B_block;
+  Mat<eT> C;
+  
+  Row<eT> A_block_mean(A_n_cols);
+  Row<eT> B_block_mean;
+  
+  if(is_self == false)  { B_block_mean.set_size(B_n_cols); }
+  
+  podarray<eT> sqrt_w;
+  
+  if(W_mem != 0)  { sqrt_w.set_size(block_rows); }
+  
+  for(uword block_start = start_row; block_start < end_row; block_start += block_rows)
+    {
+    const uword n = (std::min)( block_rows, end_row - block_start );
+    
+    T block_count = T(n);
+    
+    if(W_mem != 0)
+      {
+      const eT* w = W_mem + block_start;
+      
+      block_count = access::tmp_real( arrayops::accumulate(w, n) );
+      
+      if(block_count == T(0))  { continue; }
+      
+      for(uword i=0; i < n; ++i)  { sqrt_w[i] = std::sqrt(w[i]); }
+      }
+    
+    A_block.set_size(n, A_n_cols);
+    
+    for(uword col=0; col < A_n_cols; ++col)
+      {
+      const eT* src = A.colptr(col) + block_start;
+            eT* dst = A_block.colptr(col);
+      
+      if(W_mem == 0)
+        {
+        const eT mean_val = arrayops::accumulate(src, n) / eT(n);
+        
+        for(uword i=0; i < n; ++i)  { dst[i] = src[i] - mean_val; }
+        
+        A_block_mean[col] = mean_val;
+        }
+      else
+        {
+        const eT* w = W_mem + block_start;
+        
+        eT acc_val = eT(0);
+        
+        for(uword i=0; i < n; ++i)  { acc_val += w[i] * src[i]; }
+        
+        const eT mean_val = acc_val / eT(block_count);
+        
+        for(uword i=0; i < n; ++i)  { dst[i] = sqrt_w[i] * (src[i] - mean_val); }
+        
+        A_block_mean[col] = mean_val;
+        }
+      }
+    
+    if(is_self == false)
+      {
+      B_block.set_size(n, B_n_cols);
+      
+      for(uword col=0; col < B_n_cols; ++col)
+        {
+        const eT* src = B.colptr(col) + block_start;
+              eT* dst = B_block.colptr(col);
+        
+        const eT mean_val = arrayops::accumulate(src, n) / eT(n);
+        
+        for(uword i=0; i < n; ++i)  { dst[i] = src[i] - mean_val; }
+        
+        B_block_mean[col] = mean_val;
+        }
+      }
+    
+    if(count == T(0))
+      {
+      if(is_self)  { acc += trans(A_block) * A_block; }  // done via syrk() for real matrices
+      else         { acc += trans(A_block) * B_block; }
+      
+      mean_A = A_block_mean;
+      mean_B = B_block_mean;
+      count  = block_count;
+      }
+    else
+      {
+      if(is_self)  { C = trans(A_block) * A_block; }
+      else         { C = trans(A_block) * B_block; }
+      
+      op_cov::centred_products_merge(acc, mean_A, mean_B, count, C, A_block_mean, B_block_mean, block_count, is_self);
+      }
+    }
+  }
+
+
+
+//! combine two sets of accumulated values, each with its own means and number of rows (or sum of weights)
+template<typename eT>
+inline
+void
+op_cov::centred_products_merge(Mat<eT>& acc, Row<eT>& mean_A, Row<eT>& mean_B, typename get_pod_type<eT>::result& count, const Mat<eT>& acc2, const Row<eT>& mean_A2, const Row<eT>& mean_B2, const typename get_pod_type<eT>::result count2, const bool is_self)
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename get_pod_type<eT>::result T;
+  
+  if(count2 == T(0))  { return; }
+  
+  if(count == T(0))
+    {
+    acc    = acc2;
+    mean_A = mean_A2;
+    mean_B = mean_B2;
+    count  = count2;
+    
+    return;
+    }
+  
+  const T N = count + count2;
+  
+  const T scale   = (count / N) * count2;
+  const T scale_2 = count2 / N;
+  
+  const Row<eT> delta_A = mean_A2 - mean_A;
+  
+  acc += acc2;
+  
+  if(is_self)
+    {
+    acc += scale * (trans(delta_A) * delta_A);
+    }
+  else
+    {
+    const Row<eT> delta_B = mean_B2 - mean_B;
+    
+    acc += scale * (trans(delta_A) * delta_B);
+    
+    mean_B += scale_2 * delta_B;
+    }
+  
+  mean_A += scale_2 * delta_A;
+  
+  count = N;
+  }
+
+
 //! @}
@@ -20,6 +20,41 @@ class op_fft_real
   
   template<typename T1>
   inline static void apply( Mat< std::complex<typename T1::pod_type> >& out, const mtOp<std::complex<typename T1::pod_type>,T1,op_fft_real>& in );
+  
+  template<typename T1>
+  inline static void apply_plan( Mat< std::complex<typename T1::pod_type> >& out, const Proxy<T1>& P, const fft_plan< std::complex<typename T1::pod_type> >& plan );
+  };
+
+
+
+class op_rfft
+  {
+  public:
+  
+  template<typename T1>
+  inline static void apply( Mat< std::complex<typename T1::pod_type> >& out, const mtOp<std::complex<typename T1::pod_type>,T1,op_rfft>& in );
+  
+  template<typename T1, bool full>
+  inline static void apply_noalias( Mat< std::complex<typename T1::pod_type> >& out, const Proxy<T1>& P, const uword N_user, const bool is_vec );
+  
+  template<bool full, typename T>
+  inline static void apply2( Mat< std::complex<T> >& out, const Mat<T>& X );
+  };
+
+
+
+class op_irfft
+  {
+  public:
+  
+  template<typename T1>
+  inline static void apply( Mat<typename T1::pod_type>& out, const mtOp<typename T1::pod_type,T1,op_irfft>& in );
+  
+  template<typename T1>
+  inline static void apply_noalias( Mat<typename T1::pod_type>& out, const Proxy<T1>& P, const uword N_user, const bool is_vec );
+  
+  template<typename T>
+  inline static void apply2( Mat<T>& out, const Mat< std::complex<T> >& X, const uword n_rows, const uword n_cols );
   };
 
 
@@ -33,6 +68,24 @@ class op_fft_cx
   
   template<typename T1, bool inverse>
   inline static void apply_noalias(Mat<typename T1::elem_type>& out, const Proxy<T1>& P, const uword a, const uword b);
+  
+  template<typename T1>
+  inline static void apply_plan(Mat<typename T1::elem_type>& out, const Proxy<T1>& P, const fft_plan<typename T1::elem_type>& plan);
+  
+  template<typename eT>
+  inline static void apply_cols(Mat<eT>& out, const Mat<eT>& X, const fft_plan<eT>& plan);
+  
+  template<bool inverse, typename eT>
+  inline static void apply2(Mat<eT>& out, const Mat<eT>& X);
+  
+  template<typename engine_type, typename out_eT, typename in_eT>
+  inline static void run_cols(Mat<out_eT>& out, const Mat<in_eT>& X, const engine_type& engine, const uword N_in);
+  
+  template<typename engine_type, typename out_eT, typename in_eT>
+  inline static void run_cols_worker(Mat<out_eT>& out, const Mat<in_eT>& X, const engine_type& engine, const uword N_in, const uword col_start, const uword col_end);
+  
+  template<typename eT>
+  inline static void scale_inverse(Mat<eT>& out, const uword N);
 
   template<typename T1> arma_hot inline static void copy_vec       (typename Proxy<T1>::elem_type* dest, const Proxy<T1>& P, const uword N);
   template<typename T1> arma_hot inline static void copy_vec_proxy (typename Proxy<T1>::elem_type* dest, const Proxy<T1>& P, const uword N);
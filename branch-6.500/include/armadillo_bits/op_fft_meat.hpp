@@ -26,8 +26,61 @@ op_fft_real::apply( Mat< std::complex<typename T1::pod_type> >& out, const mtOp<
   {
   arma_extra_debug_sigprint();
   
-  typedef typename T1::pod_type         in_eT;
-  typedef typename std::complex<in_eT> out_eT;
+  const Proxy<T1> P(in.m);
+  
+  const uword n_rows = P.get_n_rows();
+  const uword n_cols = P.get_n_cols();
+  const uword n_elem = P.get_n_elem();
+  
+  const bool is_vec = ( (n_rows == 1) || (n_cols == 1) );
+  
+  const uword N_orig = (is_vec)              ? n_elem         : n_rows;
+  const uword N_user = (in.aux_uword_b == 0) ? in.aux_uword_a : N_orig;
+  
+  // no need to worry about aliasing, as we're going from a real object to complex complex, which by definition cannot alias
+  
+  op_rfft::apply_noalias<T1,true>(out, P, N_user, is_vec);
+  }
+
+
+
+//! the real transform gives the first half of the output, and the second half is obtained via conjugate symmetry.
+//! for real input, the inverse transform is the conjugate of the forward transform
+template<typename T1>
+inline
+void
+op_fft_real::apply_plan( Mat< std::complex<typename T1::pod_type> >& out, const Proxy<T1>& P, const fft_plan< std::complex<typename T1::pod_type> >& plan )
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword n_rows = P.get_n_rows();
+  const uword n_cols = P.get_n_cols();
+  
+  const bool is_vec = ( (n_rows == 1) || (n_cols == 1) );
+  
+  op_rfft::apply_noalias<T1,true>(out, P, plan.N, is_vec);
+  
+  if(plan.inverse)
+    {
+    out = conj(out);
+    
+    op_fft_cx::scale_inverse(out, plan.N);
+    }
+  }
+
+
+
+//
+// op_rfft
+
+
+
+template<typename T1>
+inline
+void
+op_rfft::apply( Mat< std::complex<typename T1::pod_type> >& out, const mtOp<std::complex<typename T1::pod_type>,T1,op_rfft>& in )
+  {
+  arma_extra_debug_sigprint();
   
   const Proxy<T1> P(in.m);
   
@@ -40,88 +93,266 @@ op_fft_real::apply( Mat< std::complex<typename T1::pod_type> >& out, const mtOp<
   const uword N_orig = (is_vec)              ? n_elem         : n_rows;
   const uword N_user = (in.aux_uword_b == 0) ? in.aux_uword_a : N_orig;
   
-  fft_engine<out_eT,false> worker(N_user);
+  op_rfft::apply_noalias<T1,false>(out, P, N_user, is_vec);
+  }
+
+
+
+//! transform a real vector (if is_vec is true), or each column of a real matrix, zero padded or truncated to length N_user;
+//! the output has N_user/2+1 rows, or N_user rows if full is true
+template<typename T1, bool full>
+inline
+void
+op_rfft::apply_noalias( Mat< std::complex<typename T1::pod_type> >& out, const Proxy<T1>& P, const uword N_user, const bool is_vec )
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename T1::pod_type         in_eT;
+  typedef typename std::complex<in_eT> out_eT;
   
-  // no need to worry about aliasing, as we're going from a real object to complex complex, which by definition cannot alias
+  const uword n_rows = P.get_n_rows();
+  const uword n_cols = P.get_n_cols();
+  
+  const uword N_orig = (is_vec) ? P.get_n_elem() : n_rows;
+  const uword N_out  = (full || (N_user == 0)) ? N_user : (N_user/2 + 1);
+  const uword n_vec  = (is_vec) ? uword(1) : n_cols;
   
   if(is_vec)
     {
-    (n_cols == 1) ? out.set_size(N_user, 1) : out.set_size(1, N_user);
-    
-    if( (out.n_elem == 0) || (N_orig == 0) )
-      {
-      out.zeros();
-      return;
-      }
-    
-    if( (N_user == 1) && (N_orig >= 1) )
-      {
-      out[0] = out_eT( P[0] );
-      return;
-      }
-    
-    podarray<out_eT> data(N_user);
-    
-    out_eT* data_mem = data.memptr();
-    
-    if(N_user > N_orig)  { arrayops::fill_zeros( &data_mem[N_orig], (N_user - N_orig) ); }
-    
-    const uword N = (std::min)(N_user, N_orig);
-    
-    if(Proxy<T1>::prefer_at_accessor == false)
+    (n_cols == 1) ? out.set_size(N_out, 1) : out.set_size(1, N_out);
+    }
+  else
+    {
+    out.set_size(N_out, n_cols);
+    }
+  
+  if( (out.n_elem == 0) || (N_orig == 0) )
+    {
+    out.zeros();
+    return;
+    }
+  
+  const fft_engine_ref< fft_engine_real<out_eT,false> > engine(N_user);
+  
+  if(is_vec)
+    {
+    if( (N_user > N_orig) || (is_Mat<typename Proxy<T1>::stored_type>::value == false) )
       {
-      typename Proxy<T1>::ea_type X = P.get_ea();
+      podarray<in_eT> data(N_user);
+      
+      in_eT* data_mem = data.memptr();
+      
+      if(N_user > N_orig)  { arrayops::fill_zeros( &data_mem[N_orig], (N_user - N_orig) ); }
       
-      for(uword i=0; i < N; ++i)  { data_mem[i] = out_eT( X[i], in_eT(0) ); }
+      op_fft_cx::copy_vec( data_mem, P, (std::min)(N_user, N_orig) );
+      
+      engine->run( out.memptr(), data_mem );
       }
     else
       {
-      if(n_cols == 1)
-        {
-        for(uword i=0; i < N; ++i)  { data_mem[i] = out_eT( P.at(i,0), in_eT(0) ); }
-        }
-      else
-        {
-        for(uword i=0; i < N; ++i)  { data_mem[i] = out_eT( P.at(0,i), in_eT(0) ); }
-        }
+      const unwrap< typename Proxy<T1>::stored_type > tmp(P.Q);
+      
+      engine->run( out.memptr(), tmp.M.memptr() );
       }
-    
-    worker.run( out.memptr(), data_mem );
     }
   else
     {
-    // process each column seperately
-    
-    out.set_size(N_user, n_cols);
-    
-    if( (out.n_elem == 0) || (N_orig == 0) )
-      {
-      out.zeros();
-      return;
-      }
+    const unwrap< typename Proxy<T1>::stored_type > tmp(P.Q);
     
-    if( (N_user == 1) && (N_orig >= 1) )
+    op_fft_cx::run_cols(out, tmp.M, *(engine.engine), N_user);
+    }
+  
+  if(full)
+    {
+    for(uword col=0; col < n_vec; ++col)
       {
-      for(uword col=0; col < n_cols; ++col)  { out.at(0,col) = out_eT( P.at(0,col) ); }
+      out_eT* out_mem = out.colptr(col);
       
-      return;
+      for(uword k = N_user/2 + 1; k < N_user; ++k)  { out_mem[k] = std::conj(out_mem[N_user - k]); }
       }
+    }
+  }
+
+
+
+//! 2D transform of a real matrix, giving the first n_rows/2+1 rows of the output;
+//! if full is true, the remaining rows are obtained via conjugate symmetry
+template<bool full, typename T>
+inline
+void
+op_rfft::apply2( Mat< std::complex<T> >& out, const Mat<T>& X )
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef std::complex<T> eT;
+  
+  const uword n_rows = X.n_rows;
+  const uword n_cols = X.n_cols;
+  
+  const Proxy< Mat<T> > P(X);
+  
+  Mat<eT> A;
+  Mat<eT> B;
+  
+  op_rfft::apply_noalias< Mat<T>, false >(A, P, n_rows, false);
+  
+  op_strans::apply_mat_noalias(B, A);
+  
+  const fft_plan<eT> plan(n_cols, false);
+  
+  op_fft_cx::apply_cols(A, B, plan);
+  
+  if(full == false)
+    {
+    op_strans::apply_mat_noalias(out, A);
+    return;
+    }
+  
+  op_strans::apply_mat_noalias(B, A);
+  
+  out.set_size(n_rows, n_cols);
+  
+  if(out.n_elem == 0)  { return; }
+  
+  const uword H = B.n_rows;
+  
+  for(uword col=0; col < n_cols; ++col)
+    {
+    eT* out_mem = out.colptr(col);
     
-    podarray<out_eT> data(N_user);
-    
-    out_eT* data_mem = data.memptr();
-    
-    if(N_user > N_orig)  { arrayops::fill_zeros( &data_mem[N_orig], (N_user - N_orig) ); }
+    arrayops::copy(out_mem, B.colptr(col), H);
     
-    const uword N = (std::min)(N_user, N_orig);
+    const eT* B_mem = B.colptr( (col > 0) ? (n_cols - col) : uword(0) );
     
-    for(uword col=0; col < n_cols; ++col)
+    for(uword row=H; row < n_rows; ++row)  { out_mem[row] = std::conj(B_mem[n_rows - row]); }
+    }
+  }
+
+
+
+//
+// op_irfft
+
+
+
+template<typename T1>
+inline
+void
+op_irfft::apply( Mat<typename T1::pod_type>& out, const mtOp<typename T1::pod_type,T1,op_irfft>& in )
+  {
+  arma_extra_debug_sigprint();
+  
+  const Proxy<T1> P(in.m);
+  
+  const uword n_rows = P.get_n_rows();
+  const uword n_cols = P.get_n_cols();
+  const uword n_elem = P.get_n_elem();
+  
+  const bool is_vec = ( (n_rows == 1) || (n_cols == 1) );
+  
+  const uword N_orig = (is_vec) ? n_elem : n_rows;
+  const uword N_user = (in.aux_uword_b == 0) ? in.aux_uword_a : ( (N_orig > 0) ? 2*(N_orig-1) : uword(0) );
+  
+  // no need to worry about aliasing, as we're going from a complex object to a real object
+  
+  op_irfft::apply_noalias(out, P, N_user, is_vec);
+  }
+
+
+
+//! inverse transform of the first N_user/2+1 values of a complex vector (if is_vec is true), or of each column of a complex matrix,
+//! giving N_user real values; missing values are taken as zero.  the output is scaled by 1/N_user, as per ifft()
+template<typename T1>
+inline
+void
+op_irfft::apply_noalias( Mat<typename T1::pod_type>& out, const Proxy<T1>& P, const uword N_user, const bool is_vec )
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename T1::elem_type in_eT;
+  
+  const uword n_rows = P.get_n_rows();
+  const uword n_cols = P.get_n_cols();
+  
+  const uword N_orig = (is_vec) ? P.get_n_elem() : n_rows;
+  const uword N_in   = (N_user > 0) ? (N_user/2 + 1) : uword(0);
+  
+  if(is_vec)
+    {
+    (n_cols == 1) ? out.set_size(N_user, 1) : out.set_size(1, N_user);
+    }
+  else
+    {
+    out.set_size(N_user, n_cols);
+    }
+  
+  if( (out.n_elem == 0) || (N_orig == 0) )
+    {
+    out.zeros();
+    return;
+    }
+  
+  const fft_engine_ref< fft_engine_real<in_eT,true> > engine(N_user);
+  
+  if(is_vec)
+    {
+    if( (N_in > N_orig) || (is_Mat<typename Proxy<T1>::stored_type>::value == false) )
       {
-      for(uword i=0; i < N; ++i)  { data_mem[i] = P.at(i, col); }
+      podarray<in_eT> data(N_in);
+      
+      in_eT* data_mem = data.memptr();
+      
+      if(N_in > N_orig)  { arrayops::fill_zeros( &data_mem[N_orig], (N_in - N_orig) ); }
+      
+      op_fft_cx::copy_vec( data_mem, P, (std::min)(N_in, N_orig) );
+      
+      engine->run( out.memptr(), data_mem );
+      }
+    else
+      {
+      const unwrap< typename Proxy<T1>::stored_type > tmp(P.Q);
       
-      worker.run( out.colptr(col), data_mem );
+      engine->run( out.memptr(), tmp.M.memptr() );
       }
     }
+  else
+    {
+    const unwrap< typename Proxy<T1>::stored_type > tmp(P.Q);
+    
+    op_fft_cx::run_cols(out, tmp.M, *(engine.engine), N_in);
+    }
+  
+  op_fft_cx::scale_inverse(out, N_user);
+  }
+
+
+
+//! inverse of op_rfft::apply2(); X holds the first rows of the 2D transform of a real matrix with n_rows rows and n_cols columns
+template<typename T>
+inline
+void
+op_irfft::apply2( Mat<T>& out, const Mat< std::complex<T> >& X, const uword n_rows, const uword n_cols )
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef std::complex<T> eT;
+  
+  Mat<eT> A;
+  Mat<eT> B;
+  
+  op_strans::apply_mat_noalias(A, X);
+  
+  const fft_plan<eT> plan(n_cols, true);
+  
+  op_fft_cx::apply_cols(B, A, plan);
+  
+  op_fft_cx::scale_inverse(B, n_cols);
+  
+  op_strans::apply_mat_noalias(A, B);
+  
+  const Proxy< Mat<eT> > P(A);
+  
+  op_irfft::apply_noalias(out, P, n_rows, false);
   }
 
 
@@ -175,7 +406,30 @@ op_fft_cx::apply_noalias(Mat<typename T1::elem_type>& out, const Proxy<T1>& P, c
   const uword N_orig = (is_vec) ? n_elem : n_rows;
   const uword N_user = (b == 0) ? a      : N_orig;
   
-  fft_engine<eT,inverse> worker(N_user);
+  const fft_plan<eT> plan(N_user, inverse);
+  
+  op_fft_cx::apply_plan(out, P, plan);
+  }
+
+
+
+template<typename T1>
+inline
+void
+op_fft_cx::apply_plan(Mat<typename T1::elem_type>& out, const Proxy<T1>& P, const fft_plan<typename T1::elem_type>& plan)
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename T1::elem_type eT;
+  
+  const uword n_rows = P.get_n_rows();
+  const uword n_cols = P.get_n_cols();
+  const uword n_elem = P.get_n_elem();
+  
+  const bool is_vec = ( (n_rows == 1) || (n_cols == 1) );
+  
+  const uword N_orig = (is_vec) ? n_elem : n_rows;
+  const uword N_user = plan.N;
   
   if(is_vec)
     {
@@ -203,80 +457,171 @@ op_fft_cx::apply_noalias(Mat<typename T1::elem_type>& out, const Proxy<T1>& P, c
       
       op_fft_cx::copy_vec( data_mem, P, (std::min)(N_user, N_orig) );
       
-      worker.run( out.memptr(), data_mem );
+      plan.run( out.memptr(), data_mem );
       }
     else
       {
       const unwrap< typename Proxy<T1>::stored_type > tmp(P.Q);
       
-      worker.run( out.memptr(), tmp.M.memptr() );
+      plan.run( out.memptr(), tmp.M.memptr() );
       }
     }
   else
     {
     // process each column seperately
     
-    out.set_size(N_user, n_cols);
-    
-    if( (out.n_elem == 0) || (N_orig == 0) )
-      {
-      out.zeros();
-      return;
-      }
+    const unwrap< typename Proxy<T1>::stored_type > tmp(P.Q);
     
-    if( (N_user == 1) && (N_orig >= 1) )
-      {
-      for(uword col=0; col < n_cols; ++col)  { out.at(0,col) = P.at(0,col); }
-      
-      return;
-      }
+    op_fft_cx::apply_cols(out, tmp.M, plan);
+    }
+  
+  if(plan.inverse)  { op_fft_cx::scale_inverse(out, N_user); }
+  }
+
+
+
+//! transform each column of X, zero padded or truncated to length plan.N, without scaling the inverse transform;
+//! out and X must be different objects
+template<typename eT>
+inline
+void
+op_fft_cx::apply_cols(Mat<eT>& out, const Mat<eT>& X, const fft_plan<eT>& plan)
+  {
+  arma_extra_debug_sigprint();
+  
+  out.set_size(plan.N, X.n_cols);
+  
+  if( (out.n_elem == 0) || (X.n_rows == 0) )
+    {
+    out.zeros();
+    return;
+    }
+  
+  op_fft_cx::run_cols(out, X, plan, plan.N);
+  }
+
+
+
+//! 2D transform of a complex matrix: the columns are transformed, followed by the rows;
+//! the rows are transformed as the columns of the transposed matrix
+template<bool inverse, typename eT>
+inline
+void
+op_fft_cx::apply2(Mat<eT>& out, const Mat<eT>& X)
+  {
+  arma_extra_debug_sigprint();
+  
+  Mat<eT> A;
+  Mat<eT> B;
+  
+  const fft_plan<eT> plan_a(X.n_rows, inverse);
+  
+  op_fft_cx::apply_cols(A, X, plan_a);
+  
+  op_strans::apply_mat_noalias(B, A);
+  
+  const fft_plan<eT> plan_b(X.n_cols, inverse);
+  
+  op_fft_cx::apply_cols(A, B, plan_b);
+  
+  op_strans::apply_mat_noalias(out, A);
+  
+  if(inverse)  { op_fft_cx::scale_inverse(out, X.n_elem); }
+  }
+
+
+
+//! apply the given plan or engine to each column of X, zero padded or truncated to N_in elements, storing the results in out.
+//! if there is enough work, the columns are split between threads, with each thread having its own workspace
+template<typename engine_type, typename out_eT, typename in_eT>
+inline
+void
+op_fft_cx::run_cols(Mat<out_eT>& out, const Mat<in_eT>& X, const engine_type& engine, const uword N_in)
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword n_cols = X.n_cols;
+
+  #if defined(_OPENMP)
+    {
+    const uword n_threads_max = uword( (std::max)(int(1), int(omp_get_max_threads())) );
+    const uword n_threads     = (out.n_elem >= 16384) ? (std::min)(n_cols, n_threads_max) : uword(1);
     
-    if( (N_user > N_orig) || (is_Mat<typename Proxy<T1>::stored_type>::value == false) )
+    if(n_threads > 1)
       {
-      podarray<eT> data(N_user);
-      
-      eT* data_mem = data.memptr();
-      
-      if(N_user > N_orig)  { arrayops::fill_zeros( &data_mem[N_orig], (N_user - N_orig) ); }
-      
-      const uword N = (std::min)(N_user, N_orig);
-      
-      for(uword col=0; col < n_cols; ++col)
+      #pragma omp parallel for schedule(static)
+      for(uword t=0; t < n_threads; ++t)
         {
-        for(uword i=0; i < N; ++i)  { data_mem[i] = P.at(i, col); }
+        const uword col_start = (t     * n_cols) / n_threads;
+        const uword col_end   = ((t+1) * n_cols) / n_threads;
         
-        worker.run( out.colptr(col), data_mem );
+        op_fft_cx::run_cols_worker(out, X, engine, N_in, col_start, col_end);
         }
-      }
-    else
-      {
-      const unwrap< typename Proxy<T1>::stored_type > tmp(P.Q);
       
-      for(uword col=0; col < n_cols; ++col)
-        {
-        worker.run( out.colptr(col), tmp.M.colptr(col) );
-        }
+      return;
       }
     }
-    
+  #endif
+  
+  op_fft_cx::run_cols_worker(out, X, engine, N_in, 0, n_cols);
+  }
+
+
+
+template<typename engine_type, typename out_eT, typename in_eT>
+inline
+void
+op_fft_cx::run_cols_worker(Mat<out_eT>& out, const Mat<in_eT>& X, const engine_type& engine, const uword N_in, const uword col_start, const uword col_end)
+  {
+  arma_extra_debug_sigprint();
   
-  // correct the scaling for the inverse transform
-  if(inverse == true)
+  typedef typename get_pod_type<in_eT>::result T;
+  
+  const uword N_orig = X.n_rows;
+  
+  const bool do_pad = (N_in > N_orig);
+  
+  podarray<in_eT> data( (do_pad) ? N_in : uword(0) );
+  podarray<T>     work( engine.n_work() );
+  
+  in_eT* data_mem = data.memptr();
+  T*     work_mem = work.memptr();
+  
+  if(do_pad)  { arrayops::fill_zeros( &data_mem[N_orig], (N_in - N_orig) ); }
+  
+  for(uword col=col_start; col < col_end; ++col)
     {
-    typedef typename get_pod_type<eT>::result T;
+    const in_eT* in_mem = X.colptr(col);
     
-    const T k = T(1) / T(N_user);
+    if(do_pad)  { arrayops::copy(data_mem, in_mem, N_orig);  in_mem = data_mem; }
     
-    eT* out_mem = out.memptr();
-    
-    const uword out_n_elem = out.n_elem;
-    
-    for(uword i=0; i < out_n_elem; ++i)  { out_mem[i] *= k; }
+    engine.run( out.colptr(col), in_mem, work_mem );
     }
   }
 
 
 
+//! correct the scaling for the inverse transform
+template<typename eT>
+inline
+void
+op_fft_cx::scale_inverse(Mat<eT>& out, const uword N)
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename get_pod_type<eT>::result T;
+  
+  const T k = T(1) / T(N);
+  
+  eT* out_mem = out.memptr();
+  
+  const uword out_n_elem = out.n_elem;
+  
+  for(uword i=0; i < out_n_elem; ++i)  { out_mem[i] *= k; }
+  }
+
+
+
 template<typename T1>
 arma_hot
 inline
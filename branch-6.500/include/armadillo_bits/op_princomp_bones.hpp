@@ -110,6 +110,27 @@ class op_princomp
     );
   
   
+  //
+  // truncated version, for dense and sparse matrices
+  
+  //! number of extra columns used by the randomized range finder
+  static const uword trunc_n_oversample = 10;
+  
+  //! number of power iterations used by the randomized range finder
+  static const uword trunc_n_power_iter = 4;
+  
+  template<typename eT, typename TA>
+  inline static bool
+  direct_princomp_trunc
+    (
+           Mat<eT>&                                  coeff_out,
+           Mat<eT>&                                  score_out,
+           Col<typename get_pod_type<eT>::result>&   latent_out,
+    const  TA&                                       X,
+    const  uword                                     k
+    );
+  
+  
   template<typename T1>
   inline static void
   apply(Mat<typename T1::elem_type>& out, const Op<T1,op_princomp>& in);
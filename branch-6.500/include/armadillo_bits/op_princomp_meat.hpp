@@ -581,6 +581,124 @@ op_princomp::direct_princomp
 
 
 
+//! \brief
+//! principal component analysis -- truncated version
+//! only the first k principal components are computed;
+//! X is either Mat<eT> or SpMat<eT>, and is never centred explicitly:
+//! products with the centred data are obtained as (X - ones*mu)*B = X*B - ones*(mu*B),
+//! so that sparse matrices are not converted to dense matrices.
+//! computation is done via a randomized range finder with power iterations (Halko, Martinsson and Tropp, 2011):
+//! the range of the centred data is approximated by an orthonormal basis Q with k+trunc_n_oversample columns,
+//! followed by the singular value decomposition of the small matrix trans(Q)*(centred data)
+template<typename eT, typename TA>
+inline
+bool
+op_princomp::direct_princomp_trunc
+  (
+         Mat<eT>&                                  coeff_out,
+         Mat<eT>&                                  score_out,
+         Col<typename get_pod_type<eT>::result>&   latent_out,
+  const  TA&                                       X,
+  const  uword                                     k
+  )
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename get_pod_type<eT>::result T;
+  
+  const uword n_rows = X.n_rows;
+  const uword n_cols = X.n_cols;
+  
+  arma_debug_check( ((k == 0) || (k > n_cols)), "princomp(): k must be greater than zero and not greater than the number of columns" );
+  
+  Mat<eT> coeff;
+  Mat<eT> score;
+  Col<T>  latent;
+  
+  const uword n_basis = k + trunc_n_oversample;
+  
+  if( (n_basis >= n_rows) || (n_basis >= n_cols) )
+    {
+    // no gain from the randomized version
+    
+    const Mat<eT> in(X);
+    
+    const bool status = op_princomp::direct_princomp(coeff, score, latent, in);
+    
+    if(status == false)  { return false; }
+    
+    coeff_out  = coeff.cols(0,k-1);
+    score_out  = score.cols(0,k-1);
+    latent_out = latent.rows(0,k-1);
+    
+    return true;
+    }
+  
+  const Row<eT> mu = (ones< Row<eT> >(n_rows) * X) / eT(n_rows);
+  
+  Mat<eT> Q;
+  Mat<eT> R;
+  Mat<eT> Y;
+  Mat<eT> W;
+  
+  bool status;
+  
+  // initial basis: centred data times a random matrix
+  
+  W = randn< Mat<eT> >(n_cols, n_basis);
+  
+  Y = X * W;  Y.each_row() -= mu * W;
+  
+  status = qr_econ(Q, R, Y);
+  
+  if(status == false)  { return false; }
+  
+  for(uword iter=0; iter < trunc_n_power_iter; ++iter)
+    {
+    // Q <- orth( C * orth(trans(C) * Q) ), where C is the centred data
+    
+    W = trans(Q) * X;  W -= trans(sum(Q)) * mu;
+    
+    status = qr_econ(Q, R, trans(W));
+    
+    if(status == false)  { return false; }
+    
+    Y = X * Q;  Y.each_row() -= mu * Q;
+    
+    status = qr_econ(Q, R, Y);
+    
+    if(status == false)  { return false; }
+    }
+  
+  Y.reset();
+  
+  W = trans(Q) * X;  W -= trans(sum(Q)) * mu;
+  
+  Q.reset();
+  
+  Mat<eT> U;
+  Col<T>  s;
+  Mat<eT> V;
+  
+  status = svd_econ(U, s, V, W, 'r');
+  
+  if(status == false)  { return false; }
+  
+  coeff = V.cols(0,k-1);
+  
+  score = X * coeff;  score.each_row() -= mu * coeff;
+  
+  latent = square( s.rows(0,k-1) ) / T(n_rows - 1);
+  
+  coeff_out.steal_mem(coeff);
+  score_out.steal_mem(score);
+  latent_out.steal_mem(latent);
+  
+  return true;
+  }
+
+
+
 template<typename T1>
 inline
 void
@@ -0,0 +1,44 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup op_stft
+//! @{
+
+
+
+class op_stft
+  {
+  public:
+  
+  template<typename eT>
+  inline static void apply(Mat< std::complex<typename get_pod_type<eT>::result> >& out, const Mat<eT>& X, const Mat<typename get_pod_type<eT>::result>& win, const uword hop, const uword nfft);
+  
+  template<typename eT>
+  inline static void apply_frames(Mat< std::complex<typename get_pod_type<eT>::result> >& out, const fft_engine_pair<eT>& engine, const Mat<eT>& X, const Mat<typename get_pod_type<eT>::result>& win, const uword hop, const uword frame_start, const uword frame_end);
+  
+  inline static uword n_frames(const uword N, const uword L, const uword hop);
+  };
+
+
+
+class op_istft
+  {
+  public:
+  
+  template<typename T>
+  inline static void apply(Mat< std::complex<T> >& out, const Mat< std::complex<T> >& S, const Mat<T>& win, const uword hop, const uword N_user);
+  
+  template<typename T>
+  inline static void apply_frames(Mat< std::complex<T> >& Y, const fft_engine_pair< std::complex<T> >& engine, const Mat< std::complex<T> >& S, const Mat<T>& win, const uword frame_start, const uword frame_end);
+  };
+
+
+
+//! @}
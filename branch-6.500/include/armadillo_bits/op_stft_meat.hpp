@@ -0,0 +1,259 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup op_stft
+//! @{
+
+
+
+//! number of frames of length L, starting every hop samples, needed to cover a signal of length N;
+//! the last frame may extend beyond the end of the signal, in which case it is zero padded
+inline
+uword
+op_stft::n_frames(const uword N, const uword L, const uword hop)
+  {
+  if(N == 0)  { return 0; }
+  if(N <= L)  { return 1; }
+  
+  return 1 + (N - L + hop - 1) / hop;
+  }
+
+
+
+//! spectrogram of X: column k is the transform (of length nfft) of samples k*hop to k*hop + L - 1 of X, multiplied by the window of length L.
+//! if OpenMP is enabled, the frames are split between threads
+template<typename eT>
+inline
+void
+op_stft::apply(Mat< std::complex<typename get_pod_type<eT>::result> >& out, const Mat<eT>& X, const Mat<typename get_pod_type<eT>::result>& win, const uword hop, const uword nfft)
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_type_check(( is_supported_blas_type<eT>::value == false ));
+  
+  const uword L = win.n_elem;
+  const uword n = (nfft > 0) ? nfft : L;
+  
+  arma_debug_check( ((X.is_vec() == false) && (X.is_empty() == false)), "stft(): given signal must be a vector"                  );
+  arma_debug_check( ((win.is_vec() == false) || (L == 0)),              "stft(): given window must be a non-empty vector"        );
+  arma_debug_check( (hop == 0),                                         "stft(): hop must be greater than zero"                  );
+  arma_debug_check( (n < L),                                            "stft(): nfft must not be less than the window length"  );
+  
+  const uword n_frames = op_stft::n_frames(X.n_elem, L, hop);
+  
+  out.set_size(n, n_frames);
+  
+  if(n_frames == 0)  { return; }
+  
+  const fft_engine_pair<eT> engine(n);
+  
+  #if defined(_OPENMP)
+    {
+    const uword n_threads_max = uword( (std::max)(int(1), int(omp_get_max_threads())) );
+    const uword n_threads     = (out.n_elem >= 16384) ? (std::min)(n_frames, n_threads_max) : uword(1);
+    
+    if(n_threads > 1)
+      {
+      #pragma omp parallel for schedule(static)
+      for(uword t=0; t < n_threads; ++t)
+        {
+        const uword frame_start = (t     * n_frames) / n_threads;
+        const uword frame_end   = ((t+1) * n_frames) / n_threads;
+        
+        op_stft::apply_frames(out, engine, X, win, hop, frame_start, frame_end);
+        }
+      
+      return;
+      }
+    }
+  #endif
+  
+  op_stft::apply_frames(out, engine, X, win, hop, 0, n_frames);
+  }
+
+
+
+//! transforms of frames frame_start to (frame_end - 1); the buffers are allocated once per call, rather than once per frame
+template<typename eT>
+inline
+void
+op_stft::apply_frames(Mat< std::complex<typename get_pod_type<eT>::result> >& out, const fft_engine_pair<eT>& engine, const Mat<eT>& X, const Mat<typename get_pod_type<eT>::result>& win, const uword hop, const uword frame_start, const uword frame_end)
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef typename get_pod_type<eT>::result T;
+  typedef std::complex<T>                   cx_type;
+  
+  const uword n      = engine.N;
+  const uword n_spec = engine.n_spec;
+  const uword L      = win.n_elem;
+  const uword N      = X.n_elem;
+  
+  const eT* X_mem   = X.memptr();
+  const  T* win_mem = win.memptr();
+  
+  podarray<eT> frame( n );
+  podarray<T>  work ( engine.n_work() );
+  
+  eT* frame_mem = frame.memptr();
+  
+  arrayops::fill_zeros(frame_mem, n);
+  
+  for(uword k=frame_start; k < frame_end; ++k)
+    {
+    const uword start  = k*hop;
+    const uword n_copy = (start < N) ? (std::min)(L, N - start) : uword(0);
+    
+    for(uword i=0;      i < n_copy; ++i)  { frame_mem[i] = X_mem[start + i] * win_mem[i]; }
+    for(uword i=n_copy; i < L;      ++i)  { frame_mem[i] = eT(0); }
+    
+    cx_type* out_colptr = out.colptr(k);
+    
+    engine.forward(out_colptr, frame_mem, work.memptr());
+    
+    // for real signals only the first n_spec values are computed; the rest follows from conjugate symmetry
+    for(uword j=n_spec; j < n; ++j)  { out_colptr[j] = std::conj(out_colptr[n - j]); }
+    }
+  }
+
+
+
+//! inverse of op_stft::apply() via weighted overlap-add: each frame is inverse transformed, multiplied by the window and added to the output,
+//! which is then divided by the sum of the squared windows at each position.
+//! the result has N_user elements, or covers all frames if N_user is zero
+template<typename T>
+inline
+void
+op_istft::apply(Mat< std::complex<T> >& out, const Mat< std::complex<T> >& S, const Mat<T>& win, const uword hop, const uword N_user)
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef std::complex<T> cx_type;
+  
+  arma_type_check(( is_supported_blas_type<T>::value == false ));
+  
+  const uword L        = win.n_elem;
+  const uword n        = S.n_rows;
+  const uword n_frames = S.n_cols;
+  
+  arma_debug_check( ((win.is_vec() == false) || (L == 0)), "istft(): given window must be a non-empty vector"                          );
+  arma_debug_check( (hop == 0),                            "istft(): hop must be greater than zero"                                    );
+  arma_debug_check( ((n < L) && (n_frames > 0)),           "istft(): number of rows of spectrogram must not be less than window length" );
+  
+  const uword N = (N_user > 0) ? N_user : ( (n_frames > 0) ? ((n_frames-1)*hop + L) : uword(0) );
+  
+  out.zeros(N, 1);
+  
+  if( (N == 0) || (n_frames == 0) )  { return; }
+  
+  Mat<cx_type> Y(L, n_frames);  // windowed frames
+  
+  const fft_engine_pair<cx_type> engine(n);
+  
+  bool done = false;
+  
+  #if defined(_OPENMP)
+    {
+    const uword n_threads_max = uword( (std::max)(int(1), int(omp_get_max_threads())) );
+    const uword n_threads     = (S.n_elem >= 16384) ? (std::min)(n_frames, n_threads_max) : uword(1);
+    
+    if(n_threads > 1)
+      {
+      #pragma omp parallel for schedule(static)
+      for(uword t=0; t < n_threads; ++t)
+        {
+        const uword frame_start = (t     * n_frames) / n_threads;
+        const uword frame_end   = ((t+1) * n_frames) / n_threads;
+        
+        op_istft::apply_frames(Y, engine, S, win, frame_start, frame_end);
+        }
+      
+      done = true;
+      }
+    }
+  #endif
+  
+  if(done == false)  { op_istft::apply_frames(Y, engine, S, win, 0, n_frames); }
+  
+  // overlap-add
+  
+  podarray<T> den(N);
+  
+  arrayops::fill_zeros(den.memptr(), N);
+  
+  const T* win_mem = win.memptr();
+  
+  cx_type* out_mem = out.memptr();
+        T* den_mem = den.memptr();
+  
+  for(uword k=0; k < n_frames; ++k)
+    {
+    const uword start = k*hop;
+    
+    if(start >= N)  { break; }
+    
+    const uword n_add = (std::min)(L, N - start);
+    
+    const cx_type* Y_colptr = Y.colptr(k);
+    
+    for(uword i=0; i < n_add; ++i)
+      {
+      out_mem[start + i] += Y_colptr[i];
+      den_mem[start + i] += win_mem[i] * win_mem[i];
+      }
+    }
+  
+  // positions not covered by any non-zero part of the windows are set to zero
+  
+  const T den_min = T(1e-10) * win.max() * win.max();
+  
+  for(uword i=0; i < N; ++i)
+    {
+    out_mem[i] = (den_mem[i] > den_min) ? (out_mem[i] / den_mem[i]) : cx_type(0);
+    }
+  }
+
+
+
+template<typename T>
+inline
+void
+op_istft::apply_frames(Mat< std::complex<T> >& Y, const fft_engine_pair< std::complex<T> >& engine, const Mat< std::complex<T> >& S, const Mat<T>& win, const uword frame_start, const uword frame_end)
+  {
+  arma_extra_debug_sigprint();
+  
+  typedef std::complex<T> cx_type;
+  
+  const uword n = engine.N;
+  const uword L = win.n_elem;
+  
+  const T* win_mem = win.memptr();
+  
+  // the inverse transform is not scaled
+  const T scale = T(1) / T(n);
+  
+  podarray<cx_type> y   ( n );
+  podarray<T>       work( engine.n_work() );
+  
+  cx_type* y_mem = y.memptr();
+  
+  for(uword k=frame_start; k < frame_end; ++k)
+    {
+    engine.inverse(y_mem, S.colptr(k), work.memptr());
+    
+    cx_type* Y_colptr = Y.colptr(k);
+    
+    for(uword i=0; i < L; ++i)  { Y_colptr[i] = y_mem[i] * (win_mem[i] * scale); }
+    }
+  }
+
+
+
+//! @}
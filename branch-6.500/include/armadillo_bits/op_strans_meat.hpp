@@ -114,6 +114,11 @@ op_strans::apply_mat_noalias(Mat<eT>& out, const TA& A)
       {
       op_strans::apply_mat_noalias_tinysq(out, A);
       }
+    else
+    if( (A_n_rows >= 512) && (A_n_cols >= 512) )
+      {
+      op_strans::apply_mat_noalias_large(out, A);
+      }
     else
       {
       eT* outptr = out.memptr();
@@ -143,6 +148,58 @@ op_strans::apply_mat_noalias(Mat<eT>& out, const TA& A)
 
 
 
+//! transpose of a large matrix, done in square blocks so that the rows and columns of each block stay in cache
+template<typename eT>
+arma_hot
+inline
+void
+op_strans::apply_mat_noalias_large(Mat<eT>& out, const Mat<eT>& A)
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword A_n_rows = A.n_rows;
+  const uword A_n_cols = A.n_cols;
+  
+  const uword block_size = 64;
+  
+  const eT* X = A.memptr();
+        eT* Y = out.memptr();
+  
+  for(uword row=0; row < A_n_rows; row += block_size)
+    {
+    const uword n_rows = (std::min)(block_size, A_n_rows - row);
+    
+    for(uword col=0; col < A_n_cols; col += block_size)
+      {
+      const uword n_cols = (std::min)(block_size, A_n_cols - col);
+      
+      op_strans::block_worker( &Y[col + row*A_n_cols], &X[row + col*A_n_rows], A_n_rows, A_n_cols, n_rows, n_cols );
+      }
+    }
+  }
+
+
+
+//! transpose the block of X with n_rows rows and n_cols columns into Y
+template<typename eT>
+arma_hot
+inline
+void
+op_strans::block_worker(eT* Y, const eT* X, const uword X_n_rows, const uword Y_n_rows, const uword n_rows, const uword n_cols)
+  {
+  for(uword row=0; row < n_rows; ++row)
+    {
+    eT* Y_col = &Y[row*Y_n_rows];
+    
+    for(uword col=0; col < n_cols; ++col)
+      {
+      Y_col[col] = X[row + col*X_n_rows];
+      }
+    }
+  }
+
+
+
 template<typename eT>
 arma_hot
 inline
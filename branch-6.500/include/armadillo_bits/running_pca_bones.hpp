@@ -0,0 +1,58 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup running_pca
+//! @{
+
+
+
+//! Class for incremental principal component analysis of data arriving in batches,
+//! without storing the individual samples.  Each row of a batch is a sample (as for princomp()).
+//! Only the mean and the first k principal components are kept (Ross et al, 2008):
+//! for each batch, the singular value decomposition is done on the stacked matrix
+//! [ diagmat(s)*trans(coeff); centred batch; sqrt(n*m/(n+m))*(old mean - batch mean) ],
+//! where s are the singular values so far, n is the number of samples so far and m is the number of samples in the batch.
+//! The result is exact if the data has rank k or less, and is an approximation otherwise.
+template<typename eT>
+class running_pca
+  {
+  public:
+  
+  typedef eT                                elem_type;
+  typedef typename get_pod_type<eT>::result pod_type;
+  
+  const uword k;
+  
+  inline ~running_pca();
+  inline explicit running_pca(const uword in_k);
+  
+  template<typename T1> inline void operator() (const Base<eT,T1>& X);
+  
+  inline void reset();
+  
+  inline const Mat<eT>&       coeff()  const;
+  inline       Col<pod_type>  latent() const;
+  inline const Row<eT>&       mean()   const;
+  
+  inline uword count() const;
+  
+  
+  private:
+  
+  arma_aligned Mat<eT>       V;   //!< principal component coefficients so far
+  arma_aligned Col<pod_type> s;   //!< singular values of the centred data so far
+  arma_aligned Row<eT>       mu;  //!< mean so far
+  
+  uword n;  //!< number of samples so far
+  };
+
+
+
+//! @}
@@ -0,0 +1,176 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup running_pca
+//! @{
+
+
+
+template<typename eT>
+inline
+running_pca<eT>::~running_pca()
+  {
+  arma_extra_debug_sigprint_this(this);
+  }
+
+
+
+template<typename eT>
+inline
+running_pca<eT>::running_pca(const uword in_k)
+  : k(in_k)
+  , n(0   )
+  {
+  arma_extra_debug_sigprint_this(this);
+  
+  arma_type_check(( is_supported_blas_type<eT>::value == false ));
+  
+  arma_debug_check( (k == 0), "running_pca(): k must be greater than zero" );
+  }
+
+
+
+//! update the principal components to reflect a new batch of samples (one sample per row)
+template<typename eT>
+template<typename T1>
+inline
+void
+running_pca<eT>::operator() (const Base<eT,T1>& X)
+  {
+  arma_extra_debug_sigprint();
+  
+  const quasi_unwrap<T1> tmp(X.get_ref());
+  const Mat<eT>& A     = tmp.M;
+  
+  const uword m = A.n_rows;
+  
+  if(m == 0)  { return; }
+  
+  arma_debug_check( ((n > 0) && (A.n_cols != mu.n_elem)), "running_pca(): dimensionality mismatch" );
+  
+  const Row<eT> batch_mu = arma::mean(A, 0);
+  
+  Mat<eT> M;
+  
+  if(n == 0)
+    {
+    M = A;  M.each_row() -= batch_mu;
+    
+    mu = batch_mu;
+    }
+  else
+    {
+    const pod_type n_old = pod_type(n);
+    const pod_type n_new = pod_type(n + m);
+    
+    const uword r = V.n_cols;
+    
+    M.set_size(r + m + 1, A.n_cols);
+    
+    M.rows(0, r-1)   = diagmat(s) * trans(V);
+    M.rows(r, r+m-1) = A;
+    M.row(r+m)       = std::sqrt(n_old * pod_type(m) / n_new) * (mu - batch_mu);
+    
+    M.rows(r, r+m-1).each_row() -= batch_mu;
+    
+    mu += (batch_mu - mu) * (pod_type(m) / n_new);
+    }
+  
+  n += m;
+  
+  Mat<eT>       U;
+  Col<pod_type> new_s;
+  Mat<eT>       new_V;
+  
+  const bool status = svd_econ(U, new_s, new_V, M, 'r');
+  
+  if(status == false)
+    {
+    arma_debug_warn("running_pca: batch ignored as the decomposition failed");
+    
+    n -= m;
+    
+    if(n == 0)  { (*this).reset(); }
+    
+    return;
+    }
+  
+  const uword n_keep = (std::min)(k, new_s.n_elem);
+  
+  V = new_V.cols(0, n_keep-1);
+  s = new_s.rows(0, n_keep-1);
+  }
+
+
+
+//! forget all samples
+template<typename eT>
+inline
+void
+running_pca<eT>::reset()
+  {
+  arma_extra_debug_sigprint();
+  
+  V.reset();
+  s.reset();
+  mu.reset();
+  
+  n = 0;
+  }
+
+
+
+//! principal component coefficients (one component per column);
+//! there are fewer than k columns if fewer than k samples or dimensions have been seen so far
+template<typename eT>
+inline
+const Mat<eT>&
+running_pca<eT>::coeff() const
+  {
+  return V;
+  }
+
+
+
+//! eigenvalues of the principal vectors
+template<typename eT>
+inline
+Col<typename running_pca<eT>::pod_type>
+running_pca<eT>::latent() const
+  {
+  arma_extra_debug_sigprint();
+  
+  return (n > 1) ? Col<pod_type>( square(s) / pod_type(n-1) ) : Col<pod_type>(s.n_elem, fill::zeros);
+  }
+
+
+
+template<typename eT>
+inline
+const Row<eT>&
+running_pca<eT>::mean() const
+  {
+  return mu;
+  }
+
+
+
+//! number of samples so far
+template<typename eT>
+inline
+uword
+running_pca<eT>::count() const
+  {
+  return n;
+  }
+
+
+
+//! @}
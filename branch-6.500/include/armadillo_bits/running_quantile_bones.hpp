@@ -0,0 +1,82 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup running_quantile
+//! @{
+
+
+
+//! Class for estimating the quantiles of a continuously sampled process / signal,
+//! without storing the individual samples.
+//! The samples are summarised by a merging t-digest (Dunning and Ertl), ie. a sorted list of weighted centroids,
+//! where the number of samples per centroid is limited via the scale function k(q) = (compression/(2*pi)) * asin(2q-1):
+//! each centroid covers at most one unit of k.  The centroids near the extremes hold few samples,
+//! so that the tails are estimated more accurately than the middle.
+//! The number of centroids is less than compression (typically about 0.6*compression), and two digests can be merged.
+template<typename eT>
+class running_quantile
+  {
+  public:
+  
+  typedef eT elem_type;
+  
+  const uword compression;
+  
+  inline ~running_quantile();
+  inline explicit running_quantile(const uword in_compression = 100);
+  
+  inline running_quantile(const running_quantile& in_rq);
+  
+  inline const running_quantile& operator=(const running_quantile& in_rq);
+  
+  inline void operator() (const eT sample);
+  
+  template<typename T1> inline void operator() (const Base<eT,T1>& X);
+  
+  inline void merge(const running_quantile& in);
+  
+  inline void reset();
+  
+  inline eT quantile(const eT P);
+  
+  template<typename T1> inline Mat<eT> quantile(const Base<eT,T1>& P);
+  
+  inline eT median();
+  
+  inline eT min() const;
+  inline eT max() const;
+  
+  inline eT count() const;
+  
+  //
+  //
+  
+  private:
+  
+  arma_aligned Col<eT> c_mean;    //!< means of the centroids, in ascending order
+  arma_aligned Col<eT> c_weight;  //!< number of samples in each centroid
+  
+  arma_aligned Col<eT> b_mean;    //!< samples (or centroids from merge()) not yet included in the centroids
+  arma_aligned Col<eT> b_weight;
+  
+  uword b_n;  //!< number of used elements in the buffer
+  
+  arma_aligned eT total_weight;
+  arma_aligned eT min_val;
+  arma_aligned eT max_val;
+  
+  inline void add(const eT val, const eT weight);
+  
+  inline void compress();
+  };
+
+
+
+//! @}
@@ -0,0 +1,426 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup running_quantile
+//! @{
+
+
+
+template<typename eT>
+inline
+running_quantile<eT>::~running_quantile()
+  {
+  arma_extra_debug_sigprint_this(this);
+  }
+
+
+
+template<typename eT>
+inline
+running_quantile<eT>::running_quantile(const uword in_compression)
+  : compression (in_compression)
+  , b_n         (0    )
+  , total_weight(eT(0))
+  , min_val     (eT(0))
+  , max_val     (eT(0))
+  {
+  arma_extra_debug_sigprint_this(this);
+  
+  arma_type_check(( is_real<eT>::value == false ));
+  
+  arma_debug_check( (compression == 0), "running_quantile(): compression must be greater than zero" );
+  
+  const uword b_n_alloc = (std::max)( uword(5*compression), uword(32) );
+  
+  b_mean.set_size(b_n_alloc);
+  b_weight.set_size(b_n_alloc);
+  }
+
+
+
+template<typename eT>
+inline
+running_quantile<eT>::running_quantile(const running_quantile<eT>& in_rq)
+  : compression (in_rq.compression )
+  , c_mean      (in_rq.c_mean      )
+  , c_weight    (in_rq.c_weight    )
+  , b_mean      (in_rq.b_mean      )
+  , b_weight    (in_rq.b_weight    )
+  , b_n         (in_rq.b_n         )
+  , total_weight(in_rq.total_weight)
+  , min_val     (in_rq.min_val     )
+  , max_val     (in_rq.max_val     )
+  {
+  arma_extra_debug_sigprint_this(this);
+  }
+
+
+
+template<typename eT>
+inline
+const running_quantile<eT>&
+running_quantile<eT>::operator=(const running_quantile<eT>& in_rq)
+  {
+  arma_extra_debug_sigprint();
+  
+  access::rw(compression) = in_rq.compression;
+  
+  c_mean       = in_rq.c_mean;
+  c_weight     = in_rq.c_weight;
+  b_mean       = in_rq.b_mean;
+  b_weight     = in_rq.b_weight;
+  b_n          = in_rq.b_n;
+  total_weight = in_rq.total_weight;
+  min_val      = in_rq.min_val;
+  max_val      = in_rq.max_val;
+  
+  return *this;
+  }
+
+
+
+//! update the digest to reflect new sample
+template<typename eT>
+inline
+void
+running_quantile<eT>::operator() (const eT sample)
+  {
+  if( arma_isfinite(sample) == false )
+    {
+    arma_debug_warn("running_quantile: sample ignored as it is non-finite" );
+    return;
+    }
+  
+  if(total_weight > eT(0))
+    {
+    if(sample < min_val)  { min_val = sample; }
+    if(sample > max_val)  { max_val = sample; }
+    }
+  else
+    {
+    min_val = sample;
+    max_val = sample;
+    }
+  
+  (*this).add(sample, eT(1));
+  }
+
+
+
+//! update the digest to reflect all elements of X, each taken as a new sample
+template<typename eT>
+template<typename T1>
+inline
+void
+running_quantile<eT>::operator() (const Base<eT,T1>& X)
+  {
+  arma_extra_debug_sigprint();
+  
+  const quasi_unwrap<T1> tmp(X.get_ref());
+  
+  const eT*   X_mem    = tmp.M.memptr();
+  const uword X_n_elem = tmp.M.n_elem;
+  
+  for(uword i=0; i < X_n_elem; ++i)  { (*this).operator()(X_mem[i]); }
+  }
+
+
+
+//! combine the digest of another running_quantile object with the digest so far
+template<typename eT>
+inline
+void
+running_quantile<eT>::merge(const running_quantile<eT>& in)
+  {
+  arma_extra_debug_sigprint();
+  
+  if(in.total_weight == eT(0))  { return; }
+  
+  if(this == &in)
+    {
+    const running_quantile<eT> tmp(in);
+    
+    (*this).merge(tmp);
+    
+    return;
+    }
+  
+  if(total_weight > eT(0))
+    {
+    if(in.min_val < min_val)  { min_val = in.min_val; }
+    if(in.max_val > max_val)  { max_val = in.max_val; }
+    }
+  else
+    {
+    min_val = in.min_val;
+    max_val = in.max_val;
+    }
+  
+  for(uword i=0; i < in.c_mean.n_elem; ++i)  { (*this).add(in.c_mean[i], in.c_weight[i]); }
+  for(uword i=0; i < in.b_n;           ++i)  { (*this).add(in.b_mean[i], in.b_weight[i]); }
+  }
+
+
+
+//! forget all samples
+template<typename eT>
+inline
+void
+running_quantile<eT>::reset()
+  {
+  arma_extra_debug_sigprint();
+  
+  c_mean.reset();
+  c_weight.reset();
+  
+  b_n = 0;
+  
+  total_weight = eT(0);
+  min_val      = eT(0);
+  max_val      = eT(0);
+  }
+
+
+
+//! estimate of the quantile for probability P;
+//! the estimate is found by linear interpolation between the centroids, placed at the middle of the samples they hold,
+//! with the smallest and largest samples placed at the ends.
+//! while each centroid holds one sample, this gives the same result as quantile(X,P) applied to all samples
+template<typename eT>
+inline
+eT
+running_quantile<eT>::quantile(const eT P)
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_debug_check( ((P < eT(0)) || (P > eT(1))), "running_quantile::quantile(): P must be in the [0,1] interval" );
+  
+  (*this).compress();
+  
+  const uword n_centroids = c_mean.n_elem;
+  
+  if(n_centroids == 0)  { return eT(0); }
+  
+  const eT* c_mean_mem   = c_mean.memptr();
+  const eT* c_weight_mem = c_weight.memptr();
+  
+  const eT pos = P * total_weight;
+  
+  eT prev_pos = eT(0);
+  eT prev_val = min_val;
+  eT acc      = eT(0);
+  
+  for(uword i=0; i < n_centroids; ++i)
+    {
+    const eT centre_pos = acc + eT(0.5)*c_weight_mem[i];
+    
+    if(pos <= centre_pos)
+      {
+      const eT frac = (centre_pos > prev_pos) ? ((pos - prev_pos) / (centre_pos - prev_pos)) : eT(1);
+      
+      return prev_val + frac*(c_mean_mem[i] - prev_val);
+      }
+    
+    prev_pos = centre_pos;
+    prev_val = c_mean_mem[i];
+    
+    acc += c_weight_mem[i];
+    }
+  
+  const eT frac = (total_weight > prev_pos) ? ((pos - prev_pos) / (total_weight - prev_pos)) : eT(1);
+  
+  return prev_val + frac*(max_val - prev_val);
+  }
+
+
+
+//! estimates of the quantiles for the probabilities in P
+template<typename eT>
+template<typename T1>
+inline
+Mat<eT>
+running_quantile<eT>::quantile(const Base<eT,T1>& P)
+  {
+  arma_extra_debug_sigprint();
+  
+  const quasi_unwrap<T1> tmp(P.get_ref());
+  
+  const Mat<eT>& PP = tmp.M;
+  
+  Mat<eT> out(PP.n_rows, PP.n_cols);
+  
+  const eT*   PP_mem    = PP.memptr();
+        eT*   out_mem   = out.memptr();
+  const uword PP_n_elem = PP.n_elem;
+  
+  for(uword i=0; i < PP_n_elem; ++i)  { out_mem[i] = (*this).quantile(PP_mem[i]); }
+  
+  return out;
+  }
+
+
+
+template<typename eT>
+inline
+eT
+running_quantile<eT>::median()
+  {
+  arma_extra_debug_sigprint();
+  
+  return (*this).quantile(eT(0.5));
+  }
+
+
+
+//! minimum value
+template<typename eT>
+inline
+eT
+running_quantile<eT>::min() const
+  {
+  arma_extra_debug_sigprint();
+  
+  return min_val;
+  }
+
+
+
+//! maximum value
+template<typename eT>
+inline
+eT
+running_quantile<eT>::max() const
+  {
+  arma_extra_debug_sigprint();
+  
+  return max_val;
+  }
+
+
+
+//! number of samples so far
+template<typename eT>
+inline
+eT
+running_quantile<eT>::count() const
+  {
+  arma_extra_debug_sigprint();
+  
+  return total_weight;
+  }
+
+
+
+template<typename eT>
+inline
+void
+running_quantile<eT>::add(const eT val, const eT weight)
+  {
+  if(b_n >= b_mean.n_elem)  { (*this).compress(); }
+  
+  b_mean[b_n]   = val;
+  b_weight[b_n] = weight;
+  
+  ++b_n;
+  
+  total_weight += weight;
+  }
+
+
+
+//! merge the buffer with the centroids: the buffer is sorted and merged with the (already sorted) centroids,
+//! then neighbouring items are combined as long as the combined centroid covers at most one unit of k(q)
+template<typename eT>
+inline
+void
+running_quantile<eT>::compress()
+  {
+  arma_extra_debug_sigprint();
+  
+  if(b_n == 0)  { return; }
+  
+  const uvec b_order = sort_index( b_mean.head(b_n) );
+  
+  const uword n_old = c_mean.n_elem;
+  const uword n_all = n_old + b_n;
+  
+  Col<eT> new_mean(n_all);
+  Col<eT> new_weight(n_all);
+  
+  const eT* c_mean_mem   = c_mean.memptr();
+  const eT* c_weight_mem = c_weight.memptr();
+  const eT* b_mean_mem   = b_mean.memptr();
+  const eT* b_weight_mem = b_weight.memptr();
+  
+  eT* new_mean_mem   = new_mean.memptr();
+  eT* new_weight_mem = new_weight.memptr();
+  
+  const eT W       = total_weight;
+  const eT k_scale = eT(compression) / (eT(2) * Datum<eT>::pi);
+  
+  uword i     = 0;  // next old centroid
+  uword j     = 0;  // next buffer element
+  uword n_new = 0;
+  
+  eT w_before = eT(0);  // weight of the finished centroids
+  eT w_limit  = eT(0);  // largest weight at the end of the current centroid
+  
+  for(uword count=0; count < n_all; ++count)
+    {
+    eT val;
+    eT weight;
+    
+    if( (j >= b_n) || ((i < n_old) && (c_mean_mem[i] <= b_mean_mem[ b_order[j] ])) )
+      {
+      val    = c_mean_mem[i];
+      weight = c_weight_mem[i];
+      ++i;
+      }
+    else
+      {
+      val    = b_mean_mem[ b_order[j] ];
+      weight = b_weight_mem[ b_order[j] ];
+      ++j;
+      }
+    
+    if( (n_new > 0) && ((w_before + new_weight_mem[n_new-1] + weight) <= w_limit) )
+      {
+      eT& cur_mean   = new_mean_mem[n_new-1];
+      eT& cur_weight = new_weight_mem[n_new-1];
+      
+      cur_weight += weight;
+      cur_mean   += (val - cur_mean) * (weight / cur_weight);
+      }
+    else
+      {
+      if(n_new > 0)  { w_before += new_weight_mem[n_new-1]; }
+      
+      // k_inv(k(q) + 1), with q = w_before/W
+      
+      const eT k_next = std::asin( (std::min)( eT(1), eT(2)*(w_before/W) - eT(1) ) ) + eT(1)/k_scale;
+      
+      w_limit = (k_next >= (Datum<eT>::pi/eT(2))) ? W : W * (std::sin(k_next) + eT(1)) / eT(2);
+      
+      new_mean_mem[n_new]   = val;
+      new_weight_mem[n_new] = weight;
+      
+      ++n_new;
+      }
+    }
+  
+  c_mean   = new_mean.head(n_new);
+  c_weight = new_weight.head(n_new);
+  
+  b_n = 0;
+  }
+
+
+
+//! @}
@@ -24,6 +24,10 @@ class arma_counter
   inline const arma_counter& operator++();
   inline void                operator++(int);
   
+  inline void add(const uword n);
+  inline void add(const arma_counter& x);
+  inline void add_weight(const eT w);
+  
   inline void reset();
   inline eT   value()         const;
   inline eT   value_plus_1()  const;
@@ -56,6 +60,11 @@ class running_stat
   inline void operator() (const T sample);
   inline void operator() (const std::complex<T>& sample);
   
+  template<typename T1> inline void operator() (const Base<              T, T1>& X);
+  template<typename T1> inline void operator() (const Base<std::complex<T>, T1>& X);
+  
+  inline void merge(const running_stat& in);
+  
   inline void reset();
   
   inline eT mean() const;
@@ -105,6 +114,28 @@ class running_stat_aux
   
   template<typename eT>
   inline static void update_stats(running_stat<eT>& x, const eT& sample, const typename arma_cx_only<eT>::result* junk = 0);
+  
+  //
+  
+  template<typename eT>
+  inline static void update_stats_batch(running_stat<eT>& x, const Mat<eT>& X, const typename arma_not_cx<eT>::result* junk = 0);
+  
+  template<typename eT>
+  inline static void update_stats_batch(running_stat<eT>& x, const Mat< std::complex<eT> >& X, const typename arma_not_cx<eT>::result* junk = 0);
+  
+  template<typename eT>
+  inline static void update_stats_batch(running_stat<eT>& x, const Mat<typename eT::value_type>& X, const typename arma_cx_only<eT>::result* junk = 0);
+  
+  template<typename eT>
+  inline static void update_stats_batch(running_stat<eT>& x, const Mat<eT>& X, const typename arma_cx_only<eT>::result* junk = 0);
+  
+  //
+  
+  template<typename eT>
+  inline static void merge_stats(running_stat<eT>& x, const running_stat<eT>& y, const typename arma_not_cx<eT>::result* junk = 0);
+  
+  template<typename eT>
+  inline static void merge_stats(running_stat<eT>& x, const running_stat<eT>& y, const typename arma_cx_only<eT>::result* junk = 0);
   };
 
 
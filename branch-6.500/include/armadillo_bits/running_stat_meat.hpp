@@ -63,6 +63,52 @@ arma_counter<eT>::operator++(int)
 
 
 
+//! add n to the count
+template<typename eT>
+inline
+void
+arma_counter<eT>::add(const uword n)
+  {
+  if(n <= (ARMA_MAX_UWORD - i_count))
+    {
+    i_count += n;
+    }
+  else
+    {
+    d_count += eT(ARMA_MAX_UWORD);
+    i_count  = n - (ARMA_MAX_UWORD - i_count);
+    }
+  }
+
+
+
+//! add the count of another counter
+template<typename eT>
+inline
+void
+arma_counter<eT>::add(const arma_counter<eT>& x)
+  {
+  const eT    x_d_count = x.d_count;
+  const uword x_i_count = x.i_count;
+  
+  d_count += x_d_count;
+  
+  (*this).add(x_i_count);
+  }
+
+
+
+//! add a weight to the count; the weight may be fractional
+template<typename eT>
+inline
+void
+arma_counter<eT>::add_weight(const eT w)
+  {
+  d_count += w;
+  }
+
+
+
 template<typename eT>
 inline
 void
@@ -184,6 +230,80 @@ running_stat<eT>::operator() (const std::complex< typename running_stat<eT>::T >
 
 
 
+//! update statistics to reflect all elements of X, each taken as a new sample
+template<typename eT>
+template<typename T1>
+inline
+void
+running_stat<eT>::operator() (const Base<typename running_stat<eT>::T, T1>& X)
+  {
+  arma_extra_debug_sigprint();
+  
+  const quasi_unwrap<T1> tmp(X.get_ref());
+  const Mat<T>& A = tmp.M;
+  
+  if(A.is_empty())  { return; }
+  
+  if(A.is_finite() == false)
+    {
+    // process the samples one by one, so that only the non-finite samples are ignored
+    
+    const T*    A_mem    = A.memptr();
+    const uword A_n_elem = A.n_elem;
+    
+    for(uword i=0; i < A_n_elem; ++i)  { (*this).operator()(A_mem[i]); }
+    
+    return;
+    }
+  
+  running_stat_aux::update_stats_batch(*this, A);
+  }
+
+
+
+//! update statistics to reflect all elements of X, each taken as a new sample (version for complex numbers)
+template<typename eT>
+template<typename T1>
+inline
+void
+running_stat<eT>::operator() (const Base<std::complex<typename running_stat<eT>::T>, T1>& X)
+  {
+  arma_extra_debug_sigprint();
+  
+  const quasi_unwrap<T1> tmp(X.get_ref());
+  const Mat< std::complex<T> >& A = tmp.M;
+  
+  if(A.is_empty())  { return; }
+  
+  if(A.is_finite() == false)
+    {
+    const std::complex<T>* A_mem    = A.memptr();
+    const uword            A_n_elem = A.n_elem;
+    
+    for(uword i=0; i < A_n_elem; ++i)  { (*this).operator()(A_mem[i]); }
+    
+    return;
+    }
+  
+  running_stat_aux::update_stats_batch(*this, A);
+  }
+
+
+
+//! combine the statistics of another running_stat object with the statistics so far,
+//! giving the same result as if the samples of both objects were processed by this object
+template<typename eT>
+inline
+void
+running_stat<eT>::merge(const running_stat<eT>& in)
+  {
+  arma_extra_debug_sigprint();
+  
+  running_stat_aux::merge_stats(*this, in);
+  }
+
+
+
 //! set all statistics to zero
 template<typename eT>
 inline
@@ -440,4 +560,222 @@ running_stat_aux::update_stats(running_stat<eT>& x, const eT& sample, const type
 
 
 
+
+//! update statistics to reflect a batch of samples (version for non-complex numbers, non-complex samples)
+template<typename eT>
+inline
+void
+running_stat_aux::update_stats_batch(running_stat<eT>& x, const Mat<eT>& X, const typename arma_not_cx<eT>::result* junk)
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  typedef typename running_stat<eT>::T T;
+  
+  const uword n_elem = X.n_elem;
+  const eT*   X_mem  = X.memptr();
+  
+  // the statistics of the batch are found via two passes,
+  // and then combined with the statistics so far
+  
+  running_stat<eT> B;
+  
+  eT acc     = eT(0);
+  eT min_val = X_mem[0];
+  eT max_val = X_mem[0];
+  
+  for(uword i=0; i < n_elem; ++i)
+    {
+    const eT val = X_mem[i];
+    
+    acc += val;
+    
+    if(val < min_val)  { min_val = val; }
+    if(val > max_val)  { max_val = val; }
+    }
+  
+  const eT mean_val = acc / T(n_elem);
+  
+  T acc2 = T(0);
+  
+  for(uword i=0; i < n_elem; ++i)
+    {
+    const eT tmp = X_mem[i] - mean_val;
+    
+    acc2 += tmp*tmp;
+    }
+  
+  B.counter.add(n_elem);
+  
+  B.r_mean  = mean_val;
+  B.r_var   = (n_elem > 1) ? T(acc2 / T(n_elem - 1)) : T(0);
+  B.min_val = min_val;
+  B.max_val = max_val;
+  
+  running_stat_aux::merge_stats(x, B);
+  }
+
+
+
+//! update statistics to reflect a batch of samples (version for non-complex numbers, complex samples)
+template<typename eT>
+inline
+void
+running_stat_aux::update_stats_batch(running_stat<eT>& x, const Mat< std::complex<eT> >& X, const typename arma_not_cx<eT>::result* junk)
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  running_stat_aux::update_stats_batch(x, conv_to< Mat<eT> >::from(X));
+  }
+
+
+
+//! update statistics to reflect a batch of samples (version for complex numbers, non-complex samples)
+template<typename eT>
+inline
+void
+running_stat_aux::update_stats_batch(running_stat<eT>& x, const Mat<typename eT::value_type>& X, const typename arma_cx_only<eT>::result* junk)
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  running_stat_aux::update_stats_batch(x, conv_to< Mat<eT> >::from(X));
+  }
+
+
+
+//! update statistics to reflect a batch of samples (version for complex numbers, complex samples)
+template<typename eT>
+inline
+void
+running_stat_aux::update_stats_batch(running_stat<eT>& x, const Mat<eT>& X, const typename arma_cx_only<eT>::result* junk)
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  typedef typename eT::value_type T;
+  
+  const uword n_elem = X.n_elem;
+  const eT*   X_mem  = X.memptr();
+  
+  running_stat<eT> B;
+  
+  eT acc          = eT(0);
+  eT min_val      = X_mem[0];
+  eT max_val      = X_mem[0];
+  T  min_val_norm = std::norm(X_mem[0]);
+  T  max_val_norm = min_val_norm;
+  
+  for(uword i=0; i < n_elem; ++i)
+    {
+    const eT& val      = X_mem[i];
+    const T   val_norm = std::norm(val);
+    
+    acc += val;
+    
+    if(val_norm < min_val_norm)  { min_val_norm = val_norm; min_val = val; }
+    if(val_norm > max_val_norm)  { max_val_norm = val_norm; max_val = val; }
+    }
+  
+  const eT mean_val = acc / T(n_elem);
+  
+  T acc2 = T(0);
+  
+  for(uword i=0; i < n_elem; ++i)  { acc2 += std::norm(X_mem[i] - mean_val); }
+  
+  B.counter.add(n_elem);
+  
+  B.r_mean       = mean_val;
+  B.r_var        = (n_elem > 1) ? T(acc2 / T(n_elem - 1)) : T(0);
+  B.min_val      = min_val;
+  B.max_val      = max_val;
+  B.min_val_norm = min_val_norm;
+  B.max_val_norm = max_val_norm;
+  
+  running_stat_aux::merge_stats(x, B);
+  }
+
+
+
+//! combine the statistics of y with the statistics of x (version for non-complex numbers);
+//! the variances are combined via the pairwise formula of Chan, Golub and LeVeque:
+//! M2 = M2_x + M2_y + delta^2 * N_x*N_y/N, where M2 is the sum of squared differences from the mean
+template<typename eT>
+inline
+void
+running_stat_aux::merge_stats(running_stat<eT>& x, const running_stat<eT>& y, const typename arma_not_cx<eT>::result* junk)
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  typedef typename running_stat<eT>::T T;
+  
+  const T N_x = x.counter.value();
+  const T N_y = y.counter.value();
+  
+  if(N_y == T(0))  { return; }
+  
+  if(N_x == T(0))  { x = y; return; }
+  
+  const T N = N_x + N_y;
+  
+  const eT delta = y.r_mean - x.r_mean;
+  
+  const T M2 = (N_x - T(1))*x.r_var + (N_y - T(1))*y.r_var + (delta*delta) * ((N_x/N) * N_y);
+  
+  x.r_var  = M2 / (N - T(1));
+  x.r_mean = x.r_mean + delta * (N_y/N);
+  
+  if(y.min_val < x.min_val)  { x.min_val = y.min_val; }
+  if(y.max_val > x.max_val)  { x.max_val = y.max_val; }
+  
+  x.counter.add(y.counter);
+  }
+
+
+
+//! combine the statistics of y with the statistics of x (version for complex numbers)
+template<typename eT>
+inline
+void
+running_stat_aux::merge_stats(running_stat<eT>& x, const running_stat<eT>& y, const typename arma_cx_only<eT>::result* junk)
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  typedef typename eT::value_type T;
+  
+  const T N_x = x.counter.value();
+  const T N_y = y.counter.value();
+  
+  if(N_y == T(0))  { return; }
+  
+  if(N_x == T(0))  { x = y; return; }
+  
+  const T N = N_x + N_y;
+  
+  const eT delta = y.r_mean - x.r_mean;
+  
+  const T M2 = (N_x - T(1))*x.r_var + (N_y - T(1))*y.r_var + std::norm(delta) * ((N_x/N) * N_y);
+  
+  x.r_var  = M2 / (N - T(1));
+  x.r_mean = x.r_mean + delta * (N_y/N);
+  
+  if(y.min_val_norm < x.min_val_norm)
+    {
+    x.min_val_norm = y.min_val_norm;
+    x.min_val      = y.min_val;
+    }
+  
+  if(y.max_val_norm > x.max_val_norm)
+    {
+    x.max_val_norm = y.max_val_norm;
+    x.max_val      = y.max_val;
+    }
+  
+  x.counter.add(y.counter);
+  }
+
+
 //! @}
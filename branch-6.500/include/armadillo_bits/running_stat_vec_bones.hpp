@@ -41,6 +41,11 @@ class running_stat_vec
   template<typename T1> arma_hot inline void operator() (const Base<              T, T1>& X);
   template<typename T1> arma_hot inline void operator() (const Base<std::complex<T>, T1>& X);
   
+  template<typename T1>              arma_hot inline void operator() (const Base<T, T1>& X, const T weight);
+  template<typename T1, typename T2> arma_hot inline void operator() (const Base<T, T1>& X, const Base<T, T2>& W);
+  
+  inline void merge(const running_stat_vec& in);
+  
   inline void reset();
   
   inline const Mat<eT>&  mean() const;
@@ -123,6 +128,77 @@ class running_stat_vec_aux
     const                   Mat<typename running_stat_vec<obj_type>::eT>& sample,
     const typename arma_cx_only<typename running_stat_vec<obj_type>::eT>::result* junk = 0
     );
+  
+  //
+  
+  template<typename obj_type>
+  inline static void
+  update_stats_batch
+    (
+    running_stat_vec<obj_type>& x,
+    const                  Mat<typename running_stat_vec<obj_type>::eT>& X,
+    const typename arma_not_cx<typename running_stat_vec<obj_type>::eT>::result* junk = 0
+    );
+  
+  template<typename obj_type>
+  inline static void
+  update_stats_batch
+    (
+    running_stat_vec<obj_type>& x,
+    const          Mat<std::complex< typename running_stat_vec<obj_type>::T > >& X,
+    const typename       arma_not_cx<typename running_stat_vec<obj_type>::eT>::result* junk = 0
+    );
+  
+  template<typename obj_type>
+  inline static void
+  update_stats_batch
+    (
+    running_stat_vec<obj_type>& x,
+    const                  Mat< typename running_stat_vec<obj_type>::T >& X,
+    const typename arma_cx_only<typename running_stat_vec<obj_type>::eT>::result* junk = 0
+    );
+  
+  template<typename obj_type>
+  inline static void
+  update_stats_batch
+    (
+    running_stat_vec<obj_type>& x,
+    const                   Mat<typename running_stat_vec<obj_type>::eT>& X,
+    const typename arma_cx_only<typename running_stat_vec<obj_type>::eT>::result* junk = 0
+    );
+  
+  //
+  
+  template<typename obj_type>
+  inline static void
+  update_stats_weighted
+    (
+    running_stat_vec<obj_type>& x,
+    const                  Mat<typename running_stat_vec<obj_type>::eT>& X,
+    const                      typename running_stat_vec<obj_type>::T*   W_mem,
+    const bool                                                           default_as_row,
+    const typename arma_not_cx<typename running_stat_vec<obj_type>::eT>::result* junk = 0
+    );
+  
+  //
+  
+  template<typename obj_type>
+  inline static void
+  merge_stats
+    (
+    running_stat_vec<obj_type>& x,
+    const running_stat_vec<obj_type>& y,
+    const typename arma_not_cx<typename running_stat_vec<obj_type>::eT>::result* junk = 0
+    );
+  
+  template<typename obj_type>
+  inline static void
+  merge_stats
+    (
+    running_stat_vec<obj_type>& x,
+    const running_stat_vec<obj_type>& y,
+    const typename arma_cx_only<typename running_stat_vec<obj_type>::eT>::result* junk = 0
+    );
   };
 
 
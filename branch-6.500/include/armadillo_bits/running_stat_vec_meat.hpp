@@ -91,6 +91,22 @@ running_stat_vec<obj_type>::operator() (const Base<typename running_stat_vec<obj
     return;
     }
   
+  if( (sample.n_rows > 1) && (sample.n_cols > 1) )
+    {
+    // each column is a sample
+    
+    if( sample.is_finite() == false )
+      {
+      for(uword col=0; col < sample.n_cols; ++col)  { (*this).operator()(sample.col(col)); }
+      
+      return;
+      }
+    
+    running_stat_vec_aux::update_stats_batch(*this, sample);
+    
+    return;
+    }
+  
   if( sample.is_finite() == false )
     {
     arma_debug_warn("running_stat_vec: sample ignored as it has non-finite elements");
@@ -120,6 +136,20 @@ running_stat_vec<obj_type>::operator() (const Base< std::complex<typename runnin
     return;
     }
   
+  if( (sample.n_rows > 1) && (sample.n_cols > 1) )
+    {
+    if( sample.is_finite() == false )
+      {
+      for(uword col=0; col < sample.n_cols; ++col)  { (*this).operator()(sample.col(col)); }
+      
+      return;
+      }
+    
+    running_stat_vec_aux::update_stats_batch(*this, sample);
+    
+    return;
+    }
+  
   if( sample.is_finite() == false )
     {
     arma_debug_warn("running_stat_vec: sample ignored as it has non-finite elements");
@@ -131,6 +161,108 @@ running_stat_vec<obj_type>::operator() (const Base< std::complex<typename runnin
 
 
 
+//! update statistics to reflect a new sample with the given non-negative weight;
+//! the weight acts as a frequency, ie. a weight of 2 is the same as giving the sample twice
+template<typename obj_type>
+template<typename T1>
+arma_hot
+inline
+void
+running_stat_vec<obj_type>::operator() (const Base<typename running_stat_vec<obj_type>::T, T1>& X, const typename running_stat_vec<obj_type>::T weight)
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_type_check(( is_cx<eT>::value ));
+  
+  arma_debug_check( ((weight < T(0)) || (arma_isfinite(weight) == false)), "running_stat_vec(): weight must be finite and non-negative" );
+  
+  const quasi_unwrap<T1> tmp(X.get_ref());
+  const Mat<T>& sample = tmp.M;
+  
+  if( sample.is_empty() || (weight == T(0)) )
+    {
+    return;
+    }
+  
+  arma_debug_check( (sample.is_vec() == false), "running_stat_vec(): given sample is not a vector" );
+  
+  if( sample.is_finite() == false )
+    {
+    arma_debug_warn("running_stat_vec: sample ignored as it has non-finite elements");
+    return;
+    }
+  
+  const Mat<T> sample_col(const_cast<T*>(sample.memptr()), sample.n_elem, 1, false, true);
+  
+  running_stat_vec_aux::update_stats_weighted(*this, sample_col, &weight, (sample.n_rows == 1));
+  }
+
+
+
+//! update statistics to reflect a batch of samples stored as the columns of X,
+//! where the non-negative weight of each sample is given in vector W
+template<typename obj_type>
+template<typename T1, typename T2>
+arma_hot
+inline
+void
+running_stat_vec<obj_type>::operator() (const Base<typename running_stat_vec<obj_type>::T, T1>& X, const Base<typename running_stat_vec<obj_type>::T, T2>& W)
+  {
+  arma_extra_debug_sigprint();
+  
+  arma_type_check(( is_cx<eT>::value ));
+  
+  const quasi_unwrap<T1> tmp1(X.get_ref());
+  const quasi_unwrap<T2> tmp2(W.get_ref());
+  
+  const Mat<T>& sample  = tmp1.M;
+  const Mat<T>& weights = tmp2.M;
+  
+  arma_debug_check( ((weights.is_vec() == false) && (weights.is_empty() == false)), "running_stat_vec(): given weights must be a vector" );
+  
+  arma_debug_check( (weights.n_elem != sample.n_cols), "running_stat_vec(): number of weights does not match the number of samples" );
+  
+  const T*    W_mem    = weights.memptr();
+  const uword W_n_elem = weights.n_elem;
+  
+  for(uword i=0; i < W_n_elem; ++i)
+    {
+    const T w = W_mem[i];
+    
+    arma_debug_check( ((w < T(0)) || (arma_isfinite(w) == false)), "running_stat_vec(): weights must be finite and non-negative" );
+    }
+  
+  if( sample.is_empty() )
+    {
+    return;
+    }
+  
+  if( sample.is_finite() == false )
+    {
+    for(uword col=0; col < sample.n_cols; ++col)  { (*this).operator()(sample.col(col), W_mem[col]); }
+    
+    return;
+    }
+  
+  running_stat_vec_aux::update_stats_weighted(*this, sample, W_mem, bool(is_Row<obj_type>::value));
+  }
+
+
+
+//! combine the statistics of another running_stat_vec object with the statistics so far,
+//! giving the same result as if the samples of both objects were processed by this object
+template<typename obj_type>
+inline
+void
+running_stat_vec<obj_type>::merge(const running_stat_vec<obj_type>& in)
+  {
+  arma_extra_debug_sigprint();
+  
+  running_stat_vec_aux::merge_stats(*this, in);
+  }
+
+
+
 //! set all statistics to zero
 template<typename obj_type>
 inline
@@ -612,4 +744,594 @@ running_stat_vec_aux::update_stats
 
 
 
+
+//! update statistics to reflect a batch of samples, stored as the columns of X (version for non-complex numbers)
+template<typename obj_type>
+inline
+void
+running_stat_vec_aux::update_stats_batch
+  (
+  running_stat_vec<obj_type>& x,
+  const                  Mat<typename running_stat_vec<obj_type>::eT>& X,
+  const typename arma_not_cx<typename running_stat_vec<obj_type>::eT>::result* junk
+  )
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  typedef typename running_stat_vec<obj_type>::eT eT;
+  typedef typename running_stat_vec<obj_type>::T   T;
+  
+  const uword X_n_rows = X.n_rows;
+  const uword X_n_cols = X.n_cols;
+  
+  // the statistics of the batch are found via two passes,
+  // and then combined with the statistics so far
+  
+  running_stat_vec<obj_type> B(x.calc_cov);
+  
+  B.r_mean.zeros(X_n_rows, 1);
+  B.r_var.zeros(X_n_rows, 1);
+  
+  B.min_val = X.col(0);
+  B.max_val = X.col(0);
+  
+  eT* r_mean_mem  = B.r_mean.memptr();
+   T* r_var_mem   = B.r_var.memptr();
+  eT* min_val_mem = B.min_val.memptr();
+  eT* max_val_mem = B.max_val.memptr();
+  
+  for(uword col=0; col < X_n_cols; ++col)
+    {
+    const eT* X_colmem = X.colptr(col);
+    
+    for(uword row=0; row < X_n_rows; ++row)
+      {
+      const eT val = X_colmem[row];
+      
+      r_mean_mem[row] += val;
+      
+      if(val < min_val_mem[row])  { min_val_mem[row] = val; }
+      if(val > max_val_mem[row])  { max_val_mem[row] = val; }
+      }
+    }
+  
+  B.r_mean /= T(X_n_cols);
+  
+  Mat<eT>& Xc = B.tmp1;
+  
+  Xc = X.each_col() - B.r_mean;
+  
+  const eT*   Xc_mem    = Xc.memptr();
+  const uword Xc_n_elem = Xc.n_elem;
+  
+  for(uword i=0; i < Xc_n_elem; ++i)
+    {
+    const eT tmp = Xc_mem[i];
+    
+    r_var_mem[i % X_n_rows] += tmp*tmp;
+    }
+  
+  B.r_var /= T(X_n_cols - 1);
+  
+  if(x.calc_cov == true)
+    {
+    B.r_cov = Xc * trans(Xc);  // done via syrk()
+    
+    B.r_cov /= T(X_n_cols - 1);
+    }
+  
+  // keep the orientation of the statistics so far; without any, follow obj_type
+  
+  const bool as_row = (x.counter.value() > T(0)) ? (x.r_mean.n_rows == 1) : bool(is_Row<obj_type>::value);
+  
+  if(as_row)
+    {
+    B.r_mean.reshape(1, X_n_rows);
+    B.r_var.reshape(1, X_n_rows);
+    B.min_val.reshape(1, X_n_rows);
+    B.max_val.reshape(1, X_n_rows);
+    }
+  
+  B.counter.add(X_n_cols);
+  
+  running_stat_vec_aux::merge_stats(x, B);
+  }
+
+
+
+//! update statistics to reflect a batch of samples (version for non-complex numbers, complex samples)
+template<typename obj_type>
+inline
+void
+running_stat_vec_aux::update_stats_batch
+  (
+  running_stat_vec<obj_type>& x,
+  const          Mat<std::complex< typename running_stat_vec<obj_type>::T > >& X,
+  const typename       arma_not_cx<typename running_stat_vec<obj_type>::eT>::result* junk
+  )
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  typedef typename running_stat_vec<obj_type>::eT eT;
+  
+  running_stat_vec_aux::update_stats_batch(x, conv_to< Mat<eT> >::from(X));
+  }
+
+
+
+//! update statistics to reflect a batch of samples (version for complex numbers, non-complex samples)
+template<typename obj_type>
+inline
+void
+running_stat_vec_aux::update_stats_batch
+  (
+  running_stat_vec<obj_type>& x,
+  const                   Mat<typename running_stat_vec<obj_type>::T >& X,
+  const typename arma_cx_only<typename running_stat_vec<obj_type>::eT>::result* junk
+  )
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  typedef typename running_stat_vec<obj_type>::eT eT;
+  
+  running_stat_vec_aux::update_stats_batch(x, conv_to< Mat<eT> >::from(X));
+  }
+
+
+
+//! update statistics to reflect a batch of samples, stored as the columns of X (version for complex numbers)
+template<typename obj_type>
+inline
+void
+running_stat_vec_aux::update_stats_batch
+  (
+  running_stat_vec<obj_type>& x,
+  const                   Mat<typename running_stat_vec<obj_type>::eT>& X,
+  const typename arma_cx_only<typename running_stat_vec<obj_type>::eT>::result* junk
+  )
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  typedef typename running_stat_vec<obj_type>::eT eT;
+  typedef typename running_stat_vec<obj_type>::T   T;
+  
+  const uword X_n_rows = X.n_rows;
+  const uword X_n_cols = X.n_cols;
+  
+  running_stat_vec<obj_type> B(x.calc_cov);
+  
+  B.r_mean.zeros(X_n_rows, 1);
+  B.r_var.zeros(X_n_rows, 1);
+  
+  B.min_val = X.col(0);
+  B.max_val = X.col(0);
+  
+  B.min_val_norm.set_size(X_n_rows, 1);
+  B.max_val_norm.set_size(X_n_rows, 1);
+  
+  eT* r_mean_mem       = B.r_mean.memptr();
+   T* r_var_mem        = B.r_var.memptr();
+  eT* min_val_mem      = B.min_val.memptr();
+  eT* max_val_mem      = B.max_val.memptr();
+   T* min_val_norm_mem = B.min_val_norm.memptr();
+   T* max_val_norm_mem = B.max_val_norm.memptr();
+  
+  for(uword row=0; row < X_n_rows; ++row)
+    {
+    min_val_norm_mem[row] = std::norm(min_val_mem[row]);
+    max_val_norm_mem[row] = min_val_norm_mem[row];
+    }
+  
+  for(uword col=0; col < X_n_cols; ++col)
+    {
+    const eT* X_colmem = X.colptr(col);
+    
+    for(uword row=0; row < X_n_rows; ++row)
+      {
+      const eT& val      = X_colmem[row];
+      const  T  val_norm = std::norm(val);
+      
+      r_mean_mem[row] += val;
+      
+      if(val_norm < min_val_norm_mem[row])
+        {
+        min_val_norm_mem[row] = val_norm;
+        min_val_mem[row]      = val;
+        }
+      
+      if(val_norm > max_val_norm_mem[row])
+        {
+        max_val_norm_mem[row] = val_norm;
+        max_val_mem[row]      = val;
+        }
+      }
+    }
+  
+  B.r_mean /= T(X_n_cols);
+  
+  Mat<eT>& Xc = B.tmp1;
+  
+  Xc = X.each_col() - B.r_mean;
+  
+  const eT*   Xc_mem    = Xc.memptr();
+  const uword Xc_n_elem = Xc.n_elem;
+  
+  for(uword i=0; i < Xc_n_elem; ++i)  { r_var_mem[i % X_n_rows] += std::norm(Xc_mem[i]); }
+  
+  B.r_var /= T(X_n_cols - 1);
+  
+  if(x.calc_cov == true)
+    {
+    B.r_cov = arma::conj(Xc) * strans(Xc);
+    
+    B.r_cov /= T(X_n_cols - 1);
+    }
+  
+  const bool as_row = (x.counter.value() > T(0)) ? (x.r_mean.n_rows == 1) : bool(is_Row<obj_type>::value);
+  
+  if(as_row)
+    {
+    B.r_mean.reshape(1, X_n_rows);
+    B.r_var.reshape(1, X_n_rows);
+    B.min_val.reshape(1, X_n_rows);
+    B.max_val.reshape(1, X_n_rows);
+    B.min_val_norm.reshape(1, X_n_rows);
+    B.max_val_norm.reshape(1, X_n_rows);
+    }
+  
+  B.counter.add(X_n_cols);
+  
+  running_stat_vec_aux::merge_stats(x, B);
+  }
+
+
+
+//! update statistics to reflect weighted samples, stored as the columns of X (version for non-complex numbers);
+//! the mean and the sums of squared differences are found in one pass via the weighted update of West (1979),
+//! and then combined with the statistics so far; samples with zero weight are ignored
+template<typename obj_type>
+inline
+void
+running_stat_vec_aux::update_stats_weighted
+  (
+  running_stat_vec<obj_type>& x,
+  const                  Mat<typename running_stat_vec<obj_type>::eT>& X,
+  const                      typename running_stat_vec<obj_type>::T*   W_mem,
+  const bool                                                           default_as_row,
+  const typename arma_not_cx<typename running_stat_vec<obj_type>::eT>::result* junk
+  )
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  typedef typename running_stat_vec<obj_type>::eT eT;
+  typedef typename running_stat_vec<obj_type>::T   T;
+  
+  const uword X_n_rows = X.n_rows;
+  const uword X_n_cols = X.n_cols;
+  
+  const T N_x = x.counter.value();
+  
+  arma_debug_check( ((N_x > T(0)) && (x.r_mean.n_elem != X_n_rows)), "running_stat_vec(): dimensionality mismatch" );
+  
+  running_stat_vec<obj_type> B(x.calc_cov);
+  
+  B.r_mean.zeros(X_n_rows, 1);
+  B.r_var.zeros(X_n_rows, 1);
+  
+  B.min_val.set_size(X_n_rows, 1);
+  B.max_val.set_size(X_n_rows, 1);
+  
+  eT* r_mean_mem  = B.r_mean.memptr();
+   T* r_var_mem   = B.r_var.memptr();
+  eT* min_val_mem = B.min_val.memptr();
+  eT* max_val_mem = B.max_val.memptr();
+  
+  // with S as the sum of the weights so far, a sample with weight w changes the mean by (w/S_new)*delta
+  // and the sum of squared differences by (S*w/S_new)*delta^2, where delta is the difference from the mean so far
+  
+  T S = T(0);
+  
+  for(uword col=0; col < X_n_cols; ++col)
+    {
+    const T w = W_mem[col];
+    
+    if(w <= T(0))  { continue; }
+    
+    const eT* X_colmem = X.colptr(col);
+    
+    if(S == T(0))
+      {
+      arrayops::copy(min_val_mem, X_colmem, X_n_rows);
+      arrayops::copy(max_val_mem, X_colmem, X_n_rows);
+      }
+    
+    const T S_new   = S + w;
+    const T coeff_m = w / S_new;
+    const T coeff_v = S * coeff_m;
+    
+    for(uword row=0; row < X_n_rows; ++row)
+      {
+      const eT val   = X_colmem[row];
+      const eT delta = val - r_mean_mem[row];
+      
+      r_mean_mem[row] += coeff_m * delta;
+      r_var_mem[row]  += coeff_v * (delta*delta);
+      
+      if(val < min_val_mem[row])  { min_val_mem[row] = val; }
+      if(val > max_val_mem[row])  { max_val_mem[row] = val; }
+      }
+    
+    S = S_new;
+    }
+  
+  if(S == T(0))  { return; }
+  
+  // the weights may be fractional; sums of squared differences with a total weight up to 1 are kept without normalisation
+  
+  const T norm_val = (S > T(1)) ? (S - T(1)) : T(1);
+  
+  B.r_var /= norm_val;
+  
+  if(x.calc_cov == true)
+    {
+    // centred samples scaled by sqrt(w), so that Xc*trans(Xc) is the weighted sum of outer products
+    
+    Mat<eT>& Xc = B.tmp1;
+    
+    Xc.set_size(X_n_rows, X_n_cols);
+    
+    for(uword col=0; col < X_n_cols; ++col)
+      {
+      const T   sqrt_w    = std::sqrt(W_mem[col]);
+      const eT* X_colmem  = X.colptr(col);
+            eT* Xc_colmem = Xc.colptr(col);
+      
+      for(uword row=0; row < X_n_rows; ++row)  { Xc_colmem[row] = sqrt_w * (X_colmem[row] - r_mean_mem[row]); }
+      }
+    
+    B.r_cov = Xc * trans(Xc);  // done via syrk()
+    
+    B.r_cov /= norm_val;
+    }
+  
+  const bool as_row = (N_x > T(0)) ? (x.r_mean.n_rows == 1) : default_as_row;
+  
+  if(as_row)
+    {
+    B.r_mean.reshape(1, X_n_rows);
+    B.r_var.reshape(1, X_n_rows);
+    B.min_val.reshape(1, X_n_rows);
+    B.max_val.reshape(1, X_n_rows);
+    }
+  
+  B.counter.add_weight(S);
+  
+  running_stat_vec_aux::merge_stats(x, B);
+  }
+
+
+
+//! combine the statistics of y with the statistics of x (version for non-complex numbers);
+//! the variances and covariances are combined via the pairwise formula of Chan, Golub and LeVeque:
+//! M2 = M2_x + M2_y + delta*trans(delta) * N_x*N_y/N, where M2 is the sum of outer products of the differences from the mean
+template<typename obj_type>
+inline
+void
+running_stat_vec_aux::merge_stats
+  (
+  running_stat_vec<obj_type>& x,
+  const running_stat_vec<obj_type>& y,
+  const typename arma_not_cx<typename running_stat_vec<obj_type>::eT>::result* junk
+  )
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  typedef typename running_stat_vec<obj_type>::eT eT;
+  typedef typename running_stat_vec<obj_type>::T   T;
+  
+  const T N_x = x.counter.value();
+  const T N_y = y.counter.value();
+  
+  if(N_y == T(0))  { return; }
+  
+  if(&x == &y)
+    {
+    const running_stat_vec<obj_type> tmp(y);
+    
+    running_stat_vec_aux::merge_stats(x, tmp);
+    
+    return;
+    }
+  
+  arma_debug_check( ((x.calc_cov == true) && (y.calc_cov == false)), "running_stat_vec::merge(): given object does not calculate the covariance matrix" );
+  
+  if(N_x == T(0))
+    {
+    x.counter = y.counter;
+    x.r_mean  = y.r_mean;
+    x.r_var   = y.r_var;
+    x.min_val = y.min_val;
+    x.max_val = y.max_val;
+    
+    if(x.calc_cov == true)  { x.r_cov = y.r_cov; }
+    
+    return;
+    }
+  
+  arma_debug_check( (x.r_mean.n_elem != y.r_mean.n_elem), "running_stat_vec::merge(): dimensionality mismatch" );
+  
+  const uword n_elem = x.r_mean.n_elem;
+  
+  const T N = N_x + N_y;
+  
+  // the counts of weighted samples can be fractional; variances with a count up to 1 are kept without normalisation
+  
+  const T N_x_norm = (N_x > T(1)) ? (N_x - T(1)) : T(1);
+  const T N_y_norm = (N_y > T(1)) ? (N_y - T(1)) : T(1);
+  const T N_norm   = (N   > T(1)) ? (N   - T(1)) : T(1);
+  
+  const T x_scale = N_x_norm / N_norm;
+  const T y_scale = N_y_norm / N_norm;
+  const T d_scale = ((N_x/N) * N_y) / N_norm;
+  const T m_scale = N_y / N;
+  
+  Mat<eT>& delta = x.tmp1;
+  
+  delta.set_size(n_elem, 1);
+  
+        eT* delta_mem     = delta.memptr();
+        eT* r_mean_mem    = x.r_mean.memptr();
+         T* r_var_mem     = x.r_var.memptr();
+        eT* min_val_mem   = x.min_val.memptr();
+        eT* max_val_mem   = x.max_val.memptr();
+  const eT* y_r_mean_mem  = y.r_mean.memptr();
+  const  T* y_r_var_mem   = y.r_var.memptr();
+  const eT* y_min_val_mem = y.min_val.memptr();
+  const eT* y_max_val_mem = y.max_val.memptr();
+  
+  for(uword i=0; i < n_elem; ++i)
+    {
+    const eT tmp = y_r_mean_mem[i] - r_mean_mem[i];
+    
+    delta_mem[i] = tmp;
+    
+    r_var_mem[i]  = x_scale*r_var_mem[i] + y_scale*y_r_var_mem[i] + d_scale*(tmp*tmp);
+    r_mean_mem[i] = r_mean_mem[i] + m_scale*tmp;
+    
+    if(y_min_val_mem[i] < min_val_mem[i])  { min_val_mem[i] = y_min_val_mem[i]; }
+    if(y_max_val_mem[i] > max_val_mem[i])  { max_val_mem[i] = y_max_val_mem[i]; }
+    }
+  
+  if(x.calc_cov == true)
+    {
+    x.tmp2 = delta * trans(delta);
+    
+    x.r_cov *= x_scale;
+    x.r_cov += y_scale * y.r_cov;
+    x.r_cov += d_scale * x.tmp2;
+    }
+  
+  x.counter.add(y.counter);
+  }
+
+
+
+//! combine the statistics of y with the statistics of x (version for complex numbers)
+template<typename obj_type>
+inline
+void
+running_stat_vec_aux::merge_stats
+  (
+  running_stat_vec<obj_type>& x,
+  const running_stat_vec<obj_type>& y,
+  const typename arma_cx_only<typename running_stat_vec<obj_type>::eT>::result* junk
+  )
+  {
+  arma_extra_debug_sigprint();
+  arma_ignore(junk);
+  
+  typedef typename running_stat_vec<obj_type>::eT eT;
+  typedef typename running_stat_vec<obj_type>::T   T;
+  
+  const T N_x = x.counter.value();
+  const T N_y = y.counter.value();
+  
+  if(N_y == T(0))  { return; }
+  
+  if(&x == &y)
+    {
+    const running_stat_vec<obj_type> tmp(y);
+    
+    running_stat_vec_aux::merge_stats(x, tmp);
+    
+    return;
+    }
+  
+  arma_debug_check( ((x.calc_cov == true) && (y.calc_cov == false)), "running_stat_vec::merge(): given object does not calculate the covariance matrix" );
+  
+  if(N_x == T(0))
+    {
+    x.counter      = y.counter;
+    x.r_mean       = y.r_mean;
+    x.r_var        = y.r_var;
+    x.min_val      = y.min_val;
+    x.max_val      = y.max_val;
+    x.min_val_norm = y.min_val_norm;
+    x.max_val_norm = y.max_val_norm;
+    
+    if(x.calc_cov == true)  { x.r_cov = y.r_cov; }
+    
+    return;
+    }
+  
+  arma_debug_check( (x.r_mean.n_elem != y.r_mean.n_elem), "running_stat_vec::merge(): dimensionality mismatch" );
+  
+  const uword n_elem = x.r_mean.n_elem;
+  
+  const T N = N_x + N_y;
+  
+  const T x_scale = (N_x - T(1)) / (N - T(1));
+  const T y_scale = (N_y - T(1)) / (N - T(1));
+  const T d_scale = ((N_x/N) * N_y) / (N - T(1));
+  const T m_scale = N_y / N;
+  
+  Mat<eT>& delta = x.tmp1;
+  
+  delta.set_size(n_elem, 1);
+  
+        eT* delta_mem          = delta.memptr();
+        eT* r_mean_mem         = x.r_mean.memptr();
+         T* r_var_mem          = x.r_var.memptr();
+        eT* min_val_mem        = x.min_val.memptr();
+        eT* max_val_mem        = x.max_val.memptr();
+         T* min_val_norm_mem   = x.min_val_norm.memptr();
+         T* max_val_norm_mem   = x.max_val_norm.memptr();
+  const eT* y_r_mean_mem       = y.r_mean.memptr();
+  const  T* y_r_var_mem        = y.r_var.memptr();
+  const eT* y_min_val_mem      = y.min_val.memptr();
+  const eT* y_max_val_mem      = y.max_val.memptr();
+  const  T* y_min_val_norm_mem = y.min_val_norm.memptr();
+  const  T* y_max_val_norm_mem = y.max_val_norm.memptr();
+  
+  for(uword i=0; i < n_elem; ++i)
+    {
+    const eT tmp = y_r_mean_mem[i] - r_mean_mem[i];
+    
+    delta_mem[i] = tmp;
+    
+    r_var_mem[i]  = x_scale*r_var_mem[i] + y_scale*y_r_var_mem[i] + d_scale*std::norm(tmp);
+    r_mean_mem[i] = r_mean_mem[i] + m_scale*tmp;
+    
+    if(y_min_val_norm_mem[i] < min_val_norm_mem[i])
+      {
+      min_val_norm_mem[i] = y_min_val_norm_mem[i];
+      min_val_mem[i]      = y_min_val_mem[i];
+      }
+    
+    if(y_max_val_norm_mem[i] > max_val_norm_mem[i])
+      {
+      max_val_norm_mem[i] = y_max_val_norm_mem[i];
+      max_val_mem[i]      = y_max_val_mem[i];
+      }
+    }
+  
+  if(x.calc_cov == true)
+    {
+    x.tmp2 = arma::conj(delta) * strans(delta);
+    
+    x.r_cov *= x_scale;
+    x.r_cov += y_scale * y.r_cov;
+    x.r_cov += d_scale * x.tmp2;
+    }
+  
+  x.counter.add(y.counter);
+  }
+
+
 //! @}
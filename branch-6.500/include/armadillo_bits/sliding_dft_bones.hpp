@@ -0,0 +1,61 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup sliding_dft
+//! @{
+
+
+
+//! selected bins of the DFT of the last N samples of a signal, updated for each incoming sample:
+//! spectrum()[i] equals fft(x)[bins[i]], where x holds the last N samples (oldest first; initially zero).
+//! each sample costs O(1) per bin via the recursion X_k <- (X_k - x_old + x_new) * exp(+i*2*pi*k/N);
+//! to stop rounding errors from accumulating, the bins are recomputed exactly every N samples via the Goertzel algorithm.
+//! as the object has state, it must not be used by several threads at once.
+template<typename eT>
+class sliding_dft
+  {
+  public:
+  
+  typedef eT                                elem_type;
+  typedef typename get_pod_type<eT>::result pod_type;
+  typedef std::complex<pod_type>            cx_type;
+  
+  const uword N;
+  
+  inline ~sliding_dft();
+  
+  template<typename T1> inline sliding_dft(const uword in_N, const Base<uword,T1>& in_bins);
+  
+  inline void operator() (const eT sample);
+  
+  template<typename T1> inline void operator() (const Base<eT,T1>& X);
+  
+  inline void reset();
+  
+  inline const Col<cx_type>& spectrum() const;
+  inline const uvec&         bins()     const;
+  
+  
+  private:
+  
+  uvec              k;        //!< the bins
+  Col<cx_type>      X;        //!< current values of the bins
+  podarray<cx_type> rot;      //!< exp(+i*2*pi*k/N) for each bin
+  podarray<eT>      buf;      //!< circular buffer of the last N samples
+  uword             pos;      //!< position of the oldest sample in buf
+  uword             count;    //!< samples since the last exact computation
+  
+  inline void update(const eT sample);
+  inline void recompute();
+  };
+
+
+
+//! @}
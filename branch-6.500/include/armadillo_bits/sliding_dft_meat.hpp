@@ -0,0 +1,197 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+//! \addtogroup sliding_dft
+//! @{
+
+
+
+template<typename eT>
+inline
+sliding_dft<eT>::~sliding_dft()
+  {
+  arma_extra_debug_sigprint_this(this);
+  }
+
+
+
+template<typename eT>
+template<typename T1>
+inline
+sliding_dft<eT>::sliding_dft(const uword in_N, const Base<uword,T1>& in_bins)
+  : N    (in_N)
+  , pos  (0   )
+  , count(0   )
+  {
+  arma_extra_debug_sigprint_this(this);
+  
+  arma_type_check(( is_supported_blas_type<eT>::value == false ));
+  
+  arma_debug_check( (N == 0), "sliding_dft(): N must be greater than zero" );
+  
+  const quasi_unwrap<T1> U(in_bins.get_ref());
+  
+  arma_debug_check( ((U.M.is_vec() == false) && (U.M.is_empty() == false)), "sliding_dft(): given bins must be a vector" );
+  
+  const uword n_bins = U.M.n_elem;
+  
+  k.set_size(n_bins);
+  X.set_size(n_bins);
+  rot.set_size(n_bins);
+  
+  arrayops::copy( k.memptr(), U.M.memptr(), n_bins );
+  
+  arma_debug_check( ((n_bins > 0) && (k.max() >= N)), "sliding_dft(): bins must be less than N" );
+  
+  for(uword i=0; i < n_bins; ++i)
+    {
+    pod_type re;
+    pod_type im;
+    
+    fft_engine<cx_type,true>::calc_root(re, im, k[i], N);
+    
+    rot[i] = cx_type(re, im);
+    }
+  
+  buf.set_size(N);
+  
+  (*this).reset();
+  }
+
+
+
+//! forget all samples, ie. the last N samples are taken as zero
+template<typename eT>
+inline
+void
+sliding_dft<eT>::reset()
+  {
+  arma_extra_debug_sigprint();
+  
+  arrayops::fill_zeros( buf.memptr(), N );
+  X.zeros();
+  
+  pos   = 0;
+  count = 0;
+  }
+
+
+
+template<typename eT>
+inline
+void
+sliding_dft<eT>::update(const eT sample)
+  {
+  const eT x_old = buf[pos];
+  
+  buf[pos] = sample;
+  
+  pos = (pos + 1 < N) ? (pos + 1) : uword(0);
+  
+  const uword n_bins = X.n_elem;
+  
+  cx_type*       X_mem   = X.memptr();
+  const cx_type* rot_mem = rot.memptr();
+  
+  const cx_type delta = cx_type(sample) - cx_type(x_old);
+  
+  for(uword i=0; i < n_bins; ++i)  { X_mem[i] = (X_mem[i] + delta) * rot_mem[i]; }
+  
+  ++count;
+  
+  if(count >= N)  { recompute(); }
+  }
+
+
+
+//! exact values of the bins, via the Goertzel recursion s[m] = x[m] + 2*cos(w)*s[m-1] - s[m-2] with w = 2*pi*k/N;
+//! the DFT value is then exp(+i*w)*s[N-1] - s[N-2], as exp(-i*w*N) = 1
+template<typename eT>
+inline
+void
+sliding_dft<eT>::recompute()
+  {
+  arma_extra_debug_sigprint();
+  
+  const uword n_bins = X.n_elem;
+  
+  const eT* buf_mem = buf.memptr();
+  
+  for(uword i=0; i < n_bins; ++i)
+    {
+    const pod_type c2 = pod_type(2) * rot[i].real();
+    
+    eT s1 = eT(0);
+    eT s2 = eT(0);
+    
+    // oldest sample first
+    for(uword m=pos; m < N;   ++m)  { const eT s0 = buf_mem[m] + c2*s1 - s2;  s2 = s1;  s1 = s0; }
+    for(uword m=0;   m < pos; ++m)  { const eT s0 = buf_mem[m] + c2*s1 - s2;  s2 = s1;  s1 = s0; }
+    
+    X[i] = rot[i] * cx_type(s1) - cx_type(s2);
+    }
+  
+  count = 0;
+  }
+
+
+
+template<typename eT>
+inline
+void
+sliding_dft<eT>::operator() (const eT sample)
+  {
+  update(sample);
+  }
+
+
+
+//! push the elements of vector X, in order
+template<typename eT>
+template<typename T1>
+inline
+void
+sliding_dft<eT>::operator() (const Base<eT,T1>& X_in)
+  {
+  arma_extra_debug_sigprint();
+  
+  const quasi_unwrap<T1> U(X_in.get_ref());
+  
+  arma_debug_check( ((U.M.is_vec() == false) && (U.M.is_empty() == false)), "sliding_dft(): given object must be a vector" );
+  
+  const eT*   mem    = U.M.memptr();
+  const uword n_elem = U.M.n_elem;
+  
+  for(uword i=0; i < n_elem; ++i)  { update(mem[i]); }
+  }
+
+
+
+template<typename eT>
+inline
+const Col<typename sliding_dft<eT>::cx_type>&
+sliding_dft<eT>::spectrum() const
+  {
+  return X;
+  }
+
+
+
+template<typename eT>
+inline
+const uvec&
+sliding_dft<eT>::bins() const
+  {
+  return k;
+  }
+
+
+
+//! @}
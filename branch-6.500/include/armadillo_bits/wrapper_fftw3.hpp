@@ -0,0 +1,301 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+
+#if defined(ARMA_USE_FFTW3)
+
+//! \namespace fftw3 namespace for FFTW3 functions.
+//! the FFTW3 planner is not thread safe, so making and destroying plans, as well as importing and exporting wisdom, is serialised;
+//! executing a plan is thread safe
+namespace fftw3
+  {
+  
+  // constants as per fftw3.h
+  static const int      forward        = -1;
+  static const int      backward       = +1;
+  static const unsigned measure        = 0U;
+  static const unsigned unaligned      = (1U << 1);
+  static const unsigned preserve_input = (1U << 4);
+  static const unsigned estimate       = (1U << 6);
+
+
+
+  #if defined(ARMA_USE_CXX11)
+    inline
+    std::mutex&
+    get_planner_mutex()
+      {
+      static std::mutex planner_mutex;
+      
+      return planner_mutex;
+      }
+  #endif
+  
+  
+  
+  template<typename eT>
+  inline
+  void*
+  plan_dft_1d_locked(const int n, eT* in, eT* out, const int sign, const unsigned flags)
+    {
+    if(is_supported_complex_float<eT>::value)
+      {
+      typedef float (*T)[2];
+      return (void*)( arma_wrapper(fftwf_plan_dft_1d)(n, (T)in, (T)out, sign, flags) );
+      }
+    else
+    if(is_supported_complex_double<eT>::value)
+      {
+      typedef double (*T)[2];
+      return (void*)( arma_wrapper(fftw_plan_dft_1d)(n, (T)in, (T)out, sign, flags) );
+      }
+    
+    return NULL;
+    }
+  
+  
+  
+  //! returns NULL if FFTW3 could not make the plan
+  template<typename eT>
+  inline
+  void*
+  plan_dft_1d(const int n, eT* in, eT* out, const int sign, const unsigned flags)
+    {
+    arma_type_check(( is_supported_complex<eT>::value == false ));
+    
+    void* plan = NULL;
+
+    #if defined(ARMA_USE_CXX11)
+      {
+      std::lock_guard<std::mutex> lock( get_planner_mutex() );
+      
+      plan = plan_dft_1d_locked(n, in, out, sign, flags);
+      }
+    #elif defined(_OPENMP)
+      {
+      #pragma omp critical (arma_fftw3_planner)
+        {
+        plan = plan_dft_1d_locked(n, in, out, sign, flags);
+        }
+      }
+    #else
+      {
+      plan = plan_dft_1d_locked(n, in, out, sign, flags);
+      }
+    #endif
+    
+    return plan;
+    }
+  
+  
+  
+  template<typename eT>
+  inline
+  void
+  destroy_plan_locked(void* plan)
+    {
+    if(is_supported_complex_float<eT>::value)
+      {
+      arma_wrapper(fftwf_destroy_plan)( (::fftwf_plan_s*)plan );
+      }
+    else
+    if(is_supported_complex_double<eT>::value)
+      {
+      arma_wrapper(fftw_destroy_plan)( (::fftw_plan_s*)plan );
+      }
+    }
+  
+  
+  
+  template<typename eT>
+  inline
+  void
+  destroy_plan(void* plan)
+    {
+    arma_type_check(( is_supported_complex<eT>::value == false ));
+    
+    if(plan == NULL)  { return; }
+
+    #if defined(ARMA_USE_CXX11)
+      {
+      std::lock_guard<std::mutex> lock( get_planner_mutex() );
+      
+      destroy_plan_locked<eT>(plan);
+      }
+    #elif defined(_OPENMP)
+      {
+      #pragma omp critical (arma_fftw3_planner)
+        {
+        destroy_plan_locked<eT>(plan);
+        }
+      }
+    #else
+      {
+      destroy_plan_locked<eT>(plan);
+      }
+    #endif
+    }
+  
+  
+  
+  //! in and out must have the same alignment as the arrays used for making the plan, unless the plan was made with the unaligned flag
+  template<typename eT>
+  inline
+  void
+  execute_dft(void* plan, const eT* in, eT* out)
+    {
+    arma_type_check(( is_supported_complex<eT>::value == false ));
+    
+    // plans made with the preserve_input flag do not modify the input
+    eT* in_rw = const_cast<eT*>(in);
+    
+    if(is_supported_complex_float<eT>::value)
+      {
+      typedef float (*T)[2];
+      arma_wrapper(fftwf_execute_dft)( (::fftwf_plan_s*)plan, (T)in_rw, (T)out );
+      }
+    else
+    if(is_supported_complex_double<eT>::value)
+      {
+      typedef double (*T)[2];
+      arma_wrapper(fftw_execute_dft)( (::fftw_plan_s*)plan, (T)in_rw, (T)out );
+      }
+    }
+  
+  
+  
+  //! true if the given memory has the alignment preferred by FFTW3 (eg. for SIMD instructions)
+  template<typename eT>
+  inline
+  bool
+  is_aligned(const eT* mem)
+    {
+    arma_type_check(( is_supported_complex<eT>::value == false ));
+    
+    typedef typename get_pod_type<eT>::result T;
+    
+    T* mem_rw = (T*)( const_cast<eT*>(mem) );
+    
+    if(is_supported_complex_float<eT>::value)
+      {
+      return (arma_wrapper(fftwf_alignment_of)( (float*)mem_rw ) == 0);
+      }
+    else
+    if(is_supported_complex_double<eT>::value)
+      {
+      return (arma_wrapper(fftw_alignment_of)( (double*)mem_rw ) == 0);
+      }
+    
+    return false;
+    }
+  
+  
+  
+  template<typename eT>
+  inline
+  eT*
+  acquire(const uword n_elem)
+    {
+    arma_type_check(( is_supported_complex<eT>::value == false ));
+    
+    if(is_supported_complex_float<eT>::value)
+      {
+      return (eT*)( arma_wrapper(fftwf_malloc)( sizeof(eT)*size_t(n_elem) ) );
+      }
+    else
+    if(is_supported_complex_double<eT>::value)
+      {
+      return (eT*)( arma_wrapper(fftw_malloc)( sizeof(eT)*size_t(n_elem) ) );
+      }
+    
+    return NULL;
+    }
+  
+  
+  
+  template<typename eT>
+  inline
+  void
+  release(eT* mem)
+    {
+    arma_type_check(( is_supported_complex<eT>::value == false ));
+    
+    if(mem == NULL)  { return; }
+    
+    if(is_supported_complex_float<eT>::value)
+      {
+      arma_wrapper(fftwf_free)( (void*)mem );
+      }
+    else
+    if(is_supported_complex_double<eT>::value)
+      {
+      arma_wrapper(fftw_free)( (void*)mem );
+      }
+    }
+  
+  
+  
+  template<typename eT>
+  inline
+  bool
+  wisdom_locked(const char* filename, const bool save)
+    {
+    int status = 0;
+    
+    if(is_supported_complex_float<eT>::value)
+      {
+      status = (save) ? arma_wrapper(fftwf_export_wisdom_to_filename)(filename) : arma_wrapper(fftwf_import_wisdom_from_filename)(filename);
+      }
+    else
+    if(is_supported_complex_double<eT>::value)
+      {
+      status = (save) ? arma_wrapper(fftw_export_wisdom_to_filename)(filename) : arma_wrapper(fftw_import_wisdom_from_filename)(filename);
+      }
+    
+    return (status != 0);
+    }
+  
+  
+  
+  //! import (save = false) or export (save = true) the FFTW3 wisdom for the precision of eT
+  template<typename eT>
+  inline
+  bool
+  wisdom(const char* filename, const bool save)
+    {
+    arma_type_check(( is_supported_complex<eT>::value == false ));
+    
+    bool status = false;
+
+    #if defined(ARMA_USE_CXX11)
+      {
+      std::lock_guard<std::mutex> lock( get_planner_mutex() );
+      
+      status = wisdom_locked<eT>(filename, save);
+      }
+    #elif defined(_OPENMP)
+      {
+      #pragma omp critical (arma_fftw3_planner)
+        {
+        status = wisdom_locked<eT>(filename, save);
+        }
+      }
+    #else
+      {
+      status = wisdom_locked<eT>(filename, save);
+      }
+    #endif
+    
+    return status;
+    }
+  
+  } // namespace fftw3
+
+#endif
@@ -25,6 +25,11 @@
 #include "armadillo_bits/typedef_elem.hpp"
 #include "armadillo_bits/include_atlas.hpp"
 #include "armadillo_bits/include_superlu.hpp"
+#include "armadillo_bits/include_fftw3.hpp"
+
+#if defined(ARMA_USE_FFTW3)
+  #include <fftw3.h>
+#endif
 
 
 #if defined(ARMA_USE_EXTERN_CXX11_RNG)
@@ -59,6 +64,7 @@ namespace arma
 #include "armadillo_bits/def_lapack.hpp"
 #include "armadillo_bits/def_arpack.hpp"
 #include "armadillo_bits/def_superlu.hpp"
+#include "armadillo_bits/def_fftw3.hpp"
 // no need to include def_hdf5.hpp -- it only contains #defines for when ARMA_USE_HDF5_ALT is not defined.
 
 
@@ -1146,6 +1152,106 @@ extern "C"
   
   
   
+  #if defined(ARMA_USE_FFTW3)
+    
+    ::fftw_plan_s* wrapper_fftw_plan_dft_1d(int n, double (*in)[2], double (*out)[2], int sign, unsigned flags)
+      {
+      return fftw_plan_dft_1d(n, in, out, sign, flags);
+      }
+    
+    ::fftwf_plan_s* wrapper_fftwf_plan_dft_1d(int n, float (*in)[2], float (*out)[2], int sign, unsigned flags)
+      {
+      return fftwf_plan_dft_1d(n, in, out, sign, flags);
+      }
+    
+    
+    
+    void wrapper_fftw_execute_dft(::fftw_plan_s* p, double (*in)[2], double (*out)[2])
+      {
+      fftw_execute_dft(p, in, out);
+      }
+    
+    void wrapper_fftwf_execute_dft(::fftwf_plan_s* p, float (*in)[2], float (*out)[2])
+      {
+      fftwf_execute_dft(p, in, out);
+      }
+    
+    
+    
+    void wrapper_fftw_destroy_plan(::fftw_plan_s* p)
+      {
+      fftw_destroy_plan(p);
+      }
+    
+    void wrapper_fftwf_destroy_plan(::fftwf_plan_s* p)
+      {
+      fftwf_destroy_plan(p);
+      }
+    
+    
+    
+    int wrapper_fftw_alignment_of(double* p)
+      {
+      return fftw_alignment_of(p);
+      }
+    
+    int wrapper_fftwf_alignment_of(float* p)
+      {
+      return fftwf_alignment_of(p);
+      }
+    
+    
+    
+    void* wrapper_fftw_malloc(size_t n)
+      {
+      return fftw_malloc(n);
+      }
+    
+    void* wrapper_fftwf_malloc(size_t n)
+      {
+      return fftwf_malloc(n);
+      }
+    
+    
+    
+    void wrapper_fftw_free(void* p)
+      {
+      fftw_free(p);
+      }
+    
+    void wrapper_fftwf_free(void* p)
+      {
+      fftwf_free(p);
+      }
+    
+    
+    
+    int wrapper_fftw_import_wisdom_from_filename(const char* filename)
+      {
+      return fftw_import_wisdom_from_filename(filename);
+      }
+    
+    int wrapper_fftwf_import_wisdom_from_filename(const char* filename)
+      {
+      return fftwf_import_wisdom_from_filename(filename);
+      }
+    
+    
+    
+    int wrapper_fftw_export_wisdom_to_filename(const char* filename)
+      {
+      return fftw_export_wisdom_to_filename(filename);
+      }
+    
+    int wrapper_fftwf_export_wisdom_to_filename(const char* filename)
+      {
+      return fftwf_export_wisdom_to_filename(filename);
+      }
+    
+  #endif
+  
+  
+  
   #if defined(ARMA_USE_HDF5_ALT)
   
     hid_t arma_H5Tcopy(hid_t dtype_id)
@@ -30,3 +30,181 @@ TEST_CASE("decomp_fft_1")
   
   // REQUIRE_THROWS(  );
   }
+
+
+
+TEST_CASE("decomp_fft_plan_1")
+  {
+  mat    A = randu<mat>(12, 5);
+  cx_mat B = randu<cx_mat>(12, 5);
+  cx_vec v = randu<cx_vec>(7);
+  
+  const fft_plan<cx_double> plan_12(12);
+  const fft_plan<cx_double> plan_16(16);
+  const fft_plan<cx_double> plan_12_inv(12, true);
+  
+  REQUIRE( accu(abs( plan_12(A)     - fft(A)      )) == Approx(0.0) );
+  REQUIRE( accu(abs( plan_12(B)     - fft(B)      )) == Approx(0.0) );
+  REQUIRE( accu(abs( plan_16(B)     - fft(B, 16)  )) == Approx(0.0) );
+  REQUIRE( accu(abs( plan_16(v)     - fft(v, 16)  )) == Approx(0.0) );
+  REQUIRE( accu(abs( plan_12_inv(B) - ifft(B)     )) == Approx(0.0) );
+  
+  REQUIRE( accu(abs( plan_12_inv(plan_12(B)) - B )) == Approx(0.0) );
+  
+  // copies share the coefficients of the original plan
+  fft_plan<cx_double> plan_copy(1);
+  
+  plan_copy = plan_16;
+  
+  cx_mat C;
+  
+  plan_copy.apply(C, B);
+  
+  REQUIRE( C.n_rows == 16 );
+  REQUIRE( accu(abs( C - fft(B, 16) )) == Approx(0.0) );
+  
+  // the output can alias the input
+  C = B;
+  
+  plan_12.apply(C, C);
+  
+  REQUIRE( accu(abs( C - fft(B) )) == Approx(0.0) );
+  }
+
+
+
+TEST_CASE("decomp_fft_plan_cache_1")
+  {
+  typedef fft_engine_type<cx_double,false>::result engine_type;
+  typedef fft_engine_cache<engine_type>            cache_type;
+  
+  // prime lengths use Bluestein's algorithm, so each engine holds several buffers of 2^k elements
+  const uword N_first = 65521;
+  
+  cx_vec v = randu<cx_vec>(N_first);
+  
+  cx_vec ref_first;
+  
+    {
+    const fft_plan<cx_double> plan_first(N_first);
+    
+    ref_first = plan_first(v);
+    }
+  
+  const uword n_entries_first = cache_type::n_entries();
+  
+  REQUIRE( n_entries_first >= 1 );
+  
+  // fill the cache past its cap
+  uword N = N_first;
+  
+  for(uword i=0; i < 64; ++i)
+    {
+    N -= 2;
+    
+    const fft_plan<cx_double> plan(N);
+    
+    REQUIRE( cache_type::n_bytes() <= cache_type::max_bytes );
+    }
+  
+  REQUIRE( cache_type::n_entries() < n_entries_first + 64 );
+  
+  // the first engine was the least recently used, so it was evicted and is built again
+  const fft_plan<cx_double> plan_again(N_first);
+  
+  REQUIRE( accu(abs( plan_again(v) - ref_first )) == Approx(0.0) );
+  REQUIRE( accu(abs( plan_again(v) - fft(v)    )) == Approx(0.0) );
+  
+  // engines for lengths above max_N are not cached
+  const uword n_entries_before = cache_type::n_entries();
+  
+  cx_vec w = randu<cx_vec>(cache_type::max_N + 1);
+  
+    {
+    const fft_plan<cx_double> plan_large(w.n_elem);
+    
+    REQUIRE( accu(abs( plan_large(w) - fft(w) )) == Approx(0.0).epsilon(1e-8) );
+    }
+  
+  REQUIRE( cache_type::n_entries() == n_entries_before );
+  }
+
+
+
+TEST_CASE("decomp_fft_2")
+  {
+  // lengths covering the passes of radix 2, 4, 8, 16, 3, 5 and generic radix, as well as Bluestein's algorithm
+  const uword lengths[] = { 1, 2, 4, 8, 16, 32, 128, 1024, 12, 45, 49, 77, 97, 134, 1009 };
+  
+  for(uword i=0; i < sizeof(lengths)/sizeof(uword); ++i)
+    {
+    const uword N = lengths[i];
+    
+    cx_mat W(N, N);
+    
+    for(uword k=0; k < N; ++k)
+    for(uword n=0; n < N; ++n)
+      {
+      const double angle = -2.0 * Datum<double>::pi * double((k*n) % N) / double(N);
+      
+      W(k,n) = cx_double( std::cos(angle), std::sin(angle) );
+      }
+    
+    const cx_vec x = randu<cx_vec>(N);
+    const cx_vec y = W * x;
+    
+    REQUIRE( norm(fft(x) - y) / norm(y) < 1e-12 );
+    
+    REQUIRE( norm(ifft(y) - x) / norm(x) < 1e-12 );
+    
+    const cx_fvec xf = conv_to<cx_fvec>::from(x);
+    const cx_fvec yf = fft(xf);
+    
+    REQUIRE( norm(conv_to<cx_vec>::from(yf) - y) / norm(y) < 1e-5 );
+    }
+  }
+
+
+
+TEST_CASE("decomp_rfft_1")
+  {
+  const uword lengths[] = { 1, 2, 3, 8, 12, 45, 64, 97, 1000 };
+  
+  for(uword i=0; i < sizeof(lengths)/sizeof(uword); ++i)
+    {
+    const uword N = lengths[i];
+    
+    const vec x = randu<vec>(N) - 0.5;
+    
+    const cx_vec y = fft( conv_to<cx_vec>::from(x) );
+    
+    const cx_vec h = rfft(x);
+    
+    REQUIRE( h.n_elem == (N/2 + 1) );
+    
+    REQUIRE( norm(h - y.head(N/2 + 1)) / norm(y) < 1e-12 );
+    
+    REQUIRE( norm(fft(x) - y) / norm(y) < 1e-12 );
+    
+    REQUIRE( norm(irfft(h, N) - x) / norm(x) < 1e-12 );
+    }
+  
+  mat A = randu<mat>(10,4);
+  
+  cx_mat B = rfft(A);
+  
+  REQUIRE( B.n_rows == 6 );
+  REQUIRE( B.n_cols == 4 );
+  
+  REQUIRE( accu(abs(B - cx_mat(fft(A)).head_rows(6))) == Approx(0.0) );
+  
+  REQUIRE( accu(abs(irfft(B) - A)) == Approx(0.0) );
+  
+  rowvec r = randu<rowvec>(9);
+  
+  cx_rowvec s = rfft(r, 16);
+  
+  REQUIRE( s.n_elem == 9 );
+  
+  REQUIRE( accu(abs(s - cx_rowvec(fft(r, 16)).head(9))) == Approx(0.0) );
+  }
@@ -30,3 +30,64 @@ TEST_CASE("decomp_fft2_1")
   
   // REQUIRE_THROWS(  );
   }
+
+
+
+TEST_CASE("decomp_rfft2_1")
+  {
+  const mat A = randu<mat>(6,5);
+  const mat B = randu<mat>(7,4);
+  
+  const cx_mat FA = fft2( conv_to<cx_mat>::from(A) );
+  const cx_mat FB = fft2( conv_to<cx_mat>::from(B) );
+  
+  REQUIRE( accu(abs(fft2(A) - FA)) == Approx(0.0) );
+  REQUIRE( accu(abs(fft2(B) - FB)) == Approx(0.0) );
+  
+  const cx_mat RA = rfft2(A);
+  const cx_mat RB = rfft2(B);
+  
+  REQUIRE( RA.n_rows == 4 );
+  REQUIRE( RB.n_rows == 4 );
+  
+  REQUIRE( accu(abs(RA - FA.head_rows(4))) == Approx(0.0) );
+  REQUIRE( accu(abs(RB - FB.head_rows(4))) == Approx(0.0) );
+  
+  REQUIRE( accu(abs(irfft2(RA) - A)) == Approx(0.0) );
+  
+  REQUIRE( accu(abs(irfft2(RB, 7, 4) - B)) == Approx(0.0) );
+  }
+
+
+
+TEST_CASE("decomp_fft2_2")
+  {
+  // the 2D transform of a vector is the 1D transform
+  const cx_rowvec r = randu<cx_rowvec>(12);
+  const cx_colvec c = randu<cx_colvec>(10);
+  
+  REQUIRE( accu(abs(fft2(r) - fft(r))) == Approx(0.0) );
+  REQUIRE( accu(abs(fft2(c) - fft(c))) == Approx(0.0) );
+  
+  REQUIRE( accu(abs(ifft2(fft2(r)) - r)) == Approx(0.0) );
+  
+  // large enough to use the blocked transpose and several threads
+  const cx_mat A = randu<cx_mat>(520,516);
+  
+  const cx_mat B = fft2(A);
+  
+  const cx_mat C = strans( fft( strans( fft(A) ) ) );
+  
+  REQUIRE( norm(B - C, "fro") / norm(C, "fro") < 1e-12 );
+  
+  REQUIRE( norm(ifft2(B) - A, "fro") / norm(A, "fro") < 1e-12 );
+  
+  const cx_mat D = fft(A);
+  
+  for(uword col=0; col < A.n_cols; col += 101)
+    {
+    const cx_vec x = A.col(col);
+    
+    REQUIRE( norm(fft(x) - D.col(col)) / norm(D.col(col)) < 1e-12 );
+    }
+  }
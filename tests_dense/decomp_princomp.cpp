@@ -30,3 +30,121 @@ TEST_CASE("decomp_princomp_1")
   
   // REQUIRE_THROWS(  );
   }
+
+
+
+TEST_CASE("decomp_princomp_2")
+  {
+  arma_rng::set_seed(123);
+  
+  const uword N = 2000;
+  const uword d = 100;
+  const uword k = 4;
+  
+  const vec scales = { 10.0, 8.0, 6.0, 4.0, 3.0, 2.0 };
+  
+  mat A = randn<mat>(N, scales.n_elem) * diagmat(scales) * randn<mat>(scales.n_elem, d) + 0.1 * randn<mat>(N, d);
+  
+  A += 5.0;
+  
+  mat coeff_full;
+  mat score_full;
+  vec latent_full;
+  
+  REQUIRE( princomp(coeff_full, score_full, latent_full, A) == true );
+  
+  mat coeff;
+  mat score;
+  vec latent;
+  
+  REQUIRE( princomp(coeff, score, latent, A, k) == true );
+  
+  REQUIRE( coeff.n_rows  == d );
+  REQUIRE( coeff.n_cols  == k );
+  REQUIRE( score.n_rows  == N );
+  REQUIRE( score.n_cols  == k );
+  REQUIRE( latent.n_elem == k );
+  
+  for(uword i=0; i < k; ++i)
+    {
+    REQUIRE( latent(i) == Approx(latent_full(i)) );
+    
+    REQUIRE( std::abs( dot(coeff.col(i), coeff_full.col(i)) ) == Approx(1.0) );
+    }
+  
+  REQUIRE( accu(abs( abs(score) - abs(score_full.cols(0,k-1)) )) / accu(abs(score)) == Approx(0.0).epsilon(1e-6) );
+  
+  // sparse input gives the same result as dense input
+  
+  sp_mat B = sprandu<sp_mat>(N, d, 0.05);
+  
+  B.col(3) *= 20.0;
+  B.col(7) *= 10.0;
+  
+  arma_rng::set_seed(456);
+  
+  mat coeff_sp;
+  mat score_sp;
+  vec latent_sp;
+  
+  REQUIRE( princomp(coeff_sp, score_sp, latent_sp, B, k) == true );
+  
+  arma_rng::set_seed(456);
+  
+  REQUIRE( princomp(coeff, score, latent, mat(B), k) == true );
+  
+  REQUIRE( abs(coeff_sp  - coeff ).max() == Approx(0.0).epsilon(1e-8) );
+  REQUIRE( abs(score_sp  - score ).max() == Approx(0.0).epsilon(1e-8) );
+  REQUIRE( abs(latent_sp - latent).max() == Approx(0.0).epsilon(1e-8) );
+  
+  REQUIRE_THROWS( princomp(coeff, score, latent, A, d+1) );
+  }
+
+
+
+TEST_CASE("decomp_princomp_3")
+  {
+  arma_rng::set_seed(123);
+  
+  const uword N = 500;
+  const uword d = 20;
+  const uword k = 3;
+  
+  // data of rank k, so that the incremental result is exact
+  
+  mat A = randn<mat>(N, k) * randn<mat>(k, d);
+  
+  A.each_row() += linspace<rowvec>(1.0, 20.0, d);
+  
+  mat coeff_full;
+  mat score_full;
+  vec latent_full;
+  
+  REQUIRE( princomp(coeff_full, score_full, latent_full, A) == true );
+  
+  running_pca<double> pca(k);
+  
+  for(uword i=0; i < N; i += 50)  { pca( A.rows(i, i+49) ); }
+  
+  REQUIRE( pca.count() == N );
+  
+  REQUIRE( abs(pca.mean() - mean(A)).max() == Approx(0.0) );
+  
+  const vec latent = pca.latent();
+  
+  REQUIRE( pca.coeff().n_rows == d );
+  REQUIRE( pca.coeff().n_cols == k );
+  REQUIRE( latent.n_elem      == k );
+  
+  for(uword i=0; i < k; ++i)
+    {
+    REQUIRE( latent(i) == Approx(latent_full(i)) );
+    
+    REQUIRE( std::abs( dot(pca.coeff().col(i), coeff_full.col(i)) ) == Approx(1.0) );
+    }
+  
+  pca.reset();
+  
+  REQUIRE( pca.count()        == 0 );
+  REQUIRE( pca.coeff().n_elem == 0 );
+  }
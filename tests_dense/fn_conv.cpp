@@ -38,3 +38,298 @@ TEST_CASE("fn_conv_1")
   
   REQUIRE( accu(abs(c - d)) == Approx(0.0) );
   }
+
+
+
+TEST_CASE("fn_conv_2")
+  {
+  vec a = linspace<vec>(1,5,6);
+  vec b = 2*linspace<vec>(1,6,7);
+  
+  vec c = conv(a,b);
+  
+  vec c_same  = conv(a, b, "same");
+  vec c_valid = conv(b, a, "valid");
+  
+  REQUIRE( c_same.n_elem  == 6 );
+  REQUIRE( c_valid.n_elem == 2 );
+  
+  REQUIRE( accu(abs(c_same  - c.subvec(3, 8))) == Approx(0.0) );
+  REQUIRE( accu(abs(c_valid - c.subvec(5, 6))) == Approx(0.0) );
+  
+  vec c_empty = conv(a, b, "valid");
+  
+  REQUIRE( c_empty.n_elem == 0 );
+  
+  rowvec ar = a.t();
+  rowvec br = b.t();
+  
+  rowvec cr = conv(ar, br, "full", "fft");
+  
+  REQUIRE( cr.n_cols == 12 );
+  REQUIRE( accu(abs(cr - c.t())) == Approx(0.0) );
+  }
+
+
+
+TEST_CASE("fn_conv_3")
+  {
+  // long filters use the FFT based method
+  
+  vec x = randu<vec>(5000) - 0.5;
+  
+  for(uword h_n = 1; h_n <= 1024; h_n *= 4)
+    {
+    vec h = randu<vec>(h_n) - 0.5;
+    
+    for(uword s=0; s < 3; ++s)
+      {
+      const char* shape = (s == 0) ? "full" : ( (s == 1) ? "same" : "valid" );
+      
+      vec y_direct = conv(x, h, shape, "direct");
+      vec y_fft    = conv(x, h, shape, "fft");
+      vec y_auto   = conv(x, h, shape);
+      
+      REQUIRE( y_fft.n_elem  == y_direct.n_elem );
+      REQUIRE( y_auto.n_elem == y_direct.n_elem );
+      
+      REQUIRE( max(abs(y_fft  - y_direct)) == Approx(0.0).epsilon(1e-10) );
+      REQUIRE( max(abs(y_auto - y_direct)) == Approx(0.0).epsilon(1e-10) );
+      }
+    }
+  
+  cx_vec cx_x = randu<cx_vec>(300);
+  cx_vec cx_h = randu<cx_vec>(77);
+  
+  REQUIRE( max(abs(conv(cx_x, cx_h, "full", "fft") - conv(cx_x, cx_h, "full", "direct"))) == Approx(0.0).epsilon(1e-10) );
+  }
+
+
+
+TEST_CASE("fn_conv2_1")
+  {
+  mat A = randu<mat>(30,40) - 0.5;
+  mat B = randu<mat>(9,7)   - 0.5;
+  
+  mat C = conv2(A, B, "full", "direct");
+  
+  REQUIRE( C.n_rows == 38 );
+  REQUIRE( C.n_cols == 46 );
+  
+  REQUIRE( accu(abs(conv2(A, B, "full", "fft") - C)) == Approx(0.0).epsilon(1e-10) );
+  
+  mat C_same  = conv2(A, B, "same",  "fft");
+  mat C_valid = conv2(A, B, "valid", "fft");
+  
+  REQUIRE( C_same.n_rows  == 30 );
+  REQUIRE( C_same.n_cols  == 40 );
+  REQUIRE( C_valid.n_rows == 22 );
+  REQUIRE( C_valid.n_cols == 34 );
+  
+  REQUIRE( accu(abs(C_same  - C(4, 3, size(A))      )) == Approx(0.0).epsilon(1e-10) );
+  REQUIRE( accu(abs(C_valid - C(8, 6, size(C_valid)))) == Approx(0.0).epsilon(1e-10) );
+  
+  REQUIRE( accu(abs(conv2(A, B, "valid", "direct") - C_valid)) == Approx(0.0).epsilon(1e-10) );
+  
+  cx_mat cx_A = randu<cx_mat>(20,10);
+  cx_mat cx_B = randu<cx_mat>(5,6);
+  
+  REQUIRE( accu(abs(conv2(cx_A, cx_B, "full", "fft") - conv2(cx_A, cx_B, "full", "direct"))) == Approx(0.0).epsilon(1e-10) );
+  }
+
+
+
+TEST_CASE("fn_conv2_2")
+  {
+  // separable filters, given explicitly or detected, give the same result as the FFT based method
+  
+  mat A = randu<mat>(35,27) - 0.5;
+  
+  vec u = randu<vec>(5) - 0.5;
+  rowvec v = randu<rowvec>(4) - 0.5;
+  
+  mat B = u * v;
+  
+  for(uword s=0; s < 3; ++s)
+    {
+    const char* shape = (s == 0) ? "full" : ( (s == 1) ? "same" : "valid" );
+    
+    mat C_fft  = conv2(A, B, shape, "fft");
+    mat C_auto = conv2(A, B, shape);
+    mat C_flip = conv2(B, A, shape, "direct");
+    mat C_uv   = conv2(u, v, A, shape);
+    
+    REQUIRE( C_auto.n_rows == C_fft.n_rows );
+    REQUIRE( C_auto.n_cols == C_fft.n_cols );
+    REQUIRE( C_uv.n_rows   == C_fft.n_rows );
+    REQUIRE( C_uv.n_cols   == C_fft.n_cols );
+    
+    REQUIRE( accu(abs(C_auto - C_fft)) == Approx(0.0).epsilon(1e-10) );
+    REQUIRE( accu(abs(C_uv   - C_fft)) == Approx(0.0).epsilon(1e-10) );
+    
+    REQUIRE( accu(abs(C_flip - conv2(B, A, shape, "fft"))) == Approx(0.0).epsilon(1e-10) );
+    }
+  
+  // integer elements use the direct method
+  
+  imat iA = randi<imat>(10, 12, distr_param(-5,5));
+  imat iB = { {1, 2, 1}, {2, 4, 2}, {1, 2, 1} };
+  
+  REQUIRE( accu(abs(conv2(iA, iB) - conv_to<imat>::from(round(conv2(conv_to<mat>::from(iA), conv_to<mat>::from(iB), "full", "fft"))))) == 0 );
+  }
+
+
+
+TEST_CASE("fn_xcorr2_1")
+  {
+  cx_mat A = randu<cx_mat>(12,9);
+  cx_mat B = randu<cx_mat>(4,3);
+  
+  cx_mat C = xcorr2(A, B);
+  
+  REQUIRE( C.n_rows == 15 );
+  REQUIRE( C.n_cols == 11 );
+  
+  // C(r,c) = sum of A(i,j) * conj(B(i - r + B.n_rows - 1, j - c + B.n_cols - 1))
+  
+  cx_double acc = 0;
+  
+  for(uword j=0; j < 3; ++j)
+  for(uword i=0; i < 4; ++i)
+    {
+    acc += A(i,j) * std::conj(B(i,j));
+    }
+  
+  REQUIRE( std::abs(C(3,2) - acc) == Approx(0.0).epsilon(1e-10) );
+  
+  // cubes are processed slice by slice
+  
+  cube Q = randu<cube>(20,15,3);
+  mat  K = randu<mat>(3,3);
+  
+  cube R = conv2(Q, K, "same");
+  cube S = xcorr2(Q, K, "valid");
+  
+  REQUIRE( R.n_slices == 3 );
+  REQUIRE( S.n_rows   == 18 );
+  
+  for(uword s=0; s < Q.n_slices; ++s)
+    {
+    mat R_s = conv2(Q.slice(s), K, "same");
+    mat S_s = xcorr2(Q.slice(s), K, "valid");
+    
+    REQUIRE( accu(abs(R.slice(s) - R_s)) == Approx(0.0) );
+    REQUIRE( accu(abs(S.slice(s) - S_s)) == Approx(0.0) );
+    }
+  }
+
+
+
+TEST_CASE("fn_conv_fir_filter")
+  {
+  // filtering a signal block by block gives the start of its full convolution
+  
+  vec x = randu<vec>(3000) - 0.5;
+  
+  const uword h_n_list[]   = { 1, 5, 100, 700 };
+  const uword block_list[] = { 1, 37, 1000 };
+  
+  for(uword i=0; i < 4; ++i)
+    {
+    vec h = randu<vec>(h_n_list[i]) - 0.5;
+    
+    vec y_ref = conv(x, h, "full", "direct");
+    
+    for(uword m=0; m < 3; ++m)
+      {
+      const char* method = (m == 0) ? "auto" : ( (m == 1) ? "direct" : "fft" );
+      
+      fir_filter<double> F(h, method);
+      
+      vec y(x.n_elem);
+      vec y_block;
+      
+      for(uword b=0; b < 3; ++b)
+        {
+        F.reset();
+        
+        for(uword start=0; start < x.n_elem; start += block_list[b])
+          {
+          const uword end = (std::min)(start + block_list[b], x.n_elem) - 1;
+          
+          F.apply(y_block, x.subvec(start, end));
+          
+          y.subvec(start, end) = y_block;
+          }
+        
+        REQUIRE( max(abs(y - y_ref.head(x.n_elem))) == Approx(0.0).epsilon(1e-10) );
+        }
+      }
+    }
+  
+  cx_vec cx_x = randu<cx_vec>(500);
+  cx_vec cx_h = randu<cx_vec>(90);
+  
+  fir_filter<cx_double> G(cx_h, "fft");
+  
+  cx_vec cx_y1  = G(cx_x.head(123));
+  cx_vec cx_y2  = G(cx_x.tail(377));
+  cx_vec cx_y   = join_cols(cx_y1, cx_y2);
+  cx_vec cx_ref = conv(cx_x, cx_h);
+  
+  REQUIRE( max(abs(cx_y - cx_ref.head(500))) == Approx(0.0).epsilon(1e-10) );
+  }
+
+
+
+// not run by default; run with: ./main "[.benchmark]"
+TEST_CASE("fn_conv_crossover", "[.benchmark]")
+  {
+  wall_clock timer;
+  
+  vec x = randu<vec>(200000);
+  
+  std::cout << "conv(): signal length " << x.n_elem << '\n';
+  std::cout << "filter_length  direct_ms  fft_ms  auto_method\n";
+  
+  for(uword h_n = 16; h_n <= 4096; h_n *= 2)
+    {
+    vec h = randu<vec>(h_n);
+    
+    timer.tic();
+    vec y_direct = conv(x, h, "full", "direct");
+    const double t_direct = timer.toc();
+    
+    timer.tic();
+    vec y_fft = conv(x, h, "full", "fft");
+    const double t_fft = timer.toc();
+    
+    REQUIRE( max(abs(y_fft - y_direct)) == Approx(0.0).epsilon(1e-8) );
+    
+    std::cout << h_n << "  " << 1e3*t_direct << "  " << 1e3*t_fft << "  "
+              << ( glue_conv::use_fft<double>(h_n, x.n_elem) ? "fft" : "direct" ) << '\n';
+    }
+  
+  mat A = randu<mat>(512,512);
+  
+  std::cout << "conv2(): image size 512x512\n";
+  std::cout << "filter_size  direct_ms  fft_ms  auto_method\n";
+  
+  for(uword k = 3; k <= 33; k += 6)
+    {
+    mat B = randu<mat>(k,k);
+    
+    timer.tic();
+    mat C_direct = conv2(A, B, "full", "direct");
+    const double t_direct = timer.toc();
+    
+    timer.tic();
+    mat C_fft = conv2(A, B, "full", "fft");
+    const double t_fft = timer.toc();
+    
+    REQUIRE( abs(C_fft - C_direct).max() == Approx(0.0).epsilon(1e-8) );
+    
+    std::cout << k << "x" << k << "  " << 1e3*t_direct << "  " << 1e3*t_fft << "  "
+              << ( glue_conv2::use_fft(B, A) ? "fft" : "direct" ) << '\n';
+    }
+  }
@@ -67,3 +67,79 @@ TEST_CASE("fn_cov_2")
   REQUIRE( accu(abs(cov(A,B) - AB)) == Approx(0.0) );
   REQUIRE( accu(abs(cov(A,C) - AC)) == Approx(0.0) );
   }
+
+
+
+TEST_CASE("fn_cov_3")
+  {
+  arma_rng::set_seed(123);
+  
+  // several blocks of rows, and a large offset relative to the spread of the values
+  
+  mat A = randn<mat>(5000, 100);
+  mat B = randn<mat>(5000,  30);
+  
+  A += 1e6;
+  B.col(0) += 0.5 * A.col(0);
+  
+  const mat A_c = A.each_row() - mean(A);
+  const mat B_c = B.each_row() - mean(B);
+  
+  const mat AA = (trans(A_c) * A_c) / 4999.0;
+  const mat AB = (trans(A_c) * B_c) / 4999.0;
+  
+  REQUIRE( abs(cov(A)    - AA).max() < 1e-10 );
+  REQUIRE( abs(cov(A, B) - AB).max() < 1e-10 );
+  
+  REQUIRE( abs(cov(A, 1) - AA * (4999.0/5000.0)).max() < 1e-10 );
+  
+  const vec sd_A = sqrt(AA.diag());
+  
+  REQUIRE( abs(cor(A) - AA / (sd_A * trans(sd_A))).max() < 1e-10 );
+  
+  REQUIRE( abs(cor(A, B) - AB / (trans(stddev(A)) * stddev(B))).max() < 1e-10 );
+  
+  // complex numbers
+  
+  const cx_mat C = randn<cx_mat>(3000, 20);
+  
+  const cx_mat C_c = C.each_row() - mean(C);
+  
+  REQUIRE( abs(cov(C) - (trans(C_c) * C_c) / 2999.0).max() < 1e-10 );
+  }
+
+
+
+TEST_CASE("fn_cov_4")
+  {
+  arma_rng::set_seed(123);
+  
+  // weighted covariance matrix, normalised by the sum of the weights
+  
+  mat A = randn<mat>(5000, 40);
+  
+  A += 1e3;
+  A.col(1) += 0.5 * A.col(0);
+  
+  const vec W = randu<vec>(5000);
+  
+  const rowvec mu  = sum(A.each_col() % W) / accu(W);
+  const mat    A_c = A.each_row() - mu;
+  
+  const mat ref = (trans(A_c) * (A_c.each_col() % W)) / accu(W);
+  
+  REQUIRE( abs(cov_weighted(A, W) - ref).max() < 1e-10 );
+  
+  REQUIRE( abs(cov_weighted(A, ones<vec>(5000)) - cov(A, 1)).max() < 1e-10 );
+  
+  // a vector is a set of scalar observations
+  
+  const vec a = A.col(0);
+  
+  REQUIRE( as_scalar(cov_weighted(a, W)) == Approx(ref(0,0)) );
+  
+  mat out;
+  
+  REQUIRE_THROWS( out = cov_weighted(A, W.subvec(0, 9)) );
+  REQUIRE_THROWS( out = cov_weighted(A, -W) );
+  }
@@ -30,3 +30,100 @@ TEST_CASE("fn_hist_1")
   
   // REQUIRE_THROWS(  );
   }
+
+
+
+// nearest center, with ties going to the lower index
+static
+uword
+ref_hist_index(const double val, const vec& C)
+  {
+  if(val == -Datum<double>::inf)  { return 0;          }
+  if(val == +Datum<double>::inf)  { return C.n_elem-1; }
+  
+  uword opt_index = 0;
+  
+  for(uword j=1; j < C.n_elem; ++j)
+    {
+    if(std::abs(C(j) - val) < std::abs(C(opt_index) - val))  { opt_index = j; }
+    }
+  
+  return opt_index;
+  }
+
+
+
+TEST_CASE("fn_hist_2")
+  {
+  arma_rng::set_seed(123);
+  
+  mat X = 4.0 * randn<mat>(20000, 3);
+  
+  X(0,0) = Datum<double>::nan;
+  X(1,0) = +Datum<double>::inf;
+  X(2,0) = -Datum<double>::inf;
+  X(3,0) = 0.5;  // exactly between two centers
+  
+  const vec C1 = linspace<vec>(-10.0, 10.0, 21);          // uniformly spaced
+  const vec C2 = { -8.0, -3.0, -2.5, 0.0, 1.0, 7.0 };     // sorted, not uniform
+  
+  for(uword c=0; c < 2; ++c)
+    {
+    const vec& C = (c == 0) ? C1 : C2;
+    
+    umat ref(C.n_elem, X.n_cols, fill::zeros);
+    
+    for(uword col=0; col < X.n_cols; ++col)
+    for(uword row=0; row < X.n_rows; ++row)
+      {
+      const double val = X(row,col);
+      
+      if(arma_isnan(val) == false)  { ref( ref_hist_index(val, C), col )++; }
+      }
+    
+    const umat H0 = hist(X, C, 0);
+    const umat H1 = hist(X.t(), C, 1);
+    
+    REQUIRE( accu(H0 != ref)     == 0 );
+    REQUIRE( accu(H1 != ref.t()) == 0 );
+    
+    const uvec h = hist(vec(X.col(0)), C);
+    
+    REQUIRE( accu(h != ref.col(0)) == 0 );
+    }
+  
+  REQUIRE( uvec(hist(X.col(1), 20)).n_elem == 20        );
+  REQUIRE( accu(hist(X.col(1), 20))        == X.n_rows  );
+  }
+
+
+
+TEST_CASE("fn_hist2_1")
+  {
+  arma_rng::set_seed(123);
+  
+  const vec X = randn<vec>(30000);
+  const vec Y = X + 0.5 * randn<vec>(30000);
+  
+  const vec CX = linspace<vec>(-3.0, 3.0, 13);
+  const vec CY = { -2.0, -1.0, 0.0, 0.5, 1.0, 3.0 };
+  
+  const umat H = hist2(X, Y, CX, CY);
+  
+  REQUIRE( H.n_rows == CX.n_elem );
+  REQUIRE( H.n_cols == CY.n_elem );
+  
+  umat ref(CX.n_elem, CY.n_elem, fill::zeros);
+  
+  for(uword i=0; i < X.n_elem; ++i)  { ref( ref_hist_index(X(i), CX), ref_hist_index(Y(i), CY) )++; }
+  
+  REQUIRE( accu(H != ref) == 0 );
+  
+  REQUIRE( accu(H) == X.n_elem );
+  
+  // the marginals are the 1D histograms
+  
+  REQUIRE( accu(umat(sum(H,1)) != umat(hist(X,CX))) == 0 );
+  
+  REQUIRE_THROWS( hist2(X, Y.head(10), CX, CY) );
+  }
@@ -30,3 +30,93 @@ TEST_CASE("fn_histc_1")
   
   // REQUIRE_THROWS(  );
   }
+
+
+
+// bin i covers [E(i), E(i+1)), and the last bin counts values equal to the last edge
+static
+uword
+ref_histc_index(const double x, const vec& E)
+  {
+  for(uword i=0; i+1 < E.n_elem; ++i)
+    {
+    if( (E(i) <= x) && (x < E(i+1)) )  { return i; }
+    }
+  
+  return (x == E(E.n_elem-1)) ? (E.n_elem-1) : E.n_elem;
+  }
+
+
+
+TEST_CASE("fn_histc_2")
+  {
+  arma_rng::set_seed(123);
+  
+  mat X = 4.0 * randn<mat>(20000, 3);
+  
+  X(0,0) = Datum<double>::nan;
+  X(1,0) = +Datum<double>::inf;
+  X(2,0) = -Datum<double>::inf;
+  X(3,0) = 10.0;  // last edge
+  X(4,0) = -2.0;  // inner edge
+  
+  const vec E1 = linspace<vec>(-10.0, 10.0, 21);          // uniformly spaced
+  const vec E2 = { -8.0, -3.0, -2.0, -2.0, 0.0, 10.0 };   // sorted, not uniform, with a repeated edge
+  
+  for(uword e=0; e < 2; ++e)
+    {
+    const vec& E = (e == 0) ? E1 : E2;
+    
+    umat ref(E.n_elem, X.n_cols, fill::zeros);
+    
+    for(uword col=0; col < X.n_cols; ++col)
+    for(uword row=0; row < X.n_rows; ++row)
+      {
+      const uword index = ref_histc_index(X(row,col), E);
+      
+      if(index < E.n_elem)  { ref(index, col)++; }
+      }
+    
+    const umat H0 = histc(X, E, 0);
+    const umat H1 = histc(X.t(), E, 1);
+    
+    REQUIRE( accu(H0 != ref)     == 0 );
+    REQUIRE( accu(H1 != ref.t()) == 0 );
+    
+    const uvec h = histc(vec(X.col(0)), E);
+    
+    REQUIRE( accu(h != ref.col(0)) == 0 );
+    }
+  }
+
+
+
+TEST_CASE("fn_histc2_1")
+  {
+  arma_rng::set_seed(123);
+  
+  const vec X = randn<vec>(30000);
+  const vec Y = X + 0.5 * randn<vec>(30000);
+  
+  const vec EX = linspace<vec>(-3.0, 3.0, 13);
+  const vec EY = { -2.0, -1.0, 0.0, 0.5, 1.0, 3.0 };
+  
+  const umat H = histc2(X, Y, EX, EY);
+  
+  REQUIRE( H.n_rows == EX.n_elem );
+  REQUIRE( H.n_cols == EY.n_elem );
+  
+  umat ref(EX.n_elem, EY.n_elem, fill::zeros);
+  
+  for(uword i=0; i < X.n_elem; ++i)
+    {
+    const uword index_x = ref_histc_index(X(i), EX);
+    const uword index_y = ref_histc_index(Y(i), EY);
+    
+    if( (index_x < EX.n_elem) && (index_y < EY.n_elem) )  { ref(index_x, index_y)++; }
+    }
+  
+  REQUIRE( accu(H != ref) == 0 );
+  
+  REQUIRE_THROWS( histc2(X, Y.head(10), EX, EY) );
+  }
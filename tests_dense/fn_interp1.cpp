@@ -45,3 +45,118 @@ TEST_CASE("fn_interp1_1")
   
   // REQUIRE_THROWS(  );
   }
+
+
+
+TEST_CASE("fn_interp1_2")
+  {
+  // queries in any order, and each of the methods, give the same results as ascending queries
+  
+  vec x = sort( randu<vec>(50) ) * 10.0;
+  vec y = sin(x);
+  
+  vec xi = linspace<vec>(x.min() - 1.0, x.max() + 1.0, 1000);
+  
+  uvec shuffled = shuffle( linspace<uvec>(0, xi.n_elem-1, xi.n_elem) );
+  
+  vec xi_shuffled = xi.elem(shuffled);
+  
+  const char* methods[] = { "nearest", "linear", "pchip", "spline", "*linear", "*spline" };
+  
+  for(uword m=0; m < 6; ++m)
+    {
+    vec yi;
+    vec yi_shuffled;
+    
+    interp1(x, y, xi,          yi,          methods[m], 2.0);
+    interp1(x, y, xi_shuffled, yi_shuffled, methods[m], 2.0);
+    
+    REQUIRE( accu(abs( yi.elem(shuffled) - yi_shuffled )) == Approx(0.0) );
+    
+    // extrapolation, and exact values at the grid points
+    
+    REQUIRE( yi(0)            == Approx(2.0) );
+    REQUIRE( yi(xi.n_elem-1)  == Approx(2.0) );
+    
+    vec yg;
+    
+    interp1(x, y, x, yg, methods[m]);
+    
+    REQUIRE( accu(abs( yg - y )) == Approx(0.0) );
+    }
+  }
+
+
+
+TEST_CASE("fn_interp1_3")
+  {
+  // the spline reproduces cubic polynomials, while pchip preserves monotonicity
+  
+  vec x = { 0.0, 0.5, 1.5, 2.0, 3.5, 4.0, 5.0 };
+  vec y = 2.0 + x - 3.0*square(x) + 0.5*pow(x,3);
+  
+  vec xi = linspace<vec>(0, 5, 101);
+  vec yi;
+  
+  interp1(x, y, xi, yi, "spline");
+  
+  vec yi_gt = 2.0 + xi - 3.0*square(xi) + 0.5*pow(xi,3);
+  
+  REQUIRE( max(abs( yi - yi_gt )) == Approx(0.0).epsilon(1e-10) );
+  
+  vec s = { 0.0, 0.0, 0.1, 3.0, 3.1, 3.1, 5.0 };
+  
+  interp1(x, s, xi, yi, "pchip");
+  
+  REQUIRE( all(diff(yi) >= -1e-12) );
+  REQUIRE( yi.min() == Approx(0.0) );
+  REQUIRE( yi.max() == Approx(5.0) );
+  }
+
+
+
+TEST_CASE("fn_interp2_1")
+  {
+  vec x = linspace<vec>(0, 4, 5);
+  vec y = linspace<vec>(0, 2, 3);
+  
+  mat Z(y.n_elem, x.n_elem);
+  
+  for(uword c=0; c < x.n_elem; ++c)
+  for(uword r=0; r < y.n_elem; ++r)
+    {
+    Z(r,c) = 1.0 + 2.0*x(c) - 3.0*y(r) + 0.5*x(c)*y(r);
+    }
+  
+  vec xi = { 3.5, -1.0, 0.25, 1.0 };
+  vec yi = { 0.0, 1.75, 2.5 };
+  
+  mat ZI;
+  
+  interp2(x, y, Z, xi, yi, ZI);
+  
+  REQUIRE( ZI.n_rows == 3 );
+  REQUIRE( ZI.n_cols == 4 );
+  
+  for(uword c=0; c < xi.n_elem; ++c)
+  for(uword r=0; r < yi.n_elem; ++r)
+    {
+    const bool inside = (xi(c) >= 0.0) && (xi(c) <= 4.0) && (yi(r) >= 0.0) && (yi(r) <= 2.0);
+    
+    if(inside)
+      {
+      REQUIRE( ZI(r,c) == Approx(1.0 + 2.0*xi(c) - 3.0*yi(r) + 0.5*xi(c)*yi(r)) );
+      }
+    else
+      {
+      REQUIRE( std::isnan(ZI(r,c)) );
+      }
+    }
+  
+  interp2(x, y, Z, xi, yi, ZI, "nearest", 0.0);
+  
+  REQUIRE( ZI(0,0) == Approx(Z(0,3)) );
+  REQUIRE( ZI(1,3) == Approx(Z(2,1)) );
+  REQUIRE( ZI(2,0) == Approx(0.0)    );
+  REQUIRE( ZI(0,1) == Approx(0.0)    );
+  }
@@ -0,0 +1,79 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+#include <armadillo>
+#include "catch.hpp"
+
+using namespace arma;
+
+
+TEST_CASE("fn_kmeans_1")
+  {
+  arma_rng::set_seed(123);
+  
+  const uword d = 4;
+  const uword k = 16;
+  const uword N = 3000;
+  
+  const mat centres = 10.0 * randu<mat>(d, k);
+  
+  mat data(d, N);
+  
+  for(uword i=0; i < N; ++i)  { data.col(i) = centres.col(i % k) + randn<vec>(d); }
+  
+  // k-means++ seeds are distinct data vectors
+  
+  mat seeds;
+  
+  REQUIRE( kmeans(seeds, data, k, random_kmpp, 0, false) == true );
+  
+  REQUIRE( seeds.n_rows == d );
+  REQUIRE( seeds.n_cols == k );
+  
+  for(uword g=0; g < k; ++g)
+    {
+    const rowvec dist = sum(square(data.each_col() - seeds.col(g)), 0);
+    
+    REQUIRE( dist.min() == Approx(0.0) );
+    
+    for(uword h=0; h < g; ++h)  { REQUIRE( accu(abs(seeds.col(g) - seeds.col(h))) > 0.0 ); }
+    }
+  
+  // the bounds based iterations give the same means as the standard algorithm
+  
+  mat ref_means = seeds;
+  
+  for(uword iter=0; iter < 10; ++iter)
+    {
+    mat   sums(d, k, fill::zeros);
+    uvec counts(k,    fill::zeros);
+    
+    for(uword i=0; i < N; ++i)
+      {
+      const rowvec dist = sum(square(ref_means.each_col() - data.col(i)), 0);
+      
+      uword g;
+      dist.min(g);
+      
+      sums.col(g) += data.col(i);
+      counts(g)++;
+      }
+    
+    REQUIRE( counts.min() > 0 );
+    
+    for(uword g=0; g < k; ++g)  { ref_means.col(g) = sums.col(g) / double(counts(g)); }
+    }
+  
+  mat means = seeds;
+  
+  REQUIRE( kmeans(means, data, k, keep_existing, 10, false) == true );
+  
+  REQUIRE( abs(means - ref_means).max() == Approx(0.0) );
+  }
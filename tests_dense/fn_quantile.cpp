@@ -0,0 +1,96 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+#include <armadillo>
+#include "catch.hpp"
+
+using namespace arma;
+
+
+TEST_CASE("fn_quantile_1")
+  {
+  const vec a = { 5.0, 1.0, 4.0, 2.0, 3.0 };
+  
+  const vec P = { 0.0, 0.05, 0.1, 0.25, 0.5, 0.75, 0.95, 1.0 };
+  
+  // positions N*p + 0.5 of the sorted values: 0.5, 0.75, 1.0, 1.75, 3.0, 4.25, 5.25, 5.5
+  const vec b = { 1.0, 1.0,  1.0, 1.75, 3.0, 4.25, 5.0,  5.0 };
+  
+  const vec c = quantile(a, P);
+  
+  REQUIRE( c.n_elem == P.n_elem );
+  
+  REQUIRE( accu(abs(c - b)) == Approx(0.0) );
+  
+  // unsorted probabilities give the same values
+  
+  const vec P_shuffled = { 0.5, 1.0, 0.05, 0.75, 0.0, 0.95, 0.25, 0.1 };
+  const vec b_shuffled = { 3.0, 5.0, 1.0,  4.25, 1.0, 5.0,  1.75, 1.0 };
+  
+  REQUIRE( accu(abs(quantile(a, P_shuffled) - b_shuffled)) == Approx(0.0) );
+  
+  // row vectors
+  
+  const rowvec d = quantile(trans(a), trans(P));
+  
+  REQUIRE( d.n_elem == P.n_elem );
+  
+  REQUIRE( accu(abs(d - trans(b))) == Approx(0.0) );
+  
+  // the median is found for p = 0.5
+  
+  const vec e = randu<vec>(101);
+  
+  REQUIRE( as_scalar(quantile(e, vec{0.5})) == Approx(median(e)) );
+  }
+
+
+
+TEST_CASE("fn_quantile_2")
+  {
+  mat A = randn<mat>(200, 30);
+  
+  A(3, 4) = 1e10;  // ties and outliers
+  A(4, 4) = A(5, 4);
+  
+  const vec P = { 0.99, 0.01, 0.5, 0.5, 0.3 };
+  
+  const mat B0 = quantile(A, P);
+  const mat B1 = quantile(A, P, 0);
+  const mat C  = quantile(trans(A), P, 1);
+  
+  REQUIRE( B0.n_rows == P.n_elem );
+  REQUIRE( B0.n_cols == A.n_cols );
+  
+  REQUIRE( C.n_rows == A.n_cols );
+  REQUIRE( C.n_cols == P.n_elem );
+  
+  REQUIRE( accu(abs(B0 - B1))       == Approx(0.0) );
+  REQUIRE( accu(abs(B0 - trans(C))) == Approx(0.0) );
+  
+  for(uword col=0; col < A.n_cols; ++col)
+    {
+    const vec s = sort(A.col(col));
+    
+    for(uword j=0; j < P.n_elem; ++j)
+      {
+      const double h = 200.0 * P(j) + 0.5;
+      const uword  k = uword(h);
+      
+      const double val = s(k-1) + (h - double(k)) * (s(k) - s(k-1));
+      
+      REQUIRE( B0(j,col) == Approx(val) );
+      }
+    }
+  
+  mat D;
+  
+  REQUIRE_THROWS( D = quantile(A, vec{ 0.5, 1.5 }) );
+  }
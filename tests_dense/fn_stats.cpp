@@ -30,3 +30,63 @@ TEST_CASE("fn_stats_1")
   
   // REQUIRE_THROWS(  );
   }
+
+
+
+TEST_CASE("fn_stats_2")
+  {
+  arma_rng::set_seed(123);
+  
+  // integer weights give the same statistics as repeated observations;
+  // enough elements for the multi-threaded paths
+  
+  const uword n_obs = 3000;
+  
+  mat X = randn<mat>(n_obs, 8);
+  
+  X.col(2) += 1e4;
+  
+  const vec W = floor(4.0 * randu<vec>(n_obs));  // includes zero weights
+  
+  uvec indices(uword(accu(W)));
+  
+  uword count = 0;
+  
+  for(uword i=0; i < n_obs; ++i)
+  for(uword j=0; j < uword(W(i)); ++j)
+    {
+    indices(count) = i;  ++count;
+    }
+  
+  const mat R = X.rows(indices);
+  
+  REQUIRE( abs(mean(X, W)       - mean(R)         ).max() < 1e-9 );
+  REQUIRE( abs(var(X, W)        - var(R, 1)       ).max() < 1e-7 );
+  REQUIRE( abs(stddev(X, W)     - stddev(R, 1)    ).max() < 1e-7 );
+  
+  const mat Xt = trans(X);
+  const mat Rt = trans(R);
+  
+  REQUIRE( abs(mean(Xt, W, 1)   - mean(Rt, 1)     ).max() < 1e-9 );
+  REQUIRE( abs(var(Xt, W, 1)    - var(Rt, 1, 1)   ).max() < 1e-7 );
+  REQUIRE( abs(stddev(Xt, W, 1) - stddev(Rt, 1, 1)).max() < 1e-7 );
+  
+  // vectors give scalars
+  
+  const vec x = X.col(0);
+  const vec r = R.col(0);
+  
+  REQUIRE( mean(x, W)   == Approx(mean(r))      );
+  REQUIRE( var(x, W)    == Approx(var(r, 1))    );
+  REQUIRE( stddev(x, W) == Approx(stddev(r, 1)) );
+  
+  // the weights are applied to the rows of the expression
+  
+  REQUIRE( abs(mean(2.0*X + 1.0, W) - (2.0*mean(R) + 1.0)).max() < 1e-9 );
+  
+  mat out;
+  
+  REQUIRE_THROWS( out = mean(X, W.subvec(0, 9)) );
+  REQUIRE_THROWS( out = var(X, -W) );
+  REQUIRE_THROWS( out = var(X, W, 2) );
+  }
@@ -0,0 +1,108 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+#include <armadillo>
+#include "catch.hpp"
+
+using namespace arma;
+
+
+TEST_CASE("fn_stft_1")
+  {
+  vec x = randu<vec>(1000) - 0.5;
+  
+  const uword L   = 64;
+  const uword hop = 16;
+  
+  // periodic Hann window
+  vec w = 0.5 - 0.5*cos( (2.0 * datum::pi / double(L)) * linspace<vec>(0, L-1, L) );
+  
+  cx_mat S = stft(x, w, hop, 128);
+  
+  REQUIRE( S.n_rows == 128 );
+  REQUIRE( S.n_cols == (1 + (1000 - L + hop - 1)/hop) );
+  
+  // each column is the transform of a windowed frame
+  
+  for(uword k=0; k < S.n_cols; k += 7)
+    {
+    vec frame(L, fill::zeros);
+    
+    const uword n = (std::min)(L, x.n_elem - k*hop);
+    
+    frame.head(n) = x.subvec(k*hop, k*hop + n - 1) % w.head(n);
+    
+    REQUIRE( accu(abs( S.col(k) - fft(frame, 128) )) == Approx(0.0).epsilon(1e-10) );
+    }
+  
+  // the inverse recovers the signal wherever the windows overlap
+  
+  cx_vec y = istft(S, w, hop, x.n_elem);
+  
+  REQUIRE( y.n_elem == x.n_elem );
+  
+  REQUIRE( max(abs( real(y.subvec(L, 900)) - x.subvec(L, 900) )) == Approx(0.0).epsilon(1e-10) );
+  REQUIRE( max(abs( imag(y) )) == Approx(0.0).epsilon(1e-10) );
+  
+  // complex signals, with odd lengths
+  
+  cx_vec cx_x = randu<cx_vec>(301);
+  vec    cx_w = ones<vec>(15);
+  
+  cx_mat cx_S = stft(cx_x, cx_w, 5);
+  cx_vec cx_y = istft(cx_S, cx_w, 5, cx_x.n_elem);
+  
+  REQUIRE( accu(abs( cx_S.col(3) - fft(cx_x.subvec(15, 29)) )) == Approx(0.0).epsilon(1e-10) );
+  REQUIRE( max(abs( cx_y - cx_x )) == Approx(0.0).epsilon(1e-10) );
+  }
+
+
+
+TEST_CASE("fn_sliding_dft_1")
+  {
+  const uword N = 50;
+  
+  uvec bins = { 0, 3, 17, 25, 49 };
+  
+  sliding_dft<double> D(N, bins);
+  
+  vec x = randu<vec>(1234);
+  
+  for(uword i=0; i < x.n_elem; ++i)
+    {
+    D(x(i));
+    
+    if( (i == 10) || (i == 77) || (i == 100) || (i == 1233) )
+      {
+      vec last(N, fill::zeros);
+      
+      const uword n = (std::min)(N, i+1);
+      
+      last.tail(n) = x.subvec(i+1-n, i);
+      
+      cx_vec X = fft(last);
+      
+      REQUIRE( accu(abs( D.spectrum() - X.elem(bins) )) == Approx(0.0).epsilon(1e-10) );
+      }
+    }
+  
+  // blocks of samples, complex signals
+  
+  cx_vec cx_x = randu<cx_vec>(200);
+  
+  sliding_dft<cx_double> E(N, bins);
+  
+  E(cx_x.head(120));
+  E(cx_x.tail(80));
+  
+  cx_vec X = fft( cx_x.tail(N) );
+  
+  REQUIRE( accu(abs( E.spectrum() - X.elem(bins) )) == Approx(0.0).epsilon(1e-10) );
+  }
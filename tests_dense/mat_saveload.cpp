@@ -30,3 +30,692 @@ TEST_CASE("mat_saveload_1")
   
   // REQUIRE_THROWS(  );
   }
+
+
+
+TEST_CASE("mat_saveload_async_1")
+  {
+  mat A = randu<mat>(20,30);
+  
+  const std::string name = "mat_saveload_async_1.bin";
+  
+  io_future fs = A.save_async(name);
+  
+  A.zeros();  // the save operates on a snapshot
+  
+  REQUIRE( fs.get() == true );
+  REQUIRE( fs.is_ready() == true );
+  
+  mat B;
+  
+  io_future fl = B.load_async(name);
+  
+  REQUIRE( fl.get() == true );
+  REQUIRE( fl.err_msg().length() == 0 );
+  
+  REQUIRE( B.n_rows == 20 );
+  REQUIRE( B.n_cols == 30 );
+  
+  mat C;
+  C.load(name);
+  
+  REQUIRE( accu(abs(B - C)) == Approx(0.0) );
+  REQUIRE( accu(B) > 0.0 );
+  
+  std::remove(name.c_str());
+  }
+
+
+
+TEST_CASE("mat_saveload_async_2")
+  {
+  mat A;
+  
+  io_future f = A.load_async("mat_saveload_async_2_missing_file.bin", arma_binary, false);
+  
+  REQUIRE( f.get() == false );
+  REQUIRE( f.err_msg().length() > 0 );
+  REQUIRE( A.n_elem == 0 );
+  }
+
+
+
+TEST_CASE("mat_saveload_async_4")
+  {
+  const mat A = randu<mat>(400,300);
+  
+  const std::string name = "mat_saveload_async_4.bin";
+  
+  REQUIRE( A.save(name) );
+  
+  // destroying the last copy of the handle waits for the load,
+  // so the destination can be destroyed straight after
+  
+  for(uword i=0; i < 10; ++i)
+    {
+    mat* B = new mat;
+    
+      {
+      io_future f1 = B->load_async(name);
+      
+        {
+        io_future f2 = f1;
+        }
+      
+      REQUIRE( f1.valid() );
+      }
+    
+    REQUIRE( B->n_rows == 400 );
+    REQUIRE( accu(abs(*B - A)) == Approx(0.0) );
+    
+    delete B;
+    }
+  
+  field<mat> G(3);
+  
+  G(0) = A;
+  G(2) = A.t();
+  
+  REQUIRE( G.save(name) );
+  
+  for(uword i=0; i < 10; ++i)
+    {
+    field<mat>* F = new field<mat>;
+    
+      {
+      io_future f = F->load_async(name);
+      }
+    
+    REQUIRE( F->n_elem == 3 );
+    REQUIRE( (*F)(2).n_rows == 300 );
+    
+    delete F;
+    }
+  
+  std::remove(name.c_str());
+  }
+
+
+
+TEST_CASE("mat_saveload_async_3")
+  {
+  // the synchronous and asynchronous forms support the same file types
+  
+  const mat    A = randu<mat>(4, 5);
+  const sp_mat S = sprandu<sp_mat>(6, 7, 0.3);
+  
+  const std::string name = "mat_saveload_async_3.bin";
+  
+  const file_type types[] = { raw_ascii, arma_ascii, csv_ascii, raw_binary, arma_binary, npy_binary, npz_binary, pgm_binary, coord_ascii, mtx_ascii, mtx_ascii_lowmem };
+  
+  for(uword i=0; i < sizeof(types)/sizeof(types[0]); ++i)
+    {
+    const file_type type = types[i];
+    
+    const bool A_save_okay = A.save(name, type, false);
+    
+    REQUIRE( A.save_async(name, type, false).get() == A_save_okay );
+    
+    mat B;
+    
+    const bool A_load_okay = B.load(name, type, false);
+    
+    REQUIRE( B.load_async(name, type, false).get() == A_load_okay );
+    
+    const bool S_save_okay = S.save(name, type, false);
+    
+    REQUIRE( S.save_async(name, type, false).get() == S_save_okay );
+    
+    sp_mat T;
+    
+    const bool S_load_okay = T.load(name, type, false);
+    
+    REQUIRE( T.load_async(name, type, false).get() == S_load_okay );
+    }
+  
+  mat C;
+  
+  io_future f = C.load_async(name, mtx_ascii, false);
+  
+  REQUIRE( f.get() == false );
+  REQUIRE( f.err_msg().find("unsupported file type") != std::string::npos );
+  
+  std::remove(name.c_str());
+  }
+
+
+
+TEST_CASE("mat_saveload_text_1")
+  {
+  mat A = randn<mat>(13,7);
+  
+  A(0,0) =  Datum<double>::inf;
+  A(1,0) = -Datum<double>::inf;
+  A(2,0) =  0.1;
+  A(3,0) =  0.0;
+  A(4,0) = -1e-300;
+  A(5,0) =  123456789.0;
+  
+  std::stringstream ss1;
+  std::stringstream ss2;
+  std::stringstream ss3;
+  
+  A.save(ss1, raw_ascii);
+  A.save(ss2, csv_ascii);
+  A.save(ss3, arma_ascii);
+  
+  mat B1;  B1.load(ss1, raw_ascii);
+  mat B2;  B2.load(ss2, csv_ascii);
+  mat B3;  B3.load(ss3, arma_ascii);
+  
+  // text output is round-trip exact
+  REQUIRE( B1.n_rows == A.n_rows );  REQUIRE( B1.n_cols == A.n_cols );
+  REQUIRE( B2.n_rows == A.n_rows );  REQUIRE( B2.n_cols == A.n_cols );
+  REQUIRE( B3.n_rows == A.n_rows );  REQUIRE( B3.n_cols == A.n_cols );
+  
+  REQUIRE( B1(0,0) ==  Datum<double>::inf );
+  REQUIRE( B1(1,0) == -Datum<double>::inf );
+  
+  A.shed_rows(0,1);  B1.shed_rows(0,1);  B2.shed_rows(0,1);  B3.shed_rows(0,1);
+  
+  REQUIRE( accu(A != B1) == 0 );
+  REQUIRE( accu(A != B2) == 0 );
+  REQUIRE( accu(A != B3) == 0 );
+  
+  std::stringstream ss4;
+  
+  mat(A.rows(0,3)).save(ss4, csv_ascii);
+  
+  const std::string line = ss4.str().substr(0, ss4.str().find('\n'));
+  
+  REQUIRE( line.substr(0, 4) == "0.1," );
+  }
+
+
+
+TEST_CASE("mat_saveload_text_2")
+  {
+  imat A = randi<imat>(9, 5, distr_param(-1000, 1000));
+  
+  A(0,0) = std::numeric_limits<sword>::min();
+  A(1,0) = std::numeric_limits<sword>::max();
+  
+  cx_mat C = randu<cx_mat>(6,4);
+  
+  std::stringstream ss1;
+  std::stringstream ss2;
+  
+  A.save(ss1, raw_ascii);
+  C.save(ss2, arma_ascii);
+  
+  imat   B;  B.load(ss1, raw_ascii);
+  cx_mat D;  D.load(ss2, arma_ascii);
+  
+  REQUIRE( accu(A != B) == 0 );
+  REQUIRE( accu(abs(C - D)) == Approx(0.0) );
+  }
+
+
+
+TEST_CASE("field_saveload_indexed_1")
+  {
+  field<mat> F(3,4);
+  
+  for(uword i=0; i < F.n_elem; ++i)  { F(i) = randu<mat>(i+1, 2*i+1); }
+  
+  const std::string name = "field_saveload_indexed_1.bin";
+  
+  REQUIRE( F.save(name, arma_binary_indexed) );
+  
+  field<mat> G;
+  
+  REQUIRE( G.load(name) );
+  
+  REQUIRE( G.n_rows == 3 );
+  REQUIRE( G.n_cols == 4 );
+  
+  for(uword i=0; i < F.n_elem; ++i)  { REQUIRE( accu(F(i) != G(i)) == 0 ); }
+  
+  field_reader<mat> R(name);
+  
+  REQUIRE( R.is_open() );
+  REQUIRE( R.n_elem == 12 );
+  
+  mat A;
+  
+  REQUIRE( R.load(A, 2, 3) );
+  
+  REQUIRE( accu(A != F(2,3)) == 0 );
+  
+  field<mat> H;
+  
+  REQUIRE( R.load(H, uvec({7, 0, 7})) );
+  
+  REQUIRE( H.n_elem == 3 );
+  REQUIRE( accu(H(0) != F(7)) == 0 );
+  REQUIRE( accu(H(1) != F(0)) == 0 );
+  REQUIRE( accu(H(2) != F(7)) == 0 );
+  
+  std::remove(name.c_str());
+  }
+
+
+
+TEST_CASE("field_saveload_indexed_2")
+  {
+  field<sp_mat> F(5);
+  
+  for(uword i=0; i < F.n_elem; ++i)  { F(i) = sprandu<sp_mat>(10, 10+i, 0.2); }
+  
+  field<cube> C(2,1,2);
+  
+  for(uword i=0; i < C.n_elem; ++i)  { C(i) = randu<cube>(2, 3, i+1); }
+  
+  std::stringstream ss1;
+  std::stringstream ss2;
+  
+  REQUIRE( F.save(ss1, arma_binary_indexed) );
+  REQUIRE( C.save(ss2, arma_binary_indexed) );
+  
+  field<sp_mat> G;
+  field<cube>   D;
+  
+  REQUIRE( G.load(ss1) );
+  REQUIRE( D.load(ss2, arma_binary_indexed) );
+  
+  REQUIRE( G.n_elem == 5 );
+  REQUIRE( D.n_slices == 2 );
+  
+  for(uword i=0; i < F.n_elem; ++i)  { REQUIRE( accu(abs(F(i) - G(i))) == 0.0 ); }
+  for(uword i=0; i < C.n_elem; ++i)  { REQUIRE( accu(C(i) != D(i)) == 0 ); }
+  }
+
+
+
+TEST_CASE("field_saveload_indexed_3")
+  {
+  field<mat> F(4);
+  
+  for(uword i=0; i < F.n_elem; ++i)  { F(i) = randu<mat>(3, 3); }
+  
+  const std::string name_1 = "field_saveload_indexed_3a.bin";
+  const std::string name_2 = "field_saveload_indexed_3b.bin";
+  
+  REQUIRE( F.save(name_1, arma_binary_indexed) );
+  REQUIRE( F.save(name_2, arma_binary)         );
+  
+  // matrices can't be loaded as column vectors; the exceptions thrown while
+  // loading the objects in parallel reach the caller, as for the arma_binary format
+  
+  field<vec> G;
+  
+  REQUIRE_THROWS( G.load(name_1) );
+  REQUIRE_THROWS( G.load(name_2) );
+  
+  field_reader<vec> R(name_1);
+  
+  REQUIRE( R.is_open() );
+  
+  REQUIRE_THROWS( R.load(G, uvec({0, 2})) );
+  
+  std::remove(name_1.c_str());
+  std::remove(name_2.c_str());
+  }
+
+
+
+//! read-only stream buffer which can't seek, as for a pipe
+class nonseekable_buf : public std::streambuf
+  {
+  public:
+  
+  std::string data;
+  
+  nonseekable_buf(const std::string& in_data) : data(in_data)
+    {
+    char* mem = &data[0];
+    
+    setg(mem, mem, mem + data.length());
+    }
+  };
+
+
+
+TEST_CASE("field_saveload_indexed_4")
+  {
+  field<mat> F(2,3);
+  
+  for(uword i=0; i < F.n_elem; ++i)  { F(i) = randu<mat>(i+1, 4); }
+  
+  std::stringstream ss;
+  
+  REQUIRE( F.save(ss, arma_binary_indexed) );
+  
+  // streams are read sequentially
+  
+  nonseekable_buf buf_1(ss.str());
+  nonseekable_buf buf_2(ss.str());
+  
+  std::istream is_1(&buf_1);
+  std::istream is_2(&buf_2);
+  
+  REQUIRE( is_1.tellg() == std::streampos(-1) );
+  
+  field<mat> G;
+  field<mat> H;
+  
+  REQUIRE( G.load(is_1, arma_binary) );
+  REQUIRE( H.load(is_2, arma_binary_indexed) );
+  
+  REQUIRE( G.n_rows == 2 );
+  REQUIRE( G.n_cols == 3 );
+  REQUIRE( H.n_elem == 6 );
+  
+  for(uword i=0; i < F.n_elem; ++i)  { REQUIRE( accu(F(i) != G(i)) == 0 ); }
+  for(uword i=0; i < F.n_elem; ++i)  { REQUIRE( accu(F(i) != H(i)) == 0 ); }
+  
+  // files with sizes in the header which don't match the index are rejected
+  
+  const std::string name = "field_saveload_indexed_4.bin";
+  
+  const std::string orig = ss.str();
+  const std::string body = orig.substr(orig.find('\n', 13) + 1);
+  
+  const char* headers[] = { "ARMA_FLX_BIN\n2 3 2\n", "ARMA_FLX_BIN\n4294967296 4294967296 4294967296\n", "ARMA_FLX_BIN\n1000000000 1000000000 1\n" };
+  
+  for(uword i=0; i < 3; ++i)
+    {
+    std::ofstream f(name.c_str(), std::fstream::binary);
+    
+    f << headers[i] << body;
+    
+    f.close();
+    
+    field<mat> K;
+    
+    REQUIRE( K.load(name, arma_binary_indexed, false) == false );
+    
+    field_reader<mat> R;
+    
+    REQUIRE( R.open(name, false) == false );
+    }
+  
+  std::remove(name.c_str());
+  }
+
+
+
+TEST_CASE("mat_saveload_npy_1")
+  {
+  mat     A = randu<mat>(7, 5);
+  cx_cube C = randu<cx_cube>(3, 4, 2);
+  sp_mat  S = sprandu<sp_mat>(30, 20, 0.1);
+  
+  std::stringstream ss1;
+  std::stringstream ss2;
+  std::stringstream ss3;
+  std::stringstream ss4;
+  
+  REQUIRE( A.save(ss1, npy_binary) );
+  REQUIRE( A.save(ss2, npz_binary) );
+  REQUIRE( C.save(ss3, npy_binary) );
+  REQUIRE( S.save(ss4, npz_binary) );
+  
+  mat     B1;  REQUIRE( B1.load(ss1) );
+  mat     B2;  REQUIRE( B2.load(ss2) );
+  cx_cube D;   REQUIRE( D.load(ss3, npy_binary) );
+  sp_mat  T;   REQUIRE( T.load(ss4, npz_binary) );
+  
+  REQUIRE( accu(A != B1) == 0 );
+  REQUIRE( accu(A != B2) == 0 );
+  REQUIRE( accu(C != D)  == 0 );
+  
+  REQUIRE( T.n_rows    == S.n_rows    );
+  REQUIRE( T.n_nonzero == S.n_nonzero );
+  REQUIRE( accu(abs(S - T)) == 0.0 );
+  }
+
+
+
+TEST_CASE("mat_saveload_npy_2")
+  {
+  // 2x3 matrix of little endian int16 values in C order: [[1, 2, 3], [4, 5, 6]]
+  std::string dict = "{'descr': '<i2', 'fortran_order': False, 'shape': (2, 3), }";
+  
+  dict.append(128 - 10 - dict.length() - 1, ' ');
+  dict.push_back('\n');
+  
+  std::string data = std::string("\x93NUMPY\x01\x00", 8) + char(dict.length()) + char(0) + dict;
+  
+  for(int i=1; i <= 6; ++i)  { data.push_back(char(i)); data.push_back(char(0)); }
+  
+  std::stringstream ss1(data);
+  std::stringstream ss2(data);
+  std::stringstream ss3(data);
+  
+  mat A;
+  
+  REQUIRE( A.load(ss1) );
+  
+  REQUIRE( A.n_rows == 2 );
+  REQUIRE( A.n_cols == 3 );
+  
+  REQUIRE( A(0,0) == 1.0 );
+  REQUIRE( A(0,2) == 3.0 );
+  REQUIRE( A(1,0) == 4.0 );
+  REQUIRE( A(1,2) == 6.0 );
+  
+  vec v;
+  
+  REQUIRE( v.load(ss2, npy_binary, false) == false );
+  
+  cx_mat B;
+  
+  REQUIRE( B.load(ss3, npy_binary) );
+  REQUIRE( std::real(B(1,1)) == 5.0 );
+  }
+
+
+
+TEST_CASE("mat_saveload_npy_3")
+  {
+  mat    A = randu<mat>(40, 30);
+  sp_mat S = sprandu<sp_mat>(50, 40, 0.1);
+  
+  const std::string name = "mat_saveload_npy_3.npz";
+  
+  // the archive is written straight to the file
+  
+  REQUIRE( A.save(name, npz_binary) );
+  
+  std::ifstream f(name.c_str(), std::fstream::binary);
+  
+  const std::string data( (std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>() );
+  
+  f.close();
+  
+  const unsigned char* header = reinterpret_cast<const unsigned char*>(data.data());
+  
+  REQUIRE( npy_misc::get_le(header, 4) == 0x04034b50 );
+  
+  const std::streamoff crc      = npy_misc::get_le(&header[14], 4);
+  const std::streamoff size     = npy_misc::get_le(&header[18], 4);
+  const std::streamoff data_pos = 30 + npy_misc::get_le(&header[26], 2) + npy_misc::get_le(&header[28], 2);
+  
+  REQUIRE( size == std::streamoff(128 + A.n_elem*sizeof(double)) );
+  REQUIRE( crc  == std::streamoff(npy_misc::crc32(data.data() + data_pos, uword(size))) );
+  
+  mat B;
+  
+  REQUIRE( B.load(name) );
+  REQUIRE( accu(A != B) == 0 );
+  
+  std::remove(name.c_str());
+  
+  // archive with zip64 records
+  
+  std::stringstream ss1;
+  
+    {
+    npy_misc::zip_writer zw(ss1, true);
+    
+    std::ostream os(&zw);
+    
+    REQUIRE( zw.begin_entry("arr_0.npy", std::streamoff(A.n_elem*sizeof(double))) );
+    REQUIRE( diskio::save_npy_binary(A, os) );
+    REQUIRE( zw.end_entry() );
+    REQUIRE( zw.finish() );
+    }
+  
+  const std::string data64 = ss1.str();
+  
+  REQUIRE( npy_misc::get_le(reinterpret_cast<const unsigned char*>(&data64[18]), 4) == std::streamoff(0xFFFFFFFF) );
+  
+  mat C;
+  
+  REQUIRE( C.load(ss1, npz_binary) );
+  REQUIRE( accu(A != C) == 0 );
+  
+  // failed writes are reported
+  
+  std::stringstream ss2;
+  
+  ss2.setstate(std::ios::badbit);
+  
+  REQUIRE( A.save(ss2, npz_binary) == false );
+  REQUIRE( S.save(ss2, npz_binary) == false );
+  }
+
+
+
+TEST_CASE("spmat_saveload_mtx_1")
+  {
+  sp_mat A = sprandu<sp_mat>(60, 50, 0.1);
+  
+  A(59,49) = -1.5e-300;
+  
+  sp_mat S = A.t() * A;
+  
+  sp_cx_mat C(A, 2.0*A);
+  
+  std::stringstream ss1;
+  std::stringstream ss2;
+  std::stringstream ss3;
+  std::stringstream ss4;
+  
+  REQUIRE( A.save(ss1, mtx_ascii) );
+  REQUIRE( S.save(ss2, mtx_ascii) );
+  REQUIRE( C.save(ss3, mtx_ascii) );
+  REQUIRE( S.save(ss4, mtx_ascii) );
+  
+  // only the lower triangle of a symmetric matrix is written
+  REQUIRE( ss2.str().find("coordinate real symmetric") != std::string::npos );
+  
+  sp_mat    B;  REQUIRE( B.load(ss1, mtx_ascii) );
+  sp_mat    T;  REQUIRE( T.load(ss2, mtx_ascii) );
+  sp_cx_mat D;  REQUIRE( D.load(ss3, mtx_ascii) );
+  sp_mat    U;  REQUIRE( U.load(ss4, mtx_ascii_lowmem) );
+  
+  REQUIRE( B.n_rows    == A.n_rows    );
+  REQUIRE( B.n_cols    == A.n_cols    );
+  REQUIRE( B.n_nonzero == A.n_nonzero );
+  REQUIRE( T.n_nonzero == S.n_nonzero );
+  REQUIRE( U.n_nonzero == S.n_nonzero );
+  
+  REQUIRE( accu(abs(A - B)) == 0.0 );
+  REQUIRE( accu(abs(S - T)) == 0.0 );
+  REQUIRE( accu(abs(cx_mat(C) - cx_mat(D))) == 0.0 );
+  REQUIRE( accu(abs(S - U)) == 0.0 );
+  
+  sp_mat E;
+  
+  std::stringstream ss5;
+  
+  REQUIRE( A.save(ss5, coord_ascii) );
+  REQUIRE( E.load(ss5, coord_ascii) );
+  
+  REQUIRE( E.n_rows == A.n_rows );
+  REQUIRE( E.n_cols == A.n_cols );
+  REQUIRE( accu(abs(A - E)) == 0.0 );
+  }
+
+
+
+TEST_CASE("spmat_saveload_mtx_2")
+  {
+  const std::string data_1 =
+    "%%MatrixMarket matrix coordinate real skew-symmetric\n"
+    "% comment\n"
+    "\n"
+    "4 4 3\n"
+    "2 1 1.5\n"
+    "4 1 -2\n"
+    "4 3 inf\n";
+  
+  const std::string data_2 =
+    "%%MatrixMarket matrix coordinate pattern symmetric\n"
+    "3 3 4\n"
+    "1 1\n"
+    "3 1\n"
+    "3 2\n"
+    "3 2\n";
+  
+  const std::string data_3 =
+    "%%MatrixMarket matrix coordinate complex hermitian\n"
+    "2 2 2\n"
+    "1 1 3 0\n"
+    "2 1 1 -2\n";
+  
+  // repeated and unsorted entries in coord_ascii data; the blank line ends the data
+  const std::string data_4 = "3 1 2\n0 0 5\n1 1 0\n3 1 7\n\n9 9 9\n";
+  
+  std::stringstream ss1(data_1);
+  std::stringstream ss2(data_2);
+  std::stringstream ss3(data_3);
+  std::stringstream ss4(data_4);
+  std::stringstream ss5(data_1);
+  
+  sp_mat    A;  REQUIRE( A.load(ss1, mtx_ascii) );
+  sp_mat    B;  REQUIRE( B.load(ss2, mtx_ascii_lowmem) );
+  sp_cx_mat C;  REQUIRE( C.load(ss3, mtx_ascii) );
+  sp_mat    D;  REQUIRE( D.load(ss4, coord_ascii) );
+  
+  REQUIRE( A.n_nonzero == 6 );
+  REQUIRE( A(1,0) ==  1.5 );
+  REQUIRE( A(0,1) == -1.5 );
+  REQUIRE( A(0,3) ==  2.0 );
+  REQUIRE( A(2,3) == -Datum<double>::inf );
+  
+  REQUIRE( B.n_nonzero == 5 );
+  REQUIRE( B(0,0) == 1.0 );
+  REQUIRE( B(0,2) == 1.0 );
+  REQUIRE( B(1,2) == 2.0 );
+  REQUIRE( B(2,1) == 2.0 );
+  
+  // loading into a non-empty matrix of the same size
+  
+  std::stringstream ss7(data_2);
+  
+  REQUIRE( B.load(ss7, mtx_ascii_lowmem) );
+  REQUIRE( B.n_nonzero == 5 );
+  REQUIRE( B(1,2) == 2.0 );
+  
+  REQUIRE( cx_double(C(0,1)) == cx_double(1.0,  2.0) );
+  REQUIRE( cx_double(C(1,0)) == cx_double(1.0, -2.0) );
+  
+  REQUIRE( D.n_rows    == 4 );
+  REQUIRE( D.n_cols    == 2 );
+  REQUIRE( D.n_nonzero == 2 );
+  REQUIRE( D(3,1) == 7.0 );
+  REQUIRE( D(0,0) == 5.0 );
+  
+  mat E;
+  
+  REQUIRE( E.load(ss5, mtx_ascii, false) == false );
+  
+  sp_mat F;
+  
+  std::stringstream ss6("%%MatrixMarket matrix coordinate real general\n2 2 2\n1 1 1.0\n");
+  
+  REQUIRE( F.load(ss6, mtx_ascii, false) == false );
+  }
@@ -30,3 +30,143 @@ TEST_CASE("stat_gmm_diag_1")
   
   // REQUIRE_THROWS(  );
   }
+
+
+
+TEST_CASE("stat_gmm_diag_online_1")
+  {
+  arma_rng::set_seed(123);
+  
+  const vec mean0 = { 1.0, 2.0, 3.0 };
+  const vec mean1 = { 6.0, 4.0, -2.0 };
+  
+  const vec sd0 = { 1.0, 0.5, 2.0 };
+  const vec sd1 = { 0.5, 1.5, 1.0 };
+  
+  gmm_diag model;
+  
+  const uword batch_size = 1000;
+  
+  for(uword b=0; b < 300; ++b)
+    {
+    mat batch(3, batch_size);
+    
+    for(uword i=0; i < batch_size; ++i)
+      {
+      batch.col(i) = ((i % 3) == 0) ? vec(mean1 + sd1 % randn<vec>(3)) : vec(mean0 + sd0 % randn<vec>(3));
+      }
+    
+    const bool status = model.learn_online(batch, 2, maha_dist, random_subset, 5, 1e-10, 0.6, false);
+    
+    REQUIRE( status == true );
+    }
+  
+  const uword g0 = (model.means(0,0) < model.means(0,1)) ? 0 : 1;
+  const uword g1 = 1 - g0;
+  
+  REQUIRE( model.hefts(g0) == Approx(2.0/3.0).epsilon(0.01) );
+  
+  REQUIRE( abs(model.means.col(g0) - mean0).max() < 0.05 );
+  REQUIRE( abs(model.means.col(g1) - mean1).max() < 0.05 );
+  
+  REQUIRE( abs(model.dcovs.col(g0) - square(sd0)).max() < 0.1 );
+  REQUIRE( abs(model.dcovs.col(g1) - square(sd1)).max() < 0.1 );
+  
+  // the state is copied, and is discarded when the parameters are set
+  
+  gmm_diag model2 = model;
+  
+  mat batch = repmat(mean0, 1, 10);
+  
+  model .learn_online(batch, 2, maha_dist, random_subset, 5, 1e-10, 0.6, false);
+  model2.learn_online(batch, 2, maha_dist, random_subset, 5, 1e-10, 0.6, false);
+  
+  REQUIRE( accu(abs(model.means - model2.means)) == Approx(0.0) );
+  
+  model2.set_hefts(model2.hefts);
+  
+  REQUIRE( model2.learn_online(batch, 3, maha_dist, keep_existing, 0, 1e-10, 0.6, false) == false );
+  REQUIRE( model2.learn_online(batch, 2, maha_dist, keep_existing, 0, 1e-10, 0.6, false) == true  );
+  }
+
+
+
+//! runs the tasks in reverse order, and records the largest number of tasks per job
+class reverse_executor : public executor
+  {
+  public:
+  
+  uword max_tasks;
+  
+  reverse_executor() : max_tasks(0) {}
+  
+  uword n_threads() const { return 4; }
+  
+  void run(executor_job& job, const uword n_tasks)
+    {
+    max_tasks = (std::max)(max_tasks, n_tasks);
+    
+    for(uword t=n_tasks; t > 0; --t)  { job.run_task(t-1); }
+    }
+  };
+
+
+
+TEST_CASE("stat_gmm_diag_executor_1")
+  {
+  arma_rng::set_seed(123);
+  
+  const mat data = join_rows( randn<mat>(4, 5000), randn<mat>(4, 5000) + 3.0 );
+  
+  gmm_diag model;
+  
+  REQUIRE( model.learn(data, 10, maha_dist, static_subset, 5, 5, 1e-10, false) == true );
+  
+  const rowvec  ref_log_p  = model.log_p(data);
+  const urowvec ref_assign = model.assign(data, prob_dist);
+  const urowvec ref_hist   = model.raw_hist(data, eucl_dist);
+  
+  reverse_executor exec;
+  
+  gmm_diag model2 = model;
+  
+  model2.set_executor(exec);
+  
+  REQUIRE( accu(abs(model2.log_p(data) - ref_log_p)) == Approx(0.0) );
+  
+  REQUIRE( model2.avg_log_p(data) == Approx(mean(ref_log_p)) );
+  
+  REQUIRE( all(model2.assign(data, prob_dist) == ref_assign) );
+  REQUIRE( all(model2.raw_hist(data, eucl_dist) == ref_hist) );
+  
+  REQUIRE( exec.max_tasks == 4 );
+  
+  // small inputs are processed as one task
+  
+  exec.max_tasks = 0;
+  
+  model2.log_p(data.cols(0,9));
+  
+  REQUIRE( exec.max_tasks == 1 );
+  
+  // same model when learned via the executor
+  
+  gmm_diag model3;
+  
+  model3.set_executor(exec);
+  
+  REQUIRE( model3.learn(data, 10, maha_dist, static_subset, 5, 5, 1e-10, false) == true );
+  
+  REQUIRE( abs(model3.means - model.means).max() == Approx(0.0).epsilon(1e-8) );
+  REQUIRE( abs(model3.dcovs - model.dcovs).max() == Approx(0.0).epsilon(1e-8) );
+  
+  // cap on the number of threads
+  
+  omp_executor exec2(2);
+  
+  REQUIRE( exec2.n_threads() <= 2 );
+  
+  model3.set_executor(exec2);
+  
+  REQUIRE( accu(abs(model3.log_p(data) - ref_log_p)) == Approx(0.0).epsilon(1e-8) );
+  }
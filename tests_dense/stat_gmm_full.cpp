@@ -0,0 +1,240 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+#include <armadillo>
+#include "catch.hpp"
+
+using namespace arma;
+
+
+TEST_CASE("stat_gmm_full_1")
+  {
+  mat means = { { 1.0, -2.0 }, { 2.0, 3.0 }, { -1.0, 0.5 } };
+  
+  cube fcovs(3, 3, 2);
+  
+  fcovs.slice(0) = { { 2.0, 0.8, 0.3 }, { 0.8, 1.0, -0.2 }, { 0.3, -0.2, 0.5 } };
+  fcovs.slice(1) = { { 0.6, -0.1, 0.0 }, { -0.1, 1.5, 0.4 }, { 0.0, 0.4, 0.9 } };
+  
+  rowvec hefts = { 0.3, 0.7 };
+  
+  gmm_full model;
+  
+  model.set_params(means, fcovs, hefts);
+  
+  REQUIRE( model.n_dims() == 3 );
+  REQUIRE( model.n_gaus() == 2 );
+  
+  mat X = randn<mat>(3, 300);
+  
+  // log-likelihoods computed directly from the definition
+  
+  rowvec expected_0(X.n_cols);
+  rowvec expected  (X.n_cols);
+  
+  for(uword i=0; i < X.n_cols; ++i)
+    {
+    vec p(2);
+    
+    for(uword g=0; g < 2; ++g)
+      {
+      const vec    y = X.col(i) - means.col(g);
+      const double q = as_scalar( y.t() * inv(fcovs.slice(g)) * y );
+      
+      p(g) = -0.5*q - 0.5*std::log(det(2.0 * datum::pi * fcovs.slice(g)));
+      }
+    
+    expected_0(i) = p(0);
+    expected(i)   = std::log( hefts(0)*std::exp(p(0)) + hefts(1)*std::exp(p(1)) );
+    }
+  
+  REQUIRE( model.log_p(X.col(7))    == Approx(expected(7))   );
+  REQUIRE( model.log_p(X.col(7), 0) == Approx(expected_0(7)) );
+  
+  REQUIRE( accu(abs( model.log_p(X)    - expected   )) == Approx(0.0).epsilon(1e-8) );
+  REQUIRE( accu(abs( model.log_p(X, 0) - expected_0 )) == Approx(0.0).epsilon(1e-8) );
+  
+  REQUIRE( accu(abs( model.log_p(X.cols(10,19)) - expected.cols(10,19) )) == Approx(0.0).epsilon(1e-8) );
+  
+  REQUIRE( model.avg_log_p(X) == Approx(mean(expected)) );
+  
+  // assignment to the most likely gaussian
+  
+  urowvec ids = model.assign(X, prob_dist);
+  
+  const rowvec p1 = model.log_p(X, 1) + std::log(hefts(1));
+  
+  for(uword i=0; i < X.n_cols; ++i)
+    {
+    const uword id = (p1(i) > expected_0(i) + std::log(hefts(0))) ? 1 : 0;
+    
+    REQUIRE( ids(i) == id );
+    }
+  
+  REQUIRE( model.assign(X.col(3), prob_dist) == ids(3) );
+  
+  REQUIRE( accu(model.raw_hist(X, prob_dist)) == X.n_cols );
+  }
+
+
+
+TEST_CASE("stat_gmm_full_2")
+  {
+  arma_rng::set_seed(1234);
+  
+  const uword N = 20000;
+  
+  vec mean0 = { 0.0, 0.0, 0.0 };
+  vec mean1 = { 6.0, 6.0, 6.0 };
+  
+  mat C0 = { { 1.0, 0.9, 0.0 }, { 0.9, 1.0, 0.0 }, { 0.0, 0.0, 0.5 } };
+  mat C1 = { { 2.0, 0.0, -1.0 }, { 0.0, 1.0, 0.0 }, { -1.0, 0.0, 1.0 } };
+  
+  const mat R0 = chol(C0);
+  const mat R1 = chol(C1);
+  
+  mat data(3, N);
+  
+  for(uword i=0; i < N; ++i)
+    {
+    data.col(i) = ( (i % 4) == 0 ) ? vec(mean1 + R1.t()*randn<vec>(3)) : vec(mean0 + R0.t()*randn<vec>(3));
+    }
+  
+  gmm_full model;
+  
+  const bool status = model.learn(data, 2, maha_dist, static_spread, 10, 20, 1e-10, false);
+  
+  REQUIRE( status == true );
+  
+  const uword g0 = (model.means(0,0) < model.means(0,1)) ? 0 : 1;
+  const uword g1 = 1 - g0;
+  
+  REQUIRE( model.hefts(g0) == Approx(0.75).epsilon(0.01) );
+  REQUIRE( model.hefts(g1) == Approx(0.25).epsilon(0.01) );
+  
+  REQUIRE( abs(model.means.col(g0) - mean0).max() < 0.05 );
+  REQUIRE( abs(model.means.col(g1) - mean1).max() < 0.05 );
+  
+  REQUIRE( abs(model.fcovs.slice(g0) - C0).max() < 0.1 );
+  REQUIRE( abs(model.fcovs.slice(g1) - C1).max() < 0.1 );
+  
+  // the model must fit better than a diagonal one
+  
+  gmm_diag dmodel;
+  
+  dmodel.learn(data, 2, maha_dist, static_spread, 10, 20, 1e-10, false);
+  
+  REQUIRE( model.avg_log_p(data) > dmodel.avg_log_p(data) );
+  
+  // copies give the same results
+  
+  gmm_full model2 = model;
+  
+  REQUIRE( model2.avg_log_p(data) == Approx(model.avg_log_p(data)) );
+  
+  mat samples = model.generate(20000);
+  
+  REQUIRE( samples.n_rows == 3 );
+  REQUIRE( samples.n_cols == 20000 );
+  
+  REQUIRE( abs( mean(samples,1) - (0.75*mean0 + 0.25*mean1) ).max() < 0.15 );
+  }
+
+
+
+//! runs the tasks in reverse order, and records the number of jobs and the largest number of tasks per job
+class counting_executor : public executor
+  {
+  public:
+  
+  uword n_jobs;
+  uword max_tasks;
+  
+  counting_executor() : n_jobs(0), max_tasks(0) {}
+  
+  uword n_threads() const { return 3; }
+  
+  void run(executor_job& job, const uword n_tasks)
+    {
+    ++n_jobs;
+    
+    max_tasks = (std::max)(max_tasks, n_tasks);
+    
+    for(uword t=n_tasks; t > 0; --t)  { job.run_task(t-1); }
+    }
+  };
+
+
+
+TEST_CASE("stat_gmm_full_executor_1")
+  {
+  arma_rng::set_seed(123);
+  
+  const mat data = join_rows( randn<mat>(4, 4000), randn<mat>(4, 4000) + 3.0 );
+  
+  gmm_full model;
+  
+  REQUIRE( model.learn(data, 4, maha_dist, static_subset, 5, 5, 1e-10, false) == true );
+  
+  const rowvec  ref_log_p  = model.log_p(data);
+  const urowvec ref_assign = model.assign(data, prob_dist);
+  const urowvec ref_hist   = model.raw_hist(data, eucl_dist);
+  
+  // the executor is set before the model is used
+  
+  counting_executor exec;
+  
+  gmm_full model2 = model;
+  
+  model2.set_executor(exec);
+  
+  REQUIRE( accu(abs(model2.log_p(data) - ref_log_p)) == Approx(0.0) );
+  
+  REQUIRE( model2.avg_log_p(data) == Approx(mean(ref_log_p)) );
+  
+  REQUIRE( all(model2.assign(data, prob_dist) == ref_assign) );
+  REQUIRE( all(model2.raw_hist(data, eucl_dist) == ref_hist) );
+  
+  REQUIRE( exec.n_jobs    >  0 );
+  REQUIRE( exec.max_tasks == 3 );
+  
+  // small inputs are processed as one task
+  
+  exec.max_tasks = 0;
+  
+  model2.log_p(data.cols(0,9));
+  
+  REQUIRE( exec.max_tasks == 1 );
+  
+  // same model when learned via the executor, including the k-means stage
+  
+  gmm_full model3;
+  
+  model3.set_executor(exec);
+  
+  exec.n_jobs = 0;
+  
+  REQUIRE( model3.learn(data, 4, maha_dist, static_subset, 5, 5, 1e-10, false) == true );
+  
+  REQUIRE( exec.n_jobs > 0 );
+  
+  REQUIRE( abs(model3.means - model.means).max() == Approx(0.0).epsilon(1e-8) );
+  REQUIRE( accu(abs(model3.fcovs - model.fcovs)) == Approx(0.0).epsilon(1e-8) );
+  
+  // back to the default executor
+  
+  model3.set_executor();
+  
+  exec.n_jobs = 0;
+  
+  REQUIRE( accu(abs(model3.log_p(data) - ref_log_p)) == Approx(0.0).epsilon(1e-8) );
+  
+  REQUIRE( exec.n_jobs == 0 );
+  }
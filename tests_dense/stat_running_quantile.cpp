@@ -0,0 +1,100 @@
+// Copyright (C) 2016 National ICT Australia (NICTA)
+// 
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+// -------------------------------------------------------------------
+// 
+// Written by Conrad Sanderson - http://conradsanderson.id.au
+
+
+#include <armadillo>
+#include "catch.hpp"
+
+using namespace arma;
+
+
+TEST_CASE("stat_running_quantile_1")
+  {
+  // few samples: each centroid holds one sample, giving exact quantiles
+  
+  const vec a = randn<vec>(20);
+  
+  const vec P = { 0.0, 0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 1.0 };
+  
+  running_quantile<double> rq;
+  
+  rq(a);
+  
+  REQUIRE( rq.count() == Approx(20.0) );
+  REQUIRE( rq.min()   == Approx(a.min()) );
+  REQUIRE( rq.max()   == Approx(a.max()) );
+  
+  REQUIRE( accu(abs(rq.quantile(P) - quantile(a, P))) == Approx(0.0) );
+  
+  REQUIRE( rq.median() == Approx(median(a)) );
+  }
+
+
+
+TEST_CASE("stat_running_quantile_2")
+  {
+  arma_rng::set_seed(123);
+  
+  const vec a = randn<vec>(100000);
+  
+  const vec P = { 0.001, 0.01, 0.1, 0.5, 0.9, 0.99, 0.999 };
+  
+  const vec ref = quantile(a, P);
+  
+  running_quantile<double> rq;
+  
+  for(uword i=0; i < a.n_elem; ++i)  { rq(a(i)); }
+  
+  // merging the digests of separately processed parts
+  
+  running_quantile<double> rq_a;
+  running_quantile<double> rq_b;
+  running_quantile<double> rq_c;
+  
+  rq_a( a.subvec(    0, 29999) );
+  rq_b( a.subvec(30000, 69999) );
+  rq_c( a.subvec(70000, 99999) );
+  
+  rq_a.merge(rq_b);
+  rq_a.merge(rq_c);
+  
+  REQUIRE( rq_a.count() == Approx(double(a.n_elem)) );
+  REQUIRE( rq_a.min()   == Approx(a.min()) );
+  REQUIRE( rq_a.max()   == Approx(a.max()) );
+  
+  const vec est   = rq.quantile(P);
+  const vec est_a = rq_a.quantile(P);
+  
+  // the errors are measured in terms of the proportion of samples below the estimate
+  
+  for(uword j=0; j < P.n_elem; ++j)
+    {
+    const double frac   = double(accu(a < est(j)))   / double(a.n_elem);
+    const double frac_a = double(accu(a < est_a(j))) / double(a.n_elem);
+    
+    const double tol = 0.002 + 0.02 * std::min(P(j), 1.0 - P(j));
+    
+    REQUIRE( std::abs(frac   - P(j)) < tol );
+    REQUIRE( std::abs(frac_a - P(j)) < tol );
+    }
+  
+  REQUIRE( std::abs(rq.median() - ref(3)) < 0.02 );
+  
+  // float version
+  
+  running_quantile<float> frq(50);
+  
+  frq( conv_to<fvec>::from(a) );
+  
+  REQUIRE( std::abs(frq.median() - float(ref(3))) < 0.05f );
+  
+  rq.reset();
+  
+  REQUIRE( rq.count() == Approx(0.0) );
+  }
@@ -30,3 +30,75 @@ TEST_CASE("stat_running_stat_1")
   
   // REQUIRE_THROWS(  );
   }
+
+
+
+TEST_CASE("stat_running_stat_2")
+  {
+  arma_rng::set_seed(123);
+  
+  const vec x = 10.0 + randn<vec>(1000);
+  
+  // batch updates and merging give the same statistics as one sample at a time
+  
+  running_stat<double> stats_ref;
+  
+  for(uword i=0; i < x.n_elem; ++i)  { stats_ref(x(i)); }
+  
+  running_stat<double> stats_a;
+  running_stat<double> stats_b;
+  
+  stats_a( x.subvec(0, 299) );
+  
+  for(uword i=300; i < x.n_elem; ++i)  { stats_b(x(i)); }
+  
+  stats_a.merge(stats_b);
+  
+  REQUIRE( stats_a.count()  == Approx(double(x.n_elem)) );
+  REQUIRE( stats_a.mean()   == Approx(stats_ref.mean()) );
+  REQUIRE( stats_a.var()    == Approx(stats_ref.var())  );
+  REQUIRE( stats_a.var(1)   == Approx(stats_ref.var(1)) );
+  REQUIRE( stats_a.min()    == Approx(stats_ref.min())  );
+  REQUIRE( stats_a.max()    == Approx(stats_ref.max())  );
+  
+  REQUIRE( stats_a.mean() == Approx(mean(x)) );
+  REQUIRE( stats_a.var()  == Approx(var(x))  );
+  
+  // merging with an empty object
+  
+  running_stat<double> stats_c;
+  
+  stats_c.merge(stats_a);
+  stats_c.merge(running_stat<double>());
+  
+  REQUIRE( stats_c.count() == Approx(double(x.n_elem)) );
+  REQUIRE( stats_c.var()   == Approx(var(x)) );
+  
+  // merging with itself doubles the count, and keeps the mean and variance of the samples
+  
+  stats_c.merge(stats_c);
+  
+  REQUIRE( stats_c.count()  == Approx(2.0 * double(x.n_elem)) );
+  REQUIRE( stats_c.mean()   == Approx(mean(x)) );
+  REQUIRE( stats_c.var(1)   == Approx(var(x,1)) );
+  
+  // complex numbers
+  
+  const cx_vec y = randn<cx_vec>(500);
+  
+  running_stat<cx_double> cx_stats_ref;
+  running_stat<cx_double> cx_stats_a;
+  running_stat<cx_double> cx_stats_b;
+  
+  for(uword i=0; i < y.n_elem; ++i)  { cx_stats_ref(y(i)); }
+  
+  cx_stats_a( y.subvec(0,   199) );
+  cx_stats_b( y.subvec(200, 499) );
+  
+  cx_stats_a.merge(cx_stats_b);
+  
+  REQUIRE( std::abs(cx_stats_a.mean() - cx_stats_ref.mean()) == Approx(0.0) );
+  REQUIRE( cx_stats_a.var() == Approx(cx_stats_ref.var()) );
+  REQUIRE( std::abs(cx_stats_a.min() - cx_stats_ref.min()) == Approx(0.0) );
+  REQUIRE( std::abs(cx_stats_a.max() - cx_stats_ref.max()) == Approx(0.0) );
+  }
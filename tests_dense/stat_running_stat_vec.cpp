@@ -30,3 +30,156 @@ TEST_CASE("stat_running_stat_vec_1")
   
   // REQUIRE_THROWS(  );
   }
+
+
+
+TEST_CASE("stat_running_stat_vec_2")
+  {
+  arma_rng::set_seed(123);
+  
+  mat X = randn<mat>(4, 1000);
+  
+  X.row(1) += 2.0 * X.row(0);
+  X.row(3) += 5.0;
+  
+  // batch updates and merging give the same statistics as one sample at a time
+  
+  running_stat_vec<vec> stats_ref(true);
+  
+  for(uword i=0; i < X.n_cols; ++i)  { stats_ref(X.col(i)); }
+  
+  running_stat_vec<vec> stats_a(true);
+  running_stat_vec<vec> stats_b(true);
+  
+  stats_a( X.cols(0, 399) );
+  
+  stats_b( X.col(400) );
+  stats_b( X.cols(401, 999) );
+  
+  stats_a.merge(stats_b);
+  
+  REQUIRE( stats_a.count() == Approx(1000.0) );
+  
+  REQUIRE( accu(abs(stats_a.mean() - stats_ref.mean())) == Approx(0.0) );
+  REQUIRE( accu(abs(stats_a.var()  - stats_ref.var() )) == Approx(0.0) );
+  REQUIRE( accu(abs(stats_a.cov()  - stats_ref.cov() )) == Approx(0.0) );
+  REQUIRE( accu(abs(stats_a.min()  - stats_ref.min() )) == Approx(0.0) );
+  REQUIRE( accu(abs(stats_a.max()  - stats_ref.max() )) == Approx(0.0) );
+  
+  REQUIRE( accu(abs(stats_a.mean() - mean(X,1)        )) == Approx(0.0) );
+  REQUIRE( accu(abs(stats_a.cov()  - cov(trans(X))    )) == Approx(0.0) );
+  REQUIRE( accu(abs(stats_a.cov(1) - cov(trans(X), 1) )) == Approx(0.0) );
+  
+  REQUIRE( stats_a.mean().n_cols == 1 );
+  
+  // samples as row vectors
+  
+  running_stat_vec<rowvec> row_stats;
+  
+  row_stats( X.cols(0, 499) );
+  row_stats( trans(X.col(500)) );
+  
+  running_stat_vec<rowvec> row_stats_b;
+  
+  row_stats_b( X.cols(501, 999) );
+  
+  row_stats.merge(row_stats_b);
+  
+  REQUIRE( row_stats.mean().n_rows == 1 );
+  
+  REQUIRE( accu(abs(row_stats.mean() - trans(stats_ref.mean()))) == Approx(0.0) );
+  REQUIRE( accu(abs(row_stats.var()  - trans(stats_ref.var() ))) == Approx(0.0) );
+  
+  // complex numbers
+  
+  const cx_mat Y = randn<cx_mat>(3, 300);
+  
+  running_stat_vec<cx_vec> cx_stats_ref(true);
+  running_stat_vec<cx_vec> cx_stats_a(true);
+  running_stat_vec<cx_vec> cx_stats_b(true);
+  
+  for(uword i=0; i < Y.n_cols; ++i)  { cx_stats_ref(Y.col(i)); }
+  
+  cx_stats_a( Y.cols(0,   99) );
+  cx_stats_b( Y.cols(100, 299) );
+  
+  cx_stats_a.merge(cx_stats_b);
+  
+  REQUIRE( accu(abs(cx_stats_a.mean() - cx_stats_ref.mean())) == Approx(0.0) );
+  REQUIRE( accu(abs(cx_stats_a.var()  - cx_stats_ref.var() )) == Approx(0.0) );
+  REQUIRE( accu(abs(cx_stats_a.cov()  - cx_stats_ref.cov() )) == Approx(0.0) );
+  REQUIRE( accu(abs(cx_stats_a.min()  - cx_stats_ref.min() )) == Approx(0.0) );
+  REQUIRE( accu(abs(cx_stats_a.max()  - cx_stats_ref.max() )) == Approx(0.0) );
+  
+  // the covariance matrix can't be found from an object that does not calculate it
+  
+  running_stat_vec<vec> stats_c(true);
+  running_stat_vec<vec> stats_d(false);
+  
+  stats_d( X );
+  
+  REQUIRE_THROWS( stats_c.merge(stats_d) );
+  }
+
+
+
+TEST_CASE("stat_running_stat_vec_3")
+  {
+  arma_rng::set_seed(123);
+  
+  mat X = randn<mat>(4, 500);
+  
+  X.row(1) += 2.0 * X.row(0);
+  X.row(3) += 5.0;
+  
+  // integer weights give the same statistics as repeated samples
+  
+  const vec W = floor(4.0 * randu<vec>(500));
+  
+  running_stat_vec<vec> stats_ref(true);
+  
+  for(uword i=0; i < X.n_cols; ++i)
+  for(uword j=0; j < uword(W(i)); ++j)
+    {
+    stats_ref(X.col(i));
+    }
+  
+  running_stat_vec<vec> stats_a(true);
+  running_stat_vec<vec> stats_b(true);
+  
+  stats_a( X.cols(0, 199), W.subvec(0, 199) );
+  
+  for(uword i=200; i < 300; ++i)  { stats_b( X.col(i), W(i) ); }
+  
+  stats_b( X.cols(300, 499), W.subvec(300, 499) );
+  
+  stats_a.merge(stats_b);
+  
+  REQUIRE( stats_a.count() == Approx(stats_ref.count()) );
+  
+  REQUIRE( accu(abs(stats_a.mean() - stats_ref.mean())) == Approx(0.0) );
+  REQUIRE( accu(abs(stats_a.var()  - stats_ref.var() )) == Approx(0.0) );
+  REQUIRE( accu(abs(stats_a.cov()  - stats_ref.cov() )) == Approx(0.0) );
+  REQUIRE( accu(abs(stats_a.min()  - stats_ref.min() )) == Approx(0.0) );
+  REQUIRE( accu(abs(stats_a.max()  - stats_ref.max() )) == Approx(0.0) );
+  
+  // fractional weights
+  
+  const vec V = randu<vec>(500);
+  
+  running_stat_vec<vec> stats_c(true);
+  
+  stats_c( X, V );
+  
+  const vec mu  = (X * V) / accu(V);
+  const mat X_c = X.each_col() - mu;
+  
+  REQUIRE( accu(abs(stats_c.mean() - mu)) == Approx(0.0) );
+  
+  REQUIRE( accu(abs(stats_c.cov() - ((X_c.each_row() % trans(V)) * trans(X_c)) / (accu(V) - 1.0))) == Approx(0.0) );
+  
+  REQUIRE( stats_c.count() == Approx(accu(V)) );
+  
+  REQUIRE_THROWS( stats_c( X, V.subvec(0, 9) ) );
+  REQUIRE_THROWS( stats_c( X.col(0), -1.0 ) );
+  }